@@ -24,6 +24,7 @@
 #define SP_COMPILE_WITH_OPENCL              // OpenCL Toolkit for GPGPU
 #define SP_COMPILE_WITH_XBOX360GAMEPAD      // XBox360 Gamepad
 #define SP_COMPILE_WITH_RENDERSYS_QUERIES   // Render System Queries
+#define SP_COMPILE_WITH_PROFILER            // Frame Profiler (Removes all profiler scopes when disabled)
 
 #ifdef SP_COMPILE_WITH_RENDERSYSTEMS
 #   define SP_COMPILE_WITH_OPENGL           // OpenGL 1.1 - 4.1
@@ -47,6 +48,7 @@
 #   define SP_COMPILE_WITH_OPENAL           // OpenAL sound device
 //#   define SP_COMPILE_WITH_XAUDIO2          // DirectX XAudio2 sound device
 #   define SP_COMPILE_WITH_OPENSLES         // OpenSL|ES 1.0
+#   define SP_COMPILE_WITH_SOFTWARE_SOUND   // Software sound device (built-in mixer with own audio thread)
 #   define SP_COMPILE_WITH_SOUNDLOADER_WAV  // Sound loader WAV (RIFF Wave)
 //#   define SP_COMPILE_WITH_AUDIOSTREAM_OGG  // Audio stream OFF (Ogg Vorbis)
 #endif
@@ -111,6 +113,7 @@
 #   define SP_COMPILE_WITH_TEXLOADER_DDS    // Texture loader DDS (Direct Draw Surface)
 #   define SP_COMPILE_WITH_TEXLOADER_WAD    // Texture loader WAD (Where is All the Data)
 #   define SP_COMPILE_WITH_TEXSAVER_BMP     // Texture saver BMP
+#   define SP_COMPILE_WITH_TEXSAVER_DDS     // Texture saver DDS (Block compressed)
 
 #   define SP_COMPILE_WITH_MESHLOADER_3DS   // Mesh loader 3DS (3D Studio)
 #   define SP_COMPILE_WITH_MESHLOADER_B3D   // Mesh loader B3D (Blitz3D)
@@ -0,0 +1,1072 @@
+/*
+ * Image block compression file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "Base/spImageBlockCompression.hpp"
+#include "Base/spImageBuffer.hpp"
+#include "Base/spImageManagement.hpp"
+#include "Base/spInputOutputFileSystem.hpp"
+#include "Base/spInputOutputLog.hpp"
+#include "Base/spThreadPool.hpp"
+#include "Base/spMath.hpp"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#   define SP_BLOCKCOMPRESSION_SIMD
+#   include <xmmintrin.h>
+#endif
+
+
+namespace sp
+{
+namespace video
+{
+
+namespace BlockCompression
+{
+
+
+/*
+ * Internal members
+ */
+
+//! Minimal count of block rows per thread. Smaller batches are not worth the thread overhead.
+static const s32 BLOCKROW_THREAD_BATCH = 8;
+
+struct SBlockCompressionThreadData
+{
+    const u8* ImageBuffer;
+    dim::size2di Size;
+    EPixelFormats PixelFormat;
+    EBlockCompressionFormats Format;
+    EBlockCompressionQualities Quality;
+    u8* BlockBuffer;
+    s32 FirstRow;
+    s32 LastRow;
+    s32 BatchSize;
+};
+
+//! Color block with the RGB components of the 16 pixels as floats (structure of arrays for the SIMD index search).
+struct SColorBlock
+{
+    f32 R[16];
+    f32 G[16];
+    f32 B[16];
+};
+
+
+/*
+ * Internal functions
+ */
+
+static u32 getBlockSize(const EBlockCompressionFormats Format)
+{
+    return Format == BLOCKCOMPRESSION_BC1 ? 8 : 16;
+}
+
+static void fetchBlock(
+    const u8* ImageBuffer, const dim::size2di &Size, const EPixelFormats PixelFormat, s32 BlockX, s32 BlockY, u8* Pixels)
+{
+    const s32 FormatSize = ImageBuffer::getFormatSize(PixelFormat);
+    
+    for (s32 y = 0; y < 4; ++y)
+    {
+        /* Replicate the last row and column for images which are not a multiple of 4 */
+        const s32 ImageY = math::Min(BlockY*4 + y, Size.Height - 1);
+        
+        for (s32 x = 0; x < 4; ++x, Pixels += 4)
+        {
+            const s32 ImageX = math::Min(BlockX*4 + x, Size.Width - 1);
+            const u8* Pixel = ImageBuffer + (ImageY * Size.Width + ImageX) * FormatSize;
+            
+            switch (PixelFormat)
+            {
+                case PIXELFORMAT_ALPHA:
+                    Pixels[0] = Pixels[1] = Pixels[2] = 255;
+                    Pixels[3] = Pixel[0];
+                    break;
+                case PIXELFORMAT_GRAY:
+                    Pixels[0] = Pixels[1] = Pixels[2] = Pixel[0];
+                    Pixels[3] = 255;
+                    break;
+                case PIXELFORMAT_GRAYALPHA:
+                    Pixels[0] = Pixels[1] = Pixels[2] = Pixel[0];
+                    Pixels[3] = Pixel[1];
+                    break;
+                case PIXELFORMAT_RGB:
+                    Pixels[0] = Pixel[0];
+                    Pixels[1] = Pixel[1];
+                    Pixels[2] = Pixel[2];
+                    Pixels[3] = 255;
+                    break;
+                case PIXELFORMAT_BGR:
+                    Pixels[0] = Pixel[2];
+                    Pixels[1] = Pixel[1];
+                    Pixels[2] = Pixel[0];
+                    Pixels[3] = 255;
+                    break;
+                case PIXELFORMAT_RGBA:
+                    Pixels[0] = Pixel[0];
+                    Pixels[1] = Pixel[1];
+                    Pixels[2] = Pixel[2];
+                    Pixels[3] = Pixel[3];
+                    break;
+                case PIXELFORMAT_BGRA:
+                    Pixels[0] = Pixel[2];
+                    Pixels[1] = Pixel[1];
+                    Pixels[2] = Pixel[0];
+                    Pixels[3] = Pixel[3];
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+
+/* === Color blocks (BC1 and color part of BC3) === */
+
+static u16 packColor565(const f32* Color)
+{
+    const s32 r = math::MinMax(static_cast<s32>(Color[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+    const s32 g = math::MinMax(static_cast<s32>(Color[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+    const s32 b = math::MinMax(static_cast<s32>(Color[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+    return static_cast<u16>((r << 11) | (g << 5) | b);
+}
+
+static void unpackColor565(u16 Color, s32* RGB)
+{
+    const s32 r = (Color >> 11) & 0x1F;
+    const s32 g = (Color >>  5) & 0x3F;
+    const s32 b = (Color      ) & 0x1F;
+    
+    RGB[0] = (r << 3) | (r >> 2);
+    RGB[1] = (g << 2) | (g >> 4);
+    RGB[2] = (b << 3) | (b >> 2);
+}
+
+static void getColorPalette(u16 Color0, u16 Color1, bool isFourColorMode, s32 (*Palette)[3])
+{
+    unpackColor565(Color0, Palette[0]);
+    unpackColor565(Color1, Palette[1]);
+    
+    for (s32 i = 0; i < 3; ++i)
+    {
+        if (isFourColorMode)
+        {
+            Palette[2][i] = (2*Palette[0][i] +   Palette[1][i]) / 3;
+            Palette[3][i] = (  Palette[0][i] + 2*Palette[1][i]) / 3;
+        }
+        else
+        {
+            Palette[2][i] = (Palette[0][i] + Palette[1][i]) / 2;
+            Palette[3][i] = 0;
+        }
+    }
+}
+
+/**
+Selects the nearest palette color for each pixel.
+\return Squared error of the whole block.
+*/
+static u32 getColorIndices(const SColorBlock &Block, const s32 (*Palette)[3], u32 &Indices)
+{
+    f32 BestIndex[16], BestDist[16];
+    
+    #ifdef SP_BLOCKCOMPRESSION_SIMD
+    
+    /* Compare four pixels with each palette color at once */
+    for (s32 i = 0; i < 16; i += 4)
+    {
+        const __m128 R = _mm_loadu_ps(Block.R + i);
+        const __m128 G = _mm_loadu_ps(Block.G + i);
+        const __m128 B = _mm_loadu_ps(Block.B + i);
+        
+        __m128 Best     = _mm_set1_ps(1.0e+30f);
+        __m128 BestIdx  = _mm_setzero_ps();
+        
+        for (s32 j = 0; j < 4; ++j)
+        {
+            const __m128 dr = _mm_sub_ps(R, _mm_set1_ps(static_cast<f32>(Palette[j][0])));
+            const __m128 dg = _mm_sub_ps(G, _mm_set1_ps(static_cast<f32>(Palette[j][1])));
+            const __m128 db = _mm_sub_ps(B, _mm_set1_ps(static_cast<f32>(Palette[j][2])));
+            
+            const __m128 Dist = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db)
+            );
+            
+            const __m128 Mask = _mm_cmplt_ps(Dist, Best);
+            
+            Best    = _mm_min_ps(Dist, Best);
+            BestIdx = _mm_or_ps(_mm_and_ps(Mask, _mm_set1_ps(static_cast<f32>(j))), _mm_andnot_ps(Mask, BestIdx));
+        }
+        
+        _mm_storeu_ps(BestDist + i, Best);
+        _mm_storeu_ps(BestIndex + i, BestIdx);
+    }
+    
+    #else
+    
+    for (s32 i = 0; i < 16; ++i)
+    {
+        BestDist[i]     = 1.0e+30f;
+        BestIndex[i]    = 0.0f;
+        
+        for (s32 j = 0; j < 4; ++j)
+        {
+            const f32 dr = Block.R[i] - static_cast<f32>(Palette[j][0]);
+            const f32 dg = Block.G[i] - static_cast<f32>(Palette[j][1]);
+            const f32 db = Block.B[i] - static_cast<f32>(Palette[j][2]);
+            
+            const f32 Dist = dr*dr + dg*dg + db*db;
+            
+            if (Dist < BestDist[i])
+            {
+                BestDist[i]     = Dist;
+                BestIndex[i]    = static_cast<f32>(j);
+            }
+        }
+    }
+    
+    #endif
+    
+    /* Pack the 2-bit indices (the first pixel is stored in the lowest bits) */
+    u32 Error = 0;
+    Indices = 0;
+    
+    for (s32 i = 0; i < 16; ++i)
+    {
+        Indices |= (static_cast<u32>(BestIndex[i]) << (i*2));
+        Error += static_cast<u32>(BestDist[i]);
+    }
+    
+    return Error;
+}
+
+/**
+Orders the end points for the four-color mode and selects the indices.
+\return Squared error of the whole block.
+*/
+static u32 finishColorBlock(const SColorBlock &Block, u16 &Color0, u16 &Color1, u32 &Indices)
+{
+    s32 Palette[4][3];
+    
+    /* The four-color mode requires Color0 > Color1 */
+    if (Color0 < Color1)
+        std::swap(Color0, Color1);
+    
+    getColorPalette(Color0, Color1, true, Palette);
+    
+    /* Equal end points select the three-color mode, so move the other palette entries out of range to only use the first index */
+    if (Color0 == Color1)
+        Palette[1][0] = Palette[2][0] = Palette[3][0] = 1 << 16;
+    
+    return getColorIndices(Block, Palette, Indices);
+}
+
+static void getEndPointsBoundingBox(const SColorBlock &Block, f32* End0, f32* End1)
+{
+    f32 Min[3] = { 255.0f, 255.0f, 255.0f };
+    f32 Max[3] = {   0.0f,   0.0f,   0.0f };
+    
+    for (s32 i = 0; i < 16; ++i)
+    {
+        Min[0] = math::Min(Min[0], Block.R[i]); Max[0] = math::Max(Max[0], Block.R[i]);
+        Min[1] = math::Min(Min[1], Block.G[i]); Max[1] = math::Max(Max[1], Block.G[i]);
+        Min[2] = math::Min(Min[2], Block.B[i]); Max[2] = math::Max(Max[2], Block.B[i]);
+    }
+    
+    /* Inset the bounding box to reduce the error of the outer pixels */
+    for (s32 i = 0; i < 3; ++i)
+    {
+        const f32 Inset = (Max[i] - Min[i]) / 16.0f;
+        End0[i] = Max[i] - Inset;
+        End1[i] = Min[i] + Inset;
+    }
+}
+
+static void getEndPointsPrincipalAxis(const SColorBlock &Block, f32* End0, f32* End1)
+{
+    /* Compute the mean color and the covariance matrix */
+    f32 Mean[3] = { 0.0f, 0.0f, 0.0f };
+    
+    for (s32 i = 0; i < 16; ++i)
+    {
+        Mean[0] += Block.R[i];
+        Mean[1] += Block.G[i];
+        Mean[2] += Block.B[i];
+    }
+    
+    for (s32 i = 0; i < 3; ++i)
+        Mean[i] /= 16.0f;
+    
+    f32 Cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    
+    for (s32 i = 0; i < 16; ++i)
+    {
+        const f32 r = Block.R[i] - Mean[0];
+        const f32 g = Block.G[i] - Mean[1];
+        const f32 b = Block.B[i] - Mean[2];
+        
+        Cov[0] += r*r; Cov[1] += r*g; Cov[2] += r*b;
+        Cov[3] += g*g; Cov[4] += g*b; Cov[5] += b*b;
+    }
+    
+    /* Find the principal axis with a few power iterations */
+    f32 Axis[3] = { 1.0f, 1.0f, 1.0f };
+    
+    for (s32 n = 0; n < 4; ++n)
+    {
+        const f32 x = Axis[0]*Cov[0] + Axis[1]*Cov[1] + Axis[2]*Cov[2];
+        const f32 y = Axis[0]*Cov[1] + Axis[1]*Cov[3] + Axis[2]*Cov[4];
+        const f32 z = Axis[0]*Cov[2] + Axis[1]*Cov[4] + Axis[2]*Cov[5];
+        
+        const f32 Len = math::Max(math::Abs(x), math::Max(math::Abs(y), math::Abs(z)));
+        
+        if (Len < math::ROUNDING_ERROR)
+        {
+            /* All pixels have (nearly) the same color */
+            getEndPointsBoundingBox(Block, End0, End1);
+            return;
+        }
+        
+        Axis[0] = x / Len;
+        Axis[1] = y / Len;
+        Axis[2] = z / Len;
+    }
+    
+    const f32 AxisLenSq = Axis[0]*Axis[0] + Axis[1]*Axis[1] + Axis[2]*Axis[2];
+    
+    /* Project the pixels onto the axis */
+    f32 MinT = 0.0f, MaxT = 0.0f;
+    
+    for (s32 i = 0; i < 16; ++i)
+    {
+        const f32 t = (
+            (Block.R[i] - Mean[0])*Axis[0] + (Block.G[i] - Mean[1])*Axis[1] + (Block.B[i] - Mean[2])*Axis[2]
+        ) / AxisLenSq;
+        
+        MinT = math::Min(MinT, t);
+        MaxT = math::Max(MaxT, t);
+    }
+    
+    /* Inset the end points along the axis */
+    const f32 Inset = (MaxT - MinT) / 16.0f;
+    
+    MinT += Inset;
+    MaxT -= Inset;
+    
+    for (s32 i = 0; i < 3; ++i)
+    {
+        End0[i] = math::MinMax(Mean[i] + Axis[i]*MaxT, 0.0f, 255.0f);
+        End1[i] = math::MinMax(Mean[i] + Axis[i]*MinT, 0.0f, 255.0f);
+    }
+}
+
+/**
+Computes the end points which minimize the squared error for the given indices (least squares).
+\return False if the system is singular (e.g. all pixels use the same index).
+*/
+static bool refineEndPoints(const SColorBlock &Block, u32 Indices, f32* End0, f32* End1)
+{
+    static const f32 Weights[4] = { 1.0f, 0.0f, 2.0f/3.0f, 1.0f/3.0f };
+    
+    f32 aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    f32 ap[3] = { 0.0f, 0.0f, 0.0f };
+    f32 bp[3] = { 0.0f, 0.0f, 0.0f };
+    
+    for (s32 i = 0; i < 16; ++i, Indices >>= 2)
+    {
+        const f32 a = Weights[Indices & 0x3];
+        const f32 b = 1.0f - a;
+        
+        aa += a*a;
+        ab += a*b;
+        bb += b*b;
+        
+        ap[0] += a*Block.R[i]; bp[0] += b*Block.R[i];
+        ap[1] += a*Block.G[i]; bp[1] += b*Block.G[i];
+        ap[2] += a*Block.B[i]; bp[2] += b*Block.B[i];
+    }
+    
+    const f32 Det = aa*bb - ab*ab;
+    
+    if (math::Abs(Det) < math::ROUNDING_ERROR)
+        return false;
+    
+    const f32 InvDet = 1.0f / Det;
+    
+    for (s32 i = 0; i < 3; ++i)
+    {
+        End0[i] = math::MinMax((ap[i]*bb - bp[i]*ab) * InvDet, 0.0f, 255.0f);
+        End1[i] = math::MinMax((bp[i]*aa - ap[i]*ab) * InvDet, 0.0f, 255.0f);
+    }
+    
+    return true;
+}
+
+static void encodeColorBlock(const u8* Pixels, const EBlockCompressionQualities Quality, u8* BlockBuffer)
+{
+    SColorBlock Block;
+    
+    for (s32 i = 0; i < 16; ++i)
+    {
+        Block.R[i] = static_cast<f32>(Pixels[i*4    ]);
+        Block.G[i] = static_cast<f32>(Pixels[i*4 + 1]);
+        Block.B[i] = static_cast<f32>(Pixels[i*4 + 2]);
+    }
+    
+    /* Determine the end points */
+    f32 End0[3], End1[3];
+    
+    if (Quality == BLOCKQUALITY_FAST)
+        getEndPointsBoundingBox(Block, End0, End1);
+    else
+        getEndPointsPrincipalAxis(Block, End0, End1);
+    
+    u16 Color0 = packColor565(End0);
+    u16 Color1 = packColor565(End1);
+    u32 Indices = 0;
+    
+    u32 Error = finishColorBlock(Block, Color0, Color1, Indices);
+    
+    /* Refine the end points with the selected indices */
+    if (Quality == BLOCKQUALITY_HIGH)
+    {
+        for (s32 n = 0; n < 2 && Error > 0; ++n)
+        {
+            if (!refineEndPoints(Block, Indices, End0, End1))
+                break;
+            
+            u16 NewColor0 = packColor565(End0);
+            u16 NewColor1 = packColor565(End1);
+            u32 NewIndices = 0;
+            
+            const u32 NewError = finishColorBlock(Block, NewColor0, NewColor1, NewIndices);
+            
+            if (NewError >= Error)
+                break;
+            
+            Color0  = NewColor0;
+            Color1  = NewColor1;
+            Indices = NewIndices;
+            Error   = NewError;
+        }
+    }
+    
+    /* Write the block (little endian) */
+    BlockBuffer[0] = static_cast<u8>(Color0 & 0xFF);
+    BlockBuffer[1] = static_cast<u8>(Color0 >> 8);
+    BlockBuffer[2] = static_cast<u8>(Color1 & 0xFF);
+    BlockBuffer[3] = static_cast<u8>(Color1 >> 8);
+    
+    for (s32 i = 0; i < 4; ++i)
+        BlockBuffer[4 + i] = static_cast<u8>((Indices >> (i*8)) & 0xFF);
+}
+
+static void decodeColorBlock(const u8* BlockBuffer, bool isBC1, u8* Pixels)
+{
+    const u16 Color0 = static_cast<u16>(BlockBuffer[0] | (BlockBuffer[1] << 8));
+    const u16 Color1 = static_cast<u16>(BlockBuffer[2] | (BlockBuffer[3] << 8));
+    
+    /* BC3 always uses the four-color mode */
+    const bool isFourColorMode = (!isBC1 || Color0 > Color1);
+    
+    s32 Palette[4][3];
+    getColorPalette(Color0, Color1, isFourColorMode, Palette);
+    
+    u32 Indices = BlockBuffer[4] | (BlockBuffer[5] << 8) | (BlockBuffer[6] << 16) | (BlockBuffer[7] << 24);
+    
+    for (s32 i = 0; i < 16; ++i, Indices >>= 2, Pixels += 4)
+    {
+        const u32 j = (Indices & 0x3);
+        
+        Pixels[0] = static_cast<u8>(Palette[j][0]);
+        Pixels[1] = static_cast<u8>(Palette[j][1]);
+        Pixels[2] = static_cast<u8>(Palette[j][2]);
+        Pixels[3] = (!isFourColorMode && j == 3 ? 0 : 255);
+    }
+}
+
+
+/* === Single channel blocks (alpha part of BC3 and both channels of BC5) === */
+
+static void getChannelPalette(s32 Value0, s32 Value1, s32* Palette)
+{
+    Palette[0] = Value0;
+    Palette[1] = Value1;
+    
+    if (Value0 > Value1)
+    {
+        /* Eight-value mode */
+        for (s32 i = 1; i < 7; ++i)
+            Palette[i + 1] = ((7 - i)*Value0 + i*Value1) / 7;
+    }
+    else
+    {
+        /* Six-value mode with explicit 0 and 255 */
+        for (s32 i = 1; i < 5; ++i)
+            Palette[i + 1] = ((5 - i)*Value0 + i*Value1) / 5;
+        Palette[6] = 0;
+        Palette[7] = 255;
+    }
+}
+
+static u32 getChannelIndices(const s32* Values, s32 Value0, s32 Value1, u64 &Indices)
+{
+    s32 Palette[8];
+    getChannelPalette(Value0, Value1, Palette);
+    
+    u32 Error = 0;
+    Indices = 0;
+    
+    for (s32 i = 0; i < 16; ++i)
+    {
+        s32 BestDist = 0x7FFFFFFF;
+        u64 BestIndex = 0;
+        
+        for (s32 j = 0; j < 8; ++j)
+        {
+            const s32 Dist = (Values[i] - Palette[j]) * (Values[i] - Palette[j]);
+            
+            if (Dist < BestDist)
+            {
+                BestDist    = Dist;
+                BestIndex   = j;
+            }
+        }
+        
+        Indices |= (BestIndex << (i*3));
+        Error += BestDist;
+    }
+    
+    return Error;
+}
+
+static void encodeChannelBlock(const u8* Pixels, s32 Channel, const EBlockCompressionQualities Quality, u8* BlockBuffer)
+{
+    s32 Values[16];
+    s32 Min = 255, Max = 0;
+    s32 InnerMin = 255, InnerMax = 0;
+    
+    for (s32 i = 0; i < 16; ++i)
+    {
+        Values[i] = Pixels[i*4 + Channel];
+        
+        Min = math::Min(Min, Values[i]);
+        Max = math::Max(Max, Values[i]);
+        
+        if (Values[i] > 0 && Values[i] < 255)
+        {
+            InnerMin = math::Min(InnerMin, Values[i]);
+            InnerMax = math::Max(InnerMax, Values[i]);
+        }
+    }
+    
+    s32 Value0 = Max, Value1 = Min;
+    u64 Indices = 0;
+    u32 Error = 0;
+    
+    if (Max == Min)
+    {
+        /* Constant block: all pixels use the first value */
+        Value0 = Value1 = Max;
+    }
+    else
+    {
+        Error = getChannelIndices(Values, Value0, Value1, Indices);
+        
+        /* Try to inset the end points of the eight-value mode */
+        if (Quality == BLOCKQUALITY_HIGH)
+        {
+            for (s32 i = 0; i < 4; ++i)
+            {
+                for (s32 j = 0; j < 4; ++j)
+                {
+                    if ((i || j) && Max - i > Min + j)
+                    {
+                        u64 NewIndices = 0;
+                        const u32 NewError = getChannelIndices(Values, Max - i, Min + j, NewIndices);
+                        
+                        if (NewError < Error)
+                        {
+                            Value0  = Max - i;
+                            Value1  = Min + j;
+                            Indices = NewIndices;
+                            Error   = NewError;
+                        }
+                    }
+                }
+            }
+        }
+        
+        /* Try the six-value mode for blocks with values at 0 or 255 */
+        if (Quality != BLOCKQUALITY_FAST && (Min == 0 || Max == 255))
+        {
+            if (InnerMin > InnerMax)
+                InnerMin = InnerMax = (Min == 0 ? Max : Min);
+            
+            u64 NewIndices = 0;
+            const u32 NewError = getChannelIndices(Values, InnerMin, InnerMax, NewIndices);
+            
+            if (NewError < Error)
+            {
+                Value0  = InnerMin;
+                Value1  = InnerMax;
+                Indices = NewIndices;
+                Error   = NewError;
+            }
+        }
+    }
+    
+    /* Write the block (two values and 16 3-bit indices, little endian) */
+    BlockBuffer[0] = static_cast<u8>(Value0);
+    BlockBuffer[1] = static_cast<u8>(Value1);
+    
+    for (s32 i = 0; i < 6; ++i)
+        BlockBuffer[2 + i] = static_cast<u8>((Indices >> (i*8)) & 0xFF);
+}
+
+static void decodeChannelBlock(const u8* BlockBuffer, s32 Channel, u8* Pixels)
+{
+    s32 Palette[8];
+    getChannelPalette(BlockBuffer[0], BlockBuffer[1], Palette);
+    
+    u64 Indices = 0;
+    
+    for (s32 i = 0; i < 6; ++i)
+        Indices |= (static_cast<u64>(BlockBuffer[2 + i]) << (i*8));
+    
+    for (s32 i = 0; i < 16; ++i, Indices >>= 3)
+        Pixels[i*4 + Channel] = static_cast<u8>(Palette[Indices & 0x7]);
+}
+
+
+/* === Image processing === */
+
+static void compressBlockRows(const SBlockCompressionThreadData &Data)
+{
+    const s32 NumBlocksX = (Data.Size.Width + 3) / 4;
+    const u32 BlockSize = getBlockSize(Data.Format);
+    
+    u8 Pixels[16*4];
+    u8* BlockBuffer = Data.BlockBuffer + Data.FirstRow * NumBlocksX * BlockSize;
+    
+    for (s32 y = Data.FirstRow; y < Data.LastRow; ++y)
+    {
+        for (s32 x = 0; x < NumBlocksX; ++x, BlockBuffer += BlockSize)
+        {
+            fetchBlock(Data.ImageBuffer, Data.Size, Data.PixelFormat, x, y, Pixels);
+            
+            switch (Data.Format)
+            {
+                case BLOCKCOMPRESSION_BC1:
+                    encodeColorBlock(Pixels, Data.Quality, BlockBuffer);
+                    break;
+                case BLOCKCOMPRESSION_BC3:
+                    encodeChannelBlock(Pixels, 3, Data.Quality, BlockBuffer);
+                    encodeColorBlock(Pixels, Data.Quality, BlockBuffer + 8);
+                    break;
+                case BLOCKCOMPRESSION_BC5:
+                    encodeChannelBlock(Pixels, 0, Data.Quality, BlockBuffer);
+                    encodeChannelBlock(Pixels, 1, Data.Quality, BlockBuffer + 8);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+static void BlockCompressionTaskProc(u32 Index, void* UserData)
+{
+    SBlockCompressionThreadData TaskData(*reinterpret_cast<const SBlockCompressionThreadData*>(UserData));
+    
+    TaskData.FirstRow   = math::Min(static_cast<s32>(Index) * TaskData.BatchSize, TaskData.LastRow);
+    TaskData.LastRow    = math::Min(static_cast<s32>(Index + 1) * TaskData.BatchSize, TaskData.LastRow);
+    
+    compressBlockRows(TaskData);
+}
+
+
+/*
+ * Global functions
+ */
+
+SP_EXPORT u32 getCompressedSize(const EBlockCompressionFormats Format, const dim::size2di &Size)
+{
+    if (Format < BLOCKCOMPRESSION_BC1 || Format > BLOCKCOMPRESSION_BC5)
+        return 0;
+    return ((Size.Width + 3) / 4) * ((Size.Height + 3) / 4) * getBlockSize(Format);
+}
+
+SP_EXPORT EBlockCompressionFormats resolveFormat(const EBlockCompressionFormats Format, const EPixelFormats PixelFormat)
+{
+    if (PixelFormat == PIXELFORMAT_DEPTH)
+        return BLOCKCOMPRESSION_NONE;
+    
+    if (Format == BLOCKCOMPRESSION_AUTO)
+    {
+        switch (PixelFormat)
+        {
+            case PIXELFORMAT_ALPHA:
+            case PIXELFORMAT_GRAYALPHA:
+            case PIXELFORMAT_RGBA:
+            case PIXELFORMAT_BGRA:
+                return BLOCKCOMPRESSION_BC3;
+            default:
+                return BLOCKCOMPRESSION_BC1;
+        }
+    }
+    
+    return Format;
+}
+
+SP_EXPORT bool compressImage(
+    const u8* ImageBuffer, const dim::size2di &Size, const EPixelFormats PixelFormat,
+    const EBlockCompressionFormats Format, u8* BlockBuffer,
+    const EBlockCompressionQualities Quality, u32 ThreadCount)
+{
+    const EBlockCompressionFormats FinalFormat = resolveFormat(Format, PixelFormat);
+    
+    if (!ImageBuffer || !BlockBuffer || Size.Width <= 0 || Size.Height <= 0 || FinalFormat == BLOCKCOMPRESSION_NONE)
+    {
+        #ifdef SP_DEBUGMODE
+        io::Log::debug("BlockCompression::compressImage");
+        #endif
+        return false;
+    }
+    
+    /* Split the block rows into batches */
+    const s32 NumBlockRows = (Size.Height + 3) / 4;
+    
+    if (!ThreadCount)
+        ThreadCount = ThreadPool::getShared()->getThreadCount() + 1;
+    
+    ThreadCount = math::MinMax(ThreadCount, 1u, static_cast<u32>(NumBlockRows / BLOCKROW_THREAD_BATCH + 1));
+    
+    SBlockCompressionThreadData Data;
+    {
+        Data.ImageBuffer        = ImageBuffer;
+        Data.Size               = Size;
+        Data.PixelFormat        = PixelFormat;
+        Data.Format             = FinalFormat;
+        Data.Quality            = Quality;
+        Data.BlockBuffer        = BlockBuffer;
+        Data.FirstRow           = 0;
+        Data.LastRow            = NumBlockRows;
+        Data.BatchSize          = (NumBlockRows + ThreadCount - 1) / ThreadCount;
+    }
+    
+    /* Compress the batches on the shared thread pool (this thread takes part) */
+    if (ThreadCount > 1)
+        ThreadPool::getShared()->run(BlockCompressionTaskProc, &Data, ThreadCount);
+    else
+        compressBlockRows(Data);
+    
+    return true;
+}
+
+SP_EXPORT bool compressMipMaps(
+    const u8* ImageBuffer, const dim::size2di &Size, const EPixelFormats PixelFormat,
+    const EBlockCompressionFormats Format, SCompressedImage &Image, bool MipMaps,
+    const EBlockCompressionQualities Quality, BlockCompressionCache* Cache)
+{
+    Image.Format    = resolveFormat(Format, PixelFormat);
+    Image.Size      = Size;
+    Image.Levels.clear();
+    
+    if (!ImageBuffer || !getCompressedSize(Image.Format, Size))
+        return false;
+    
+    const s32 FormatSize = ImageBuffer::getFormatSize(PixelFormat);
+    
+    dim::size2di LevelSize(Size);
+    u8* LevelBuffer = 0;
+    bool Result = true;
+    
+    while (1)
+    {
+        const u8* Buffer = (LevelBuffer ? LevelBuffer : ImageBuffer);
+        
+        /* Compress current MIP level (or read it from the cache) */
+        Image.Levels.resize(Image.Levels.size() + 1);
+        std::vector<u8>& BlockBuffer = Image.Levels.back();
+        
+        if (Cache)
+            Result = Cache->compressImage(Buffer, LevelSize, PixelFormat, Image.Format, BlockBuffer, Quality);
+        else
+        {
+            BlockBuffer.resize(getCompressedSize(Image.Format, LevelSize));
+            Result = compressImage(Buffer, LevelSize, PixelFormat, Image.Format, &BlockBuffer[0], Quality);
+        }
+        
+        if (!Result || BlockBuffer.empty() || !MipMaps || ( LevelSize.Width == 1 && LevelSize.Height == 1 ))
+            break;
+        
+        /* Generate next MIP level */
+        if (!LevelBuffer)
+        {
+            const u32 BufferSize = LevelSize.getArea() * FormatSize;
+            LevelBuffer = new u8[BufferSize];
+            memcpy(LevelBuffer, ImageBuffer, BufferSize);
+        }
+        
+        ImageConverter::halveImage<u8>(LevelBuffer, LevelSize.Width, LevelSize.Height, FormatSize);
+        
+        LevelSize.Width     = math::Max(1, LevelSize.Width  / 2);
+        LevelSize.Height    = math::Max(1, LevelSize.Height / 2);
+    }
+    
+    delete [] LevelBuffer;
+    
+    if (!Result)
+        Image.Levels.clear();
+    
+    return Result;
+}
+
+SP_EXPORT bool decompressImage(
+    const u8* BlockBuffer, const dim::size2di &Size, const EBlockCompressionFormats Format, u8* ImageBuffer)
+{
+    if (!BlockBuffer || !ImageBuffer || Size.Width <= 0 || Size.Height <= 0 || !getCompressedSize(Format, Size))
+    {
+        #ifdef SP_DEBUGMODE
+        io::Log::debug("BlockCompression::decompressImage");
+        #endif
+        return false;
+    }
+    
+    const s32 NumBlocksX = (Size.Width + 3) / 4;
+    const s32 NumBlocksY = (Size.Height + 3) / 4;
+    const u32 BlockSize = getBlockSize(Format);
+    
+    u8 Pixels[16*4];
+    
+    for (s32 y = 0; y < NumBlocksY; ++y)
+    {
+        for (s32 x = 0; x < NumBlocksX; ++x, BlockBuffer += BlockSize)
+        {
+            /* Decode the block */
+            switch (Format)
+            {
+                case BLOCKCOMPRESSION_BC1:
+                    decodeColorBlock(BlockBuffer, true, Pixels);
+                    break;
+                case BLOCKCOMPRESSION_BC3:
+                    decodeColorBlock(BlockBuffer + 8, false, Pixels);
+                    decodeChannelBlock(BlockBuffer, 3, Pixels);
+                    break;
+                case BLOCKCOMPRESSION_BC5:
+                    decodeChannelBlock(BlockBuffer, 0, Pixels);
+                    decodeChannelBlock(BlockBuffer + 8, 1, Pixels);
+                    for (s32 i = 0; i < 16; ++i)
+                    {
+                        Pixels[i*4 + 2] = 0;
+                        Pixels[i*4 + 3] = 255;
+                    }
+                    break;
+                default:
+                    break;
+            }
+            
+            /* Copy the pixels which are inside the image */
+            const s32 Width     = math::Min(4, Size.Width   - x*4);
+            const s32 Height    = math::Min(4, Size.Height  - y*4);
+            
+            for (s32 sy = 0; sy < Height; ++sy)
+            {
+                memcpy(
+                    ImageBuffer + ((y*4 + sy) * Size.Width + x*4) * 4, Pixels + sy*16, Width*4
+                );
+            }
+        }
+    }
+    
+    return true;
+}
+
+SP_EXPORT f64 getPSNR(
+    const u8* ImageBufferA, const u8* ImageBufferB, u32 PixelCount, const EBlockCompressionFormats Format)
+{
+    if (!ImageBufferA || !ImageBufferB || !PixelCount)
+        return 0.0;
+    
+    /* Determine the compared channels */
+    u32 NumChannels = 3;
+    
+    if (Format == BLOCKCOMPRESSION_BC3)
+        NumChannels = 4;
+    else if (Format == BLOCKCOMPRESSION_BC5)
+        NumChannels = 2;
+    
+    /* Compute the mean squared error */
+    u64 SquaredError = 0;
+    
+    for (u32 i = 0; i < PixelCount; ++i, ImageBufferA += 4, ImageBufferB += 4)
+    {
+        for (u32 j = 0; j < NumChannels; ++j)
+        {
+            const s32 Diff = static_cast<s32>(ImageBufferA[j]) - static_cast<s32>(ImageBufferB[j]);
+            SquaredError += Diff*Diff;
+        }
+    }
+    
+    if (!SquaredError)
+        return 999.0;
+    
+    const f64 MSE = static_cast<f64>(SquaredError) / (PixelCount * NumChannels);
+    
+    return 10.0 * log10(255.0 * 255.0 / MSE);
+}
+
+} // /namespace BlockCompression
+
+
+/*
+ * BlockCompressionCache class
+ */
+
+static const u32 BLOCKCACHE_MAGIC   = 0x43425053; // "SPBC"
+static const u32 BLOCKCACHE_VERSION = 1;
+
+BlockCompressionCache::BlockCompressionCache(const io::stringc &Path) :
+    Path_       (Path   ),
+    NumHits_    (0      ),
+    NumMisses_  (0      )
+{
+    /* Append the directory separator */
+    if (Path_.size() && Path_[Path_.size() - 1] != '/' && Path_[Path_.size() - 1] != '\\')
+        Path_ += "/";
+}
+BlockCompressionCache::~BlockCompressionCache()
+{
+}
+
+bool BlockCompressionCache::compressImage(
+    const u8* ImageBuffer, const dim::size2di &Size, const EPixelFormats PixelFormat,
+    const EBlockCompressionFormats Format, std::vector<u8> &BlockBuffer,
+    const EBlockCompressionQualities Quality, u32 ThreadCount)
+{
+    const EBlockCompressionFormats FinalFormat = BlockCompression::resolveFormat(Format, PixelFormat);
+    const u32 CompressedSize = BlockCompression::getCompressedSize(FinalFormat, Size);
+    
+    if (!ImageBuffer || !CompressedSize)
+        return false;
+    
+    /* Hash the image content and all parameters which affect the blocks (64 bit FNV-1a) */
+    SHeader Header;
+    {
+        Header.Magic        = BLOCKCACHE_MAGIC;
+        Header.Version      = BLOCKCACHE_VERSION;
+        Header.Width        = Size.Width;
+        Header.Height       = Size.Height;
+        Header.PixelFormat  = PixelFormat;
+        Header.Format       = FinalFormat;
+        Header.Quality      = Quality;
+        Header.Reserved     = 0;
+    }
+    
+    const u32 ImageSize = Size.getArea() * ImageBuffer::getFormatSize(PixelFormat);
+    
+    const s32 Params[5] = { Size.Width, Size.Height, PixelFormat, FinalFormat, Quality };
+    
+    const u64 Hash = math::getHash(Params, sizeof(Params), math::getHash(ImageBuffer, ImageSize));
+    
+    Header.Hash = Hash;
+    
+    const io::stringc Filename(Path_ + io::getHexString(Hash) + ".spbc");
+    
+    /* Read the blocks from the cache */
+    if (readCacheFile(Filename, Header, BlockBuffer))
+    {
+        Mutex_.lock();
+        ++NumHits_;
+        Mutex_.unlock();
+        return true;
+    }
+    
+    /* Compress the image and store it in the cache */
+    Mutex_.lock();
+    ++NumMisses_;
+    Mutex_.unlock();
+    
+    BlockBuffer.resize(CompressedSize);
+    
+    if (!BlockCompression::compressImage(ImageBuffer, Size, PixelFormat, FinalFormat, &BlockBuffer[0], Quality, ThreadCount))
+        return false;
+    
+    writeCacheFile(Filename, Header, BlockBuffer);
+    
+    return true;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+bool BlockCompressionCache::readCacheFile(
+    const io::stringc &Filename, const SHeader &Header, std::vector<u8> &BlockBuffer) const
+{
+    io::FileSystem FileSys;
+    
+    if (!FileSys.findFile(Filename))
+        return false;
+    
+    io::File* CacheFile = FileSys.openFile(Filename, io::FILE_READ);
+    
+    if (!CacheFile)
+        return false;
+    
+    /* Compare the header (a hash collision with other parameters is rejected here) */
+    SHeader FileHeader;
+    CacheFile->readBuffer(&FileHeader, sizeof(SHeader));
+    
+    const u32 CompressedSize = BlockCompression::getCompressedSize(
+        static_cast<EBlockCompressionFormats>(Header.Format), dim::size2di(Header.Width, Header.Height)
+    );
+    
+    bool Result = false;
+    
+    if (!memcmp(&FileHeader, &Header, sizeof(SHeader)) && CacheFile->getSize() == sizeof(SHeader) + CompressedSize)
+    {
+        BlockBuffer.resize(CompressedSize);
+        CacheFile->readBuffer(&BlockBuffer[0], CompressedSize);
+        Result = true;
+    }
+    
+    FileSys.closeFile(CacheFile);
+    
+    return Result;
+}
+
+void BlockCompressionCache::writeCacheFile(
+    const io::stringc &Filename, const SHeader &Header, const std::vector<u8> &BlockBuffer) const
+{
+    io::FileSystem FileSys;
+    io::File* CacheFile = FileSys.openFile(Filename, io::FILE_WRITE);
+    
+    if (!CacheFile)
+    {
+        io::Log::warning("Could not write block compression cache file \"" + Filename + "\"");
+        return;
+    }
+    
+    CacheFile->writeBuffer(&Header, sizeof(SHeader));
+    CacheFile->writeBuffer(&BlockBuffer[0], BlockBuffer.size());
+    
+    FileSys.closeFile(CacheFile);
+}
+
+
+} // /namespace video
+
+} // /namespace sp
+
+
+
+// ================================================================================
@@ -0,0 +1,231 @@
+/*
+ * Image block compression header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_IMAGE_BLOCK_COMPRESSION_H__
+#define __SP_IMAGE_BLOCK_COMPRESSION_H__
+
+
+#include "Base/spStandard.hpp"
+#include "Base/spDimension.hpp"
+#include "Base/spInputOutputString.hpp"
+#include "Base/spCriticalSection.hpp"
+#include "RenderSystem/spTextureFlags.hpp"
+
+#include <vector>
+
+
+namespace sp
+{
+namespace video
+{
+
+
+class BlockCompressionCache;
+
+/**
+Block compressed image with its MIP-map chain. This is used to compress an image on a worker thread,
+so that only the blocks are uploaded on the render thread.
+\see BlockCompression::compressMipMaps
+\see Texture::adoptImageBuffer
+\since Version 3.3
+*/
+struct SCompressedImage
+{
+    SCompressedImage() :
+        Format(BLOCKCOMPRESSION_NONE)
+    {
+    }
+    ~SCompressedImage()
+    {
+    }
+    
+    /* Members */
+    EBlockCompressionFormats Format;    //!< Final block compression format (BC1, BC3 or BC5).
+    dim::size2di Size;                  //!< Size of the first MIP level.
+    std::vector< std::vector<u8> > Levels; //!< Compressed blocks of each MIP level. The first entry is the full sized image.
+};
+
+
+/**
+BlockCompression namespace with the CPU encoder and decoder for the BC1 (DXT1), BC3 (DXT5) and BC5 (ATI2) block compression formats.
+Each format stores 4x4 pixel blocks with a fixed size (8 bytes for BC1 and 16 bytes for BC3 and BC5).
+The encoder processes the block rows on several threads and uses SSE for the color index search when available.
+\see EBlockCompressionFormats
+\since Version 3.3
+*/
+namespace BlockCompression
+{
+
+/**
+Returns the size (in bytes) of the compressed image.
+\param Format: Specifies the block compression format. Must be BC1, BC3 or BC5.
+\param Size: Specifies the image size. The image is padded to multiples of 4.
+\return Compressed image size or 0 if the format is invalid.
+*/
+SP_EXPORT u32 getCompressedSize(const EBlockCompressionFormats Format, const dim::size2di &Size);
+
+/**
+Returns the final block compression format for the specified pixel format,
+i.e. BLOCKCOMPRESSION_AUTO is resolved to BC3 for pixel formats with alpha channel and to BC1 otherwise.
+\return Block compression format or BLOCKCOMPRESSION_NONE if the pixel format can not be compressed (e.g. PIXELFORMAT_DEPTH).
+*/
+SP_EXPORT EBlockCompressionFormats resolveFormat(const EBlockCompressionFormats Format, const EPixelFormats PixelFormat);
+
+/**
+Compresses the specified image.
+\param ImageBuffer: Specifies the UBYTE image buffer. Gray scaled images are expanded to RGB and BGR(A) images are swapped to RGB(A).
+\param Size: Specifies the image size.
+\param PixelFormat: Specifies the image pixel format. PIXELFORMAT_DEPTH is not supported.
+\param Format: Specifies the block compression format. BLOCKCOMPRESSION_AUTO is resolved with "resolveFormat".
+\param BlockBuffer: Specifies the output buffer. It must have at least the size returned by "getCompressedSize".
+\param Quality: Specifies the encoder quality. By default BLOCKQUALITY_NORMAL.
+\param ThreadCount: Specifies the count of batches which are compressed on the shared thread pool.
+By default 0 which means one batch per processor. \see ThreadPool::getShared
+\return True if the image could be compressed.
+*/
+SP_EXPORT bool compressImage(
+    const u8* ImageBuffer, const dim::size2di &Size, const EPixelFormats PixelFormat,
+    const EBlockCompressionFormats Format, u8* BlockBuffer,
+    const EBlockCompressionQualities Quality = BLOCKQUALITY_NORMAL, u32 ThreadCount = 0
+);
+
+/**
+Decompresses the specified block buffer.
+\param BlockBuffer: Specifies the compressed blocks.
+\param Size: Specifies the image size.
+\param Format: Specifies the block compression format. Must be BC1, BC3 or BC5.
+\param ImageBuffer: Specifies the RGBA output buffer (Size.Width * Size.Height * 4 bytes).
+BC5 images are decompressed to red and green with blue 0 and alpha 255.
+\return True if the image could be decompressed.
+*/
+/**
+Compresses the specified image and optionally its whole MIP-map chain. The MIP levels are generated by halving the image.
+\param ImageBuffer: Specifies the UBYTE image buffer. \see compressImage
+\param Size: Specifies the image size.
+\param PixelFormat: Specifies the image pixel format.
+\param Format: Specifies the block compression format. BLOCKCOMPRESSION_AUTO is resolved with "resolveFormat".
+\param Image: Specifies the output image. Its previous levels are discarded.
+\param MipMaps: Specifies whether the MIP-map chain is compressed, too.
+\param Quality: Specifies the encoder quality. By default BLOCKQUALITY_NORMAL.
+\param Cache: Optional block compression cache. By default null.
+eturn True if all levels could be compressed.
+*/
+SP_EXPORT bool compressMipMaps(
+    const u8* ImageBuffer, const dim::size2di &Size, const EPixelFormats PixelFormat,
+    const EBlockCompressionFormats Format, SCompressedImage &Image, bool MipMaps,
+    const EBlockCompressionQualities Quality = BLOCKQUALITY_NORMAL, BlockCompressionCache* Cache = 0
+);
+
+SP_EXPORT bool decompressImage(
+    const u8* BlockBuffer, const dim::size2di &Size, const EBlockCompressionFormats Format, u8* ImageBuffer
+);
+
+/**
+Computes the peak signal-to-noise ratio (PSNR) between two RGBA images.
+Only the channels which are stored by the block compression format are compared (RGB for BC1, RGBA for BC3 and RG for BC5).
+\return PSNR in decibel or 999.0 if the images are equal.
+*/
+SP_EXPORT f64 getPSNR(
+    const u8* ImageBufferA, const u8* ImageBufferB, u32 PixelCount, const EBlockCompressionFormats Format
+);
+
+} // /namespace BlockCompression
+
+
+/**
+The block compression cache stores compressed images on the disk. The cache files are addressed
+by a hash of the image content, its size, pixel format, block compression format and encoder quality.
+Thus an image which has already been compressed once (e.g. in a previous run of the application) is only read from the cache.
+The cache can be used by several threads at once.
+\note The cache directory must already exist.
+\see RenderSystem::setTextureCompressionCache
+\since Version 3.3
+*/
+class SP_EXPORT BlockCompressionCache
+{
+    
+    public:
+        
+        BlockCompressionCache(const io::stringc &Path);
+        ~BlockCompressionCache();
+        
+        /* === Functions === */
+        
+        /**
+        Reads the compressed image from the cache or compresses it and writes it into the cache.
+        \param BlockBuffer: Specifies the output buffer. It is resized to the compressed image size.
+        \see BlockCompression::compressImage
+        */
+        bool compressImage(
+            const u8* ImageBuffer, const dim::size2di &Size, const EPixelFormats PixelFormat,
+            const EBlockCompressionFormats Format, std::vector<u8> &BlockBuffer,
+            const EBlockCompressionQualities Quality = BLOCKQUALITY_NORMAL, u32 ThreadCount = 0
+        );
+        
+        /* === Inline functions === */
+        
+        //! Returns the cache directory path.
+        inline const io::stringc& getPath() const
+        {
+            return Path_;
+        }
+        
+        //! Returns the count of images which have been read from the cache.
+        inline u32 getNumHits() const
+        {
+            return NumHits_;
+        }
+        //! Returns the count of images which have been compressed because they were not in the cache.
+        inline u32 getNumMisses() const
+        {
+            return NumMisses_;
+        }
+        
+    private:
+        
+        /* === Structures === */
+        
+        struct SHeader
+        {
+            u32 Magic;
+            u32 Version;
+            u64 Hash;
+            s32 Width;
+            s32 Height;
+            s32 PixelFormat;
+            s32 Format;
+            s32 Quality;
+            s32 Reserved;
+        };
+        
+        /* === Functions === */
+        
+        bool readCacheFile(const io::stringc &Filename, const SHeader &Header, std::vector<u8> &BlockBuffer) const;
+        void writeCacheFile(const io::stringc &Filename, const SHeader &Header, const std::vector<u8> &BlockBuffer) const;
+        
+        /* === Members === */
+        
+        io::stringc Path_;
+        
+        CriticalSection Mutex_; //!< Guards the statistics.
+        
+        u32 NumHits_;
+        u32 NumMisses_;
+        
+};
+
+
+} // /namespace video
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
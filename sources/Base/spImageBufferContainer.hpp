@@ -184,6 +184,24 @@ template <typename T, s32 DefVal> class ImageBufferContainer : public ImageBuffe
             MemoryManager::deleteBuffer(Buffer_);
         }
         
+        /**
+        Takes over the specified raw buffer instead of copying it (e.g. the buffer of an image loader).
+        \param Buffer: Specifies the raw buffer. It must have been allocated with "new T[]" and must hold at least
+        "Size.getArea() * Depth * getFormatSize(Format)" elements. After the call this pointer is null.
+        */
+        void adoptBuffer(const EPixelFormats Format, const dim::size2di &Size, u32 Depth, T* &Buffer)
+        {
+            deleteBuffer();
+            
+            Format_     = Format;
+            FormatSize_ = ImageBuffer::getFormatSize(Format);
+            Size_       = Size;
+            Depth_      = math::Max(static_cast<u32>(1), Depth);
+            
+            Buffer_ = Buffer;
+            Buffer  = 0;
+        }
+        
     protected:
         
         ImageBufferContainer(const EImageBufferTypes Type) :
@@ -134,8 +134,8 @@ s32 FilePhysical::readBuffer(void* Buffer, u32 Size, u32 Count) const
         return -1;
     }
     
-    /* Return count of read bytes */
-    return static_cast<s32>(Count * Size);
+    /* Return count of read bytes (which is less than requested at the end of the file) */
+    return static_cast<s32>(Stream_.gcount());
 }
 
 void FilePhysical::setSeek(s32 Pos, const EFileSeekTypes PosType)
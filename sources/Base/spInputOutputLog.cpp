@@ -70,6 +70,9 @@ struct SLogState
 static SLogState LogState;
 static std::map<std::string, bool> UniqueMessages;
 
+/* Messages of worker threads are recorded and printed later by the main thread */
+static SP_THREAD_LOCAL std::vector<SLogMessage>* RecordedMessages = 0;
+
 
 /*
  * Functions
@@ -116,6 +119,12 @@ SP_EXPORT void debug(const stringc &ProcName, const stringc &Message, s32 Flags)
 
 SP_EXPORT void message(const stringc &Message, s32 Flags)
 {
+    if (RecordedMessages)
+    {
+        RecordedMessages->push_back(SLogMessage(Message, Flags));
+        return;
+    }
+    
     /* Check if message is unique */
     if ((Flags & LOG_UNIQUE) != 0 && !checkUniqueMessage(Message))
         return;
@@ -153,6 +162,12 @@ SP_EXPORT void message(const stringc &Message, s32 Flags)
 
 SP_EXPORT void message(const stringc &Message, s32 Flags)
 {
+    if (RecordedMessages)
+    {
+        RecordedMessages->push_back(SLogMessage(Message, Flags));
+        return;
+    }
+    
     /* Check if message is unique */
     if ((Flags & LOG_UNIQUE) != 0 && !checkUniqueMessage(Message))
         return;
@@ -260,10 +275,16 @@ SP_EXPORT stringc getCurrentTab()
 
 SP_EXPORT void upperTab()
 {
+    if (RecordedMessages)
+        return;
+    
     LogState.Tab += LogState.TabString;
 }
 SP_EXPORT void lowerTab()
 {
+    if (RecordedMessages)
+        return;
+    
     const s32 Len = static_cast<s32>(LogState.Tab.size()) - LogState.TabString.size();
     if (Len <= 0)
         LogState.Tab = "";
@@ -330,6 +351,21 @@ SP_EXPORT void pause(bool isPaused)
     }
 }
 
+SP_EXPORT void startRecording(std::vector<SLogMessage> &Messages)
+{
+    RecordedMessages = &Messages;
+}
+SP_EXPORT void stopRecording()
+{
+    RecordedMessages = 0;
+}
+
+SP_EXPORT void printRecord(const std::vector<SLogMessage> &Messages)
+{
+    for (std::vector<SLogMessage>::const_iterator it = Messages.begin(); it != Messages.end(); ++it)
+        message(it->Message, it->Flags);
+}
+
 #if defined(SP_PLATFORM_WINDOWS)
 
 SP_EXPORT void openConsole(const stringc &Title)
@@ -15,6 +15,7 @@
 #include "Base/spMaterialColor.hpp"
 
 #include <fstream>
+#include <vector>
 #include <string.h>
 #include <boost/function.hpp>
 
@@ -70,6 +71,24 @@ static stringc DEF_DEBUGLOG_FILE = "spDebugLog.txt";
 #endif
 
 
+//! Log message which has been recorded by a worker thread. \see Log::startRecording
+struct SLogMessage
+{
+    SLogMessage(const stringc &InitMessage, s32 InitFlags) :
+        Message (InitMessage),
+        Flags   (InitFlags  )
+    {
+    }
+    ~SLogMessage()
+    {
+    }
+    
+    /* Members */
+    stringc Message;
+    s32 Flags;
+};
+
+
 //! Log class has been changed to an own namespace. The syntax remains the same but now you can use "using namespace io::Log;".
 namespace Log
 {
@@ -133,6 +152,18 @@ SP_EXPORT void close();
 //! Opens or closes the output stream temporarily.
 SP_EXPORT void pause(bool isPaused);
 
+/**
+Starts recording the log messages of the calling thread. While recording the messages are not printed but
+stored in the specified container and the tab functions have no effect. Worker threads use this to hand their
+messages over to the main thread, which prints them with "printRecord".
+\param Messages: Specifies the container which receives the messages. It must be valid until "stopRecording" is called.
+*/
+SP_EXPORT void startRecording(std::vector<SLogMessage> &Messages);
+//! Stops recording the log messages of the calling thread. \see startRecording
+SP_EXPORT void stopRecording();
+//! Prints the specified recorded messages. \see startRecording
+SP_EXPORT void printRecord(const std::vector<SLogMessage> &Messages);
+
 SP_EXPORT void openConsole(const stringc &Title = "");
 SP_EXPORT void closeConsole();
 SP_EXPORT void clearConsole();
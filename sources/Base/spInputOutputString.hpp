@@ -684,6 +684,78 @@ template <typename T> class string
             return unicode;
         }
         
+        /**
+        Decodes the UTF-8 encoded character at the specified position.
+        Invalid sequences (e.g. truncated or overlong sequences and surrogates) are decoded as U+FFFD.
+        \param Pos: Specifies the byte position. This will be moved to the first byte of the next character.
+        \return Unicode code point of the decoded character or 0 if the position is out of range.
+        \since Version 3.3
+        */
+        u32 decodeUTF8(u32 &Pos) const
+        {
+            const u32 Len = Str_.size();
+            
+            if (Pos >= Len)
+                return 0;
+            
+            const u32 Lead = static_cast<u8>(Str_[Pos++]);
+            
+            if (Lead < 0x80)
+                return Lead;
+            
+            /* Get sequence length from the lead byte */
+            u32 Count = 0, Char = 0, MinChar = 0;
+            
+            if ((Lead & 0xE0) == 0xC0)
+            {
+                Count   = 1;
+                Char    = (Lead & 0x1F);
+                MinChar = 0x80;
+            }
+            else if ((Lead & 0xF0) == 0xE0)
+            {
+                Count   = 2;
+                Char    = (Lead & 0x0F);
+                MinChar = 0x800;
+            }
+            else if ((Lead & 0xF8) == 0xF0)
+            {
+                Count   = 3;
+                Char    = (Lead & 0x07);
+                MinChar = 0x10000;
+            }
+            else
+                return 0xFFFD;
+            
+            /* Decode continuation bytes */
+            for (; Count > 0; --Count, ++Pos)
+            {
+                if (Pos >= Len || (static_cast<u8>(Str_[Pos]) & 0xC0) != 0x80)
+                    return 0xFFFD;
+                Char = (Char << 6) | (static_cast<u8>(Str_[Pos]) & 0x3F);
+            }
+            
+            if (Char < MinChar || Char > 0x10FFFF || (Char >= 0xD800 && Char <= 0xDFFF))
+                return 0xFFFD;
+            
+            return Char;
+        }
+        
+        /**
+        Returns the count of UTF-8 encoded characters (code points) in this string.
+        \see decodeUTF8
+        \since Version 3.3
+        */
+        u32 lengthUTF8() const
+        {
+            u32 Count = 0;
+            
+            for (u32 Pos = 0; Pos < Str_.size(); ++Count)
+                decodeUTF8(Pos);
+            
+            return Count;
+        }
+        
     private:
         
         /* Members */
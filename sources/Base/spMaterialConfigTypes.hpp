@@ -122,6 +122,8 @@ enum ETextureGenFlags
     TEXGEN_WRAP_W,          //!< W wrap mode (Z axis). Same values as TEXGEN_WRAP.
     
     TEXGEN_ANISOTROPY,      //!< Anisotropy of the anisotropic MIP mapping filter. Use a power of two value (2, 4, 8, 16 etc.).
+    
+    TEXGEN_COMPRESSION,     //!< Hardware texture block compression. Use a value of the EBlockCompressionFormats enumeration. \since Version 3.3
 };
 
 //! Graphics hardware vendor IDs
@@ -355,6 +357,8 @@ enum EVideoFeatureSupport
     VIDEOSUPPORT_CUBEMAP_ARRAY,             //!< Query if cubmap texture arrays are supported.
     VIDEOSUPPORT_TEXTURE_BUFFER,            //!< Query if texture buffers are supported.
     VIDEOSUPPORT_SHADER_RESOURCE,           //!< Query if shader resources are supported.
+    VIDEOSUPPORT_TEXTURE_COMPRESSION,       //!< Query if BC1 and BC3 (S3TC) block compressed textures are supported. \since Version 3.3
+    VIDEOSUPPORT_TEXTURE_COMPRESSION_RG,    //!< Query if BC5 (RGTC) block compressed textures are supported. \since Version 3.3
     
     /* Shader support */
     VIDEOSUPPORT_SHADER,                    //!< Query if shaders are generally supported (shader programs, GLSL or HLSL).
@@ -85,6 +85,19 @@ SP_EXPORT f32 updateEloNumber(f32 Ra, f32 Rb, f32 Sa, const f32 k)
     return std::max(0.0f, Ra + k * (Sa - E));
 }
 
+SP_EXPORT u64 getHash(const void* Buffer, u32 Size, u64 Hash)
+{
+    const u8* ByteBuffer = static_cast<const u8*>(Buffer);
+    
+    for (u32 i = 0; i < Size; ++i)
+    {
+        Hash ^= ByteBuffer[i];
+        Hash *= 1099511628211ull;
+    }
+    
+    return Hash;
+}
+
 
 } // /namespace math
 
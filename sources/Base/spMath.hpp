@@ -244,6 +244,15 @@ has made lots of games and higher values if player A has made less games.
 */
 SP_EXPORT f32 updateEloNumber(f32 Ra, f32 Rb, f32 Sa, const f32 k = 0.1f);
 
+/**
+Computes the 64 bit FNV-1a hash of the specified buffer. This is used for the keys of the file caches.
+\param[in] Buffer Specifies the data which is to be hashed.
+\param[in] Size Specifies the buffer size (in bytes).
+\param[in] Hash Specifies the previous hash value. Use this to combine several buffers into one hash.
+\since Version 3.3
+*/
+SP_EXPORT u64 getHash(const void* Buffer, u32 Size, u64 Hash = 14695981039346656037ull);
+
 
 /* === Other math functions === */
 
@@ -11,6 +11,7 @@
 #include "RenderSystem/spRenderSystem.hpp"
 #include "RenderSystem/spTextureLayerStandard.hpp"
 #include "RenderSystem/spTextureLayerRelief.hpp"
+#include "Base/spProfiler.hpp"
 
 #include <boost/foreach.hpp>
 
@@ -31,6 +32,8 @@ namespace video
 const c8* DEB_ERR_LAYER_RANGE = "Texture layer index out of range";
 const c8* DEB_ERR_LAYER_INCMP = "Texture layer type incompatible";
 
+static SP_THREAD_LOCAL bool DeferredUpload = false;
+
 
 /*
  * Internal structures
@@ -425,13 +428,19 @@ void MeshBuffer::clearBackup()
 
 void MeshBuffer::createVertexBuffer()
 {
-    if (!VertexBuffer_.Reference)
+    if (!VertexBuffer_.Reference && !DeferredUpload)
+    {
         GlbRenderSys->createVertexBuffer(VertexBuffer_.Reference);
+        SP_PROFILE_COUNTER(io::PROFILERCOUNTER_ALLOCATIONS, 1);
+    }
 }
 void MeshBuffer::createIndexBuffer()
 {
-    if (!IndexBuffer_.Reference)
+    if (!IndexBuffer_.Reference && !DeferredUpload)
+    {
         GlbRenderSys->createIndexBuffer(IndexBuffer_.Reference);
+        SP_PROFILE_COUNTER(io::PROFILERCOUNTER_ALLOCATIONS, 1);
+    }
 }
 void MeshBuffer::createMeshBuffer()
 {
@@ -469,6 +478,7 @@ void MeshBuffer::updateVertexBuffer()
             VertexBuffer_.Reference, VertexBuffer_.RawBuffer, VertexFormat_, VertexBuffer_.Usage
         );
         VertexBuffer_.Validated = true;
+        SP_PROFILE_COUNTER(io::PROFILERCOUNTER_BUFFER_UPLOADS, 1);
     }
 }
 void MeshBuffer::updateIndexBuffer()
@@ -479,6 +489,7 @@ void MeshBuffer::updateIndexBuffer()
             IndexBuffer_.Reference, IndexBuffer_.RawBuffer, &IndexFormat_, IndexBuffer_.Usage
         );
         IndexBuffer_.Validated = true;
+        SP_PROFILE_COUNTER(io::PROFILERCOUNTER_BUFFER_UPLOADS, 1);
     }
 }
 void MeshBuffer::updateMeshBuffer()
@@ -489,11 +500,33 @@ void MeshBuffer::updateMeshBuffer()
 
 void MeshBuffer::updateVertexBufferElement(u32 Index)
 {
+    if (DeferredUpload)
+        return;
     GlbRenderSys->updateVertexBufferElement(VertexBuffer_.Reference, VertexBuffer_.RawBuffer, Index);
+    SP_PROFILE_COUNTER(io::PROFILERCOUNTER_BUFFER_UPLOADS, 1);
+}
+void MeshBuffer::updateVertexBufferRange(u32 First, u32 Count)
+{
+    if (DeferredUpload || !Count)
+        return;
+    GlbRenderSys->updateVertexBufferRange(VertexBuffer_.Reference, VertexBuffer_.RawBuffer, First, Count);
+    SP_PROFILE_COUNTER(io::PROFILERCOUNTER_BUFFER_UPLOADS, 1);
 }
 void MeshBuffer::updateIndexBufferElement(u32 Index)
 {
+    if (DeferredUpload)
+        return;
     GlbRenderSys->updateIndexBufferElement(IndexBuffer_.Reference, IndexBuffer_.RawBuffer, Index);
+    SP_PROFILE_COUNTER(io::PROFILERCOUNTER_BUFFER_UPLOADS, 1);
+}
+
+void MeshBuffer::setDeferredUpload(bool Enable)
+{
+    DeferredUpload = Enable;
+}
+bool MeshBuffer::getDeferredUpload()
+{
+    return DeferredUpload;
 }
 
 void MeshBuffer::setPrimitiveType(const ERenderPrimitives Type)
@@ -1494,6 +1527,24 @@ void MeshBuffer::meshFlip(bool isXAxis, bool isYAxis, bool isZAxis)
     scene::MeshModifier::meshFlip(*this, isXAxis, isYAxis, isZAxis);
 }
 
+SMeshOptimizationStats MeshBuffer::optimizeForVertexCache(u32 CacheSize, bool OptimizeOverdraw)
+{
+    SMeshOptimizationStats Stats;
+    
+    const s32 Flags = MESHOPTIMIZE_VERTEX_CACHE | (OptimizeOverdraw ? MESHOPTIMIZE_OVERDRAW : 0);
+    
+    if (MeshBufferOptimizer::optimizeMeshBuffer(*this, Flags, CacheSize, &Stats))
+        updateIndexBuffer();
+    
+    return Stats;
+}
+
+void MeshBuffer::optimizeVertexFetch()
+{
+    if (MeshBufferOptimizer::optimizeMeshBuffer(*this, MESHOPTIMIZE_VERTEX_FETCH))
+        updateMeshBuffer();
+}
+
 void MeshBuffer::seperateTriangles()
 {
     if (!UseIndexBuffer_)
@@ -16,6 +16,7 @@
 #include "Base/spVertexFormat.hpp"
 #include "Base/spIndexFormat.hpp"
 #include "Base/spMathTriangleCutter.hpp"
+#include "Base/spMeshBufferOptimizer.hpp"
 #include "RenderSystem/spTextureLayer.hpp"
 
 #include <vector>
@@ -119,9 +120,26 @@ class SP_EXPORT MeshBuffer
         
         //! Updates the hardware vertex buffer only for the specified element.
         void updateVertexBufferElement(u32 Index);
+        /**
+        Updates the hardware vertex buffer only for the specified range of elements.
+        The hardware buffer must already be large enough, i.e. use "updateVertexBuffer" after adding vertices.
+        \since Version 3.3
+        */
+        void updateVertexBufferRange(u32 First, u32 Count);
         //! Updates the hardware index buffer only for the specified element.
         void updateIndexBufferElement(u32 Index);
         
+        /**
+        Enables or disables the deferred hardware buffer upload for the calling thread. While it is enabled,
+        the "create..." and "update..." functions of all mesh buffers do nothing on this thread. Then the
+        thread can build mesh buffers without accessing the render system. This is used by the worker threads of the
+        scene::AsyncMeshLoader. Afterwards call "createMeshBuffer" and "updateMeshBuffer" on the render thread.
+        \since Version 3.3
+        */
+        static void setDeferredUpload(bool Enable);
+        //! Returns true if the deferred hardware buffer upload is enabled for the calling thread. \since Version 3.3
+        static bool getDeferredUpload();
+        
         /**
         Sets the primitive type. By default PRIMITIVE_TRIANGLES. There are some types which are only supported
         by OpenGL which are: PRIMITIVE_LINE_LOOP, PRIMITIVE_QUADS, PRIMITIVE_QUAD_STRIP and PRIMITIVE_POLYGON.
@@ -499,6 +517,29 @@ class SP_EXPORT MeshBuffer
         */
         void seperateTriangles();
         
+        /**
+        Reorders the triangles for the GPU's post-transform vertex cache and optionally sorts the triangle clusters
+        to reduce overdraw. The hardware index buffer is updated afterwards.
+        \param CacheSize: Specifies the vertex cache size. By default 16.
+        \param OptimizeOverdraw: Specifies whether the triangle clusters are to be sorted to reduce overdraw. By default true.
+        \return Vertex cache statistics before and after the optimization.
+        \note Can only be used for triangle lists with enabled index buffer.
+        \see MeshBufferOptimizer
+        \since Version 3.3
+        */
+        SMeshOptimizationStats optimizeForVertexCache(
+            u32 CacheSize = MeshBufferOptimizer::DEF_VERTEX_CACHE_SIZE, bool OptimizeOverdraw = true
+        );
+        
+        /**
+        Reorders the vertices in the order of their first use by the indices, so that the vertex fetch reads the memory
+        mostly sequentially. Call this after "optimizeForVertexCache". The hardware buffers are updated afterwards.
+        \note Don't use this for meshes with morph target or skeletal animations, since these animations refer to the vertex indices.
+        \see MeshBufferOptimizer
+        \since Version 3.3
+        */
+        void optimizeVertexFetch();
+        
         /**
         Paints each vertex with the specified color.
         \param Color: Specifies the color which is to be painted.
@@ -745,6 +786,15 @@ class SP_EXPORT MeshBuffer
         {
             return VertexBuffer_.RawBuffer;
         }
+        /**
+        Returns the vertex buffer for direct modification. Use this for dynamic mesh buffers which
+        write many vertices each frame (e.g. particle systems). Call "updateVertexBuffer" afterwards.
+        \note The vertex data must match the vertex format.
+        */
+        inline dim::UniversalBuffer& getVertexBuffer()
+        {
+            return VertexBuffer_.RawBuffer;
+        }
         //! Returns the index buffer.
         inline const dim::UniversalBuffer& getIndexBuffer() const
         {
@@ -0,0 +1,604 @@
+/*
+ * Mesh buffer optimizer file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "Base/spMeshBufferOptimizer.hpp"
+#include "Base/spMeshBuffer.hpp"
+#include "Base/spInputOutputLog.hpp"
+#include "Base/spCriticalSection.hpp"
+#include "Base/spThreadPool.hpp"
+#include "Base/spTimer.hpp"
+#include "Base/spMath.hpp"
+
+#include <boost/foreach.hpp>
+#include <algorithm>
+
+
+namespace sp
+{
+namespace video
+{
+
+namespace MeshBufferOptimizer
+{
+
+
+/*
+ * Internal structures
+ */
+
+struct SMeshOptimizationThreadData
+{
+    const std::vector<MeshBuffer*>* Surfaces;
+    std::vector<SMeshOptimizationStats>* Stats;
+    std::vector<bool>* Results;
+    s32 Flags;
+    u32 CacheSize;
+    u32* NextSurface;
+    CriticalSection* Mutex;
+};
+
+struct SCluster
+{
+    u32 FirstTriangle;
+    u32 NumTriangles;
+    f32 Occlusion;
+};
+
+
+/*
+ * Internal functions
+ */
+
+//! Returns the count of vertex cache misses for a FIFO cache.
+static u32 getCacheMisses(const std::vector<u32> &Indices, u32 NumVertices, u32 CacheSize)
+{
+    /* Each vertex stores the time when it was pushed into the cache */
+    std::vector<u32> CacheTime(NumVertices, 0);
+    
+    u32 Time = CacheSize + 1;
+    u32 NumMisses = 0;
+    
+    foreach (u32 Index, Indices)
+    {
+        if (Time - CacheTime[Index] > CacheSize)
+        {
+            CacheTime[Index] = Time++;
+            ++NumMisses;
+        }
+    }
+    
+    return NumMisses;
+}
+
+static bool areIndicesValid(const std::vector<u32> &Indices, u32 NumVertices)
+{
+    foreach (u32 Index, Indices)
+    {
+        if (Index >= NumVertices)
+            return false;
+    }
+    return true;
+}
+
+static s32 skipDeadEnd(
+    const std::vector<u32> &LiveTriangles, std::vector<u32> &DeadEndStack, u32 &Cursor, u32 NumVertices)
+{
+    /* Restart with the most recently used vertex which still has live triangles */
+    while (!DeadEndStack.empty())
+    {
+        const u32 Vertex = DeadEndStack.back();
+        DeadEndStack.pop_back();
+        
+        if (LiveTriangles[Vertex] > 0)
+            return static_cast<s32>(Vertex);
+    }
+    
+    /* Otherwise continue with the next vertex in input order */
+    for (; Cursor < NumVertices; ++Cursor)
+    {
+        if (LiveTriangles[Cursor] > 0)
+            return static_cast<s32>(Cursor);
+    }
+    
+    return -1;
+}
+
+static s32 getNextVertex(
+    const std::vector<u32> &Candidates, const std::vector<u32> &LiveTriangles, const std::vector<u32> &CacheTime,
+    u32 Time, u32 CacheSize)
+{
+    s32 BestVertex = -1;
+    s32 BestPriority = -1;
+    
+    foreach (u32 Vertex, Candidates)
+    {
+        if (LiveTriangles[Vertex] == 0)
+            continue;
+        
+        /* Prefer the oldest vertex which will still be in the cache after its remaining triangles have been emitted */
+        s32 Priority = 0;
+        
+        if (Time - CacheTime[Vertex] + 2*LiveTriangles[Vertex] <= CacheSize)
+            Priority = static_cast<s32>(Time - CacheTime[Vertex]);
+        
+        if (Priority > BestPriority)
+        {
+            BestPriority    = Priority;
+            BestVertex      = static_cast<s32>(Vertex);
+        }
+    }
+    
+    return BestVertex;
+}
+
+static bool compareClusters(const SCluster &A, const SCluster &B)
+{
+    return A.Occlusion > B.Occlusion;
+}
+
+static void readIndices(const MeshBuffer &Surface, std::vector<u32> &Indices)
+{
+    const u32 NumIndices = Surface.getIndexCount();
+    
+    Indices.resize(NumIndices);
+    
+    for (u32 i = 0; i < NumIndices; ++i)
+        Indices[i] = Surface.getPrimitiveIndex(i);
+}
+
+static void writeIndices(MeshBuffer &Surface, const std::vector<u32> &Indices)
+{
+    for (u32 i = 0, n = Indices.size(); i < n; ++i)
+        Surface.setPrimitiveIndex(i, Indices[i]);
+}
+
+static void optimizeSurfaceList(SMeshOptimizationThreadData &Data)
+{
+    while (1)
+    {
+        /* Fetch the next mesh buffer */
+        u32 Index = 0;
+        
+        if (Data.Mutex)
+        {
+            Data.Mutex->lock();
+            Index = (*Data.NextSurface)++;
+            Data.Mutex->unlock();
+        }
+        else
+            Index = (*Data.NextSurface)++;
+        
+        if (Index >= Data.Surfaces->size())
+            break;
+        
+        /* Optimize the mesh buffer (each thread writes only to its own entries) */
+        SMeshOptimizationStats Stats;
+        const bool Result = optimizeMeshBuffer(*(*Data.Surfaces)[Index], Data.Flags, Data.CacheSize, &Stats);
+        
+        if (Data.Mutex)
+            Data.Mutex->lock();
+        
+        (*Data.Stats)[Index] = Stats;
+        (*Data.Results)[Index] = Result;
+        
+        if (Data.Mutex)
+            Data.Mutex->unlock();
+    }
+}
+
+static void MeshOptimizationTaskProc(u32 /*Index*/, void* UserData)
+{
+    optimizeSurfaceList(*reinterpret_cast<SMeshOptimizationThreadData*>(UserData));
+}
+
+
+/*
+ * Global functions
+ */
+
+SP_EXPORT f32 getACMR(const std::vector<u32> &Indices, u32 NumVertices, u32 CacheSize)
+{
+    if (Indices.size() < 3 || !areIndicesValid(Indices, NumVertices))
+        return 0.0f;
+    
+    const u32 NumMisses = getCacheMisses(Indices, NumVertices, CacheSize);
+    
+    return static_cast<f32>(NumMisses) / (Indices.size() / 3);
+}
+
+SP_EXPORT f32 getATVR(const std::vector<u32> &Indices, u32 NumVertices, u32 CacheSize)
+{
+    if (Indices.empty() || !areIndicesValid(Indices, NumVertices))
+        return 0.0f;
+    
+    /* Count the referenced vertices */
+    std::vector<bool> isReferenced(NumVertices, false);
+    u32 NumReferenced = 0;
+    
+    foreach (u32 Index, Indices)
+    {
+        if (!isReferenced[Index])
+        {
+            isReferenced[Index] = true;
+            ++NumReferenced;
+        }
+    }
+    
+    const u32 NumMisses = getCacheMisses(Indices, NumVertices, CacheSize);
+    
+    return static_cast<f32>(NumMisses) / NumReferenced;
+}
+
+SP_EXPORT void optimizeTriangleOrder(
+    std::vector<u32> &Indices, u32 NumVertices, u32 CacheSize, std::vector<u32>* Clusters)
+{
+    const u32 NumTriangles = Indices.size() / 3;
+    
+    if (Clusters)
+        Clusters->clear();
+    
+    if (!NumTriangles || !areIndicesValid(Indices, NumVertices))
+        return;
+    
+    /* Build the vertex-triangle adjacency */
+    std::vector<u32> LiveTriangles(NumVertices, 0);
+    
+    for (u32 i = 0; i < NumTriangles*3; ++i)
+        ++LiveTriangles[Indices[i]];
+    
+    std::vector<u32> AdjacencyOffsets(NumVertices + 1, 0);
+    
+    for (u32 v = 0; v < NumVertices; ++v)
+        AdjacencyOffsets[v + 1] = AdjacencyOffsets[v] + LiveTriangles[v];
+    
+    std::vector<u32> Adjacency(NumTriangles*3);
+    std::vector<u32> AdjacencyFill(AdjacencyOffsets.begin(), AdjacencyOffsets.end() - 1);
+    
+    for (u32 i = 0; i < NumTriangles*3; ++i)
+        Adjacency[AdjacencyFill[Indices[i]]++] = i / 3;
+    
+    /* Fan around the fanning vertex and continue with a vertex in the cache */
+    std::vector<u32> CacheTime(NumVertices, 0);
+    std::vector<bool> isEmitted(NumTriangles, false);
+    std::vector<u32> DeadEndStack;
+    std::vector<u32> Candidates;
+    
+    std::vector<u32> OutIndices;
+    OutIndices.reserve(NumTriangles*3);
+    
+    u32 Time = CacheSize + 1;
+    u32 Cursor = 0;
+    
+    s32 Vertex = skipDeadEnd(LiveTriangles, DeadEndStack, Cursor, NumVertices);
+    bool isNewCluster = true;
+    
+    while (Vertex >= 0)
+    {
+        if (isNewCluster && Clusters)
+            Clusters->push_back(OutIndices.size() / 3);
+        
+        Candidates.clear();
+        
+        for (u32 i = AdjacencyOffsets[Vertex], n = AdjacencyOffsets[Vertex + 1]; i < n; ++i)
+        {
+            const u32 Triangle = Adjacency[i];
+            
+            if (isEmitted[Triangle])
+                continue;
+            
+            for (u32 j = 0; j < 3; ++j)
+            {
+                const u32 TriVertex = Indices[Triangle*3 + j];
+                
+                OutIndices.push_back(TriVertex);
+                DeadEndStack.push_back(TriVertex);
+                Candidates.push_back(TriVertex);
+                
+                --LiveTriangles[TriVertex];
+                
+                if (Time - CacheTime[TriVertex] > CacheSize)
+                    CacheTime[TriVertex] = Time++;
+            }
+            
+            isEmitted[Triangle] = true;
+        }
+        
+        Vertex = getNextVertex(Candidates, LiveTriangles, CacheTime, Time, CacheSize);
+        isNewCluster = (Vertex < 0);
+        
+        if (isNewCluster)
+            Vertex = skipDeadEnd(LiveTriangles, DeadEndStack, Cursor, NumVertices);
+    }
+    
+    /* Keep the incomplete triangle at the end (if any) */
+    OutIndices.insert(OutIndices.end(), Indices.begin() + NumTriangles*3, Indices.end());
+    
+    Indices.swap(OutIndices);
+}
+
+SP_EXPORT void optimizeOverdraw(
+    std::vector<u32> &Indices, const std::vector<dim::vector3df> &Coords, const std::vector<u32> &Clusters)
+{
+    const u32 NumTriangles = Indices.size() / 3;
+    
+    if (Clusters.size() < 2 || !areIndicesValid(Indices, Coords.size()))
+        return;
+    
+    /* Compute the mesh's center */
+    dim::vector3df MeshCenter;
+    f32 MeshArea = 0.0f;
+    
+    std::vector<SCluster> ClusterList(Clusters.size());
+    
+    for (u32 c = 0; c < Clusters.size(); ++c)
+    {
+        SCluster &Cluster = ClusterList[c];
+        
+        Cluster.FirstTriangle   = Clusters[c];
+        Cluster.NumTriangles    = (c + 1 < Clusters.size() ? Clusters[c + 1] : NumTriangles) - Clusters[c];
+        Cluster.Occlusion       = 0.0f;
+    }
+    
+    for (u32 t = 0; t < NumTriangles; ++t)
+    {
+        const dim::vector3df &A = Coords[Indices[t*3    ]];
+        const dim::vector3df &B = Coords[Indices[t*3 + 1]];
+        const dim::vector3df &C = Coords[Indices[t*3 + 2]];
+        
+        const f32 Area = (B - A).cross(C - A).getLength();
+        
+        MeshCenter += (A + B + C) * (Area / 3.0f);
+        MeshArea += Area;
+    }
+    
+    if (MeshArea <= math::ROUNDING_ERROR)
+        return;
+    
+    MeshCenter /= MeshArea;
+    
+    /* Compute the occlusion measure of each cluster: dot(ClusterCenter - MeshCenter, ClusterNormal) */
+    foreach (SCluster &Cluster, ClusterList)
+    {
+        dim::vector3df Center, Normal;
+        f32 Area = 0.0f;
+        
+        for (u32 t = Cluster.FirstTriangle, n = Cluster.FirstTriangle + Cluster.NumTriangles; t < n; ++t)
+        {
+            const dim::vector3df &A = Coords[Indices[t*3    ]];
+            const dim::vector3df &B = Coords[Indices[t*3 + 1]];
+            const dim::vector3df &C = Coords[Indices[t*3 + 2]];
+            
+            const dim::vector3df AreaNormal((B - A).cross(C - A));
+            const f32 TriArea = AreaNormal.getLength();
+            
+            Center += (A + B + C) * (TriArea / 3.0f);
+            Normal += AreaNormal;
+            Area += TriArea;
+        }
+        
+        if (Area > math::ROUNDING_ERROR)
+        {
+            Center /= Area;
+            Normal.normalize();
+            Cluster.Occlusion = (Center - MeshCenter).dot(Normal);
+        }
+    }
+    
+    /* Draw the outer clusters first */
+    std::stable_sort(ClusterList.begin(), ClusterList.end(), compareClusters);
+    
+    std::vector<u32> OutIndices;
+    OutIndices.reserve(Indices.size());
+    
+    foreach (const SCluster &Cluster, ClusterList)
+    {
+        OutIndices.insert(
+            OutIndices.end(),
+            Indices.begin() + Cluster.FirstTriangle*3,
+            Indices.begin() + (Cluster.FirstTriangle + Cluster.NumTriangles)*3
+        );
+    }
+    
+    OutIndices.insert(OutIndices.end(), Indices.begin() + NumTriangles*3, Indices.end());
+    
+    Indices.swap(OutIndices);
+}
+
+SP_EXPORT u32 optimizeVertexFetch(std::vector<u32> &Indices, u32 NumVertices, std::vector<u32> &Remap)
+{
+    static const u32 UNUSED = ~0u;
+    
+    Remap.assign(NumVertices, UNUSED);
+    
+    if (!areIndicesValid(Indices, NumVertices))
+    {
+        for (u32 i = 0; i < NumVertices; ++i)
+            Remap[i] = i;
+        return NumVertices;
+    }
+    
+    /* Assign the new indices in the order of the first use */
+    u32 NumReferenced = 0;
+    
+    foreach (u32 &Index, Indices)
+    {
+        if (Remap[Index] == UNUSED)
+            Remap[Index] = NumReferenced++;
+        Index = Remap[Index];
+    }
+    
+    /* Move the unused vertices to the end */
+    u32 NextIndex = NumReferenced;
+    
+    foreach (u32 &NewIndex, Remap)
+    {
+        if (NewIndex == UNUSED)
+            NewIndex = NextIndex++;
+    }
+    
+    return NumReferenced;
+}
+
+SP_EXPORT bool optimizeMeshBuffer(MeshBuffer &Surface, s32 Flags, u32 CacheSize, SMeshOptimizationStats* Stats)
+{
+    if ( Surface.getReference() != &Surface || !Surface.getIndexBufferEnable() ||
+         Surface.getPrimitiveType() != PRIMITIVE_TRIANGLES || Surface.getIndexCount() < 3 )
+    {
+        return false;
+    }
+    
+    const u32 NumVertices = Surface.getVertexCount();
+    
+    std::vector<u32> Indices;
+    readIndices(Surface, Indices);
+    
+    if (!areIndicesValid(Indices, NumVertices))
+        return false;
+    
+    if (Stats)
+    {
+        Stats->NumTriangles = Indices.size() / 3;
+        Stats->ACMRBefore   = getACMR(Indices, NumVertices, CacheSize);
+        Stats->ATVRBefore   = getATVR(Indices, NumVertices, CacheSize);
+    }
+    
+    /* Reorder the triangles */
+    if (Flags & MESHOPTIMIZE_VERTEX_CACHE)
+    {
+        std::vector<u32> Clusters;
+        optimizeTriangleOrder(Indices, NumVertices, CacheSize, (Flags & MESHOPTIMIZE_OVERDRAW) ? &Clusters : 0);
+        
+        if (Flags & MESHOPTIMIZE_OVERDRAW)
+        {
+            std::vector<dim::vector3df> Coords(NumVertices);
+            
+            for (u32 i = 0; i < NumVertices; ++i)
+                Coords[i] = Surface.getVertexCoord(i);
+            
+            optimizeOverdraw(Indices, Coords, Clusters);
+        }
+    }
+    
+    /* Reorder the vertices */
+    if ((Flags & MESHOPTIMIZE_VERTEX_FETCH) && NumVertices > 0)
+    {
+        std::vector<u32> Remap;
+        optimizeVertexFetch(Indices, NumVertices, Remap);
+        
+        dim::UniversalBuffer &Vertices = Surface.getVertexBuffer();
+        const u32 Stride = Vertices.getStride();
+        
+        std::vector<s8> OutVertices(Vertices.getSize());
+        
+        for (u32 i = 0; i < NumVertices; ++i)
+            memcpy(&OutVertices[Remap[i] * Stride], Vertices.getArray(i, 0), Stride);
+        
+        Vertices.getContainer().swap(OutVertices);
+    }
+    
+    writeIndices(Surface, Indices);
+    
+    if (Stats)
+    {
+        Stats->ACMRAfter = getACMR(Indices, NumVertices, CacheSize);
+        Stats->ATVRAfter = getATVR(Indices, NumVertices, CacheSize);
+    }
+    
+    return true;
+}
+
+SP_EXPORT SMeshOptimizationStats optimizeMeshBuffers(
+    const std::vector<MeshBuffer*> &Surfaces, s32 Flags, u32 CacheSize, u32 ThreadCount)
+{
+    SMeshOptimizationStats TotalStats;
+    
+    if (Surfaces.empty())
+        return TotalStats;
+    
+    io::Timer Clock(true);
+    Clock.resetClockCounter();
+    
+    /* Distribute the mesh buffers over the tasks of the shared thread pool */
+    if (!ThreadCount)
+        ThreadCount = ThreadPool::getShared()->getThreadCount() + 1;
+    
+    ThreadCount = math::MinMax(ThreadCount, 1u, static_cast<u32>(Surfaces.size()));
+    
+    std::vector<SMeshOptimizationStats> Stats(Surfaces.size());
+    std::vector<bool> Results(Surfaces.size(), false);
+    
+    u32 NextSurface = 0;
+    CriticalSection Mutex;
+    
+    SMeshOptimizationThreadData Data;
+    {
+        Data.Surfaces           = (&Surfaces);
+        Data.Stats              = (&Stats);
+        Data.Results            = (&Results);
+        Data.Flags              = Flags;
+        Data.CacheSize          = CacheSize;
+        Data.NextSurface        = (&NextSurface);
+        Data.Mutex              = (ThreadCount > 1 ? &Mutex : 0);
+    }
+    
+    /* Each task fetches mesh buffers until all are done (this thread takes part in the work as well) */
+    if (ThreadCount > 1)
+        ThreadPool::getShared()->run(MeshOptimizationTaskProc, &Data, ThreadCount);
+    else
+        optimizeSurfaceList(Data);
+    
+    /* Update the hardware buffers on this thread and summarize the statistics (weighted by the triangle count) */
+    u32 NumOptimized = 0;
+    
+    for (u32 i = 0; i < Surfaces.size(); ++i)
+    {
+        if (!Results[i])
+            continue;
+        
+        Surfaces[i]->updateMeshBuffer();
+        
+        const f32 Weight = static_cast<f32>(Stats[i].NumTriangles);
+        
+        TotalStats.NumTriangles += Stats[i].NumTriangles;
+        TotalStats.ACMRBefore   += Stats[i].ACMRBefore * Weight;
+        TotalStats.ACMRAfter    += Stats[i].ACMRAfter  * Weight;
+        TotalStats.ATVRBefore   += Stats[i].ATVRBefore * Weight;
+        TotalStats.ATVRAfter    += Stats[i].ATVRAfter  * Weight;
+        
+        ++NumOptimized;
+    }
+    
+    if (TotalStats.NumTriangles > 0)
+    {
+        const f32 InvNumTriangles = 1.0f / TotalStats.NumTriangles;
+        
+        TotalStats.ACMRBefore   *= InvNumTriangles;
+        TotalStats.ACMRAfter    *= InvNumTriangles;
+        TotalStats.ATVRBefore   *= InvNumTriangles;
+        TotalStats.ATVRAfter    *= InvNumTriangles;
+    }
+    
+    io::Log::message(
+        "Optimized " + io::stringc(NumOptimized) + " mesh buffer(s) with " + io::stringc(TotalStats.NumTriangles) +
+        " triangles in " + io::stringc(Clock.getElapsedMicroseconds() / 1000) + " ms: ACMR " +
+        io::stringc(TotalStats.ACMRBefore) + " -> " + io::stringc(TotalStats.ACMRAfter) + ", ATVR " +
+        io::stringc(TotalStats.ATVRBefore) + " -> " + io::stringc(TotalStats.ATVRAfter)
+    );
+    
+    return TotalStats;
+}
+
+
+} // /namespace MeshBufferOptimizer
+
+} // /namespace video
+
+} // /namespace sp
+
+
+
+// ================================================================================
@@ -0,0 +1,168 @@
+/*
+ * Mesh buffer optimizer header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_MESHBUFFER_OPTIMIZER_H__
+#define __SP_MESHBUFFER_OPTIMIZER_H__
+
+
+#include "Base/spStandard.hpp"
+#include "Base/spDimensionVector3D.hpp"
+
+#include <vector>
+
+
+namespace sp
+{
+namespace video
+{
+
+
+class MeshBuffer;
+
+//! Mesh buffer optimization flags. \see MeshBufferOptimizer
+enum EMeshOptimizationFlags
+{
+    MESHOPTIMIZE_VERTEX_CACHE   = 0x01, //!< Reorders the triangles for the post-transform vertex cache.
+    MESHOPTIMIZE_OVERDRAW       = 0x02, //!< Sorts the triangle clusters of the vertex cache optimization to reduce overdraw. Requires MESHOPTIMIZE_VERTEX_CACHE.
+    MESHOPTIMIZE_VERTEX_FETCH   = 0x04, //!< Reorders the vertices in the order of their first use. Don't use this for animated meshes, since the animations refer to the vertex indices.
+    
+    MESHOPTIMIZE_ALL            = MESHOPTIMIZE_VERTEX_CACHE | MESHOPTIMIZE_OVERDRAW | MESHOPTIMIZE_VERTEX_FETCH,
+};
+
+
+//! Vertex cache statistics of a mesh buffer optimization. \see MeshBufferOptimizer
+struct SP_EXPORT SMeshOptimizationStats
+{
+    SMeshOptimizationStats() :
+        NumTriangles(0      ),
+        ACMRBefore  (0.0f   ),
+        ACMRAfter   (0.0f   ),
+        ATVRBefore  (0.0f   ),
+        ATVRAfter   (0.0f   )
+    {
+    }
+    ~SMeshOptimizationStats()
+    {
+    }
+    
+    /* Members */
+    u32 NumTriangles;   //!< Count of triangles.
+    f32 ACMRBefore;     //!< Average cache miss ratio (vertex shader invocations per triangle) before the optimization.
+    f32 ACMRAfter;      //!< Average cache miss ratio after the optimization. The optimum is 0.5 for large regular meshes.
+    f32 ATVRBefore;     //!< Average transform to vertex ratio (vertex shader invocations per vertex) before the optimization.
+    f32 ATVRAfter;      //!< Average transform to vertex ratio after the optimization. The optimum is 1.0.
+};
+
+
+/**
+MeshBufferOptimizer namespace with the index and vertex reordering for the GPU's post-transform vertex cache and the vertex fetch.
+The triangle order is optimized with the linear-time "Tipsify" algorithm (Sander, Nehab and Barczak: "Fast Triangle Reordering
+for Vertex Locality and Reduced Overdraw"). The triangle clusters between the cache flushes of this algorithm are afterwards
+sorted by a view-independent occlusion measure, so that outer parts of the mesh are drawn first.
+\note All functions, except "optimizeMeshBuffers", only modify the CPU data of the mesh buffers,
+thus they can be used on worker threads. Call "MeshBuffer::updateMeshBuffer" afterwards.
+\see MeshBuffer::optimizeForVertexCache
+\see MeshBuffer::optimizeVertexFetch
+\since Version 3.3
+*/
+namespace MeshBufferOptimizer
+{
+
+//! Default vertex cache size for the optimization. This is smaller than the cache of most GPUs to stay close to the optimum on all of them.
+static const u32 DEF_VERTEX_CACHE_SIZE = 16;
+
+/**
+Computes the average cache miss ratio (ACMR) of the specified triangle list, i.e. the average count of vertex shader invocations
+per triangle, for a FIFO vertex cache with the specified size.
+\param Indices: Specifies the triangle list indices.
+\param NumVertices: Specifies the count of vertices. All indices must be less than this value.
+\param CacheSize: Specifies the simulated vertex cache size.
+*/
+SP_EXPORT f32 getACMR(const std::vector<u32> &Indices, u32 NumVertices, u32 CacheSize = DEF_VERTEX_CACHE_SIZE);
+
+/**
+Computes the average transform to vertex ratio (ATVR) of the specified triangle list, i.e. the count of vertex shader invocations
+divided by the count of referenced vertices. In contrast to the ACMR this measure does not depend on the mesh topology.
+\see getACMR
+*/
+SP_EXPORT f32 getATVR(const std::vector<u32> &Indices, u32 NumVertices, u32 CacheSize = DEF_VERTEX_CACHE_SIZE);
+
+/**
+Reorders the triangles for the post-transform vertex cache.
+\param Indices: Specifies the triangle list indices which are to be reordered.
+\param NumVertices: Specifies the count of vertices.
+\param CacheSize: Specifies the vertex cache size.
+\param Clusters: Optional output list which receives the index of the first triangle of each cluster. A new cluster begins where
+the algorithm had to restart at a dead end, i.e. where the vertex cache is flushed anyway. So the clusters can be reordered
+without a significant loss of vertex cache efficiency.
+*/
+SP_EXPORT void optimizeTriangleOrder(
+    std::vector<u32> &Indices, u32 NumVertices, u32 CacheSize = DEF_VERTEX_CACHE_SIZE, std::vector<u32>* Clusters = 0
+);
+
+/**
+Reorders the triangle clusters to reduce overdraw. Clusters which face away from the mesh's center are drawn first.
+\param Indices: Specifies the triangle list indices which are to be reordered.
+\param Coords: Specifies the vertex coordinates.
+\param Clusters: Specifies the index of the first triangle of each cluster (see optimizeTriangleOrder).
+*/
+SP_EXPORT void optimizeOverdraw(
+    std::vector<u32> &Indices, const std::vector<dim::vector3df> &Coords, const std::vector<u32> &Clusters
+);
+
+/**
+Reorders the vertices in the order of their first use by the indices, so that the vertex fetch reads the memory
+mostly sequentially. Vertices which are not referenced by any index are moved to the end.
+\param Indices: Specifies the indices which are to be remapped.
+\param NumVertices: Specifies the count of vertices.
+\param[out] Remap: Receives the new index for each old vertex index.
+\return Count of referenced vertices.
+*/
+SP_EXPORT u32 optimizeVertexFetch(std::vector<u32> &Indices, u32 NumVertices, std::vector<u32> &Remap);
+
+/**
+Optimizes the CPU data of the specified mesh buffer. The hardware buffers are not updated.
+Mesh buffers without index buffer or with other primitives than triangles are not modified.
+\param Surface: Specifies the mesh buffer. Reference mesh buffers must be optimized via their reference.
+\param Flags: Specifies the optimizations. This can be a combination of the EMeshOptimizationFlags enumeration values.
+\param CacheSize: Specifies the vertex cache size.
+\param Stats: Optional output statistics.
+\return True if the mesh buffer has been optimized.
+*/
+SP_EXPORT bool optimizeMeshBuffer(
+    MeshBuffer &Surface, s32 Flags = MESHOPTIMIZE_ALL, u32 CacheSize = DEF_VERTEX_CACHE_SIZE,
+    SMeshOptimizationStats* Stats = 0
+);
+
+/**
+Optimizes the specified mesh buffers on several worker threads and updates their hardware buffers afterwards.
+The vertex cache statistics before and after the optimization are written to the log.
+\param Surfaces: Specifies the mesh buffers. Each mesh buffer must be contained only once.
+\param Flags: Specifies the optimizations. This can be a combination of the EMeshOptimizationFlags enumeration values.
+\param CacheSize: Specifies the vertex cache size.
+\param ThreadCount: Specifies the count of tasks which optimize the mesh buffers on the shared thread pool.
+By default 0 which means one task per processor. \see ThreadPool::getShared
+\return Summarized statistics of all optimized mesh buffers.
+*/
+SP_EXPORT SMeshOptimizationStats optimizeMeshBuffers(
+    const std::vector<MeshBuffer*> &Surfaces, s32 Flags = MESHOPTIMIZE_ALL,
+    u32 CacheSize = DEF_VERTEX_CACHE_SIZE, u32 ThreadCount = 0
+);
+
+} // /namespace MeshBufferOptimizer
+
+
+} // /namespace video
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
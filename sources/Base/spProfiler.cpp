@@ -0,0 +1,685 @@
+/*
+ * Profiler file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "Base/spProfiler.hpp"
+#include "Base/spCriticalSection.hpp"
+#include "Base/spInputOutputFileSystem.hpp"
+#include "Base/spInputOutputLog.hpp"
+#include "Base/spTimer.hpp"
+#include "Base/spMath.hpp"
+#include "RenderSystem/spRenderSystem.hpp"
+
+#include <boost/foreach.hpp>
+#include <algorithm>
+#include <string.h>
+
+#if defined(SP_PLATFORM_WINDOWS)
+#   include <windows.h>
+#elif defined(SP_PLATFORM_LINUX)
+#   include <sys/time.h>
+#endif
+
+
+namespace sp
+{
+
+extern video::RenderSystem* GlbRenderSys;
+
+namespace io
+{
+
+
+/*
+ * Internal structures
+ */
+
+//! Event ring buffer of one thread. The thread is the only producer and "Profiler::nextFrame" the only consumer.
+struct SProfilerThread
+{
+    static const u32 CAPACITY = 4096;
+    
+    SProfilerThread(u32 ThreadIndex) :
+        Index           (ThreadIndex),
+        ReadPos         (0          ),
+        WritePos        (0          ),
+        NumDropped      (0          ),
+        NumReported     (0          ),
+        Depth           (0          ),
+        isFree          (false      )
+    {
+    }
+    ~SProfilerThread()
+    {
+    }
+    
+    /* Members */
+    u32 Index;
+    
+    SProfilerEvent Events[CAPACITY];
+    
+    /* Both positions increase continuously and are only masked when the buffer is accessed */
+    volatile u32 ReadPos;
+    volatile u32 WritePos;
+    
+    volatile u32 NumDropped;    //!< Written by the producer.
+    u32 NumReported;            //!< Dropped events which have already been reported (only used by the consumer).
+    
+    /* Open scopes (only used by the producer) */
+    u32 Depth;
+    const c8* ScopeNames[Profiler::MAX_DEPTH];
+    u64 ScopeBeginTimes[Profiler::MAX_DEPTH];
+    
+    bool isFree;                //!< The thread has been released and the ring buffer can be reused (guarded by the mutex).
+};
+
+struct SProfilerScopeStats
+{
+    const c8* Name;
+    u64 Duration;
+    u32 NumCalls;
+};
+
+
+/*
+ * Internal members
+ */
+
+static SP_THREAD_LOCAL SProfilerThread* ProfilerThreadData = 0;
+static SP_THREAD_LOCAL bool ProfilerThreadOverflow = false;
+
+static SProfilerThread* ProfilerThreads[Profiler::MAX_THREADS] = { 0 };
+static volatile u32 NumProfilerThreads = 0;
+static CriticalSection ProfilerThreadMutex;
+
+static volatile u32 ProfilerCounters[PROFILERCOUNTER_COUNT] = { 0 };
+static volatile u32 NumOverflowEvents = 0;
+
+static std::list<SProfilerFrame> ProfilerFrameHistory;
+static u32 ProfilerHistorySize = 60;
+static u32 ProfilerFrameIndex = 0;
+
+static const SProfilerFrame ProfilerEmptyFrame;
+
+
+/*
+ * Internal functions
+ */
+
+static inline void memoryBarrier()
+{
+    #if defined(SP_COMPILER_VC)
+    MemoryBarrier();
+    #else
+    __sync_synchronize();
+    #endif
+}
+
+static inline void atomicAdd(volatile u32* Value, u32 Count)
+{
+    #if defined(SP_COMPILER_VC)
+    InterlockedExchangeAdd(reinterpret_cast<volatile LONG*>(Value), static_cast<LONG>(Count));
+    #else
+    __sync_fetch_and_add(Value, Count);
+    #endif
+}
+
+static inline u32 atomicExchange(volatile u32* Value, u32 NewValue)
+{
+    #if defined(SP_COMPILER_VC)
+    return static_cast<u32>(InterlockedExchange(reinterpret_cast<volatile LONG*>(Value), static_cast<LONG>(NewValue)));
+    #else
+    return __sync_lock_test_and_set(Value, NewValue);
+    #endif
+}
+
+static u64 getSystemMicroseconds()
+{
+    #if defined(SP_PLATFORM_WINDOWS)
+    
+    static LARGE_INTEGER Frequency = { 0 };
+    
+    if (!Frequency.QuadPart)
+        QueryPerformanceFrequency(&Frequency);
+    
+    LARGE_INTEGER Counter;
+    QueryPerformanceCounter(&Counter);
+    
+    /* Split the conversion to avoid an overflow */
+    const u64 Ticks = static_cast<u64>(Counter.QuadPart);
+    const u64 Freq = static_cast<u64>(Frequency.QuadPart);
+    
+    return (Ticks / Freq) * 1000000 + (Ticks % Freq) * 1000000 / Freq;
+    
+    #elif defined(SP_PLATFORM_LINUX)
+    
+    timeval Time;
+    gettimeofday(&Time, 0);
+    return static_cast<u64>(Time.tv_sec) * 1000000 + static_cast<u64>(Time.tv_usec);
+    
+    #else
+    
+    return Timer::millisecs() * 1000;
+    
+    #endif
+}
+
+static const u64 ProfilerStartTime = getSystemMicroseconds();
+
+static inline u64 getProfilerTime()
+{
+    return getSystemMicroseconds() - ProfilerStartTime;
+}
+
+static u64 ProfilerFrameBeginTime = 0;
+
+static SProfilerThread* getProfilerThread()
+{
+    if (ProfilerThreadData || ProfilerThreadOverflow)
+        return ProfilerThreadData;
+    
+    /* Register the calling thread */
+    ProfilerThreadMutex.lock();
+    {
+        /* Reuse the ring buffer of a released thread (its remaining events are still collected) */
+        for (u32 i = 0; i < NumProfilerThreads && !ProfilerThreadData; ++i)
+        {
+            if (ProfilerThreads[i]->isFree)
+            {
+                ProfilerThreadData = ProfilerThreads[i];
+                ProfilerThreadData->isFree = false;
+            }
+        }
+        
+        /* Otherwise create a new ring buffer */
+        if (!ProfilerThreadData)
+        {
+            if (NumProfilerThreads < Profiler::MAX_THREADS)
+            {
+                ProfilerThreadData = new SProfilerThread(NumProfilerThreads);
+                ProfilerThreads[NumProfilerThreads] = ProfilerThreadData;
+                
+                /* Publish the thread only after it has been stored */
+                memoryBarrier();
+                ++NumProfilerThreads;
+            }
+            else
+                ProfilerThreadOverflow = true;
+        }
+    }
+    ProfilerThreadMutex.unlock();
+    
+    return ProfilerThreadData;
+}
+
+static void collectEvents(SProfilerFrame* Frame)
+{
+    const u32 NumThreads = NumProfilerThreads;
+    memoryBarrier();
+    
+    for (u32 i = 0; i < NumThreads; ++i)
+    {
+        SProfilerThread* Thread = ProfilerThreads[i];
+        
+        const u32 ReadPos = Thread->ReadPos;
+        const u32 WritePos = Thread->WritePos;
+        
+        /* Don't read the events before the producer has written them */
+        memoryBarrier();
+        
+        if (Frame)
+        {
+            for (u32 Pos = ReadPos; Pos != WritePos; ++Pos)
+                Frame->Events.push_back(Thread->Events[Pos & (SProfilerThread::CAPACITY - 1)]);
+            
+            const u32 NumDropped = Thread->NumDropped;
+            Frame->NumDroppedEvents += NumDropped - Thread->NumReported;
+            Thread->NumReported = NumDropped;
+        }
+        else
+            Thread->NumReported = Thread->NumDropped;
+        
+        /* Release the space only after the events have been copied */
+        memoryBarrier();
+        
+        Thread->ReadPos = WritePos;
+    }
+    
+    const u32 NumOverflow = atomicExchange(&NumOverflowEvents, 0);
+    
+    if (Frame)
+        Frame->NumDroppedEvents += NumOverflow;
+}
+
+static bool compareEvents(const SProfilerEvent &EventA, const SProfilerEvent &EventB)
+{
+    if (EventA.ThreadIndex != EventB.ThreadIndex)
+        return EventA.ThreadIndex < EventB.ThreadIndex;
+    return EventA.BeginTime < EventB.BeginTime;
+}
+
+static bool compareScopeStats(const SProfilerScopeStats &StatsA, const SProfilerScopeStats &StatsB)
+{
+    return StatsA.Duration > StatsB.Duration;
+}
+
+static io::stringc getJSONString(const c8* Str)
+{
+    io::stringc Result("\"");
+    
+    for (; *Str; ++Str)
+    {
+        if (*Str == '\"' || *Str == '\\')
+            Result += "\\";
+        Result += io::stringc(*Str);
+    }
+    
+    return Result + "\"";
+}
+
+static video::color getScopeColor(const c8* Name)
+{
+    /* Hash the name, so that each scope keeps its color in every frame */
+    u32 Hash = 2166136261u;
+    
+    for (; *Name; ++Name)
+        Hash = (Hash ^ static_cast<u8>(*Name)) * 16777619u;
+    
+    return video::color(
+        96 + (Hash & 0x7F), 96 + ((Hash >> 8) & 0x7F), 96 + ((Hash >> 16) & 0x7F), 220
+    );
+}
+
+
+/*
+ * SProfilerFrame structure
+ */
+
+SProfilerFrame::SProfilerFrame() :
+    Index           (0),
+    BeginTime       (0),
+    EndTime         (0),
+    NumDroppedEvents(0)
+{
+    memset(Counters, 0, sizeof(Counters));
+}
+SProfilerFrame::~SProfilerFrame()
+{
+}
+
+
+/*
+ * Profiler class
+ */
+
+volatile bool Profiler::isEnabled_ = false;
+
+void Profiler::setEnabled(bool Enable)
+{
+    if (isEnabled_ != Enable)
+    {
+        isEnabled_ = Enable;
+        
+        /* The current frame begins now */
+        ProfilerFrameBeginTime = getProfilerTime();
+    }
+}
+
+void Profiler::setHistorySize(u32 NumFrames)
+{
+    ProfilerHistorySize = math::Max(1u, NumFrames);
+    
+    while (ProfilerFrameHistory.size() > ProfilerHistorySize)
+        ProfilerFrameHistory.pop_front();
+}
+u32 Profiler::getHistorySize()
+{
+    return ProfilerHistorySize;
+}
+
+void Profiler::nextFrame()
+{
+    const u64 Time = getProfilerTime();
+    
+    /* Reset the counters in any case */
+    u32 Counters[PROFILERCOUNTER_COUNT];
+    
+    for (u32 i = 0; i < PROFILERCOUNTER_COUNT; ++i)
+        Counters[i] = atomicExchange(&ProfilerCounters[i], 0);
+    
+    if (isEnabled_)
+    {
+        ProfilerFrameHistory.push_back(SProfilerFrame());
+        SProfilerFrame& Frame = ProfilerFrameHistory.back();
+        
+        Frame.Index     = ProfilerFrameIndex;
+        Frame.BeginTime = ProfilerFrameBeginTime;
+        Frame.EndTime   = Time;
+        
+        memcpy(Frame.Counters, Counters, sizeof(Counters));
+        
+        /* The render system counts its queries itself (they are reset after this call) */
+        Frame.Counters[PROFILERCOUNTER_DRAW_CALLS]      += video::RenderSystem::getNumDrawCalls();
+        Frame.Counters[PROFILERCOUNTER_STATE_CHANGES]   += video::RenderSystem::getNumStateChanges();
+        
+        collectEvents(&Frame);
+        std::sort(Frame.Events.begin(), Frame.Events.end(), compareEvents);
+        
+        while (ProfilerFrameHistory.size() > ProfilerHistorySize)
+            ProfilerFrameHistory.pop_front();
+    }
+    else
+        collectEvents(0);
+    
+    ProfilerFrameBeginTime = Time;
+    ++ProfilerFrameIndex;
+}
+
+void Profiler::clearHistory()
+{
+    ProfilerFrameHistory.clear();
+}
+
+void Profiler::beginScope(const c8* Name)
+{
+    SProfilerThread* Thread = getProfilerThread();
+    
+    if (!Thread)
+        return;
+    
+    if (Thread->Depth < MAX_DEPTH)
+    {
+        Thread->ScopeNames[Thread->Depth] = Name;
+        Thread->ScopeBeginTimes[Thread->Depth] = getProfilerTime();
+    }
+    
+    ++Thread->Depth;
+}
+
+void Profiler::endScope()
+{
+    SProfilerThread* Thread = ProfilerThreadData;
+    
+    if (!Thread)
+    {
+        if (ProfilerThreadOverflow)
+            atomicAdd(&NumOverflowEvents, 1);
+        return;
+    }
+    
+    if (!Thread->Depth || --Thread->Depth >= MAX_DEPTH)
+        return;
+    
+    const u32 WritePos = Thread->WritePos;
+    const u32 ReadPos = Thread->ReadPos;
+    
+    /* Don't overwrite the events before the consumer has read them */
+    memoryBarrier();
+    
+    if (WritePos - ReadPos >= SProfilerThread::CAPACITY)
+    {
+        Thread->NumDropped = Thread->NumDropped + 1;
+        return;
+    }
+    
+    SProfilerEvent& Event = Thread->Events[WritePos & (SProfilerThread::CAPACITY - 1)];
+    {
+        Event.Name          = Thread->ScopeNames[Thread->Depth];
+        Event.BeginTime     = Thread->ScopeBeginTimes[Thread->Depth];
+        Event.EndTime       = getProfilerTime();
+        Event.ThreadIndex   = Thread->Index;
+        Event.Depth         = Thread->Depth;
+    }
+    
+    /* Publish the event only after it has been written */
+    memoryBarrier();
+    Thread->WritePos = WritePos + 1;
+}
+
+void Profiler::releaseThread()
+{
+    SProfilerThread* Thread = ProfilerThreadData;
+    
+    if (Thread)
+    {
+        /* Scopes which are still open are discarded */
+        Thread->Depth = 0;
+        
+        ProfilerThreadMutex.lock();
+        Thread->isFree = true;
+        ProfilerThreadMutex.unlock();
+        
+        ProfilerThreadData = 0;
+    }
+    
+    ProfilerThreadOverflow = false;
+}
+
+void Profiler::addCounter(const EProfilerCounters Type, u32 Count)
+{
+    if (isEnabled_ && Type < PROFILERCOUNTER_COUNT)
+        atomicAdd(&ProfilerCounters[Type], Count);
+}
+
+const SProfilerFrame& Profiler::getLastFrame()
+{
+    return ProfilerFrameHistory.empty() ? ProfilerEmptyFrame : ProfilerFrameHistory.back();
+}
+
+const std::list<SProfilerFrame>& Profiler::getFrameHistory()
+{
+    return ProfilerFrameHistory;
+}
+
+bool Profiler::exportChromeTrace(const io::stringc &Filename)
+{
+    io::FileSystem FileSys;
+    io::File* TraceFile = FileSys.openFile(Filename, io::FILE_WRITE);
+    
+    if (!TraceFile)
+    {
+        io::Log::error("Could not write profiler trace file \"" + Filename + "\"");
+        return false;
+    }
+    
+    TraceFile->writeString("{\"traceEvents\":[\n");
+    
+    /* Write thread names */
+    const u32 NumThreads = NumProfilerThreads;
+    
+    for (u32 i = 0; i < NumThreads; ++i)
+    {
+        TraceFile->writeString(
+            "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + io::stringc(i) +
+            ",\"args\":{\"name\":\"Thread " + io::stringc(i) + "\"}},\n"
+        );
+    }
+    
+    foreach (const SProfilerFrame &Frame, ProfilerFrameHistory)
+    {
+        /* Write frame marker and counters */
+        TraceFile->writeString(
+            "{\"name\":\"Frame " + io::stringc(Frame.Index) + "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":" +
+            io::stringc(Frame.BeginTime) + "},\n"
+        );
+        TraceFile->writeString(
+            "{\"name\":\"Counters\",\"ph\":\"C\",\"pid\":1,\"ts\":" + io::stringc(Frame.BeginTime) +
+            ",\"args\":{\"DrawCalls\":" + io::stringc(Frame.Counters[PROFILERCOUNTER_DRAW_CALLS]) +
+            ",\"StateChanges\":" + io::stringc(Frame.Counters[PROFILERCOUNTER_STATE_CHANGES]) +
+            ",\"BufferUploads\":" + io::stringc(Frame.Counters[PROFILERCOUNTER_BUFFER_UPLOADS]) +
+            ",\"Allocations\":" + io::stringc(Frame.Counters[PROFILERCOUNTER_ALLOCATIONS]) + "}},\n"
+        );
+        
+        /* Write scope events */
+        foreach (const SProfilerEvent &Event, Frame.Events)
+        {
+            TraceFile->writeString(
+                "{\"name\":" + getJSONString(Event.Name) + ",\"ph\":\"X\",\"pid\":1,\"tid\":" + io::stringc(Event.ThreadIndex) +
+                ",\"ts\":" + io::stringc(Event.BeginTime) + ",\"dur\":" + io::stringc(Event.EndTime - Event.BeginTime) + "},\n"
+            );
+        }
+    }
+    
+    /* Close the event array with a final frame marker, so that no trailing comma remains */
+    TraceFile->writeString(
+        "{\"name\":\"End\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":" + io::stringc(getLastFrame().EndTime) + "}\n"
+    );
+    TraceFile->writeString("]}\n");
+    
+    FileSys.closeFile(TraceFile);
+    
+    return true;
+}
+
+void Profiler::drawOverlay(const video::Font* FontObject, const dim::point2di &Position)
+{
+    if (!GlbRenderSys)
+        return;
+    
+    static const s32 WIDTH          = 400;
+    static const s32 BAR_HEIGHT     = 6;
+    static const u32 MAX_BAR_DEPTH  = 8;
+    static const u32 MAX_SCOPES     = 10;
+    
+    const SProfilerFrame& Frame = getLastFrame();
+    const u64 Duration = math::Max<u64>(1, Frame.getDuration());
+    
+    /* Determine the nesting depth of each thread */
+    std::vector<u32> ThreadDepths;
+    
+    foreach (const SProfilerEvent &Event, Frame.Events)
+    {
+        if (Event.ThreadIndex >= ThreadDepths.size())
+            ThreadDepths.resize(Event.ThreadIndex + 1, 0);
+        ThreadDepths[Event.ThreadIndex] = math::Max(ThreadDepths[Event.ThreadIndex], math::Min(Event.Depth + 1, MAX_BAR_DEPTH));
+    }
+    
+    /* Summarize the scopes by their names */
+    std::vector<SProfilerScopeStats> ScopeStats;
+    
+    foreach (const SProfilerEvent &Event, Frame.Events)
+    {
+        std::vector<SProfilerScopeStats>::iterator it = ScopeStats.begin();
+        
+        for (; it != ScopeStats.end(); ++it)
+        {
+            if (it->Name == Event.Name || !strcmp(it->Name, Event.Name))
+                break;
+        }
+        
+        if (it == ScopeStats.end())
+        {
+            SProfilerScopeStats Stats;
+            {
+                Stats.Name      = Event.Name;
+                Stats.Duration  = 0;
+                Stats.NumCalls  = 0;
+            }
+            ScopeStats.push_back(Stats);
+            it = ScopeStats.end() - 1;
+        }
+        
+        it->Duration += Event.EndTime - Event.BeginTime;
+        ++it->NumCalls;
+    }
+    
+    std::sort(ScopeStats.begin(), ScopeStats.end(), compareScopeStats);
+    
+    if (ScopeStats.size() > MAX_SCOPES)
+        ScopeStats.resize(MAX_SCOPES);
+    
+    /* Compute the overlay size */
+    const s32 LineHeight = (FontObject ? FontObject->getHeight() + 2 : 0);
+    
+    s32 Height = 10;
+    
+    foreach (u32 Depth, ThreadDepths)
+        Height += Depth * BAR_HEIGHT + 4;
+    
+    if (FontObject)
+        Height += LineHeight * (2 + ScopeStats.size());
+    
+    GlbRenderSys->beginDrawing2D();
+    {
+        GlbRenderSys->draw2DRectangle(
+            dim::rect2di(Position.X, Position.Y, Position.X + WIDTH + 10, Position.Y + Height), video::color(0, 0, 0, 160)
+        );
+        
+        s32 PosY = Position.Y + 5;
+        
+        /* Draw the frame information */
+        if (FontObject)
+        {
+            GlbRenderSys->draw2DText(
+                FontObject, dim::point2di(Position.X + 5, PosY),
+                "Frame " + io::stringc(Frame.Index) + ": " + io::stringc::numberFloat(static_cast<f32>(Frame.getDuration()) / 1000.0f, 2) + " ms" +
+                (Frame.NumDroppedEvents ? ", Dropped Events: " + io::stringc(Frame.NumDroppedEvents) : io::stringc(""))
+            );
+            PosY += LineHeight;
+            
+            GlbRenderSys->draw2DText(
+                FontObject, dim::point2di(Position.X + 5, PosY),
+                "Draw Calls: " + io::stringc(Frame.Counters[PROFILERCOUNTER_DRAW_CALLS]) +
+                ", State Changes: " + io::stringc(Frame.Counters[PROFILERCOUNTER_STATE_CHANGES]) +
+                ", Uploads: " + io::stringc(Frame.Counters[PROFILERCOUNTER_BUFFER_UPLOADS]) +
+                ", Allocations: " + io::stringc(Frame.Counters[PROFILERCOUNTER_ALLOCATIONS])
+            );
+            PosY += LineHeight;
+        }
+        
+        /* Draw the timeline of each thread */
+        std::vector<s32> ThreadPosY(ThreadDepths.size(), 0);
+        
+        for (u32 i = 0; i < ThreadDepths.size(); ++i)
+        {
+            ThreadPosY[i] = PosY;
+            PosY += ThreadDepths[i] * BAR_HEIGHT + 4;
+        }
+        
+        foreach (const SProfilerEvent &Event, Frame.Events)
+        {
+            if (Event.Depth >= MAX_BAR_DEPTH)
+                continue;
+            
+            /* Clamp the events which began in the previous frame */
+            const u64 Begin = math::Max(Event.BeginTime, Frame.BeginTime) - Frame.BeginTime;
+            const u64 End = math::Min(math::Max(Event.EndTime, Frame.BeginTime), Frame.EndTime) - Frame.BeginTime;
+            
+            const s32 Left = Position.X + 5 + static_cast<s32>(Begin * WIDTH / Duration);
+            const s32 Right = Position.X + 5 + static_cast<s32>(End * WIDTH / Duration);
+            const s32 Top = ThreadPosY[Event.ThreadIndex] + Event.Depth * BAR_HEIGHT;
+            
+            GlbRenderSys->draw2DRectangle(
+                dim::rect2di(Left, Top, math::Max(Left + 1, Right), Top + BAR_HEIGHT - 1), getScopeColor(Event.Name)
+            );
+        }
+        
+        /* Draw the most expensive scopes */
+        if (FontObject)
+        {
+            foreach (const SProfilerScopeStats &Stats, ScopeStats)
+            {
+                GlbRenderSys->draw2DText(
+                    FontObject, dim::point2di(Position.X + 5, PosY),
+                    io::stringc(Stats.Name) + ": " + io::stringc::numberFloat(static_cast<f32>(Stats.Duration) / 1000.0f, 2) +
+                    " ms (" + io::stringc(Stats.NumCalls) + "x)",
+                    getScopeColor(Stats.Name)
+                );
+                PosY += LineHeight;
+            }
+        }
+    }
+    GlbRenderSys->endDrawing2D();
+}
+
+
+} // /namespace io
+
+} // /namespace sp
+
+
+
+// ================================================================================
@@ -0,0 +1,247 @@
+/*
+ * Profiler header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_PROFILER_H__
+#define __SP_PROFILER_H__
+
+
+#include "Base/spStandard.hpp"
+#include "Base/spInputOutputString.hpp"
+#include "Base/spDimensionVector2D.hpp"
+
+#include <vector>
+#include <list>
+
+
+namespace sp
+{
+namespace video
+{
+    class Font;
+}
+namespace io
+{
+
+
+/**
+Profiler scope macro. This measures the time until the end of the current block.
+The name must be a string literal (or any other string which lives as long as the profiler).
+When the engine was compiled without the 'SP_COMPILE_WITH_PROFILER' option this macro expands to nothing.
+\code
+void updateWorld()
+{
+    SP_PROFILE_SCOPE("updateWorld");
+    // ...
+}
+\endcode
+\see Profiler
+*/
+#ifdef SP_COMPILE_WITH_PROFILER
+#   define SP_PROFILE_SCOPE(n)              sp::io::ProfilerScope SP_PROFILE_SCOPE_VAR(__LINE__)(n)
+#   define SP_PROFILE_COUNTER(t, c)         sp::io::Profiler::addCounter(t, c)
+#else
+#   define SP_PROFILE_SCOPE(n)
+#   define SP_PROFILE_COUNTER(t, c)
+#endif
+
+#define SP_PROFILE_SCOPE_VAR(l)             SP_PROFILE_SCOPE_VAR_CONCAT(l)
+#define SP_PROFILE_SCOPE_VAR_CONCAT(l)      __spProfileScope##l
+
+
+//! Profiler counters. \see Profiler::addCounter
+enum EProfilerCounters
+{
+    PROFILERCOUNTER_DRAW_CALLS,         //!< Mesh buffer draw calls. Taken from RenderSystem::getNumDrawCalls.
+    PROFILERCOUNTER_STATE_CHANGES,      //!< Issued render state changes. Taken from RenderSystem::getNumStateChanges.
+    PROFILERCOUNTER_BUFFER_UPLOADS,     //!< Vertex-, index buffer and texture uploads.
+    PROFILERCOUNTER_ALLOCATIONS,        //!< Hardware vertex-, index buffer and texture allocations.
+    
+    PROFILERCOUNTER_COUNT,
+};
+
+
+//! Profiler event. This is one measured scope.
+struct SProfilerEvent
+{
+    const c8* Name;     //!< Scope name.
+    u64 BeginTime;      //!< Begin time (in microseconds since the profiler was created).
+    u64 EndTime;        //!< End time (in microseconds since the profiler was created).
+    u32 ThreadIndex;    //!< Index of the thread which measured the scope. The first thread which used the profiler has index 0.
+    u32 Depth;          //!< Nesting depth of the scope (0 for the outermost scope).
+};
+
+//! Profiler frame with all events which have been finished during this frame.
+struct SP_EXPORT SProfilerFrame
+{
+    SProfilerFrame();
+    ~SProfilerFrame();
+    
+    /* === Functions === */
+    
+    //! Returns the frame duration (in microseconds).
+    inline u64 getDuration() const
+    {
+        return EndTime - BeginTime;
+    }
+    
+    /* Members */
+    u32 Index;                              //!< Frame index.
+    u64 BeginTime;                          //!< Frame begin time (in microseconds since the profiler was created).
+    u64 EndTime;                            //!< Frame end time (in microseconds since the profiler was created).
+    u32 Counters[PROFILERCOUNTER_COUNT];    //!< Frame counters. \see EProfilerCounters
+    u32 NumDroppedEvents;                   //!< Count of events which were dropped because a thread's ring buffer was full.
+    std::vector<SProfilerEvent> Events;     //!< Finished events of all threads.
+};
+
+
+/**
+The profiler measures hierarchical CPU scopes and per-frame counters. Each thread writes its events into its own lock-free
+ring buffer, which is created when the thread uses the profiler for the first time. The events are collected on the main thread
+when a new frame begins (this is done in "SoftPixelDevice::updateEvents"). The last frames can be exported to the
+Chrome trace format (open "chrome://tracing" and load the file) or drawn as an overlay.
+\note Use the SP_PROFILE_SCOPE macro instead of calling "beginScope" and "endScope" directly.
+When the profiler is disabled a scope only checks one flag. When the engine was compiled without the
+'SP_COMPILE_WITH_PROFILER' option the scopes are removed completely.
+\note At most MAX_THREADS threads get a ring buffer at the same time. The events of further threads are dropped.
+The ring buffers of finished threads are reused (see "releaseThread").
+\since Version 3.3
+*/
+class SP_EXPORT Profiler
+{
+    
+    public:
+        
+        //! Maximal count of threads which can be profiled.
+        static const u32 MAX_THREADS = 64;
+        //! Maximal nesting depth of scopes. Deeper scopes are not measured.
+        static const u32 MAX_DEPTH = 32;
+        
+        /* === Functions === */
+        
+        /**
+        Enables or disables the profiler. By default disabled.
+        Scopes which are open when the profiler is disabled are finished nevertheless.
+        */
+        static void setEnabled(bool Enable);
+        
+        /**
+        Sets the count of frames which are kept in the history. By default 60.
+        \see getFrameHistory
+        \see exportChromeTrace
+        */
+        static void setHistorySize(u32 NumFrames);
+        static u32 getHistorySize();
+        
+        /**
+        Begins a new frame. This collects the events of all threads and the counters into the previous frame.
+        This is called by "SoftPixelDevice::updateEvents", so you don't need to call it yourself.
+        */
+        static void nextFrame();
+        
+        //! Discards all collected frames.
+        static void clearHistory();
+        
+        /**
+        Begins a new scope on the calling thread.
+        \param Name Specifies the scope name. This pointer is stored in the event, so it must be a string literal
+        (or any other string which lives as long as the profiler).
+        */
+        static void beginScope(const c8* Name);
+        //! Ends the last scope on the calling thread.
+        static void endScope();
+        
+        /**
+        Releases the ring buffer of the calling thread, so it can be reused by another thread. Its pending events are still collected.
+        This is called automatically when a thread of the ThreadManager class exits. Threads which have been created otherwise
+        should call it before they exit.
+        */
+        static void releaseThread();
+        
+        /**
+        Adds the specified value to a counter of the current frame. This can be called from any thread.
+        The draw call and state change counters are taken from the render system at the end of each frame.
+        */
+        static void addCounter(const EProfilerCounters Type, u32 Count = 1);
+        
+        //! Returns the last completed frame.
+        static const SProfilerFrame& getLastFrame();
+        
+        //! Returns the history of the last completed frames (the oldest frame first).
+        static const std::list<SProfilerFrame>& getFrameHistory();
+        
+        /**
+        Exports the frame history to the Chrome trace event format (JSON).
+        \param Filename Specifies the output filename (e.g. "Trace.json").
+        \return True if the file could be written.
+        */
+        static bool exportChromeTrace(const io::stringc &Filename);
+        
+        /**
+        Draws an overlay with the timeline of each thread, the most expensive scopes and the counters of the last frame.
+        \param FontObject Specifies the font for the text. If 0 only the timelines are drawn.
+        \param Position Specifies the upper left corner of the overlay.
+        */
+        static void drawOverlay(const video::Font* FontObject, const dim::point2di &Position = dim::point2di(15, 15));
+        
+        /* === Inline functions === */
+        
+        //! Returns true if the profiler is enabled. By default disabled.
+        static inline bool getEnabled()
+        {
+            return isEnabled_;
+        }
+        
+    private:
+        
+        /* === Members === */
+        
+        static volatile bool isEnabled_;
+        
+};
+
+
+/**
+Profiler scope. The scope begins in the constructor and ends in the destructor.
+\see SP_PROFILE_SCOPE
+\since Version 3.3
+*/
+class ProfilerScope
+{
+    
+    public:
+        
+        inline ProfilerScope(const c8* Name) :
+            isActive_(Profiler::getEnabled())
+        {
+            if (isActive_)
+                Profiler::beginScope(Name);
+        }
+        inline ~ProfilerScope()
+        {
+            if (isActive_)
+                Profiler::endScope();
+        }
+        
+    private:
+        
+        /* === Members === */
+        
+        bool isActive_;
+        
+};
+
+
+} // /namespace io
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,96 @@
+/*
+ * Semaphore file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "Base/spSemaphore.hpp"
+#include "Base/spInputOutputLog.hpp"
+
+
+namespace sp
+{
+
+
+#if defined(SP_PLATFORM_WINDOWS)
+
+Semaphore::Semaphore(u32 InitialCount) :
+    Handle_(0)
+{
+    Handle_ = CreateSemaphore(0, static_cast<LONG>(InitialCount), 0x7FFFFFFF, 0);
+    
+    if (!Handle_)
+        io::Log::error("Could not create semaphore");
+}
+Semaphore::~Semaphore()
+{
+    if (Handle_)
+        CloseHandle(Handle_);
+}
+
+void Semaphore::wait()
+{
+    WaitForSingleObject(Handle_, INFINITE);
+}
+void Semaphore::post(u32 Count)
+{
+    if (Count > 0)
+        ReleaseSemaphore(Handle_, static_cast<LONG>(Count), 0);
+}
+
+#elif defined(SP_PLATFORM_LINUX) || defined(SP_PLATFORM_IOS)
+
+/*
+Unnamed POSIX semaphores are not available on every platform (e.g. iOS),
+so the semaphore is implemented with a mutex and a condition variable.
+*/
+
+Semaphore::Semaphore(u32 InitialCount) :
+    Count_(InitialCount)
+{
+    pthread_mutex_init(&Mutex_, 0);
+    pthread_cond_init(&Condition_, 0);
+}
+Semaphore::~Semaphore()
+{
+    pthread_cond_destroy(&Condition_);
+    pthread_mutex_destroy(&Mutex_);
+}
+
+void Semaphore::wait()
+{
+    pthread_mutex_lock(&Mutex_);
+    
+    while (Count_ == 0)
+        pthread_cond_wait(&Condition_, &Mutex_);
+    --Count_;
+    
+    pthread_mutex_unlock(&Mutex_);
+}
+void Semaphore::post(u32 Count)
+{
+    if (Count == 0)
+        return;
+    
+    /* Signal while the mutex is locked, because a woken thread may delete the semaphore right after its wait */
+    pthread_mutex_lock(&Mutex_);
+    
+    Count_ += Count;
+    
+    if (Count == 1)
+        pthread_cond_signal(&Condition_);
+    else
+        pthread_cond_broadcast(&Condition_);
+    
+    pthread_mutex_unlock(&Mutex_);
+}
+
+#endif
+
+
+} // /namespace sp
+
+
+
+// ================================================================================
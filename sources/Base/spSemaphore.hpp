@@ -0,0 +1,68 @@
+/*
+ * Semaphore header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_SEMAPHORE_H__
+#define __SP_SEMAPHORE_H__
+
+
+#include "Base/spStandard.hpp"
+
+#if defined(SP_PLATFORM_WINDOWS)
+#   include <windows.h>
+#elif defined(SP_PLATFORM_LINUX) || defined(SP_PLATFORM_IOS)
+#   include <pthread.h>
+#endif
+
+
+namespace sp
+{
+
+
+/**
+Counting semaphore class used for multi-threading. In contrast to polling a flag, a thread which waits
+for the semaphore is blocked by the operating system and does not use any CPU time until it is signaled.
+\since Version 3.3
+*/
+class SP_EXPORT Semaphore
+{
+    
+    public:
+        
+        Semaphore(u32 InitialCount = 0);
+        ~Semaphore();
+        
+        /* Functions */
+        
+        //! Waits until the counter is greater than zero and decrements it.
+        void wait();
+        
+        //! Increments the counter by the specified value and wakes up as many waiting threads.
+        void post(u32 Count = 1);
+        
+    private:
+        
+        /* Members */
+        
+        #if defined(SP_PLATFORM_WINDOWS)
+        HANDLE Handle_;
+        #elif defined(SP_PLATFORM_LINUX) || defined(SP_PLATFORM_IOS)
+        pthread_mutex_t Mutex_;
+        pthread_cond_t Condition_;
+        u32 Count_;
+        #endif
+        
+};
+
+
+} // /namepsace sp
+
+
+#endif
+
+
+
+// ================================================================================
@@ -116,6 +116,12 @@
 #   define _USE_MATH_DEFINES
 #endif
 
+#if defined(SP_COMPILER_VC)
+#   define SP_THREAD_LOCAL __declspec(thread)
+#else
+#   define SP_THREAD_LOCAL __thread
+#endif
+
 #ifndef SP_DONT_DEFINE_BOOST_MACROS
 #   define foreach          BOOST_FOREACH
 #   define foreach_reverse  BOOST_REVERSE_FOREACH
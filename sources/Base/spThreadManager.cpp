@@ -7,23 +7,74 @@
 
 #include "Base/spThreadManager.hpp"
 #include "Base/spInputOutputLog.hpp"
+#include "Base/spProfiler.hpp"
 
 
 namespace sp
 {
 
 
+/*
+ * Internal functions
+ */
+
+struct SThreadStartData
+{
+    PFNTHREADPROC ThreadProc;
+    void* Arguments;
+};
+
+static THREAD_PROC(ThreadStartProc)
+{
+    /* Run the thread procedure and release the per-thread resources afterwards */
+    SThreadStartData StartData = *reinterpret_cast<SThreadStartData*>(Arguments);
+    delete reinterpret_cast<SThreadStartData*>(Arguments);
+    
+    #if defined(SP_PLATFORM_WINDOWS)
+    const DWORD Result = StartData.ThreadProc(StartData.Arguments);
+    #else
+    void* Result = StartData.ThreadProc(StartData.Arguments);
+    #endif
+    
+    #ifdef SP_COMPILE_WITH_PROFILER
+    io::Profiler::releaseThread();
+    #endif
+    
+    return Result;
+}
+
+static SThreadStartData* createThreadStartData(PFNTHREADPROC ThreadProc, void* Arguments)
+{
+    SThreadStartData* StartData = new SThreadStartData();
+    {
+        StartData->ThreadProc   = ThreadProc;
+        StartData->Arguments    = Arguments;
+    }
+    return StartData;
+}
+
+
+/*
+ * ThreadManager class
+ */
+
+
 #if defined(SP_PLATFORM_WINDOWS)
 
 ThreadManager::ThreadManager(PFNTHREADPROC ThreadProc, void* Arguments, bool StartImmediately) :
     ThreadHandle_(0)
 {
+    SThreadStartData* StartData = createThreadStartData(ThreadProc, Arguments);
+    
     ThreadHandle_ = CreateThread(
-        0, 0, ThreadProc, Arguments, StartImmediately ? 0 : CREATE_SUSPENDED, 0
+        0, 0, ThreadStartProc, StartData, StartImmediately ? 0 : CREATE_SUSPENDED, 0
     );
     
     if (!ThreadHandle_)
+    {
         io::Log::error("Could not start thread procedure");
+        delete StartData;
+    }
 }
 ThreadManager::~ThreadManager()
 {
@@ -103,8 +154,13 @@ ThreadManager::ThreadManager(PFNTHREADPROC ThreadProc, void* Arguments, bool Sta
     pthread_attr_init(&Attributes);
     pthread_attr_setdetachstate(&Attributes, PTHREAD_CREATE_DETACHED);
     
-    if (pthread_create(&ThreadHandle_, &Attributes, ThreadProc, Arguments))
+    SThreadStartData* StartData = createThreadStartData(ThreadProc, Arguments);
+    
+    if (pthread_create(&ThreadHandle_, &Attributes, ThreadStartProc, StartData))
+    {
         io::Log::error("Could not start thread procedure");
+        delete StartData;
+    }
 }
 ThreadManager::~ThreadManager()
 {
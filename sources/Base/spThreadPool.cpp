@@ -0,0 +1,190 @@
+/*
+ * Thread pool file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "Base/spThreadPool.hpp"
+#include "Base/spInputOutputOSInformator.hpp"
+#include "Base/spMemoryManagement.hpp"
+#include "Base/spMathCore.hpp"
+
+#include <algorithm>
+
+
+namespace sp
+{
+
+extern io::OSInformator* GlbPlatformInfo;
+
+
+/*
+ * Internal members
+ */
+
+static ThreadPool* SharedThreadPool = 0;
+static CriticalSection SharedThreadPoolMutex;
+
+THREAD_PROC(ThreadPoolProc)
+{
+    ThreadPool* Pool = static_cast<ThreadPool*>(Arguments);
+    
+    while (1)
+    {
+        /* Sleep until new tasks are available */
+        Pool->WorkSignal_.wait();
+        
+        if (!Pool->isRunning_)
+            break;
+        
+        while (Pool->processTask(0));
+    }
+    
+    Pool->ExitSignal_.post();
+    
+    return 0;
+}
+
+
+/*
+ * SJob structure
+ */
+
+ThreadPool::SJob::SJob(PFNTHREADPOOLTASKPROC InitTaskProc, void* InitUserData, u32 InitNumTasks) :
+    TaskProc    (InitTaskProc   ),
+    UserData    (InitUserData   ),
+    NumTasks    (InitNumTasks   ),
+    NextTask    (0              ),
+    NumPending  (InitNumTasks   )
+{
+}
+ThreadPool::SJob::~SJob()
+{
+}
+
+
+/*
+ * ThreadPool class
+ */
+
+ThreadPool::ThreadPool(u32 ThreadCount) :
+    isRunning_(true)
+{
+    for (u32 i = 0; i < ThreadCount; ++i)
+        Threads_.push_back(new ThreadManager(ThreadPoolProc, this));
+}
+ThreadPool::~ThreadPool()
+{
+    /* Wake up all workers and wait until they have left their procedure */
+    isRunning_ = false;
+    
+    WorkSignal_.post(Threads_.size());
+    
+    for (u32 i = 0; i < Threads_.size(); ++i)
+        ExitSignal_.wait();
+    
+    MemoryManager::deleteList(Threads_);
+}
+
+void ThreadPool::run(PFNTHREADPOOLTASKPROC TaskProc, void* UserData, u32 NumTasks)
+{
+    if (!TaskProc || !NumTasks)
+        return;
+    
+    /* Small jobs are processed directly */
+    if (NumTasks == 1 || Threads_.empty())
+    {
+        for (u32 i = 0; i < NumTasks; ++i)
+            TaskProc(i, UserData);
+        return;
+    }
+    
+    SJob Job(TaskProc, UserData, NumTasks);
+    
+    Mutex_.lock();
+    Jobs_.push_back(&Job);
+    Mutex_.unlock();
+    
+    /* Wake up the workers (the calling thread takes one task itself) */
+    WorkSignal_.post(math::Min(NumTasks - 1, static_cast<u32>(Threads_.size())));
+    
+    /* Help with the own tasks and wait until the tasks taken by the workers are finished */
+    while (processTask(&Job));
+    
+    Job.Finished.wait();
+}
+
+ThreadPool* ThreadPool::getShared()
+{
+    SharedThreadPoolMutex.lock();
+    
+    if (!SharedThreadPool)
+    {
+        const u32 NumCores = (GlbPlatformInfo ? GlbPlatformInfo->getProcessorCount() : 1);
+        SharedThreadPool = new ThreadPool(NumCores > 1 ? NumCores - 1 : 0);
+    }
+    
+    ThreadPool* Pool = SharedThreadPool;
+    
+    SharedThreadPoolMutex.unlock();
+    
+    return Pool;
+}
+
+void ThreadPool::deleteShared()
+{
+    SharedThreadPoolMutex.lock();
+    MemoryManager::deleteMemory(SharedThreadPool);
+    SharedThreadPoolMutex.unlock();
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+bool ThreadPool::processTask(SJob* OwnJob)
+{
+    /* Take the next task of the specified job or of the oldest job */
+    Mutex_.lock();
+    
+    SJob* Job = OwnJob;
+    
+    if (!Job)
+        Job = (Jobs_.empty() ? 0 : Jobs_.front());
+    
+    if (!Job || Job->NextTask >= Job->NumTasks)
+    {
+        Mutex_.unlock();
+        return false;
+    }
+    
+    const u32 Index = Job->NextTask++;
+    
+    /* Remove the job from the queue when all its tasks have been handed out */
+    if (Job->NextTask == Job->NumTasks)
+        Jobs_.erase(std::find(Jobs_.begin(), Jobs_.end(), Job));
+    
+    Mutex_.unlock();
+    
+    /* Process the task */
+    Job->TaskProc(Index, Job->UserData);
+    
+    /* Signal the waiting caller when the last task has been finished */
+    Mutex_.lock();
+    const bool isFinished = (--Job->NumPending == 0);
+    Mutex_.unlock();
+    
+    if (isFinished)
+        Job->Finished.post();
+    
+    return true;
+}
+
+
+} // /namespace sp
+
+
+
+// ================================================================================
@@ -0,0 +1,129 @@
+/*
+ * Thread pool header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_THREADPOOL_H__
+#define __SP_THREADPOOL_H__
+
+
+#include "Base/spStandard.hpp"
+#include "Base/spThreadManager.hpp"
+#include "Base/spCriticalSection.hpp"
+#include "Base/spSemaphore.hpp"
+
+#include <vector>
+
+
+namespace sp
+{
+
+
+/**
+Thread pool task procedure.
+\param Index: Specifies the task index in the range [0 .. NumTasks).
+\param UserData: Specifies the user data pointer which has been passed to "ThreadPool::run".
+\see ThreadPool::run
+*/
+typedef void (*PFNTHREADPOOLTASKPROC)(u32 Index, void* UserData);
+
+
+/**
+The thread pool keeps a fixed set of worker threads alive, so parallel algorithms which run every frame
+(or for every file) don't have to create new threads for each call. Idle workers are blocked on a semaphore
+and a caller which waits for its tasks is blocked as well, i.e. no thread spins while waiting.
+\see getShared
+\since Version 3.3
+*/
+class SP_EXPORT ThreadPool
+{
+    
+    public:
+        
+        /**
+        Creates the thread pool and starts the worker threads.
+        \param ThreadCount: Specifies the count of worker threads. The thread which calls "run" processes tasks as well,
+        so a pool with (CPU cores - 1) worker threads uses all cores.
+        */
+        ThreadPool(u32 ThreadCount);
+        ~ThreadPool();
+        
+        /* === Functions === */
+        
+        /**
+        Calls the task procedure for each task index in the range [0 .. NumTasks) and returns when all tasks have been finished.
+        The tasks are distributed over the worker threads and the calling thread processes tasks too.
+        This can be called from several threads at once, even from inside a task.
+        \param TaskProc: Specifies the task procedure.
+        \param UserData: Specifies the user data pointer which is passed to each task.
+        \param NumTasks: Specifies the count of tasks.
+        */
+        void run(PFNTHREADPOOLTASKPROC TaskProc, void* UserData, u32 NumTasks);
+        
+        /* === Static functions === */
+        
+        /**
+        Returns the shared thread pool which is used by the engine's parallel algorithms (e.g. the mesh optimizer or the OBJ loader).
+        It is created on first use with one worker thread less than the CPU has cores and it is deleted with the device.
+        */
+        static ThreadPool* getShared();
+        
+        //! Deletes the shared thread pool. This is called when the device is deleted.
+        static void deleteShared();
+        
+        /* === Inline functions === */
+        
+        //! Returns the count of worker threads.
+        inline u32 getThreadCount() const
+        {
+            return Threads_.size();
+        }
+        
+    private:
+        
+        friend THREAD_PROC(ThreadPoolProc);
+        
+        /* === Structures === */
+        
+        struct SJob
+        {
+            SJob(PFNTHREADPOOLTASKPROC InitTaskProc, void* InitUserData, u32 InitNumTasks);
+            ~SJob();
+            
+            /* Members */
+            PFNTHREADPOOLTASKPROC TaskProc;
+            void* UserData;
+            u32 NumTasks;
+            u32 NextTask;       //!< Next task index which is handed out.
+            u32 NumPending;     //!< Tasks which have not been finished yet.
+            Semaphore Finished; //!< Signaled when the last task has been finished.
+        };
+        
+        /* === Functions === */
+        
+        bool processTask(SJob* OwnJob);
+        
+        /* === Members === */
+        
+        std::vector<SJob*> Jobs_;
+        CriticalSection Mutex_;
+        
+        Semaphore WorkSignal_;
+        Semaphore ExitSignal_;
+        
+        std::vector<ThreadManager*> Threads_;
+        volatile bool isRunning_;
+        
+};
+
+
+} // /namepsace sp
+
+
+#endif
+
+
+
+// ================================================================================
@@ -17,6 +17,7 @@
 //#   endif
 #elif defined(SP_PLATFORM_LINUX)
 #   include <unistd.h>
+#   include <sys/time.h>
 #endif
 
 
@@ -36,6 +37,15 @@ struct SFrequenceQuery
     LARGE_INTEGER StartTime;
 };
 
+#elif defined(SP_PLATFORM_LINUX)
+
+static u64 getWallClockMicroseconds()
+{
+    timeval Time;
+    gettimeofday(&Time, 0);
+    return static_cast<u64>(Time.tv_sec) * 1000000 + static_cast<u64>(Time.tv_usec);
+}
+
 #endif
 
 
@@ -54,8 +64,10 @@ Timer::Timer(u64 Duration) :
     EndTime_    (0),
     TimeOut_    (0),
     Duration_   (0)
-    #ifdef SP_PLATFORM_WINDOWS
+    #if defined(SP_PLATFORM_WINDOWS)
     ,FreqQuery_(0)
+    #elif defined(SP_PLATFORM_LINUX)
+    ,ClockStartTime_(0)
     #endif
 {
     if (Duration > 0)
@@ -66,8 +78,10 @@ Timer::Timer(bool UseFrequenceQuery) :
     EndTime_    (0),
     TimeOut_    (0),
     Duration_   (0)
-    #ifdef SP_PLATFORM_WINDOWS
+    #if defined(SP_PLATFORM_WINDOWS)
     ,FreqQuery_(0)
+    #elif defined(SP_PLATFORM_LINUX)
+    ,ClockStartTime_(0)
     #endif
 {
     if (UseFrequenceQuery)
@@ -153,6 +167,10 @@ u64 Timer::getElapsedMicroseconds()
     // Convert to microseconds
     return static_cast<u64>(1000000 * ElapsedTime / FreqQuery_->ClockFrequency.QuadPart);
     
+    #elif defined(SP_PLATFORM_LINUX)
+    
+    return getWallClockMicroseconds() - ClockStartTime_;
+    
     #else
     
     return 1;
@@ -171,6 +189,10 @@ void Timer::resetClockCounter()
         FreqQuery_->PrevElapsedTime = 0;
     }
     
+    #elif defined(SP_PLATFORM_LINUX)
+    
+    ClockStartTime_ = getWallClockMicroseconds();
+    
     #endif
 }
 
@@ -341,6 +363,8 @@ void Timer::createFrequenceQuery()
     FreqQuery_ = MemoryManager::createMemory<SFrequenceQuery>("io::Timer::SFrequenceQuery");
     QueryPerformanceFrequency(&FreqQuery_->ClockFrequency);
     resetClockCounter();
+    #elif defined(SP_PLATFORM_LINUX)
+    resetClockCounter();
     #endif
 }
 
@@ -224,8 +224,10 @@ class SP_EXPORT Timer
         
         /* === Members === */
         
-        #ifdef SP_PLATFORM_WINDOWS
+        #if defined(SP_PLATFORM_WINDOWS)
         SFrequenceQuery* FreqQuery_;
+        #elif defined(SP_PLATFORM_LINUX)
+        u64 ClockStartTime_;
         #endif
         
         static f64 GlobalFPS_;              //!< Global base FPS counter variable.
@@ -24,6 +24,7 @@
 /* ImageSaver: */
 
 #include "FileFormats/Image/spImageSaverBMP.hpp"
+#include "FileFormats/Image/spImageSaverDDS.hpp"
 
 
 #endif
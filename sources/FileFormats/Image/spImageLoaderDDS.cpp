@@ -11,6 +11,9 @@
 
 
 #include "Base/spImageManagement.hpp"
+#include "Base/spImageBlockCompression.hpp"
+
+#include <vector>
 
 
 namespace sp
@@ -152,9 +155,9 @@ bool ImageLoaderDDS::updateFourCCType()
     else if (FourCCName_ == "DXT3")
         FourCC_ = FOURCC_DXT3, isAlpha_ = true;
     else if (FourCCName_ == "DXT4")
-        FourCC_ = FOURCC_DXT4;
+        FourCC_ = FOURCC_DXT4, isAlpha_ = true;
     else if (FourCCName_ == "DXT5")
-        FourCC_ = FOURCC_DXT5;
+        FourCC_ = FOURCC_DXT5, isAlpha_ = true;
     else if (FourCCName_ == "DX10")
         FourCC_ = FOURCC_DX10;
     else if (FourCCName_ == "BC4U")
@@ -204,9 +207,21 @@ bool ImageLoaderDDS::updateFourCCType()
 
 bool ImageLoaderDDS::readBody()
 {
-    return
-        ( ( FourCC_ >= FOURCC_DXT1 && FourCC_ <= FOURCC_DXT5 ) )
-        ? readCompressed() : readUncompressed();
+    switch (FourCC_)
+    {
+        case FOURCC_DXT1:
+            return readBlockCompressed(BLOCKCOMPRESSION_BC1);
+        case FOURCC_DXT4:
+        case FOURCC_DXT5:
+            return readBlockCompressed(BLOCKCOMPRESSION_BC3);
+        case FOURCC_ATI2:
+            return readBlockCompressed(BLOCKCOMPRESSION_BC5);
+        case FOURCC_DXT2:
+        case FOURCC_DXT3:
+            return readCompressed();
+        default:
+            return readUncompressed();
+    }
 }
 
 bool ImageLoaderDDS::readUncompressed()
@@ -313,6 +328,36 @@ bool ImageLoaderDDS::readCompressed()
     return true;
 }
 
+bool ImageLoaderDDS::readBlockCompressed(const EBlockCompressionFormats Format)
+{
+    const dim::size2di Size(MainHeader_.Width, MainHeader_.Height);
+    
+    /* Read the compressed image buffer */
+    std::vector<u8> BlockBuffer(BlockCompression::getCompressedSize(Format, Size));
+    
+    if (BlockBuffer.empty())
+        return false;
+    
+    File_->readBuffer(&BlockBuffer[0], BlockBuffer.size());
+    
+    /* Decompress the image buffer to RGBA */
+    std::vector<u8> Pixels(Size.getArea() * 4);
+    
+    if (!BlockCompression::decompressImage(&BlockBuffer[0], Size, Format, &Pixels[0]))
+        return false;
+    
+    /* Copy the pixels with the final format size */
+    const s32 FormatSize = TexData_->FormatSize;
+    
+    for (s32 i = 0, n = Size.getArea(); i < n; ++i)
+    {
+        for (s32 j = 0; j < FormatSize; ++j)
+            TexData_->ImageBuffer[i*FormatSize + j] = Pixels[i*4 + j];
+    }
+    
+    return true;
+}
+
 video::color ImageLoaderDDS::get16BitColor(u16 Color) const
 {
     return video::color(
@@ -15,6 +15,7 @@
 
 
 #include "FileFormats/Image/spImageFormatInterfaces.hpp"
+#include "RenderSystem/spTextureFlags.hpp"
 
 
 namespace sp
@@ -146,6 +147,7 @@ class SP_EXPORT ImageLoaderDDS : public ImageLoader
         
         bool readUncompressed();
         bool readCompressed();
+        bool readBlockCompressed(const EBlockCompressionFormats Format);
         
         video::color get16BitColor(u16 Color) const;
         video::color getInterpolatedColor(const video::color &ColorA, const video::color &ColorB) const;
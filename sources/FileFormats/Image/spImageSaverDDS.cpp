@@ -0,0 +1,108 @@
+/*
+ * Image saver DDS file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "FileFormats/Image/spImageSaverDDS.hpp"
+
+#ifdef SP_COMPILE_WITH_TEXSAVER_DDS
+
+
+#include "Base/spImageBlockCompression.hpp"
+#include "Base/spInputOutputLog.hpp"
+
+#include <vector>
+
+
+namespace sp
+{
+namespace video
+{
+
+
+ImageSaverDDS::ImageSaverDDS(
+    io::File* File, const EBlockCompressionFormats Format, const EBlockCompressionQualities Quality) :
+    ImageSaver  (File   ),
+    Format_     (Format ),
+    Quality_    (Quality)
+{
+}
+ImageSaverDDS::~ImageSaverDDS()
+{
+}
+
+bool ImageSaverDDS::saveImageData(SImageDataWrite* ImageData)
+{
+    /* Check if the file has opened correct */
+    if (!File_ || !File_->hasWriteAccess())
+        return false;
+    
+    /* Get the final block compression format */
+    const EBlockCompressionFormats Format = BlockCompression::resolveFormat(
+        Format_ == BLOCKCOMPRESSION_NONE ? BLOCKCOMPRESSION_AUTO : Format_, ImageData->Format
+    );
+    
+    if (Format == BLOCKCOMPRESSION_NONE)
+    {
+        io::Log::error("Pixel format is not supported for DDS image files");
+        return false;
+    }
+    
+    /* Compress the image */
+    const dim::size2di Size(ImageData->Width, ImageData->Height);
+    
+    std::vector<u8> BlockBuffer(BlockCompression::getCompressedSize(Format, Size));
+    
+    if ( BlockBuffer.empty() ||
+         !BlockCompression::compressImage(ImageData->ImageBuffer, Size, ImageData->Format, Format, &BlockBuffer[0], Quality_) )
+    {
+        io::Log::error("Could not compress image for DDS file");
+        return false;
+    }
+    
+    /* Header settings */
+    SHeaderDDS HeaderInfo;
+    memset(&HeaderInfo, 0, sizeof(HeaderInfo));
+    
+    HeaderInfo.StructSize           = sizeof(SHeaderDDS);
+    HeaderInfo.Flags                = 0x00081007; // (CAPS | HEIGHT | WIDTH | PIXELFORMAT | LINEARSIZE)
+    HeaderInfo.Height               = ImageData->Height;
+    HeaderInfo.Width                = ImageData->Width;
+    HeaderInfo.Pitch                = BlockBuffer.size();
+    HeaderInfo.MipMapCount          = 1;
+    HeaderInfo.Format.StructSize    = sizeof(SPixelFormatDDS);
+    HeaderInfo.Format.Flags         = 0x00000004; // (FOURCC)
+    HeaderInfo.SurfaceFlags         = 0x00001000; // (TEXTURE)
+    
+    switch (Format)
+    {
+        case BLOCKCOMPRESSION_BC1:
+            memcpy(&HeaderInfo.Format.FourCC, "DXT1", 4); break;
+        case BLOCKCOMPRESSION_BC3:
+            memcpy(&HeaderInfo.Format.FourCC, "DXT5", 4); break;
+        default:
+            memcpy(&HeaderInfo.Format.FourCC, "ATI2", 4); break;
+    }
+    
+    /* Write magic number, header and blocks into the image file */
+    File_->writeValue<s32>(0x20534444); // ("DDS ")
+    File_->writeBuffer(&HeaderInfo, sizeof(HeaderInfo));
+    File_->writeBuffer(&BlockBuffer[0], BlockBuffer.size());
+    
+    /* Saving successful */
+    return true;
+}
+
+
+} // /namespace video
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,114 @@
+/*
+ * Image saver DDS header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_IMAGESAVER_DDS_H__
+#define __SP_IMAGESAVER_DDS_H__
+
+
+#include "Base/spStandard.hpp"
+
+#ifdef SP_COMPILE_WITH_TEXSAVER_DDS
+
+
+#include "FileFormats/Image/spImageFormatInterfaces.hpp"
+#include "RenderSystem/spTextureFlags.hpp"
+
+
+namespace sp
+{
+namespace video
+{
+
+
+/**
+Image saver for block compressed DDS (Direct Draw Surface) files. The image is compressed with the BlockCompression encoder
+and stored with the FourCC "DXT1" (BC1), "DXT5" (BC3) or "ATI2" (BC5). Only the first MIP level is stored.
+\since Version 3.3
+*/
+class SP_EXPORT ImageSaverDDS : public ImageSaver
+{
+    
+    public:
+        
+        ImageSaverDDS(
+            io::File* File, const EBlockCompressionFormats Format = BLOCKCOMPRESSION_AUTO,
+            const EBlockCompressionQualities Quality = BLOCKQUALITY_NORMAL
+        );
+        ~ImageSaverDDS();
+        
+        bool saveImageData(SImageDataWrite* ImageData);
+        
+    private:
+        
+        /* Structures */
+        
+        #if defined(_MSC_VER)
+        #   pragma pack(push, packing)
+        #   pragma pack(1)
+        #   define SP_PACK_STRUCT
+        #elif defined(__GNUC__)
+        #   define SP_PACK_STRUCT __attribute__((packed))
+        #else
+        #   define SP_PACK_STRUCT
+        #endif
+        
+        struct SPixelFormatDDS
+        {
+            s32 StructSize;
+            s32 Flags;
+            s32 FourCC;
+            s32 RGBBitCount;
+            s32 RBitMask;
+            s32 GBitMask;
+            s32 BBitMask;
+            s32 ABitMask;
+        }
+        SP_PACK_STRUCT;
+        
+        struct SHeaderDDS
+        {
+            s32 StructSize;
+            s32 Flags;
+            s32 Height;
+            s32 Width;
+            s32 Pitch;
+            s32 Depth;
+            s32 MipMapCount;
+            s32 Reserved1[11];
+            SPixelFormatDDS Format;
+            s32 SurfaceFlags;
+            s32 CubeMapFlags;
+            s32 Reserved2[3];
+        }
+        SP_PACK_STRUCT;
+        
+        #ifdef _MSC_VER
+        #   pragma pack(pop, packing)
+        #endif
+        
+        #undef SP_PACK_STRUCT
+        
+        /* Members */
+        
+        EBlockCompressionFormats Format_;
+        EBlockCompressionQualities Quality_;
+        
+};
+
+
+} // /namespace video
+
+} // /namespace sp
+
+
+#endif
+
+#endif
+
+
+
+// ================================================================================
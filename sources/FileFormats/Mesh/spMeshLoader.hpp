@@ -28,7 +28,18 @@ namespace scene
 //! Mesh loader flags. Used in the SceneManager::loadMesh function.
 enum EMeshLoaderFlags
 {
-    MESHFLAG_SINGLE_MODEL = 0x0001, //!< Only a single 3D model is to be created. Disallows model fragmentation.
+    MESHFLAG_SINGLE_MODEL           = 0x0001, //!< Only a single 3D model is to be created. Disallows model fragmentation.
+    /**
+    Optimizes the index and vertex order of all mesh buffers for the GPU's post-transform vertex cache.
+    The optimization runs on several worker threads and the vertex cache statistics are written to the log.
+    The vertex order is kept for animated meshes. \see video::MeshBufferOptimizer
+    */
+    MESHFLAG_OPTIMIZE_VERTEX_CACHE  = 0x0002,
+    /**
+    Uses the line-by-line parser for OBJ files instead of the parallel chunk parser.
+    The line-by-line parser does not merge equal vertices. This is mainly used for comparison benchmarks.
+    */
+    MESHFLAG_LINE_BY_LINE_PARSING   = 0x0004,
 };
 
 
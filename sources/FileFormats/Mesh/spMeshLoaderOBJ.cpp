@@ -11,8 +11,11 @@
 
 
 #include "Platform/spSoftPixelDeviceOS.hpp"
+#include "Base/spThreadPool.hpp"
+#include "Base/spTimer.hpp"
 
 #include <boost/foreach.hpp>
+#include <cstring>
 
 
 namespace sp
@@ -24,6 +27,289 @@ namespace scene
 {
 
 
+/*
+ * Internal members
+ */
+
+//! Minimal chunk size (in bytes) for the parallel parser.
+static const u32 OBJ_MIN_CHUNK_SIZE = 262144;
+
+//! Bias of the chunk-local indices. Relative indices may refer to elements of previous chunks, so local indices can be negative.
+static const s32 OBJ_LOCAL_INDEX_BIAS = 0x40000000;
+
+//! Maximal magnitude of parsed integers. Larger values are clamped, so the index arithmetic cannot overflow.
+static const s32 OBJ_MAX_INTEGER = 0x3FFFFFFF;
+
+struct SVertexKeyOBJ
+{
+    u32 Coord;
+    u32 TexCoord;
+    u32 Normal;
+};
+
+/*
+Open addressing hash table which maps the index triples of the face corners to the vertex indices.
+This is used to share equal vertices when the chunks are merged into the mesh buffers.
+*/
+class VertexHashMapOBJ
+{
+    
+    public:
+        
+        VertexHashMapOBJ(u32 MaxCount) :
+            Mask_(0)
+        {
+            u32 Size = 16;
+            while (Size < MaxCount * 2)
+                Size <<= 1;
+            
+            Mask_ = Size - 1;
+            Entries_.resize(Size);
+            
+            for (u32 i = 0; i < Size; ++i)
+                Entries_[i].Index = EMPTY;
+        }
+        ~VertexHashMapOBJ()
+        {
+        }
+        
+        /* === Functions === */
+        
+        //! Returns the vertex index of the specified key. If the key is new it gets the specified index.
+        u32 insert(const SVertexKeyOBJ &Key, u32 NewIndex)
+        {
+            u32 i = (Key.Coord * 73856093u ^ Key.TexCoord * 19349663u ^ Key.Normal * 83492791u) & Mask_;
+            
+            while (1)
+            {
+                SEntry& Entry = Entries_[i];
+                
+                if (Entry.Index == EMPTY)
+                {
+                    Entry.Key   = Key;
+                    Entry.Index = NewIndex;
+                    return NewIndex;
+                }
+                
+                if (Entry.Key.Coord == Key.Coord && Entry.Key.TexCoord == Key.TexCoord && Entry.Key.Normal == Key.Normal)
+                    return Entry.Index;
+                
+                i = (i + 1) & Mask_;
+            }
+        }
+        
+    private:
+        
+        static const u32 EMPTY = ~0u;
+        
+        /* === Structures === */
+        
+        struct SEntry
+        {
+            SVertexKeyOBJ Key;
+            u32 Index;
+        };
+        
+        /* === Members === */
+        
+        std::vector<SEntry> Entries_;
+        u32 Mask_;
+        
+};
+
+static inline bool isBlankOBJ(c8 Chr)
+{
+    return Chr == ' ' || Chr == '\t' || Chr == '\r';
+}
+
+static inline const c8* skipBlanksOBJ(const c8* Str, const c8* End)
+{
+    while (Str < End && isBlankOBJ(*Str))
+        ++Str;
+    return Str;
+}
+
+static inline bool isDigitOBJ(c8 Chr)
+{
+    return Chr >= '0' && Chr <= '9';
+}
+
+//! Parses a floating-point number without any allocation. Returns the position after the number.
+static const c8* parseFloatOBJ(const c8* Str, const c8* End, f32 &Value)
+{
+    static const f64 Powers[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    
+    bool isNegative = false;
+    
+    if (Str < End && (*Str == '-' || *Str == '+'))
+        isNegative = (*Str++ == '-');
+    
+    /* Read the mantissa (digits beyond the precision of a double are only counted) */
+    f64 Mantissa = 0.0;
+    s32 Exponent = 0, NumDigits = 0;
+    
+    for (; Str < End && isDigitOBJ(*Str); ++Str)
+    {
+        if (NumDigits++ < 18)
+            Mantissa = Mantissa * 10.0 + (*Str - '0');
+        else
+            ++Exponent;
+    }
+    
+    if (Str < End && *Str == '.')
+    {
+        for (++Str; Str < End && isDigitOBJ(*Str); ++Str)
+        {
+            if (NumDigits++ < 18)
+            {
+                Mantissa = Mantissa * 10.0 + (*Str - '0');
+                --Exponent;
+            }
+        }
+    }
+    
+    /* Read the exponent */
+    if (Str < End && (*Str == 'e' || *Str == 'E'))
+    {
+        const c8* ExpStr = Str + 1;
+        bool isExpNegative = false;
+        
+        if (ExpStr < End && (*ExpStr == '-' || *ExpStr == '+'))
+            isExpNegative = (*ExpStr++ == '-');
+        
+        if (ExpStr < End && isDigitOBJ(*ExpStr))
+        {
+            s32 Exp = 0;
+            for (; ExpStr < End && isDigitOBJ(*ExpStr); ++ExpStr)
+            {
+                if (Exp < 10000)
+                    Exp = Exp * 10 + (*ExpStr - '0');
+            }
+            Exponent += (isExpNegative ? -Exp : Exp);
+            Str = ExpStr;
+        }
+    }
+    
+    /* Scale the mantissa */
+    if (Mantissa != 0.0 && Exponent != 0)
+    {
+        const s32 AbsExponent = (Exponent < 0 ? -Exponent : Exponent);
+        const f64 Scale = (AbsExponent <= 22 ? Powers[AbsExponent] : pow(10.0, static_cast<f64>(AbsExponent)));
+        
+        if (Exponent < 0)
+            Mantissa /= Scale;
+        else
+            Mantissa *= Scale;
+    }
+    
+    Value = static_cast<f32>(isNegative ? -Mantissa : Mantissa);
+    
+    return Str;
+}
+
+//! Parses an integer without any allocation. Returns the position after the number.
+static const c8* parseIntOBJ(const c8* Str, const c8* End, s32 &Value)
+{
+    bool isNegative = false;
+    
+    if (Str < End && (*Str == '-' || *Str == '+'))
+        isNegative = (*Str++ == '-');
+    
+    s32 Result = 0;
+    for (; Str < End && isDigitOBJ(*Str); ++Str)
+    {
+        /* Clamp too large numbers of malformed files (such indices are rejected when they are resolved) */
+        if (Result <= (OBJ_MAX_INTEGER - 9) / 10)
+            Result = Result * 10 + (*Str - '0');
+        else
+            Result = OBJ_MAX_INTEGER;
+    }
+    
+    Value = (isNegative ? -Result : Result);
+    
+    return Str;
+}
+
+//! Parses up to "Count" floating-point numbers until the end of the line. Missing values are zero.
+static void parseFloatsOBJ(const c8* Str, const c8* End, f32* Values, u32 Count)
+{
+    for (u32 i = 0; i < Count; ++i)
+    {
+        Str = skipBlanksOBJ(Str, End);
+        
+        if (Str >= End)
+        {
+            Values[i] = 0.0f;
+            continue;
+        }
+        
+        const c8* Next = parseFloatOBJ(Str, End, Values[i]);
+        
+        /* Skip invalid characters */
+        if (Next == Str)
+        {
+            while (Next < End && !isBlankOBJ(*Next))
+                ++Next;
+        }
+        
+        Str = Next;
+    }
+}
+
+//! Returns the first word of the line part (used for group, object and material names).
+static io::stringc getFirstWordOBJ(const c8* Str, const c8* End)
+{
+    Str = skipBlanksOBJ(Str, End);
+    
+    const c8* WordEnd = Str;
+    while (WordEnd < End && !isBlankOBJ(*WordEnd))
+        ++WordEnd;
+    
+    return io::stringc(std::string(Str, WordEnd));
+}
+
+//! Returns true if the line begins with the specified keyword which is followed by a blank or the line end.
+static inline bool isKeywordOBJ(const c8* Str, const c8* End, const c8* Keyword, u32 Length)
+{
+    const u32 Size = static_cast<u32>(End - Str);
+    return Size >= Length && !strncmp(Str, Keyword, Length) && (Size == Length || isBlankOBJ(Str[Length]));
+}
+
+//! Converts the relative index (e.g. -1 for the last element) into a biased chunk-local index.
+static inline s32 getLocalIndexOBJ(s32 Index, u32 NumElements)
+{
+    return (Index < 0 ? static_cast<s32>(NumElements) + Index - OBJ_LOCAL_INDEX_BIAS : Index);
+}
+
+//! Resolves the absolute (beginning with 1) or biased chunk-local index. Returns ~0 for missing elements.
+static inline u32 resolveIndexOBJ(s32 Index, u32 ChunkOffset)
+{
+    if (Index > 0)
+        return static_cast<u32>(Index - 1);
+    if (Index < 0)
+    {
+        const s32 Resolved = static_cast<s32>(ChunkOffset) + Index + OBJ_LOCAL_INDEX_BIAS;
+        return (Resolved >= 0 ? static_cast<u32>(Resolved) : ~0u - 1);
+    }
+    return ~0u;
+}
+
+void MeshLoaderOBJTaskProc(u32 Index, void* UserData)
+{
+    MeshLoaderOBJ* Loader = reinterpret_cast<MeshLoaderOBJ*>(UserData);
+    MeshLoaderOBJ::parseChunk(Loader->Chunks_[Index]);
+}
+
+
+/*
+ * MeshLoaderOBJ class
+ */
+
+
 MeshLoaderOBJ::MeshLoaderOBJ() :
     MeshLoader  (   ),
     CurLineNr_  (0  ),
@@ -41,11 +327,21 @@ Mesh* MeshLoaderOBJ::loadMesh(const io::stringc &Filename, const io::stringc &Te
     if (!openLoadFile(Filename, TexturePath))
         return Mesh_;
     
-    if (!parseFile(File_))
-        io::Log::error("Loading OBJ mesh failed");
-    
-    if (!buildModel())
-        io::Log::error("Building OBJ mesh failed");
+    if (hasFlag(MESHFLAG_LINE_BY_LINE_PARSING))
+    {
+        if (!parseFile(File_))
+            io::Log::error("Loading OBJ mesh failed");
+        
+        if (!buildModel())
+            io::Log::error("Building OBJ mesh failed");
+    }
+    else
+    {
+        if (!parseFileParallel(File_))
+            io::Log::error("Loading OBJ mesh failed");
+        else if (!buildModelFromChunks())
+            io::Log::error("Building OBJ mesh failed");
+    }
     
     return Mesh_;
 }
@@ -170,6 +466,422 @@ bool MeshLoaderOBJ::buildModel()
     return true;
 }
 
+bool MeshLoaderOBJ::parseFileParallel(io::File* CurFile)
+{
+    /* Read the whole file with a single read operation */
+    const u32 FileSize = CurFile->getSize();
+    
+    FileBuffer_.resize(FileSize + 1);
+    
+    const bool isRead = (FileSize == 0 || CurFile->readBuffer(&FileBuffer_[0], FileSize) == static_cast<s32>(FileSize));
+    
+    FileSys_.closeFile(CurFile);
+    
+    if (!isRead)
+        return exitWithError("Could not read file", false);
+    
+    const u64 StartTime = io::Timer::microsecs();
+    
+    /* Split the file into chunks at line boundaries */
+    ThreadPool* Pool = ThreadPool::getShared();
+    
+    const u32 ThreadCount = Pool->getThreadCount() + 1;
+    
+    const u32 NumChunks = math::MinMax(FileSize / OBJ_MIN_CHUNK_SIZE, 1u, ThreadCount * 4);
+    
+    const c8* FileBegin = &FileBuffer_[0];
+    const c8* FileEnd = FileBegin + FileSize;
+    const c8* Pos = FileBegin;
+    
+    Chunks_.resize(NumChunks);
+    
+    for (u32 i = 0; i < NumChunks; ++i)
+    {
+        Chunks_[i].Begin = Pos;
+        
+        if (i + 1 < NumChunks)
+        {
+            const c8* Split = FileBegin + static_cast<u32>(static_cast<u64>(FileSize) * (i + 1) / NumChunks);
+            
+            if (Split < Pos)
+                Split = Pos;
+            
+            const c8* LineEnd = static_cast<const c8*>(memchr(Split, '\n', FileEnd - Split));
+            Pos = (LineEnd ? LineEnd + 1 : FileEnd);
+        }
+        else
+            Pos = FileEnd;
+        
+        Chunks_[i].End = Pos;
+    }
+    
+    /* Parse one chunk per task on the shared thread pool (this thread takes part in the work as well) */
+    Pool->run(MeshLoaderOBJTaskProc, this, NumChunks);
+    
+    /* Print the parser throughput */
+    const u64 Duration = math::Max(static_cast<u64>(1), io::Timer::microsecs() - StartTime);
+    
+    io::Log::message(
+        "Parsed " + io::stringc(FileSize / 1024) + " KB in " + io::stringc(static_cast<u32>(Duration / 1000)) + " ms with " +
+        io::stringc(math::Min(ThreadCount, NumChunks)) + " thread(s) (" + io::stringc(static_cast<u32>(static_cast<u64>(FileSize) / Duration)) + " MB/s)"
+    );
+    
+    /* The file buffer is no longer needed, because the statements hold copies of their strings */
+    std::vector<c8>().swap(FileBuffer_);
+    
+    return applyStatements();
+}
+
+void MeshLoaderOBJ::parseChunk(SChunkOBJ &Chunk)
+{
+    const c8* Line = Chunk.Begin;
+    
+    SCornerOBJ Corner;
+    f32 Values[3];
+    
+    while (Line < Chunk.End)
+    {
+        /* Find the end of the current line */
+        const c8* LineEnd = static_cast<const c8*>(memchr(Line, '\n', Chunk.End - Line));
+        if (!LineEnd)
+            LineEnd = Chunk.End;
+        
+        const c8* Str = skipBlanksOBJ(Line, LineEnd);
+        Line = LineEnd + 1;
+        
+        if (Str >= LineEnd)
+            continue;
+        
+        switch (*Str)
+        {
+            case 'v':
+            {
+                if (Str + 1 >= LineEnd)
+                    break;
+                
+                if (isBlankOBJ(Str[1]))
+                {
+                    parseFloatsOBJ(Str + 2, LineEnd, Values, 3);
+                    Chunk.Coords.push_back(dim::vector3df(Values[0], Values[1], Values[2]));
+                }
+                else if (Str[1] == 't')
+                {
+                    parseFloatsOBJ(Str + 2, LineEnd, Values, 2);
+                    Chunk.TexCoords.push_back(dim::point2df(Values[0], -Values[1]));
+                }
+                else if (Str[1] == 'n')
+                {
+                    parseFloatsOBJ(Str + 2, LineEnd, Values, 3);
+                    Chunk.Normals.push_back(dim::vector3df(Values[0], Values[1], Values[2]));
+                }
+            }
+            break;
+            
+            case 'f':
+            {
+                if (Str + 1 >= LineEnd || !isBlankOBJ(Str[1]))
+                    break;
+                
+                const u32 FirstCorner = Chunk.Corners.size();
+                
+                for (Str = skipBlanksOBJ(Str + 2, LineEnd); Str < LineEnd; Str = skipBlanksOBJ(Str, LineEnd))
+                {
+                    /* Read the "coord/texcoord/normal" indices (texture coordinate and normal are optional) */
+                    Corner.TexCoord = Corner.Normal = 0;
+                    
+                    const c8* Next = parseIntOBJ(Str, LineEnd, Corner.Coord);
+                    
+                    if (Next == Str)
+                        break;
+                    
+                    if (Next < LineEnd && *Next == '/')
+                    {
+                        Next = parseIntOBJ(Next + 1, LineEnd, Corner.TexCoord);
+                        
+                        if (Next < LineEnd && *Next == '/')
+                            Next = parseIntOBJ(Next + 1, LineEnd, Corner.Normal);
+                    }
+                    
+                    /* Relative indices refer to the elements which have been read before */
+                    Corner.Coord    = getLocalIndexOBJ(Corner.Coord,    Chunk.Coords.size()     );
+                    Corner.TexCoord = getLocalIndexOBJ(Corner.TexCoord, Chunk.TexCoords.size()  );
+                    Corner.Normal   = getLocalIndexOBJ(Corner.Normal,   Chunk.Normals.size()    );
+                    
+                    Chunk.Corners.push_back(Corner);
+                    Str = Next;
+                }
+                
+                /* Faces with less than three corners are ignored */
+                if (Chunk.Corners.size() - FirstCorner >= 3)
+                    Chunk.Faces.push_back(FirstCorner);
+                else
+                    Chunk.Corners.resize(FirstCorner);
+            }
+            break;
+            
+            case 'g':
+            case 'o':
+            case 'u':
+            case 'm':
+            {
+                /* Store the statement with the current face position, it is applied after all chunks have been parsed */
+                SStatementOBJ Statement;
+                
+                if (isKeywordOBJ(Str, LineEnd, "g", 1) || isKeywordOBJ(Str, LineEnd, "o", 1))
+                    Statement.Argument = getFirstWordOBJ(Str + 1, LineEnd);
+                else if (isKeywordOBJ(Str, LineEnd, "usemtl", 6))
+                    Statement.Argument = getFirstWordOBJ(Str + 6, LineEnd);
+                else if (isKeywordOBJ(Str, LineEnd, "mtllib", 6))
+                    Statement.Argument = io::stringc(std::string(Str + 6, LineEnd)).trim();
+                else
+                    break;
+                
+                Statement.Type      = *Str;
+                Statement.FaceIndex = Chunk.Faces.size();
+                
+                Chunk.Statements.push_back(Statement);
+            }
+            break;
+            
+            default:
+                break;
+        }
+    }
+    
+    /* Close the last face */
+    Chunk.Faces.push_back(Chunk.Corners.size());
+}
+
+bool MeshLoaderOBJ::applyStatements()
+{
+    /* Apply the statements in file order and assign the face ranges to the groups */
+    for (u32 i = 0; i < Chunks_.size(); ++i)
+    {
+        const SChunkOBJ& Chunk = Chunks_[i];
+        
+        SFaceRangeOBJ Range;
+        Range.Chunk     = i;
+        Range.FirstFace = 0;
+        
+        for (u32 j = 0; j <= Chunk.Statements.size(); ++j)
+        {
+            /* Add the faces until the next statement to the current group */
+            Range.LastFace = (j < Chunk.Statements.size() ? Chunk.Statements[j].FaceIndex : Chunk.Faces.size() - 1);
+            
+            if (Range.LastFace > Range.FirstFace)
+            {
+                checkGroupExistence();
+                CurGroup_->FaceRanges.push_back(Range);
+            }
+            
+            Range.FirstFace = Range.LastFace;
+            
+            if (j == Chunk.Statements.size())
+                break;
+            
+            /* Apply the statement */
+            const SStatementOBJ& Statement = Chunk.Statements[j];
+            
+            switch (Statement.Type)
+            {
+                case 'g':
+                    if (!Statement.Argument.size())
+                        return exitWithError("Group defined but name is missing", false);
+                    createNewGroup(Statement.Argument);
+                    break;
+                    
+                case 'o':
+                    if (!Statement.Argument.size())
+                        return exitWithError("Object defined but name is missing", false);
+                    Mesh_->setName(Statement.Argument);
+                    break;
+                    
+                case 'u':
+                {
+                    checkGroupExistence();
+                    
+                    if (!Statement.Argument.size())
+                        return exitWithError("Material used but name is missing", false);
+                    
+                    MaterialType::iterator it = Materials_.find(Statement.Argument.str());
+                    
+                    if (it != Materials_.end())
+                        CurGroup_->Material = &(it->second);
+                    else
+                        io::Log::warning("Could not find material \"" + Statement.Argument + "\"");
+                }
+                break;
+                
+                case 'm':
+                    Line_ = Statement.Argument;
+                    if (!parseMaterialLibrary())
+                        return false;
+                    break;
+            }
+        }
+    }
+    
+    return true;
+}
+
+bool MeshLoaderOBJ::buildModelFromChunks()
+{
+    /* Merge the vertex elements of all chunks and store the chunk offsets to resolve the chunk-local indices */
+    std::vector<u32> CoordOffsets(Chunks_.size()), TexCoordOffsets(Chunks_.size()), NormalOffsets(Chunks_.size());
+    
+    u32 NumCoords = 0, NumTexCoords = 0, NumNormals = 0;
+    
+    for (u32 i = 0; i < Chunks_.size(); ++i)
+    {
+        CoordOffsets[i]     = NumCoords;
+        TexCoordOffsets[i]  = NumTexCoords;
+        NormalOffsets[i]    = NumNormals;
+        
+        NumCoords       += Chunks_[i].Coords.size();
+        NumTexCoords    += Chunks_[i].TexCoords.size();
+        NumNormals      += Chunks_[i].Normals.size();
+    }
+    
+    VertexCoords_.reserve(NumCoords);
+    VertexTexCoords_.reserve(NumTexCoords);
+    VertexNormals_.reserve(NumNormals);
+    
+    foreach (SChunkOBJ &Chunk, Chunks_)
+    {
+        VertexCoords_.insert(VertexCoords_.end(), Chunk.Coords.begin(), Chunk.Coords.end());
+        VertexTexCoords_.insert(VertexTexCoords_.end(), Chunk.TexCoords.begin(), Chunk.TexCoords.end());
+        VertexNormals_.insert(VertexNormals_.end(), Chunk.Normals.begin(), Chunk.Normals.end());
+        
+        std::vector<dim::vector3df>().swap(Chunk.Coords);
+        std::vector<dim::point2df>().swap(Chunk.TexCoords);
+        std::vector<dim::vector3df>().swap(Chunk.Normals);
+    }
+    
+    std::vector<SVertexKeyOBJ> Vertices;
+    std::vector<u32> Indices;
+    
+    foreach (const SGroupOBJ &Group, GroupList_)
+    {
+        /* Count the face corners of this group */
+        u32 NumCorners = 0;
+        
+        foreach (const SFaceRangeOBJ &Range, Group.FaceRanges)
+        {
+            const SChunkOBJ& Chunk = Chunks_[Range.Chunk];
+            NumCorners += Chunk.Faces[Range.LastFace] - Chunk.Faces[Range.FirstFace];
+        }
+        
+        if (!NumCorners)
+            continue;
+        
+        /* Share equal vertices and triangulate the faces */
+        VertexHashMapOBJ VertexMap(NumCorners);
+        
+        Vertices.clear();
+        Indices.clear();
+        
+        foreach (const SFaceRangeOBJ &Range, Group.FaceRanges)
+        {
+            const SChunkOBJ& Chunk = Chunks_[Range.Chunk];
+            
+            for (u32 f = Range.FirstFace; f < Range.LastFace; ++f)
+            {
+                const u32 FirstCorner = Chunk.Faces[f], LastCorner = Chunk.Faces[f + 1];
+                u32 FirstIndex = 0, PrevIndex = 0;
+                
+                for (u32 c = FirstCorner; c < LastCorner; ++c)
+                {
+                    const SCornerOBJ& Corner = Chunk.Corners[c];
+                    
+                    /* Resolve the absolute and chunk-local indices */
+                    SVertexKeyOBJ Key;
+                    {
+                        Key.Coord       = resolveIndexOBJ(Corner.Coord,     CoordOffsets[Range.Chunk]   );
+                        Key.TexCoord    = resolveIndexOBJ(Corner.TexCoord,  TexCoordOffsets[Range.Chunk]);
+                        Key.Normal      = resolveIndexOBJ(Corner.Normal,    NormalOffsets[Range.Chunk]  );
+                    }
+                    
+                    if (Key.Coord >= NumCoords)
+                        return exitWithError("Invalid index for vertex coordiante", false);
+                    if (Key.TexCoord != ~0u && Key.TexCoord >= NumTexCoords)
+                        return exitWithError("Invalid index for texture coordiante", false);
+                    if (Key.Normal != ~0u && Key.Normal >= NumNormals)
+                        return exitWithError("Invalid index for vertex normal", false);
+                    
+                    const u32 Index = VertexMap.insert(Key, Vertices.size());
+                    
+                    if (Index == Vertices.size())
+                        Vertices.push_back(Key);
+                    
+                    /* Create triangle fan */
+                    if (c == FirstCorner)
+                        FirstIndex = Index;
+                    else if (c > FirstCorner + 1)
+                    {
+                        Indices.push_back(FirstIndex);
+                        Indices.push_back(PrevIndex);
+                        Indices.push_back(Index);
+                    }
+                    
+                    PrevIndex = Index;
+                }
+            }
+        }
+        
+        /* Create new surface */
+        video::MeshBuffer* Surface = Mesh_->createMeshBuffer();
+        
+        Surface->setName(Group.Name);
+        
+        video::color DiffuseColor(255);
+        
+        /* Apply material */
+        if (Group.Material)
+        {
+            DiffuseColor = Group.Material->Diffuse;
+            
+            if (Group.Material->ColorMap)
+                Surface->addTexture(Group.Material->ColorMap);
+        }
+        
+        /* Fill the vertex buffer */
+        const u32 NumVertices = Vertices.size();
+        
+        Surface->addVertices(NumVertices);
+        
+        for (u32 i = 0; i < NumVertices; ++i)
+        {
+            const SVertexKeyOBJ& Key = Vertices[i];
+            
+            Surface->setVertexCoord(i, VertexCoords_[Key.Coord]);
+            Surface->setVertexColor(i, DiffuseColor);
+            
+            if (Key.TexCoord != ~0u)
+            {
+                const dim::point2df& TexCoord = VertexTexCoords_[Key.TexCoord];
+                Surface->setVertexTexCoord(i, dim::vector3df(TexCoord.X, TexCoord.Y, 0.0f));
+            }
+            if (Key.Normal != ~0u)
+                Surface->setVertexNormal(i, VertexNormals_[Key.Normal]);
+        }
+        
+        /* Fill the index buffer (large models need 32-bit indices) */
+        if (NumVertices > USHRT_MAX)
+            Surface->setIndexFormat(video::DATATYPE_UNSIGNED_INT);
+        
+        Surface->addIndices(Indices.size());
+        
+        for (u32 i = 0; i < Indices.size(); ++i)
+            Surface->setPrimitiveIndex(i, Indices[i]);
+    }
+    
+    Chunks_.clear();
+    
+    Mesh_->updateMeshBuffer();
+    
+    return true;
+}
+
 bool MeshLoaderOBJ::getNextToken()
 {
     if (!Line_.size())
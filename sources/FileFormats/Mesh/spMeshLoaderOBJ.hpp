@@ -28,6 +28,12 @@ namespace scene
 {
 
 
+/**
+OBJ mesh loader. By default the whole file is read at once and split into chunks at line boundaries.
+The chunks are parsed in parallel with non-allocating number parsers and merged afterwards,
+whereby equal vertices (same coordinate, texture coordinate and normal index) are shared in each mesh buffer.
+\see MESHFLAG_LINE_BY_LINE_PARSING
+*/
 class SP_EXPORT MeshLoaderOBJ : public MeshLoader
 {
     
@@ -40,6 +46,8 @@ class SP_EXPORT MeshLoaderOBJ : public MeshLoader
         
     private:
         
+        friend void MeshLoaderOBJTaskProc(u32 Index, void* UserData);
+        
         /* === Enumerations === */
         
         enum ETokenFlags
@@ -75,6 +83,14 @@ class SP_EXPORT MeshLoaderOBJ : public MeshLoader
             video::Texture* ColorMap;
         };
         
+        //! Range of faces in a parsed chunk (fast parser).
+        struct SFaceRangeOBJ
+        {
+            u32 Chunk;
+            u32 FirstFace;
+            u32 LastFace;
+        };
+        
         struct SGroupOBJ
         {
             SGroupOBJ() : Material(0)
@@ -88,6 +104,47 @@ class SP_EXPORT MeshLoaderOBJ : public MeshLoader
             io::stringc Name;
             SMaterialOBJ* Material;
             std::list<SFaceOBJ> Faces;
+            std::vector<SFaceRangeOBJ> FaceRanges;
+        };
+        
+        //! Face corner of the fast parser. Positive indices are absolute (beginning with 1), negative indices are biased chunk-local indices and 0 means missing.
+        struct SCornerOBJ
+        {
+            s32 Coord;
+            s32 TexCoord;
+            s32 Normal;
+        };
+        
+        //! Statement which changes the parser state (group, material etc.). These are applied in file order after parsing.
+        struct SStatementOBJ
+        {
+            c8 Type;
+            u32 FaceIndex;
+            io::stringc Argument;
+        };
+        
+        //! Chunk of the file which is parsed by one worker thread.
+        struct SChunkOBJ
+        {
+            SChunkOBJ() : Begin(0), End(0)
+            {
+            }
+            ~SChunkOBJ()
+            {
+            }
+            
+            /* Members */
+            const c8* Begin;
+            const c8* End;
+            
+            std::vector<dim::vector3df> Coords;
+            std::vector<dim::point2df> TexCoords;
+            std::vector<dim::vector3df> Normals;
+            
+            std::vector<SCornerOBJ> Corners;
+            std::vector<u32> Faces; //!< Offset of each face in the corner list (the last entry marks the end).
+            
+            std::vector<SStatementOBJ> Statements;
         };
         
         /* === Type definitions === */
@@ -99,6 +156,12 @@ class SP_EXPORT MeshLoaderOBJ : public MeshLoader
         bool parseFile(io::File* CurFile);
         bool buildModel();
         
+        bool parseFileParallel(io::File* CurFile);
+        bool applyStatements();
+        bool buildModelFromChunks();
+        
+        static void parseChunk(SChunkOBJ &Chunk);
+        
         void createNewGroup(const io::stringc &Name);
         void createNewMaterial(const io::stringc &Name);
         void checkGroupExistence();
@@ -137,6 +200,9 @@ class SP_EXPORT MeshLoaderOBJ : public MeshLoader
         SMaterialOBJ* CurMaterial_;
         MaterialType Materials_;
         
+        std::vector<c8> FileBuffer_;
+        std::vector<SChunkOBJ> Chunks_;
+        
 };
 
 
@@ -40,13 +40,37 @@ class SP_EXPORT AudioStream
         virtual bool openFile(const io::stringc &Filename) = 0;
         virtual void closeFile() = 0;
         
+        /**
+        Fills the specified PCM buffer with new data by streaming the active audio file.
+        This function does not allocate any memory, thus it can be used on a decoder thread with a reused buffer.
+        \param[out] BufferPCM Pointer to the raw PCM audio buffer.
+        \param[in] Size Specifies the buffer size (in bytes). The audio stream will fill the whole buffer until the end of the stream.
+        \return Count of bytes which have been written into the buffer. This is 0 at the end of the stream or on failure.
+        \see AudioStreamService
+        \since Version 3.3
+        */
+        virtual u32 stream(s8* BufferPCM, u32 Size) = 0;
+        
+        /**
+        Restarts the stream from the beginning. This is used to loop streams.
+        \return True on success. By default false, i.e. the stream can not be restarted.
+        \since Version 3.3
+        */
+        virtual bool rewind()
+        {
+            return false;
+        }
+        
         /**
         Fills the specified PCM buffer with new data by streaming the active audio file.
         \param[in,out] BufferPCM Specifies the raw PCM audio buffer. The buffer must nut be empty.
         The audio stream will fill the whole buffer until the end of the stream.
         \return True on success. Otherwise streaming is not possible or the specified buffer is empty.
         */
-        virtual bool stream(std::vector<s8> &BufferPCM) = 0;
+        inline bool stream(std::vector<s8> &BufferPCM)
+        {
+            return !BufferPCM.empty() && stream(&BufferPCM[0], static_cast<u32>(BufferPCM.size())) > 0;
+        }
         
         /* === Inline functions === */
         
@@ -55,16 +79,40 @@ class SP_EXPORT AudioStream
             return Format_;
         }
         
+        //! Returns the sample rate (in Hz). This is valid after the file has been opened.
+        inline u32 getSampleRate() const
+        {
+            return SampleRate_;
+        }
+        
+        //! Returns the size of one frame (in bytes), i.e. the size of one sample for each channel.
+        inline u32 getFrameSize() const
+        {
+            switch (Format_)
+            {
+                case WAVECHANNEL_MONO8:
+                    return 1;
+                case WAVECHANNEL_MONO16:
+                case WAVECHANNEL_STEREO8:
+                    return 2;
+                case WAVECHANNEL_STEREO16:
+                    return 4;
+            }
+            return 1;
+        }
+        
     protected:
         
         AudioStream() :
-            Format_(WAVECHANNEL_MONO8)
+            Format_     (WAVECHANNEL_MONO8  ),
+            SampleRate_ (0                  )
         {
         }
         
         /* === Members === */
         
         EWaveChannelFormats Format_;
+        u32 SampleRate_;
         
 };
 
@@ -20,7 +20,10 @@ namespace audio
 
 
 AudioStreamOGG::AudioStreamOGG() :
-    AudioStream()
+    AudioStream     (   ),
+    OggFile_        (0  ),
+    VorbisInfo_     (0  ),
+    VorbisComment_  (0  )
 {
 }
 AudioStreamOGG::~AudioStreamOGG()
@@ -45,6 +48,7 @@ bool AudioStreamOGG::openFile(const io::stringc &Filename)
     if ( ( Result = ov_open(OggFile_, &OggStream_, 0, 0) ) < 0 )
     {
         fclose(OggFile_);
+        OggFile_ = 0;
         io::Log::error("Could not open 'Ogg Vorbis' stream (" + AudioStreamOGG::getErrorString(Result) + ")");
         return false;
     }
@@ -58,36 +62,37 @@ bool AudioStreamOGG::openFile(const io::stringc &Filename)
     else
         Format_ = WAVECHANNEL_STEREO16;
     
+    SampleRate_ = static_cast<u32>(VorbisInfo_->rate);
+    
     return true;
 }
 
 void AudioStreamOGG::closeFile()
 {
-    if (OggStream_)
-        ov_clear(&OggStream_);
     if (OggFile_)
     {
-        fclose(OggFile_);
+        /* Clear the stream (this also closes the file) */
+        ov_clear(&OggStream_);
         OggFile_ = 0;
     }
 }
 
-bool AudioStreamOGG::stream(std::vector<s8> &BufferPCM)
+u32 AudioStreamOGG::stream(s8* BufferPCM, u32 BufferSize)
 {
-    if (BufferPCM.empty() || !OggFile_)
-        return false;
+    if (!BufferPCM || !BufferSize || !OggFile_)
+        return 0;
     
-    size_t Size = 0;
+    u32 Size = 0;
     s32 Section = 0;
     s32 Result = 0;
     
-    while (Size < BufferPCM.size())
+    while (Size < BufferSize)
     {
         /* Read next stream block */
         Result = ov_read(
             &OggStream_,                // Ogg vorbis stream.
-            (&BufferPCM[0]) + Size,     // Pointer to the buffer with offset.
-            BufferPCM.size() - Size,    // Typical buffer length is 4096.
+            reinterpret_cast<char*>(BufferPCM + Size), // Pointer to the buffer with offset.
+            BufferSize - Size,          // Typical buffer length is 4096.
             0,                          // 0 for little endian byte packing.
             2,                          // 2 for 16-bit samples.
             1,                          // 1 for signed data.
@@ -100,15 +105,18 @@ bool AudioStreamOGG::stream(std::vector<s8> &BufferPCM)
         else if (Result < 0)
         {
             io::Log::error("Streaming 'Ogg Vorbis' file failed (" + AudioStreamOGG::getErrorString(Result) + ")");
-            return false;
+            break;
         }
         else
             break;
     }
     
-    //alBufferData(buffer, format, data, size, vorbisInfo->rate);
-    
-    return Size > 0;
+    return Size;
+}
+
+bool AudioStreamOGG::rewind()
+{
+    return OggFile_ && ov_raw_seek(&OggStream_, 0) == 0;
 }
 
 
@@ -41,7 +41,10 @@ class SP_EXPORT AudioStreamOGG : public AudioStream
         bool openFile(const io::stringc &Filename);
         void closeFile();
         
-        bool stream(std::vector<s8> &BufferPCM);
+        u32 stream(s8* BufferPCM, u32 Size);
+        bool rewind();
+        
+        using AudioStream::stream;
         
     private:
         
@@ -0,0 +1,447 @@
+/*
+ * Audio stream service file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "FileFormats/Sound/spAudioStreamService.hpp"
+#include "Base/spInputOutputLog.hpp"
+#include "Base/spMemoryManagement.hpp"
+#include "Base/spMath.hpp"
+
+#include <boost/foreach.hpp>
+#include <algorithm>
+
+
+namespace sp
+{
+namespace audio
+{
+
+
+/*
+ * Internal functions
+ */
+
+//! Orders the memory accesses between the producer and the consumer thread of a ring buffer.
+static inline void memoryBarrier()
+{
+    #if defined(SP_COMPILER_VC)
+    MemoryBarrier();
+    #else
+    __sync_synchronize();
+    #endif
+}
+
+THREAD_PROC(AudioStreamServiceThreadProc)
+{
+    AudioStreamService* Service = static_cast<AudioStreamService*>(Arguments);
+    
+    while (Service->isThreadRunning_)
+    {
+        /* Sleep until a stream has been read or created when all streams are filled */
+        if (!Service->decodeNextChunk())
+            Service->WorkSignal_.wait();
+    }
+    
+    Service->ExitSignal_.post();
+    
+    return 0;
+}
+
+
+/*
+ * AudioRingBuffer class
+ */
+
+AudioRingBuffer::AudioRingBuffer(u32 Capacity) :
+    Buffer_     (0),
+    Capacity_   (16),
+    Mask_       (0),
+    ReadPos_    (0),
+    WritePos_   (0)
+{
+    while (Capacity_ < Capacity)
+        Capacity_ <<= 1;
+    
+    Mask_   = Capacity_ - 1;
+    Buffer_ = new s8[Capacity_];
+}
+AudioRingBuffer::~AudioRingBuffer()
+{
+    delete [] Buffer_;
+}
+
+u32 AudioRingBuffer::write(const void* Data, u32 Size)
+{
+    const u32 WritePos = WritePos_;
+    const u32 ReadPos = ReadPos_;
+    
+    /* Don't overwrite the data before the consumer has read it */
+    memoryBarrier();
+    
+    Size = math::Min(Size, Capacity_ - (WritePos - ReadPos));
+    
+    /* Copy the data in (at most) two parts */
+    const u32 Offset = (WritePos & Mask_);
+    const u32 FirstSize = math::Min(Size, Capacity_ - Offset);
+    
+    memcpy(Buffer_ + Offset, Data, FirstSize);
+    memcpy(Buffer_, static_cast<const s8*>(Data) + FirstSize, Size - FirstSize);
+    
+    commitWrite(Size);
+    
+    return Size;
+}
+
+u32 AudioRingBuffer::read(void* Data, u32 Size)
+{
+    const u32 ReadPos = ReadPos_;
+    const u32 WritePos = WritePos_;
+    
+    /* Don't read the data before the producer has written it */
+    memoryBarrier();
+    
+    Size = math::Min(Size, WritePos - ReadPos);
+    
+    /* Copy the data in (at most) two parts */
+    const u32 Offset = (ReadPos & Mask_);
+    const u32 FirstSize = math::Min(Size, Capacity_ - Offset);
+    
+    memcpy(Data, Buffer_ + Offset, FirstSize);
+    memcpy(static_cast<s8*>(Data) + FirstSize, Buffer_, Size - FirstSize);
+    
+    /* Release the space only after the data has been copied */
+    memoryBarrier();
+    
+    ReadPos_ = ReadPos + Size;
+    
+    return Size;
+}
+
+u32 AudioRingBuffer::getWriteRegion(s8* &Data)
+{
+    const u32 WritePos = WritePos_;
+    const u32 Free = Capacity_ - (WritePos - ReadPos_);
+    
+    memoryBarrier();
+    
+    const u32 Offset = (WritePos & Mask_);
+    
+    Data = Buffer_ + Offset;
+    
+    return math::Min(Free, Capacity_ - Offset);
+}
+
+void AudioRingBuffer::commitWrite(u32 Size)
+{
+    /* Publish the position only after the data has been written */
+    memoryBarrier();
+    WritePos_ = WritePos_ + Size;
+}
+
+u32 AudioRingBuffer::getReadableSize() const
+{
+    return WritePos_ - ReadPos_;
+}
+
+u32 AudioRingBuffer::getWritableSize() const
+{
+    return Capacity_ - (WritePos_ - ReadPos_);
+}
+
+void AudioRingBuffer::clear()
+{
+    ReadPos_    = 0;
+    WritePos_   = 0;
+}
+
+
+/*
+ * AudioStreamChannel class
+ */
+
+AudioStreamChannel::AudioStreamChannel(
+    AudioStreamService* Service, AudioStream* Stream, u32 Capacity, bool isLoop) :
+    Service_        (Service                ),
+    Stream_         (Stream                 ),
+    RingBuffer_     (Capacity               ),
+    FrameSize_      (Stream->getFrameSize() ),
+    Priority_       (1.0f                   ),
+    isFinished_     (false                  ),
+    isLoop_         (isLoop                 ),
+    NumUnderruns_   (0                      ),
+    isRewound_      (false                  )
+{
+}
+AudioStreamChannel::~AudioStreamChannel()
+{
+}
+
+u32 AudioStreamChannel::read(s8* BufferPCM, u32 NumFrames)
+{
+    if (!BufferPCM || !NumFrames)
+        return 0;
+    
+    /* Read complete frames only (the decoder may have written a part of a frame) */
+    const bool isEndOfStream = isFinished_;
+    
+    const u32 NumAvailFrames = RingBuffer_.getReadableSize() / FrameSize_;
+    const u32 NumReadFrames = math::Min(NumFrames, NumAvailFrames);
+    
+    RingBuffer_.read(BufferPCM, NumReadFrames * FrameSize_);
+    
+    if (NumReadFrames < NumFrames && !isEndOfStream)
+        ++NumUnderruns_;
+    
+    /* Wake up the decoder thread when there is enough space for the next chunk */
+    if (!isEndOfStream && AudioStreamService::isRefillRequired(RingBuffer_))
+        Service_->wakeUpDecoder();
+    
+    return NumReadFrames;
+}
+
+
+/*
+ * AudioStreamService class
+ */
+
+AudioStreamService::AudioStreamService(u32 ChunkSize) :
+    ChunkSize_          (math::Max(ChunkSize, 64u)  ),
+    DecodingChannel_    (0                          ),
+    NumDecodeWaiters_   (0                          ),
+    Thread_             (0                          ),
+    isThreadRunning_    (true                       ),
+    isThreadIdle_       (false                      ),
+    NumDecodedBytes_    (0                          )
+{
+    Thread_ = new ThreadManager(AudioStreamServiceThreadProc, this);
+}
+AudioStreamService::~AudioStreamService()
+{
+    /* Wait until the decoder thread has finished the current chunk */
+    isThreadRunning_ = false;
+    
+    WorkSignal_.post();
+    ExitSignal_.wait();
+    
+    MemoryManager::deleteMemory(Thread_);
+    
+    clearStreams();
+}
+
+AudioStreamChannel* AudioStreamService::createStream(AudioStream* Stream, f32 BufferDuration, bool isLoop)
+{
+    if (!Stream || !Stream->getSampleRate())
+    {
+        io::Log::error("Could not create audio stream channel for invalid or closed audio stream");
+        return 0;
+    }
+    
+    /* Allocate the ring buffer with room for at least two chunks */
+    const u32 Capacity = math::Max(
+        static_cast<u32>(math::Max(BufferDuration, 0.0f) * Stream->getSampleRate()) * Stream->getFrameSize(),
+        ChunkSize_ * 2
+    );
+    
+    AudioStreamChannel* Channel = new AudioStreamChannel(this, Stream, Capacity, isLoop);
+    
+    Mutex_.lock();
+    Streams_.push_back(Channel);
+    Mutex_.unlock();
+    
+    wakeUpDecoder();
+    
+    return Channel;
+}
+
+void AudioStreamService::deleteStream(AudioStreamChannel* Channel)
+{
+    if (!Channel)
+        return;
+    
+    /* Remove the channel while the decoder thread does not use it */
+    Mutex_.lock();
+    
+    std::vector<AudioStreamChannel*>::iterator it = std::find(Streams_.begin(), Streams_.end(), Channel);
+    
+    if (it != Streams_.end())
+        Streams_.erase(it);
+    else
+        Channel = 0;
+    
+    const bool isDecoding = (Channel && Channel == DecodingChannel_);
+    
+    if (isDecoding)
+        ++NumDecodeWaiters_;
+    
+    Mutex_.unlock();
+    
+    /* Wait until the decoder thread has finished the chunk of this channel */
+    if (isDecoding)
+        DecodeSignal_.wait();
+    
+    delete Channel;
+}
+
+void AudioStreamService::clearStreams()
+{
+    std::vector<AudioStreamChannel*> Channels;
+    
+    Mutex_.lock();
+    
+    Channels.swap(Streams_);
+    
+    const bool isDecoding = (DecodingChannel_ != 0);
+    
+    if (isDecoding)
+        ++NumDecodeWaiters_;
+    
+    Mutex_.unlock();
+    
+    if (isDecoding)
+        DecodeSignal_.wait();
+    
+    foreach (AudioStreamChannel* Channel, Channels)
+        delete Channel;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void AudioStreamService::wakeUpDecoder()
+{
+    /* Only signal the semaphore when the decoder thread is going to sleep */
+    memoryBarrier();
+    
+    if (isThreadIdle_)
+    {
+        isThreadIdle_ = false;
+        WorkSignal_.post();
+    }
+}
+
+bool AudioStreamService::decodeNextChunk()
+{
+    /*
+    Announce the idle state before searching, so a reader which frees space
+    after the search always sees it and wakes up the thread (see wakeUpDecoder).
+    */
+    isThreadIdle_ = true;
+    memoryBarrier();
+    
+    Mutex_.lock();
+    
+    /* Find the most urgent stream */
+    AudioStreamChannel* NextChannel = 0;
+    f32 MaxUrgency = -2.0f;
+    
+    foreach (AudioStreamChannel* Channel, Streams_)
+    {
+        const f32 Urgency = AudioStreamService::getStreamUrgency(Channel);
+        
+        if (MaxUrgency < Urgency)
+        {
+            NextChannel = Channel;
+            MaxUrgency  = Urgency;
+        }
+    }
+    
+    if (!NextChannel)
+    {
+        Mutex_.unlock();
+        return false;
+    }
+    
+    isThreadIdle_ = false;
+    
+    /* Deleting this channel waits until the chunk has been published */
+    DecodingChannel_ = NextChannel;
+    
+    Mutex_.unlock();
+    
+    /* Decode the next chunk without blocking the other threads */
+    s8* Region = 0;
+    const u32 Size = math::Min(NextChannel->RingBuffer_.getWriteRegion(Region), ChunkSize_);
+    
+    const u32 DecodedSize = NextChannel->Stream_->stream(Region, Size);
+    
+    /* Restart the stream (but don't try again if the stream is empty after rewinding) */
+    const bool hasRewound = (
+        !DecodedSize && NextChannel->isLoop_ && !NextChannel->isRewound_ && NextChannel->Stream_->rewind()
+    );
+    
+    /* Publish the chunk and release the channel */
+    Mutex_.lock();
+    
+    publishChunk(NextChannel, DecodedSize, hasRewound);
+    
+    DecodingChannel_ = 0;
+    
+    if (NumDecodeWaiters_ > 0)
+    {
+        DecodeSignal_.post(NumDecodeWaiters_);
+        NumDecodeWaiters_ = 0;
+    }
+    
+    Mutex_.unlock();
+    
+    return true;
+}
+
+void AudioStreamService::publishChunk(AudioStreamChannel* Channel, u32 DecodedSize, bool hasRewound)
+{
+    if (DecodedSize > 0)
+    {
+        Channel->RingBuffer_.commitWrite(DecodedSize);
+        Channel->isRewound_ = false;
+        NumDecodedBytes_ = NumDecodedBytes_ + DecodedSize;
+    }
+    else if (hasRewound)
+        Channel->isRewound_ = true;
+    else
+        Channel->isFinished_ = true;
+}
+
+f32 AudioStreamService::getStreamUrgency(const AudioStreamChannel* Channel)
+{
+    if (Channel->isFinished_)
+        return -2.0f;
+    
+    const AudioRingBuffer &RingBuffer = Channel->RingBuffer_;
+    
+    if (!AudioStreamService::isRefillRequired(RingBuffer))
+        return -2.0f;
+    
+    const u32 WritableSize = RingBuffer.getWritableSize();
+    
+    /*
+    Audible streams are refilled before inaudible streams.
+    The emptier the buffer and the louder the stream, the more urgent it is.
+    */
+    const f32 Fill = 1.0f - static_cast<f32>(WritableSize) / RingBuffer.getCapacity();
+    const f32 Priority = Channel->Priority_;
+    
+    if (Priority > 0.0f)
+        return Priority * (1.0f - Fill) + math::ROUNDING_ERROR;
+    
+    return -Fill;
+}
+
+bool AudioStreamService::isRefillRequired(const AudioRingBuffer &RingBuffer)
+{
+    /* Don't decode into small gaps to keep the decoding efficient */
+    return RingBuffer.getWritableSize() >= RingBuffer.getCapacity() / 8;
+}
+
+
+} // /namespace audio
+
+} // /namespace sp
+
+
+
+// ================================================================================
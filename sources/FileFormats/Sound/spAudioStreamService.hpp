@@ -0,0 +1,335 @@
+/*
+ * Audio stream service header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_AUDIO_STREAM_SERVICE_H__
+#define __SP_AUDIO_STREAM_SERVICE_H__
+
+
+#include "Base/spStandard.hpp"
+#include "Base/spCriticalSection.hpp"
+#include "Base/spThreadManager.hpp"
+#include "Base/spSemaphore.hpp"
+#include "FileFormats/Sound/spAudioStream.hpp"
+
+#include <vector>
+
+
+namespace sp
+{
+namespace audio
+{
+
+
+class AudioStreamService;
+
+
+/**
+Lock-free single-producer/single-consumer ring buffer for raw PCM data.
+One thread may write and one other thread may read at the same time without any locks.
+The buffer is allocated only once in the constructor.
+\since Version 3.3
+\ingroup group_audio
+*/
+class SP_EXPORT AudioRingBuffer
+{
+    
+    public:
+        
+        //! \param Capacity Specifies the buffer size (in bytes). This will be rounded up to the next power of two.
+        AudioRingBuffer(u32 Capacity);
+        ~AudioRingBuffer();
+        
+        /* === Functions === */
+        
+        /**
+        Writes the specified data into the ring buffer. Only call this from the producer thread.
+        \return Count of bytes which have been written. This is less than "Size" if the buffer is full.
+        */
+        u32 write(const void* Data, u32 Size);
+        
+        /**
+        Reads data from the ring buffer. Only call this from the consumer thread.
+        \return Count of bytes which have been read. This is less than "Size" if the buffer runs empty.
+        */
+        u32 read(void* Data, u32 Size);
+        
+        /**
+        Returns the largest contiguous region which can be written without wrapping around.
+        Use this to decode directly into the ring buffer and call "commitWrite" afterwards.
+        Only call this from the producer thread.
+        \param[out] Data Receives the pointer to the writable region.
+        \return Size of the writable region (in bytes).
+        */
+        u32 getWriteRegion(s8* &Data);
+        
+        //! Makes the specified count of bytes, which have been written into the write region, visible to the consumer.
+        void commitWrite(u32 Size);
+        
+        //! Returns the count of bytes which can be read.
+        u32 getReadableSize() const;
+        //! Returns the count of bytes which can be written.
+        u32 getWritableSize() const;
+        
+        /**
+        Discards all data. Only call this when neither the producer nor the consumer accesses the buffer.
+        */
+        void clear();
+        
+        /* === Inline functions === */
+        
+        inline u32 getCapacity() const
+        {
+            return Capacity_;
+        }
+        
+    private:
+        
+        /* === Members === */
+        
+        s8* Buffer_;
+        u32 Capacity_;
+        u32 Mask_;
+        
+        /* Both positions increase continuously and are only masked when the buffer is accessed */
+        volatile u32 ReadPos_;
+        volatile u32 WritePos_;
+        
+};
+
+
+/**
+Audio stream channel. This is the handle of one stream of the audio stream service.
+The channel's ring buffer is kept filled by the decoder thread and is read by the playback thread.
+\see AudioStreamService
+\since Version 3.3
+\ingroup group_audio
+*/
+class SP_EXPORT AudioStreamChannel
+{
+    
+    public:
+        
+        /* === Functions === */
+        
+        /**
+        Reads the next decoded PCM frames. This never decodes or allocates memory, thus it can be called
+        from the main thread or an audio thread. Only one thread may read from the same channel.
+        \param[out] BufferPCM Pointer to the PCM buffer. The format is the format of the audio stream (see getFormat).
+        \param[in] NumFrames Specifies the count of frames which are to be read.
+        \return Count of frames which have been read. If this is less than "NumFrames", the stream has reached its end
+        or the decoder thread could not keep up (see getNumUnderruns).
+        */
+        u32 read(s8* BufferPCM, u32 NumFrames);
+        
+        /* === Inline functions === */
+        
+        inline AudioStream* getStream() const
+        {
+            return Stream_;
+        }
+        
+        inline EWaveChannelFormats getFormat() const
+        {
+            return Stream_->getFormat();
+        }
+        inline u32 getSampleRate() const
+        {
+            return Stream_->getSampleRate();
+        }
+        inline u32 getFrameSize() const
+        {
+            return FrameSize_;
+        }
+        
+        /**
+        Sets the decoding priority. Use the audibility of the stream, e.g. the volume after the 3D attenuation.
+        The decoder thread refills the streams with the highest priority first. Streams with a priority of 0 or less
+        are only refilled when all audible streams are filled. By default 1.0.
+        */
+        inline void setPriority(f32 Priority)
+        {
+            Priority_ = Priority;
+        }
+        inline f32 getPriority() const
+        {
+            return Priority_;
+        }
+        
+        //! Returns the count of buffered frames.
+        inline u32 getNumBufferedFrames() const
+        {
+            return RingBuffer_.getReadableSize() / FrameSize_;
+        }
+        //! Returns the buffer capacity (in frames).
+        inline u32 getCapacity() const
+        {
+            return RingBuffer_.getCapacity() / FrameSize_;
+        }
+        
+        //! Returns true if the stream has been decoded completely. The buffered frames can still be read.
+        inline bool finished() const
+        {
+            return isFinished_;
+        }
+        //! Returns true if the stream has been decoded completely and all frames have been read.
+        inline bool empty() const
+        {
+            return isFinished_ && !RingBuffer_.getReadableSize();
+        }
+        
+        //! Returns true if the stream is restarted when its end has been reached.
+        inline bool getLoop() const
+        {
+            return isLoop_;
+        }
+        
+        //! Returns how often "read" returned less frames than requested before the end of the stream.
+        inline u32 getNumUnderruns() const
+        {
+            return NumUnderruns_;
+        }
+        
+    private:
+        
+        friend class AudioStreamService;
+        
+        AudioStreamChannel(AudioStreamService* Service, AudioStream* Stream, u32 Capacity, bool isLoop);
+        ~AudioStreamChannel();
+        
+        /* === Members === */
+        
+        AudioStreamService* Service_;
+        AudioStream* Stream_;
+        AudioRingBuffer RingBuffer_;
+        
+        u32 FrameSize_;
+        
+        volatile f32 Priority_;
+        volatile bool isFinished_;
+        bool isLoop_;
+        
+        u32 NumUnderruns_;
+        
+        /* Decoder thread state */
+        bool isRewound_;
+        
+};
+
+
+/**
+The audio stream service decodes all streams on a background thread. Each stream has its own lock-free PCM ring buffer
+which is kept filled ahead of playback, so the playback thread never decodes or allocates memory for the audio.
+The decoder thread refills the streams in the order of their audibility and fill level.
+\code
+audio::AudioStreamService StreamService;
+audio::AudioStreamOGG* MusicFile = new audio::AudioStreamOGG();
+MusicFile->openFile("Music.ogg");
+audio::AudioStreamChannel* Music = StreamService.createStream(MusicFile, 2.0f, true);
+// ...
+// On the playback thread:
+Music->read(BufferPCM, NumFrames);
+\endcode
+\see AudioStream
+\since Version 3.3
+\ingroup group_audio
+*/
+class SP_EXPORT AudioStreamService
+{
+    
+    public:
+        
+        //! \param ChunkSize Specifies the maximal count of bytes which are decoded at once. By default 16 KB.
+        AudioStreamService(u32 ChunkSize = 16384);
+        ~AudioStreamService();
+        
+        /* === Functions === */
+        
+        /**
+        Creates a new stream channel. The audio stream must already be opened and must not be used anywhere else
+        until the channel has been deleted. The audio stream object will not be deleted by the service.
+        \param[in] Stream Pointer to the opened audio stream.
+        \param[in] BufferDuration Specifies how much audio is decoded ahead of playback (in seconds). By default 1 second.
+        \param[in] isLoop Specifies whether the stream is to be restarted when its end has been reached (see AudioStream::rewind).
+        \return Pointer to the new channel or null if the stream is invalid.
+        */
+        AudioStreamChannel* createStream(AudioStream* Stream, f32 BufferDuration = 1.0f, bool isLoop = false);
+        
+        //! Deletes the specified stream channel. The decoder thread stops streaming it.
+        void deleteStream(AudioStreamChannel* Channel);
+        
+        //! Deletes all stream channels.
+        void clearStreams();
+        
+        /* === Inline functions === */
+        
+        //! Returns the count of bytes which have been decoded since the service was created.
+        inline u64 getNumDecodedBytes() const
+        {
+            return NumDecodedBytes_;
+        }
+        
+        inline u32 getChunkSize() const
+        {
+            return ChunkSize_;
+        }
+        
+        inline const std::vector<AudioStreamChannel*>& getStreamList() const
+        {
+            return Streams_;
+        }
+        
+    private:
+        
+        friend class AudioStreamChannel;
+        friend THREAD_PROC(AudioStreamServiceThreadProc);
+        
+        /* === Functions === */
+        
+        void wakeUpDecoder();
+        
+        bool decodeNextChunk();
+        void publishChunk(AudioStreamChannel* Channel, u32 DecodedSize, bool hasRewound);
+        
+        /* === Static functions === */
+        
+        static f32 getStreamUrgency(const AudioStreamChannel* Channel);
+        static bool isRefillRequired(const AudioRingBuffer &RingBuffer);
+        
+        /* === Members === */
+        
+        CriticalSection Mutex_;
+        
+        std::vector<AudioStreamChannel*> Streams_;
+        
+        u32 ChunkSize_;
+        
+        /* Channel which is decoded outside the mutex and the threads which wait to delete it */
+        AudioStreamChannel* DecodingChannel_;
+        u32 NumDecodeWaiters_;
+        Semaphore DecodeSignal_;
+        
+        ThreadManager* Thread_;
+        Semaphore WorkSignal_;
+        Semaphore ExitSignal_;
+        volatile bool isThreadRunning_;
+        volatile bool isThreadIdle_;
+        
+        volatile u64 NumDecodedBytes_;
+        
+};
+
+
+} // /namespace audio
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
@@ -13,6 +13,7 @@
 #include "Base/spInputOutputLog.hpp"
 #include "Base/spTimer.hpp"
 #include "Base/spMemoryManagement.hpp"
+#include "Base/spProfiler.hpp"
 
 #include <lm.h>
 #include <Iphlpapi.h>
@@ -146,6 +147,8 @@ bool NetworkSystemUDP::sendPacket(const NetworkPacket &Packet, NetworkMember* Re
 
 bool NetworkSystemUDP::receivePacket(NetworkPacket &Packet, NetworkMember* &Sender)
 {
+    SP_PROFILE_SCOPE("NetworkSystemUDP::receivePacket");
+    
     if (!Socket_)
         return false;
     
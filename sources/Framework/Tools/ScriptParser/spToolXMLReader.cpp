@@ -0,0 +1,525 @@
+/*
+ * XML reader file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "Framework/Tools/ScriptParser/spToolXMLReader.hpp"
+
+#ifdef SP_COMPILE_WITH_XMLPARSER
+
+
+#include "Base/spInputOutputLog.hpp"
+#include "Base/spInputOutputFileSystem.hpp"
+
+#include <cstring>
+#include <cstdlib>
+
+
+namespace sp
+{
+namespace tool
+{
+
+
+static inline bool isXMLWhiteSpace(c8 Chr)
+{
+    return Chr == ' ' || Chr == '\t' || Chr == '\n' || Chr == '\r';
+}
+
+static inline bool isXMLNameChar(c8 Chr)
+{
+    return !isXMLWhiteSpace(Chr) && Chr != 0 && Chr != '<' && Chr != '>' && Chr != '/' && Chr != '=' && Chr != '\"' && Chr != '\'';
+}
+
+XMLReader::XMLReader() :
+    Pos_                (0              ),
+    Event_              (XMLEVENT_NONE  ),
+    IsRawText_          (false          ),
+    IsEmptyTag_         (false          ),
+    HasPendingEndTag_   (false          )
+{
+}
+XMLReader::~XMLReader()
+{
+}
+
+bool XMLReader::loadFile(const io::stringc &Filename)
+{
+    io::FileSystem FileSys;
+    
+    reset();
+    
+    if (!FileSys.readFileString(Filename, Buffer_))
+    {
+        io::Log::error("Could not read XML file: \"" + Filename + "\"");
+        Event_ = XMLEVENT_ERROR;
+        return false;
+    }
+    
+    return true;
+}
+
+void XMLReader::loadString(const io::stringc &XMLString)
+{
+    reset();
+    Buffer_ = XMLString;
+}
+
+EXMLReaderEvents XMLReader::next()
+{
+    if (Event_ == XMLEVENT_EOF || Event_ == XMLEVENT_ERROR)
+        return Event_;
+    
+    /* Generate the end event of an empty-element tag */
+    if (HasPendingEndTag_)
+    {
+        HasPendingEndTag_ = false;
+        IsEmptyTag_ = false;
+        Attributes_.clear();
+        TagStack_.pop_back();
+        return Event_ = XMLEVENT_TAG_END;
+    }
+    
+    IsEmptyTag_ = false;
+    Attributes_.clear();
+    
+    const u32 Size = Buffer_.size();
+    
+    while (Pos_ < Size)
+    {
+        if (Buffer_[Pos_] != '<')
+        {
+            /* Read text (white-space only texts are skipped) */
+            if (readText() == XMLEVENT_TEXT)
+                return Event_;
+            continue;
+        }
+        
+        /* Skip comments, processing instructions and document type declarations */
+        if (startsWith("<!--"))
+        {
+            if (!skipSequence("<!--", "-->"))
+                return exitWithError("Missing end of comment");
+        }
+        else if (startsWith("<![CDATA["))
+        {
+            const u32 Start = Pos_ + 9;
+            const c8* End = strstr(Buffer_.c_str() + Start, "]]>");
+            
+            if (!End)
+                return exitWithError("Missing end of CDATA section");
+            
+            Text_ = SStringView(Start, static_cast<u32>(End - Buffer_.c_str()) - Start);
+            IsRawText_ = true;
+            Pos_ = Text_.Offset + Text_.Length + 3;
+            
+            return Event_ = XMLEVENT_TEXT;
+        }
+        else if (startsWith("<?"))
+        {
+            if (!skipSequence("<?", "?>"))
+                return exitWithError("Missing end of processing instruction");
+        }
+        else if (startsWith("<!"))
+        {
+            if (!skipSequence("<!", ">"))
+                return exitWithError("Missing end of document type declaration");
+        }
+        else if (startsWith("</"))
+            return readEndTag();
+        else
+            return readStartTag();
+    }
+    
+    if (!TagStack_.empty())
+        return exitWithError("Unexpected end of file (tag \"" + getString(TagStack_.back()) + "\" has not been closed)");
+    
+    return Event_ = XMLEVENT_EOF;
+}
+
+bool XMLReader::parse(XMLContentHandler &Handler)
+{
+    while (1)
+    {
+        switch (next())
+        {
+            case XMLEVENT_TAG_START:
+                if (!Handler.startTag(*this))
+                    return true;
+                break;
+            case XMLEVENT_TAG_END:
+                if (!Handler.endTag(*this))
+                    return true;
+                break;
+            case XMLEVENT_TEXT:
+                if (!Handler.text(*this))
+                    return true;
+                break;
+            case XMLEVENT_EOF:
+                return true;
+            default:
+                return false;
+        }
+    }
+}
+
+bool XMLReader::skipTag()
+{
+    if (Event_ != XMLEVENT_TAG_START)
+        return Event_ != XMLEVENT_ERROR;
+    
+    const u32 Depth = TagStack_.size();
+    
+    while (1)
+    {
+        switch (next())
+        {
+            case XMLEVENT_TAG_END:
+                if (TagStack_.size() < Depth)
+                    return true;
+                break;
+            case XMLEVENT_EOF:
+                return true;
+            case XMLEVENT_ERROR:
+                return false;
+            default:
+                break;
+        }
+    }
+}
+
+io::stringc XMLReader::getName() const
+{
+    return getString(Name_);
+}
+
+bool XMLReader::isName(const c8* Name) const
+{
+    return compare(Name_, Name);
+}
+
+io::stringc XMLReader::getText() const
+{
+    return IsRawText_ ? getString(Text_) : decode(Text_);
+}
+
+io::stringc XMLReader::getAttributeName(u32 Index) const
+{
+    return Index < Attributes_.size() ? getString(Attributes_[Index].Name) : io::stringc();
+}
+
+io::stringc XMLReader::getAttributeValue(u32 Index) const
+{
+    return Index < Attributes_.size() ? decode(Attributes_[Index].Value) : io::stringc();
+}
+
+s32 XMLReader::findAttribute(const c8* Name) const
+{
+    for (u32 i = 0; i < Attributes_.size(); ++i)
+    {
+        if (compare(Attributes_[i].Name, Name))
+            return static_cast<s32>(i);
+    }
+    return -1;
+}
+
+io::stringc XMLReader::getAttributeValue(const c8* Name, const io::stringc &Default) const
+{
+    const s32 Index = findAttribute(Name);
+    return Index != -1 ? decode(Attributes_[Index].Value) : Default;
+}
+
+s32 XMLReader::getRow() const
+{
+    /* Count the lines up to the current position only when an error message needs it */
+    const u32 End = math::Min(Pos_, static_cast<u32>(Buffer_.size()));
+    s32 Row = 1;
+    
+    for (u32 i = 0; i < End; ++i)
+    {
+        if (Buffer_[i] == '\n')
+            ++Row;
+    }
+    
+    return Row;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void XMLReader::reset()
+{
+    Buffer_             = "";
+    Pos_                = 0;
+    Event_              = XMLEVENT_NONE;
+    Name_               = SStringView();
+    Text_               = SStringView();
+    IsRawText_          = false;
+    IsEmptyTag_         = false;
+    HasPendingEndTag_   = false;
+    
+    Attributes_.clear();
+    TagStack_.clear();
+}
+
+EXMLReaderEvents XMLReader::readStartTag()
+{
+    /* Read tag name */
+    ++Pos_;
+    
+    if (!readName(Name_))
+        return exitWithError("Missing tag name");
+    
+    /* Read attributes */
+    const u32 Size = Buffer_.size();
+    
+    while (1)
+    {
+        skipWhiteSpaces();
+        
+        if (Pos_ >= Size)
+            return exitWithError("Unexpected end of file in tag \"" + getName() + "\"");
+        
+        const c8 Chr = Buffer_[Pos_];
+        
+        if (Chr == '>')
+        {
+            ++Pos_;
+            break;
+        }
+        if (Chr == '/')
+        {
+            if (Pos_ + 1 >= Size || Buffer_[Pos_ + 1] != '>')
+                return exitWithError("Missing '>' after '/' in tag \"" + getName() + "\"");
+            
+            Pos_ += 2;
+            IsEmptyTag_ = true;
+            HasPendingEndTag_ = true;
+            break;
+        }
+        
+        /* Read attribute name */
+        SAttributeView Attrib;
+        
+        if (!readName(Attrib.Name))
+            return exitWithError("Unexpected character '" + io::stringc(Chr) + "' in tag \"" + getName() + "\"");
+        
+        /* Read '=' and the quoted attribute value */
+        skipWhiteSpaces();
+        
+        if (Pos_ >= Size || Buffer_[Pos_] != '=')
+            return exitWithError("Missing '=' after attribute \"" + getString(Attrib.Name) + "\"");
+        
+        ++Pos_;
+        skipWhiteSpaces();
+        
+        if (Pos_ >= Size || ( Buffer_[Pos_] != '\"' && Buffer_[Pos_] != '\'' ))
+            return exitWithError("Missing quoted value for attribute \"" + getString(Attrib.Name) + "\"");
+        
+        const c8 Quote = Buffer_[Pos_++];
+        const c8* End = strchr(Buffer_.c_str() + Pos_, Quote);
+        
+        if (!End)
+            return exitWithError("Missing end of value for attribute \"" + getString(Attrib.Name) + "\"");
+        
+        Attrib.Value = SStringView(Pos_, static_cast<u32>(End - Buffer_.c_str()) - Pos_);
+        Pos_ = Attrib.Value.Offset + Attrib.Value.Length + 1;
+        
+        Attributes_.push_back(Attrib);
+    }
+    
+    TagStack_.push_back(Name_);
+    
+    return Event_ = XMLEVENT_TAG_START;
+}
+
+EXMLReaderEvents XMLReader::readEndTag()
+{
+    /* Read tag name */
+    Pos_ += 2;
+    
+    if (!readName(Name_))
+        return exitWithError("Missing tag name in end tag");
+    
+    skipWhiteSpaces();
+    
+    if (Pos_ >= Buffer_.size() || Buffer_[Pos_] != '>')
+        return exitWithError("Missing '>' in end tag \"" + getName() + "\"");
+    
+    ++Pos_;
+    
+    /* Check if the end tag matches the last start tag */
+    if (TagStack_.empty())
+        return exitWithError("Unexpected end tag \"" + getName() + "\"");
+    if (!compare(TagStack_.back(), Name_))
+    {
+        return exitWithError(
+            "End tag \"" + getName() + "\" does not match start tag \"" + getString(TagStack_.back()) + "\""
+        );
+    }
+    
+    TagStack_.pop_back();
+    
+    return Event_ = XMLEVENT_TAG_END;
+}
+
+EXMLReaderEvents XMLReader::readText()
+{
+    const c8* Start = Buffer_.c_str() + Pos_;
+    const c8* End = strchr(Start, '<');
+    
+    if (!End)
+        End = Buffer_.c_str() + Buffer_.size();
+    
+    Pos_ = static_cast<u32>(End - Buffer_.c_str());
+    
+    /* Skip white-space only texts */
+    for (const c8* Chr = Start; Chr != End; ++Chr)
+    {
+        if (!isXMLWhiteSpace(*Chr))
+        {
+            Text_ = SStringView(static_cast<u32>(Start - Buffer_.c_str()), static_cast<u32>(End - Start));
+            IsRawText_ = false;
+            return Event_ = XMLEVENT_TEXT;
+        }
+    }
+    
+    return XMLEVENT_NONE;
+}
+
+bool XMLReader::skipSequence(const c8* Start, const c8* End)
+{
+    const c8* Str = strstr(Buffer_.c_str() + Pos_ + strlen(Start), End);
+    
+    if (!Str)
+        return false;
+    
+    Pos_ = static_cast<u32>(Str - Buffer_.c_str()) + strlen(End);
+    
+    return true;
+}
+
+void XMLReader::skipWhiteSpaces()
+{
+    while (Pos_ < Buffer_.size() && isXMLWhiteSpace(Buffer_[Pos_]))
+        ++Pos_;
+}
+
+bool XMLReader::readName(SStringView &Name)
+{
+    Name.Offset = Pos_;
+    
+    while (Pos_ < Buffer_.size() && isXMLNameChar(Buffer_[Pos_]))
+        ++Pos_;
+    
+    Name.Length = Pos_ - Name.Offset;
+    
+    return Name.Length > 0;
+}
+
+bool XMLReader::startsWith(const c8* Str) const
+{
+    return strncmp(Buffer_.c_str() + Pos_, Str, strlen(Str)) == 0;
+}
+
+bool XMLReader::compare(const SStringView &View, const c8* Str) const
+{
+    return Str && strncmp(Buffer_.c_str() + View.Offset, Str, View.Length) == 0 && Str[View.Length] == 0;
+}
+
+bool XMLReader::compare(const SStringView &ViewA, const SStringView &ViewB) const
+{
+    return ViewA.Length == ViewB.Length && memcmp(Buffer_.c_str() + ViewA.Offset, Buffer_.c_str() + ViewB.Offset, ViewA.Length) == 0;
+}
+
+io::stringc XMLReader::getString(const SStringView &View) const
+{
+    io::stringc Str;
+    Str.str().assign(Buffer_.c_str() + View.Offset, View.Length);
+    return Str;
+}
+
+io::stringc XMLReader::decode(const SStringView &View) const
+{
+    const c8* Start = Buffer_.c_str() + View.Offset;
+    const c8* End = Start + View.Length;
+    
+    /* Only allocate the string once when there are no entities */
+    if (!memchr(Start, '&', View.Length))
+        return getString(View);
+    
+    io::stringc Str;
+    Str.str().reserve(View.Length);
+    
+    for (const c8* Chr = Start; Chr != End; ++Chr)
+    {
+        if (*Chr != '&')
+        {
+            Str.str() += *Chr;
+            continue;
+        }
+        
+        /* Find end of entity */
+        const c8* Semicolon = static_cast<const c8*>(memchr(Chr, ';', End - Chr));
+        
+        if (!Semicolon)
+        {
+            Str.str() += *Chr;
+            continue;
+        }
+        
+        const std::string Entity(Chr + 1, Semicolon);
+        
+        if (Entity == "amp")
+            Str.str() += '&';
+        else if (Entity == "lt")
+            Str.str() += '<';
+        else if (Entity == "gt")
+            Str.str() += '>';
+        else if (Entity == "quot")
+            Str.str() += '\"';
+        else if (Entity == "apos")
+            Str.str() += '\'';
+        else if (Entity.size() > 1 && Entity[0] == '#')
+        {
+            /* Decode character reference (e.g. "&#65;" or "&#x41;"), only single-byte (Latin-1) characters are supported */
+            const long Code = (
+                Entity[1] == 'x' ?
+                    strtol(Entity.c_str() + 2, 0, 16) :
+                    strtol(Entity.c_str() + 1, 0, 10)
+            );
+            Str.str() += static_cast<c8>(Code > 0 && Code < 256 ? Code : '?');
+        }
+        else
+        {
+            /* Keep unknown entities unchanged */
+            Str.str().append(Chr, Semicolon + 1);
+        }
+        
+        Chr = Semicolon;
+    }
+    
+    return Str;
+}
+
+EXMLReaderEvents XMLReader::exitWithError(const io::stringc &Message)
+{
+    io::Log::error("XML reader error [" + io::stringc(getRow()) + "]: " + Message);
+    return Event_ = XMLEVENT_ERROR;
+}
+
+
+} // /namespace tool
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,293 @@
+/*
+ * XML reader header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_TOOL_XMLREADER_H__
+#define __SP_TOOL_XMLREADER_H__
+
+
+#include "Base/spStandard.hpp"
+
+#ifdef SP_COMPILE_WITH_XMLPARSER
+
+
+#include "Base/spInputOutputString.hpp"
+
+#include <vector>
+
+
+namespace sp
+{
+namespace tool
+{
+
+
+//! XML reader events. \see XMLReader::next
+enum EXMLReaderEvents
+{
+    XMLEVENT_NONE,      //!< No event has been read yet.
+    XMLEVENT_TAG_START, //!< Start tag (e.g. "<tag attrib='value'>"). Empty-element tags (e.g. "<tag/>") generate a start and an end event.
+    XMLEVENT_TAG_END,   //!< End tag (e.g. "</tag>").
+    XMLEVENT_TEXT,      //!< Text between two tags or a CDATA section. White-space only texts are skipped.
+    XMLEVENT_EOF,       //!< End of file has been reached.
+    XMLEVENT_ERROR,     //!< Syntax error. The error message has already been printed to the log.
+};
+
+
+class XMLReader;
+
+/**
+SAX (Simple API for XML) content handler interface. Derive from this class and pass it to "XMLReader::parse".
+Each callback can return false to stop the parsing.
+\since Version 3.3
+*/
+class SP_EXPORT XMLContentHandler
+{
+    
+    public:
+        
+        virtual ~XMLContentHandler()
+        {
+        }
+        
+        /* === Functions === */
+        
+        //! Start tag callback. The tag name and the attributes can be queried with the reader.
+        virtual bool startTag(const XMLReader&)
+        {
+            return true;
+        }
+        //! End tag callback.
+        virtual bool endTag(const XMLReader&)
+        {
+            return true;
+        }
+        //! Text callback.
+        virtual bool text(const XMLReader&)
+        {
+            return true;
+        }
+        
+    protected:
+        
+        XMLContentHandler()
+        {
+        }
+        
+};
+
+
+/**
+The XML reader is a pull-mode (StAX like) XML parser. In contrast to the XMLParser it does not build a tag tree
+but generates one event after another while the client iterates over the document with "next".
+The whole file is read into a single buffer and the tag names, attributes and texts only refer to their characters
+inside this buffer. Strings are only allocated when the client asks for them (e.g. with "getAttributeValue").
+Comments, processing instructions (e.g. "<?xml ... ?>") and document type declarations are skipped.
+\code
+tool::XMLReader Reader;
+if (Reader.loadFile("Scene.xml"))
+{
+    tool::EXMLReaderEvents Event;
+    while ( ( Event = Reader.next() ) != tool::XMLEVENT_EOF && Event != tool::XMLEVENT_ERROR )
+    {
+        if (Event == tool::XMLEVENT_TAG_START && Reader.isName("mesh"))
+            LoadMesh(Reader.getAttributeValue("file"));
+    }
+}
+\endcode
+\note Unlike the XMLParser this reader is strict: end tags must match their start tags and attribute values must be quoted.
+\see XMLContentHandler
+\since Version 3.3
+*/
+class SP_EXPORT XMLReader
+{
+    
+    public:
+        
+        XMLReader();
+        ~XMLReader();
+        
+        /* === Functions === */
+        
+        //! Reads the whole XML file into the reader's buffer and resets the reader state.
+        bool loadFile(const io::stringc &Filename);
+        //! Copies the XML string into the reader's buffer and resets the reader state.
+        void loadString(const io::stringc &XMLString);
+        
+        /**
+        Reads the next event.
+        \return The new event type. After XMLEVENT_EOF or XMLEVENT_ERROR the event does not change anymore.
+        */
+        EXMLReaderEvents next();
+        
+        /**
+        Reads the whole document and passes each event to the specified content handler (SAX mode).
+        \return False if a syntax error occurred.
+        */
+        bool parse(XMLContentHandler &Handler);
+        
+        /**
+        Skips the content of the current start tag, i.e. the next event is the one after the respective end tag.
+        \return False if a syntax error occurred.
+        */
+        bool skipTag();
+        
+        //! Returns the name of the current start or end tag.
+        io::stringc getName() const;
+        //! Returns true if the name of the current start or end tag is equal to the specified string.
+        bool isName(const c8* Name) const;
+        
+        //! Returns the current text with decoded entities (e.g. "&amp;" becomes '&'). CDATA sections are returned unchanged.
+        io::stringc getText() const;
+        
+        //! Returns the name of the specified attribute of the current start tag.
+        io::stringc getAttributeName(u32 Index) const;
+        //! Returns the value (with decoded entities) of the specified attribute of the current start tag.
+        io::stringc getAttributeValue(u32 Index) const;
+        
+        /**
+        Returns the index of the specified attribute of the current start tag.
+        \return Attribute index or -1 if the current tag has no such attribute.
+        */
+        s32 findAttribute(const c8* Name) const;
+        
+        /**
+        Returns the value of the specified attribute of the current start tag.
+        \param Name: Specifies the attribute name.
+        \param Default: Specifies the value which is returned if the current tag has no such attribute.
+        */
+        io::stringc getAttributeValue(const c8* Name, const io::stringc &Default = "") const;
+        
+        //! Returns the row (or rather line) of the current reader position. This is only computed on demand.
+        s32 getRow() const;
+        
+        /* === Inline functions === */
+        
+        //! Returns the current event.
+        inline EXMLReaderEvents getEvent() const
+        {
+            return Event_;
+        }
+        
+        //! Returns the count of open tags. Within a start tag event this includes the current tag.
+        inline u32 getDepth() const
+        {
+            return TagStack_.size();
+        }
+        
+        //! Returns the count of attributes of the current start tag.
+        inline u32 getNumAttributes() const
+        {
+            return Attributes_.size();
+        }
+        
+        //! Returns true if the current start tag is an empty-element tag (e.g. "<tag/>").
+        inline bool isEmptyTag() const
+        {
+            return IsEmptyTag_;
+        }
+        
+        //! Returns a pointer to the first character of the current tag name. The characters are not null-terminated!
+        inline const c8* getNameData() const
+        {
+            return Buffer_.c_str() + Name_.Offset;
+        }
+        //! Returns the length of the current tag name.
+        inline u32 getNameLength() const
+        {
+            return Name_.Length;
+        }
+        
+        //! Returns the value of the specified attribute converted to the template type (e.g. "Reader.getAttributeVal<s32>("width", 0)").
+        template <typename T> inline T getAttributeVal(const c8* Name, const T &Default) const
+        {
+            const s32 Index = findAttribute(Name);
+            return Index != -1 ? getAttributeValue(static_cast<u32>(Index)).val<T>() : Default;
+        }
+        
+    private:
+        
+        /* === Structures === */
+        
+        struct SStringView
+        {
+            SStringView() :
+                Offset(0),
+                Length(0)
+            {
+            }
+            SStringView(u32 ViewOffset, u32 ViewLength) :
+                Offset(ViewOffset),
+                Length(ViewLength)
+            {
+            }
+            ~SStringView()
+            {
+            }
+            
+            /* Members */
+            u32 Offset;
+            u32 Length;
+        };
+        
+        struct SAttributeView
+        {
+            SStringView Name;
+            SStringView Value;
+        };
+        
+        /* === Functions === */
+        
+        void reset();
+        
+        EXMLReaderEvents readStartTag();
+        EXMLReaderEvents readEndTag();
+        EXMLReaderEvents readText();
+        
+        bool skipSequence(const c8* Start, const c8* End);
+        void skipWhiteSpaces();
+        bool readName(SStringView &Name);
+        
+        bool startsWith(const c8* Str) const;
+        bool compare(const SStringView &View, const c8* Str) const;
+        bool compare(const SStringView &ViewA, const SStringView &ViewB) const;
+        
+        io::stringc getString(const SStringView &View) const;
+        io::stringc decode(const SStringView &View) const;
+        
+        EXMLReaderEvents exitWithError(const io::stringc &Message);
+        
+        /* === Members === */
+        
+        io::stringc Buffer_;
+        u32 Pos_;
+        
+        EXMLReaderEvents Event_;
+        
+        SStringView Name_;
+        SStringView Text_;
+        bool IsRawText_;
+        bool IsEmptyTag_;
+        bool HasPendingEndTag_;
+        
+        std::vector<SAttributeView> Attributes_;
+        std::vector<SStringView> TagStack_;
+        
+};
+
+
+} // /namespace tool
+
+} // /namespace sp
+
+
+#endif
+
+#endif
+
+
+
+// ================================================================================
@@ -285,7 +285,7 @@ DEFINE_HASHMAP_SETUP_PROC(
             break;                          \
         else if (type() == TOKEN_NAME)      \
         {                                   \
-            if (Tkn_->Str == "discard")     \
+            if (isStr("discard"))           \
                 ignoreNextBlock();          \
             else                            \
             {                               \
@@ -329,15 +329,8 @@ bool MaterialScriptReader::loadScript(const io::stringc &Filename)
     
     clearVariables();
     
-    /* Read file into string */
-    io::stringc InputScript;
-    if (!io::FileSystem().readFileString(Filename, InputScript))
-        return false;
-    
-    /* Parse tokens from input shader code */
-    TokenStream_ = Scanner_.readTokens(InputScript.c_str(), COMMENTSTYLE_BASIC);
-    
-    if (!TokenStream_)
+    /* Read file directly into the token view stream (or from the cache) and parse all tokens */
+    if (!readTokenFile(Filename, COMMENTSTYLE_BASIC))
         return exitWithError("Invalid token iterator");
     
     /* Validate brackets */
@@ -356,7 +349,7 @@ bool MaterialScriptReader::loadScript(const io::stringc &Filename)
         {
             if (type() == TOKEN_NAME)
             {
-                if (Tkn_->Str == "discard")
+                if (isStr("discard"))
                     ignoreNextBlock();
                 else
                     readScriptBlock();
@@ -767,7 +760,7 @@ void MaterialScriptReader::breakUnexpectedToken()
 
 void MaterialScriptReader::breakUnexpectedIdentifier()
 {
-    throw io::DefaultException("Unexpected identifier named \"" + Tkn_->Str + "\"");
+    throw io::DefaultException("Unexpected identifier named \"" + str() + "\"");
 }
 
 void MaterialScriptReader::breakExpectedIdentifier()
@@ -846,10 +839,10 @@ void MaterialScriptReader::readMaterial()
     /* Read material name */
     nextTokenNoEOF();
     
-    if (type() != TOKEN_STRING || Tkn_->Str.empty())
+    if (type() != TOKEN_STRING || Tkn_->empty())
         breakExpectedIdentifier();
     
-    const io::stringc& Name = Tkn_->Str;
+    const io::stringc Name(str());
     
     /* Check if material name already exists */
     if (findMaterial(Name) != 0)
@@ -868,7 +861,7 @@ void MaterialScriptReader::readMaterial()
 
 void MaterialScriptReader::readMaterialState()
 {
-    const io::stringc& Name = Tkn_->Str;
+    const io::stringc Name(str());
     
          if (Name == "ambient"          ) Materials_.Current->setAmbientColor       (readColor()        );
     else if (Name == "diffuse"          ) Materials_.Current->setDiffuseColor       (readColor()        );
@@ -907,10 +900,10 @@ void MaterialScriptReader::readShaderClass()
     /* Read shader class name */
     nextTokenNoEOF();
     
-    if (type() != TOKEN_STRING || Tkn_->Str.empty())
+    if (type() != TOKEN_STRING || Tkn_->empty())
         breakExpectedIdentifier();
     
-    const io::stringc& Name = Tkn_->Str;
+    const io::stringc Name(str());
     
     /* Check if shaders are supported */
     if (!GlbRenderSys->queryVideoSupport(video::VIDEOSUPPORT_SHADER))
@@ -931,9 +924,9 @@ void MaterialScriptReader::readShaderClass()
     
     if (type() == TOKEN_NAME)
     {
-        InputLayer = parseVertexFormat(Tkn_->Str);
+        InputLayer = parseVertexFormat(str());
         if (!InputLayer)
-            io::Log::warning("Unknown vertex format named \"" + Tkn_->Str + "\"");
+            io::Log::warning("Unknown vertex format named \"" + str() + "\"");
     }
     else if (type() != TOKEN_BRACE_LEFT)
         breakUnexpectedToken();
@@ -949,7 +942,7 @@ void MaterialScriptReader::readShaderClass()
 
 void MaterialScriptReader::readShaderType()
 {
-    const io::stringc& Name = Tkn_->Str;
+    const io::stringc Name(str());
     
     if (Name == "glsl" || Name == "glslEs" || Name == "hlsl3" || Name == "hlsl5")
     {
@@ -977,7 +970,7 @@ void MaterialScriptReader::readShader()
 
 void MaterialScriptReader::readAllShaderPrograms()
 {
-    const video::EShaderTypes ShaderType = MaterialScriptReader::parseShaderType(Tkn_->Str);
+    const video::EShaderTypes ShaderType = MaterialScriptReader::parseShaderType(str());
     
     if (ShaderType != video::SHADER_DUMMY)
         readShaderProgram(ShaderType);
@@ -990,14 +983,14 @@ void MaterialScriptReader::readShaderProgram(const video::EShaderTypes ShaderTyp
     /* Read shader entry point or block begin */
     nextTokenNoEOF();
     
-    if ( type() != TOKEN_BRACE_LEFT && ( type() != TOKEN_STRING || Tkn_->Str.empty() ) )
+    if ( type() != TOKEN_BRACE_LEFT && ( type() != TOKEN_STRING || Tkn_->empty() ) )
         throw io::DefaultException("Invalid shader entry point");
     
     io::stringc EntryPoint;
     
     if (type() != TOKEN_BRACE_LEFT)
     {
-        EntryPoint = Tkn_->Str;
+        EntryPoint = str();
         
         /* Read block begin */
         nextTokenNoEOF();
@@ -1044,7 +1037,7 @@ void MaterialScriptReader::readShaderProgram(const video::EShaderTypes ShaderTyp
 
 void MaterialScriptReader::readShaderProgramCode()
 {
-    const io::stringc& Name = Tkn_->Str;
+    const io::stringc Name(str());
     
     if (Name == "source")
     {
@@ -1077,10 +1070,10 @@ void MaterialScriptReader::readVertexFormat()
     /* Read vertex format name */
     nextTokenNoEOF();
     
-    if (type() != TOKEN_STRING || Tkn_->Str.empty())
+    if (type() != TOKEN_STRING || Tkn_->empty())
         breakExpectedIdentifier();
     
-    const io::stringc& Name = Tkn_->Str;
+    const io::stringc Name(str());
     
     /* Check if vertex format name is reservered */
     if (Name.size() >= 12 && Name.leftEqual("vertexFormat"))
@@ -1108,7 +1101,7 @@ void MaterialScriptReader::readVertexFormatAttributes()
         "coord", "color", "normal", "binormal", "tangent", "texCoord", "fogCoord", "universal", 0
     };
     
-    const io::stringc& Name = Tkn_->Str;
+    const io::stringc Name(str());
     
     /* Check if identifier is a valid vertex format attribute */
     const c8** Attrib = VertAttribs;
@@ -1136,10 +1129,10 @@ void MaterialScriptReader::readVertexFormatAttributes(const io::stringc &AttribT
     {
         nextTokenNoEOF();
         
-        if (type() != TOKEN_STRING || Tkn_->Str.empty())
+        if (type() != TOKEN_STRING || Tkn_->empty())
             throw io::DefaultException("Universal without name is not allowed");
         
-        AttribName = Tkn_->Str;
+        AttribName = str();
     }
     
     /* Attribute components */
@@ -1179,7 +1172,7 @@ void MaterialScriptReader::readVertexFormatAttributes(const io::stringc &AttribT
 void MaterialScriptReader::readVertexFormatAttributeComponents(
     video::ERendererDataTypes &DataType, s32 &Size, bool &Normalize, video::EVertexFormatFlags &Attrib)
 {
-    const io::stringc& Name = Tkn_->Str;
+    const io::stringc Name(str());
     
          if (Name == "size"     ) Size      = readNumber<s32>();
     else if (Name == "type"     ) DataType  = PARSE_ENUM(parseDataType);
@@ -1194,10 +1187,10 @@ void MaterialScriptReader::readTexture()
     /* Read texture name */
     nextTokenNoEOF();
     
-    if (type() != TOKEN_STRING || Tkn_->Str.empty())
+    if (type() != TOKEN_STRING || Tkn_->empty())
         breakExpectedIdentifier();
     
-    const io::stringc& Name = Tkn_->Str;
+    const io::stringc Name(str());
     
     /* Check if texture name already exists */
     if (findTexture(Name) != 0)
@@ -1254,7 +1247,7 @@ void MaterialScriptReader::readTexture()
 
 void MaterialScriptReader::readTextureAttributes()
 {
-    const io::stringc& Name = Tkn_->Str;
+    const io::stringc Name(str());
     
          if (Name == "imageFile"    ) CurTexFlags_.Filename     = readString();
     else if (Name == "fillColor"    ) CurFillColor_             = readColor();
@@ -1284,7 +1277,7 @@ void MaterialScriptReader::readTextureFilter()
 
 void MaterialScriptReader::readTextureFilterAttributes()
 {
-    const io::stringc& Name = Tkn_->Str;
+    const io::stringc Name(str());
     video::STextureFilter& Filter = CurTexFlags_.Filter;
     
          if (Name == "mipMaps"      ) Filter.HasMIPMaps = readBool();
@@ -1305,10 +1298,10 @@ void MaterialScriptReader::readTextureLayer()
     /* Read texture layer name */
     nextTokenNoEOF();
     
-    if (type() != TOKEN_STRING || Tkn_->Str.empty())
+    if (type() != TOKEN_STRING || Tkn_->empty())
         breakExpectedIdentifier();
     
-    const io::stringc& Name = Tkn_->Str;
+    const io::stringc Name(str());
     
     /* Check if texture layer name already exists */
     if (findTextureLayer(Name) != 0)
@@ -1320,7 +1313,7 @@ void MaterialScriptReader::readTextureLayer()
     if (type() != TOKEN_NAME)
         breakUnexpectedToken();
     
-    const io::stringc& LayerType = Tkn_->Str;
+    const io::stringc LayerType(str());
     
     /* Create new texture layer */
     addTextureLayer(Name, LayerType);
@@ -1350,7 +1343,7 @@ void MaterialScriptReader::readTextureLayerAttributes()
                 TexLayerRlf->f;                                                             \
         }
     
-    const io::stringc& Name = Tkn_->Str;
+    const io::stringc Name(str());
     
     /* Setup base settings */
          if (Name == "tex"              ) TexLayers_.Current->setTexture    (findTexture(readIdentifier())  );
@@ -1442,7 +1435,7 @@ void MaterialScriptReader::readVarDefinition()
         if (type() == TOKEN_NUMBER_INT || type() == TOKEN_NUMBER_FLOAT)
         {
             /* Setup variable as number */
-            NumVal = Tkn_->Str.val<f64>();
+            NumVal = val<f64>();
             
             if (IsNumNegative)
                 NumVal = -NumVal;
@@ -1481,7 +1474,7 @@ void MaterialScriptReader::readVarDefinition()
         {
             /* Add variable value */
             IsVarStr = true;
-            StrVal += Tkn_->Str;
+            StrVal += str();
         }
         else
             breakUnexpectedToken();
@@ -1531,7 +1524,7 @@ io::stringc MaterialScriptReader::readVarName()
     if (type() != TOKEN_NAME)
         breakExpectedIdentifier();
     
-    return Tkn_->Str;
+    return str();
 }
 
 f64 MaterialScriptReader::readDouble(bool ReadAssignment)
@@ -1554,7 +1547,7 @@ f64 MaterialScriptReader::readDouble(bool ReadAssignment)
     {
         case TOKEN_NUMBER_INT:
         case TOKEN_NUMBER_FLOAT:
-            return Factor * Tkn_->Str.val<f64>();
+            return Factor * val<f64>();
             
         case TOKEN_AT:
             /* Read variable name */
@@ -1564,7 +1557,7 @@ f64 MaterialScriptReader::readDouble(bool ReadAssignment)
                 breakExpectedIdentifier();
             
             /* Return variable name */
-            return Factor * getNumber(Tkn_->Str);
+            return Factor * getNumber(str());
             
         default:
             breakUnexpectedToken();
@@ -1590,7 +1583,7 @@ io::stringc MaterialScriptReader::readString(bool ReadAssignment)
     {
         /* Add string value */
         if (type() == TOKEN_STRING)
-            Str += Tkn_->Str;
+            Str += str();
         else if (type() == TOKEN_AT)
             Str += getString(readVarName());
         else
@@ -1623,7 +1616,7 @@ io::stringc MaterialScriptReader::readIdentifier(bool ReadAssignment)
     if (type() != TOKEN_NAME)
         breakUnexpectedToken();
     
-    return Tkn_->Str;
+    return str();
 }
 
 bool MaterialScriptReader::readBool(bool ReadAssignment)
@@ -1746,7 +1739,7 @@ bool MaterialScriptReader::validShaderForRenderSys(const io::stringc &Name) cons
 
 bool MaterialScriptReader::readScriptBlock()
 {
-    const io::stringc& Name = Tkn_->Str;
+    const io::stringc Name(str());
     
          if (Name == "material"     ) readMaterial      ();
     else if (Name == "shader"       ) readShaderClass   ();
@@ -0,0 +1,243 @@
+/*
+ * Script cache file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "Framework/Tools/ScriptParser/spUtilityScriptCache.hpp"
+
+#ifdef SP_COMPILE_WITH_TOKENSCANNER
+
+
+#include "Base/spInputOutputLog.hpp"
+#include "Base/spMath.hpp"
+
+#include <boost/make_shared.hpp>
+
+
+namespace sp
+{
+namespace tool
+{
+
+
+static const u32 SCRIPTCACHE_MAGIC      = 0x43535053; // "SPSC"
+static const u32 SCRIPTCACHE_VERSION    = 1;
+
+ScriptCache::ScriptCache(const io::stringc &Path) :
+    Path_       (Path   ),
+    NumHits_    (0      ),
+    NumMisses_  (0      )
+{
+    /* Append the directory separator */
+    if (Path_.size() && Path_[Path_.size() - 1] != '/' && Path_[Path_.size() - 1] != '\\')
+        Path_ += "/";
+}
+ScriptCache::~ScriptCache()
+{
+}
+
+TokenViewStreamPtr ScriptCache::readTokenViews(
+    TokenScanner &Scanner, const io::stringc &InputString, const ETokenCommentStyles CommentStyle, s32 Flags)
+{
+    /* Hash the script and all parameters which affect the tokens */
+    const s32 Params[3] = { CommentStyle, Flags, static_cast<s32>(sizeof(STokenView)) };
+    
+    const u64 Hash = math::getHash(
+        Params, sizeof(Params), math::getHash(InputString.c_str(), InputString.size())
+    );
+    
+    const io::stringc Filename(getFilename(Hash));
+    
+    /* Read the token view stream from the cache */
+    SHeader Header;
+    {
+        Header.Magic        = SCRIPTCACHE_MAGIC;
+        Header.Version      = SCRIPTCACHE_VERSION;
+        Header.Hash         = Hash;
+        Header.Type         = CACHEFILE_TOKENS;
+        Header.DataSize     = InputString.size();
+        Header.NumTokens    = 0;
+        Header.Reserved     = 0;
+    }
+    
+    SHeader FileHeader = Header;
+    io::File* CacheFile = openCacheFile(Filename, FileHeader);
+    
+    if (CacheFile)
+    {
+        TokenViewStreamPtr Stream;
+        
+        if ( FileHeader.DataSize == Header.DataSize && FileHeader.NumTokens > 0 &&
+             CacheFile->getSize() == sizeof(SHeader) + FileHeader.DataSize + FileHeader.NumTokens * sizeof(STokenView) )
+        {
+            Stream = boost::make_shared<TokenViewStream>();
+            
+            Stream->Buffer_.str().resize(FileHeader.DataSize);
+            Stream->Tokens_.resize(FileHeader.NumTokens);
+            
+            if (FileHeader.DataSize > 0)
+                CacheFile->readBuffer(&Stream->Buffer_.str()[0], FileHeader.DataSize);
+            CacheFile->readBuffer(&Stream->Tokens_[0], sizeof(STokenView), FileHeader.NumTokens);
+        }
+        
+        FileSys_.closeFile(CacheFile);
+        
+        if (Stream)
+        {
+            ++NumHits_;
+            return Stream;
+        }
+    }
+    
+    /* Scan the script and store the token view stream in the cache */
+    ++NumMisses_;
+    
+    TokenViewStreamPtr Stream = Scanner.readTokenViews(InputString, CommentStyle, Flags);
+    
+    if (!Stream || Stream->Tokens_.empty())
+        return Stream;
+    
+    Header.DataSize     = Stream->Buffer_.size();
+    Header.NumTokens    = Stream->Tokens_.size();
+    
+    if ( ( CacheFile = createCacheFile(Filename, Header) ) != 0 )
+    {
+        CacheFile->writeBuffer(Stream->Buffer_.c_str(), Header.DataSize);
+        CacheFile->writeBuffer(&Stream->Tokens_[0], sizeof(STokenView), Header.NumTokens);
+        
+        FileSys_.closeFile(CacheFile);
+    }
+    
+    return Stream;
+}
+
+bool ScriptCache::readString(u64 Hash, io::stringc &OutputString)
+{
+    SHeader Header;
+    {
+        Header.Magic    = SCRIPTCACHE_MAGIC;
+        Header.Version  = SCRIPTCACHE_VERSION;
+        Header.Hash     = Hash;
+        Header.Type     = CACHEFILE_STRING;
+    }
+    
+    io::File* CacheFile = openCacheFile(getFilename(Hash), Header);
+    
+    if (!CacheFile)
+    {
+        ++NumMisses_;
+        return false;
+    }
+    
+    bool Result = false;
+    
+    if (CacheFile->getSize() == sizeof(SHeader) + Header.DataSize)
+    {
+        /* Append the cached string to the output string */
+        const u32 Offset = OutputString.size();
+        
+        OutputString.str().resize(Offset + Header.DataSize);
+        
+        if (Header.DataSize > 0)
+            CacheFile->readBuffer(&OutputString.str()[Offset], Header.DataSize);
+        
+        Result = true;
+    }
+    
+    FileSys_.closeFile(CacheFile);
+    
+    if (Result)
+        ++NumHits_;
+    else
+        ++NumMisses_;
+    
+    return Result;
+}
+
+void ScriptCache::writeString(u64 Hash, const io::stringc &Str)
+{
+    SHeader Header;
+    {
+        Header.Magic        = SCRIPTCACHE_MAGIC;
+        Header.Version      = SCRIPTCACHE_VERSION;
+        Header.Hash         = Hash;
+        Header.Type         = CACHEFILE_STRING;
+        Header.DataSize     = Str.size();
+        Header.NumTokens    = 0;
+        Header.Reserved     = 0;
+    }
+    
+    io::File* CacheFile = createCacheFile(getFilename(Hash), Header);
+    
+    if (CacheFile)
+    {
+        CacheFile->writeBuffer(Str.c_str(), Header.DataSize);
+        FileSys_.closeFile(CacheFile);
+    }
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+io::stringc ScriptCache::getFilename(u64 Hash) const
+{
+    return Path_ + io::getHexString(Hash) + ".spsc";
+}
+
+io::File* ScriptCache::openCacheFile(const io::stringc &Filename, SHeader &Header)
+{
+    if (!FileSys_.findFile(Filename))
+        return 0;
+    
+    io::File* CacheFile = FileSys_.openFile(Filename, io::FILE_READ);
+    
+    if (!CacheFile)
+        return 0;
+    
+    /* Compare the header (a hash collision with another file type is rejected here) */
+    SHeader FileHeader;
+    
+    if ( CacheFile->getSize() < sizeof(SHeader) ||
+         CacheFile->readBuffer(&FileHeader, sizeof(SHeader)) != static_cast<s32>(sizeof(SHeader)) ||
+         FileHeader.Magic != Header.Magic || FileHeader.Version != Header.Version ||
+         FileHeader.Hash != Header.Hash || FileHeader.Type != Header.Type )
+    {
+        FileSys_.closeFile(CacheFile);
+        return 0;
+    }
+    
+    Header = FileHeader;
+    
+    return CacheFile;
+}
+
+io::File* ScriptCache::createCacheFile(const io::stringc &Filename, const SHeader &Header)
+{
+    io::File* CacheFile = FileSys_.openFile(Filename, io::FILE_WRITE);
+    
+    if (!CacheFile)
+    {
+        io::Log::warning("Could not write script cache file \"" + Filename + "\"");
+        return 0;
+    }
+    
+    CacheFile->writeBuffer(&Header, sizeof(SHeader));
+    
+    return CacheFile;
+}
+
+
+} // /namespace tool
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,137 @@
+/*
+ * Script cache header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_UTILITY_SCRIPT_CACHE_H__
+#define __SP_UTILITY_SCRIPT_CACHE_H__
+
+
+#include "Base/spStandard.hpp"
+
+#ifdef SP_COMPILE_WITH_TOKENSCANNER
+
+
+#include "Base/spInputOutputFileSystem.hpp"
+#include "Framework/Tools/ScriptParser/spUtilityTokenParser.hpp"
+
+
+namespace sp
+{
+namespace tool
+{
+
+
+/**
+The script cache stores compiled scripts in a binary form on the disk. The cache files are addressed
+by a hash of the script content and all parameters which affect the result (e.g. the comment style).
+For the script readers (see ScriptReaderBase::setCache) the compiled form is the token view stream, i.e. the solved source buffer
+and the token array. A warm start only reads these two arrays with a single file access and skips the whole lexical analysis.
+The shader pre-processor also stores its complete output string, so a warm start skips the pre-processing entirely.
+\note The cache directory must already exist.
+\see ScriptReaderBase::setCache
+\since Version 3.3
+*/
+class SP_EXPORT ScriptCache
+{
+    
+    public:
+        
+        ScriptCache(const io::stringc &Path);
+        ~ScriptCache();
+        
+        /* === Functions === */
+        
+        /**
+        Reads the token views of the specified script from the cache or scans the script and writes the tokens into the cache.
+        \see TokenScanner::readTokenViews
+        */
+        TokenViewStreamPtr readTokenViews(
+            TokenScanner &Scanner, const io::stringc &InputString,
+            const ETokenCommentStyles CommentStyle = COMMENTSTYLE_NONE, s32 Flags = 0
+        );
+        
+        /**
+        Reads a string with the specified hash from the cache.
+        \param[in] Hash Specifies the hash of the input data and all parameters which affect the string (see "math::getHash").
+        \param[out] OutputString Specifies the output string. The cached string is appended to this string.
+        \return True if the string has been found in the cache.
+        */
+        bool readString(u64 Hash, io::stringc &OutputString);
+        //! Writes the specified string with the specified hash into the cache.
+        void writeString(u64 Hash, const io::stringc &Str);
+        
+        /* === Inline functions === */
+        
+        //! Returns the cache directory path.
+        inline const io::stringc& getPath() const
+        {
+            return Path_;
+        }
+        
+        //! Returns the count of scripts which have been read from the cache.
+        inline u32 getNumHits() const
+        {
+            return NumHits_;
+        }
+        //! Returns the count of scripts which have been compiled because they were not in the cache.
+        inline u32 getNumMisses() const
+        {
+            return NumMisses_;
+        }
+        
+    private:
+        
+        /* === Enumerations === */
+        
+        enum ECacheFileTypes
+        {
+            CACHEFILE_TOKENS = 1,
+            CACHEFILE_STRING,
+        };
+        
+        /* === Structures === */
+        
+        struct SHeader
+        {
+            u32 Magic;
+            u32 Version;
+            u64 Hash;
+            u32 Type;
+            u32 DataSize;
+            u32 NumTokens;
+            u32 Reserved;
+        };
+        
+        /* === Functions === */
+        
+        io::stringc getFilename(u64 Hash) const;
+        
+        io::File* openCacheFile(const io::stringc &Filename, SHeader &Header);
+        io::File* createCacheFile(const io::stringc &Filename, const SHeader &Header);
+        
+        /* === Members === */
+        
+        io::FileSystem FileSys_;
+        io::stringc Path_;
+        
+        u32 NumHits_;
+        u32 NumMisses_;
+        
+};
+
+
+} // /namespace tool
+
+} // /namespace sp
+
+
+#endif
+
+#endif
+
+
+
+// ================================================================================
@@ -11,6 +11,7 @@
 
 
 #include "Base/spInputOutputLog.hpp"
+#include "Base/spInputOutputFileSystem.hpp"
 
 
 namespace sp
@@ -20,7 +21,8 @@ namespace tool
 
 
 ScriptReaderBase::ScriptReaderBase() :
-    Tkn_(0)
+    Tkn_    (0),
+    Cache_  (0)
 {
 }
 ScriptReaderBase::~ScriptReaderBase()
@@ -32,7 +34,38 @@ ScriptReaderBase::~ScriptReaderBase()
  * ======= Protected: ========
  */
 
-bool ScriptReaderBase::exitWithError(const io::stringc &Message, const SToken* InvalidToken)
+bool ScriptReaderBase::readTokens(const io::stringc &InputString, const ETokenCommentStyles CommentStyle)
+{
+    Tkn_ = 0;
+    
+    if (Cache_)
+        TokenStream_ = Cache_->readTokenViews(Scanner_, InputString, CommentStyle);
+    else
+        TokenStream_ = Scanner_.readTokenViews(InputString, CommentStyle);
+    
+    return TokenStream_ != 0;
+}
+
+bool ScriptReaderBase::readTokenFile(const io::stringc &Filename, const ETokenCommentStyles CommentStyle)
+{
+    /* Without cache the file is read directly into the token stream */
+    if (!Cache_)
+    {
+        Tkn_ = 0;
+        TokenStream_ = Scanner_.parseFileViews(Filename, CommentStyle);
+        return TokenStream_ != 0;
+    }
+    
+    io::FileSystem FileSys;
+    io::stringc InputString;
+    
+    if (!FileSys.readFileString(Filename, InputString))
+        return false;
+    
+    return readTokens(InputString, CommentStyle);
+}
+
+bool ScriptReaderBase::exitWithError(const io::stringc &Message, const STokenView* InvalidToken)
 {
     io::Log::error(Message + " at " + InvalidToken->getRowColumnString());
     return false;
@@ -48,7 +81,7 @@ bool ScriptReaderBase::exitWithError(const io::stringc &Message, bool AppendToke
 
 bool ScriptReaderBase::validateBrackets()
 {
-    const SToken* InvalidToken = 0;
+    const STokenView* InvalidToken = 0;
     
     switch (TokenStream_->validateBrackets(InvalidToken))
     {
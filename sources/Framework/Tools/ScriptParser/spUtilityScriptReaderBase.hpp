@@ -15,6 +15,7 @@
 
 
 #include "Framework/Tools/ScriptParser/spUtilityTokenParser.hpp"
+#include "Framework/Tools/ScriptParser/spUtilityScriptCache.hpp"
 
 
 namespace sp
@@ -24,7 +25,8 @@ namespace tool
 
 
 /**
-Script reader base class.
+Script reader base class. The scripts are scanned into a TokenViewStream,
+i.e. token strings are only allocated when a reader explicitly asks for them (see "str").
 \since Version 3.3
 */
 class SP_EXPORT ScriptReaderBase
@@ -34,13 +36,36 @@ class SP_EXPORT ScriptReaderBase
         
         virtual ~ScriptReaderBase();
         
+        /* === Inline functions === */
+        
+        /**
+        Sets the script cache. By default null. If a cache is set, the scanned tokens are written into the cache directory
+        and read back when the same script is loaded again.
+        \note The cache object is not deleted by the script reader.
+        \see ScriptCache
+        \since Version 3.3
+        */
+        inline void setCache(ScriptCache* Cache)
+        {
+            Cache_ = Cache;
+        }
+        inline ScriptCache* getCache() const
+        {
+            return Cache_;
+        }
+        
     protected:
         
         /* === Functions === */
         
         ScriptReaderBase();
         
-        bool exitWithError(const io::stringc &Message, const SToken* InvalidToken);
+        //! Scans the specified string into the token stream (or reads it from the cache).
+        bool readTokens(const io::stringc &InputString, const ETokenCommentStyles CommentStyle);
+        //! Scans the specified file into the token stream (or reads it from the cache).
+        bool readTokenFile(const io::stringc &Filename, const ETokenCommentStyles CommentStyle);
+        
+        bool exitWithError(const io::stringc &Message, const STokenView* InvalidToken);
         bool exitWithError(const io::stringc &Message, bool AppendTokenPos = true);
         
         bool validateBrackets();
@@ -64,11 +89,29 @@ class SP_EXPORT ScriptReaderBase
             return Tkn_->Type;
         }
         
+        //! Returns the string of the current token.
+        inline io::stringc str() const
+        {
+            return TokenStream_->getString(*Tkn_);
+        }
+        //! Returns true if the string of the current token is equal to the specified string (without allocating a string).
+        inline bool isStr(const c8* Str) const
+        {
+            return TokenStream_->compare(*Tkn_, Str);
+        }
+        //! Returns the number value of the current token.
+        template <typename T> inline T val() const
+        {
+            return TokenStream_->getValue<T>(*Tkn_);
+        }
+        
         /* === Members === */
         
         TokenScanner Scanner_;
-        TokenStreamPtr TokenStream_;
-        SToken* Tkn_;
+        TokenViewStreamPtr TokenStream_;
+        const STokenView* Tkn_;
+        
+        ScriptCache* Cache_;
         
 };
 
@@ -12,6 +12,7 @@
 
 #include "Base/spInputOutputFileSystem.hpp"
 #include "Base/spBaseExceptions.hpp"
+#include "Base/spMath.hpp"
 
 #include <boost/foreach.hpp>
 
@@ -52,8 +53,26 @@ bool ShaderPreProcessor::preProcessShader(
     if (EntryPoint.empty())
         return exitWithError("Invalid entry point");
     
-    /* Parse tokens from input shader code */
-    TokenStream_ = Scanner_.readTokens(InputShaderCode.c_str(), COMMENTSTYLE_ANSI_C);
+    /* Read the pre-processed shader code from the cache */
+    u64 CacheHash = 0;
+    
+    if (Cache_)
+    {
+        const s32 Params[3] = { ShaderType, ShaderVersion, static_cast<s32>(Options) };
+        
+        CacheHash = math::getHash(InputShaderCode.c_str(), InputShaderCode.size());
+        CacheHash = math::getHash(EntryPoint.c_str(), EntryPoint.size(), CacheHash);
+        CacheHash = math::getHash(Params, sizeof(Params), CacheHash);
+        
+        if (Cache_->readString(CacheHash, OutputShaderCode))
+            return true;
+    }
+    
+    const u32 OutputOffset = OutputShaderCode.size();
+    
+    /* Parse tokens from input shader code (only the output code is cached, not the tokens) */
+    Tkn_ = 0;
+    TokenStream_ = Scanner_.readTokenViews(InputShaderCode, COMMENTSTYLE_ANSI_C);
     
     if (!TokenStream_)
         return exitWithError("Invalid token iterator");
@@ -93,13 +112,16 @@ bool ShaderPreProcessor::preProcessShader(
             /* Solve macros directly */
             if (type() == TOKEN_NAME)
             {
+                io::stringc Name(str());
+                
                 if ((Options_ & SHADER_PREPROCESS_SOLVE_MACROS) != 0)
-                    solveMacrosGLSL();
-                if (Tkn_->Str == EntryPoint)
-                {
-                    if (processEntryPointGLSL())
-                        continue;
-                }
+                    solveMacrosGLSL(Name);
+                
+                if (Name == EntryPoint && processEntryPointGLSL())
+                    continue;
+                
+                *OutString_ += Name;
+                continue;
             }
             
             /* Solve HLSL attributes (e.g. [loop], [unroll] etc.) */
@@ -125,6 +147,10 @@ bool ShaderPreProcessor::preProcessShader(
     if (!State_.EntryPointFound)
         io::Log::warning("Entry point \"" + EntryPoint + "\" not found");
     
+    /* Store the pre-processed shader code in the cache */
+    if (Cache_)
+        Cache_->writeString(CacheHash, OutputShaderCode.str().substr(OutputOffset));
+    
     return true;
 }
 
@@ -135,7 +161,7 @@ bool ShaderPreProcessor::preProcessShader(
 
 void ShaderPreProcessor::append()
 {
-    Tkn_->appendString(*OutString_);
+    TokenStream_->appendString(*Tkn_, *OutString_);
 }
 
 void ShaderPreProcessor::append(const io::stringc &Str)
@@ -156,10 +182,8 @@ void ShaderPreProcessor::popIndent()
         Indent_.clear();
 }
 
-void ShaderPreProcessor::solveMacrosGLSL()
+void ShaderPreProcessor::solveMacrosGLSL(io::stringc &Name)
 {
-    io::stringc& Name = Tkn_->Str;
-    
     /* Check for vector and matrix macros */
     static const SDataTypeConversion ConversionTypes[] =
     {
@@ -285,7 +309,7 @@ bool ShaderPreProcessor::solveAttributesGLSL()
         return false;
     
     /* Process attribute */
-    const io::stringc& Name = Tkn_->Str;
+    const io::stringc Name(str());
     
     if (Name == "numthreads")
         return solveAttributeNumThreadsGLSL();
@@ -365,7 +389,7 @@ bool ShaderPreProcessor::solveAttributeMaxVertexCountGLSL()
     while (nextToken())
     {
         if (type() == TOKEN_NUMBER_INT)
-            State_.MaxVertexCount = Tkn_->Str.val<u32>();
+            State_.MaxVertexCount = val<u32>();
         else if (type() == TOKEN_SQUARED_BRACKET_RIGHT)
             break;
     }
@@ -426,16 +450,16 @@ bool ShaderPreProcessor::processInputArgGLSL(SInputArgument &Arg)
         if (!nextTokenCheck(TOKEN_NAME))
             throw io::DefaultException("data-type");
         
-        if ((Options_ & SHADER_PREPROCESS_SOLVE_MACROS) != 0)
-            solveMacrosGLSL();
+        Arg.DataType = str();
         
-        Arg.DataType = Tkn_->Str;
+        if ((Options_ & SHADER_PREPROCESS_SOLVE_MACROS) != 0)
+            solveMacrosGLSL(Arg.DataType);
         
         /* Get argument identifier */
         if (!nextTokenCheck(TOKEN_NAME))
             throw io::DefaultException("identifier");
         
-        Arg.Identifier = Tkn_->Str;
+        Arg.Identifier = str();
         
         /* Check if there is no semantic */
         if (!nextToken())
@@ -452,7 +476,7 @@ bool ShaderPreProcessor::processInputArgGLSL(SInputArgument &Arg)
                 throw io::DefaultException("semantic");
         }
         
-        Arg.Semantic = Tkn_->Str;
+        Arg.Semantic = str();
     }
     catch (const io::DefaultException &Err)
     {
@@ -60,6 +60,8 @@ class SP_EXPORT ShaderPreProcessor : public ScriptReaderBase
         \param[in] ProcessingOptions Specifies the preprocessing options (or rather flags).
         This can be a combination of the 'EShaderPreProcessorOptions' enumeration flags.
         \return True if the shader code could be preprocessed successful. Otherwise error messages will be printed.
+        \note If a script cache is set (see "setCache"), the whole output shader code is read from the cache
+        when the same input code has already been preprocessed with the same parameters.
         \see video::EShaderTypes
         \see video::EShaderVersions
         \see EShaderPreProcessorOptions
@@ -121,7 +123,7 @@ class SP_EXPORT ShaderPreProcessor : public ScriptReaderBase
         void pushIndent();
         void popIndent();
         
-        void solveMacrosGLSL();
+        void solveMacrosGLSL(io::stringc &Name);
         bool solveMacroVectorGLSL(io::stringc &Name, const SDataTypeConversion &Type);
         
         bool ignoreAttribute();
@@ -13,6 +13,7 @@
 #include "Base/spInputOutputFileSystem.hpp"
 
 #include <boost/make_shared.hpp>
+#include <cstring>
 
 
 namespace sp
@@ -290,10 +291,248 @@ TokenStreamPtr TokenScanner::parseFile(
 }
 
 
+TokenViewStreamPtr TokenScanner::readTokenViews(
+    const io::stringc &InputString, const ETokenCommentStyles CommentStyle, s32 Flags)
+{
+    /* Copy the input string once into the stream buffer */
+    TokenViewStreamPtr Stream = boost::make_shared<TokenViewStream>();
+    Stream->Buffer_ = InputString;
+    
+    if (!scanTokenViews(*Stream, CommentStyle, Flags))
+        return TokenViewStreamPtr();
+    
+    return Stream;
+}
+
+TokenViewStreamPtr TokenScanner::parseFileViews(
+    const io::stringc &Filename, const ETokenCommentStyles CommentStyle, s32 Flags)
+{
+    /* Read file directly into the stream buffer */
+    TokenViewStreamPtr Stream = boost::make_shared<TokenViewStream>();
+    
+    io::FileSystem FileSys;
+    if (!FileSys.readFileString(Filename, Stream->Buffer_))
+        return TokenViewStreamPtr();
+    
+    if (!scanTokenViews(*Stream, CommentStyle, Flags))
+        return TokenViewStreamPtr();
+    
+    return Stream;
+}
+
+
 /*
  * ======= Private: =======
  */
 
+bool TokenScanner::scanTokenViews(TokenViewStream &Stream, const ETokenCommentStyles CommentStyle, s32 Flags)
+{
+    static const c8* SpecialSignTokens = ",.:;!?#@$()[]{}><=+-*/%~&|^";
+    
+    std::string& Buffer = Stream.Buffer_.str();
+    std::vector<STokenView>& Tokens = Stream.Tokens_;
+    
+    Tokens.clear();
+    Tokens.reserve(Buffer.size() / 4 + 1);
+    
+    const bool IgnoreWhiteSpaces = ((Flags & SCANNERFLAG_IGNORE_WHITESPACES) != 0);
+    
+    /* Scan the buffer in place (solved escape characters are written back into the string tokens) */
+    c8* Begin = (Buffer.empty() ? 0 : &Buffer[0]);
+    c8* End = Begin + Buffer.size();
+    c8* Ptr = Begin;
+    const c8* LineStart = Begin;
+    
+    Row_ = 1;
+    
+    while (Ptr < End && *Ptr != 0)
+    {
+        const c8 Chr = *Ptr;
+        const c8 NextChr = (Ptr + 1 < End ? Ptr[1] : 0);
+        
+        const u32 Offset = static_cast<u32>(Ptr - Begin);
+        Column_ = static_cast<s32>(Ptr - LineStart) + 1;
+        
+        /* Check for comments */
+        bool IsCommentLine = false;
+        const c8* CommentEnd = 0;
+        
+        switch (CommentStyle)
+        {
+            case COMMENTSTYLE_ANSI_C:
+                if (Chr == '/' && NextChr == '/')
+                    IsCommentLine = true;
+                else if (Chr == '/' && NextChr == '*')
+                    CommentEnd = "*/";
+                break;
+            case COMMENTSTYLE_HTML:
+                if (Chr == '<' && NextChr == '!' && End - Ptr >= 4 && Ptr[2] == '-' && Ptr[3] == '-')
+                    CommentEnd = "-->";
+                break;
+            case COMMENTSTYLE_BASH:
+                IsCommentLine = (Chr == '#');
+                break;
+            case COMMENTSTYLE_BASIC:
+                IsCommentLine = (Chr == ';');
+                break;
+            default:
+                break;
+        }
+        
+        if (IsCommentLine)
+        {
+            /* Ignore everything until the new-line character (which is scanned as white space) */
+            while (Ptr < End && *Ptr != '\n' && *Ptr != 0)
+                ++Ptr;
+            continue;
+        }
+        
+        if (CommentEnd)
+        {
+            /* Ignore everything until the end of the multi-line comment */
+            const u32 CommentEndLen = strlen(CommentEnd);
+            
+            for (Ptr += 2; Ptr < End && *Ptr != 0; ++Ptr)
+            {
+                if (*Ptr == '\n')
+                {
+                    ++Row_;
+                    LineStart = Ptr + 1;
+                }
+                else if (static_cast<u32>(End - Ptr) >= CommentEndLen && !strncmp(Ptr, CommentEnd, CommentEndLen))
+                {
+                    Ptr += CommentEndLen;
+                    break;
+                }
+            }
+            continue;
+        }
+        
+        /* Check for strings */
+        if (Chr == '\"')
+        {
+            c8* StrStart = ++Ptr;
+            c8* StrWrite = StrStart;
+            
+            while (1)
+            {
+                if (Ptr >= End || *Ptr == 0)
+                {
+                    exitWithError("Unexpected end of file in string");
+                    return false;
+                }
+                
+                c8 StrChr = *Ptr++;
+                
+                if (StrChr == '\"')
+                    break;
+                
+                if (StrChr == '\\')
+                {
+                    /* Solve special character */
+                    switch (Ptr < End ? *Ptr++ : 0)
+                    {
+                        case 't':   StrChr = '\t'; break;
+                        case 'n':   StrChr = '\n'; break;
+                        case '\"':  StrChr = '\"'; break;
+                        default:
+                            exitWithError("Incomplete character after '\\' character");
+                            return false;
+                    }
+                }
+                else if (StrChr == '\n')
+                {
+                    ++Row_;
+                    LineStart = Ptr;
+                }
+                
+                *StrWrite++ = StrChr;
+            }
+            
+            Tokens.push_back(STokenView(
+                TOKEN_STRING, static_cast<u32>(StrStart - Begin), static_cast<u32>(StrWrite - StrStart), Row_, Column_
+            ));
+            continue;
+        }
+        
+        /* Check for white spaces */
+        if (isCharWhiteSpace(Chr))
+        {
+            /* New-line tokens already belong to the next row (like in the TokenStream) */
+            if (Chr == '\n')
+            {
+                ++Row_;
+                LineStart = Ptr + 1;
+            }
+            
+            if (!IgnoreWhiteSpaces)
+            {
+                const ETokenTypes Type = (Chr == ' ' ? TOKEN_BLANK : Chr == '\t' ? TOKEN_TAB : TOKEN_NEWLINE);
+                Tokens.push_back(STokenView(Type, Offset, 1, Row_, Column_));
+            }
+            
+            ++Ptr;
+            continue;
+        }
+        
+        /* Check for names */
+        if (isCharNamePart(Chr))
+        {
+            for (++Ptr; Ptr < End && ( isCharNamePart(*Ptr) || isCharNumber(*Ptr) ); ++Ptr);
+            
+            Tokens.push_back(STokenView(TOKEN_NAME, Offset, static_cast<u32>(Ptr - Begin) - Offset, Row_, Column_));
+            continue;
+        }
+        
+        /* Check for numbers */
+        if (isCharNumber(Chr) || ( Chr == '.' && isCharNumber(NextChr) ))
+        {
+            bool HasNumberDot = false;
+            
+            for (; Ptr < End; ++Ptr)
+            {
+                if (*Ptr == '.')
+                {
+                    if (HasNumberDot)
+                    {
+                        exitWithError("Too many dots in number");
+                        return false;
+                    }
+                    if (Ptr + 1 >= End || !isCharNumber(Ptr[1]))
+                    {
+                        exitWithError("Floating point number without a number after the dot");
+                        return false;
+                    }
+                    HasNumberDot = true;
+                }
+                else if (!isCharNumber(*Ptr))
+                    break;
+            }
+            
+            Tokens.push_back(STokenView(
+                HasNumberDot ? TOKEN_NUMBER_FLOAT : TOKEN_NUMBER_INT, Offset, static_cast<u32>(Ptr - Begin) - Offset, Row_, Column_
+            ));
+            continue;
+        }
+        
+        /* Check for special signs */
+        const c8* Sign = strchr(SpecialSignTokens, Chr);
+        
+        if (Sign)
+        {
+            const u32 Index = static_cast<u32>(Sign - SpecialSignTokens);
+            Tokens.push_back(STokenView(static_cast<ETokenTypes>(TOKEN_COMMA + Index), Offset, 1, Row_, Column_));
+        }
+        
+        ++Ptr;
+    }
+    
+    Tokens.push_back(STokenView(TOKEN_EOF, static_cast<u32>(Ptr - Begin), 0, Row_, static_cast<s32>(Ptr - LineStart) + 1));
+    
+    return true;
+}
+
+
 void TokenScanner::nextChar()
 {
     /* Get next and current characters */
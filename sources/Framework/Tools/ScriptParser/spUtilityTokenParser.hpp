@@ -16,6 +16,7 @@
 
 #include "Base/spInputOutputString.hpp"
 #include "Framework/Tools/ScriptParser/spUtilityTokenIterator.hpp"
+#include "Framework/Tools/ScriptParser/spUtilityTokenViewStream.hpp"
 
 
 namespace sp
@@ -93,10 +94,39 @@ class SP_EXPORT TokenScanner
             const io::stringc &InputFilename, const ETokenCommentStyles CommentStyle = COMMENTSTYLE_NONE, s32 Flags = 0
         );
         
+        /**
+        Reads all tokens out of the given string into a token view stream. In contrast to "readTokens" no string
+        is allocated per token. The input string is copied once into the stream and each token only stores
+        its offset and length inside this copy. Use this for large scripts.
+        \param[in] InputString Specifies the input string.
+        \param[in] CommentStyle Specifies the comment style. By default COMMENTSTYLE_NONE.
+        \param[in] Flags Specifies some options parsing flags.
+        This can be a combination of the ETokenScannerFlags enumeration values.
+        \return TokenViewStream shared pointer or null if an error occured.
+        \see readTokens
+        \see TokenViewStream
+        \since Version 3.3
+        */
+        TokenViewStreamPtr readTokenViews(
+            const io::stringc &InputString, const ETokenCommentStyles CommentStyle = COMMENTSTYLE_NONE, s32 Flags = 0
+        );
+        
+        /**
+        Does the same as the "readTokenViews" procedure but reads the file directly into the token view stream.
+        \param[in] Filename Specifies the input file which is to be read.
+        \see readTokenViews
+        \since Version 3.3
+        */
+        TokenViewStreamPtr parseFileViews(
+            const io::stringc &InputFilename, const ETokenCommentStyles CommentStyle = COMMENTSTYLE_NONE, s32 Flags = 0
+        );
+        
     private:
         
         /* === Functions === */
         
+        bool scanTokenViews(TokenViewStream &Stream, const ETokenCommentStyles CommentStyle, s32 Flags);
+        
         void nextChar();
         void ignore(u32 Count);
         
@@ -0,0 +1,336 @@
+/*
+ * Token view stream file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "Framework/Tools/ScriptParser/spUtilityTokenViewStream.hpp"
+
+#ifdef SP_COMPILE_WITH_TOKENSCANNER
+
+
+#include "Base/spMath.hpp"
+
+#include <cstring>
+#include <cstdlib>
+
+
+namespace sp
+{
+namespace tool
+{
+
+
+/*
+ * STokenView structure
+ */
+
+STokenView::STokenView() :
+    Type    (TOKEN_UNKNOWN  ),
+    Offset  (0              ),
+    Length  (0              ),
+    Row     (0              ),
+    Column  (0              )
+{
+}
+STokenView::STokenView(
+    const ETokenTypes TokenType, u32 TokenOffset, u32 TokenLength, s32 TokenRow, s32 TokenColumn) :
+    Type    (TokenType  ),
+    Offset  (TokenOffset),
+    Length  (TokenLength),
+    Row     (TokenRow   ),
+    Column  (TokenColumn)
+{
+}
+STokenView::~STokenView()
+{
+}
+
+io::stringc STokenView::getRowColumnString() const
+{
+    return "[" + io::stringc(Row) + ":" + io::stringc(Column) + "]";
+}
+
+bool STokenView::isWhiteSpace(bool DisableNewLineChars) const
+{
+    return Type == TOKEN_BLANK || Type == TOKEN_TAB || ( !DisableNewLineChars && Type == TOKEN_NEWLINE );
+}
+
+bool STokenView::isOpenBracket() const
+{
+    return Type == TOKEN_BRACKET_LEFT || Type == TOKEN_SQUARED_BRACKET_LEFT || Type == TOKEN_BRACE_LEFT;
+}
+bool STokenView::isCloseBracket() const
+{
+    return Type == TOKEN_BRACKET_RIGHT || Type == TOKEN_SQUARED_BRACKET_RIGHT || Type == TOKEN_BRACE_RIGHT;
+}
+
+
+/*
+ * TokenViewStream class
+ */
+
+STokenView TokenViewStream::InvalidToken_;
+
+TokenViewStream::TokenViewStream() :
+    Index_      (0      ),
+    ForceNLChar_(false  )
+{
+}
+TokenViewStream::~TokenViewStream()
+{
+}
+
+const STokenView& TokenViewStream::getToken() const
+{
+    return Index_ < Tokens_.size() ? Tokens_[Index_] : TokenViewStream::InvalidToken_;
+}
+
+const STokenView& TokenViewStream::getNextToken(bool IgnoreWhiteSpaces, bool RestoreIterator)
+{
+    const u32 PrevIndex = Index_;
+    
+    while (Index_ < Tokens_.size())
+    {
+        const STokenView& Tkn = Tokens_[Index_];
+        
+        ++Index_;
+        
+        if (!IgnoreWhiteSpaces || !Tkn.isWhiteSpace(ForceNLChar_))
+        {
+            if (RestoreIterator)
+                Index_ = PrevIndex;
+            return Tkn;
+        }
+    }
+    
+    if (RestoreIterator)
+        Index_ = PrevIndex;
+    
+    return TokenViewStream::InvalidToken_;
+}
+
+const STokenView& TokenViewStream::getPrevToken(bool IgnoreWhiteSpaces, bool RestoreIterator)
+{
+    const u32 PrevIndex = Index_;
+    
+    while (Index_ > 0)
+    {
+        --Index_;
+        
+        const STokenView& Tkn = Tokens_[Index_];
+        
+        if (!IgnoreWhiteSpaces || !Tkn.isWhiteSpace(ForceNLChar_))
+        {
+            if (RestoreIterator)
+                Index_ = PrevIndex;
+            return Tkn;
+        }
+    }
+    
+    if (RestoreIterator)
+        Index_ = PrevIndex;
+    
+    return TokenViewStream::InvalidToken_;
+}
+
+const STokenView& TokenViewStream::getNextToken(const ETokenTypes NextTokenType, bool IgnoreWhiteSpaces, bool RestoreIterator)
+{
+    const u32 PrevIndex = Index_;
+    
+    while (1)
+    {
+        const STokenView& Tkn = getNextToken(IgnoreWhiteSpaces);
+        
+        if (Tkn.Type == NextTokenType || Tkn.Type == TOKEN_EOF || Tkn.Type == TOKEN_UNKNOWN || Index_ >= Tokens_.size())
+        {
+            if (RestoreIterator)
+                Index_ = PrevIndex;
+            return Tkn;
+        }
+    }
+}
+
+bool TokenViewStream::next()
+{
+    if (Index_ < Tokens_.size())
+    {
+        ++Index_;
+        return true;
+    }
+    return false;
+}
+
+bool TokenViewStream::prev()
+{
+    if (Index_ > 0)
+    {
+        --Index_;
+        return true;
+    }
+    return false;
+}
+
+void TokenViewStream::push(bool UsePrevIndex)
+{
+    if (UsePrevIndex)
+    {
+        if (Index_ > 0)
+            Stack_.push(Index_ - 1);
+    }
+    else
+        Stack_.push(Index_);
+}
+
+const STokenView& TokenViewStream::pop(bool UsePrevIndex)
+{
+    if (!Stack_.empty())
+    {
+        if (UsePrevIndex)
+            Index_ = Stack_.top();
+        Stack_.pop();
+    }
+    return getToken();
+}
+
+void TokenViewStream::ignoreBlock(bool SearchNextBlock)
+{
+    /* Check if current token is a starting bracket */
+    const STokenView* Tkn = &getToken();
+    
+    if (!Tkn->isOpenBracket())
+    {
+        if (!SearchNextBlock)
+            return;
+        
+        /* Find starting block */
+        do
+        {
+            Tkn = &getNextToken();
+            if (!Tkn->valid())
+                return;
+        }
+        while (!Tkn->isOpenBracket());
+    }
+    
+    /* Find respective closing bracket */
+    u32 Depth = 1;
+    
+    while (Depth > 0)
+    {
+        Tkn = &getNextToken();
+        
+        if (!Tkn->valid() || Tkn->eof())
+            break;
+        
+        if (Tkn->isOpenBracket())
+            ++Depth;
+        else if (Tkn->isCloseBracket())
+            --Depth;
+    }
+}
+
+ETokenValidationErrors TokenViewStream::validateBrackets(const STokenView* &InvalidToken, s32 Flags) const
+{
+    std::stack<const STokenView*> BracketStack;
+    
+    for (std::vector<STokenView>::const_iterator it = Tokens_.begin(); it != Tokens_.end(); ++it)
+    {
+        const STokenView& Tkn = *it;
+        
+        /* Get the respective opening bracket type */
+        ETokenTypes OpenType = TOKEN_UNKNOWN;
+        
+        switch (Tkn.Type)
+        {
+            case TOKEN_BRACKET_LEFT:
+            case TOKEN_BRACKET_RIGHT:
+                if ((Flags & VALIDATE_BRACKET) == 0)
+                    continue;
+                OpenType = TOKEN_BRACKET_LEFT;
+                break;
+            case TOKEN_SQUARED_BRACKET_LEFT:
+            case TOKEN_SQUARED_BRACKET_RIGHT:
+                if ((Flags & VALIDATE_SQUARED_BRACKET) == 0)
+                    continue;
+                OpenType = TOKEN_SQUARED_BRACKET_LEFT;
+                break;
+            case TOKEN_BRACE_LEFT:
+            case TOKEN_BRACE_RIGHT:
+                if ((Flags & VALIDATE_BRACE) == 0)
+                    continue;
+                OpenType = TOKEN_BRACE_LEFT;
+                break;
+            default:
+                continue;
+        }
+        
+        if (Tkn.isOpenBracket())
+            BracketStack.push(&Tkn);
+        else
+        {
+            if (BracketStack.empty() || BracketStack.top()->Type != OpenType)
+            {
+                InvalidToken = &Tkn;
+                return VALIDATION_ERROR_UNEXPECTED;
+            }
+            BracketStack.pop();
+        }
+    }
+    
+    if (!BracketStack.empty())
+    {
+        InvalidToken = BracketStack.top();
+        return VALIDATION_ERROR_UNCLOSED;
+    }
+    
+    return VALIDATION_ERROR_NONE;
+}
+
+io::stringc TokenViewStream::getString(const STokenView &Tkn) const
+{
+    io::stringc Str;
+    Str.str().assign(getData(Tkn), Tkn.Length);
+    return Str;
+}
+
+void TokenViewStream::appendString(const STokenView &Tkn, io::stringc &OutputString) const
+{
+    OutputString.str().append(getData(Tkn), Tkn.Length);
+}
+
+bool TokenViewStream::compare(const STokenView &Tkn, const c8* Str) const
+{
+    return Str && strncmp(getData(Tkn), Str, Tkn.Length) == 0 && Str[Tkn.Length] == 0;
+}
+
+bool TokenViewStream::compare(const STokenView &Tkn, const io::stringc &Str) const
+{
+    return Str.size() == Tkn.Length && memcmp(getData(Tkn), Str.c_str(), Tkn.Length) == 0;
+}
+
+f64 TokenViewStream::getNumber(const STokenView &Tkn) const
+{
+    /* Copy the characters into a small null-terminated buffer (numbers are never that long) */
+    c8 NumberStr[64];
+    
+    const u32 Len = math::Min(Tkn.Length, static_cast<u32>(sizeof(NumberStr) - 1));
+    
+    memcpy(NumberStr, getData(Tkn), Len);
+    NumberStr[Len] = 0;
+    
+    return atof(NumberStr);
+}
+
+
+} // /namespace tool
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
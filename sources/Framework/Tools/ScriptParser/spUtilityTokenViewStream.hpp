@@ -0,0 +1,216 @@
+/*
+ * Token view stream header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_UTILITY_TOKEN_VIEW_STREAM_H__
+#define __SP_UTILITY_TOKEN_VIEW_STREAM_H__
+
+
+#include "Base/spStandard.hpp"
+
+#ifdef SP_COMPILE_WITH_TOKENSCANNER
+
+
+#include "Framework/Tools/ScriptParser/spUtilityTokenIterator.hpp"
+
+#include <boost/shared_ptr.hpp>
+#include <vector>
+#include <stack>
+
+
+namespace sp
+{
+namespace tool
+{
+
+
+/**
+Script token view structure. In contrast to SToken this token does not own its string.
+It only stores the offset and length of its characters inside the source buffer of the TokenViewStream.
+\see TokenViewStream
+\since Version 3.3
+*/
+struct SP_EXPORT STokenView
+{
+    STokenView();
+    STokenView(const ETokenTypes TokenType, u32 TokenOffset, u32 TokenLength, s32 TokenRow, s32 TokenColumn);
+    ~STokenView();
+    
+    /* === Functions === */
+    
+    //! Returns the stored row and column of this token as a string (e.g. "[5:17]").
+    io::stringc getRowColumnString() const;
+    
+    //! Returns true if this token is from the type TOKEN_BLANK, TOKEN_TAB or TOKEN_NEWLINE. \see ETokenTypes
+    bool isWhiteSpace(bool DisableNewLineChars = false) const;
+    
+    bool isOpenBracket() const;
+    bool isCloseBracket() const;
+    
+    /* === Inline functions === */
+    
+    //! Returns true if this token is from the type TOKEN_EOF. \see ETokenTypes
+    inline bool eof() const
+    {
+        return Type == TOKEN_EOF;
+    }
+    //! Returns true if this token is not from the type TOKEN_UNKNOWN. \see ETokenTypes
+    inline bool valid() const
+    {
+        return Type != TOKEN_UNKNOWN;
+    }
+    //! Returns true if this token has no characters (e.g. an empty string token or the EOF token).
+    inline bool empty() const
+    {
+        return Length == 0;
+    }
+    
+    /* === Members === */
+    
+    ETokenTypes Type;   //!< Token type. \see ETokenTypes
+    u32 Offset;         //!< Offset of the first character in the source buffer.
+    u32 Length;         //!< Count of characters. For strings this is the length without the quotes and with solved escape characters.
+    s32 Row;            //!< Row (or rather line) in string.
+    s32 Column;         //!< Column in string.
+};
+
+
+/**
+The token view stream is the zero-copy counterpart of the TokenStream. It owns a single copy of the source string
+and stores all tokens in one contiguous container. The tokens only refer to their characters inside this buffer,
+so no string is allocated unless the client explicitly asks for it (e.g. with "getString").
+\see TokenScanner::readTokenViews
+\since Version 3.3
+*/
+class SP_EXPORT TokenViewStream
+{
+    
+    public:
+        
+        TokenViewStream();
+        ~TokenViewStream();
+        
+        /* === Functions === */
+        
+        //! Returns the current token.
+        const STokenView& getToken() const;
+        
+        const STokenView& getNextToken(bool IgnoreWhiteSpaces = true, bool RestoreIterator = false);
+        const STokenView& getPrevToken(bool IgnoreWhiteSpaces = true, bool RestoreIterator = false);
+        
+        const STokenView& getNextToken(const ETokenTypes NextTokenType, bool IgnoreWhiteSpaces = true, bool RestoreIterator = false);
+        
+        bool next();
+        bool prev();
+        
+        void push(bool UsePrevIndex = true);
+        const STokenView& pop(bool UsePrevIndex = true);
+        
+        /**
+        If the current token is a bracket ('(', '[' or '{'), this function call will ignore the whole bracket,
+        i.e. to the respective closing bracket (')', ']' or '}').
+        \see TokenStream::ignoreBlock
+        */
+        void ignoreBlock(bool SearchNextBlock = false);
+        
+        //! \see TokenStream::validateBrackets
+        ETokenValidationErrors validateBrackets(const STokenView* &InvalidToken, s32 Flags = ~0) const;
+        
+        //! Returns the characters of the specified token as new string.
+        io::stringc getString(const STokenView &Tkn) const;
+        //! Appends the characters of the specified token to the output string.
+        void appendString(const STokenView &Tkn, io::stringc &OutputString) const;
+        
+        //! Returns true if the characters of the specified token are equal to the specified null-terminated string.
+        bool compare(const STokenView &Tkn, const c8* Str) const;
+        //! Returns true if the characters of the specified token are equal to the specified string.
+        bool compare(const STokenView &Tkn, const io::stringc &Str) const;
+        
+        //! Returns the number value of the specified token without allocating a string.
+        f64 getNumber(const STokenView &Tkn) const;
+        
+        /* === Inline functions === */
+        
+        //! Returns a pointer to the first character of the specified token. The characters are not null-terminated!
+        inline const c8* getData(const STokenView &Tkn) const
+        {
+            return Buffer_.c_str() + Tkn.Offset;
+        }
+        
+        //! Returns the first character of the specified token. This is the sign of special tokens (e.g. '{').
+        inline c8 getChar(const STokenView &Tkn) const
+        {
+            return Tkn.Length > 0 ? Buffer_[Tkn.Offset] : 0;
+        }
+        
+        template <typename T> inline T getValue(const STokenView &Tkn) const
+        {
+            return static_cast<T>(getNumber(Tkn));
+        }
+        
+        //! Validates the brackets without the invalid token output.
+        inline ETokenValidationErrors validateBrackets(s32 Flags = ~0) const
+        {
+            const STokenView* Unused = 0;
+            return validateBrackets(Unused, Flags);
+        }
+        
+        //! \see TokenStream::setForceNLChar
+        inline void setForceNLChar(bool Enable)
+        {
+            ForceNLChar_ = Enable;
+        }
+        inline bool getForceNLChar() const
+        {
+            return ForceNLChar_;
+        }
+        
+        //! Returns the token list.
+        inline const std::vector<STokenView>& getTokenList() const
+        {
+            return Tokens_;
+        }
+        
+        //! Returns the source buffer. String tokens with escape characters have been solved inside this buffer.
+        inline const io::stringc& getBuffer() const
+        {
+            return Buffer_;
+        }
+        
+    private:
+        
+        friend class TokenScanner;
+        friend class ScriptCache;
+        
+        /* === Members === */
+        
+        io::stringc Buffer_;
+        std::vector<STokenView> Tokens_;
+        u32 Index_;
+        
+        std::stack<u32> Stack_;
+        
+        bool ForceNLChar_;
+        
+        static STokenView InvalidToken_;
+        
+};
+
+typedef boost::shared_ptr<TokenViewStream> TokenViewStreamPtr;
+
+
+} // /namespace tool
+
+} // /namespace sp
+
+
+#endif
+
+#endif
+
+
+
+// ================================================================================
@@ -14,10 +14,14 @@
 #include "Framework/Tools/LightmapGenerator/spLightmapGenerator.hpp"
 #include "Framework/Tools/ScriptParser/spToolScriptLoader.hpp"
 #include "Framework/Tools/ScriptParser/spToolXMLParser.hpp"
+#include "Framework/Tools/ScriptParser/spToolXMLReader.hpp"
 #include "Framework/Tools/spToolModelCombiner.hpp"
 #include "Framework/Tools/spToolTextureManipulator.hpp"
 #include "Framework/Tools/spToolParticleAnimator.hpp"
+#include "Framework/Tools/spToolParticleSystem.hpp"
 #include "Framework/Tools/spToolPathFinder.hpp"
+#include "Framework/Tools/spToolPathFlowField.hpp"
+#include "Framework/Tools/spToolGridPathFinder.hpp"
 #include "Framework/Tools/spUtilityDebugging.hpp"
 #include "Framework/Tools/spUtilityInputService.hpp"
 #include "Framework/Tools/spUtilityCommandLine.hpp"
@@ -0,0 +1,1047 @@
+/*
+ * Grid path finder file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "Framework/Tools/spToolGridPathFinder.hpp"
+
+#ifdef SP_COMPILE_WITH_PATHFINDER
+
+
+#include "Base/spMathCore.hpp"
+
+#include <algorithm>
+
+
+namespace sp
+{
+namespace tool
+{
+
+
+/*
+ * Internal functions
+ */
+
+static f32 getOctileDistance(const dim::point2di &A, const dim::point2di &B)
+{
+    const s32 DistX = math::Abs(A.X - B.X);
+    const s32 DistY = math::Abs(A.Y - B.Y);
+    
+    /* Diagonal steps cost sqrt(2), straight steps cost 1 */
+    return static_cast<f32>(math::Max(DistX, DistY)) + (math::SQRT2F - 1.0f) * static_cast<f32>(math::Min(DistX, DistY));
+}
+
+static dim::point2di getDirection(const dim::point2di &From, const dim::point2di &To)
+{
+    return dim::point2di(math::sgn(To.X - From.X), math::sgn(To.Y - From.Y));
+}
+
+
+/*
+ * GridPathQuery class
+ */
+
+const u32 GridPathQuery::INVALID_NODE = ~0u;
+
+GridPathQuery::GridPathQuery() :
+    NumExpandedNodes_   (0      ),
+    isSolved_           (false  )
+{
+}
+GridPathQuery::~GridPathQuery()
+{
+}
+
+
+/*
+ * GridPathGraph class
+ */
+
+GridPathGraph::GridPathGraph() :
+    ClusterSize_        (0      ),
+    NumAbstractNodes_   (0      ),
+    isDirty_            (false  )
+{
+}
+GridPathGraph::~GridPathGraph()
+{
+}
+
+void GridPathGraph::create(
+    const dim::vector3df &From, const dim::vector3df &To, const dim::size2di &Size,
+    const std::vector<bool> &Bitmap, s32 ClusterSize)
+{
+    clear();
+    
+    if (Size.Width < 1 || Size.Height < 1)
+        return;
+    
+    From_           = From;
+    To_             = To;
+    Size_           = Size;
+    ClusterSize_    = math::Max(0, ClusterSize);
+    
+    /* Create the compact bitmap */
+    const u32 NumCells = static_cast<u32>(Size_.Width * Size_.Height);
+    
+    Bitmap_.resize((NumCells + 31) / 32, 0);
+    
+    for (u32 i = 0; i < NumCells; ++i)
+    {
+        if (i >= Bitmap.size() || Bitmap[i])
+            Bitmap_[i >> 5] |= (1u << (i & 31));
+    }
+    
+    if (ClusterSize_ == 0)
+        return;
+    
+    /* Create clusters and the borders between them */
+    NumClusters_.Width  = (Size_.Width  + ClusterSize_ - 1) / ClusterSize_;
+    NumClusters_.Height = (Size_.Height + ClusterSize_ - 1) / ClusterSize_;
+    
+    Clusters_.resize(NumClusters_.Width * NumClusters_.Height);
+    Borders_.resize(Clusters_.size() * 2);
+    
+    for (s32 y = 0; y < NumClusters_.Height; ++y)
+    {
+        for (s32 x = 0; x < NumClusters_.Width; ++x)
+        {
+            SCluster& Cluster = Clusters_[y*NumClusters_.Width + x];
+            
+            Cluster.Rect = dim::rect2di(
+                x*ClusterSize_, y*ClusterSize_,
+                math::Min((x + 1)*ClusterSize_, Size_.Width),
+                math::Min((y + 1)*ClusterSize_, Size_.Height)
+            );
+            
+            if (x + 1 < NumClusters_.Width)
+            {
+                SBorder& Border = Borders_[getBorderIndex(x, y, true)];
+                Border.Direction = dim::point2di(1, 0);
+                Border.Dirty = true;
+            }
+            if (y + 1 < NumClusters_.Height)
+            {
+                SBorder& Border = Borders_[getBorderIndex(x, y, false)];
+                Border.Direction = dim::point2di(0, 1);
+                Border.Dirty = true;
+            }
+        }
+    }
+    
+    isDirty_ = true;
+    
+    updateClusters();
+}
+
+void GridPathGraph::clear()
+{
+    Bitmap_.clear();
+    Clusters_.clear();
+    Borders_.clear();
+    AbstractNodes_.clear();
+    NodeIndices_.clear();
+    
+    Size_               = 0;
+    NumClusters_        = 0;
+    ClusterSize_        = 0;
+    NumAbstractNodes_   = 0;
+    isDirty_            = false;
+}
+
+void GridPathGraph::setWalkable(const dim::point2di &Cell, bool Walkable)
+{
+    if (Cell.X < 0 || Cell.Y < 0 || Cell.X >= Size_.Width || Cell.Y >= Size_.Height || walkable(Cell) == Walkable)
+        return;
+    
+    const u32 Index = getCellIndex(Cell);
+    
+    if (Walkable)
+        Bitmap_[Index >> 5] |= (1u << (Index & 31));
+    else
+        Bitmap_[Index >> 5] &= ~(1u << (Index & 31));
+    
+    if (ClusterSize_ > 0)
+        markDirty(Cell);
+}
+
+bool GridPathGraph::isWalkable(const dim::point2di &Cell) const
+{
+    return walkable(Cell);
+}
+
+u32 GridPathGraph::updateClusters()
+{
+    if (!isDirty_)
+        return 0;
+    
+    /* Rebuild the transitions of each changed border and mark both neighbor clusters as dirty */
+    for (s32 y = 0; y < NumClusters_.Height; ++y)
+    {
+        for (s32 x = 0; x < NumClusters_.Width; ++x)
+        {
+            const SCluster& Cluster = Clusters_[y*NumClusters_.Width + x];
+            
+            if (x + 1 < NumClusters_.Width)
+            {
+                SBorder& Border = Borders_[getBorderIndex(x, y, true)];
+                
+                if (Border.Dirty)
+                {
+                    buildBorder(
+                        Border, dim::point2di(Cluster.Rect.Right - 1, Cluster.Rect.Top),
+                        dim::point2di(0, 1), Cluster.Rect.Bottom - Cluster.Rect.Top
+                    );
+                    Clusters_[y*NumClusters_.Width + x    ].Dirty = true;
+                    Clusters_[y*NumClusters_.Width + x + 1].Dirty = true;
+                }
+            }
+            if (y + 1 < NumClusters_.Height)
+            {
+                SBorder& Border = Borders_[getBorderIndex(x, y, false)];
+                
+                if (Border.Dirty)
+                {
+                    buildBorder(
+                        Border, dim::point2di(Cluster.Rect.Left, Cluster.Rect.Bottom - 1),
+                        dim::point2di(1, 0), Cluster.Rect.Right - Cluster.Rect.Left
+                    );
+                    Clusters_[ y     *NumClusters_.Width + x].Dirty = true;
+                    Clusters_[(y + 1)*NumClusters_.Width + x].Dirty = true;
+                }
+            }
+        }
+    }
+    
+    /* Rebuild the intra-cluster distances of each changed cluster */
+    std::vector<u32> DirtyClusters;
+    
+    for (u32 i = 0; i < Clusters_.size(); ++i)
+    {
+        if (Clusters_[i].Dirty)
+        {
+            buildCluster(i);
+            DirtyClusters.push_back(i);
+        }
+    }
+    
+    /* Only replace the abstract nodes of the changed clusters, unless too many node slots have become unused */
+    if (AbstractNodes_.size() > NumAbstractNodes_*2)
+        buildAbstractNodes();
+    else
+        updateAbstractNodes(DirtyClusters);
+    
+    isDirty_ = false;
+    
+    return DirtyClusters.size();
+}
+
+bool GridPathGraph::findPath(GridPathQuery &Query, const dim::point2di &From, const dim::point2di &To, std::vector<dim::point2di> &Path) const
+{
+    Path.clear();
+    
+    Query.NumExpandedNodes_ = 0;
+    Query.isSolved_         = false;
+    
+    if (!walkable(From) || !walkable(To))
+        return false;
+    
+    /*
+    Use the jump point search directly for short paths, when the hierarchical path finding is disabled
+    or when the clusters are out of date (they can not be updated here, because this function is const).
+    */
+    if ( ClusterSize_ == 0 || isDirty_ || getClusterIndex(From) == getClusterIndex(To) ||
+         getOctileDistance(From, To) <= static_cast<f32>(ClusterSize_*2) )
+    {
+        Query.isSolved_ = searchJPS(Query, From, To, Path);
+        return Query.isSolved_;
+    }
+    
+    /* Search the path through the abstract cluster graph */
+    if (!searchAbstract(Query, From, To))
+        return false;
+    
+    /* Refine each abstract path segment with the jump point search */
+    std::vector<dim::point2di> Segment;
+    
+    const u32 NumExpandedAbstract = Query.NumExpandedNodes_;
+    u32 NumExpanded = 0;
+    
+    Path.push_back(From);
+    
+    for (u32 i = 1; i < Query.Waypoints_.size(); ++i)
+    {
+        if (!searchJPS(Query, Query.Waypoints_[i - 1], Query.Waypoints_[i], Segment))
+        {
+            Path.clear();
+            return false;
+        }
+        
+        NumExpanded += Query.NumExpandedNodes_;
+        
+        Path.insert(Path.end(), Segment.begin() + 1, Segment.end());
+    }
+    
+    Query.NumExpandedNodes_ = NumExpandedAbstract + NumExpanded;
+    Query.isSolved_         = true;
+    
+    return true;
+}
+
+bool GridPathGraph::findPathJPS(GridPathQuery &Query, const dim::point2di &From, const dim::point2di &To, std::vector<dim::point2di> &Path) const
+{
+    Path.clear();
+    
+    Query.NumExpandedNodes_ = 0;
+    Query.isSolved_         = false;
+    
+    if (!walkable(From) || !walkable(To))
+        return false;
+    
+    Query.isSolved_ = searchJPS(Query, From, To, Path);
+    
+    return Query.isSolved_;
+}
+
+dim::vector3df GridPathGraph::getCellPosition(const dim::point2di &Cell) const
+{
+    const dim::vector3df Stretch(
+        static_cast<f32>(math::Max(1, Size_.Width - 1)), static_cast<f32>(math::Max(1, Size_.Height - 1)), 1.0f
+    );
+    return From_ + (To_ - From_) * dim::vector3df(static_cast<f32>(Cell.X), static_cast<f32>(Cell.Y), 0.0f) / Stretch;
+}
+
+dim::point2di GridPathGraph::getCell(const dim::vector3df &Position) const
+{
+    const dim::vector3df Extent(To_ - From_);
+    const dim::vector3df Offset(Position - From_);
+    
+    dim::point2di Cell;
+    
+    if (Extent.X != 0.0f)
+        Cell.X = math::round(Offset.X / Extent.X * static_cast<f32>(Size_.Width - 1));
+    if (Extent.Y != 0.0f)
+        Cell.Y = math::round(Offset.Y / Extent.Y * static_cast<f32>(Size_.Height - 1));
+    
+    math::clamp(Cell.X, 0, math::Max(0, Size_.Width - 1));
+    math::clamp(Cell.Y, 0, math::Max(0, Size_.Height - 1));
+    
+    return Cell;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void GridPathGraph::markDirty(const dim::point2di &Cell)
+{
+    const s32 X = Cell.X / ClusterSize_, LocalX = Cell.X % ClusterSize_;
+    const s32 Y = Cell.Y / ClusterSize_, LocalY = Cell.Y % ClusterSize_;
+    
+    Clusters_[Y*NumClusters_.Width + X].Dirty = true;
+    
+    /* Cells on a cluster border also change the transitions to the neighbor cluster */
+    if (LocalX == ClusterSize_ - 1 && X + 1 < NumClusters_.Width)
+        Borders_[getBorderIndex(X, Y, true)].Dirty = true;
+    if (LocalX == 0 && X > 0)
+        Borders_[getBorderIndex(X - 1, Y, true)].Dirty = true;
+    if (LocalY == ClusterSize_ - 1 && Y + 1 < NumClusters_.Height)
+        Borders_[getBorderIndex(X, Y, false)].Dirty = true;
+    if (LocalY == 0 && Y > 0)
+        Borders_[getBorderIndex(X, Y - 1, false)].Dirty = true;
+    
+    isDirty_ = true;
+}
+
+void GridPathGraph::buildBorder(SBorder &Border, const dim::point2di &Start, const dim::point2di &Step, s32 Length)
+{
+    /* Long entrances get a transition at both ends, short entrances only one in the middle */
+    static const s32 MAX_SINGLE_TRANSITION_LENGTH = 6;
+    
+    Border.Transitions.clear();
+    Border.Dirty = false;
+    
+    s32 RunStart = -1;
+    
+    for (s32 i = 0; i <= Length; ++i)
+    {
+        const dim::point2di Cell(Start + Step*i);
+        
+        const bool Open = (i < Length && walkable(Cell) && walkable(Cell + Border.Direction));
+        
+        if (Open)
+        {
+            if (RunStart < 0)
+                RunStart = i;
+        }
+        else if (RunStart >= 0)
+        {
+            /* Add transitions for the entrance [RunStart, i) */
+            const s32 RunLength = i - RunStart;
+            
+            if (RunLength < MAX_SINGLE_TRANSITION_LENGTH)
+                Border.Transitions.push_back(Start + Step*(RunStart + RunLength/2));
+            else
+            {
+                Border.Transitions.push_back(Start + Step*RunStart);
+                Border.Transitions.push_back(Start + Step*(i - 1));
+            }
+            
+            RunStart = -1;
+        }
+    }
+}
+
+void GridPathGraph::buildCluster(u32 Index)
+{
+    SCluster& Cluster = Clusters_[Index];
+    
+    const s32 X = static_cast<s32>(Index) % NumClusters_.Width;
+    const s32 Y = static_cast<s32>(Index) / NumClusters_.Width;
+    
+    /* Gather the entrance cells from all four borders */
+    Cluster.Nodes.clear();
+    
+    const SBorder* Borders[4] = { 0, 0, 0, 0 };
+    bool OtherSide[4] = { false, false, true, true };
+    
+    if (X + 1 < NumClusters_.Width)
+        Borders[0] = &Borders_[getBorderIndex(X, Y, true)];
+    if (Y + 1 < NumClusters_.Height)
+        Borders[1] = &Borders_[getBorderIndex(X, Y, false)];
+    if (X > 0)
+        Borders[2] = &Borders_[getBorderIndex(X - 1, Y, true)];
+    if (Y > 0)
+        Borders[3] = &Borders_[getBorderIndex(X, Y - 1, false)];
+    
+    for (u32 i = 0; i < 4; ++i)
+    {
+        if (!Borders[i])
+            continue;
+        
+        for (std::vector<dim::point2di>::const_iterator it = Borders[i]->Transitions.begin(); it != Borders[i]->Transitions.end(); ++it)
+        {
+            const dim::point2di Cell(OtherSide[i] ? *it + Borders[i]->Direction : *it);
+            
+            if (std::find(Cluster.Nodes.begin(), Cluster.Nodes.end(), Cell) == Cluster.Nodes.end())
+                Cluster.Nodes.push_back(Cell);
+        }
+    }
+    
+    /* Compute the distances between all entrance cells inside the cluster */
+    const u32 NumNodes = Cluster.Nodes.size();
+    
+    Cluster.Distances.resize(NumNodes*NumNodes);
+    
+    for (u32 i = 0; i < NumNodes; ++i)
+        searchCluster(BuildQuery_.Cells_, Cluster.Rect, Cluster.Nodes[i], Cluster.Nodes, &Cluster.Distances[i*NumNodes]);
+    
+    Cluster.Dirty = false;
+}
+
+void GridPathGraph::buildAbstractNodes()
+{
+    /* Release all node slots and place the nodes of all clusters one after another */
+    AbstractNodes_.clear();
+    NodeIndices_.clear();
+    NumAbstractNodes_ = 0;
+    
+    std::vector<u32> AllClusters(Clusters_.size());
+    
+    for (u32 i = 0; i < Clusters_.size(); ++i)
+    {
+        SCluster& Cluster = Clusters_[i];
+        
+        Cluster.FirstNode       = 0;
+        Cluster.NumSlots        = 0;
+        Cluster.NumPlacedNodes  = 0;
+        
+        AllClusters[i] = i;
+    }
+    
+    updateAbstractNodes(AllClusters);
+}
+
+void GridPathGraph::updateAbstractNodes(const std::vector<u32> &ChangedClusters)
+{
+    /* Remove the previous nodes of the changed clusters and their links from the neighbor nodes */
+    for (std::vector<u32>::const_iterator it = ChangedClusters.begin(); it != ChangedClusters.end(); ++it)
+    {
+        SCluster& Cluster = Clusters_[*it];
+        
+        for (u32 i = Cluster.FirstNode, n = Cluster.FirstNode + Cluster.NumPlacedNodes; i < n; ++i)
+        {
+            SAbstractNode& Node = AbstractNodes_[i];
+            
+            for (u32 j = 0; j < Node.NumLinks; ++j)
+                GridPathGraph::removeLink(AbstractNodes_[Node.Links[j]], i);
+            
+            Node.NumLinks = 0;
+            NodeIndices_.erase(getCellIndex(Node.Cell));
+        }
+        
+        NumAbstractNodes_ -= Cluster.NumPlacedNodes;
+        Cluster.NumPlacedNodes = 0;
+    }
+    
+    /* Place the new nodes into the previous slots or at the end when the cluster has more nodes than before */
+    std::vector<s32> ChangedBorders;
+    
+    for (std::vector<u32>::const_iterator it = ChangedClusters.begin(); it != ChangedClusters.end(); ++it)
+    {
+        SCluster& Cluster = Clusters_[*it];
+        
+        const u32 NumNodes = Cluster.Nodes.size();
+        
+        if (NumNodes > Cluster.NumSlots)
+        {
+            Cluster.FirstNode   = AbstractNodes_.size();
+            Cluster.NumSlots    = NumNodes;
+            AbstractNodes_.resize(Cluster.FirstNode + NumNodes);
+        }
+        
+        for (u32 i = 0; i < NumNodes; ++i)
+        {
+            SAbstractNode& Node = AbstractNodes_[Cluster.FirstNode + i];
+            
+            Node.Cell       = Cluster.Nodes[i];
+            Node.Cluster    = *it;
+            Node.LocalIndex = i;
+            Node.NumLinks   = 0;
+            
+            NodeIndices_[getCellIndex(Node.Cell)] = Cluster.FirstNode + i;
+        }
+        
+        Cluster.NumPlacedNodes = NumNodes;
+        NumAbstractNodes_ += NumNodes;
+        
+        /* Collect the borders around this cluster */
+        const s32 X = static_cast<s32>(*it) % NumClusters_.Width;
+        const s32 Y = static_cast<s32>(*it) / NumClusters_.Width;
+        
+        if (X + 1 < NumClusters_.Width)
+            ChangedBorders.push_back(getBorderIndex(X, Y, true));
+        if (Y + 1 < NumClusters_.Height)
+            ChangedBorders.push_back(getBorderIndex(X, Y, false));
+        if (X > 0)
+            ChangedBorders.push_back(getBorderIndex(X - 1, Y, true));
+        if (Y > 0)
+            ChangedBorders.push_back(getBorderIndex(X, Y - 1, false));
+    }
+    
+    /* Link the transitions of each border around the changed clusters once */
+    std::sort(ChangedBorders.begin(), ChangedBorders.end());
+    ChangedBorders.erase(std::unique(ChangedBorders.begin(), ChangedBorders.end()), ChangedBorders.end());
+    
+    for (std::vector<s32>::const_iterator it = ChangedBorders.begin(); it != ChangedBorders.end(); ++it)
+    {
+        const SBorder& Border = Borders_[*it];
+        
+        for (std::vector<dim::point2di>::const_iterator itCell = Border.Transitions.begin(); itCell != Border.Transitions.end(); ++itCell)
+        {
+            const u32 NodeA = NodeIndices_[getCellIndex(*itCell)];
+            const u32 NodeB = NodeIndices_[getCellIndex(*itCell + Border.Direction)];
+            
+            AbstractNodes_[NodeA].Links[AbstractNodes_[NodeA].NumLinks++] = NodeB;
+            AbstractNodes_[NodeB].Links[AbstractNodes_[NodeB].NumLinks++] = NodeA;
+        }
+    }
+}
+
+s32 GridPathGraph::getBorderIndex(s32 ClusterX, s32 ClusterY, bool Vertical) const
+{
+    return (ClusterY*NumClusters_.Width + ClusterX)*2 + (Vertical ? 0 : 1);
+}
+
+void GridPathGraph::removeLink(SAbstractNode &Node, u32 LinkedNode)
+{
+    for (u32 i = 0; i < Node.NumLinks; ++i)
+    {
+        if (Node.Links[i] == LinkedNode)
+        {
+            Node.Links[i] = Node.Links[--Node.NumLinks];
+            break;
+        }
+    }
+}
+
+u32 GridPathGraph::getClusterIndex(const dim::point2di &Cell) const
+{
+    if (ClusterSize_ == 0)
+        return 0;
+    return static_cast<u32>((Cell.Y / ClusterSize_)*NumClusters_.Width + Cell.X / ClusterSize_);
+}
+
+void GridPathGraph::searchCluster(
+    GridPathQuery::SSearchSpace &Space, const dim::rect2di &Rect,
+    const dim::point2di &Start, const std::vector<dim::point2di> &Targets, f32* Costs) const
+{
+    /* Dijkstra search which is limited to the cluster rectangle */
+    static const dim::point2di Directions[8] =
+    {
+        dim::point2di( 1,  0), dim::point2di(-1,  0), dim::point2di( 0,  1), dim::point2di( 0, -1),
+        dim::point2di( 1,  1), dim::point2di(-1,  1), dim::point2di( 1, -1), dim::point2di(-1, -1)
+    };
+    
+    const u32 NumTargets = Targets.size();
+    
+    for (u32 i = 0; i < NumTargets; ++i)
+        Costs[i] = -1.0f;
+    
+    Space.begin(static_cast<u32>(Size_.Width * Size_.Height));
+    
+    const u32 StartIndex = getCellIndex(Start);
+    
+    GridPathQuery::SNodeState& StartState = Space.visit(StartIndex);
+    StartState.WayCosts         = 0.0f;
+    StartState.EstimatedCosts   = 0.0f;
+    StartState.Predecessor      = GridPathQuery::INVALID_NODE;
+    
+    Space.pushOpen(StartIndex);
+    
+    u32 NumFound = 0, CurIndex = 0;
+    
+    while (NumFound < NumTargets && Space.popOpen(CurIndex))
+    {
+        const dim::point2di Cell(
+            static_cast<s32>(CurIndex) % Size_.Width, static_cast<s32>(CurIndex) / Size_.Width
+        );
+        const f32 CurCosts = Space.getState(CurIndex).WayCosts;
+        
+        /* Store costs for the targets */
+        for (u32 i = 0; i < NumTargets; ++i)
+        {
+            if (Targets[i] == Cell)
+            {
+                Costs[i] = CurCosts;
+                ++NumFound;
+            }
+        }
+        
+        for (u32 i = 0; i < 8; ++i)
+        {
+            const dim::point2di& Dir = Directions[i];
+            const dim::point2di Next(Cell + Dir);
+            
+            if ( Next.X < Rect.Left || Next.Y < Rect.Top || Next.X >= Rect.Right || Next.Y >= Rect.Bottom || !walkable(Next) ||
+                 ( Dir.X != 0 && Dir.Y != 0 && ( !walkable(Cell.X + Dir.X, Cell.Y) || !walkable(Cell.X, Cell.Y + Dir.Y) ) ) )
+            {
+                continue;
+            }
+            
+            const f32 Costs = CurCosts + (Dir.X != 0 && Dir.Y != 0 ? math::SQRT2F : 1.0f);
+            const u32 NextIndex = getCellIndex(Next);
+            
+            GridPathQuery::SNodeState* State = Space.getVisitedState(NextIndex);
+            
+            if (!State)
+            {
+                GridPathQuery::SNodeState& NewState = Space.visit(NextIndex);
+                NewState.WayCosts       = Costs;
+                NewState.EstimatedCosts = Costs;
+                NewState.Predecessor    = CurIndex;
+                Space.pushOpen(NextIndex);
+            }
+            else if (State->isOpen() && Costs < State->WayCosts)
+            {
+                State->WayCosts         = Costs;
+                State->EstimatedCosts   = Costs;
+                State->Predecessor      = CurIndex;
+                Space.updateOpen(NextIndex);
+            }
+        }
+    }
+}
+
+bool GridPathGraph::searchJPS(GridPathQuery &Query, const dim::point2di &From, const dim::point2di &To, std::vector<dim::point2di> &Path) const
+{
+    Path.clear();
+    Query.NumExpandedNodes_ = 0;
+    
+    if (From == To)
+    {
+        Path.push_back(From);
+        return true;
+    }
+    
+    GridPathQuery::SSearchSpace& Space = Query.Cells_;
+    
+    Space.begin(static_cast<u32>(Size_.Width * Size_.Height));
+    
+    const u32 StartIndex = getCellIndex(From);
+    const u32 GoalIndex = getCellIndex(To);
+    
+    GridPathQuery::SNodeState& StartState = Space.visit(StartIndex);
+    StartState.WayCosts         = 0.0f;
+    StartState.EstimatedCosts   = getOctileDistance(From, To);
+    StartState.Predecessor      = GridPathQuery::INVALID_NODE;
+    
+    Space.pushOpen(StartIndex);
+    
+    dim::point2di Directions[8];
+    u32 CurIndex = 0;
+    bool Found = false;
+    
+    while (Space.popOpen(CurIndex))
+    {
+        if (CurIndex == GoalIndex)
+        {
+            Found = true;
+            break;
+        }
+        
+        ++Query.NumExpandedNodes_;
+        
+        const dim::point2di Cell(
+            static_cast<s32>(CurIndex) % Size_.Width, static_cast<s32>(CurIndex) / Size_.Width
+        );
+        const GridPathQuery::SNodeState& CurState = Space.getState(CurIndex);
+        const f32 CurCosts = CurState.WayCosts;
+        
+        /* Get the travel direction from the parent jump point */
+        dim::point2di Dir;
+        
+        if (CurState.Predecessor != GridPathQuery::INVALID_NODE)
+        {
+            const dim::point2di Parent(
+                static_cast<s32>(CurState.Predecessor) % Size_.Width, static_cast<s32>(CurState.Predecessor) / Size_.Width
+            );
+            Dir = getDirection(Parent, Cell);
+        }
+        
+        /* Jump into each pruned direction */
+        const u32 NumDirections = getSuccessorDirections(Dir, Directions);
+        
+        for (u32 i = 0; i < NumDirections; ++i)
+        {
+            dim::point2di JumpPoint(Cell);
+            
+            if (!jump(JumpPoint, Directions[i], To))
+                continue;
+            
+            const f32 Costs = CurCosts + getOctileDistance(Cell, JumpPoint);
+            const u32 JumpIndex = getCellIndex(JumpPoint);
+            
+            GridPathQuery::SNodeState* State = Space.getVisitedState(JumpIndex);
+            
+            if (!State)
+            {
+                GridPathQuery::SNodeState& NewState = Space.visit(JumpIndex);
+                NewState.WayCosts       = Costs;
+                NewState.EstimatedCosts = Costs + getOctileDistance(JumpPoint, To);
+                NewState.Predecessor    = CurIndex;
+                Space.pushOpen(JumpIndex);
+            }
+            else if (State->isOpen() && Costs < State->WayCosts)
+            {
+                State->EstimatedCosts   += Costs - State->WayCosts;
+                State->WayCosts         = Costs;
+                State->Predecessor      = CurIndex;
+                Space.updateOpen(JumpIndex);
+            }
+        }
+    }
+    
+    if (!Found)
+        return false;
+    
+    /* Build the path by connecting the jump points (each segment is a straight or diagonal line) */
+    for (u32 Index = GoalIndex; Index != StartIndex; Index = Space.getState(Index).Predecessor)
+    {
+        const u32 PrevIndex = Space.getState(Index).Predecessor;
+        
+        const dim::point2di Cell(
+            static_cast<s32>(Index) % Size_.Width, static_cast<s32>(Index) / Size_.Width
+        );
+        const dim::point2di PrevCell(
+            static_cast<s32>(PrevIndex) % Size_.Width, static_cast<s32>(PrevIndex) / Size_.Width
+        );
+        const dim::point2di Dir(getDirection(Cell, PrevCell));
+        
+        for (dim::point2di Pos(Cell); Pos != PrevCell; Pos += Dir)
+            Path.push_back(Pos);
+    }
+    
+    Path.push_back(From);
+    
+    std::reverse(Path.begin(), Path.end());
+    
+    return true;
+}
+
+bool GridPathGraph::searchAbstract(GridPathQuery &Query, const dim::point2di &From, const dim::point2di &To) const
+{
+    const u32 StartCluster  = getClusterIndex(From);
+    const u32 GoalCluster   = getClusterIndex(To);
+    
+    const SCluster& StartClusterRef = Clusters_[StartCluster];
+    const SCluster& GoalClusterRef  = Clusters_[GoalCluster];
+    
+    Query.Waypoints_.clear();
+    Query.NumExpandedNodes_ = 0;
+    
+    /* Connect the start and goal cell temporarily to the entrances of their clusters */
+    Query.StartCosts_.resize(StartClusterRef.Nodes.size());
+    Query.GoalCosts_.resize(GoalClusterRef.Nodes.size());
+    
+    if (!Query.StartCosts_.empty())
+        searchCluster(Query.Cells_, StartClusterRef.Rect, From, StartClusterRef.Nodes, &Query.StartCosts_[0]);
+    if (!Query.GoalCosts_.empty())
+        searchCluster(Query.Cells_, GoalClusterRef.Rect, To, GoalClusterRef.Nodes, &Query.GoalCosts_[0]);
+    
+    /* A* search through the abstract graph (the last two nodes are the start and the goal) */
+    const u32 NumNodes  = AbstractNodes_.size();
+    const u32 StartNode = NumNodes;
+    const u32 GoalNode  = NumNodes + 1;
+    
+    GridPathQuery::SSearchSpace& Space = Query.Abstract_;
+    
+    Space.begin(NumNodes + 2);
+    
+    GridPathQuery::SNodeState& StartState = Space.visit(StartNode);
+    StartState.WayCosts         = 0.0f;
+    StartState.EstimatedCosts   = getOctileDistance(From, To);
+    StartState.Predecessor      = GridPathQuery::INVALID_NODE;
+    
+    Space.pushOpen(StartNode);
+    
+    u32 CurNode = 0;
+    bool Found = false;
+    
+    while (Space.popOpen(CurNode))
+    {
+        if (CurNode == GoalNode)
+        {
+            Found = true;
+            break;
+        }
+        
+        ++Query.NumExpandedNodes_;
+        
+        const f32 CurCosts = Space.getState(CurNode).WayCosts;
+        
+        /* Gather the successors of the current node */
+        u32 NumSuccessors = 0;
+        
+        if (CurNode == StartNode)
+        {
+            for (u32 i = 0; i < Query.StartCosts_.size(); ++i)
+            {
+                if (Query.StartCosts_[i] >= 0.0f)
+                    Query.Successors_.push_back(std::make_pair(StartClusterRef.FirstNode + i, Query.StartCosts_[i]));
+            }
+        }
+        else
+        {
+            const SAbstractNode& Node = AbstractNodes_[CurNode];
+            const SCluster& Cluster = Clusters_[Node.Cluster];
+            
+            const u32 NumClusterNodes = Cluster.Nodes.size();
+            const f32* Distances = &Cluster.Distances[Node.LocalIndex * NumClusterNodes];
+            
+            for (u32 i = 0; i < NumClusterNodes; ++i)
+            {
+                if (i != Node.LocalIndex && Distances[i] >= 0.0f)
+                    Query.Successors_.push_back(std::make_pair(Cluster.FirstNode + i, Distances[i]));
+            }
+            
+            for (u32 i = 0; i < Node.NumLinks; ++i)
+                Query.Successors_.push_back(std::make_pair(Node.Links[i], 1.0f));
+            
+            if (Node.Cluster == GoalCluster && Query.GoalCosts_[Node.LocalIndex] >= 0.0f)
+                Query.Successors_.push_back(std::make_pair(GoalNode, Query.GoalCosts_[Node.LocalIndex]));
+        }
+        
+        NumSuccessors = Query.Successors_.size();
+        
+        /* Relax all successors */
+        for (u32 i = 0; i < NumSuccessors; ++i)
+        {
+            const u32 NextNode = Query.Successors_[i].first;
+            const f32 Costs = CurCosts + Query.Successors_[i].second;
+            
+            GridPathQuery::SNodeState* State = Space.getVisitedState(NextNode);
+            
+            if (!State)
+            {
+                const dim::point2di& Cell = (NextNode == GoalNode ? To : AbstractNodes_[NextNode].Cell);
+                
+                GridPathQuery::SNodeState& NewState = Space.visit(NextNode);
+                NewState.WayCosts       = Costs;
+                NewState.EstimatedCosts = Costs + getOctileDistance(Cell, To);
+                NewState.Predecessor    = CurNode;
+                Space.pushOpen(NextNode);
+            }
+            else if (State->isOpen() && Costs < State->WayCosts)
+            {
+                State->EstimatedCosts   += Costs - State->WayCosts;
+                State->WayCosts         = Costs;
+                State->Predecessor      = CurNode;
+                Space.updateOpen(NextNode);
+            }
+        }
+        
+        Query.Successors_.clear();
+    }
+    
+    if (!Found)
+        return false;
+    
+    /* Store the waypoints from the start to the goal cell */
+    for (u32 Node = GoalNode; Node != GridPathQuery::INVALID_NODE; Node = Space.getState(Node).Predecessor)
+    {
+        if (Node == GoalNode)
+            Query.Waypoints_.push_back(To);
+        else if (Node == StartNode)
+            Query.Waypoints_.push_back(From);
+        else
+            Query.Waypoints_.push_back(AbstractNodes_[Node].Cell);
+    }
+    
+    std::reverse(Query.Waypoints_.begin(), Query.Waypoints_.end());
+    
+    return true;
+}
+
+bool GridPathGraph::jump(dim::point2di &Cell, const dim::point2di &Dir, const dim::point2di &Goal) const
+{
+    if (Dir.X == 0 || Dir.Y == 0)
+        return jumpStraight(Cell, Dir, Goal);
+    
+    while (true)
+    {
+        /* Diagonal moves are only allowed if both adjacent straight cells are walkable */
+        if (!walkable(Cell.X + Dir.X, Cell.Y) || !walkable(Cell.X, Cell.Y + Dir.Y) || !walkable(Cell + Dir))
+            return false;
+        
+        Cell += Dir;
+        
+        if (Cell == Goal)
+            return true;
+        
+        /* Each cell which has a jump point in horizontal or vertical direction is a jump point itself */
+        dim::point2di Tmp(Cell);
+        if (jumpStraight(Tmp, dim::point2di(Dir.X, 0), Goal))
+            return true;
+        
+        Tmp = Cell;
+        if (jumpStraight(Tmp, dim::point2di(0, Dir.Y), Goal))
+            return true;
+    }
+    
+    return false;
+}
+
+bool GridPathGraph::jumpStraight(dim::point2di &Cell, const dim::point2di &Dir, const dim::point2di &Goal) const
+{
+    while (true)
+    {
+        if (!walkable(Cell + Dir))
+            return false;
+        
+        Cell += Dir;
+        
+        if (Cell == Goal)
+            return true;
+        
+        /* Check for forced neighbors */
+        if (Dir.X != 0)
+        {
+            if ( ( walkable(Cell.X, Cell.Y - 1) && !walkable(Cell.X - Dir.X, Cell.Y - 1) ) ||
+                 ( walkable(Cell.X, Cell.Y + 1) && !walkable(Cell.X - Dir.X, Cell.Y + 1) ) )
+            {
+                return true;
+            }
+        }
+        else
+        {
+            if ( ( walkable(Cell.X - 1, Cell.Y) && !walkable(Cell.X - 1, Cell.Y - Dir.Y) ) ||
+                 ( walkable(Cell.X + 1, Cell.Y) && !walkable(Cell.X + 1, Cell.Y - Dir.Y) ) )
+            {
+                return true;
+            }
+        }
+    }
+    
+    return false;
+}
+
+u32 GridPathGraph::getSuccessorDirections(const dim::point2di &Dir, dim::point2di* Directions)
+{
+    u32 Count = 0;
+    
+    if (Dir.X == 0 && Dir.Y == 0)
+    {
+        /* The start cell has no parent, so all directions are searched */
+        for (s32 y = -1; y <= 1; ++y)
+        {
+            for (s32 x = -1; x <= 1; ++x)
+            {
+                if (x != 0 || y != 0)
+                    Directions[Count++] = dim::point2di(x, y);
+            }
+        }
+    }
+    else if (Dir.X != 0 && Dir.Y != 0)
+    {
+        /* Natural neighbors for diagonal moves */
+        Directions[Count++] = dim::point2di(Dir.X, 0);
+        Directions[Count++] = dim::point2di(0, Dir.Y);
+        Directions[Count++] = Dir;
+    }
+    else if (Dir.X != 0)
+    {
+        /* Natural and forced neighbors for horizontal moves */
+        Directions[Count++] = Dir;
+        Directions[Count++] = dim::point2di(Dir.X,  1);
+        Directions[Count++] = dim::point2di(Dir.X, -1);
+        Directions[Count++] = dim::point2di(0,  1);
+        Directions[Count++] = dim::point2di(0, -1);
+    }
+    else
+    {
+        /* Natural and forced neighbors for vertical moves */
+        Directions[Count++] = Dir;
+        Directions[Count++] = dim::point2di( 1, Dir.Y);
+        Directions[Count++] = dim::point2di(-1, Dir.Y);
+        Directions[Count++] = dim::point2di( 1, 0);
+        Directions[Count++] = dim::point2di(-1, 0);
+    }
+    
+    return Count;
+}
+
+GridPathGraph::SBorder::SBorder() :
+    Dirty(false)
+{
+}
+GridPathGraph::SBorder::~SBorder()
+{
+}
+
+GridPathGraph::SCluster::SCluster() :
+    FirstNode       (0      ),
+    NumSlots        (0      ),
+    NumPlacedNodes  (0      ),
+    Dirty           (true   )
+{
+}
+GridPathGraph::SCluster::~SCluster()
+{
+}
+
+
+} // /namespace tool
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
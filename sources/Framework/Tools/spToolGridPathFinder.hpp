@@ -0,0 +1,301 @@
+/*
+ * Grid path finder header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_TOOL_GRIDPATHFINDER_H__
+#define __SP_TOOL_GRIDPATHFINDER_H__
+
+
+#include "Base/spStandard.hpp"
+
+#ifdef SP_COMPILE_WITH_PATHFINDER
+
+
+#include "Base/spDimension.hpp"
+#include "Framework/Tools/spToolPathSearchSpace.hpp"
+
+#include <vector>
+#include <map>
+
+
+namespace sp
+{
+namespace tool
+{
+
+
+/**
+GridPathQuery objects hold the whole state of a path search in a GridPathGraph.
+Like the PathQuery class for the PathGraph, each thread needs its own query object
+to search paths in the same grid at once.
+\see GridPathGraph::findPath
+\ingroup group_pathfinding
+*/
+class SP_EXPORT GridPathQuery
+{
+    
+    public:
+        
+        GridPathQuery();
+        ~GridPathQuery();
+        
+        /* === Inline functions === */
+        
+        //! Returns true if the last path search with this query object has found a path.
+        inline bool foundPath() const
+        {
+            return isSolved_;
+        }
+        
+        //! Returns the count of nodes (jump points or abstract nodes) which have been expanded during the last path search.
+        inline u32 getNumExpandedNodes() const
+        {
+            return NumExpandedNodes_;
+        }
+        
+    private:
+        
+        friend class GridPathGraph;
+        
+        /* === Types === */
+        
+        //! Search state for one search space (grid cells or abstract nodes).
+        typedef PathSearchSpace<u32> SSearchSpace;
+        typedef SSearchSpace::SNodeState SNodeState;
+        
+        /* === Members === */
+        
+        SSearchSpace Cells_;        //!< Search space for the jump point search.
+        SSearchSpace Abstract_;     //!< Search space for the abstract cluster graph.
+        
+        std::vector<f32> StartCosts_;
+        std::vector<f32> GoalCosts_;
+        
+        std::vector<dim::point2di> Waypoints_;
+        std::vector< std::pair<u32, f32> > Successors_;
+        
+        u32 NumExpandedNodes_;
+        
+        bool isSolved_;
+        
+        static const u32 INVALID_NODE;
+        
+};
+
+
+/**
+GridPathGraph objects represent a uniform 2D grid for path finding. In contrast to a PathGraph created with
+"PathGraph::createGrid" the grid cells are not stored as nodes and edges but only as a compact bitmap.
+Paths are searched with the "Jump Point Search" algorithm which skips all the symmetric paths in open areas.
+For large grids the cells are additionally divided into clusters which form an abstract graph ("HPA*").
+A long path is first searched in the abstract graph and then refined with the jump point search.
+The clusters are rebuilt incrementally when cells are changed with the "setWalkable" function.
+\note The movement is 8-directional but diagonal moves are only allowed when both adjacent straight cells are walkable.
+\ingroup group_pathfinding
+*/
+class SP_EXPORT GridPathGraph
+{
+    
+    public:
+        
+        GridPathGraph();
+        ~GridPathGraph();
+        
+        /* === Functions === */
+        
+        /**
+        Creates a new grid. All cells will be walkable by default.
+        \param From: Specifies the global position of the first cell (0, 0).
+        \param To: Specifies the global position of the last cell (Size.Width - 1, Size.Height - 1).
+        \param Size: Specifies the grid size (count of cells in X and Y direction).
+        \param Bitmap: Specifies the array of walkable cells in the order [ Y*Size.Width + X ].
+        By default empty array which means that all cells are walkable. This is the same layout
+        as for the "PathGraph::createGrid" function with a grid of (Width, Height, 1) nodes.
+        \param ClusterSize: Specifies the width and height of each cluster for the hierarchical path finding.
+        If this is 0, the hierarchical path finding is disabled and each path is searched with the jump point search only.
+        */
+        void create(
+            const dim::vector3df &From, const dim::vector3df &To, const dim::size2di &Size,
+            const std::vector<bool> &Bitmap = std::vector<bool>(), s32 ClusterSize = 16
+        );
+        
+        //! Deletes the grid.
+        void clear();
+        
+        //! Sets the specified cell to walkable or blocked. The affected clusters will be rebuilt with the next "updateClusters" call.
+        void setWalkable(const dim::point2di &Cell, bool Walkable);
+        
+        //! Returns true if the specified cell is inside the grid and walkable.
+        bool isWalkable(const dim::point2di &Cell) const;
+        
+        /**
+        Rebuilds all clusters which have been changed since the last update.
+        Call this after modifying the grid and before searching paths from several threads,
+        because the path search functions are const and do not update the clusters.
+        \return Count of clusters which have been rebuilt.
+        */
+        u32 updateClusters();
+        
+        /**
+        Trys to find a path from the specified start cell to the target cell.
+        \param Query: Specifies the query object which holds the whole search state.
+        \param From: Specifies the start cell.
+        \param To: Specifies the target cell.
+        \param Path: Specifies the resulting path. All cells from the start to the target cell are stored (including both).
+        \return True if a path has been found. Otherwise false.
+        \note When hierarchical path finding is used, the resulting path is nearly but not necessarily exactly optimal.
+        */
+        bool findPath(GridPathQuery &Query, const dim::point2di &From, const dim::point2di &To, std::vector<dim::point2di> &Path) const;
+        
+        //! Trys to find the optimal path only with the jump point search. \see findPath
+        bool findPathJPS(GridPathQuery &Query, const dim::point2di &From, const dim::point2di &To, std::vector<dim::point2di> &Path) const;
+        
+        //! Returns the global position of the specified cell.
+        dim::vector3df getCellPosition(const dim::point2di &Cell) const;
+        
+        //! Returns the cell which is nearest to the specified global position.
+        dim::point2di getCell(const dim::vector3df &Position) const;
+        
+        /* === Inline functions === */
+        
+        //! Returns the grid size.
+        inline const dim::size2di& getSize() const
+        {
+            return Size_;
+        }
+        
+        //! Returns the cluster size or 0 if hierarchical path finding is disabled.
+        inline s32 getClusterSize() const
+        {
+            return ClusterSize_;
+        }
+        
+        //! Returns the count of nodes in the abstract cluster graph.
+        inline u32 getNumAbstractNodes() const
+        {
+            return NumAbstractNodes_;
+        }
+        
+    private:
+        
+        /* === Structures === */
+        
+        //! Border between two neighbor clusters with its transitions.
+        struct SBorder
+        {
+            SBorder();
+            ~SBorder();
+            
+            /* Members */
+            std::vector<dim::point2di> Transitions; //!< Cells on the first side of the border.
+            dim::point2di Direction;                //!< Offset from the first to the second side.
+            bool Dirty;
+        };
+        
+        struct SCluster
+        {
+            SCluster();
+            ~SCluster();
+            
+            /* Members */
+            dim::rect2di Rect;                  //!< Cell range [Left, Right) x [Top, Bottom).
+            std::vector<dim::point2di> Nodes;   //!< Entrance cells inside this cluster.
+            std::vector<f32> Distances;         //!< Distance matrix (Nodes.size() x Nodes.size()) inside the cluster.
+            u32 FirstNode;                      //!< Index of the first node in the flat abstract node list.
+            u32 NumSlots;                       //!< Count of node slots which are reserved for this cluster in the abstract node list.
+            u32 NumPlacedNodes;                 //!< Count of nodes which are currently placed in these slots.
+            bool Dirty;
+        };
+        
+        struct SAbstractNode
+        {
+            dim::point2di Cell;
+            u32 Cluster;
+            u32 LocalIndex;
+            u32 Links[4];                       //!< Inter-cluster links to other abstract nodes.
+            u32 NumLinks;
+        };
+        
+        /* === Functions === */
+        
+        void markDirty(const dim::point2di &Cell);
+        
+        void buildBorder(SBorder &Border, const dim::point2di &Start, const dim::point2di &Step, s32 Length);
+        void buildCluster(u32 Index);
+        void buildAbstractNodes();
+        void updateAbstractNodes(const std::vector<u32> &ChangedClusters);
+        
+        s32 getBorderIndex(s32 ClusterX, s32 ClusterY, bool Vertical) const;
+        u32 getClusterIndex(const dim::point2di &Cell) const;
+        
+        static void removeLink(SAbstractNode &Node, u32 LinkedNode);
+        
+        void searchCluster(
+            GridPathQuery::SSearchSpace &Space, const dim::rect2di &Rect,
+            const dim::point2di &Start, const std::vector<dim::point2di> &Targets, f32* Costs
+        ) const;
+        
+        bool searchJPS(GridPathQuery &Query, const dim::point2di &From, const dim::point2di &To, std::vector<dim::point2di> &Path) const;
+        bool searchAbstract(GridPathQuery &Query, const dim::point2di &From, const dim::point2di &To) const;
+        
+        bool jump(dim::point2di &Cell, const dim::point2di &Dir, const dim::point2di &Goal) const;
+        bool jumpStraight(dim::point2di &Cell, const dim::point2di &Dir, const dim::point2di &Goal) const;
+        static u32 getSuccessorDirections(const dim::point2di &Dir, dim::point2di* Directions);
+        
+        /* === Inline functions === */
+        
+        inline bool walkable(s32 X, s32 Y) const
+        {
+            if (X < 0 || Y < 0 || X >= Size_.Width || Y >= Size_.Height)
+                return false;
+            const u32 Index = static_cast<u32>(Y*Size_.Width + X);
+            return (Bitmap_[Index >> 5] & (1u << (Index & 31))) != 0;
+        }
+        inline bool walkable(const dim::point2di &Cell) const
+        {
+            return walkable(Cell.X, Cell.Y);
+        }
+        
+        inline u32 getCellIndex(const dim::point2di &Cell) const
+        {
+            return static_cast<u32>(Cell.Y*Size_.Width + Cell.X);
+        }
+        
+        /* === Members === */
+        
+        dim::vector3df From_, To_;
+        dim::size2di Size_;
+        
+        std::vector<u32> Bitmap_; //!< Bit mask of walkable cells (32 cells per entry).
+        
+        s32 ClusterSize_;
+        dim::size2di NumClusters_;
+        
+        std::vector<SCluster> Clusters_;
+        std::vector<SBorder> Borders_;
+        std::vector<SAbstractNode> AbstractNodes_; //!< Nodes of all clusters. Slots of clusters which have been moved are unused.
+        std::map<u32, u32> NodeIndices_;            //!< Abstract node index of each entrance cell (by cell index).
+        u32 NumAbstractNodes_;
+        
+        GridPathQuery BuildQuery_; //!< Search state which is used to build the clusters.
+        
+        bool isDirty_;
+        
+};
+
+
+} // /namespace tool
+
+} // /namespace sp
+
+
+#endif
+
+#endif
+
+
+
+// ================================================================================
@@ -71,6 +71,7 @@ ParticleAnimator is a further 'GameEngine like' tool to simplify particle animat
 Normally for each particle effect (e.g. fire effect, smoke effect etc.) one ParticleAnimator has to be
 created and not only one for all effects because you would get problems with callback handling.
 The ParticleAnimator does not create any billboards (or sprites). You have to create the sprites yourself.
+\note Each particle is a Billboard scene node with its own draw call. For large particle counts use the ParticleSystem class.
 */
 class SP_EXPORT ParticleAnimator
 {
@@ -0,0 +1,439 @@
+/*
+ * Particle system file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "Framework/Tools/spToolParticleSystem.hpp"
+
+#ifdef SP_COMPILE_WITH_PARTICLEANIMATOR
+
+
+#include "Base/spMathRandomizer.hpp"
+#include "Base/spThreadPool.hpp"
+#include "Base/spVertexFormatUniversal.hpp"
+#include "SceneGraph/spSceneNode.hpp"
+#include "RenderSystem/spRenderSystem.hpp"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#   define SP_PARTICLE_SIMD
+#   include <xmmintrin.h>
+#endif
+
+
+namespace sp
+{
+
+extern video::RenderSystem* GlbRenderSys;
+
+namespace tool
+{
+
+
+/*
+ * Internal members
+ */
+
+//! Minimal count of particles per thread. Smaller batches are not worth the thread overhead.
+static const u32 PARTICLE_THREAD_BATCH = 4096;
+
+struct SParticleTaskData
+{
+    ParticleSystem* System;
+    s32 Task;
+    u32 BatchSize;
+    u32 NumBatches;
+    f32 DeltaTime;
+};
+
+void ParticleSystemTaskProc(u32 Index, void* UserData)
+{
+    SParticleTaskData* TaskData = reinterpret_cast<SParticleTaskData*>(UserData);
+    
+    const u32 NumParticles = TaskData->System->NumParticles_;
+    
+    /* The last batch takes the remaining particles */
+    const u32 First = math::Min(Index * TaskData->BatchSize, NumParticles);
+    const u32 Last = (Index + 1 == TaskData->NumBatches ? NumParticles : math::Min((Index + 1) * TaskData->BatchSize, NumParticles));
+    
+    TaskData->System->processTask(
+        static_cast<ParticleSystem::EParticleTasks>(TaskData->Task), First, Last, TaskData->DeltaTime
+    );
+}
+
+
+/*
+ * ParticleSystem class
+ */
+
+ParticleSystem::ParticleSystem(const SParticleSystemDesc &Desc) :
+    scene::MaterialNode (scene::NODE_CUSTOM ),
+    NumParticles_       (0                  ),
+    EmissionCounter_    (0.0f               ),
+    ThreadCount_        (1                  ),
+    VertexFormat_       (0                  ),
+    Surface_            (0                  ),
+    NumQuadVertices_    (6                  ),
+    isColorARGB_        (false              )
+{
+    /* Create vertex format: position, color and one texture coordinate */
+    VertexFormat_ = GlbRenderSys->createVertexFormat<video::VertexFormatUniversal>();
+    {
+        VertexFormat_->addCoord();
+        VertexFormat_->addColor();
+        VertexFormat_->addTexCoord();
+    }
+    
+    /* Create dynamic mesh buffer (non-indexed quads or triangle list) */
+    Surface_ = new video::MeshBuffer(VertexFormat_);
+    {
+        Surface_->createVertexBuffer();
+        Surface_->setIndexBufferEnable(false);
+        Surface_->setVertexBufferUsage(video::HWBUFFER_DYNAMIC);
+    }
+    
+    /* Quads need only 4 instead of 6 vertices per particle but are only supported by OpenGL */
+    if (GlbRenderSys->getRendererType() == video::RENDERER_OPENGL)
+    {
+        Surface_->setPrimitiveType(video::PRIMITIVE_QUADS);
+        NumQuadVertices_ = 4;
+    }
+    
+    /* Direct3D9 expects the vertex color as one 32-bit ARGB value */
+    isColorARGB_ = (GlbRenderSys->getRendererType() == video::RENDERER_DIRECT3D9);
+    
+    /* Particles are usually not lit */
+    Material_.setLighting(false);
+    Material_.setRenderFace(video::FACE_BOTH);
+    
+    setDesc(Desc);
+}
+ParticleSystem::~ParticleSystem()
+{
+    delete Surface_;
+    GlbRenderSys->deleteVertexFormat(VertexFormat_);
+}
+
+void ParticleSystem::render()
+{
+    if (!NumParticles_)
+        return;
+    
+    /* Get the camera's right and up vectors in global space */
+    const dim::vector4df& Right = scene::spViewInvMatrix.getColumn(0);
+    const dim::vector4df& Up    = scene::spViewInvMatrix.getColumn(1);
+    
+    ViewRight_  = dim::vector3df(Right.X, Right.Y, Right.Z).normalize();
+    ViewUp_     = dim::vector3df(Up.X, Up.Y, Up.Z).normalize();
+    
+    /* Build one quad for each particle */
+    Surface_->getVertexBuffer().setCount(NumParticles_ * NumQuadVertices_);
+    runTask(TASK_BUILD_VERTICES, 0.0f);
+    Surface_->updateVertexBuffer();
+    
+    /* Setup material states */
+    GlbRenderSys->setupMaterialStates(getMaterial());
+    GlbRenderSys->setupShaderClass(this, getShaderClass());
+    
+    /* The vertices are already in global space */
+    scene::spWorldMatrix.reset();
+    GlbRenderSys->updateModelviewMatrix();
+    
+    /* Draw all particles at once */
+    GlbRenderSys->drawMeshBuffer(Surface_);
+    
+    GlbRenderSys->unbindShaders();
+}
+
+void ParticleSystem::update(f32 DeltaTime)
+{
+    if (DeltaTime <= 0.0f)
+        return;
+    
+    /* Move all particles */
+    runTask(TASK_SIMULATE, DeltaTime);
+    
+    removeDeadParticles();
+    
+    /* Emit new particles */
+    EmissionCounter_ += Desc_.EmissionRate * DeltaTime;
+    
+    if (EmissionCounter_ >= 1.0f)
+    {
+        const u32 Count = static_cast<u32>(EmissionCounter_);
+        EmissionCounter_ -= static_cast<f32>(Count);
+        emit(Count);
+    }
+}
+
+u32 ParticleSystem::emit(u32 Count)
+{
+    Count = math::Min(Count, Desc_.Capacity - NumParticles_);
+    
+    const dim::vector3df Origin(getPosition(true));
+    
+    for (u32 i = NumParticles_, n = NumParticles_ + Count; i < n; ++i)
+    {
+        PosX_[i]        = Origin.X + math::Randomizer::randFloat(-Desc_.PositionSpread.X, Desc_.PositionSpread.X);
+        PosY_[i]        = Origin.Y + math::Randomizer::randFloat(-Desc_.PositionSpread.Y, Desc_.PositionSpread.Y);
+        PosZ_[i]        = Origin.Z + math::Randomizer::randFloat(-Desc_.PositionSpread.Z, Desc_.PositionSpread.Z);
+        
+        VelX_[i]        = Desc_.Velocity.X + math::Randomizer::randFloat(-Desc_.VelocitySpread.X, Desc_.VelocitySpread.X);
+        VelY_[i]        = Desc_.Velocity.Y + math::Randomizer::randFloat(-Desc_.VelocitySpread.Y, Desc_.VelocitySpread.Y);
+        VelZ_[i]        = Desc_.Velocity.Z + math::Randomizer::randFloat(-Desc_.VelocitySpread.Z, Desc_.VelocitySpread.Z);
+        
+        Age_[i]         = 0.0f;
+        LifeTime_[i]    = math::Randomizer::randFloat(Desc_.MinLifeTime, Desc_.MaxLifeTime);
+    }
+    
+    NumParticles_ += Count;
+    
+    return Count;
+}
+
+void ParticleSystem::clear()
+{
+    NumParticles_       = 0;
+    EmissionCounter_    = 0.0f;
+}
+
+void ParticleSystem::setDesc(const SParticleSystemDesc &Desc)
+{
+    const bool isCapacityChanged = (Desc_.Capacity != Desc.Capacity || PosX_.empty());
+    
+    Desc_ = Desc;
+    
+    if (Desc_.MaxLifeTime < Desc_.MinLifeTime)
+        Desc_.MaxLifeTime = Desc_.MinLifeTime;
+    
+    if (isCapacityChanged)
+        allocatePool();
+}
+
+void ParticleSystem::setTexture(video::Texture* Tex)
+{
+    if (Tex)
+    {
+        if (Surface_->getTextureCount())
+            Surface_->setTexture(0, Tex);
+        else
+            Surface_->addTexture(Tex);
+    }
+    else
+        Surface_->clearTextureLayers();
+}
+
+video::Texture* ParticleSystem::getTexture() const
+{
+    return Surface_->getTexture(0);
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void ParticleSystem::allocatePool()
+{
+    clear();
+    
+    /* Allocate the pool once for the whole capacity */
+    std::vector<f32>* Arrays[] = { &PosX_, &PosY_, &PosZ_, &VelX_, &VelY_, &VelZ_, &Age_, &LifeTime_ };
+    
+    for (u32 i = 0; i < 8; ++i)
+    {
+        std::vector<f32>().swap(*Arrays[i]);
+        Arrays[i]->resize(math::Max(Desc_.Capacity, 1u));
+    }
+    
+    Surface_->getVertexBuffer().setCount(0);
+}
+
+void ParticleSystem::removeDeadParticles()
+{
+    /* Replace each dead particle by the last one to keep the pool dense */
+    for (u32 i = 0; i < NumParticles_;)
+    {
+        if (Age_[i] >= LifeTime_[i])
+        {
+            const u32 Last = --NumParticles_;
+            
+            PosX_       [i] = PosX_     [Last];
+            PosY_       [i] = PosY_     [Last];
+            PosZ_       [i] = PosZ_     [Last];
+            VelX_       [i] = VelX_     [Last];
+            VelY_       [i] = VelY_     [Last];
+            VelZ_       [i] = VelZ_     [Last];
+            Age_        [i] = Age_      [Last];
+            LifeTime_   [i] = LifeTime_ [Last];
+        }
+        else
+            ++i;
+    }
+}
+
+void ParticleSystem::runTask(const EParticleTasks Task, f32 DeltaTime)
+{
+    /* Split the particles into batches which are a multiple of 4 (for the SIMD kernels) */
+    const u32 ThreadCount = math::MinMax(ThreadCount_, 1u, NumParticles_ / PARTICLE_THREAD_BATCH + 1);
+    
+    if (ThreadCount == 1)
+    {
+        processTask(Task, 0, NumParticles_, DeltaTime);
+        return;
+    }
+    
+    SParticleTaskData TaskData;
+    {
+        TaskData.System     = this;
+        TaskData.Task       = Task;
+        TaskData.BatchSize  = ((NumParticles_ / ThreadCount) + 3) & ~3u;
+        TaskData.NumBatches = ThreadCount;
+        TaskData.DeltaTime  = DeltaTime;
+    }
+    ThreadPool::getShared()->run(ParticleSystemTaskProc, &TaskData, ThreadCount);
+}
+
+void ParticleSystem::processTask(const EParticleTasks Task, u32 First, u32 Last, f32 DeltaTime)
+{
+    if (First >= Last)
+        return;
+    
+    switch (Task)
+    {
+        case TASK_SIMULATE:
+            simulate(First, Last, DeltaTime);
+            break;
+        case TASK_BUILD_VERTICES:
+            buildVertices(First, Last);
+            break;
+    }
+}
+
+void ParticleSystem::simulate(u32 First, u32 Last, f32 DeltaTime)
+{
+    f32* PosX = &PosX_[0];
+    f32* PosY = &PosY_[0];
+    f32* PosZ = &PosZ_[0];
+    f32* VelX = &VelX_[0];
+    f32* VelY = &VelY_[0];
+    f32* VelZ = &VelZ_[0];
+    f32* Age  = &Age_[0];
+    
+    const dim::vector3df Accel(Desc_.Gravity * DeltaTime);
+    
+    u32 i = First;
+    
+    #ifdef SP_PARTICLE_SIMD
+    
+    /* Process four particles at once */
+    const __m128 vDeltaTime = _mm_set1_ps(DeltaTime);
+    const __m128 vAccelX    = _mm_set1_ps(Accel.X);
+    const __m128 vAccelY    = _mm_set1_ps(Accel.Y);
+    const __m128 vAccelZ    = _mm_set1_ps(Accel.Z);
+    
+    for (; i + 4 <= Last; i += 4)
+    {
+        const __m128 vVelX = _mm_add_ps(_mm_loadu_ps(VelX + i), vAccelX);
+        const __m128 vVelY = _mm_add_ps(_mm_loadu_ps(VelY + i), vAccelY);
+        const __m128 vVelZ = _mm_add_ps(_mm_loadu_ps(VelZ + i), vAccelZ);
+        
+        _mm_storeu_ps(VelX + i, vVelX);
+        _mm_storeu_ps(VelY + i, vVelY);
+        _mm_storeu_ps(VelZ + i, vVelZ);
+        
+        _mm_storeu_ps(PosX + i, _mm_add_ps(_mm_loadu_ps(PosX + i), _mm_mul_ps(vVelX, vDeltaTime)));
+        _mm_storeu_ps(PosY + i, _mm_add_ps(_mm_loadu_ps(PosY + i), _mm_mul_ps(vVelY, vDeltaTime)));
+        _mm_storeu_ps(PosZ + i, _mm_add_ps(_mm_loadu_ps(PosZ + i), _mm_mul_ps(vVelZ, vDeltaTime)));
+        
+        _mm_storeu_ps(Age + i, _mm_add_ps(_mm_loadu_ps(Age + i), vDeltaTime));
+    }
+    
+    #endif
+    
+    /* Process the remaining particles */
+    for (; i < Last; ++i)
+    {
+        VelX[i] += Accel.X;
+        VelY[i] += Accel.Y;
+        VelZ[i] += Accel.Z;
+        
+        PosX[i] += VelX[i] * DeltaTime;
+        PosY[i] += VelY[i] * DeltaTime;
+        PosZ[i] += VelZ[i] * DeltaTime;
+        
+        Age[i] += DeltaTime;
+    }
+}
+
+void ParticleSystem::buildVertices(u32 First, u32 Last)
+{
+    SParticleVertex* Vert = reinterpret_cast<SParticleVertex*>(Surface_->getVertexBuffer().getArray()) + First*NumQuadVertices_;
+    
+    const f32 SizeDiff = Desc_.EndSize - Desc_.StartSize;
+    
+    for (u32 i = First; i < Last; ++i, Vert += NumQuadVertices_)
+    {
+        /* Interpolate size and color over the life time */
+        const f32 t = math::MinMax(Age_[i] / LifeTime_[i], 0.0f, 1.0f);
+        
+        const f32 Size = Desc_.StartSize + SizeDiff * t;
+        
+        const f32 RX = ViewRight_.X * Size, RY = ViewRight_.Y * Size, RZ = ViewRight_.Z * Size;
+        const f32 UX = ViewUp_.X    * Size, UY = ViewUp_.Y    * Size, UZ = ViewUp_.Z    * Size;
+        
+        const f32 X = PosX_[i], Y = PosY_[i], Z = PosZ_[i];
+        
+        const u32 Color = getColor(t);
+        
+        /* Write the four corners in quad order */
+        Vert[0].Coord.X = X - RX - UX; Vert[0].Coord.Y = Y - RY - UY; Vert[0].Coord.Z = Z - RZ - UZ;
+        Vert[1].Coord.X = X - RX + UX; Vert[1].Coord.Y = Y - RY + UY; Vert[1].Coord.Z = Z - RZ + UZ;
+        Vert[2].Coord.X = X + RX + UX; Vert[2].Coord.Y = Y + RY + UY; Vert[2].Coord.Z = Z + RZ + UZ;
+        Vert[3].Coord.X = X + RX - UX; Vert[3].Coord.Y = Y + RY - UY; Vert[3].Coord.Z = Z + RZ - UZ;
+        
+        Vert[0].TexCoord.X = 0.0f; Vert[0].TexCoord.Y = 1.0f;
+        Vert[1].TexCoord.X = 0.0f; Vert[1].TexCoord.Y = 0.0f;
+        Vert[2].TexCoord.X = 1.0f; Vert[2].TexCoord.Y = 0.0f;
+        Vert[3].TexCoord.X = 1.0f; Vert[3].TexCoord.Y = 1.0f;
+        
+        Vert[0].Color = Vert[1].Color = Vert[2].Color = Vert[3].Color = Color;
+        
+        /* Split the quad into two triangles if quads are not supported */
+        if (NumQuadVertices_ == 6)
+        {
+            Vert[4] = Vert[0];
+            Vert[5] = Vert[2];
+        }
+    }
+}
+
+u32 ParticleSystem::getColor(f32 Interpolation) const
+{
+    const video::color Color(
+        static_cast<u8>(Desc_.StartColor.Red   + (static_cast<f32>(Desc_.EndColor.Red  ) - Desc_.StartColor.Red  ) * Interpolation),
+        static_cast<u8>(Desc_.StartColor.Green + (static_cast<f32>(Desc_.EndColor.Green) - Desc_.StartColor.Green) * Interpolation),
+        static_cast<u8>(Desc_.StartColor.Blue  + (static_cast<f32>(Desc_.EndColor.Blue ) - Desc_.StartColor.Blue ) * Interpolation),
+        static_cast<u8>(Desc_.StartColor.Alpha + (static_cast<f32>(Desc_.EndColor.Alpha) - Desc_.StartColor.Alpha) * Interpolation)
+    );
+    
+    if (isColorARGB_)
+        return Color.getSingle();
+    
+    u32 Value;
+    memcpy(&Value, &Color.Red, sizeof(u32));
+    return Value;
+}
+
+
+} // /namespace tool
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
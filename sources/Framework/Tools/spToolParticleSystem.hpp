@@ -0,0 +1,224 @@
+/*
+ * Particle system header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_TOOL_PARTICLESYSTEM_H__
+#define __SP_TOOL_PARTICLESYSTEM_H__
+
+
+#include "Base/spStandard.hpp"
+
+#ifdef SP_COMPILE_WITH_PARTICLEANIMATOR
+
+
+#include "Base/spMeshBuffer.hpp"
+#include "Base/spThreadPool.hpp"
+#include "SceneGraph/spMaterialNode.hpp"
+
+#include <vector>
+
+
+namespace sp
+{
+namespace video
+{
+    class VertexFormatUniversal;
+}
+namespace tool
+{
+
+
+//! Particle system description. \see ParticleSystem
+struct SP_EXPORT SParticleSystemDesc
+{
+    SParticleSystemDesc() :
+        Capacity        (10000                      ),
+        EmissionRate    (100.0f                     ),
+        MinLifeTime     (1.0f                       ),
+        MaxLifeTime     (2.0f                       ),
+        Velocity        (0.0f, 1.0f, 0.0f           ),
+        VelocitySpread  (0.25f                      ),
+        StartSize       (0.1f                       ),
+        EndSize         (0.1f                       ),
+        StartColor      (255                        ),
+        EndColor        (255, 255, 255, 0           )
+    {
+    }
+    ~SParticleSystemDesc()
+    {
+    }
+    
+    /* Members */
+    u32 Capacity;                   //!< Maximal count of particles. The particle pool is allocated only once. By default 10000.
+    f32 EmissionRate;               //!< Count of particles which are emitted per second. By default 100.
+    f32 MinLifeTime;                //!< Minimal particle life time (in seconds). By default 1.0.
+    f32 MaxLifeTime;                //!< Maximal particle life time (in seconds). By default 2.0.
+    dim::vector3df PositionSpread;  //!< Half size of the box around the emitter's global position in which particles are emitted. By default (0, 0, 0).
+    dim::vector3df Velocity;        //!< Initial particle velocity (in units per second). By default (0, 1, 0).
+    dim::vector3df VelocitySpread;  //!< Maximal random deviation of the initial velocity. By default (0.25, 0.25, 0.25).
+    dim::vector3df Gravity;         //!< Constant acceleration (in units per second squared). By default (0, 0, 0).
+    f32 StartSize;                  //!< Particle size at emission. By default 0.1.
+    f32 EndSize;                    //!< Particle size at the end of its life time. By default 0.1.
+    video::color StartColor;        //!< Particle color at emission. By default opaque white.
+    video::color EndColor;          //!< Particle color at the end of its life time. By default transparent white.
+};
+
+
+/**
+ParticleSystem is a data-oriented replacement for the ParticleAnimator. All particles of one emitter are stored
+in a fixed-capacity pool of flat arrays (structure of arrays) instead of one Billboard scene node per particle.
+The simulation and the vertex generation are processed in batches (optionally by several threads) and all particles
+are drawn with a single dynamic mesh buffer, i.e. with one draw call per emitter.
+\note The particles are simulated in global space. Moving the emitter node only moves the position where new particles are emitted.
+\see SParticleSystemDesc
+\since Version 3.3
+*/
+class SP_EXPORT ParticleSystem : public scene::MaterialNode
+{
+    
+    public:
+        
+        ParticleSystem(const SParticleSystemDesc &Desc = SParticleSystemDesc());
+        virtual ~ParticleSystem();
+        
+        /* === Functions === */
+        
+        //! Builds the camera facing particle quads and draws them with one draw call.
+        virtual void render();
+        
+        /**
+        Emits new particles by the emission rate and moves all particles.
+        Particles which exceeded their life time are removed.
+        \param DeltaTime: Specifies the elapsed time (in seconds) since the last update.
+        */
+        void update(f32 DeltaTime);
+        
+        /**
+        Emits the specified count of particles immediately.
+        \return Count of emitted particles. This can be less than "Count" when the pool is full.
+        */
+        u32 emit(u32 Count);
+        
+        //! Removes all particles.
+        void clear();
+        
+        /**
+        Sets the new particle system description. If the capacity changes all particles are removed.
+        \see SParticleSystemDesc
+        */
+        void setDesc(const SParticleSystemDesc &Desc);
+        
+        //! Sets the particle texture. Pass null to disable texturing.
+        void setTexture(video::Texture* Tex);
+        //! Returns the particle texture or null if no texture is used.
+        video::Texture* getTexture() const;
+        
+        /* === Inline functions === */
+        
+        //! Returns the particle system description.
+        inline const SParticleSystemDesc& getDesc() const
+        {
+            return Desc_;
+        }
+        
+        //! Returns the count of living particles.
+        inline u32 getNumParticles() const
+        {
+            return NumParticles_;
+        }
+        
+        /**
+        Sets the count of threads which simulate the particles and build the vertices. By default 1.
+        Additional threads are only used when there are enough particles. They are taken from the shared thread pool.
+        \see ThreadPool::getShared
+        */
+        inline void setThreadCount(u32 Count)
+        {
+            ThreadCount_ = math::Max(1u, Count);
+        }
+        inline u32 getThreadCount() const
+        {
+            return ThreadCount_;
+        }
+        
+        //! Returns the dynamic mesh buffer which holds the particle vertices.
+        inline const video::MeshBuffer* getMeshBuffer() const
+        {
+            return Surface_;
+        }
+        
+    private:
+        
+        friend void ParticleSystemTaskProc(u32 Index, void* UserData);
+        
+        /* === Enumerations === */
+        
+        enum EParticleTasks
+        {
+            TASK_SIMULATE,
+            TASK_BUILD_VERTICES,
+        };
+        
+        /* === Structures === */
+        
+        //! Vertex layout of the particle mesh buffer (24 bytes).
+        struct SParticleVertex
+        {
+            dim::vector3df Coord;
+            u32 Color;
+            dim::point2df TexCoord;
+        };
+        
+        /* === Functions === */
+        
+        void allocatePool();
+        void removeDeadParticles();
+        
+        void runTask(const EParticleTasks Task, f32 DeltaTime);
+        void processTask(const EParticleTasks Task, u32 First, u32 Last, f32 DeltaTime);
+        
+        void simulate(u32 First, u32 Last, f32 DeltaTime);
+        void buildVertices(u32 First, u32 Last);
+        
+        u32 getColor(f32 Interpolation) const;
+        
+        /* === Members === */
+        
+        SParticleSystemDesc Desc_;
+        
+        /* Particle pool (structure of arrays) */
+        std::vector<f32> PosX_, PosY_, PosZ_;
+        std::vector<f32> VelX_, VelY_, VelZ_;
+        std::vector<f32> Age_, LifeTime_;
+        
+        u32 NumParticles_;
+        f32 EmissionCounter_;
+        
+        u32 ThreadCount_;
+        
+        /* Rendering */
+        video::VertexFormatUniversal* VertexFormat_;
+        video::MeshBuffer* Surface_;
+        
+        dim::vector3df ViewRight_, ViewUp_;
+        u32 NumQuadVertices_;
+        bool isColorARGB_;
+        
+};
+
+
+} // /namespace tool
+
+} // /namespace sp
+
+
+#endif
+
+#endif
+
+
+
+// ================================================================================
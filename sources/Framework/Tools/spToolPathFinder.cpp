@@ -6,13 +6,16 @@
  */
 
 #include "Framework/Tools/spToolPathFinder.hpp"
+#include "Framework/Tools/spToolPathFlowField.hpp"
 
 #ifdef SP_COMPILE_WITH_PATHFINDER
 
 
 #include "Base/spMemoryManagement.hpp"
+#include "Base/spThreadPool.hpp"
 
 #include <boost/foreach.hpp>
+#include <algorithm>
 
 
 namespace sp
@@ -21,23 +24,52 @@ namespace tool
 {
 
 
+/*
+ * Internal structures
+ */
+
+struct SNearestNodesTaskData
+{
+    const PathGraph* Graph;
+    const std::vector<dim::vector3df>* Positions;
+    const std::vector< std::pair<dim::vector3di, u32> >* Order;
+    std::vector<PathNode*>* Nodes;
+    u32 NumTasks;
+};
+
+static void NearestNodesTaskProc(u32 Index, void* UserData)
+{
+    SNearestNodesTaskData* TaskData = reinterpret_cast<SNearestNodesTaskData*>(UserData);
+    
+    const std::vector< std::pair<dim::vector3di, u32> >& Order = *TaskData->Order;
+    
+    const u32 Count = Order.size();
+    const u32 First = Index * Count / TaskData->NumTasks;
+    const u32 Last  = (Index + 1) * Count / TaskData->NumTasks;
+    
+    for (u32 i = First; i < Last; ++i)
+    {
+        const u32 PosIndex = Order[i].second;
+        (*TaskData->Nodes)[PosIndex] = TaskData->Graph->findNearestNode((*TaskData->Positions)[PosIndex]);
+    }
+}
+
+
 /*
  * PathNode class
  */
 
 PathNode::PathNode() :
-    BaseObject      (   ),
-    WayCosts_       (0  ),
-    DirectDistance_ (0  ),
-    Predecessor_    (0  )
+    BaseObject  (   ),
+    Graph_      (0  ),
+    Index_      (0  )
 {
 }
 PathNode::PathNode(const dim::vector3df &Position, void* Data) :
-    BaseObject      (           ),
-    Position_       (Position   ),
-    WayCosts_       (0          ),
-    DirectDistance_ (0          ),
-    Predecessor_    (0          )
+    BaseObject  (           ),
+    Position_   (Position   ),
+    Graph_      (0          ),
+    Index_      (0          )
 {
     setUserData(Data);
 }
@@ -47,10 +79,18 @@ PathNode::~PathNode()
 
 void PathNode::setPosition(const dim::vector3df &Position)
 {
+    const dim::vector3df PrevPosition(Position_);
+    
     Position_ = Position;
     
     foreach (PathEdge* Edge, Edges_)
         Edge->updateNodePosition(this);
+    
+    if (Graph_)
+    {
+        Graph_->moveIndexNode(this, PrevPosition);
+        ++Graph_->Revision_;
+    }
 }
 
 std::list<PathNode*> PathNode::getNeighbors() const
@@ -147,18 +187,44 @@ void PathEdge::updateNodePosition(PathNode* Node)
 }
 
 
+/*
+ * PathQuery class
+ */
+
+PathQuery::PathQuery() :
+    NumExpandedNodes_   (0      ),
+    isSolved_           (false  )
+{
+}
+PathQuery::~PathQuery()
+{
+}
+
+void PathQuery::begin(u32 NumNodes)
+{
+    Search_.begin(NumNodes);
+    
+    NumExpandedNodes_   = 0;
+    isSolved_           = false;
+}
+
+
 /*
  * PathFinder class
  */
 
 PathGraph::PathGraph() :
-    StartNode_  (0      ),
-    TargetNode_ (0      ),
-    isSolved_   (false  )
+    IndexCellSize_          (1.0f   ),
+    FlowFieldCacheSize_     (8      ),
+    FlowFieldThreadCount_   (1      ),
+    FlowFieldUseCounter_    (0      ),
+    Revision_               (0      ),
+    isSolved_               (false  )
 {
 }
 PathGraph::~PathGraph()
 {
+    clearFlowFields();
     MemoryManager::deleteList(NodeList_);
     MemoryManager::deleteList(EdgeList_);
 }
@@ -166,7 +232,15 @@ PathGraph::~PathGraph()
 PathNode* PathGraph::addNode(const dim::vector3df &Position, void* Data)
 {
     PathNode* NewNode = new PathNode(Position, Data);
+    
+    NewNode->Graph_ = this;
+    NewNode->Index_ = NodeList_.size();
+    
     NodeList_.push_back(NewNode);
+    insertIndexNode(NewNode);
+    
+    ++Revision_;
+    
     return NewNode;
 }
 void PathGraph::removeNode(PathNode* Node)
@@ -187,13 +261,25 @@ void PathGraph::removeNode(PathNode* Node)
     }
     
     /* Remove the node */
-    MemoryManager::removeElement(NodeList_, Node, true);
+    if (Node && Node->Graph_ == this)
+    {
+        removeIndexNode(Node, Node->getPosition());
+        removeFlowField(Node);
+    }
+    
+    if (MemoryManager::removeElement(NodeList_, Node, true))
+        updateNodeIndices();
+    
+    ++Revision_;
 }
 
 void PathGraph::clearNodeList()
 {
+    clearFlowFields();
     MemoryManager::deleteList(NodeList_);
     MemoryManager::deleteList(EdgeList_);
+    IndexCells_.clear();
+    ++Revision_;
 }
 
 PathEdge* PathGraph::addEdge(PathNode* From, PathNode* To, bool Adjusted)
@@ -202,6 +288,7 @@ PathEdge* PathGraph::addEdge(PathNode* From, PathNode* To, bool Adjusted)
     {
         PathEdge* NewEdge = new PathEdge(From, To, Adjusted);
         EdgeList_.push_back(NewEdge);
+        ++Revision_;
         return NewEdge;
     }
     return 0;
@@ -209,11 +296,13 @@ PathEdge* PathGraph::addEdge(PathNode* From, PathNode* To, bool Adjusted)
 void PathGraph::removeEdge(PathEdge* Edge)
 {
     MemoryManager::removeElement(EdgeList_, Edge);
+    ++Revision_;
 }
 
 void PathGraph::clearEdgeList()
 {
     MemoryManager::deleteList(EdgeList_);
+    ++Revision_;
 }
 
 void PathGraph::createGrid(
@@ -300,76 +389,255 @@ std::list<PathNode*> PathGraph::findPath(PathNode* From, PathNode* To)
 
 bool PathGraph::findPath(PathNode* From, PathNode* To, std::list<PathNode*> &Path)
 {
-    /* Check parameter validity */
-    if (!From || !To)
-        return false;
-    if (From == To)
+    isSolved_ = findPath(Query_, From, To, Path);
+    return isSolved_;
+}
+
+std::list<PathNode*> PathGraph::findPath(const dim::vector3df &From, const dim::vector3df &To)
+{
+    std::list<PathNode*> Path;
+    findPath(From, To, Path);
+    return Path;
+}
+
+bool PathGraph::findPath(const dim::vector3df &From, const dim::vector3df &To, std::list<PathNode*> &Path)
+{
+    return findPath(findNearestNode(From), findNearestNode(To), Path);
+}
+
+PathNode* PathGraph::findNearestNode(const dim::vector3df &Position) const
+{
+    if (IndexCells_.empty())
+        return 0;
+    
+    const dim::vector3di Center(getIndexCell(Position));
+    
+    PathNode* Nearest = 0;
+    f32 NearestDistSq = 0.0f;
+    
+    /* Maximal ring radius which can still contain any index cell */
+    const s32 MaxRadius = math::Max(
+        math::Max(math::Abs(Center.X - IndexMin_.X), math::Abs(Center.X - IndexMax_.X)),
+        math::Max(math::Abs(Center.Y - IndexMin_.Y), math::Abs(Center.Y - IndexMax_.Y)),
+        math::Max(math::Abs(Center.Z - IndexMin_.Z), math::Abs(Center.Z - IndexMax_.Z))
+    );
+    
+    /* Search the cells in growing rings (cube shells) around the center cell */
+    dim::vector3di Cell;
+    
+    for (s32 Radius = 0; Radius <= MaxRadius; ++Radius)
     {
-        Path.push_back(From);
-        return true;
+        const dim::vector3di Min(
+            math::Max(Center.X - Radius, IndexMin_.X), math::Max(Center.Y - Radius, IndexMin_.Y), math::Max(Center.Z - Radius, IndexMin_.Z)
+        );
+        const dim::vector3di Max(
+            math::Min(Center.X + Radius, IndexMax_.X), math::Min(Center.Y + Radius, IndexMax_.Y), math::Min(Center.Z + Radius, IndexMax_.Z)
+        );
+        
+        for (Cell.Z = Min.Z; Cell.Z <= Max.Z; ++Cell.Z)
+        {
+            for (Cell.Y = Min.Y; Cell.Y <= Max.Y; ++Cell.Y)
+            {
+                const bool InnerRow = (math::Abs(Cell.Z - Center.Z) < Radius && math::Abs(Cell.Y - Center.Y) < Radius);
+                
+                for (Cell.X = Min.X; Cell.X <= Max.X; ++Cell.X)
+                {
+                    /* Only visit the shell of the current ring */
+                    if (InnerRow && math::Abs(Cell.X - Center.X) < Radius)
+                    {
+                        Cell.X = Center.X + Radius - 1;
+                        continue;
+                    }
+                    searchIndexCell(Cell, Position, Nearest, NearestDistSq);
+                }
+            }
+        }
+        
+        /*
+        Each node in the next ring is at least "Radius" cells away from the position,
+        so the search is finished when a node has been found which is nearer than that.
+        */
+        if (Nearest)
+        {
+            const f32 RingDist = static_cast<f32>(Radius) * IndexCellSize_;
+            if (NearestDistSq <= RingDist*RingDist)
+                break;
+        }
     }
     
-    /* Initialization */
-    StartNode_  = From;
-    TargetNode_ = To;
+    return Nearest;
+}
+
+void PathGraph::findNearestNodes(const std::vector<dim::vector3df> &Positions, std::vector<PathNode*> &Nodes) const
+{
+    const u32 Count = Positions.size();
     
-    isSolved_ = false;
+    Nodes.resize(Count);
     
-    /* Add the first node to the queue list */
-    addNodeToQueue(StartNode_, 0, 0);
+    /* Sort the positions by their index cells, so each task gets a compact region of the grid */
+    std::vector< std::pair<dim::vector3di, u32> > Order(Count);
     
-    /* Process next step while searching the optimal path in the graph */
-    while (nextStep());
+    for (u32 i = 0; i < Count; ++i)
+        Order[i] = std::make_pair(getIndexCell(Positions[i]), i);
     
-    /* Reset the storage */
-    NodeQueue_.clear();
-    ClosedMap_.clear();
+    std::sort(Order.begin(), Order.end());
     
-    if (!isSolved_)
-        return false;
+    /* Search the nodes on the shared thread pool (the index is only read) */
+    SNearestNodesTaskData TaskData;
+    {
+        TaskData.Graph      = this;
+        TaskData.Positions  = (&Positions);
+        TaskData.Order      = (&Order);
+        TaskData.Nodes      = (&Nodes);
+        TaskData.NumTasks   = math::MinMax(ThreadPool::getShared()->getThreadCount() + 1, 1u, Count / 256 + 1);
+    }
+    
+    if (TaskData.NumTasks > 1)
+        ThreadPool::getShared()->run(NearestNodesTaskProc, &TaskData, TaskData.NumTasks);
+    else
+        NearestNodesTaskProc(0, &TaskData);
+}
+
+const PathFlowField* PathGraph::getFlowField(PathNode* Goal)
+{
+    if (!Goal || Goal->Graph_ != this)
+        return 0;
     
-    /* Build the path */
-    constructPath(Path, TargetNode_);
+    PathFlowField* Field = 0;
     
-    return true;
+    FlowFieldMap::iterator it = FlowFields_.find(Goal);
+    
+    if (it != FlowFields_.end())
+    {
+        Field = it->second;
+        
+        /* Rebuild the field if the graph has been modified */
+        if (!Field->valid())
+            Field->build(this, Goal, FlowFieldThreadCount_);
+    }
+    else
+    {
+        /* Make room for the new field */
+        while (FlowFields_.size() >= FlowFieldCacheSize_)
+            removeLeastRecentFlowField();
+        
+        Field = new PathFlowField();
+        Field->build(this, Goal, FlowFieldThreadCount_);
+        
+        FlowFields_[Goal] = Field;
+    }
+    
+    Field->LastUse_ = ++FlowFieldUseCounter_;
+    
+    return Field;
 }
 
-std::list<PathNode*> PathGraph::findPath(const dim::vector3df &From, const dim::vector3df &To)
+void PathGraph::setFlowFieldCacheSize(u32 Size)
 {
-    std::list<PathNode*> Path;
-    findPath(From, To, Path);
-    return Path;
+    FlowFieldCacheSize_ = math::Max(1u, Size);
+    
+    while (FlowFields_.size() > FlowFieldCacheSize_)
+        removeLeastRecentFlowField();
 }
 
-bool PathGraph::findPath(const dim::vector3df &From, const dim::vector3df &To, std::list<PathNode*> &Path)
+void PathGraph::clearFlowFields()
 {
-    PathNode* FromNode = 0, *ToNode = 0;
+    for (FlowFieldMap::iterator it = FlowFields_.begin(); it != FlowFields_.end(); ++it)
+        delete it->second;
+    FlowFields_.clear();
+}
+
+void PathGraph::setIndexCellSize(f32 Size)
+{
+    if (Size <= 0.0f || Size == IndexCellSize_)
+        return;
+    
+    IndexCellSize_ = Size;
     
-    f32 DistSq;
-    f32 DistFrom = 999999.f, DistTo = 999999.f;
+    /* Rebuild the whole index */
+    IndexCells_.clear();
     
     foreach (PathNode* Node, NodeList_)
+        insertIndexNode(Node);
+}
+
+
+bool PathGraph::findPath(PathQuery &Query, PathNode* From, PathNode* To, std::list<PathNode*> &Path) const
+{
+    /* Check parameter validity */
+    if (!From || !To)
+        return false;
+    if (From == To)
     {
-        /* Check distance for start node */
-        DistSq = math::getDistanceSq(From, Node->getPosition());
-        
-        if (DistSq < DistFrom)
+        Path.push_back(From);
+        return true;
+    }
+    
+    /* Initialization */
+    Query.begin(NodeList_.size());
+    
+    const dim::vector3df TargetPos(To->getPosition());
+    
+    PathQuery::SNodeState& StartState = Query.Search_.visit(From);
+    
+    StartState.WayCosts         = 0.0f;
+    StartState.EstimatedCosts   = math::getDistance(From->getPosition(), TargetPos);
+    StartState.Predecessor      = 0;
+    
+    Query.Search_.pushOpen(From);
+    
+    /* Expand the node with the lowest estimated costs until the target node has been reached */
+    PathNode* CurNode = 0;
+    
+    while (Query.Search_.popOpen(CurNode))
+    {
+        if (CurNode == To)
         {
-            DistFrom = DistSq;
-            FromNode = Node;
+            Query.isSolved_ = true;
+            break;
         }
         
-        /* Check distance for end node */
-        DistSq = math::getDistanceSq(To, Node->getPosition());
+        ++Query.NumExpandedNodes_;
+        
+        const f32 CurWayCosts = Query.Search_.getState(CurNode).WayCosts;
         
-        if (DistSq < DistTo)
+        for (std::list<PathNode::SNeighbor>::const_iterator it = CurNode->Neighbors_.begin(); it != CurNode->Neighbors_.end(); ++it)
         {
-            DistTo = DistSq;
-            ToNode = Node;
+            const f32 WayCosts = CurWayCosts + it->Distance;
+            
+            PathQuery::SNodeState* State = Query.Search_.getVisitedState(it->Node);
+            
+            if (!State)
+            {
+                /* Add the new node to the open list */
+                PathQuery::SNodeState& NewState = Query.Search_.visit(it->Node);
+                
+                NewState.WayCosts       = WayCosts;
+                NewState.EstimatedCosts = WayCosts + math::getDistance(it->Node->getPosition(), TargetPos);
+                NewState.Predecessor    = CurNode;
+                
+                Query.Search_.pushOpen(it->Node);
+            }
+            else if (State->isOpen() && WayCosts < State->WayCosts)
+            {
+                /* Found a shorter way to a node in the open list */
+                State->EstimatedCosts   += WayCosts - State->WayCosts;
+                State->WayCosts         = WayCosts;
+                State->Predecessor      = CurNode;
+                
+                Query.Search_.updateOpen(it->Node);
+            }
         }
     }
     
-    return findPath(FromNode, ToNode, Path);
+    if (!Query.isSolved_)
+        return false;
+    
+    /* Build the path from the target node back to the start node */
+    for (PathNode* Node = To; Node; Node = Query.Search_.getState(Node).Predecessor)
+        Path.push_back(Node);
+    
+    return true;
 }
 
 
@@ -377,102 +645,160 @@ bool PathGraph::findPath(const dim::vector3df &From, const dim::vector3df &To, s
  * ======= Protected: =======
  */
 
-bool PathGraph::nextStep()
+void PathGraph::updateNodeIndices()
 {
-    /* Get the next accessable node */
-    PathNode* CurNode = getNextNode();
-    
-    /* Check if no path has been found */
-    if (!CurNode)
-        return false;
+    u32 Index = 0;
+    foreach (PathNode* Node, NodeList_)
+        Node->Index_ = Index++;
+}
+
+void PathGraph::insertIndexNode(PathNode* Node)
+{
+    const dim::vector3di Cell(getIndexCell(Node->getPosition()));
     
-    /* Check if path has been found */
-    if (CurNode == TargetNode_)
+    /* Update the bounding box of all index cells */
+    if (IndexCells_.empty())
+        IndexMin_ = IndexMax_ = Cell;
+    else
     {
-        isSolved_ = true;
-        return false;
+        math::decrease(IndexMin_.X, Cell.X);
+        math::decrease(IndexMin_.Y, Cell.Y);
+        math::decrease(IndexMin_.Z, Cell.Z);
+        
+        math::increase(IndexMax_.X, Cell.X);
+        math::increase(IndexMax_.Y, Cell.Y);
+        math::increase(IndexMax_.Z, Cell.Z);
     }
     
-    /* Add the neighbors to the queue */
-    for (std::list<PathNode::SNeighbor>::iterator it = CurNode->Neighbors_.begin(); it != CurNode->Neighbors_.end(); ++it)
-        addNodeToQueue(it->Node, CurNode, CurNode->WayCosts_ + it->Distance);
-    
-    return true;
+    IndexCells_[Cell].push_back(Node);
 }
 
-PathNode* PathGraph::getNextNode()
+void PathGraph::removeIndexNode(PathNode* Node, const dim::vector3df &Position)
 {
-    if (NodeQueue_.empty())
-        return 0;
+    const dim::vector3di Cell(getIndexCell(Position));
+    
+    IndexCellMap::iterator it = IndexCells_.find(Cell);
+    
+    if (it == IndexCells_.end())
+        return;
     
-    /* Search the optimal next node */
-    f32 Dist = 999999.f, CurDist;
-    std::list<PathNode*>::iterator itLast = NodeQueue_.begin();
+    std::vector<PathNode*>& CellNodes = it->second;
     
-    for (std::list<PathNode*>::iterator it = NodeQueue_.begin(); it != NodeQueue_.end(); ++it)
+    for (u32 i = 0; i < CellNodes.size(); ++i)
     {
-        CurDist = (*it)->getMinWayCosts();
-        
-        if (CurDist < Dist)
+        if (CellNodes[i] == Node)
         {
-            Dist    = CurDist;
-            itLast  = it;
+            /* Swap with the last entry, because the order does not matter */
+            CellNodes[i] = CellNodes.back();
+            CellNodes.pop_back();
+            break;
         }
     }
     
-    /* Return the next node and remove it from the queue */
-    PathNode* NextNode = *itLast;
-    NodeQueue_.erase(itLast);
-    
-    return NextNode;
+    if (CellNodes.empty())
+    {
+        IndexCells_.erase(it);
+        
+        /* Shrink the bounding box when a cell on its border has been removed */
+        if ( Cell.X == IndexMin_.X || Cell.Y == IndexMin_.Y || Cell.Z == IndexMin_.Z ||
+             Cell.X == IndexMax_.X || Cell.Y == IndexMax_.Y || Cell.Z == IndexMax_.Z )
+        {
+            updateIndexBounds();
+        }
+    }
 }
 
-void PathGraph::addNodeToQueue(PathNode* Node, PathNode* Predecessor, const f32 WayCosts)
+void PathGraph::updateIndexBounds()
 {
-    /* Check if the node is already in the closed list */
-    std::map<PathNode*, bool>::iterator itMap = ClosedMap_.find(Node);
+    if (IndexCells_.empty())
+        return;
     
-    if (itMap == ClosedMap_.end())
+    IndexCellMap::const_iterator it = IndexCells_.begin();
+    
+    IndexMin_ = IndexMax_ = it->first;
+    
+    for (++it; it != IndexCells_.end(); ++it)
     {
-        /* Store the direct distance between the current node and the target node */
-        Node->DirectDistance_ = math::getDistance(Node->getPosition(), TargetNode_->getPosition());
+        math::decrease(IndexMin_.X, it->first.X);
+        math::decrease(IndexMin_.Y, it->first.Y);
+        math::decrease(IndexMin_.Z, it->first.Z);
         
-        /* Add the node to the queue and to the closed list */
-        NodeQueue_.push_back(Node);
-        ClosedMap_[Node] = true;
+        math::increase(IndexMax_.X, it->first.X);
+        math::increase(IndexMax_.Y, it->first.Y);
+        math::increase(IndexMax_.Z, it->first.Z);
     }
-    if (itMap == ClosedMap_.end() || WayCosts < Node->WayCosts_)
+}
+
+void PathGraph::moveIndexNode(PathNode* Node, const dim::vector3df &PrevPosition)
+{
+    if (getIndexCell(PrevPosition) != getIndexCell(Node->getPosition()))
     {
-        /* Setup information about this node */
-        Node->Predecessor_  = Predecessor;
-        Node->WayCosts_     = WayCosts;
+        removeIndexNode(Node, PrevPosition);
+        insertIndexNode(Node);
     }
 }
 
-void PathGraph::constructPath(std::list<PathNode*> &Path, PathNode* NextNode)
+dim::vector3di PathGraph::getIndexCell(const dim::vector3df &Position) const
 {
-    if (!NextNode)
-        return;
+    /*
+    Clamp the cell coordinates, so that far away (or invalid) positions don't overflow the integer conversion.
+    The limit is small enough that the distance between two cells still fits into 32 bits.
+    */
+    static const f32 MAX_CELL = static_cast<f32>(1 << 30);
     
-    /* Add the first node to the path */
-    Path.push_back(NextNode);
+    return dim::vector3di(
+        static_cast<s32>(math::MinMax(static_cast<f32>(floor(Position.X / IndexCellSize_)), -MAX_CELL, MAX_CELL)),
+        static_cast<s32>(math::MinMax(static_cast<f32>(floor(Position.Y / IndexCellSize_)), -MAX_CELL, MAX_CELL)),
+        static_cast<s32>(math::MinMax(static_cast<f32>(floor(Position.Z / IndexCellSize_)), -MAX_CELL, MAX_CELL))
+    );
+}
+
+void PathGraph::searchIndexCell(
+    const dim::vector3di &Cell, const dim::vector3df &Position, PathNode* &Nearest, f32 &NearestDistSq) const
+{
+    IndexCellMap::const_iterator it = IndexCells_.find(Cell);
     
-    /* Repeat the following process until the start node has reached */
-    do
+    if (it == IndexCells_.end())
+        return;
+    
+    for (std::vector<PathNode*>::const_iterator itNode = it->second.begin(); itNode != it->second.end(); ++itNode)
     {
-        /* Go to the next predecessor */
-        if (NextNode->Predecessor_)
-            NextNode = NextNode->Predecessor_;
-        else
+        const f32 DistSq = math::getDistanceSq(Position, (*itNode)->getPosition());
+        
+        if (!Nearest || DistSq < NearestDistSq)
         {
-            io::Log::error("Incomplete path while searching in graph");
-            break;
+            Nearest         = *itNode;
+            NearestDistSq   = DistSq;
         }
-        
-        /* Add the next node to the path */
-        Path.push_back(NextNode);
     }
-    while (NextNode != StartNode_);
+}
+
+void PathGraph::removeFlowField(const PathNode* Goal)
+{
+    FlowFieldMap::iterator it = FlowFields_.find(Goal);
+    
+    if (it != FlowFields_.end())
+    {
+        delete it->second;
+        FlowFields_.erase(it);
+    }
+}
+
+void PathGraph::removeLeastRecentFlowField()
+{
+    FlowFieldMap::iterator itOldest = FlowFields_.end();
+    
+    for (FlowFieldMap::iterator it = FlowFields_.begin(); it != FlowFields_.end(); ++it)
+    {
+        if (itOldest == FlowFields_.end() || it->second->LastUse_ < itOldest->second->LastUse_)
+            itOldest = it;
+    }
+    
+    if (itOldest != FlowFields_.end())
+    {
+        delete itOldest->second;
+        FlowFields_.erase(itOldest);
+    }
 }
 
 
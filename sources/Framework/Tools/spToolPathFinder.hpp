@@ -16,8 +16,10 @@
 
 #include "Base/spBaseObject.hpp"
 #include "Base/spDimension.hpp"
+#include "Framework/Tools/spToolPathSearchSpace.hpp"
 
 #include <list>
+#include <vector>
 #include <map>
 
 
@@ -28,6 +30,9 @@ namespace tool
 
 
 class PathEdge;
+class PathGraph;
+class PathQuery;
+class PathFlowField;
 
 /**
 Node class for a graph.
@@ -44,7 +49,10 @@ class SP_EXPORT PathNode : public BaseObject
         
         /* === Functions === */
         
-        //! Sets the position and updates all distances between this node and its neighbors.
+        /**
+        Sets the position and updates all distances between this node and its neighbors.
+        If the node is part of a graph, the graph's spatial node index is updated as well.
+        */
         void setPosition(const dim::vector3df &Position);
         
         //! Returns a list with all neighbors of this node.
@@ -64,10 +72,20 @@ class SP_EXPORT PathNode : public BaseObject
             return Edges_;
         }
         
+        /**
+        Returns the node's index inside its graph. This index is used by the PathQuery objects
+        to address their dense per-node arrays. It is only valid while the node is part of a graph.
+        */
+        inline u32 getIndex() const
+        {
+            return Index_;
+        }
+        
     private:
         
         friend class PathEdge;
         friend class PathGraph;
+        friend class PathFlowField;
         
         /* === Structures === */
         
@@ -87,28 +105,29 @@ class SP_EXPORT PathNode : public BaseObject
         void removeEdge(PathEdge* Edge);
         void updateNeighbors();
         
-        /* === Inline functions === */
-        
-        inline f32 getMinWayCosts() const
-        {
-            return WayCosts_ + DirectDistance_;
-        }
-        
         /* === Members === */
         
         dim::vector3df Position_;
         
-        f32 WayCosts_;
-        f32 DirectDistance_;
-        
         std::list<PathEdge*> Edges_;
         std::list<SNeighbor> Neighbors_;
         
-        PathNode* Predecessor_;
+        PathGraph* Graph_;
+        u32 Index_;
         
 };
 
 
+//! Path nodes are addressed by their index inside the graph. \see PathSearchSpace
+template <> struct SPathSearchIndex<PathNode*>
+{
+    static inline u32 get(const PathNode* Node)
+    {
+        return Node->getIndex();
+    }
+};
+
+
 /**
 Edge class for a graph (connects two path nodes).
 \ingroup group_pathfinding
@@ -167,6 +186,60 @@ class SP_EXPORT PathEdge : public BaseObject
 };
 
 
+/**
+PathQuery objects hold the whole state of a path search (open list, way costs, predecessors).
+A PathGraph is never modified by a search, so several threads can search paths in the same graph
+at once, as long as each thread uses its own PathQuery object. The internal arrays are only
+resized when the graph grows, thus a query object should be reused for many searches.
+\see PathGraph::findPath
+\ingroup group_pathfinding
+*/
+class SP_EXPORT PathQuery
+{
+    
+    public:
+        
+        PathQuery();
+        ~PathQuery();
+        
+        /* === Inline functions === */
+        
+        //! Returns true if the last path search with this query object has found a path.
+        inline bool foundPath() const
+        {
+            return isSolved_;
+        }
+        
+        //! Returns the count of nodes which have been expanded during the last path search.
+        inline u32 getNumExpandedNodes() const
+        {
+            return NumExpandedNodes_;
+        }
+        
+    private:
+        
+        friend class PathGraph;
+        
+        /* === Types === */
+        
+        typedef PathSearchSpace<PathNode*> SSearchSpace;
+        typedef SSearchSpace::SNodeState SNodeState;
+        
+        /* === Functions === */
+        
+        void begin(u32 NumNodes);
+        
+        /* === Members === */
+        
+        SSearchSpace Search_;
+        
+        u32 NumExpandedNodes_;
+        
+        bool isSolved_;
+        
+};
+
+
 /**
 PathGraph objects represent a graph for path finding. The "A* Algorithm" is used for fast path finding.
 \ingroup group_pathfinding
@@ -249,6 +322,64 @@ class SP_EXPORT PathGraph
         //! Uses the other "findPath" function but uses the nearest PathNode objects from the specified global positions .
         virtual bool findPath(const dim::vector3df &From, const dim::vector3df &To, std::list<PathNode*> &Path);
         
+        /**
+        Returns the node which is nearest to the specified global position.
+        The nodes are stored in a uniform grid (the spatial node index), so only
+        the nodes in the grid cells around the specified position are checked.
+        \return Pointer to the nearest PathNode object or null if the graph has no nodes.
+        \see setIndexCellSize
+        */
+        PathNode* findNearestNode(const dim::vector3df &Position) const;
+        
+        /**
+        Searches the nearest node for each of the specified positions, e.g. to snap many agent positions at once.
+        The positions are sorted by their grid cells and split into contiguous ranges which are searched
+        on the shared thread pool (see ThreadPool::getShared), so each thread works on a compact region of the grid.
+        \param Positions: Specifies the global positions.
+        \param Nodes: Receives the nearest node for each position (in the same order as the positions).
+        This array will be resized to the count of positions.
+        */
+        void findNearestNodes(const std::vector<dim::vector3df> &Positions, std::vector<PathNode*> &Nodes) const;
+        
+        /**
+        Sets the cell size of the spatial node index. This should be about the distance between two neighbor nodes.
+        Too small cells make the search for isolated nodes slow, too large cells contain too many nodes. By default 1.0.
+        \note This rebuilds the whole index.
+        */
+        void setIndexCellSize(f32 Size);
+        
+        /**
+        Trys to find a path from the specified start node to the target node through this path graph.
+        This function does not modify the graph, i.e. it can be called from several threads at once
+        as long as each thread uses its own query object and the graph is not modified in the meantime.
+        \param Query: Specifies the query object which holds the whole search state.
+        \param From: Specifies the start PathNode object.
+        \param To: Specifies the target PathNode object.
+        \param Path: Specifies the resulting path. The nodes are stored from the target to the start node.
+        \return True if a path has been found. Otherwise false.
+        */
+        bool findPath(PathQuery &Query, PathNode* From, PathNode* To, std::list<PathNode*> &Path) const;
+        
+        /**
+        Returns the flow field for the specified goal node. Use this when many agents move to the same goal.
+        The fields of the recently used goals are cached and only rebuilt when the graph has been modified.
+        \param Goal: Specifies the goal node.
+        \return Pointer to the flow field or null if the goal node is not part of this graph.
+        The field is owned by the graph and must not be deleted. It can be used until the next call of this function.
+        \note This function is not thread-safe, but the returned field can be read by several threads at once.
+        \see PathFlowField
+        */
+        const PathFlowField* getFlowField(PathNode* Goal);
+        
+        /**
+        Sets the maximal count of cached flow fields. When a new field is required and the cache is full,
+        the least recently used field is deleted. The minimal size is 1. By default 8.
+        */
+        void setFlowFieldCacheSize(u32 Size);
+        
+        //! Deletes all cached flow fields.
+        void clearFlowFields();
+        
         /* === Inline functions === */
         
         //! Returns true if the last searched path has been found. Otherwise false and no path has been found.
@@ -268,26 +399,80 @@ class SP_EXPORT PathGraph
             return EdgeList_;
         }
         
+        //! Returns the cell size of the spatial node index. \see setIndexCellSize
+        inline f32 getIndexCellSize() const
+        {
+            return IndexCellSize_;
+        }
+        
+        /**
+        Returns the graph revision. It is incremented each time a node or edge is added,
+        removed or moved. This is used to detect when flow fields must be rebuilt.
+        */
+        inline u32 getRevision() const
+        {
+            return Revision_;
+        }
+        
+        //! Returns the maximal count of cached flow fields.
+        inline u32 getFlowFieldCacheSize() const
+        {
+            return FlowFieldCacheSize_;
+        }
+        
+        //! Sets the count of threads which are used to build flow fields. By default 1.
+        inline void setFlowFieldThreadCount(u32 ThreadCount)
+        {
+            FlowFieldThreadCount_ = math::Max(1u, ThreadCount);
+        }
+        //! Returns the count of threads which are used to build flow fields.
+        inline u32 getFlowFieldThreadCount() const
+        {
+            return FlowFieldThreadCount_;
+        }
+        
     protected:
         
+        friend class PathNode;
+        
+        /* Types */
+        
+        typedef std::map<dim::vector3di, std::vector<PathNode*> > IndexCellMap;
+        typedef std::map<const PathNode*, PathFlowField*> FlowFieldMap;
+        
         /* Functions */
         
-        bool nextStep();
+        void updateNodeIndices();
+        
+        void insertIndexNode(PathNode* Node);
+        void removeIndexNode(PathNode* Node, const dim::vector3df &Position);
+        void moveIndexNode(PathNode* Node, const dim::vector3df &PrevPosition);
+        void updateIndexBounds();
         
-        PathNode* getNextNode();
-        void addNodeToQueue(PathNode* Node, PathNode* Predecessor, const f32 WayCosts);
+        dim::vector3di getIndexCell(const dim::vector3df &Position) const;
         
-        void constructPath(std::list<PathNode*> &Path, PathNode* NextNode);
+        void searchIndexCell(const dim::vector3di &Cell, const dim::vector3df &Position, PathNode* &Nearest, f32 &NearestDistSq) const;
+        
+        void removeFlowField(const PathNode* Goal);
+        void removeLeastRecentFlowField();
         
         /* Members */
         
         std::list<PathNode*> NodeList_;
         std::list<PathEdge*> EdgeList_;
         
-        std::list<PathNode*> NodeQueue_;
-        std::map<PathNode*, bool> ClosedMap_;
+        PathQuery Query_;
+        
+        IndexCellMap IndexCells_;
+        f32 IndexCellSize_;
+        dim::vector3di IndexMin_, IndexMax_;  //!< Bounding box of all non-empty index cells.
+        
+        FlowFieldMap FlowFields_;
+        u32 FlowFieldCacheSize_;
+        u32 FlowFieldThreadCount_;
+        u32 FlowFieldUseCounter_;
         
-        PathNode* StartNode_, * TargetNode_;
+        u32 Revision_;
         
         bool isSolved_;
         
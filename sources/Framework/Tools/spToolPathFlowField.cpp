@@ -0,0 +1,313 @@
+/*
+ * Path flow field file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "Framework/Tools/spToolPathFlowField.hpp"
+
+#ifdef SP_COMPILE_WITH_PATHFINDER
+
+
+#include "Framework/Tools/spToolPathFinder.hpp"
+#include "Base/spThreadPool.hpp"
+
+#include <boost/foreach.hpp>
+#include <queue>
+#include <functional>
+
+
+namespace sp
+{
+namespace tool
+{
+
+
+/*
+ * Internal structures
+ */
+
+struct SFlowFieldTaskData
+{
+    PathFlowField* Field;
+    u32 NumNodes;
+    u32 NumTasks;
+};
+
+void FlowFieldTaskProc(u32 Index, void* UserData)
+{
+    SFlowFieldTaskData* TaskData = reinterpret_cast<SFlowFieldTaskData*>(UserData);
+    
+    TaskData->Field->buildNextNodes(
+        Index * TaskData->NumNodes / TaskData->NumTasks, (Index + 1) * TaskData->NumNodes / TaskData->NumTasks
+    );
+}
+
+
+/*
+ * PathFlowField class
+ */
+
+PathFlowField::PathFlowField() :
+    Graph_              (0),
+    Goal_               (0),
+    Revision_           (0),
+    NumReachableNodes_  (0),
+    LastUse_            (0)
+{
+}
+PathFlowField::~PathFlowField()
+{
+}
+
+bool PathFlowField::build(const PathGraph* Graph, PathNode* Goal, u32 ThreadCount)
+{
+    clear();
+    
+    if (!Graph || !Goal || Goal->Graph_ != Graph)
+        return false;
+    
+    Graph_      = Graph;
+    Goal_       = Goal;
+    Revision_   = Graph->getRevision();
+    
+    /* Build the compact adjacency lists and the integration field */
+    buildAdjacency();
+    buildIntegrationField(Goal->getIndex());
+    
+    /* Compute the next node for each node (optionally in several threads) */
+    const u32 NumNodes = Nodes_.size();
+    
+    NextNodes_.resize(NumNodes, 0);
+    
+    ThreadCount = math::MinMax(ThreadCount, 1u, NumNodes / 1024 + 1);
+    
+    if (ThreadCount > 1)
+    {
+        SFlowFieldTaskData TaskData;
+        {
+            TaskData.Field      = this;
+            TaskData.NumNodes   = NumNodes;
+            TaskData.NumTasks   = ThreadCount;
+        }
+        ThreadPool::getShared()->run(FlowFieldTaskProc, &TaskData, ThreadCount);
+    }
+    else
+        buildNextNodes(0, NumNodes);
+    
+    /* The adjacency lists are only required while building */
+    Forward_    = SAdjacency();
+    Backward_   = SAdjacency();
+    
+    return true;
+}
+
+void PathFlowField::clear()
+{
+    Graph_              = 0;
+    Goal_               = 0;
+    Revision_           = 0;
+    NumReachableNodes_  = 0;
+    
+    Nodes_.clear();
+    Costs_.clear();
+    NextNodes_.clear();
+}
+
+bool PathFlowField::valid() const
+{
+    return Graph_ && Graph_->getRevision() == Revision_;
+}
+
+PathNode* PathFlowField::getNextNode(const PathNode* Node) const
+{
+    return checkNode(Node) ? NextNodes_[Node->getIndex()] : 0;
+}
+
+dim::vector3df PathFlowField::getDirection(const PathNode* Node) const
+{
+    const PathNode* NextNode = getNextNode(Node);
+    
+    if (NextNode)
+        return (NextNode->getPosition() - Node->getPosition()).normalize();
+    
+    return 0.0f;
+}
+
+dim::vector3df PathFlowField::getDirection(const dim::vector3df &Position) const
+{
+    if (!Graph_)
+        return 0.0f;
+    
+    const PathNode* Node = Graph_->findNearestNode(Position);
+    
+    if (!checkNode(Node) || Costs_[Node->getIndex()] < 0.0f)
+        return 0.0f;
+    
+    /* Move to the nearest node first or follow the field if the agent is already there */
+    dim::vector3df Dir(Node->getPosition() - Position);
+    
+    if (Dir.getLengthSq() <= math::ROUNDING_ERROR)
+        return getDirection(Node);
+    
+    return Dir.normalize();
+}
+
+f32 PathFlowField::getCosts(const PathNode* Node) const
+{
+    return checkNode(Node) ? Costs_[Node->getIndex()] : -1.0f;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void PathFlowField::buildAdjacency()
+{
+    const u32 NumNodes = Graph_->getNodeList().size();
+    
+    Nodes_.resize(NumNodes);
+    
+    Forward_.Offsets.assign(NumNodes + 1, 0);
+    Backward_.Offsets.assign(NumNodes + 1, 0);
+    
+    /* Count the links of each node */
+    foreach (PathNode* Node, Graph_->getNodeList())
+    {
+        Nodes_[Node->getIndex()] = Node;
+        
+        for (std::list<PathNode::SNeighbor>::const_iterator it = Node->Neighbors_.begin(); it != Node->Neighbors_.end(); ++it)
+        {
+            if (it->Node != Node)
+            {
+                ++Forward_.Offsets[Node->getIndex() + 1];
+                ++Backward_.Offsets[it->Node->getIndex() + 1];
+            }
+        }
+    }
+    
+    for (u32 i = 0; i < NumNodes; ++i)
+    {
+        Forward_.Offsets[i + 1] += Forward_.Offsets[i];
+        Backward_.Offsets[i + 1] += Backward_.Offsets[i];
+    }
+    
+    const u32 NumLinks = Forward_.Offsets[NumNodes];
+    
+    Forward_.Nodes.resize(NumLinks);
+    Forward_.Distances.resize(NumLinks);
+    Backward_.Nodes.resize(NumLinks);
+    Backward_.Distances.resize(NumLinks);
+    
+    /* Fill the links (the backward lists store for each node the nodes which lead to it) */
+    std::vector<u32> BackwardFill(Backward_.Offsets.begin(), Backward_.Offsets.end() - 1);
+    
+    for (u32 i = 0; i < NumNodes; ++i)
+    {
+        const PathNode* Node = Nodes_[i];
+        u32 Link = Forward_.Offsets[i];
+        
+        for (std::list<PathNode::SNeighbor>::const_iterator it = Node->Neighbors_.begin(); it != Node->Neighbors_.end(); ++it)
+        {
+            if (it->Node == Node)
+                continue;
+            
+            const u32 Neighbor = it->Node->getIndex();
+            
+            Forward_.Nodes      [Link] = Neighbor;
+            Forward_.Distances  [Link] = it->Distance;
+            ++Link;
+            
+            const u32 BackLink = BackwardFill[Neighbor]++;
+            
+            Backward_.Nodes     [BackLink] = i;
+            Backward_.Distances [BackLink] = it->Distance;
+        }
+    }
+}
+
+void PathFlowField::buildIntegrationField(u32 GoalIndex)
+{
+    typedef std::pair<f32, u32> SEntry;
+    
+    std::priority_queue< SEntry, std::vector<SEntry>, std::greater<SEntry> > OpenList;
+    
+    Costs_.assign(Nodes_.size(), -1.0f);
+    
+    Costs_[GoalIndex] = 0.0f;
+    OpenList.push(SEntry(0.0f, GoalIndex));
+    
+    /* Dijkstra search from the goal node over the backward links */
+    while (!OpenList.empty())
+    {
+        const SEntry Entry = OpenList.top();
+        OpenList.pop();
+        
+        /* Skip outdated entries (the queue has no decrease-key operation) */
+        if (Entry.first > Costs_[Entry.second])
+            continue;
+        
+        ++NumReachableNodes_;
+        
+        for (u32 i = Backward_.Offsets[Entry.second], n = Backward_.Offsets[Entry.second + 1]; i < n; ++i)
+        {
+            const u32 Node = Backward_.Nodes[i];
+            const f32 Costs = Entry.first + Backward_.Distances[i];
+            
+            if (Costs_[Node] < 0.0f || Costs < Costs_[Node])
+            {
+                Costs_[Node] = Costs;
+                OpenList.push(SEntry(Costs, Node));
+            }
+        }
+    }
+}
+
+void PathFlowField::buildNextNodes(u32 First, u32 Last)
+{
+    const u32 GoalIndex = Goal_->getIndex();
+    
+    for (u32 i = First; i < Last; ++i)
+    {
+        if (i == GoalIndex || Costs_[i] < 0.0f)
+            continue;
+        
+        /* Select the neighbor over which the goal is reached with the lowest costs */
+        f32 BestCosts = -1.0f;
+        
+        for (u32 j = Forward_.Offsets[i], n = Forward_.Offsets[i + 1]; j < n; ++j)
+        {
+            const u32 Neighbor = Forward_.Nodes[j];
+            
+            if (Costs_[Neighbor] < 0.0f)
+                continue;
+            
+            const f32 Costs = Costs_[Neighbor] + Forward_.Distances[j];
+            
+            if (BestCosts < 0.0f || Costs < BestCosts)
+            {
+                BestCosts       = Costs;
+                NextNodes_[i]   = Nodes_[Neighbor];
+            }
+        }
+    }
+}
+
+bool PathFlowField::checkNode(const PathNode* Node) const
+{
+    return Node && Node->getIndex() < Nodes_.size() && Nodes_[Node->getIndex()] == Node;
+}
+
+
+} // /namespace tool
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,159 @@
+/*
+ * Path flow field header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_TOOL_PATHFLOWFIELD_H__
+#define __SP_TOOL_PATHFLOWFIELD_H__
+
+
+#include "Base/spStandard.hpp"
+
+#ifdef SP_COMPILE_WITH_PATHFINDER
+
+
+#include "Base/spDimension.hpp"
+
+#include <vector>
+
+
+namespace sp
+{
+namespace tool
+{
+
+
+class PathNode;
+class PathGraph;
+
+/**
+PathFlowField objects store the shortest way from each node of a PathGraph to one goal node.
+The whole field is computed with a single Dijkstra search which starts at the goal node
+(the "integration field"). After that each node knows its next node on the way to the goal,
+so any count of agents can move to the same goal with an O(1) lookup per step instead of
+searching an own path with "PathGraph::findPath".
+\see PathGraph::getFlowField
+\ingroup group_pathfinding
+*/
+class SP_EXPORT PathFlowField
+{
+    
+    public:
+        
+        PathFlowField();
+        ~PathFlowField();
+        
+        /* === Functions === */
+        
+        /**
+        Builds the flow field for the specified graph and goal node.
+        \param Graph: Specifies the graph. The field is only valid as long as this graph is not modified.
+        \param Goal: Specifies the goal node which all agents want to reach.
+        \param ThreadCount: Specifies the count of tasks which are used to compute the next node for each node.
+        The tasks are processed by the shared thread pool. The integration field itself is always computed by one thread.
+        \see ThreadPool::getShared
+        \return True if the field could be built. Otherwise the graph or the goal node was invalid.
+        */
+        bool build(const PathGraph* Graph, PathNode* Goal, u32 ThreadCount = 1);
+        
+        //! Deletes the field.
+        void clear();
+        
+        //! Returns true if the field has been built and the graph has not been modified since then.
+        bool valid() const;
+        
+        //! Returns the next node on the shortest way from the specified node to the goal or null if the goal can not be reached.
+        PathNode* getNextNode(const PathNode* Node) const;
+        
+        /**
+        Returns the normalized direction from the specified node to its next node.
+        \return Direction vector or a zero vector if the node is the goal or can not reach the goal.
+        */
+        dim::vector3df getDirection(const PathNode* Node) const;
+        
+        /**
+        Returns the direction in which an agent at the specified global position should move.
+        The agent moves to the nearest node first and then follows the field.
+        \see PathGraph::findNearestNode
+        */
+        dim::vector3df getDirection(const dim::vector3df &Position) const;
+        
+        //! Returns the way costs from the specified node to the goal or -1.0 if the goal can not be reached.
+        f32 getCosts(const PathNode* Node) const;
+        
+        /* === Inline functions === */
+        
+        //! Returns the goal node.
+        inline PathNode* getGoal() const
+        {
+            return Goal_;
+        }
+        
+        //! Returns the graph for which this field has been built.
+        inline const PathGraph* getGraph() const
+        {
+            return Graph_;
+        }
+        
+        //! Returns the count of nodes which can reach the goal.
+        inline u32 getNumReachableNodes() const
+        {
+            return NumReachableNodes_;
+        }
+        
+    private:
+        
+        friend class PathGraph;
+        friend void FlowFieldTaskProc(u32 Index, void* UserData);
+        
+        /* === Structures === */
+        
+        //! Compact (flat) adjacency list of the whole graph.
+        struct SAdjacency
+        {
+            std::vector<u32> Offsets;   //!< First link for each node (NumNodes + 1 entries).
+            std::vector<u32> Nodes;     //!< Linked node indices.
+            std::vector<f32> Distances; //!< Linked node distances.
+        };
+        
+        /* === Functions === */
+        
+        void buildAdjacency();
+        void buildIntegrationField(u32 GoalIndex);
+        void buildNextNodes(u32 First, u32 Last);
+        
+        bool checkNode(const PathNode* Node) const;
+        
+        /* === Members === */
+        
+        const PathGraph* Graph_;
+        PathNode* Goal_;
+        u32 Revision_;
+        
+        std::vector<PathNode*> Nodes_;
+        std::vector<f32> Costs_;
+        std::vector<PathNode*> NextNodes_;
+        
+        SAdjacency Forward_;
+        SAdjacency Backward_;
+        
+        u32 NumReachableNodes_;
+        u32 LastUse_; //!< Used by the flow field cache of the PathGraph class.
+        
+};
+
+
+} // /namespace tool
+
+} // /namespace sp
+
+
+#endif
+
+#endif
+
+
+
+// ================================================================================
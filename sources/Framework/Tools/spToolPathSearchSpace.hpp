@@ -0,0 +1,269 @@
+/*
+ * Path search space header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_TOOL_PATHSEARCHSPACE_H__
+#define __SP_TOOL_PATHSEARCHSPACE_H__
+
+
+#include "Base/spStandard.hpp"
+
+#ifdef SP_COMPILE_WITH_PATHFINDER
+
+
+#include <vector>
+
+
+namespace sp
+{
+namespace tool
+{
+
+
+/**
+Returns the dense index of a search node. By default the node itself is the index.
+Node types which are no indices (e.g. "PathNode*") specialize this structure.
+\tparam T Specifies the node type.
+*/
+template <typename T> struct SPathSearchIndex
+{
+    static inline u32 get(const T &Node)
+    {
+        return static_cast<u32>(Node);
+    }
+};
+
+
+/**
+Search space for the A* searches of the PathGraph and the GridPathGraph. The node states are stored in a dense
+array (addressed by the node indices) and the open list is a binary min-heap ordered by the estimated costs.
+Each state stores its heap index, so a node can be moved up in place when a shorter way has been found.
+\tparam T Specifies the node type (e.g. "PathNode*" or a cell index). \see SPathSearchIndex
+*/
+template <typename T> class PathSearchSpace
+{
+    
+    public:
+        
+        //! Search state of one node.
+        struct SNodeState
+        {
+            SNodeState() :
+                WayCosts        (0          ),
+                EstimatedCosts  (0          ),
+                Predecessor     (           ),
+                HeapIndex       (HEAP_CLOSED),
+                SearchID        (0          )
+            {
+            }
+            ~SNodeState()
+            {
+            }
+            
+            /* Inline functions */
+            
+            //! Returns true if the node is in the open list.
+            inline bool isOpen() const
+            {
+                return HeapIndex != HEAP_CLOSED;
+            }
+            
+            /* Members */
+            f32 WayCosts;       //!< Costs from the start node to this node.
+            f32 EstimatedCosts; //!< Way costs plus the estimated costs to the target node.
+            T Predecessor;
+            u32 HeapIndex;      //!< Index in the open list or HEAP_CLOSED.
+            u32 SearchID;       //!< Search ID of the last search which has visited this node.
+        };
+        
+        PathSearchSpace() :
+            SearchID_(0)
+        {
+        }
+        ~PathSearchSpace()
+        {
+        }
+        
+        /* === Functions === */
+        
+        //! Begins a new search for the specified count of nodes.
+        void begin(u32 NumNodes)
+        {
+            if (States_.size() < NumNodes)
+                States_.resize(NumNodes);
+            
+            OpenList_.clear();
+            
+            /*
+            Use a new search ID instead of clearing the whole state array.
+            The array only needs to be reset when the ID overflows.
+            */
+            if (++SearchID_ == 0)
+            {
+                for (typename std::vector<SNodeState>::iterator it = States_.begin(); it != States_.end(); ++it)
+                    it->SearchID = 0;
+                SearchID_ = 1;
+            }
+        }
+        
+        //! Returns the state of the specified node or null if the node has not been visited in the current search.
+        SNodeState* getVisitedState(const T &Node)
+        {
+            SNodeState& State = States_[SPathSearchIndex<T>::get(Node)];
+            return State.SearchID == SearchID_ ? &State : 0;
+        }
+        
+        //! Marks the specified node as visited in the current search and returns its state.
+        SNodeState& visit(const T &Node)
+        {
+            SNodeState& State = States_[SPathSearchIndex<T>::get(Node)];
+            State.SearchID = SearchID_;
+            return State;
+        }
+        
+        //! Inserts the specified node into the open list. Its estimated costs must already be set.
+        void pushOpen(const T &Node)
+        {
+            OpenList_.push_back(Node);
+            
+            const u32 Index = OpenList_.size() - 1;
+            States_[SPathSearchIndex<T>::get(Node)].HeapIndex = Index;
+            
+            moveUp(Index);
+        }
+        
+        /**
+        Removes the node with the lowest estimated costs from the open list.
+        \return False if the open list is empty.
+        */
+        bool popOpen(T &Node)
+        {
+            if (OpenList_.empty())
+                return false;
+            
+            Node = OpenList_.front();
+            States_[SPathSearchIndex<T>::get(Node)].HeapIndex = HEAP_CLOSED;
+            
+            /* Move the last entry to the top and restore the heap property */
+            const T Last = OpenList_.back();
+            OpenList_.pop_back();
+            
+            if (!OpenList_.empty())
+            {
+                setHeapEntry(0, Last);
+                moveDown(0);
+            }
+            
+            return true;
+        }
+        
+        //! Restores the heap order after the estimated costs of the specified open node have been decreased.
+        void updateOpen(const T &Node)
+        {
+            /* Costs can only decrease, so the node only moves towards the top */
+            moveUp(States_[SPathSearchIndex<T>::get(Node)].HeapIndex);
+        }
+        
+        /* === Inline functions === */
+        
+        //! Returns the state of the specified node. The node must have been visited in the current search.
+        inline SNodeState& getState(const T &Node)
+        {
+            return States_[SPathSearchIndex<T>::get(Node)];
+        }
+        
+        /* === Static members === */
+        
+        static const u32 HEAP_CLOSED = ~0u;
+        
+    private:
+        
+        /* === Functions === */
+        
+        void moveUp(u32 Index)
+        {
+            const T Node = OpenList_[Index];
+            const f32 Costs = getState(Node).EstimatedCosts;
+            
+            while (Index > 0)
+            {
+                const u32 Parent = (Index - 1) / 2;
+                
+                if (getHeapCosts(Parent) <= Costs)
+                    break;
+                
+                setHeapEntry(Index, OpenList_[Parent]);
+                Index = Parent;
+            }
+            
+            setHeapEntry(Index, Node);
+        }
+        
+        void moveDown(u32 Index)
+        {
+            const u32 Count = OpenList_.size();
+            
+            const T Node = OpenList_[Index];
+            const f32 Costs = getState(Node).EstimatedCosts;
+            
+            while (true)
+            {
+                u32 Child = Index*2 + 1;
+                
+                if (Child >= Count)
+                    break;
+                
+                /* Select the child with the lower costs */
+                if (Child + 1 < Count && getHeapCosts(Child + 1) < getHeapCosts(Child))
+                    ++Child;
+                
+                if (Costs <= getHeapCosts(Child))
+                    break;
+                
+                setHeapEntry(Index, OpenList_[Child]);
+                Index = Child;
+            }
+            
+            setHeapEntry(Index, Node);
+        }
+        
+        /* === Inline functions === */
+        
+        inline f32 getHeapCosts(u32 Index) const
+        {
+            return States_[SPathSearchIndex<T>::get(OpenList_[Index])].EstimatedCosts;
+        }
+        
+        inline void setHeapEntry(u32 Index, const T &Node)
+        {
+            OpenList_[Index] = Node;
+            getState(Node).HeapIndex = Index;
+        }
+        
+        /* === Members === */
+        
+        std::vector<SNodeState> States_;    //!< Dense state array. Indexed by the node indices.
+        std::vector<T> OpenList_;           //!< Binary min-heap ordered by the estimated costs.
+        
+        u32 SearchID_;
+        
+};
+
+template <typename T> const u32 PathSearchSpace<T>::HEAP_CLOSED;
+
+
+} // /namespace tool
+
+} // /namespace sp
+
+
+#endif
+
+#endif
+
+
+
+// ================================================================================
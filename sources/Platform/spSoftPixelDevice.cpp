@@ -8,6 +8,8 @@
 #include "Platform/spSoftPixelDeviceOS.hpp"
 #include "Base/spSharedObjects.hpp"
 #include "Base/spTimer.hpp"
+#include "Base/spProfiler.hpp"
+#include "Base/spThreadPool.hpp"
 #include "GUI/spGUIManager.hpp"
 
 #include "RenderSystem/spRenderSystem.hpp"
@@ -25,12 +27,15 @@
 
 #include "SceneGraph/spSceneBillboard.hpp"
 #include "SceneGraph/spSceneGraphPortalBased.hpp"
+#include "SceneGraph/spSceneManager.hpp"
+#include "SceneGraph/spAsyncMeshLoader.hpp"
 #include "SceneGraph/Collision/spCollisionGraph.hpp"
 
 #include "SoundSystem/OpenAL/spOpenALSoundDevice.hpp"
 #include "SoundSystem/WinMM/spWinMMSoundDevice.hpp"
 #include "SoundSystem/XAudio2/spXAudio2SoundDevice.hpp"
 #include "SoundSystem/OpenSLES/spOpenSLESSoundDevice.hpp"
+#include "SoundSystem/Software/spSoftwareSoundDevice.hpp"
 #include "SoundSystem/spDummySoundDevice.hpp"
 
 #include "Framework/Physics/Newton/spNewtonSimulator.hpp"
@@ -354,6 +359,24 @@ void SoftPixelDevice::updateBaseEvents()
     /* Update base input events */
     GlbInputCtrl->updateBaseEvents();
     
+    /* Upload the asynchronously loaded meshes (this may request textures, so it comes first) */
+    if (gSharedObjects.SceneMngr && gSharedObjects.SceneMngr->AsyncMeshLoader_)
+        gSharedObjects.SceneMngr->AsyncMeshLoader_->update();
+    
+    /* Enforce the texture memory budget and upload the asynchronously loaded textures */
+    if (GlbRenderSys)
+    {
+        if (GlbRenderSys->TextureResidencyManager_)
+            GlbRenderSys->TextureResidencyManager_->update();
+        if (GlbRenderSys->AsyncTextureLoader_)
+            GlbRenderSys->AsyncTextureLoader_->update();
+    }
+    
+    #ifdef SP_COMPILE_WITH_PROFILER
+    /* Finish the profiler frame before the draw call counter is reset */
+    io::Profiler::nextFrame();
+    #endif
+    
     #ifdef SP_COMPILE_WITH_RENDERSYS_QUERIES
     /* Reset draw call counter */
     video::RenderSystem::resetQueryCounters();
@@ -672,6 +695,8 @@ void SoftPixelDevice::deleteResourceDevices()
     #endif
 
     MemoryManager::deleteMemory(GlbRenderSys);
+    
+    ThreadPool::deleteShared();
 }
 
 void SoftPixelDevice::releaseGraphicsContext()
@@ -749,6 +774,13 @@ audio::SoundDevice* SoftPixelDevice::allocSoundDevice(audio::ESoundDevices Devic
             DeviceType = audio::SOUNDDEVICE_DUMMY;
         }
         #endif
+        #ifndef SP_COMPILE_WITH_SOFTWARE_SOUND
+        if (DeviceType == audio::SOUNDDEVICE_SOFTWARE)
+        {
+            io::Log::warning("Software sound is not supported; using Dummy");
+            DeviceType = audio::SOUNDDEVICE_DUMMY;
+        }
+        #endif
     }
     
     switch (DeviceType)
@@ -773,6 +805,11 @@ audio::SoundDevice* SoftPixelDevice::allocSoundDevice(audio::ESoundDevices Devic
             return new audio::WinMMSoundDevice();
         #endif
         
+        #ifdef SP_COMPILE_WITH_SOFTWARE_SOUND
+        case audio::SOUNDDEVICE_SOFTWARE:
+            return new audio::SoftwareSoundDevice();
+        #endif
+        
         default:
             break;
     }
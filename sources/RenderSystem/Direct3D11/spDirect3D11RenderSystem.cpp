@@ -399,23 +399,38 @@ void Direct3D11RenderSystem::setupConfiguration()
  * ======= Rendering functions =======
  */
 
+void Direct3D11RenderSystem::invalidateRenderStates()
+{
+    RenderSystem::invalidateRenderStates();
+    
+    BoundRasterizerState_   .invalidate();
+    BoundDepthStencilState_ .invalidate();
+    BoundBlendState_        .invalidate();
+}
+
 bool Direct3D11RenderSystem::setupMaterialStates(const MaterialStates* Material, bool Forced)
 {
     /* Check for equality to optimize render path */
-    if ( GlobalMaterialStates_ != 0 || !Material || ( !Forced && ( PrevMaterial_ == Material || Material->compare(PrevMaterial_) ) ) )
+    if ( GlobalMaterialStates_ != 0 || !Material || ( !Forced && PrevMaterial_ == Material ) )
         return false;
     
     PrevMaterial_ = Material;
     
+    if (Forced)
+        invalidateRenderStates();
+    
     /* Get the material state objects */
     RasterizerState_    = reinterpret_cast<ID3D11RasterizerState*   >(Material->RefRasterizerState_     );
     DepthStencilState_  = reinterpret_cast<ID3D11DepthStencilState* >(Material->RefDepthStencilState_   );
     BlendState_         = reinterpret_cast<ID3D11BlendState*        >(Material->RefBlendState_          );
     
-    /* Set material states */
-    D3DDeviceContext_->RSSetState(RasterizerState_);
-    D3DDeviceContext_->OMSetDepthStencilState(DepthStencilState_, 0);
-    D3DDeviceContext_->OMSetBlendState(BlendState_, 0, ~0);
+    /* Set only the material state objects which differ from the bound ones */
+    if (BoundRasterizerState_.change(RasterizerState_))
+        D3DDeviceContext_->RSSetState(RasterizerState_);
+    if (BoundDepthStencilState_.change(DepthStencilState_))
+        D3DDeviceContext_->OMSetDepthStencilState(DepthStencilState_, 0);
+    if (BoundBlendState_.change(BlendState_))
+        D3DDeviceContext_->OMSetBlendState(BlendState_, 0, ~0);
     
     #ifdef SP_COMPILE_WITH_RENDERSYS_QUERIES
     ++RenderSystem::NumMaterialUpdates_;
@@ -426,6 +441,10 @@ bool Direct3D11RenderSystem::setupMaterialStates(const MaterialStates* Material,
 
 void Direct3D11RenderSystem::bindTextureLayers(const TextureLayerListType &TexLayers)
 {
+    /* Track texture usage for the residency manager */
+    if (TextureResidencyManager_)
+        TextureResidencyManager_->markUsed(TexLayers);
+    
     /* Check if this texture layer list is already bound */
     if (PrevTextureLayers_ == (&TexLayers))
         return;
@@ -84,6 +84,8 @@ class SP_EXPORT Direct3D11RenderSystem : public RenderSystem
         
         bool setupMaterialStates(const MaterialStates* Material, bool Forced);
         
+        void invalidateRenderStates();
+        
         void bindTextureLayers(const TextureLayerListType &TexLayers);
         void unbindTextureLayers(const TextureLayerListType &TexLayers);
         
@@ -410,6 +412,11 @@ class SP_EXPORT Direct3D11RenderSystem : public RenderSystem
         ID3D11DepthStencilState* DepthStencilState_;
         ID3D11BlendState* BlendState_;
         
+        /* Render state cache (state objects with equal descriptions are shared by the device) */
+        SStateCache<ID3D11RasterizerState*> BoundRasterizerState_;
+        SStateCache<ID3D11DepthStencilState*> BoundDepthStencilState_;
+        SStateCache<ID3D11BlendState*> BoundBlendState_;
+        
         /* Descriptions */
         
         //D3D11_INPUT_ELEMENT_DESC* VertexLayout2D_;
@@ -13,6 +13,7 @@
 #include "RenderSystem/Direct3D11/spDirect3D11RenderSystem.hpp"
 #include "RenderSystem/Direct3D11/spDirect3D11TextureBuffer.hpp"
 #include "Base/spImageManagement.hpp"
+#include "Base/spProfiler.hpp"
 #include "Platform/spSoftPixelDeviceOS.hpp"
 #include "Framework/Tools/spUtilityDebugging.hpp"
 
@@ -185,6 +186,8 @@ void Direct3D11Texture::bind(s32 Level) const
 {
     D3D11_RENDER_SYS->setupShaderResourceView   (static_cast<u32>(Level), ResourceView_ );
     D3D11_RENDER_SYS->setupSamplerState         (static_cast<u32>(Level), SamplerSate_  );
+    
+    markUsed();
 }
 
 void Direct3D11Texture::unbind(s32 Level) const
@@ -231,6 +234,8 @@ bool Direct3D11Texture::shareImageBuffer()
 
 bool Direct3D11Texture::updateImageBuffer()
 {
+    SP_PROFILE_COUNTER(io::PROFILERCOUNTER_BUFFER_UPLOADS, 1);
+    
     /* Re-create the hardware texture */
     if (!createHWTexture())
         return false;
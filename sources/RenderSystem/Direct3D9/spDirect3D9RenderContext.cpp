@@ -313,6 +313,9 @@ bool Direct3D9RenderContext::reset()
         return false;
     }
 
+    /* The device has been reset to its default render states */
+    GlbRenderSys->invalidateRenderStates();
+
     /* Recreate all graphics resources */
     static_cast<Direct3D9RenderSystem*>(GlbRenderSys)->recreateAllResources();
 
@@ -95,7 +95,8 @@ Direct3D9RenderSystem::Direct3D9RenderSystem() :
     CurD3DVolumeTexture_        (0                  ),
     ClearColor_                 (video::color::empty),
     ClearColorMask_             (1, 1, 1, 1         ),
-    ClearStencil_               (0                  )
+    ClearStencil_               (0                  ),
+    isD3DMaterialCacheValid_    (false              )
 {
     /* Create the Direct3D renderer */
     D3DInstance_ = Direct3DCreate9(D3D_SDK_VERSION);
@@ -170,10 +171,10 @@ void Direct3D9RenderSystem::setupConfiguration()
     }
     
     /* Default settings */
-    D3DDevice_->SetRenderState(D3DRS_ZFUNC, D3DCMP_LESSEQUAL);
-    D3DDevice_->SetRenderState(D3DRS_ALPHATESTENABLE, true);
-    D3DDevice_->SetRenderState(D3DRS_SPECULARENABLE, true);
-    D3DDevice_->SetRenderState(D3DRS_NORMALIZENORMALS, true);
+    setD3DRenderState(D3DRS_ZFUNC, D3DCMP_LESSEQUAL);
+    setD3DRenderState(D3DRS_ALPHATESTENABLE, true);
+    setD3DRenderState(D3DRS_SPECULARENABLE, true);
+    setD3DRenderState(D3DRS_NORMALIZENORMALS, true);
     
     /* Default queries */
     RenderQuery_[RENDERQUERY_SHADER             ] = queryVideoSupport(VIDEOSUPPORT_SHADER               );
@@ -298,10 +299,10 @@ void Direct3D9RenderSystem::setShadeMode(const EShadeModeTypes ShadeMode)
     switch (ShadeMode)
     {
         case SHADEMODE_SMOOTH:
-            D3DDevice_->SetRenderState(D3DRS_SHADEMODE, D3DSHADE_GOURAUD);
+            setD3DRenderState(D3DRS_SHADEMODE, D3DSHADE_GOURAUD);
             break;
         case SHADEMODE_FLAT:
-            D3DDevice_->SetRenderState(D3DRS_SHADEMODE, D3DSHADE_FLAT);
+            setD3DRenderState(D3DRS_SHADEMODE, D3DSHADE_FLAT);
             break;
     }
 }
@@ -337,17 +338,17 @@ void Direct3D9RenderSystem::setColorMask(bool isRed, bool isGreen, bool isBlue,
         ClearColorMask_.Alpha = 1;
     }
     
-    D3DDevice_->SetRenderState(D3DRS_COLORWRITEENABLE, Mask);
+    setD3DRenderState(D3DRS_COLORWRITEENABLE, Mask);
 }
 
 void Direct3D9RenderSystem::setDepthMask(bool isDepth)
 {
-    D3DDevice_->SetRenderState(D3DRS_ZWRITEENABLE, isDepth);
+    setD3DRenderState(D3DRS_ZWRITEENABLE, isDepth);
 }
 
 void Direct3D9RenderSystem::setAntiAlias(bool isAntiAlias)
 {
-    D3DDevice_->SetRenderState(D3DRS_MULTISAMPLEANTIALIAS, isAntiAlias);
+    setD3DRenderState(D3DRS_MULTISAMPLEANTIALIAS, isAntiAlias);
 }
 
 void Direct3D9RenderSystem::setDepthRange(f32 Near, f32 Far)
@@ -367,7 +368,7 @@ void Direct3D9RenderSystem::setDepthRange(f32 Near, f32 Far)
 void Direct3D9RenderSystem::setDepthClip(bool Enable)
 {
     RenderSystem::setDepthClip(Enable);
-    D3DDevice_->SetRenderState(D3DRS_CLIPPING, Enable);
+    setD3DRenderState(D3DRS_CLIPPING, Enable);
 }
 
 
@@ -377,21 +378,21 @@ void Direct3D9RenderSystem::setDepthClip(bool Enable)
 
 void Direct3D9RenderSystem::setStencilMask(u32 BitMask)
 {
-    D3DDevice_->SetRenderState(D3DRS_STENCILMASK, BitMask);
+    setD3DRenderState(D3DRS_STENCILMASK, BitMask);
 }
 
 void Direct3D9RenderSystem::setStencilMethod(const ESizeComparisionTypes Method, s32 Reference, u32 BitMask)
 {
-    D3DDevice_->SetRenderState(D3DRS_STENCILFUNC, D3DCompareList[Method]);
-    D3DDevice_->SetRenderState(D3DRS_STENCILREF, Reference);
-    D3DDevice_->SetRenderState(D3DRS_STENCILWRITEMASK, BitMask);
+    setD3DRenderState(D3DRS_STENCILFUNC, D3DCompareList[Method]);
+    setD3DRenderState(D3DRS_STENCILREF, Reference);
+    setD3DRenderState(D3DRS_STENCILWRITEMASK, BitMask);
 }
 
 void Direct3D9RenderSystem::setStencilOperation(const EStencilOperations FailOp, const EStencilOperations ZFailOp, const EStencilOperations ZPassOp)
 {
-    D3DDevice_->SetRenderState(D3DRS_STENCILZFAIL, D3DStencilOperationList[FailOp]);
-    D3DDevice_->SetRenderState(D3DRS_STENCILFAIL, D3DStencilOperationList[ZFailOp]);
-    D3DDevice_->SetRenderState(D3DRS_STENCILPASS, D3DStencilOperationList[ZPassOp]);
+    setD3DRenderState(D3DRS_STENCILZFAIL, D3DStencilOperationList[FailOp]);
+    setD3DRenderState(D3DRS_STENCILFAIL, D3DStencilOperationList[ZFailOp]);
+    setD3DRenderState(D3DRS_STENCILPASS, D3DStencilOperationList[ZPassOp]);
 }
 
 void Direct3D9RenderSystem::setClearStencil(s32 Stencil)
@@ -404,40 +405,54 @@ void Direct3D9RenderSystem::setClearStencil(s32 Stencil)
  * ======= Rendering functions =======
  */
 
+void Direct3D9RenderSystem::invalidateRenderStates()
+{
+    RenderSystem::invalidateRenderStates();
+    
+    for (u32 i = 0; i < RENDERSTATE_CACHE_SIZE; ++i)
+        RenderStateCache_[i].invalidate();
+    
+    isD3DMaterialCacheValid_ = false;
+}
+
 bool Direct3D9RenderSystem::setupMaterialStates(const MaterialStates* Material, bool Forced)
 {
     /* Check for equality to optimize render path */
-    if ( GlobalMaterialStates_ != 0 || !Material || ( !Forced && ( PrevMaterial_ == Material || Material->compare(PrevMaterial_) ) ) )
+    if ( GlobalMaterialStates_ != 0 || !Material || ( !Forced && PrevMaterial_ == Material ) )
         return false;
     
     PrevMaterial_ = Material;
     
+    /* Only the states which differ from their shadow copies are changed (see "setD3DRenderState") */
+    if (Forced)
+        invalidateRenderStates();
+    
     /* Cull facing */
     switch (Material->getRenderFace())
     {
         case video::FACE_FRONT:
-            D3DDevice_->SetRenderState(D3DRS_CULLMODE, isFrontFace_ ? D3DCULL_CCW : D3DCULL_CW);
+            setD3DRenderState(D3DRS_CULLMODE, isFrontFace_ ? D3DCULL_CCW : D3DCULL_CW);
             break;
         case video::FACE_BACK:
-            D3DDevice_->SetRenderState(D3DRS_CULLMODE, isFrontFace_ ? D3DCULL_CW : D3DCULL_CCW);
+            setD3DRenderState(D3DRS_CULLMODE, isFrontFace_ ? D3DCULL_CW : D3DCULL_CCW);
             break;
         case video::FACE_BOTH:
-            D3DDevice_->SetRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
+            setD3DRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
             break;
     }
     
     /* Fog effect */
-    D3DDevice_->SetRenderState(D3DRS_FOGENABLE, __isFog && Material->getFog());
+    setD3DRenderState(D3DRS_FOGENABLE, __isFog && Material->getFog());
     
     /* Color material */
-    D3DDevice_->SetRenderState(D3DRS_COLORVERTEX, Material->getColorMaterial());
+    setD3DRenderState(D3DRS_COLORVERTEX, Material->getColorMaterial());
     
     /* Lighting material */
     if (__isLighting && Material->getLighting())
     {
         D3DMATERIAL9 D3DMat;
         
-        D3DDevice_->SetRenderState(D3DRS_LIGHTING, true);
+        setD3DRenderState(D3DRS_LIGHTING, true);
         
         /* Diffuse, ambient, specular and emissive color */
         D3DMat.Diffuse = getD3DColor(Material->getDiffuseColor());
@@ -449,48 +464,48 @@ bool Direct3D9RenderSystem::setupMaterialStates(const MaterialStates* Material,
         D3DMat.Power = Material->getShininessFactor();
         
         /* Set the material */
-        D3DDevice_->SetMaterial(&D3DMat);
+        setD3DMaterial(D3DMat);
     }
     else
-        D3DDevice_->SetRenderState(D3DRS_LIGHTING, false);
+        setD3DRenderState(D3DRS_LIGHTING, false);
     
     /* Depth functions */
     if (Material->getDepthBuffer())
     {
-        D3DDevice_->SetRenderState(D3DRS_ZENABLE, true);
-        D3DDevice_->SetRenderState(D3DRS_ZFUNC, D3DCompareList[Material->getDepthMethod()]);
+        setD3DRenderState(D3DRS_ZENABLE, true);
+        setD3DRenderState(D3DRS_ZFUNC, D3DCompareList[Material->getDepthMethod()]);
     }
     else
-        D3DDevice_->SetRenderState(D3DRS_ZENABLE, false);
+        setD3DRenderState(D3DRS_ZENABLE, false);
     
     /* Blending mode */
     if (Material->getBlending())
     {
-        D3DDevice_->SetRenderState(D3DRS_ALPHABLENDENABLE, true);
-        D3DDevice_->SetRenderState(D3DRS_SRCBLEND, D3DBlendingList[Material->getBlendSource()]);
-        D3DDevice_->SetRenderState(D3DRS_DESTBLEND, D3DBlendingList[Material->getBlendTarget()]);
+        setD3DRenderState(D3DRS_ALPHABLENDENABLE, true);
+        setD3DRenderState(D3DRS_SRCBLEND, D3DBlendingList[Material->getBlendSource()]);
+        setD3DRenderState(D3DRS_DESTBLEND, D3DBlendingList[Material->getBlendTarget()]);
     }
     else
-        D3DDevice_->SetRenderState(D3DRS_ALPHABLENDENABLE, false);
+        setD3DRenderState(D3DRS_ALPHABLENDENABLE, false);
     
     /* Polygon offset */
     if (Material->getPolygonOffset())
     {
-        D3DDevice_->SetRenderState(D3DRS_SLOPESCALEDEPTHBIAS, *(DWORD*)&Material->OffsetFactor_);
-        D3DDevice_->SetRenderState(D3DRS_DEPTHBIAS, *(DWORD*)&Material->OffsetUnits_);
+        setD3DRenderState(D3DRS_SLOPESCALEDEPTHBIAS, *(DWORD*)&Material->OffsetFactor_);
+        setD3DRenderState(D3DRS_DEPTHBIAS, *(DWORD*)&Material->OffsetUnits_);
     }
     else
     {
-        D3DDevice_->SetRenderState(D3DRS_SLOPESCALEDEPTHBIAS, 0);
-        D3DDevice_->SetRenderState(D3DRS_DEPTHBIAS, 0);
+        setD3DRenderState(D3DRS_SLOPESCALEDEPTHBIAS, 0);
+        setD3DRenderState(D3DRS_DEPTHBIAS, 0);
     }
     
     /* Alpha functions */
-    D3DDevice_->SetRenderState(D3DRS_ALPHAFUNC, D3DCompareList[Material->getAlphaMethod()]);
-    D3DDevice_->SetRenderState(D3DRS_ALPHAREF, s32(Material->getAlphaReference() * 255));
+    setD3DRenderState(D3DRS_ALPHAFUNC, D3DCompareList[Material->getAlphaMethod()]);
+    setD3DRenderState(D3DRS_ALPHAREF, s32(Material->getAlphaReference() * 255));
     
     /* Polygon mode */
-    D3DDevice_->SetRenderState(D3DRS_FILLMODE, D3DFILL_POINT + Material->getWireframeFront());
+    setD3DRenderState(D3DRS_FILLMODE, D3DFILL_POINT + Material->getWireframeFront());
     
     /* Flexible vertex format (FVF) */
     D3DDevice_->SetFVF(FVF_VERTEX3D);
@@ -929,34 +944,34 @@ void Direct3D9RenderSystem::setRenderState(const video::ERenderStates Type, s32
     switch (Type)
     {
         case RENDER_ALPHATEST:
-            D3DDevice_->SetRenderState(D3DRS_ALPHATESTENABLE, State); break;
+            setD3DRenderState(D3DRS_ALPHATESTENABLE, State); break;
         case RENDER_BLEND:
-            D3DDevice_->SetRenderState(D3DRS_ALPHABLENDENABLE, State); break;
+            setD3DRenderState(D3DRS_ALPHABLENDENABLE, State); break;
         case RENDER_COLORMATERIAL:
-            D3DDevice_->SetRenderState(D3DRS_COLORVERTEX, State); break;
+            setD3DRenderState(D3DRS_COLORVERTEX, State); break;
         case RENDER_CULLFACE:
-            D3DDevice_->SetRenderState(D3DRS_CULLMODE, State ? D3DCULL_CCW : D3DCULL_NONE); break;
+            setD3DRenderState(D3DRS_CULLMODE, State ? D3DCULL_CCW : D3DCULL_NONE); break;
         case RENDER_DEPTH:
-            D3DDevice_->SetRenderState(D3DRS_ZENABLE, State); break;
+            setD3DRenderState(D3DRS_ZENABLE, State); break;
         case RENDER_DITHER:
-            D3DDevice_->SetRenderState(D3DRS_DITHERENABLE, State); break;
+            setD3DRenderState(D3DRS_DITHERENABLE, State); break;
         case RENDER_FOG:
-            D3DDevice_->SetRenderState(D3DRS_FOGENABLE, State); break;
+            setD3DRenderState(D3DRS_FOGENABLE, State); break;
         case RENDER_LIGHTING:
-            D3DDevice_->SetRenderState(D3DRS_LIGHTING, State); break;
+            setD3DRenderState(D3DRS_LIGHTING, State); break;
         case RENDER_LINESMOOTH:
-            D3DDevice_->SetRenderState(D3DRS_ANTIALIASEDLINEENABLE, State); break;
+            setD3DRenderState(D3DRS_ANTIALIASEDLINEENABLE, State); break;
         case RENDER_MULTISAMPLE:
-            D3DDevice_->SetRenderState(D3DRS_MULTISAMPLEANTIALIAS, State); break;
+            setD3DRenderState(D3DRS_MULTISAMPLEANTIALIAS, State); break;
         case RENDER_NORMALIZE:
         case RENDER_RESCALENORMAL:
-            D3DDevice_->SetRenderState(D3DRS_NORMALIZENORMALS, State); break;
+            setD3DRenderState(D3DRS_NORMALIZENORMALS, State); break;
         case RENDER_POINTSMOOTH:
             break;
         case RENDER_SCISSOR:
-            D3DDevice_->SetRenderState(D3DRS_SCISSORTESTENABLE, State); break;
+            setD3DRenderState(D3DRS_SCISSORTESTENABLE, State); break;
         case RENDER_STENCIL:
-            D3DDevice_->SetRenderState(D3DRS_STENCILENABLE, State); break;
+            setD3DRenderState(D3DRS_STENCILENABLE, State); break;
         case RENDER_TEXTURE:
             __isTexturing = (State != 0); break;
     }
@@ -1011,10 +1026,10 @@ void Direct3D9RenderSystem::endSceneRendering()
     RenderSystem::endSceneRendering();
     
     /* Default render functions */
-    D3DDevice_->SetRenderState(D3DRS_ALPHAFUNC, D3DCMP_ALWAYS);
-    D3DDevice_->SetRenderState(D3DRS_ALPHAREF, 0);
-    D3DDevice_->SetRenderState(D3DRS_ALPHABLENDENABLE, true);
-    D3DDevice_->SetRenderState(D3DRS_ZFUNC, D3DCMP_LESSEQUAL);
+    setD3DRenderState(D3DRS_ALPHAFUNC, D3DCMP_ALWAYS);
+    setD3DRenderState(D3DRS_ALPHAREF, 0);
+    setD3DRenderState(D3DRS_ALPHABLENDENABLE, true);
+    setD3DRenderState(D3DRS_ZFUNC, D3DCMP_LESSEQUAL);
     
     PrevMaterial_ = 0;
 }
@@ -1109,15 +1124,15 @@ void Direct3D9RenderSystem::setFog(const EFogTypes Type)
             switch (Fog_.Mode)
             {
                 case FOG_PALE:
-                    D3DDevice_->SetRenderState(D3DRS_FOGTABLEMODE, D3DFOG_EXP); break;
+                    setD3DRenderState(D3DRS_FOGTABLEMODE, D3DFOG_EXP); break;
                 case FOG_THICK:
-                    D3DDevice_->SetRenderState(D3DRS_FOGTABLEMODE, D3DFOG_EXP2); break;
+                    setD3DRenderState(D3DRS_FOGTABLEMODE, D3DFOG_EXP2); break;
             }
             
             /* Range settings */
-            D3DDevice_->SetRenderState(D3DRS_FOGDENSITY, *(DWORD*)&Fog_.Range);
-            D3DDevice_->SetRenderState(D3DRS_FOGSTART, *(DWORD*)&Fog_.Near);
-            D3DDevice_->SetRenderState(D3DRS_FOGEND, *(DWORD*)&Fog_.Far);
+            setD3DRenderState(D3DRS_FOGDENSITY, *(DWORD*)&Fog_.Range);
+            setD3DRenderState(D3DRS_FOGSTART, *(DWORD*)&Fog_.Near);
+            setD3DRenderState(D3DRS_FOGEND, *(DWORD*)&Fog_.Far);
         }
         break;
         
@@ -1126,11 +1141,11 @@ void Direct3D9RenderSystem::setFog(const EFogTypes Type)
             __isFog = true;
             
             /* Renderer settings */
-            D3DDevice_->SetRenderState(D3DRS_FOGTABLEMODE, D3DFOG_LINEAR);
-            D3DDevice_->SetRenderState(D3DRS_FOGVERTEXMODE, D3DFOG_LINEAR); // ???
-            D3DDevice_->SetRenderState(D3DRS_FOGDENSITY, *(DWORD*)&Fog_.Range);
-            D3DDevice_->SetRenderState(D3DRS_FOGSTART, 0);
-            D3DDevice_->SetRenderState(D3DRS_FOGEND, 1);
+            setD3DRenderState(D3DRS_FOGTABLEMODE, D3DFOG_LINEAR);
+            setD3DRenderState(D3DRS_FOGVERTEXMODE, D3DFOG_LINEAR); // ???
+            setD3DRenderState(D3DRS_FOGDENSITY, *(DWORD*)&Fog_.Range);
+            setD3DRenderState(D3DRS_FOGSTART, 0);
+            setD3DRenderState(D3DRS_FOGEND, 1);
         }
         break;
     }
@@ -1138,7 +1153,7 @@ void Direct3D9RenderSystem::setFog(const EFogTypes Type)
 
 void Direct3D9RenderSystem::setFogColor(const video::color &Color)
 {
-    D3DDevice_->SetRenderState(D3DRS_FOGCOLOR, Color.getSingle());
+    setD3DRenderState(D3DRS_FOGCOLOR, Color.getSingle());
     Fog_.Color = Color;
 }
 
@@ -1152,15 +1167,15 @@ void Direct3D9RenderSystem::setFogRange(f32 Range, f32 NearPlane, f32 FarPlane,
         switch (Fog_.Mode)
         {
             case FOG_PALE:
-                D3DDevice_->SetRenderState(D3DRS_FOGTABLEMODE, D3DFOG_EXP); break;
+                setD3DRenderState(D3DRS_FOGTABLEMODE, D3DFOG_EXP); break;
             case FOG_THICK:
-                D3DDevice_->SetRenderState(D3DRS_FOGTABLEMODE, D3DFOG_EXP2); break;
+                setD3DRenderState(D3DRS_FOGTABLEMODE, D3DFOG_EXP2); break;
         }
         
         /* Range settings */
-        D3DDevice_->SetRenderState(D3DRS_FOGDENSITY, *(DWORD*)&Fog_.Range);
-        D3DDevice_->SetRenderState(D3DRS_FOGSTART, *(DWORD*)&Fog_.Near);
-        D3DDevice_->SetRenderState(D3DRS_FOGEND, *(DWORD*)&Fog_.Far);
+        setD3DRenderState(D3DRS_FOGDENSITY, *(DWORD*)&Fog_.Range);
+        setD3DRenderState(D3DRS_FOGSTART, *(DWORD*)&Fog_.Near);
+        setD3DRenderState(D3DRS_FOGEND, *(DWORD*)&Fog_.Far);
     }
 }
 
@@ -1184,7 +1199,7 @@ void Direct3D9RenderSystem::setClipPlane(u32 Index, const dim::plane3df &Plane,
     else
         math::removeFlag(State, Flag);
     
-    D3DDevice_->SetRenderState(D3DRS_CLIPPLANEENABLE, State);
+    setD3DRenderState(D3DRS_CLIPPLANEENABLE, State);
 }
 
 
@@ -1272,7 +1287,7 @@ void Direct3D9RenderSystem::beginDrawing2D()
     /* Disable 3d render states */
     D3DDevice_->SetTextureStageState(0, D3DTSS_TEXTURETRANSFORMFLAGS, D3DTTFF_DISABLE);
     D3DDevice_->SetTextureStageState(0, D3DTSS_TEXCOORDINDEX, 0);
-    D3DDevice_->SetRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
+    setD3DRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
     
     /* Use no texture layer */
     D3DDevice_->SetTexture(0, 0);
@@ -1284,13 +1299,13 @@ void Direct3D9RenderSystem::beginDrawing2D()
 
 void Direct3D9RenderSystem::setBlending(const EBlendingTypes SourceBlend, const EBlendingTypes DestBlend)
 {
-    D3DDevice_->SetRenderState(D3DRS_SRCBLEND, D3DBlendingList[SourceBlend]);
-    D3DDevice_->SetRenderState(D3DRS_DESTBLEND, D3DBlendingList[DestBlend]);
+    setD3DRenderState(D3DRS_SRCBLEND, D3DBlendingList[SourceBlend]);
+    setD3DRenderState(D3DRS_DESTBLEND, D3DBlendingList[DestBlend]);
 }
 
 void Direct3D9RenderSystem::setClipping(bool Enable, const dim::point2di &Position, const dim::size2di &Dimension)
 {
-    D3DDevice_->SetRenderState(D3DRS_SCISSORTESTENABLE, Enable);
+    setD3DRenderState(D3DRS_SCISSORTESTENABLE, Enable);
     
     RECT rc;
     {
@@ -1353,7 +1368,7 @@ bool Direct3D9RenderSystem::setRenderTarget(Texture* Target)
 void Direct3D9RenderSystem::setPointSize(s32 Size)
 {
     f32 Temp = static_cast<f32>(Size);
-    D3DDevice_->SetRenderState(D3DRS_POINTSIZE, *(DWORD*)(&Temp));
+    setD3DRenderState(D3DRS_POINTSIZE, *(DWORD*)(&Temp));
 }
 
 
@@ -1400,7 +1415,7 @@ void Direct3D9RenderSystem::draw2DImage(
     };
     
     /* Set the render states */
-    D3DDevice_->SetRenderState(D3DRS_FILLMODE, D3DFILL_SOLID);
+    setD3DRenderState(D3DRS_FILLMODE, D3DFILL_SOLID);
     
     /* Update the primitive list */
     updatePrimitiveList(VerticesList, 4);
@@ -1448,7 +1463,7 @@ void Direct3D9RenderSystem::draw2DImage(
     };
     
     /* Set the render states */
-    D3DDevice_->SetRenderState(D3DRS_FILLMODE, D3DFILL_SOLID);
+    setD3DRenderState(D3DRS_FILLMODE, D3DFILL_SOLID);
     
     /* Update the primitive list */
     updatePrimitiveList(VerticesList, 4);
@@ -1487,7 +1502,7 @@ void Direct3D9RenderSystem::draw2DImage(
     };
     
     /* Set the render states */
-    D3DDevice_->SetRenderState(D3DRS_FILLMODE, D3DFILL_SOLID);
+    setD3DRenderState(D3DRS_FILLMODE, D3DFILL_SOLID);
     
     /* Update the primitive list */
     updatePrimitiveList(VerticesList, 4);
@@ -1583,7 +1598,7 @@ void Direct3D9RenderSystem::draw2DRectangle(
     };
     
     /* Set the render states */
-    D3DDevice_->SetRenderState(D3DRS_FILLMODE, isSolid ? D3DFILL_SOLID : D3DFILL_WIREFRAME);
+    setD3DRenderState(D3DRS_FILLMODE, isSolid ? D3DFILL_SOLID : D3DFILL_WIREFRAME);
     
     /* Update the primitive list */
     updatePrimitiveList(VerticesList, 4);
@@ -2163,7 +2178,7 @@ void Direct3D9RenderSystem::drawTexturedFont(
     const SFontGlyph* GlyphList = &(FontObj->getGlyphList()[0]);
     
     /* Setup render- and texture states */
-    D3DDevice_->SetRenderState(D3DRS_FILLMODE, D3DFILL_SOLID);
+    setD3DRenderState(D3DRS_FILLMODE, D3DFILL_SOLID);
     
     bindDrawingColor(Color);
     
@@ -2278,7 +2293,7 @@ void Direct3D9RenderSystem::setupTexturedFontGlyph(
 
 void Direct3D9RenderSystem::bindDrawingColor(const video::color &Color)
 {
-    D3DDevice_->SetRenderState(D3DRS_TEXTUREFACTOR, Color.getSingle());
+    setD3DRenderState(D3DRS_TEXTUREFACTOR, Color.getSingle());
     D3DDevice_->SetTextureStageState(0, D3DTSS_COLORARG2, D3DTA_TFACTOR);
     D3DDevice_->SetTextureStageState(0, D3DTSS_ALPHAARG2, D3DTA_TFACTOR);
 }
@@ -2288,6 +2303,33 @@ void Direct3D9RenderSystem::unbindDrawingColor()
     D3DDevice_->SetTextureStageState(0, D3DTSS_ALPHAARG2, D3DTA_DIFFUSE);
 }
 
+void Direct3D9RenderSystem::setD3DRenderState(const D3DRENDERSTATETYPE Type, DWORD Value)
+{
+    /* Only change the render state when it differs from its shadow copy */
+    if (static_cast<u32>(Type) >= RENDERSTATE_CACHE_SIZE || RenderStateCache_[Type].change(Value))
+        D3DDevice_->SetRenderState(Type, Value);
+}
+
+void Direct3D9RenderSystem::setD3DMaterial(const D3DMATERIAL9 &Material)
+{
+    if (isD3DMaterialCacheValid_ && !memcmp(&D3DMaterialCache_, &Material, sizeof(D3DMATERIAL9)))
+    {
+        #ifdef SP_COMPILE_WITH_RENDERSYS_QUERIES
+        ++RenderSystem::NumRedundantStateChanges_;
+        #endif
+        return;
+    }
+    
+    D3DMaterialCache_           = Material;
+    isD3DMaterialCacheValid_    = true;
+    
+    D3DDevice_->SetMaterial(&Material);
+    
+    #ifdef SP_COMPILE_WITH_RENDERSYS_QUERIES
+    ++RenderSystem::NumStateChanges_;
+    #endif
+}
+
 
 /*
  * SResourceManagement structure
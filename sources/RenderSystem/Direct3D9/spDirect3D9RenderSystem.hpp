@@ -92,6 +92,8 @@ class SP_EXPORT Direct3D9RenderSystem : public RenderSystem
         
         bool setupMaterialStates(const MaterialStates* Material, bool Forced = false);
         
+        void invalidateRenderStates();
+        
         void setupTextureLayer(
             u8 LayerIndex, const dim::matrix4f &TexMatrix, const ETextureEnvTypes EnvType,
             const EMappingGenTypes GenType, s32 MappingCoordsFlags
@@ -380,6 +382,10 @@ class SP_EXPORT Direct3D9RenderSystem : public RenderSystem
         void bindDrawingColor(const video::color &Color);
         void unbindDrawingColor();
         
+        /* Render state cache */
+        void setD3DRenderState(const D3DRENDERSTATETYPE Type, DWORD Value);
+        void setD3DMaterial(const D3DMATERIAL9 &Material);
+        
         /* === Inline functions === */
         
         inline D3DCOLORVALUE getD3DColor(const video::color &Color)
@@ -408,6 +414,13 @@ class SP_EXPORT Direct3D9RenderSystem : public RenderSystem
         
         video::color ClearColor_, ClearColorMask_;
         DWORD ClearStencil_;
+        
+        /* Render state cache */
+        static const u32 RENDERSTATE_CACHE_SIZE = D3DRS_BLENDOPALPHA + 1;
+        
+        SStateCache<DWORD> RenderStateCache_[RENDERSTATE_CACHE_SIZE];
+        D3DMATERIAL9 D3DMaterialCache_;
+        bool isD3DMaterialCacheValid_;
 
         SResourceManagement ResMngr_;
         
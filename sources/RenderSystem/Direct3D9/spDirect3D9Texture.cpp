@@ -12,6 +12,7 @@
 
 #include "RenderSystem/Direct3D9/spDirect3D9RenderSystem.hpp"
 #include "Base/spImageManagement.hpp"
+#include "Base/spProfiler.hpp"
 #include "Platform/spSoftPixelDeviceOS.hpp"
 #include "Framework/Tools/spUtilityDebugging.hpp"
 
@@ -85,6 +86,8 @@ void Direct3D9Texture::bind(s32 Level) const
     updateTextureAttributes(Level);
     
     D3D9_DEVICE->SetTexture(Level, D3DResource_.Res);
+    
+    markUsed();
 }
 
 void Direct3D9Texture::unbind(s32 Level) const
@@ -125,6 +128,8 @@ bool Direct3D9Texture::shareImageBuffer()
 
 bool Direct3D9Texture::updateImageBuffer()
 {
+    SP_PROFILE_COUNTER(io::PROFILERCOUNTER_BUFFER_UPLOADS, 1);
+    
     /* ReCreate the image data */
     createHWTexture();
     
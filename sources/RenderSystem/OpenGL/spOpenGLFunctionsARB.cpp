@@ -46,6 +46,7 @@ PFNGLACTIVETEXTUREARBPROC                   glActiveTextureARB
 //PFNGLACTIVESTENCILFACEEXTPROC               glActiveStencilFaceEXT              = 0;
 PFNGLTEXIMAGE3DEXTPROC                      glTexImage3DEXT                     = 0;
 PFNGLTEXSUBIMAGE3DEXTPROC                   glTexSubImage3DEXT                  = 0;
+PFNGLCOMPRESSEDTEXIMAGE2DARBPROC            glCompressedTexImage2DARB           = 0;
 PFNGLCLIENTACTIVETEXTUREARBPROC             glClientActiveTextureARB            = 0;
 
 PFNGLFOGCOORDPOINTERPROC                    glFogCoordPointer                   = 0;
@@ -440,6 +441,11 @@ bool loadTex3DProcs()
         loadGLProc(glTexSubImage3DEXT,  "glTexSubImage3DEXT");
 }
 
+bool loadTexCompressionProcs()
+{
+    return loadGLProc(glCompressedTexImage2DARB, "glCompressedTexImage2DARB");
+}
+
 bool loadQueryObjectProcs()
 {
     return
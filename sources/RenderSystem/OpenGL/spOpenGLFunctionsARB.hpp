@@ -79,6 +79,7 @@ extern PFNGLACTIVETEXTUREARBPROC                    glActiveTextureARB;
 //extern PFNGLACTIVESTENCILFACEEXTPROC                glActiveStencilFaceEXT;
 extern PFNGLTEXIMAGE3DEXTPROC                       glTexImage3DEXT;
 extern PFNGLTEXSUBIMAGE3DEXTPROC                    glTexSubImage3DEXT;
+extern PFNGLCOMPRESSEDTEXIMAGE2DARBPROC             glCompressedTexImage2DARB;
 
 /* Vertex buffer object (VBO) extension procedures */
 extern PFNGLCLIENTACTIVETEXTUREARBPROC              glClientActiveTextureARB;
@@ -214,6 +215,7 @@ bool loadTessellationShaderProcs();
 bool loadComputeShaderProcs();
 bool loadFogCoordProcs();
 bool loadTex3DProcs();
+bool loadTexCompressionProcs();
 bool loadQueryObjectProcs();
 
 } // /namesapce GLExtensionLoader
@@ -275,6 +275,15 @@ void GLBasePipeline::updateIndexBufferElement(void* BufferID, const dim::Univers
     }
 }
 
+void GLBasePipeline::updateVertexBufferRange(void* BufferID, const dim::UniversalBuffer &BufferData, u32 First, u32 Count)
+{
+    if (RenderQuery_[RENDERQUERY_HARDWARE_MESHBUFFER] && BufferID && Count && First + Count <= BufferData.getCount())
+    {
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, *(u32*)BufferID);
+        glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, BufferData.getStride() * First, BufferData.getStride() * Count, BufferData.getArray(First, 0));
+    }
+}
+
 
 /*
  * ======= Simple drawing functions =======
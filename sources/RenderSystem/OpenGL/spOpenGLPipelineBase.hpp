@@ -74,6 +74,8 @@ class SP_EXPORT GLBasePipeline : virtual public RenderSystem
         virtual void updateVertexBufferElement(void* BufferID, const dim::UniversalBuffer &BufferData, u32 Index);
         virtual void updateIndexBufferElement(void* BufferID, const dim::UniversalBuffer &BufferData, u32 Index);
         
+        virtual void updateVertexBufferRange(void* BufferID, const dim::UniversalBuffer &BufferData, u32 First, u32 Count);
+        
         /* === Simple drawing functions === */
         
         virtual void setBlending(const EBlendingTypes SourceBlend, const EBlendingTypes DestBlend);
@@ -20,6 +20,7 @@
 namespace sp
 {
 
+extern video::RenderSystem* GlbRenderSys;
 extern video::RenderContext* GlbRenderCtx;
 extern io::InputControl* GlbInputCtrl;
 
@@ -155,6 +156,9 @@ void OpenGLRenderContext::closeGraphicsScreen()
 
 void OpenGLRenderContext::flipBuffers()
 {
+    /* Draw pending 2D drawings before the buffers are swapped */
+    GlbRenderSys->flush2DDrawing();
+    
     #ifdef SP_DEBUGMODE
     if (!SwapBuffers(DeviceContext_))
         io::Log::debug("OpenGLRenderContext::flipBuffers", "Flip buffers failed");
@@ -613,6 +617,9 @@ bool OpenGLRenderContext::switchFullscreenMode(bool isFullscreen)
 
 void OpenGLRenderContext::flipBuffers()
 {
+    /* Draw pending 2D drawings before the buffers are swapped */
+    GlbRenderSys->flush2DDrawing();
+    
     glXSwapBuffers(Display_, Window_);
 }
 
@@ -99,7 +99,12 @@ OpenGLRenderSystem::OpenGLRenderSystem() :
     RenderSystem                    (RENDERER_OPENGL),
     GLFixedFunctionPipeline         (               ),
     GLProgrammableFunctionPipeline  (               ),
-    PrevBoundMeshBuffer_            (0              )
+    PrevBoundMeshBuffer_            (0                  ),
+    Batch2DTexture_                 (0                  ),
+    isBatch2DAdditive_              (false              ),
+    Batch2DBuffer_                  (GL_ARRAY_BUFFER_ARB),
+    Batch2DBufferSize_              (0                  ),
+    isBatch2DClipping_              (false              )
 {
 }
 OpenGLRenderSystem::~OpenGLRenderSystem()
@@ -133,6 +138,8 @@ void OpenGLRenderSystem::setupConfiguration()
     RenderQuery_[RENDERQUERY_CUBEMAP_ARRAY              ] = queryVideoSupport(VIDEOSUPPORT_CUBEMAP_ARRAY            );
     RenderQuery_[RENDERQUERY_TEXTURE_BUFFER             ] = queryVideoSupport(VIDEOSUPPORT_TEXTURE_BUFFER           );
     RenderQuery_[RENDERQUERY_SHADER_RESOURCE            ] = queryVideoSupport(VIDEOSUPPORT_SHADER_RESOURCE          );
+    RenderQuery_[RENDERQUERY_TEXTURE_COMPRESSION        ] = queryVideoSupport(VIDEOSUPPORT_TEXTURE_COMPRESSION      );
+    RenderQuery_[RENDERQUERY_TEXTURE_COMPRESSION_RG     ] = queryVideoSupport(VIDEOSUPPORT_TEXTURE_COMPRESSION_RG   );
     
     RenderQuery_[RENDERQUERY_HARDWARE_MESHBUFFER        ] = queryVideoSupport(VIDEOSUPPORT_HARDWARE_MESHBUFFER      );
     RenderQuery_[RENDERQUERY_HARDWARE_INSTANCING        ] = queryVideoSupport(VIDEOSUPPORT_HARDWARE_INSTANCING      );
@@ -203,6 +210,10 @@ bool OpenGLRenderSystem::queryVideoSupport(const EVideoFeatureSupport Query) con
             return true;
         case VIDEOSUPPORT_VOLUMETRIC_TEXTURE:
             return queryExtensionSupport("GL_EXT_texture3D");
+        case VIDEOSUPPORT_TEXTURE_COMPRESSION:
+            return queryExtensionSupport("GL_EXT_texture_compression_s3tc");
+        case VIDEOSUPPORT_TEXTURE_COMPRESSION_RG:
+            return queryExtensionSupport("GL_ARB_texture_compression_rgtc");
         case VIDEOSUPPORT_TEXTURE_BUFFER:
             return queryExtensionSupport("GL_ARB_texture_buffer_object");
         case VIDEOSUPPORT_SHADER_RESOURCE:
@@ -280,135 +291,170 @@ void OpenGLRenderSystem::setClearStencil(s32 Stencil)
  * ======= Rendering functions =======
  */
 
+void OpenGLRenderSystem::clearBuffers(const s32 ClearFlags)
+{
+    flush2DDrawing();
+    GLBasePipeline::clearBuffers(ClearFlags);
+}
+
 bool OpenGLRenderSystem::setupMaterialStates(const MaterialStates* Material, bool Forced)
 {
     /* Check for equality to optimize render path */
-    if ( GlobalMaterialStates_ != 0 || !Material || ( !Forced && ( PrevMaterial_ == Material || Material->compare(PrevMaterial_) ) ) )
+    if ( GlobalMaterialStates_ != 0 || !Material || ( !Forced && PrevMaterial_ == Material ) )
         return false;
     
+    flush2DDrawing();
+    
     PrevMaterial_ = Material;
     
+    /*
+    Only the states which differ from their shadow copies are changed,
+    so materials with only a few differences are cheap to switch
+    */
+    if (Forced)
+        StateCache_.invalidate();
+    
     /* Face culling & polygon mode */
-    GLenum PolygonOffsetType = GL_POLYGON_OFFSET_FILL;
+    u32 PolygonOffsetIndex = 2;
     
     switch (Material->getRenderFace())
     {
         case FACE_FRONT:
         {
             /* Cull back face */
-            glEnable(GL_CULL_FACE);
-            glCullFace(GL_BACK);
+            changeGlRenderState(StateCache_.CullFace, GL_CULL_FACE, true);
+            if (StateCache_.CullMode.change(GL_BACK))
+                glCullFace(GL_BACK);
             
             /* Setup wireframe for front face */
-            glPolygonMode(GL_FRONT, GL_POINT + Material->getWireframeFront());
+            changeGlPolygonMode(GL_FRONT, GL_POINT + Material->getWireframeFront());
             
             /* Get polygon offset type */
-            PolygonOffsetType = GLPolygonOffseTypes[Material->getWireframeFront()];
+            PolygonOffsetIndex = Material->getWireframeFront();
         }
         break;
         
         case FACE_BACK:
         {
             /* Cull front face */
-            glEnable(GL_CULL_FACE);
-            glCullFace(GL_FRONT);
+            changeGlRenderState(StateCache_.CullFace, GL_CULL_FACE, true);
+            if (StateCache_.CullMode.change(GL_FRONT))
+                glCullFace(GL_FRONT);
             
             /* Setup wireframe for back face */
-            glPolygonMode(GL_BACK, GL_POINT + Material->getWireframeBack());
+            changeGlPolygonMode(GL_BACK, GL_POINT + Material->getWireframeBack());
             
             /* Get polygon offset type */
-            PolygonOffsetType = GLPolygonOffseTypes[Material->getWireframeBack()];
+            PolygonOffsetIndex = Material->getWireframeBack();
         }
         break;
         
         case FACE_BOTH:
         {
             /* Disable face culling */
-            glDisable(GL_CULL_FACE);
+            changeGlRenderState(StateCache_.CullFace, GL_CULL_FACE, false);
             
             /* Setup wireframe for front and back face */
             if (Material->getWireframeFront() != Material->getWireframeBack())
             {
-                glPolygonMode(GL_FRONT, GL_POINT + Material->getWireframeFront());
-                glPolygonMode(GL_BACK, GL_POINT + Material->getWireframeBack());
+                changeGlPolygonMode(GL_FRONT, GL_POINT + Material->getWireframeFront());
+                changeGlPolygonMode(GL_BACK, GL_POINT + Material->getWireframeBack());
             }
             else
-                glPolygonMode(GL_FRONT_AND_BACK, GL_POINT + Material->getWireframeFront());
+                changeGlPolygonMode(GL_FRONT_AND_BACK, GL_POINT + Material->getWireframeFront());
             
             /* Get polygon offset type */
-            PolygonOffsetType = GLPolygonOffseTypes[Material->getWireframeFront()];
+            PolygonOffsetIndex = Material->getWireframeFront();
         }
         break;
     }
     
+    const GLenum PolygonOffsetType = GLPolygonOffseTypes[PolygonOffsetIndex];
+    
     //if (!CurShaderClass_)
     {
         /* Fog effect */
-        setGlRenderState(GL_FOG, __isFog && Material->getFog());
+        changeGlRenderState(StateCache_.Fog, GL_FOG, __isFog && Material->getFog());
         
         /* Color material */
-        setGlRenderState(GL_COLOR_MATERIAL, Material->getColorMaterial());
+        changeGlRenderState(StateCache_.ColorMaterial, GL_COLOR_MATERIAL, Material->getColorMaterial());
         
         /* Lighting material */
         if (__isLighting && Material->getLighting())
         {
-            glEnable(GL_LIGHTING);
+            changeGlRenderState(StateCache_.Lighting, GL_LIGHTING, true);
             
             /* Light model */
-            glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, Material->getRenderFace() == FACE_BOTH ? 1 : 0);
+            const s32 LightModelTwoSide = (Material->getRenderFace() == FACE_BOTH ? 1 : 0);
+            if (StateCache_.LightModelTwoSide.change(LightModelTwoSide))
+                glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, LightModelTwoSide);
             
             /* Shininess */
-            glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, Material->getShininessFactor());
-            
-            /* Diffuse color */
-            Material->getDiffuseColor().getFloatArray(TempColor_);
-            glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, TempColor_);
-            
-            /* Ambient color */
-            Material->getAmbientColor().getFloatArray(TempColor_);
-            glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, TempColor_);
-            
-            /* Specular color */
-            Material->getSpecularColor().getFloatArray(TempColor_);
-            glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, TempColor_);
+            if (StateCache_.Shininess.change(Material->getShininessFactor()))
+                glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, Material->getShininessFactor());
             
-            /* Emission color */
-            Material->getEmissionColor().getFloatArray(TempColor_);
-            glMaterialfv(GL_FRONT_AND_BACK, GL_EMISSION, TempColor_);
+            /* Diffuse, ambient, specular and emission color */
+            changeGlMaterialColor(StateCache_.DiffuseColor, GL_DIFFUSE, Material->getDiffuseColor());
+            changeGlMaterialColor(StateCache_.AmbientColor, GL_AMBIENT, Material->getAmbientColor());
+            changeGlMaterialColor(StateCache_.SpecularColor, GL_SPECULAR, Material->getSpecularColor());
+            changeGlMaterialColor(StateCache_.EmissionColor, GL_EMISSION, Material->getEmissionColor());
         }
         else
-            glDisable(GL_LIGHTING);
+            changeGlRenderState(StateCache_.Lighting, GL_LIGHTING, false);
         
-        /* Alpha function */
-        glAlphaFunc(GLCompareList[Material->getAlphaMethod()], Material->getAlphaReference());
+        /* The color material overwrites the diffuse and ambient color with each vertex color */
+        if (Material->getColorMaterial())
+        {
+            StateCache_.DiffuseColor.invalidate();
+            StateCache_.AmbientColor.invalidate();
+        }
+        
+        /* Alpha function (bitwise OR to update both shadow copies) */
+        const s32 AlphaFunc = GLCompareList[Material->getAlphaMethod()];
+        
+        if ( StateCache_.AlphaFunc.change(AlphaFunc) | StateCache_.AlphaReference.change(Material->getAlphaReference()) )
+            glAlphaFunc(AlphaFunc, Material->getAlphaReference());
     }
     
     /* Depth function */
     if (Material->getDepthBuffer())
     {
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GLCompareList[Material->getDepthMethod()]);
+        changeGlRenderState(StateCache_.DepthTest, GL_DEPTH_TEST, true);
+        
+        const s32 DepthFunc = GLCompareList[Material->getDepthMethod()];
+        if (StateCache_.DepthFunc.change(DepthFunc))
+            glDepthFunc(DepthFunc);
     }
     else
-        glDisable(GL_DEPTH_TEST);
+        changeGlRenderState(StateCache_.DepthTest, GL_DEPTH_TEST, false);
     
     /* Blending function */
     if (Material->getBlending())
     {
-        glEnable(GL_BLEND);
-        glBlendFunc(GLBlendingList[Material->getBlendSource()], GLBlendingList[Material->getBlendTarget()]);
+        changeGlRenderState(StateCache_.Blend, GL_BLEND, true);
+        
+        const s32 BlendSource = GLBlendingList[Material->getBlendSource()];
+        const s32 BlendTarget = GLBlendingList[Material->getBlendTarget()];
+        
+        if ( StateCache_.BlendSource.change(BlendSource) | StateCache_.BlendTarget.change(BlendTarget) )
+            glBlendFunc(BlendSource, BlendTarget);
     }
     else
-        glDisable(GL_BLEND);
+        changeGlRenderState(StateCache_.Blend, GL_BLEND, false);
     
     /* Polygon offset */
     if (Material->getPolygonOffset())
     {
-        glEnable(PolygonOffsetType);
-        glPolygonOffset(Material->getPolygonOffsetFactor(), Material->getPolygonOffsetUnits());
+        changeGlRenderState(StateCache_.PolygonOffset[PolygonOffsetIndex], PolygonOffsetType, true);
+        
+        if ( StateCache_.PolygonOffsetFactor.change(Material->getPolygonOffsetFactor()) |
+             StateCache_.PolygonOffsetUnits.change(Material->getPolygonOffsetUnits()) )
+        {
+            glPolygonOffset(Material->getPolygonOffsetFactor(), Material->getPolygonOffsetUnits());
+        }
     }
     else
-        glDisable(PolygonOffsetType);
+        changeGlRenderState(StateCache_.PolygonOffset[PolygonOffsetIndex], PolygonOffsetType, false);
     
     #ifdef SP_COMPILE_WITH_RENDERSYS_QUERIES
     ++RenderSystem::NumMaterialUpdates_;
@@ -417,6 +463,37 @@ bool OpenGLRenderSystem::setupMaterialStates(const MaterialStates* Material, boo
     return true;
 }
 
+void OpenGLRenderSystem::setRenderState(const video::ERenderStates Type, s32 State)
+{
+    flush2DDrawing();
+    
+    /* Invalidate the shadow copy of the modified state */
+    switch (Type)
+    {
+        case RENDER_SCISSOR:
+            isBatch2DClipping_ = (State != 0); break;
+        case RENDER_BLEND:
+            StateCache_.Blend.invalidate(); break;
+        case RENDER_COLORMATERIAL:
+            StateCache_.ColorMaterial.invalidate();
+            StateCache_.DiffuseColor.invalidate();
+            StateCache_.AmbientColor.invalidate();
+            break;
+        case RENDER_CULLFACE:
+            StateCache_.CullFace.invalidate(); break;
+        case RENDER_DEPTH:
+            StateCache_.DepthTest.invalidate(); break;
+        case RENDER_FOG:
+            StateCache_.Fog.invalidate(); break;
+        case RENDER_LIGHTING:
+            StateCache_.Lighting.invalidate(); break;
+        default:
+            break;
+    }
+    
+    GLFixedFunctionPipeline::setRenderState(Type, State);
+}
+
 void OpenGLRenderSystem::endSceneRendering()
 {
     RenderSystem::endSceneRendering();
@@ -427,6 +504,142 @@ void OpenGLRenderSystem::endSceneRendering()
     PrevMaterial_ = 0;
 }
 
+void OpenGLRenderSystem::endDrawing2D()
+{
+    flush2DDrawing();
+    GLFixedFunctionPipeline::endDrawing2D();
+}
+
+void OpenGLRenderSystem::invalidateRenderStates()
+{
+    RenderSystem::invalidateRenderStates();
+    StateCache_.invalidate();
+}
+
+void OpenGLRenderSystem::flush2DDrawing()
+{
+    if (Batch2DVertices_.empty())
+        return;
+    
+    const u32 NumVertices = Batch2DVertices_.size();
+    const u32 DataSize = sizeof(SBatchVertex2D) * NumVertices;
+    const c8* VertexData = reinterpret_cast<const c8*>(&Batch2DVertices_[0]);
+    
+    /* Upload the vertices into the streaming vertex buffer */
+    if (RenderQuery_[RENDERQUERY_HARDWARE_MESHBUFFER])
+    {
+        if (!Batch2DBuffer_.hasBuffer() || DataSize > Batch2DBufferSize_)
+        {
+            /* Create the buffer once and only reallocate its storage when a batch does not fit */
+            Batch2DBuffer_.createBuffer();
+            Batch2DBuffer_.setupBuffer(VertexData, DataSize, HWBUFFER_DYNAMIC);
+            Batch2DBufferSize_ = DataSize;
+        }
+        else
+        {
+            /* Orphan the previous storage, so the driver does not wait for the last draw call */
+            Batch2DBuffer_.setupBuffer(0, Batch2DBufferSize_, HWBUFFER_DYNAMIC);
+            Batch2DBuffer_.setupBufferSub(VertexData, DataSize);
+        }
+        VertexData = 0;
+    }
+    
+    /* Set the vertex pointers */
+    glVertexPointer(2, GL_FLOAT, sizeof(SBatchVertex2D), VertexData);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(SBatchVertex2D), VertexData + 8);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(SBatchVertex2D), VertexData + 16);
+    
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    
+    /* Bind the texture and draw all quads at once */
+    if (Batch2DTexture_)
+        Batch2DTexture_->bind(0);
+    if (isBatch2DAdditive_)
+    {
+        /*
+        The current blend function is restored from the state cache after the additive batch.
+        It is only queried from GL when the cache has been invalidated.
+        */
+        if (!StateCache_.BlendSource.isValid || !StateCache_.BlendTarget.isValid)
+        {
+            GLint BlendSource = 0, BlendTarget = 0;
+            glGetIntegerv(GL_BLEND_SRC, &BlendSource);
+            glGetIntegerv(GL_BLEND_DST, &BlendTarget);
+            StateCache_.BlendSource.change(BlendSource);
+            StateCache_.BlendTarget.change(BlendTarget);
+        }
+        glBlendFunc(GLBlendingList[BLEND_SRCALPHA], GLBlendingList[BLEND_ONE]);
+    }
+    
+    glDrawArrays(GL_QUADS, 0, NumVertices);
+    
+    if (isBatch2DAdditive_)
+        glBlendFunc(StateCache_.BlendSource.State, StateCache_.BlendTarget.State);
+    if (Batch2DTexture_)
+        Batch2DTexture_->unbind(0);
+    
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_COLOR_ARRAY);
+    
+    if (RenderQuery_[RENDERQUERY_HARDWARE_MESHBUFFER])
+        Batch2DBuffer_.unbind();
+    
+    #ifdef SP_COMPILE_WITH_RENDERSYS_QUERIES
+    ++RenderSystem::NumDrawCalls_;
+    #endif
+    
+    /* Reset the batch (the vertex container keeps its capacity) */
+    Batch2DVertices_.clear();
+    Batch2DTexture_     = 0;
+    isBatch2DAdditive_  = false;
+}
+
+void OpenGLRenderSystem::setBlending(const EBlendingTypes SourceBlend, const EBlendingTypes DestBlend)
+{
+    flush2DDrawing();
+    GLBasePipeline::setBlending(SourceBlend, DestBlend);
+    
+    /* Keep the shadow copies up to date, so additive 2D batches can restore the blend function without a query */
+    StateCache_.BlendSource.change(GLBlendingList[SourceBlend]);
+    StateCache_.BlendTarget.change(GLBlendingList[DestBlend]);
+}
+
+void OpenGLRenderSystem::setClipping(bool Enable, const dim::point2di &Position, const dim::size2di &Size)
+{
+    /* Only flush the batch when the clipping rectangle really changes */
+    if ( Enable != isBatch2DClipping_ || ( Enable && ( Position != Batch2DClipPos_ || Size != Batch2DClipSize_ ) ) )
+        flush2DDrawing();
+    
+    isBatch2DClipping_  = Enable;
+    Batch2DClipPos_     = Position;
+    Batch2DClipSize_    = Size;
+    
+    GLBasePipeline::setClipping(Enable, Position, Size);
+}
+
+void OpenGLRenderSystem::setViewport(const dim::point2di &Position, const dim::size2di &Size)
+{
+    /* The queued quads must be drawn with the previous viewport */
+    flush2DDrawing();
+    GLBasePipeline::setViewport(Position, Size);
+}
+
+void OpenGLRenderSystem::setLogicOp(const ELogicOperations Op)
+{
+    flush2DDrawing();
+    GLFixedFunctionPipeline::setLogicOp(Op);
+}
+
+bool OpenGLRenderSystem::setRenderTarget(Texture* Target)
+{
+    if (Target != RenderTarget_)
+        flush2DDrawing();
+    return GLProgrammableFunctionPipeline::setRenderTarget(Target);
+}
+
 
 /*
  * ======= Hardware mesh buffers =======
@@ -800,18 +1013,6 @@ void OpenGLRenderSystem::draw2DImage(
     if (!Tex)
         return;
     
-    #ifndef __DRAW2DARRAYS__
-    /* Coloring */
-    glColor4ub(Color.Red, Color.Green, Color.Blue, Color.Alpha);
-    #endif
-    
-    setup2DDrawing();
-    
-    /* Binding the texture */
-    Tex->bind(0);
-    
-    #ifdef __DRAW2DARRAYS__
-    
     const dim::rect2df Rect(
         static_cast<f32>(Position.X),
         static_cast<f32>(Position.Y),
@@ -819,36 +1020,12 @@ void OpenGLRenderSystem::draw2DImage(
         static_cast<f32>(Position.Y + Tex->getSize().Height)
     );
     
-    Vertices2D_[0] = scene::SPrimitiveVertex2D(Rect.Left    , Rect.Top      , 0.0f, 0.0f, Color);
-    Vertices2D_[1] = scene::SPrimitiveVertex2D(Rect.Right   , Rect.Top      , 1.0f, 0.0f, Color);
-    Vertices2D_[2] = scene::SPrimitiveVertex2D(Rect.Right   , Rect.Bottom   , 1.0f, 1.0f, Color);
-    Vertices2D_[3] = scene::SPrimitiveVertex2D(Rect.Left    , Rect.Bottom   , 0.0f, 1.0f, Color);
+    SBatchVertex2D* Vertices = allocBatchQuad2D(Tex);
     
-    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-    
-    #else
-    
-    /* Drawing the quad */
-    glBegin(GL_QUADS);
-    {
-        glTexCoord2i(0, 0);
-        glVertex2i(Position.X, Position.Y);
-        
-        glTexCoord2i(1, 0);
-        glVertex2i(Position.X + Tex->getSize().Width, Position.Y);
-        
-        glTexCoord2i(1, 1);
-        glVertex2i(Position.X + Tex->getSize().Width, Position.Y + Tex->getSize().Height);
-        
-        glTexCoord2i(0, 1);
-        glVertex2i(Position.X, Position.Y + Tex->getSize().Height);
-    }
-    glEnd();
-    
-    #endif
-    
-    /* Back settings */
-    Tex->unbind(0);
+    Vertices[0].setup(Rect.Left,    Rect.Top,       0.0f, 0.0f, Color);
+    Vertices[1].setup(Rect.Right,   Rect.Top,       1.0f, 0.0f, Color);
+    Vertices[2].setup(Rect.Right,   Rect.Bottom,    1.0f, 1.0f, Color);
+    Vertices[3].setup(Rect.Left,    Rect.Bottom,    0.0f, 1.0f, Color);
 }
 
 void OpenGLRenderSystem::draw2DImage(
@@ -857,53 +1034,17 @@ void OpenGLRenderSystem::draw2DImage(
     if (!Tex)
         return;
     
-    #ifndef __DRAW2DARRAYS__
-    /* Coloring */
-    glColor4ub(Color.Red, Color.Green, Color.Blue, Color.Alpha);
-    #endif
-    
-    setup2DDrawing();
-    
-    /* Binding the texture */
-    Tex->bind(0);
-    
-    #ifdef __DRAW2DARRAYS__
-    
     dim::rect2df Rect(Position.cast<f32>());
     
     Rect.Right += Rect.Left;
     Rect.Bottom += Rect.Top;
     
-    Vertices2D_[0] = scene::SPrimitiveVertex2D(Rect.Left,   Rect.Top,       Clipping.Left,  Clipping.Top,       Color);
-    Vertices2D_[1] = scene::SPrimitiveVertex2D(Rect.Right,  Rect.Top,       Clipping.Right, Clipping.Top,       Color);
-    Vertices2D_[2] = scene::SPrimitiveVertex2D(Rect.Right,  Rect.Bottom,    Clipping.Right, Clipping.Bottom,    Color);
-    Vertices2D_[3] = scene::SPrimitiveVertex2D(Rect.Left,   Rect.Bottom,    Clipping.Left,  Clipping.Bottom,    Color);
-    
-    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-    
-    #else
-    
-    /* Drawing the quad */
-    glBegin(GL_QUADS);
-    {
-        glTexCoord2f(Clipping.Left, Clipping.Top);
-        glVertex2i(Position.Left, Position.Top);
-        
-        glTexCoord2f(Clipping.Right, Clipping.Top);
-        glVertex2i(Position.Left + Position.Right, Position.Top);
-        
-        glTexCoord2f(Clipping.Right, Clipping.Bottom);
-        glVertex2i(Position.Left + Position.Right, Position.Top + Position.Bottom);
-        
-        glTexCoord2f(Clipping.Left, Clipping.Bottom);
-        glVertex2i(Position.Left, Position.Top + Position.Bottom);
-    }
-    glEnd();
-    
-    #endif
+    SBatchVertex2D* Vertices = allocBatchQuad2D(Tex);
     
-    /* Back settings */
-    Tex->unbind(0);
+    Vertices[0].setup(Rect.Left,    Rect.Top,       Clipping.Left,  Clipping.Top,       Color);
+    Vertices[1].setup(Rect.Right,   Rect.Top,       Clipping.Right, Clipping.Top,       Color);
+    Vertices[2].setup(Rect.Right,   Rect.Bottom,    Clipping.Right, Clipping.Bottom,    Color);
+    Vertices[3].setup(Rect.Left,    Rect.Bottom,    Clipping.Left,  Clipping.Bottom,    Color);
 }
 
 void OpenGLRenderSystem::draw2DImage(
@@ -912,80 +1053,19 @@ void OpenGLRenderSystem::draw2DImage(
     if (!Tex)
         return;
     
-    #if 0
-    #ifndef __DRAW2DARRAYS__
-    /* Temporary variables */
-    Radius *= math::SQRT2F;
-    
-    const dim::point2df lefttopPos      (math::Sin(Rotation -  45)*Radius + Position.X, -math::Cos(Rotation -  45)*Radius + Position.Y);
-    const dim::point2df righttopPos     (math::Sin(Rotation +  45)*Radius + Position.X, -math::Cos(Rotation +  45)*Radius + Position.Y);
-    const dim::point2df rightbottomPos  (math::Sin(Rotation + 135)*Radius + Position.X, -math::Cos(Rotation + 135)*Radius + Position.Y);
-    const dim::point2df leftbottomPos   (math::Sin(Rotation - 135)*Radius + Position.X, -math::Cos(Rotation - 135)*Radius + Position.Y);
-    #endif
-    #endif
-    
-    #ifndef __DRAW2DARRAYS__
-    /* Coloring */
-    glColor4ub(Color.Red, Color.Green, Color.Blue, Color.Alpha);
-    #endif
-    
-    setup2DDrawing();
-    
-    /* Setup transformation */
-    glTranslatef(static_cast<f32>(Position.X), static_cast<f32>(Position.Y), 0.0f);
-    glRotatef(Rotation, 0.0f, 0.0f, 1.0f);
-    
-    /* Binding the texture */
-    Tex->bind(0);
-    
-    #ifdef __DRAW2DARRAYS__
-    
-    Vertices2D_[0] = scene::SPrimitiveVertex2D(-Radius, -Radius, 0.0f, 0.0f, Color);
-    Vertices2D_[1] = scene::SPrimitiveVertex2D( Radius, -Radius, 1.0f, 0.0f, Color);
-    Vertices2D_[2] = scene::SPrimitiveVertex2D( Radius,  Radius, 1.0f, 1.0f, Color);
-    Vertices2D_[3] = scene::SPrimitiveVertex2D(-Radius,  Radius, 0.0f, 1.0f, Color);
+    /* Rotate the quad corners on the CPU (equivalent to glTranslatef/glRotatef) */
+    const f32 X = static_cast<f32>(Position.X);
+    const f32 Y = static_cast<f32>(Position.Y);
     
-    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    const f32 RotSin = math::Sin(Rotation) * Radius;
+    const f32 RotCos = math::Cos(Rotation) * Radius;
     
-    #else
+    SBatchVertex2D* Vertices = allocBatchQuad2D(Tex);
     
-    /* Drawing the quad */
-    glBegin(GL_QUADS);
-    {
-        #if 0
-        glTexCoord2i(0, 0);
-        glVertex2f(lefttopPos.X, lefttopPos.Y);
-        
-        glTexCoord2i(1, 0);
-        glVertex2f(righttopPos.X, righttopPos.Y);
-        
-        glTexCoord2i(1, 1);
-        glVertex2f(rightbottomPos.X, rightbottomPos.Y);
-        
-        glTexCoord2i(0, 1);
-        glVertex2f(leftbottomPos.X, leftbottomPos.Y);
-        #else
-        glTexCoord2i(0, 0);
-        glVertex2f(-Radius, -Radius);
-        
-        glTexCoord2i(1, 0);
-        glVertex2f(Radius, -Radius);
-        
-        glTexCoord2i(1, 1);
-        glVertex2f(Radius, Radius);
-        
-        glTexCoord2i(0, 1);
-        glVertex2f(-Radius, Radius);
-        #endif
-    }
-    glEnd();
-    
-    #endif
-    
-    glLoadIdentity();
-    
-    /* Back settings */
-    Tex->unbind(0);
+    Vertices[0].setup(X - RotCos + RotSin, Y - RotSin - RotCos, 0.0f, 0.0f, Color);
+    Vertices[1].setup(X + RotCos + RotSin, Y + RotSin - RotCos, 1.0f, 0.0f, Color);
+    Vertices[2].setup(X + RotCos - RotSin, Y + RotSin + RotCos, 1.0f, 1.0f, Color);
+    Vertices[3].setup(X - RotCos - RotSin, Y - RotSin + RotCos, 0.0f, 1.0f, Color);
 }
 
 void OpenGLRenderSystem::draw2DImage(
@@ -1000,47 +1080,12 @@ void OpenGLRenderSystem::draw2DImage(
     if (!Tex)
         return;
     
-    setup2DDrawing();
+    SBatchVertex2D* Vertices = allocBatchQuad2D(Tex);
     
-    /* Texture binding */
-    Tex->bind(0);
-    
-    #ifdef __DRAW2DARRAYS__
-    
-    Vertices2D_[0] = scene::SPrimitiveVertex2D(static_cast<f32>(lefttopPosition.X       ), static_cast<f32>(lefttopPosition.Y       ), lefttopClipping.X    , lefttopClipping.Y     , lefttopColor      );
-    Vertices2D_[1] = scene::SPrimitiveVertex2D(static_cast<f32>(righttopPosition.X      ), static_cast<f32>(righttopPosition.Y      ), righttopClipping.X   , righttopClipping.Y    , righttopColor     );
-    Vertices2D_[2] = scene::SPrimitiveVertex2D(static_cast<f32>(rightbottomPosition.X   ), static_cast<f32>(rightbottomPosition.Y   ), rightbottomClipping.X, rightbottomClipping.Y , rightbottomColor  );
-    Vertices2D_[3] = scene::SPrimitiveVertex2D(static_cast<f32>(leftbottomPosition.X    ), static_cast<f32>(leftbottomPosition.Y    ), leftbottomClipping.X , leftbottomClipping.Y  , leftbottomColor   );
-    
-    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-    
-    #else
-    
-    /* Drawing the quad */
-    glBegin(GL_QUADS);
-    {
-        glColor4ub(lefttopColor.Red, lefttopColor.Green, lefttopColor.Blue, lefttopColor.Alpha);
-        glTexCoord2f(lefttopClipping.X, lefttopClipping.Y);
-        glVertex2i(lefttopPosition.X, lefttopPosition.Y);
-        
-        glColor4ub(righttopColor.Red, righttopColor.Green, righttopColor.Blue, righttopColor.Alpha);
-        glTexCoord2f(righttopClipping.X, righttopClipping.Y);
-        glVertex2i(righttopPosition.X, righttopPosition.Y);
-        
-        glColor4ub(rightbottomColor.Red, rightbottomColor.Green, rightbottomColor.Blue, rightbottomColor.Alpha);
-        glTexCoord2f(rightbottomClipping.X, rightbottomClipping.Y);
-        glVertex2i(rightbottomPosition.X, rightbottomPosition.Y);
-        
-        glColor4ub(leftbottomColor.Red, leftbottomColor.Green, leftbottomColor.Blue, leftbottomColor.Alpha);
-        glTexCoord2f(leftbottomClipping.X, leftbottomClipping.Y);
-        glVertex2i(leftbottomPosition.X, leftbottomPosition.Y);
-    }
-    glEnd();
-    
-    #endif
-    
-    /* Back settings */
-    Tex->unbind(0);
+    Vertices[0].setup(static_cast<f32>(lefttopPosition.X       ), static_cast<f32>(lefttopPosition.Y       ), lefttopClipping.X    , lefttopClipping.Y     , lefttopColor      );
+    Vertices[1].setup(static_cast<f32>(righttopPosition.X      ), static_cast<f32>(righttopPosition.Y      ), righttopClipping.X   , righttopClipping.Y    , righttopColor     );
+    Vertices[2].setup(static_cast<f32>(rightbottomPosition.X   ), static_cast<f32>(rightbottomPosition.Y   ), rightbottomClipping.X, rightbottomClipping.Y , rightbottomColor  );
+    Vertices[3].setup(static_cast<f32>(leftbottomPosition.X    ), static_cast<f32>(leftbottomPosition.Y    ), leftbottomClipping.X , leftbottomClipping.Y  , leftbottomColor   );
 }
 
 
@@ -1057,6 +1102,7 @@ f32 OpenGLRenderSystem::getPixelDepth(const dim::point2di &Position) const
 
 void OpenGLRenderSystem::draw2DPoint(const dim::point2di &Position, const color &Color)
 {
+    flush2DDrawing();
     setup2DDrawing();
     
     glColor4ub(Color.Red, Color.Green, Color.Blue, Color.Alpha);
@@ -1071,17 +1117,9 @@ void OpenGLRenderSystem::draw2DPoint(const dim::point2di &Position, const color
 void OpenGLRenderSystem::draw2DLine(
     const dim::point2di &PositionA, const dim::point2di &PositionB, const color &Color)
 {
+    flush2DDrawing();
     setup2DDrawing();
     
-    #ifdef __DRAW2DARRAYS__
-    
-    Vertices2D_[0] = scene::SPrimitiveVertex2D(static_cast<f32>(PositionA.X), static_cast<f32>(PositionA.Y), 0.0f, 0.0f, Color);
-    Vertices2D_[1] = scene::SPrimitiveVertex2D(static_cast<f32>(PositionB.X), static_cast<f32>(PositionB.Y), 0.0f, 0.0f, Color);
-    
-    glDrawArrays(GL_LINES, 0, 2);
-    
-    #else
-    
     glColor4ub(Color.Red, Color.Green, Color.Blue, Color.Alpha);
     
     glBegin(GL_LINES);
@@ -1090,24 +1128,14 @@ void OpenGLRenderSystem::draw2DLine(
         glVertex2i(PositionB.X, PositionB.Y);
     }
     glEnd();
-    
-    #endif
 }
 
 void OpenGLRenderSystem::draw2DLine(
     const dim::point2di &PositionA, const dim::point2di &PositionB, const color &ColorA, const color &ColorB)
 {
+    flush2DDrawing();
     setup2DDrawing();
     
-    #ifdef __DRAW2DARRAYS__
-    
-    Vertices2D_[0] = scene::SPrimitiveVertex2D(static_cast<f32>(PositionA.X), static_cast<f32>(PositionA.Y), 0.0f, 0.0f, ColorA);
-    Vertices2D_[1] = scene::SPrimitiveVertex2D(static_cast<f32>(PositionB.X), static_cast<f32>(PositionB.Y), 0.0f, 0.0f, ColorB);
-    
-    glDrawArrays(GL_LINES, 0, 2);
-    
-    #else
-    
     glBegin(GL_LINES);
     {
         glColor4ub(ColorA.Red, ColorA.Green, ColorA.Blue, ColorA.Alpha);
@@ -1117,57 +1145,34 @@ void OpenGLRenderSystem::draw2DLine(
         glVertex2i(PositionB.X, PositionB.Y);
     }
     glEnd();
-    
-    #endif
 }
 
 void OpenGLRenderSystem::draw2DRectangle(const dim::rect2di &Rect, const color &Color, bool isSolid)
 {
-    setup2DDrawing();
-    
-    #ifdef __DRAW2DARRAYS__
-    
-    Vertices2D_[0] = scene::SPrimitiveVertex2D(static_cast<f32>(Rect.Left   ), static_cast<f32>(Rect.Top    ), 0.0f, 0.0f, Color);
-    Vertices2D_[1] = scene::SPrimitiveVertex2D(static_cast<f32>(Rect.Right  ), static_cast<f32>(Rect.Top    ), 0.0f, 0.0f, Color);
-    Vertices2D_[2] = scene::SPrimitiveVertex2D(static_cast<f32>(Rect.Right  ), static_cast<f32>(Rect.Bottom ), 0.0f, 0.0f, Color);
-    Vertices2D_[3] = scene::SPrimitiveVertex2D(static_cast<f32>(Rect.Left   ), static_cast<f32>(Rect.Bottom ), 0.0f, 0.0f, Color);
-    
-    glDrawArrays(isSolid ? GL_QUADS : GL_LINE_LOOP, 0, 4);
-    
-    #else
-    
-    glColor4ub(Color.Red, Color.Green, Color.Blue, Color.Alpha);
-    
-    glBegin(isSolid ? GL_QUADS : GL_LINE_LOOP);
-    {
-        glVertex2i(Rect.Left, Rect.Top);
-        glVertex2i(Rect.Right, Rect.Top);
-        glVertex2i(Rect.Right, Rect.Bottom);
-        glVertex2i(Rect.Left, Rect.Bottom);
-    }
-    glEnd();
-    
-    #endif
+    draw2DRectangle(Rect, Color, Color, Color, Color, isSolid);
 }
 
 void OpenGLRenderSystem::draw2DRectangle(
     const dim::rect2di &Rect, const color &lefttopColor, const color &righttopColor,
     const color &rightbottomColor, const color &leftbottomColor, bool isSolid)
 {
-    setup2DDrawing();
-    
-    #ifdef __DRAW2DARRAYS__
-    
-    Vertices2D_[0] = scene::SPrimitiveVertex2D(static_cast<f32>(Rect.Left   ), static_cast<f32>(Rect.Top    ), 0.0f, 0.0f, lefttopColor      );
-    Vertices2D_[1] = scene::SPrimitiveVertex2D(static_cast<f32>(Rect.Right  ), static_cast<f32>(Rect.Top    ), 0.0f, 0.0f, righttopColor     );
-    Vertices2D_[2] = scene::SPrimitiveVertex2D(static_cast<f32>(Rect.Right  ), static_cast<f32>(Rect.Bottom ), 0.0f, 0.0f, rightbottomColor  );
-    Vertices2D_[3] = scene::SPrimitiveVertex2D(static_cast<f32>(Rect.Left   ), static_cast<f32>(Rect.Bottom ), 0.0f, 0.0f, leftbottomColor   );
-    
-    glDrawArrays(isSolid ? GL_QUADS : GL_LINE_LOOP, 0, 4);
+    if (isSolid)
+    {
+        /* Solid rectangles are collected in the 2D drawing batch */
+        SBatchVertex2D* Vertices = allocBatchQuad2D(0);
+        
+        Vertices[0].setup(static_cast<f32>(Rect.Left ), static_cast<f32>(Rect.Top   ), 0.0f, 0.0f, lefttopColor      );
+        Vertices[1].setup(static_cast<f32>(Rect.Right), static_cast<f32>(Rect.Top   ), 0.0f, 0.0f, righttopColor     );
+        Vertices[2].setup(static_cast<f32>(Rect.Right), static_cast<f32>(Rect.Bottom), 0.0f, 0.0f, rightbottomColor  );
+        Vertices[3].setup(static_cast<f32>(Rect.Left ), static_cast<f32>(Rect.Bottom), 0.0f, 0.0f, leftbottomColor   );
+        
+        return;
+    }
     
-    #else
+    flush2DDrawing();
+    setup2DDrawing();
     
-    glBegin(isSolid ? GL_QUADS : GL_LINE_LOOP);
+    glBegin(GL_LINE_LOOP);
     {
         glColor4ub(lefttopColor.Red, lefttopColor.Green, lefttopColor.Blue, lefttopColor.Alpha);
         glVertex2i(Rect.Left, Rect.Top);
@@ -1182,8 +1187,6 @@ void OpenGLRenderSystem::draw2DRectangle(
         glVertex2i(Rect.Left, Rect.Bottom);
     }
     glEnd();
-    
-    #endif
 }
 
 
@@ -1197,6 +1200,7 @@ void OpenGLRenderSystem::draw2DPolygon(
     if (!VerticesList || !Count)
         return;
     
+    flush2DDrawing();
     setup2DDrawing();
     
     /* Set the vertex pointers */
@@ -1216,6 +1220,25 @@ void OpenGLRenderSystem::draw2DPolygon(
     glDisableClientState(GL_COLOR_ARRAY);
 }
 
+void OpenGLRenderSystem::draw2DPolygonImage(
+    const ERenderPrimitives Type, Texture* Tex, const scene::SPrimitiveVertex2D* VerticesList, u32 Count)
+{
+    flush2DDrawing();
+    GLFixedFunctionPipeline::draw2DPolygonImage(Type, Tex, VerticesList, Count);
+}
+
+Texture* OpenGLRenderSystem::createScreenShot(const dim::point2di &Position, dim::size2di Size)
+{
+    flush2DDrawing();
+    return GLFixedFunctionPipeline::createScreenShot(Position, Size);
+}
+
+void OpenGLRenderSystem::createScreenShot(Texture* Tex, const dim::point2di &Position)
+{
+    flush2DDrawing();
+    GLFixedFunctionPipeline::createScreenShot(Tex, Position);
+}
+
 
 /*
  * ======= 3D drawing functions =======
@@ -1446,9 +1469,14 @@ void OpenGLRenderSystem::drawBitmapFont(
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
     
-    glEnable(GL_COLOR_MATERIAL);
+    /* Change the cached states through their shadow copies and let the next material compare against them again */
+    changeGlRenderState(StateCache_.ColorMaterial, GL_COLOR_MATERIAL, true);
+    changeGlRenderState(StateCache_.PolygonOffset[2], GL_POLYGON_OFFSET_FILL, false);
     glDisable(GL_TEXTURE_2D);
-    glDisable(GL_POLYGON_OFFSET_FILL);
+    
+    StateCache_.DiffuseColor.invalidate();
+    StateCache_.AmbientColor.invalidate();
+    PrevMaterial_ = 0;
     
     /* Coloring (before loacting raster position) */
     glColor4ub(Color.Red, Color.Green, Color.Blue, Color.Alpha);
@@ -1475,6 +1503,77 @@ void OpenGLRenderSystem::drawBitmapFont(
     glPopAttrib();
 }
 
+void OpenGLRenderSystem::drawTexturedFont(
+    const Font* FontObj, const dim::point2di &Position, const io::stringc &Text, const color &Color)
+{
+    /* Check parameters */
+    const video::Texture* Tex = FontObj->getTexture();
+    
+    const ImageBuffer* ImgBuffer = Tex->getImageBuffer();
+    
+    if (!ImgBuffer || Text.empty())
+        return;
+    
+    const std::vector<SFontGlyph>& GlyphList = FontObj->getGlyphList();
+    
+    const f32 InvTexWidth   = 1.0f / static_cast<f32>(Tex->getSize().Width);
+    const f32 InvTexHeight  = 1.0f / static_cast<f32>(Tex->getSize().Height);
+    
+    /* The glyph quads are transformed on the CPU so that the whole text can be batched */
+    const dim::point2df Origin(static_cast<f32>(Position.X), static_cast<f32>(Position.Y));
+    const bool isTransformed = !FontTransform_.isIdentity();
+    
+    SBatchVertex2D* Vertices = allocBatchQuad2D(Tex, ImgBuffer->getFormatSize() < 4, Text.size());
+    
+    u32 NumQuads = 0;
+    f32 Move = 0.0f;
+    
+    for (u32 i = 0, c = Text.size(); i < c; ++i)
+    {
+        /* Get character glyph from string */
+        const SFontGlyph& Glyph = GlyphList[static_cast<u8>(Text[i])];
+        
+        /* Offset movement */
+        Move += static_cast<f32>(Glyph.StartOffset);
+        
+        if (Glyph.Rect.Right > Glyph.Rect.Left && Glyph.Rect.Bottom > Glyph.Rect.Top)
+        {
+            /* Setup glyph quad */
+            dim::point2df Corners[4] =
+            {
+                dim::point2df(Move, 0.0f),
+                dim::point2df(Move + static_cast<f32>(Glyph.Rect.Right - Glyph.Rect.Left), 0.0f),
+                dim::point2df(Move + static_cast<f32>(Glyph.Rect.Right - Glyph.Rect.Left), static_cast<f32>(Glyph.Rect.Bottom - Glyph.Rect.Top)),
+                dim::point2df(Move, static_cast<f32>(Glyph.Rect.Bottom - Glyph.Rect.Top))
+            };
+            
+            for (u32 j = 0; j < 4; ++j)
+                Corners[j] = (isTransformed ? FontTransform_ * Corners[j] : Corners[j]) + Origin;
+            
+            const dim::rect2df Mapping(
+                static_cast<f32>(Glyph.Rect.Left    ) * InvTexWidth,
+                static_cast<f32>(Glyph.Rect.Top     ) * InvTexHeight,
+                static_cast<f32>(Glyph.Rect.Right   ) * InvTexWidth,
+                static_cast<f32>(Glyph.Rect.Bottom  ) * InvTexHeight
+            );
+            
+            Vertices[0].setup(Corners[0].X, Corners[0].Y, Mapping.Left,  Mapping.Top,    Color);
+            Vertices[1].setup(Corners[1].X, Corners[1].Y, Mapping.Right, Mapping.Top,    Color);
+            Vertices[2].setup(Corners[2].X, Corners[2].Y, Mapping.Right, Mapping.Bottom, Color);
+            Vertices[3].setup(Corners[3].X, Corners[3].Y, Mapping.Left,  Mapping.Bottom, Color);
+            
+            Vertices += 4;
+            ++NumQuads;
+        }
+        
+        /* Character width and white space movement */
+        Move += static_cast<f32>(Glyph.DrawnWidth + Glyph.WhiteSpace);
+    }
+    
+    /* Remove the quads of empty glyphs (e.g. white spaces) */
+    Batch2DVertices_.resize(Batch2DVertices_.size() - (Text.size() - NumQuads)*4);
+}
+
 void OpenGLRenderSystem::draw3DText(
     Font* FontObject, const dim::matrix4f &Transformation, const io::stringc &Text, const color &Color)
 {
@@ -1642,6 +1741,14 @@ void OpenGLRenderSystem::loadExtensions()
     /* Load image 3D procs */
     if (!queryVideoSupport(VIDEOSUPPORT_VOLUMETRIC_TEXTURE) || !GLExtensionLoader::loadTex3DProcs())
         io::Log::message("Volumetric textures are not supported");
+    
+    /* Load texture compression procs */
+    if (!RenderQuery_[RENDERQUERY_TEXTURE_COMPRESSION] || !GLExtensionLoader::loadTexCompressionProcs())
+    {
+        io::Log::message("Texture compression is not supported");
+        RenderQuery_[RENDERQUERY_TEXTURE_COMPRESSION    ] = false;
+        RenderQuery_[RENDERQUERY_TEXTURE_COMPRESSION_RG ] = false;
+    }
 }
 
 void OpenGLRenderSystem::defaultTextureGenMode()
@@ -1876,6 +1983,53 @@ void OpenGLRenderSystem::drawPrimitiveList(
     }
 }
 
+OpenGLRenderSystem::SBatchVertex2D* OpenGLRenderSystem::allocBatchQuad2D(const Texture* Tex, bool isAdditive, u32 NumQuads)
+{
+    setup2DDrawing();
+    
+    /* Flush the batch when the new quads need another texture or blending */
+    if (!Batch2DVertices_.empty() && ( Batch2DTexture_ != Tex || isBatch2DAdditive_ != isAdditive ))
+        flush2DDrawing();
+    
+    Batch2DTexture_     = Tex;
+    isBatch2DAdditive_  = isAdditive;
+    
+    /* Append the new quads */
+    const u32 Offset = Batch2DVertices_.size();
+    Batch2DVertices_.resize(Offset + NumQuads*4);
+    
+    return &Batch2DVertices_[Offset];
+}
+
+void OpenGLRenderSystem::changeGlPolygonMode(GLenum Face, GLenum Mode)
+{
+    /* Check both faces separately, because the materials set them independently */
+    const bool isFront  = (Face != GL_BACK  && StateCache_.PolygonModeFront.change(Mode));
+    const bool isBack   = (Face != GL_FRONT && StateCache_.PolygonModeBack.change(Mode));
+    
+    if (isFront && isBack)
+        glPolygonMode(GL_FRONT_AND_BACK, Mode);
+    else if (isFront)
+        glPolygonMode(GL_FRONT, Mode);
+    else if (isBack)
+        glPolygonMode(GL_BACK, Mode);
+}
+
+void OpenGLRenderSystem::changeGlMaterialColor(SStateCache<color> &Cache, GLenum Type, const color &Color)
+{
+    if (Cache.change(Color))
+    {
+        Color.getFloatArray(TempColor_);
+        glMaterialfv(GL_FRONT_AND_BACK, Type, TempColor_);
+    }
+}
+
+void OpenGLRenderSystem::changeGlRenderState(SStateCache<bool> &Cache, GLenum Mode, bool Enable)
+{
+    if (Cache.change(Enable))
+        setGlRenderState(Mode, Enable);
+}
+
 GLenum OpenGLRenderSystem::getGL3TexFormat(const EHWTextureFormats HWTexFormat, const EPixelFormats PixelFormat)
 {
     switch (HWTexFormat)
@@ -1989,6 +2143,44 @@ GLenum OpenGLRenderSystem::getGL3TexFormat(const EHWTextureFormats HWTexFormat,
 }
 
 
+/*
+ * SMaterialStateCache structure
+ */
+
+void OpenGLRenderSystem::SMaterialStateCache::invalidate()
+{
+    CullFace            .invalidate();
+    CullMode            .invalidate();
+    PolygonModeFront    .invalidate();
+    PolygonModeBack     .invalidate();
+    
+    Fog                 .invalidate();
+    ColorMaterial       .invalidate();
+    Lighting            .invalidate();
+    LightModelTwoSide   .invalidate();
+    Shininess           .invalidate();
+    DiffuseColor        .invalidate();
+    AmbientColor        .invalidate();
+    SpecularColor       .invalidate();
+    EmissionColor       .invalidate();
+    
+    AlphaFunc           .invalidate();
+    AlphaReference      .invalidate();
+    
+    DepthTest           .invalidate();
+    DepthFunc           .invalidate();
+    
+    Blend               .invalidate();
+    BlendSource         .invalidate();
+    BlendTarget         .invalidate();
+    
+    for (u32 i = 0; i < 3; ++i)
+        PolygonOffset[i].invalidate();
+    PolygonOffsetFactor .invalidate();
+    PolygonOffsetUnits  .invalidate();
+}
+
+
 } // /namespace video
 
 } // /namespace sp
@@ -17,6 +17,9 @@
 #include "RenderSystem/OpenGL/spOpenGLPipelineFixed.hpp"
 #include "RenderSystem/OpenGL/spOpenGLPipelineProgrammable.hpp"
 #include "RenderSystem/OpenGL/spOpenGLTexture.hpp"
+#include "RenderSystem/OpenGL/spOpenGLHardwareBuffer.hpp"
+
+#include <vector>
 
 
 namespace sp
@@ -57,10 +60,33 @@ class SP_EXPORT OpenGLRenderSystem : public GLFixedFunctionPipeline, public GLPr
         
         /* === Rendering functions === */
         
+        void clearBuffers(const s32 ClearFlags = BUFFER_COLOR | BUFFER_DEPTH);
+        
         bool setupMaterialStates(const MaterialStates* Material, bool Forced = false);
         
+        void setRenderState(const video::ERenderStates Type, s32 State);
+        
         void endSceneRendering();
         
+        void endDrawing2D();
+        
+        void invalidateRenderStates();
+        
+        /**
+        Draws all pending 2D drawing operations. Images, solid rectangles and textured text are collected
+        in a batch. Consecutive operations with the same texture are drawn with a single draw call
+        out of a streaming vertex buffer.
+        */
+        void flush2DDrawing();
+        
+        void setBlending(const EBlendingTypes SourceBlend, const EBlendingTypes DestBlend);
+        void setClipping(bool Enable, const dim::point2di &Position, const dim::size2di &Size);
+        void setViewport(const dim::point2di &Position, const dim::size2di &Size);
+        
+        void setLogicOp(const ELogicOperations Op);
+        
+        bool setRenderTarget(Texture* Target);
+        
         /* === Hardware mesh buffers === */
         
         bool bindMeshBuffer(const MeshBuffer* Buffer);
@@ -144,6 +170,12 @@ class SP_EXPORT OpenGLRenderSystem : public GLFixedFunctionPipeline, public GLPr
         void draw2DPolygon(
             const ERenderPrimitives Type, const scene::SPrimitiveVertex2D* VerticesList, u32 Count
         );
+        void draw2DPolygonImage(
+            const ERenderPrimitives Type, Texture* Tex, const scene::SPrimitiveVertex2D* VerticesList, u32 Count
+        );
+        
+        Texture* createScreenShot(const dim::point2di &Position = 0, dim::size2di Size = 0);
+        void createScreenShot(Texture* Tex, const dim::point2di &Position = 0);
         
         /* === 3D drawing functions === */
         
@@ -187,6 +219,63 @@ class SP_EXPORT OpenGLRenderSystem : public GLFixedFunctionPipeline, public GLPr
         };
         #endif
         
+        //! Vertex layout of the 2D drawing batch (20 bytes).
+        struct SBatchVertex2D
+        {
+            inline void setup(f32 PosX, f32 PosY, f32 TexU, f32 TexV, const color &Clr)
+            {
+                X = PosX;
+                Y = PosY;
+                U = TexU;
+                V = TexV;
+                Color[0] = Clr.Red;
+                Color[1] = Clr.Green;
+                Color[2] = Clr.Blue;
+                Color[3] = Clr.Alpha;
+            }
+            
+            /* Members */
+            f32 X, Y;
+            f32 U, V;
+            u8 Color[4];
+        };
+        
+        //! Shadow copies of all render states which are changed by "setupMaterialStates".
+        struct SMaterialStateCache
+        {
+            void invalidate();
+            
+            /* Members */
+            SStateCache<bool> CullFace;
+            SStateCache<GLenum> CullMode;
+            SStateCache<GLenum> PolygonModeFront;
+            SStateCache<GLenum> PolygonModeBack;
+            
+            SStateCache<bool> Fog;
+            SStateCache<bool> ColorMaterial;
+            SStateCache<bool> Lighting;
+            SStateCache<s32> LightModelTwoSide;
+            SStateCache<f32> Shininess;
+            SStateCache<color> DiffuseColor;
+            SStateCache<color> AmbientColor;
+            SStateCache<color> SpecularColor;
+            SStateCache<color> EmissionColor;
+            
+            SStateCache<s32> AlphaFunc;
+            SStateCache<f32> AlphaReference;
+            
+            SStateCache<bool> DepthTest;
+            SStateCache<s32> DepthFunc;
+            
+            SStateCache<bool> Blend;
+            SStateCache<s32> BlendSource;
+            SStateCache<s32> BlendTarget;
+            
+            SStateCache<bool> PolygonOffset[3];
+            SStateCache<f32> PolygonOffsetFactor;
+            SStateCache<f32> PolygonOffsetUnits;
+        };
+        
         /* === Functions === */
         
         void deleteFontObjects();
@@ -197,6 +286,19 @@ class SP_EXPORT OpenGLRenderSystem : public GLFixedFunctionPipeline, public GLPr
         void defaultTextureGenMode();
         
         void drawBitmapFont(const Font* FontObj, const dim::point2di &Position, const io::stringc &Text, const color &Color);
+        void drawTexturedFont(const Font* FontObj, const dim::point2di &Position, const io::stringc &Text, const color &Color);
+        
+        /**
+        Returns the vertices of new quads (four vertices per quad) in the 2D drawing batch. The batch is flushed
+        before when the texture or the blending differs from the quads which are already in the batch.
+        */
+        SBatchVertex2D* allocBatchQuad2D(const Texture* Tex, bool isAdditive = false, u32 NumQuads = 1);
+        
+        /* Render state cache */
+        void changeGlPolygonMode(GLenum Face, GLenum Mode);
+        void changeGlMaterialColor(SStateCache<color> &Cache, GLenum Type, const color &Color);
+        
+        static void changeGlRenderState(SStateCache<bool> &Cache, GLenum Mode, bool Enable);
         
         void bindHWMeshBuffer(const MeshBuffer* MeshBuffer);
         void unbindHWMeshBuffer(const MeshBuffer* MeshBuffer);
@@ -219,6 +321,20 @@ class SP_EXPORT OpenGLRenderSystem : public GLFixedFunctionPipeline, public GLPr
         
         const MeshBuffer* PrevBoundMeshBuffer_;
         
+        SMaterialStateCache StateCache_;
+        
+        /* 2D drawing batch */
+        std::vector<SBatchVertex2D> Batch2DVertices_;
+        const Texture* Batch2DTexture_;
+        bool isBatch2DAdditive_;
+        
+        GLHardwareBuffer Batch2DBuffer_;
+        u32 Batch2DBufferSize_;
+        
+        bool isBatch2DClipping_;
+        dim::point2di Batch2DClipPos_;
+        dim::size2di Batch2DClipSize_;
+        
 };
 
 
@@ -53,6 +53,8 @@ OpenGLShaderClass::~OpenGLShaderClass()
 
 void OpenGLShaderClass::bind(const scene::MaterialNode* Object)
 {
+    GlbRenderSys->flush2DDrawing();
+    
     if (ObjectCallback_)
         ObjectCallback_(this, Object);
     GlbRenderSys->setSurfaceCallback(SurfaceCallback_);
@@ -83,6 +85,8 @@ void OpenGLShaderClass::bind(const scene::MaterialNode* Object)
 
 void OpenGLShaderClass::unbind()
 {
+    GlbRenderSys->flush2DDrawing();
+    
     #ifdef SP_COMPILE_WITH_OPENGL
     if (HighLevel_)
     {
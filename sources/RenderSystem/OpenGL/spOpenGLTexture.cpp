@@ -11,6 +11,8 @@
 
 
 #include "Base/spImageManagement.hpp"
+#include "Base/spImageBlockCompression.hpp"
+#include "Base/spProfiler.hpp"
 #include "Platform/spSoftPixelDeviceOS.hpp"
 #include "RenderSystem/OpenGL/spOpenGLFunctionsARB.hpp"
 #include "RenderSystem/OpenGL/spOpenGLRenderSystem.hpp"
@@ -180,6 +182,11 @@ bool OpenGLTexture::shareImageBuffer()
 
 bool OpenGLTexture::updateImageBuffer()
 {
+    SP_PROFILE_COUNTER(io::PROFILERCOUNTER_BUFFER_UPLOADS, 1);
+    
+    /* Draw pending 2D drawings with the previous image */
+    GlbRenderSys->flush2DDrawing();
+    
     /* Update dimension and format */
     const bool ReCreateTexture = (GLDimension_ != GLBasePipeline::getGlTexDimension(Type_));
     
@@ -219,6 +226,12 @@ bool OpenGLTexture::updateImageBuffer(const dim::point2di &Pos, const dim::size2
         return false;
     }
     
+    /* Block compressed textures can only be updated as a whole */
+    if (HWCompression_ != BLOCKCOMPRESSION_NONE)
+        return updateImageBuffer();
+    
+    GlbRenderSys->flush2DDrawing();
+    
     /* Get image buffer area */
     const u32 BufferSize = Size.getArea() * ImageBuffer_->getPixelSize();
     boost::shared_array<c8> Buffer = boost::shared_array<c8>(new c8[BufferSize]);
@@ -297,6 +310,43 @@ void OpenGLTexture::updateHardwareFormats()
             GLType_ = GL_FLOAT;
             break;
     }
+    
+    /* Get GL internal format for block compression */
+    updateHardwareCompression();
+}
+
+void OpenGLTexture::updateHardwareCompression()
+{
+    HWCompression_ = BLOCKCOMPRESSION_NONE;
+    
+    /* Only 2D textures with UBYTE image buffers can be compressed */
+    if ( Compression_ == BLOCKCOMPRESSION_NONE || Type_ != TEXTURE_2D || isRenderTarget_ ||
+         HWFormat_ != HWTEXFORMAT_UBYTE8 || ImageBuffer_->getType() != IMAGEBUFFER_UBYTE ||
+         !ImageBuffer_->getBuffer() || !GlbRenderSys->RenderQuery_[RenderSystem::RENDERQUERY_TEXTURE_COMPRESSION] )
+    {
+        return;
+    }
+    
+    const EBlockCompressionFormats Format = BlockCompression::resolveFormat(Compression_, ImageBuffer_->getFormat());
+    
+    switch (Format)
+    {
+        case BLOCKCOMPRESSION_BC1:
+            GLInternalFormat_ = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            break;
+        case BLOCKCOMPRESSION_BC3:
+            GLInternalFormat_ = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            break;
+        case BLOCKCOMPRESSION_BC5:
+            if (!GlbRenderSys->RenderQuery_[RenderSystem::RENDERQUERY_TEXTURE_COMPRESSION_RG])
+                return;
+            GLInternalFormat_ = GL_COMPRESSED_RG_RGTC2;
+            break;
+        default:
+            return;
+    }
+    
+    HWCompression_ = Format;
 }
 
 void OpenGLTexture::updateHardwareTexture(
@@ -323,10 +373,18 @@ void OpenGLTexture::updateHardwareTexture(
         case TEXTURE_2D_RW:
         case TEXTURE_1D_ARRAY_RW:
         {
-            /* Create 2D texture image */
-            glTexImage2D(
-                GLDimension_, Level, GLInternalFormat_, Size.X, Size.Y, 0, GLFormat_, GLType_, ImageBuffer
-            );
+            if (HWCompression_ != BLOCKCOMPRESSION_NONE && Level == 0 && ImageBuffer)
+            {
+                /* Create block compressed 2D texture image with its MIP-map chain */
+                updateCompressedTexture(dim::size2di(Size.X, Size.Y), static_cast<const u8*>(ImageBuffer));
+            }
+            else
+            {
+                /* Create 2D texture image */
+                glTexImage2D(
+                    GLDimension_, Level, GLInternalFormat_, Size.X, Size.Y, 0, GLFormat_, GLType_, ImageBuffer
+                );
+            }
         }
         break;
         
@@ -393,6 +451,52 @@ void OpenGLTexture::updateHardwareTexture(
     }
 }
 
+void OpenGLTexture::updateCompressedTexture(const dim::size2di &Size, const u8* ImageBuffer)
+{
+    /* MIP-maps are compressed on the CPU as well, thus disable automatic MIP-map generation */
+    glTexParameteri(GLDimension_, GL_GENERATE_MIPMAP, GL_FALSE);
+    
+    /* Use the blocks which have already been compressed on a loader thread if they match */
+    SCompressedImage LocalImage;
+    const SCompressedImage* Image = CompressedImage_;
+    
+    if ( !Image || Image->Format != HWCompression_ || Image->Size != Size ||
+         Image->Levels.empty() || ( getMipMapping() && Image->Levels.size() < 2 && Size != dim::size2di(1) ) )
+    {
+        /* Compress the image and its MIP levels on this thread (or read them from the cache) */
+        BlockCompression::compressMipMaps(
+            ImageBuffer, Size, ImageBuffer_->getFormat(), HWCompression_, LocalImage, getMipMapping(),
+            GlbRenderSys->getTextureCompressionQuality(), GlbRenderSys->getTextureCompressionCache()
+        );
+        Image = &LocalImage;
+    }
+    
+    /* Upload the compressed MIP levels */
+    dim::size2di LevelSize(Size);
+    
+    for (u32 Level = 0; Level < Image->Levels.size(); ++Level)
+    {
+        const std::vector<u8>& BlockBuffer = Image->Levels[Level];
+        
+        if (BlockBuffer.empty())
+            break;
+        
+        glCompressedTexImage2DARB(
+            GLDimension_, Level, GLInternalFormat_, LevelSize.Width, LevelSize.Height, 0,
+            static_cast<GLsizei>(BlockBuffer.size()), &BlockBuffer[0]
+        );
+        
+        if (!getMipMapping())
+            break;
+        
+        LevelSize.Width     = math::Max(1, LevelSize.Width  / 2);
+        LevelSize.Height    = math::Max(1, LevelSize.Height / 2);
+    }
+    
+    if (Image->Levels.empty() || Image->Levels[0].empty())
+        io::Log::error("Could not compress texture image");
+}
+
 void OpenGLTexture::updateHardwareTextureArea(
     const dim::vector3di &Pos, const dim::vector3di &Size, const void* ImageBuffer, s32 Level)
 {
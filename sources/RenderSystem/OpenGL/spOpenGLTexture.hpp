@@ -56,9 +56,11 @@ class SP_EXPORT OpenGLTexture : public GLTextureBase, public GLFrameBufferObject
         void updateFormatAndDimension();
         
         void updateHardwareFormats();
+        void updateHardwareCompression();
         void updateHardwareTexture(
             dim::vector3di Size, const u32 PixelSize, const void* ImageBuffer, s32 Level = 0
         );
+        void updateCompressedTexture(const dim::size2di &Size, const u8* ImageBuffer);
         void updateHardwareTextureArea(
             const dim::vector3di &Pos, const dim::vector3di &Size, const void* ImageBuffer, s32 Level = 0
         );
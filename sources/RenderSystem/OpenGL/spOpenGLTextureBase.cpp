@@ -170,6 +170,8 @@ void GLTextureBase::bind(s32 Level) const
     
     if (GlbRenderSys->getRendererType() != RENDERER_OPENGLES2 && Type_ <= TEXTURE_CUBEMAP)
         glEnable(GLDimension_);
+    
+    markUsed();
 }
 
 void GLTextureBase::unbind(s32 Level) const
@@ -211,6 +213,9 @@ void GLTextureBase::deleteHWTexture()
 {
     if (OrigID_)
     {
+        /* Pending 2D drawings may still refer to this texture */
+        GlbRenderSys->flush2DDrawing();
+        
         /* Delete OpenGL hardware texture */
         if (glIsTexture(getTexID()))
             glDeleteTextures(1, getTexPtrID());
@@ -11,6 +11,7 @@
 
 
 #include "Base/spImageManagement.hpp"
+#include "Base/spProfiler.hpp"
 //#include "Platform/spSoftPixelDeviceOS.hpp"
 #include "RenderSystem/OpenGLES/spOpenGLESFunctionsARB.hpp"
 #include "RenderSystem/OpenGLES/spOpenGLES1RenderSystem.hpp"
@@ -49,6 +50,8 @@ OpenGLES1Texture::~OpenGLES1Texture()
 
 bool OpenGLES1Texture::updateImageBuffer()
 {
+    SP_PROFILE_COUNTER(io::PROFILERCOUNTER_BUFFER_UPLOADS, 1);
+    
     /* Update dimension and format */
     const bool ReCreateTexture = (GLDimension_ != GLBasePipeline::getGlTexDimension(Type_));
     
@@ -11,6 +11,7 @@
 
 
 #include "Base/spImageManagement.hpp"
+#include "Base/spProfiler.hpp"
 //#include "Platform/spSoftPixelDeviceOS.hpp"
 #include "RenderSystem/OpenGLES/spOpenGLESFunctionsARB.hpp"
 #include "RenderSystem/OpenGLES/spOpenGLES2RenderSystem.hpp"
@@ -53,6 +54,8 @@ OpenGLES2Texture::~OpenGLES2Texture()
 
 bool OpenGLES2Texture::updateImageBuffer()
 {
+    SP_PROFILE_COUNTER(io::PROFILERCOUNTER_BUFFER_UPLOADS, 1);
+    
     /* Update dimension and format */
     const bool ReCreateTexture = (GLDimension_ != GLBasePipeline::getGlTexDimension(Type_));
     
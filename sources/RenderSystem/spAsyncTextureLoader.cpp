@@ -0,0 +1,427 @@
+/*
+ * Asynchronous texture loader file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "RenderSystem/spAsyncTextureLoader.hpp"
+#include "RenderSystem/spRenderSystem.hpp"
+#include "RenderSystem/spTextureBase.hpp"
+#include "Base/spImageBufferUByte.hpp"
+#include "Base/spImageBlockCompression.hpp"
+#include "Base/spInputOutputFileSystem.hpp"
+#include "Base/spInputOutputLog.hpp"
+#include "Base/spMemoryManagement.hpp"
+#include "Base/spTimer.hpp"
+
+#include <boost/foreach.hpp>
+
+
+namespace sp
+{
+
+extern video::RenderSystem* GlbRenderSys;
+
+namespace video
+{
+
+
+/*
+ * Internal functions
+ */
+
+THREAD_PROC(AsyncTextureLoaderThreadProc)
+{
+    AsyncTextureLoader* Loader = static_cast<AsyncTextureLoader*>(Arguments);
+    
+    while (1)
+    {
+        /* Sleep until a texture has been requested (canceled requests leave the queue empty) */
+        Loader->RequestSignal_.wait();
+        
+        if (!Loader->isRunning_)
+            break;
+        
+        AsyncTextureLoader::SRequest* Request = Loader->popRequest();
+        
+        if (Request)
+            Loader->loadRequest(Request);
+    }
+    
+    Loader->ExitSignal_.post();
+    
+    return 0;
+}
+
+
+/*
+ * SRequest structure
+ */
+
+AsyncTextureLoader::SRequest::SRequest(Texture* InitTex, const io::stringc &InitFilename, f32 InitPriority) :
+    Tex         (InitTex        ),
+    Filename    (InitFilename   ),
+    Priority    (InitPriority   ),
+    State       (REQUEST_QUEUED ),
+    Image           (0                      ),
+    Compression     (BLOCKCOMPRESSION_NONE  ),
+    MipMaps         (false                  ),
+    CompressedImage (0                      ),
+    isCanceled      (false                  )
+{
+}
+AsyncTextureLoader::SRequest::~SRequest()
+{
+    MemoryManager::deleteMemory(Image);
+    MemoryManager::deleteMemory(CompressedImage);
+}
+
+
+/*
+ * AsyncTextureLoader class
+ */
+
+AsyncTextureLoader::AsyncTextureLoader(u32 ThreadCount) :
+    isRunning_          (true   ),
+    isFlushing_         (false  ),
+    MaxUploadBytes_     (4194304),
+    MaxUploadTime_      (2000   ),
+    NumUploadedTextures_(0      ),
+    NumUploadedBytes_   (0      )
+{
+    /* Start the worker threads */
+    ThreadCount = math::Max(1u, ThreadCount);
+    
+    for (u32 i = 0; i < ThreadCount; ++i)
+        Threads_.push_back(new ThreadManager(AsyncTextureLoaderThreadProc, this));
+}
+AsyncTextureLoader::~AsyncTextureLoader()
+{
+    /* Wake up all threads and wait until they are finished */
+    isRunning_ = false;
+    
+    RequestSignal_.post(Threads_.size());
+    
+    for (u32 i = 0; i < Threads_.size(); ++i)
+        ExitSignal_.wait();
+    
+    MemoryManager::deleteList(Threads_);
+    
+    /* Delete all requests (after the threads have stopped each request is in one of the queues) */
+    MemoryManager::deleteList(RequestQueue_);
+    MemoryManager::deleteList(UploadQueue_);
+}
+
+void AsyncTextureLoader::request(Texture* Tex, const io::stringc &Filename, f32 Priority, const TextureLoadCallback &Callback)
+{
+    if (!Tex)
+        return;
+    
+    FailedTextures_.erase(Tex);
+    
+    std::map<const Texture*, SRequest*>::iterator it = Requests_.find(Tex);
+    
+    if (it != Requests_.end())
+    {
+        /* Add the callback to the pending request and keep the highest priority */
+        SRequest* Request = it->second;
+        
+        Mutex_.lock();
+        Request->Priority = math::Min(Request->Priority, Priority);
+        Mutex_.unlock();
+        
+        if (Callback)
+            Request->Callbacks.push_back(Callback);
+    }
+    else
+    {
+        /* Create a new request (the texture settings are taken here, because the worker must not access the texture) */
+        SRequest* Request = new SRequest(Tex, Filename, Priority);
+        
+        if ( Tex->getType() == TEXTURE_2D && !Tex->getRenderTarget() && Tex->getHardwareFormat() == HWTEXFORMAT_UBYTE8 &&
+             GlbRenderSys->queryVideoSupport(VIDEOSUPPORT_TEXTURE_COMPRESSION) )
+        {
+            Request->Compression    = Tex->getCompression();
+            Request->MipMaps        = Tex->getMipMapping();
+        }
+        
+        if (Callback)
+            Request->Callbacks.push_back(Callback);
+        
+        Requests_[Tex] = Request;
+        
+        Mutex_.lock();
+        RequestQueue_.push_back(Request);
+        Mutex_.unlock();
+        
+        RequestSignal_.post();
+    }
+}
+
+bool AsyncTextureLoader::setPriority(const Texture* Tex, f32 Priority)
+{
+    std::map<const Texture*, SRequest*>::iterator it = Requests_.find(Tex);
+    
+    if (it == Requests_.end())
+        return false;
+    
+    Mutex_.lock();
+    it->second->Priority = Priority;
+    Mutex_.unlock();
+    
+    return true;
+}
+
+bool AsyncTextureLoader::cancel(const Texture* Tex)
+{
+    FailedTextures_.erase(Tex);
+    
+    std::map<const Texture*, SRequest*>::iterator it = Requests_.find(Tex);
+    
+    if (it == Requests_.end())
+        return false;
+    
+    SRequest* Request = it->second;
+    Requests_.erase(it);
+    
+    Mutex_.lock();
+    
+    if (Request->State == REQUEST_LOADING)
+    {
+        /* The worker thread still uses this request, so it will be deleted in the next update */
+        Request->isCanceled = true;
+    }
+    else
+    {
+        if (Request->State == REQUEST_QUEUED)
+            MemoryManager::removeElement(RequestQueue_, Request);
+        else
+            MemoryManager::removeElement(UploadQueue_, Request);
+        delete Request;
+    }
+    
+    Mutex_.unlock();
+    
+    return true;
+}
+
+bool AsyncTextureLoader::isLoading(const Texture* Tex) const
+{
+    return Requests_.find(Tex) != Requests_.end();
+}
+
+bool AsyncTextureLoader::hasFailed(const Texture* Tex) const
+{
+    return FailedTextures_.find(Tex) != FailedTextures_.end();
+}
+
+void AsyncTextureLoader::update()
+{
+    upload(MaxUploadBytes_, MaxUploadTime_);
+}
+
+void AsyncTextureLoader::flush()
+{
+    Mutex_.lock();
+    isFlushing_ = true;
+    Mutex_.unlock();
+    
+    while (!Requests_.empty())
+    {
+        upload(~0u, ~0u);
+        
+        /* Sleep until the next texture has been loaded */
+        if (!Requests_.empty())
+            LoadedSignal_.wait();
+    }
+    
+    Mutex_.lock();
+    isFlushing_ = false;
+    Mutex_.unlock();
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void AsyncTextureLoader::upload(u32 MaxBytes, u64 MaxTime)
+{
+    NumUploadedTextures_    = 0;
+    NumUploadedBytes_       = 0;
+    
+    const u64 StartTime = io::Timer::microsecs();
+    
+    while (1)
+    {
+        SRequest* Request = popLoadedRequest();
+        
+        if (!Request)
+            break;
+        
+        if (Request->isCanceled)
+        {
+            delete Request;
+            continue;
+        }
+        
+        Requests_.erase(Request->Tex);
+        
+        /* Hand the decoded image over to the texture (the texture takes the ownership of the image buffer) */
+        const bool isLoaded = (Request->Image != 0);
+        
+        if (isLoaded)
+        {
+            NumUploadedBytes_ += Request->Image->getBufferSize();
+            ++NumUploadedTextures_;
+            
+            Request->Tex->adoptImageBuffer(Request->Image, Request->CompressedImage);
+            Request->Image = 0;
+            Request->CompressedImage = 0;
+        }
+        
+        /* Print the messages of the worker thread (the log output is not thread-safe) */
+        io::Log::printRecord(Request->Messages);
+        
+        if (!isLoaded)
+        {
+            io::Log::error("Could not load texture \"" + Request->Filename + "\" asynchronously");
+            FailedTextures_.insert(Request->Tex);
+        }
+        
+        /* Notify the client */
+        foreach (TextureLoadCallback &Callback, Request->Callbacks)
+            Callback(Request->Tex, isLoaded);
+        
+        delete Request;
+        
+        /* Check if the upload budget is exhausted */
+        if (NumUploadedBytes_ >= MaxBytes || io::Timer::microsecs() - StartTime >= MaxTime)
+            break;
+    }
+}
+
+AsyncTextureLoader::SRequest* AsyncTextureLoader::popRequest()
+{
+    SRequest* Request = 0;
+    
+    Mutex_.lock();
+    
+    if (!RequestQueue_.empty())
+    {
+        /* Select the request with the highest priority */
+        std::vector<SRequest*>::iterator itBest = RequestQueue_.begin();
+        
+        for (std::vector<SRequest*>::iterator it = itBest + 1; it != RequestQueue_.end(); ++it)
+        {
+            if ((*it)->Priority < (*itBest)->Priority)
+                itBest = it;
+        }
+        
+        Request = *itBest;
+        Request->State = REQUEST_LOADING;
+        
+        RequestQueue_.erase(itBest);
+    }
+    
+    Mutex_.unlock();
+    
+    return Request;
+}
+
+AsyncTextureLoader::SRequest* AsyncTextureLoader::popLoadedRequest()
+{
+    SRequest* Request = 0;
+    
+    Mutex_.lock();
+    
+    if (!UploadQueue_.empty())
+    {
+        /* Select the request with the highest priority */
+        std::vector<SRequest*>::iterator itBest = UploadQueue_.begin();
+        
+        for (std::vector<SRequest*>::iterator it = itBest + 1; it != UploadQueue_.end(); ++it)
+        {
+            if ((*it)->Priority < (*itBest)->Priority)
+                itBest = it;
+        }
+        
+        Request = *itBest;
+        UploadQueue_.erase(itBest);
+    }
+    
+    Mutex_.unlock();
+    
+    return Request;
+}
+
+void AsyncTextureLoader::loadRequest(SRequest* Request)
+{
+    ImageBuffer* Image = 0;
+    SCompressedImage* CompressedImage = 0;
+    
+    /* Record the log messages of the file system and the image loaders for the render thread */
+    io::Log::startRecording(Request->Messages);
+    
+    /* Read and decode the image file */
+    io::FileSystem FileSys;
+    io::File* TexFile = FileSys.readResourceFile(Request->Filename);
+    
+    boost::shared_ptr<ImageLoader> Loader = GlbRenderSys->createImageLoader(TexFile);
+    
+    if (Loader)
+    {
+        SImageDataRead* ImageData = Loader->loadImageData();
+        
+        if (ImageData)
+        {
+            /* Take over the decoded pixels without copying them */
+            ImageBufferUByte* NewImage = new ImageBufferUByte();
+            NewImage->adoptBuffer(
+                ImageData->Format, dim::size2di(ImageData->Width, ImageData->Height), 1, ImageData->ImageBuffer
+            );
+            Image = NewImage;
+            
+            MemoryManager::deleteMemory(ImageData);
+        }
+    }
+    
+    /* Compress the image here, so that only the blocks are uploaded on the render thread */
+    if (Image && Request->Compression != BLOCKCOMPRESSION_NONE)
+    {
+        CompressedImage = new SCompressedImage();
+        
+        if (!BlockCompression::compressMipMaps(
+                static_cast<const u8*>(Image->getBuffer()), Image->getSize(), Image->getFormat(), Request->Compression,
+                *CompressedImage, Request->MipMaps, GlbRenderSys->getTextureCompressionQuality(),
+                GlbRenderSys->getTextureCompressionCache()))
+        {
+            MemoryManager::deleteMemory(CompressedImage);
+        }
+    }
+    
+    io::Log::stopRecording();
+    
+    /* Pass the request to the upload queue */
+    Mutex_.lock();
+    
+    Request->Image = Image;
+    Request->CompressedImage = CompressedImage;
+    Request->State = REQUEST_LOADED;
+    UploadQueue_.push_back(Request);
+    
+    if (isFlushing_)
+        LoadedSignal_.post();
+    
+    Mutex_.unlock();
+}
+
+
+} // /namespace video
+
+} // /namespace sp
+
+
+
+// ================================================================================
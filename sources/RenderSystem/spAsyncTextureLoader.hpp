@@ -0,0 +1,212 @@
+/*
+ * Asynchronous texture loader header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_ASYNC_TEXTURE_LOADER_H__
+#define __SP_ASYNC_TEXTURE_LOADER_H__
+
+
+#include "Base/spStandard.hpp"
+#include "Base/spInputOutputString.hpp"
+#include "Base/spInputOutputLog.hpp"
+#include "Base/spCriticalSection.hpp"
+#include "Base/spThreadManager.hpp"
+#include "Base/spSemaphore.hpp"
+#include "RenderSystem/spTextureFlags.hpp"
+
+#include <vector>
+#include <map>
+#include <set>
+#include <boost/function.hpp>
+
+
+namespace sp
+{
+namespace video
+{
+
+
+class Texture;
+class ImageBuffer;
+struct SCompressedImage;
+
+/**
+Texture load callback. This is called on the render thread when an asynchronously loaded texture has been uploaded.
+\param Tex: Pointer to the texture object. This is the texture which was returned by "RenderSystem::loadTextureAsync".
+\param isLoaded: False if the texture could not be loaded. In this case the texture keeps its placeholder image.
+\see RenderSystem::loadTextureAsync
+\since Version 3.3
+*/
+typedef boost::function<void (Texture* Tex, bool isLoaded)> TextureLoadCallback;
+
+
+/**
+The asynchronous texture loader reads and decodes the image files on worker threads.
+Images of textures with block compression are compressed on the worker threads as well (incl. their MIP-maps).
+The decoded images are uploaded on the render thread with "update" under a per-frame byte and time budget.
+Requests with lower priority values are loaded and uploaded first (e.g. use the distance between the camera and the object).
+\see RenderSystem::loadTextureAsync
+\see RenderSystem::getAsyncTextureLoader
+\since Version 3.3
+*/
+class SP_EXPORT AsyncTextureLoader
+{
+    
+    public:
+        
+        AsyncTextureLoader(u32 ThreadCount = 2);
+        ~AsyncTextureLoader();
+        
+        /* === Functions === */
+        
+        /**
+        Requests the specified image file for the specified texture. The texture keeps its current image until the new image
+        has been uploaded. If the texture is already being loaded, only the callback is added and the priority is raised.
+        \param Tex: Specifies the (placeholder) texture which is to be filled with the image.
+        \param Filename: Specifies the image filename.
+        \param Priority: Specifies the loading priority. Lower values are loaded first.
+        \param Callback: Specifies the optional callback which is called after the texture has been uploaded.
+        */
+        void request(Texture* Tex, const io::stringc &Filename, f32 Priority = 0.0f, const TextureLoadCallback &Callback = 0);
+        
+        /**
+        Sets the new priority of a pending texture.
+        \return True if the texture is still waiting to be loaded or uploaded.
+        */
+        bool setPriority(const Texture* Tex, f32 Priority);
+        
+        /**
+        Cancels the loading of the specified texture. The callbacks will not be called.
+        This is done automatically when the texture is deleted with "RenderSystem::deleteTexture".
+        \return True if the texture was pending.
+        */
+        bool cancel(const Texture* Tex);
+        
+        //! Returns true if the specified texture is waiting to be loaded or uploaded.
+        bool isLoading(const Texture* Tex) const;
+        
+        //! Returns true if the image of the specified texture could not be loaded. The texture keeps its placeholder image.
+        bool hasFailed(const Texture* Tex) const;
+        
+        /**
+        Uploads the loaded textures under the upload budget and calls their callbacks.
+        At least one texture is uploaded per call. This must be called on the render thread.
+        It is called automatically once per frame by "SoftPixelDevice::updateEvents".
+        \see setUploadBudget
+        */
+        void update();
+        
+        //! Waits until all pending textures have been loaded and uploaded (e.g. for loading screens).
+        void flush();
+        
+        /* === Inline functions === */
+        
+        /**
+        Sets the upload budget per frame.
+        \param MaxBytes: Specifies the maximal count of image bytes which are uploaded per frame. By default 4 MB.
+        \param MaxMicroseconds: Specifies the maximal upload time (in microseconds) per frame. By default 2000.
+        */
+        inline void setUploadBudget(u32 MaxBytes, u32 MaxMicroseconds)
+        {
+            MaxUploadBytes_ = MaxBytes;
+            MaxUploadTime_  = MaxMicroseconds;
+        }
+        
+        //! Returns the count of textures which are waiting to be loaded or uploaded.
+        inline u32 getNumPendingTextures() const
+        {
+            return Requests_.size();
+        }
+        //! Returns the count of textures which have been uploaded in the last update.
+        inline u32 getNumUploadedTextures() const
+        {
+            return NumUploadedTextures_;
+        }
+        //! Returns the count of image bytes which have been uploaded in the last update.
+        inline u32 getNumUploadedBytes() const
+        {
+            return NumUploadedBytes_;
+        }
+        
+    private:
+        
+        friend THREAD_PROC(AsyncTextureLoaderThreadProc);
+        
+        /* === Enumerations === */
+        
+        enum ERequestStates
+        {
+            REQUEST_QUEUED,     //!< Waiting for a worker thread.
+            REQUEST_LOADING,    //!< A worker thread is loading the image.
+            REQUEST_LOADED      //!< Loaded and decoded, waiting for upload.
+        };
+        
+        /* === Structures === */
+        
+        struct SRequest
+        {
+            SRequest(Texture* InitTex, const io::stringc &InitFilename, f32 InitPriority);
+            ~SRequest();
+            
+            /* Members */
+            Texture* Tex;
+            io::stringc Filename;
+            f32 Priority;
+            ERequestStates State;
+            ImageBuffer* Image;
+            EBlockCompressionFormats Compression;   //!< Requested block compression of the texture.
+            bool MipMaps;                           //!< Specifies whether the MIP-maps are compressed, too.
+            SCompressedImage* CompressedImage;      //!< Image compressed on the worker thread. May be null.
+            bool isCanceled;
+            std::vector<TextureLoadCallback> Callbacks;
+            std::vector<io::SLogMessage> Messages; //!< Log messages of the worker thread. They are printed on the render thread.
+        };
+        
+        /* === Functions === */
+        
+        void upload(u32 MaxBytes, u64 MaxTime);
+        
+        SRequest* popRequest();
+        SRequest* popLoadedRequest();
+        
+        void loadRequest(SRequest* Request);
+        
+        /* === Members === */
+        
+        std::map<const Texture*, SRequest*> Requests_;
+        std::set<const Texture*> FailedTextures_;
+        
+        std::vector<SRequest*> RequestQueue_;
+        std::vector<SRequest*> UploadQueue_;
+        
+        CriticalSection Mutex_;
+        
+        std::vector<ThreadManager*> Threads_;
+        Semaphore RequestSignal_;
+        Semaphore ExitSignal_;
+        Semaphore LoadedSignal_;
+        volatile bool isRunning_;
+        bool isFlushing_;
+        
+        u32 MaxUploadBytes_;
+        u32 MaxUploadTime_;
+        
+        u32 NumUploadedTextures_;
+        u32 NumUploadedBytes_;
+        
+};
+
+
+} // /namespace video
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
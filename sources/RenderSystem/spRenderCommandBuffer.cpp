@@ -0,0 +1,174 @@
+/*
+ * Render command buffer file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "RenderSystem/spRenderCommandBuffer.hpp"
+#include "RenderSystem/spRenderSystem.hpp"
+#include "SceneGraph/spSceneGraph.hpp"
+#include "SceneGraph/spSceneMesh.hpp"
+
+
+namespace sp
+{
+
+extern video::RenderSystem* GlbRenderSys;
+extern scene::SceneGraph* GlbSceneGraph;
+
+namespace video
+{
+
+
+RenderCommandBuffer::RenderCommandBuffer() :
+    NumDrawCommands_(0)
+{
+}
+RenderCommandBuffer::~RenderCommandBuffer()
+{
+}
+
+void RenderCommandBuffer::clear()
+{
+    Commands_.clear();
+    Matrices_.clear();
+    
+    NumDrawCommands_ = 0;
+}
+
+void RenderCommandBuffer::setWorldMatrix(const dim::matrix4f &Matrix)
+{
+    addCommand(RENDERCMD_WORLD_MATRIX).MatrixIndex = Matrices_.size();
+    Matrices_.push_back(Matrix);
+}
+
+void RenderCommandBuffer::setupMaterialStates(const MaterialStates* Material)
+{
+    if (Material)
+        addCommand(RENDERCMD_MATERIAL_STATES).Material = Material;
+}
+
+void RenderCommandBuffer::setupShaderClass(const scene::MaterialNode* Object, ShaderClass* ShaderObject)
+{
+    SCommand& Cmd = addCommand(RENDERCMD_SHADER_CLASS);
+    Cmd.ShaderClassCmd.Object       = Object;
+    Cmd.ShaderClassCmd.ShaderObject = ShaderObject;
+}
+
+void RenderCommandBuffer::unbindShaders()
+{
+    addCommand(RENDERCMD_UNBIND_SHADERS);
+}
+
+void RenderCommandBuffer::setRenderState(const ERenderStates Type, s32 State)
+{
+    SCommand& Cmd = addCommand(RENDERCMD_RENDER_STATE);
+    Cmd.RenderStateCmd.Type     = Type;
+    Cmd.RenderStateCmd.State    = State;
+}
+
+void RenderCommandBuffer::drawMeshBuffer(const MeshBuffer* Buffer)
+{
+    if (Buffer)
+    {
+        SCommand& Cmd = addCommand(RENDERCMD_DRAW);
+        Cmd.DrawCmd.Buffer      = Buffer;
+        Cmd.DrawCmd.StartOffset = 0;
+        Cmd.DrawCmd.NumVertices = 0;
+        ++NumDrawCommands_;
+    }
+}
+
+void RenderCommandBuffer::drawMeshBufferPart(const MeshBuffer* Buffer, u32 StartOffset, u32 NumVertices)
+{
+    if (Buffer && NumVertices > 0)
+    {
+        SCommand& Cmd = addCommand(RENDERCMD_DRAW_PART);
+        Cmd.DrawCmd.Buffer      = Buffer;
+        Cmd.DrawCmd.StartOffset = StartOffset;
+        Cmd.DrawCmd.NumVertices = NumVertices;
+        ++NumDrawCommands_;
+    }
+}
+
+void RenderCommandBuffer::renderNode(scene::RenderNode* Node)
+{
+    if (Node)
+        addCommand(RENDERCMD_RENDER_NODE).Node = Node;
+}
+
+void RenderCommandBuffer::submit(RenderSystem* Renderer) const
+{
+    if (!Renderer)
+        Renderer = GlbRenderSys;
+    
+    for (std::vector<SCommand>::const_iterator it = Commands_.begin(); it != Commands_.end(); ++it)
+    {
+        switch (it->Type)
+        {
+            case RENDERCMD_WORLD_MATRIX:
+                Renderer->setWorldMatrix(Matrices_[it->MatrixIndex]);
+                Renderer->updateModelviewMatrix();
+                break;
+                
+            case RENDERCMD_MATERIAL_STATES:
+                Renderer->setupMaterialStates(it->Material);
+                break;
+                
+            case RENDERCMD_SHADER_CLASS:
+            {
+                const scene::MaterialNode* Object = it->ShaderClassCmd.Object;
+                
+                /* The Direct3D11 default shader reads the active mesh while drawing */
+                if (Object && GlbSceneGraph && Object->getType() == scene::NODE_MESH)
+                    GlbSceneGraph->setActiveMesh(const_cast<scene::Mesh*>(static_cast<const scene::Mesh*>(Object)));
+                
+                Renderer->setupShaderClass(Object, it->ShaderClassCmd.ShaderObject);
+            }
+            break;
+            
+            case RENDERCMD_UNBIND_SHADERS:
+                Renderer->unbindShaders();
+                break;
+                
+            case RENDERCMD_RENDER_STATE:
+                Renderer->setRenderState(it->RenderStateCmd.Type, it->RenderStateCmd.State);
+                break;
+                
+            case RENDERCMD_DRAW:
+                Renderer->drawMeshBuffer(it->DrawCmd.Buffer);
+                break;
+                
+            case RENDERCMD_DRAW_PART:
+                Renderer->drawMeshBufferPart(it->DrawCmd.Buffer, it->DrawCmd.StartOffset, it->DrawCmd.NumVertices);
+                break;
+                
+            case RENDERCMD_RENDER_NODE:
+                it->Node->render();
+                break;
+        }
+    }
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+RenderCommandBuffer::SCommand& RenderCommandBuffer::addCommand(const ERenderCommands Type)
+{
+    Commands_.resize(Commands_.size() + 1);
+    SCommand& Cmd = Commands_.back();
+    Cmd.Type = Type;
+    return Cmd;
+}
+
+
+} // /namespace video
+
+} // /namespace sp
+
+
+
+// ================================================================================
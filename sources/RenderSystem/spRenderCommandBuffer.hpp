@@ -0,0 +1,204 @@
+/*
+ * Render command buffer header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_RENDER_COMMAND_BUFFER_H__
+#define __SP_RENDER_COMMAND_BUFFER_H__
+
+
+#include "Base/spStandard.hpp"
+#include "Base/spMaterialConfigTypes.hpp"
+#include "Base/spDimensionMatrix4.hpp"
+
+#include <vector>
+
+
+namespace sp
+{
+namespace scene
+{
+    class MaterialNode;
+    class RenderNode;
+}
+namespace video
+{
+
+
+class RenderSystem;
+class MaterialStates;
+class ShaderClass;
+class MeshBuffer;
+
+//! Render command types. \see RenderCommandBuffer
+enum ERenderCommands
+{
+    RENDERCMD_WORLD_MATRIX,     //!< Sets the world matrix and updates the model-view matrix.
+    RENDERCMD_MATERIAL_STATES,  //!< Sets up the material states.
+    RENDERCMD_SHADER_CLASS,     //!< Sets up the shader class for an object.
+    RENDERCMD_UNBIND_SHADERS,   //!< Unbinds the shaders.
+    RENDERCMD_RENDER_STATE,     //!< Sets a single render state.
+    RENDERCMD_DRAW,             //!< Draws a mesh buffer.
+    RENDERCMD_DRAW_PART,        //!< Draws a part of a mesh buffer.
+    RENDERCMD_RENDER_NODE,      //!< Renders a node as usual. Used for nodes which can not be recorded.
+};
+
+
+/**
+RenderCommandBuffer records compact render commands (world matrices, material states, shader bindings and draw calls)
+which are replayed later in the same order with "submit". Recording does not call the render system,
+so several command buffers can be recorded in parallel on worker threads (e.g. one buffer per thread or per pass)
+while the render thread submits them in order. The commands only store pointers to the resources,
+i.e. the recorded materials, shader classes and mesh buffers must not be deleted before the buffer has been submitted.
+\code
+// On the worker threads:
+CmdBuffer->clear();
+foreach (scene::Mesh* Obj, MeshesOfThisThread)
+    Obj->recordRender(*CmdBuffer);
+    
+// On the render thread:
+foreach (video::RenderCommandBuffer* CmdBuffer, CmdBuffers)
+    CmdBuffer->submit();
+\endcode
+\see scene::RenderNode::recordRender
+\see scene::SceneGraph::setParallelRecording
+\since Version 3.3
+*/
+class SP_EXPORT RenderCommandBuffer
+{
+    
+    public:
+        
+        RenderCommandBuffer();
+        ~RenderCommandBuffer();
+        
+        /* === Recording functions === */
+        
+        //! Removes all recorded commands. The memory is kept for the next recording.
+        void clear();
+        
+        //! Records a world matrix change. \see RenderSystem::setWorldMatrix
+        void setWorldMatrix(const dim::matrix4f &Matrix);
+        
+        //! Records a material states setup. \see RenderSystem::setupMaterialStates
+        void setupMaterialStates(const MaterialStates* Material);
+        
+        //! Records a shader class setup. \see RenderSystem::setupShaderClass
+        void setupShaderClass(const scene::MaterialNode* Object, ShaderClass* ShaderObject);
+        
+        //! Records a shader unbinding. \see RenderSystem::unbindShaders
+        void unbindShaders();
+        
+        //! Records a render state change. \see RenderSystem::setRenderState
+        void setRenderState(const ERenderStates Type, s32 State);
+        
+        //! Records a draw call for the whole mesh buffer. \see RenderSystem::drawMeshBuffer
+        void drawMeshBuffer(const MeshBuffer* Buffer);
+        
+        //! Records a draw call for a part of the mesh buffer. \see RenderSystem::drawMeshBufferPart
+        void drawMeshBufferPart(const MeshBuffer* Buffer, u32 StartOffset, u32 NumVertices);
+        
+        /**
+        Records the rendering of the specified node. When the buffer is submitted the node's
+        "render" function is called on the render thread, i.e. the node is rendered as usual.
+        */
+        void renderNode(scene::RenderNode* Node);
+        
+        /* === Submission functions === */
+        
+        /**
+        Replays all recorded commands in order. This must be called on the render thread.
+        \param Renderer Specifies the render system. By default 0 to use the active render system.
+        Nodes recorded with "renderNode" are always rendered with the active render system.
+        */
+        void submit(RenderSystem* Renderer = 0) const;
+        
+        /* === Inline functions === */
+        
+        //! Returns the count of recorded commands.
+        inline u32 getNumCommands() const
+        {
+            return Commands_.size();
+        }
+        //! Returns the count of recorded draw commands (RENDERCMD_DRAW and RENDERCMD_DRAW_PART).
+        inline u32 getNumDrawCommands() const
+        {
+            return NumDrawCommands_;
+        }
+        
+        //! Returns true if no commands have been recorded.
+        inline bool empty() const
+        {
+            return Commands_.empty();
+        }
+        
+        //! Returns the type of the specified command. The index must be less than "getNumCommands".
+        inline ERenderCommands getCommandType(u32 Index) const
+        {
+            return Commands_[Index].Type;
+        }
+        
+    private:
+        
+        /* === Structures === */
+        
+        struct SShaderClassCmd
+        {
+            const scene::MaterialNode* Object;
+            ShaderClass* ShaderObject;
+        };
+        
+        struct SRenderStateCmd
+        {
+            ERenderStates Type;
+            s32 State;
+        };
+        
+        struct SDrawCmd
+        {
+            const MeshBuffer* Buffer;
+            u32 StartOffset;
+            u32 NumVertices;
+        };
+        
+        //! Compact render command. The world matrices are stored separately.
+        struct SCommand
+        {
+            ERenderCommands Type;
+            union
+            {
+                u32 MatrixIndex;
+                const MaterialStates* Material;
+                scene::RenderNode* Node;
+                SShaderClassCmd ShaderClassCmd;
+                SRenderStateCmd RenderStateCmd;
+                SDrawCmd DrawCmd;
+            };
+        };
+        
+        /* === Functions === */
+        
+        SCommand& addCommand(const ERenderCommands Type);
+        
+        /* === Members === */
+        
+        std::vector<SCommand> Commands_;
+        std::vector<dim::matrix4f> Matrices_;
+        
+        u32 NumDrawCommands_;
+        
+};
+
+
+} // /namespace video
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
@@ -140,6 +140,10 @@ void RenderContext::setActiveRenderContext(RenderContext* Context)
         );
     }
     
+    /* Each render context has its own render states */
+    if (GlbRenderSys && RenderContext::ActiveRenderContext_ != Context)
+        GlbRenderSys->invalidateRenderStates();
+    
     /* Activate new render context */
     RenderContext::ActiveRenderContext_ = Context;
     
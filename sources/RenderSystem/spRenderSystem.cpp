@@ -12,10 +12,12 @@
 #include "SceneGraph/spSceneGraph.hpp"
 #include "SceneGraph/spSceneMesh.hpp"
 #include "SceneGraph/spSceneManager.hpp"
+#include "SceneGraph/spAsyncMeshLoader.hpp"
 #include "Framework/Cg/spCgShaderClass.hpp"
-#include "Framework/Tools/ScriptParser/spToolXMLParser.hpp"
+#include "Framework/Tools/ScriptParser/spToolXMLReader.hpp"
 #include "Base/spMathRasterizer.hpp"
 #include "Base/spSharedObjects.hpp"
+#include "Base/spProfiler.hpp"
 
 #include <boost/foreach.hpp>
 #include <boost/shared_ptr.hpp>
@@ -38,6 +40,8 @@ u32 RenderSystem::NumDrawCalls_             = 0;
 u32 RenderSystem::NumMeshBufferBindings_    = 0;
 u32 RenderSystem::NumTexLayerBindings_      = 0;
 u32 RenderSystem::NumMaterialUpdates_       = 0;
+u32 RenderSystem::NumStateChanges_          = 0;
+u32 RenderSystem::NumRedundantStateChanges_ = 0;
 #endif
 
 RenderSystem::RenderSystem(const ERenderSystems Type) :
@@ -51,6 +55,11 @@ RenderSystem::RenderSystem(const ERenderSystems Type) :
     Window_                 (0              ),
     #endif
     
+    AsyncTextureLoader_     (0              ),
+    TextureResidencyManager_(0              ),
+    TexCompressionQuality_  (BLOCKQUALITY_NORMAL),
+    TexCompressionCache_    (0              ),
+    
     RenderMode_             (RENDERMODE_NONE),
     MaxClippingPlanes_      (0              ),
     isFrontFace_            (true           ),
@@ -70,7 +79,7 @@ RenderSystem::RenderSystem(const ERenderSystems Type) :
     VertexFormatExtended_   (0              ),
     VertexFormatFull_       (0              ),
     VertexFormatEmpty_      (0              ),
-
+    
     BillboardMeshBuffer_    (0              )
 {
     /* General settings */
@@ -92,6 +101,11 @@ RenderSystem::~RenderSystem()
     MemoryManager::deleteList(ShaderClassList_      );
     MemoryManager::deleteList(ShaderResourceList_   );
     MemoryManager::deleteList(QueryList_            );
+    
+    /* Stop the texture loading threads */
+    MemoryManager::deleteMemory(AsyncTextureLoader_);
+    MemoryManager::deleteMemory(TextureResidencyManager_);
+    MemoryManager::deleteMemory(TexCompressionCache_);
 }
 
 
@@ -183,6 +197,12 @@ void RenderSystem::setClearStencil(s32 Stencil)
  * ======= Rendering 3D scenes =======
  */
 
+void RenderSystem::updateVertexBufferRange(void* BufferID, const dim::UniversalBuffer &BufferData, u32 First, u32 Count)
+{
+    for (u32 i = First, n = First + Count; i < n; ++i)
+        updateVertexBufferElement(BufferID, BufferData, i);
+}
+
 void RenderSystem::setGlobalMaterialStates(const MaterialStates* GlobalMaterialStates)
 {
     if (GlobalMaterialStates_ != GlobalMaterialStates)
@@ -203,6 +223,10 @@ void RenderSystem::setupTextureLayer(
 
 void RenderSystem::bindTextureLayers(const TextureLayerListType &TexLayers)
 {
+    /* Track texture usage for the residency manager */
+    if (TextureResidencyManager_)
+        TextureResidencyManager_->markUsed(TexLayers);
+    
     /* Check if this texture layer list is already bound */
     if (PrevTextureLayers_ == (&TexLayers))
         return;
@@ -667,6 +691,16 @@ void RenderSystem::endDrawing2D()
     RenderMode_ = RENDERMODE_NONE;
 }
 
+void RenderSystem::flush2DDrawing()
+{
+    // dummy
+}
+
+void RenderSystem::invalidateRenderStates()
+{
+    PrevMaterial_ = 0;
+}
+
 void RenderSystem::beginDrawing3D()
 {
     /* Setup camera view */
@@ -952,6 +986,12 @@ void RenderSystem::draw3DBox(const dim::obbox3df &BoundBox, const color &Color)
 
 Texture* RenderSystem::loadTexture(const io::stringc &Filename)
 {
+    /* Mesh loader threads must not access the render system, so their textures are created on the render thread */
+    if (scene::AsyncMeshLoader::isLoaderThread())
+        return scene::AsyncMeshLoader::loadTexture(Filename);
+    
+    SP_PROFILE_SCOPE("RenderSystem::loadTexture");
+    
     /* Initialization */
     Texture* NewTexture = 0;
     
@@ -971,58 +1011,70 @@ Texture* RenderSystem::loadTexture(const io::stringc &Filename)
     }
     
     /* Get a suitable image loader */
-    const EImageFileFormats FileFormat = getImageFileFormat(TexFile);
+    boost::shared_ptr<ImageLoader> Loader = createImageLoader(TexFile);
     
-    boost::shared_ptr<ImageLoader> Loader;
+    if (!Loader)
+    {
+        /* Create an empty texture */
+        NewTexture = createTexture(DEF_TEXTURE_SIZE);
+        io::Log::lowerTab();
+        return NewTexture;
+    }
+    
+    /* Load the texture and create the renderer texture */
+    NewTexture = loadTexture(Loader.get());
+    
+    io::Log::lowerTab();
+    
+    return NewTexture;
+}
+
+boost::shared_ptr<ImageLoader> RenderSystem::createImageLoader(io::File* TexFile) const
+{
+    if (!TexFile)
+        return boost::shared_ptr<ImageLoader>();
+    
+    const EImageFileFormats FileFormat = getImageFileFormat(TexFile);
     
     switch (FileFormat)
     {
         #ifdef SP_COMPILE_WITH_TEXLOADER_BMP
         case IMAGEFORMAT_BMP:
-            Loader = boost::shared_ptr<ImageLoader>(new ImageLoaderBMP(TexFile)); break;
+            return boost::shared_ptr<ImageLoader>(new ImageLoaderBMP(TexFile));
         #endif
         #ifdef SP_COMPILE_WITH_TEXLOADER_JPG
         case IMAGEFORMAT_JPG:
-            Loader = boost::shared_ptr<ImageLoader>(new ImageLoaderJPG(TexFile)); break;
+            return boost::shared_ptr<ImageLoader>(new ImageLoaderJPG(TexFile));
         #endif
         #ifdef SP_COMPILE_WITH_TEXLOADER_TGA
         case IMAGEFORMAT_TGA:
-            Loader = boost::shared_ptr<ImageLoader>(new ImageLoaderTGA(TexFile)); break;
+            return boost::shared_ptr<ImageLoader>(new ImageLoaderTGA(TexFile));
         #endif
         #ifdef SP_COMPILE_WITH_TEXLOADER_PNG
         case IMAGEFORMAT_PNG:
-            Loader = boost::shared_ptr<ImageLoader>(new ImageLoaderPNG(TexFile)); break;
+            return boost::shared_ptr<ImageLoader>(new ImageLoaderPNG(TexFile));
         #endif
         #ifdef SP_COMPILE_WITH_TEXLOADER_PCX
         case IMAGEFORMAT_PCX:
-            Loader = boost::shared_ptr<ImageLoader>(new ImageLoaderPCX(TexFile)); break;
+            return boost::shared_ptr<ImageLoader>(new ImageLoaderPCX(TexFile));
         #endif
         #ifdef SP_COMPILE_WITH_TEXLOADER_DDS
         case IMAGEFORMAT_DDS:
-            Loader = boost::shared_ptr<ImageLoader>(new ImageLoaderDDS(TexFile)); break;
+            return boost::shared_ptr<ImageLoader>(new ImageLoaderDDS(TexFile));
         #endif
         
         default:
         {
-            /* Print error message and create an empty texture */
+            /* Print error message */
             if (FileFormat == IMAGEFORMAT_WAD)
                 io::Log::error("Texture file format WAD must be loaded as a texture list");
             else
                 io::Log::error("Texture has unsupported file format");
-            
-            NewTexture = createTexture(DEF_TEXTURE_SIZE);
-            
-            io::Log::lowerTab();
-            return NewTexture;
         }
+        break;
     }
     
-    /* Load the texture and create the renderer texture */
-    NewTexture = loadTexture(Loader.get());
-    
-    io::Log::lowerTab();
-    
-    return NewTexture;
+    return boost::shared_ptr<ImageLoader>();
 }
 
 Texture* RenderSystem::loadTexture(ImageLoader* Loader)
@@ -1068,6 +1120,54 @@ Texture* RenderSystem::getTexture(const io::stringc &Filename)
     return it->second;
 }
 
+Texture* RenderSystem::loadTextureAsync(const io::stringc &Filename, f32 Priority, const TextureLoadCallback &Callback)
+{
+    AsyncTextureLoader* Loader = getAsyncTextureLoader();
+    
+    /* Each file is only loaded once */
+    std::map<std::string, Texture*>::iterator it = TextureMap_.find(Filename.str());
+    
+    if (it != TextureMap_.end())
+    {
+        if (Loader->isLoading(it->second))
+            Loader->request(it->second, Filename, Priority, Callback);
+        else if (Callback)
+            Callback(it->second, !Loader->hasFailed(it->second));
+        return it->second;
+    }
+    
+    /* Create placeholder texture and request the image */
+    Texture* NewTexture = createTexture(dim::size2di(1), PIXELFORMAT_RGBA);
+    NewTexture->setFilename(Filename);
+    
+    TextureMap_[Filename.str()] = NewTexture;
+    
+    Loader->request(NewTexture, Filename, Priority, Callback);
+    
+    return NewTexture;
+}
+
+AsyncTextureLoader* RenderSystem::getAsyncTextureLoader()
+{
+    if (!AsyncTextureLoader_)
+        AsyncTextureLoader_ = new AsyncTextureLoader();
+    return AsyncTextureLoader_;
+}
+
+TextureResidencyManager* RenderSystem::getTextureResidencyManager()
+{
+    if (!TextureResidencyManager_)
+        TextureResidencyManager_ = new TextureResidencyManager();
+    return TextureResidencyManager_;
+}
+
+void RenderSystem::setTextureCompressionCache(const io::stringc &Path)
+{
+    MemoryManager::deleteMemory(TexCompressionCache_);
+    if (Path.size())
+        TexCompressionCache_ = new BlockCompressionCache(Path);
+}
+
 void RenderSystem::setTextureGenFlags(const ETextureGenFlags Flag, const s32 Value)
 {
     switch (Flag)
@@ -1100,6 +1200,9 @@ void RenderSystem::setTextureGenFlags(const ETextureGenFlags Flag, const s32 Val
             
         case TEXGEN_ANISOTROPY:
             TexGenFlags_.Filter.Anisotropy = Value; break;
+            
+        case TEXGEN_COMPRESSION:
+            TexGenFlags_.Compression = static_cast<EBlockCompressionFormats>(Value); break;
     }
 }
 
@@ -1107,6 +1210,16 @@ void RenderSystem::deleteTexture(Texture* &Tex)
 {
     if (Tex)
     {
+        /* Cancel pending image upload and remove the texture from the file cache */
+        if (AsyncTextureLoader_)
+            AsyncTextureLoader_->cancel(Tex);
+        if (TextureResidencyManager_)
+            TextureResidencyManager_->removeTexture(Tex);
+        
+        std::map<std::string, Texture*>::iterator it = TextureMap_.find(Tex->getFilename().str());
+        if (it != TextureMap_.end() && it->second == Tex)
+            TextureMap_.erase(it);
+        
         TextureListSemaphore_.lock();
         MemoryManager::removeElement(TextureList_, Tex, true);
         TextureListSemaphore_.unlock();
@@ -1312,6 +1425,14 @@ bool RenderSystem::saveTexture(const Texture* Tex, io::stringc Filename, const E
     {
         case IMAGEFORMAT_BMP:
             Saver = boost::shared_ptr<ImageSaver>(new ImageSaverBMP(TexFile)); break;
+            
+        #ifdef SP_COMPILE_WITH_TEXSAVER_DDS
+        case IMAGEFORMAT_DDS:
+            Saver = boost::shared_ptr<ImageSaver>(
+                new ImageSaverDDS(TexFile, Tex->getCompression(), TexCompressionQuality_)
+            );
+            break;
+        #endif
         
         default:
         {
@@ -1332,17 +1453,18 @@ bool RenderSystem::saveTexture(const Texture* Tex, io::stringc Filename, const E
     ImageData.Width        = ImgBuffer->getSize().Width;
     ImageData.Height       = ImgBuffer->getSize().Height;
     ImageData.FormatSize   = ImgBuffer->getFormatSize();
+    ImageData.Format       = ImgBuffer->getFormat();
     ImageData.ImageBuffer  = static_cast<const u8*>(ImgBuffer->getBuffer());
     
     /* Save the image */
-    Saver->saveImageData(&ImageData);
+    const bool Result = Saver->saveImageData(&ImageData);
     
     /* Clear the image buffer to avoid that the buffer will be deleted with the raw data */
     ImageData.ImageBuffer = 0;
     
     io::Log::lowerTab();
     
-    return true;
+    return Result;
 }
 
 Texture* RenderSystem::createScreenShot(const dim::point2di &Position, dim::size2di Size)
@@ -1492,6 +1614,13 @@ Font* RenderSystem::createFont(const io::stringc &FontName, s32 FontSize, s32 Fl
         
         NewFontObj = createBitmapFont(FontName, FontSize, Flags);
     }
+    else if (Flags & FONT_DYNAMIC)
+    {
+        io::Log::message("Create dynamic font: \"" + FontName + "\" with size of " + io::stringc(FontSize));
+        io::Log::upperTab();
+        
+        NewFontObj = createDynamicFont(FontName, FontSize, Flags);
+    }
     else
     {
         io::Log::message("Create texture font: \"" + FontName + "\" with size of " + io::stringc(FontSize));
@@ -1522,6 +1651,61 @@ Font* RenderSystem::createBitmapFont(const io::stringc &FontName, s32 FontSize,
     return NewFont;
 }
 
+Font* RenderSystem::createDynamicFont(const io::stringc &FontName, s32 FontSize, s32 Flags)
+{
+    #if defined(SP_PLATFORM_WINDOWS)
+    
+    /* Create device font with the default character set (to support large character sets) */
+    HFONT FontHandle = 0;
+    createDeviceFont(&FontHandle, FontName, dim::size2di(0, FontSize), Flags, DEFAULT_CHARSET);
+    
+    if (!FontHandle)
+    {
+        io::Log::error("Could not create device font");
+        return createTexturedFont(FontName, FontSize, Flags);
+    }
+    
+    return createFont(new GDIGlyphRasterizer(DeviceContext_, FontHandle), FontName + "|" + io::stringc(FontSize));
+    
+    #else
+    
+    io::Log::error("Dynamic fonts without custom glyph rasterizer are only supported under MS/Windows");
+    return createTexturedFont(FontName, FontSize, Flags);
+    
+    #endif
+}
+
+Font* RenderSystem::createFont(GlyphRasterizer* Rasterizer, const io::stringc &FontName, const dim::size2di &AtlasSize)
+{
+    if (!Rasterizer)
+    {
+        io::Log::error("Invalid glyph rasterizer for dynamic font");
+        return 0;
+    }
+    
+    /* Create atlas texture */
+    STextureCreationFlags CreationFlags;
+    {
+        CreationFlags.Filename          = FontName;
+        CreationFlags.Size              = AtlasSize;
+        CreationFlags.Format            = PIXELFORMAT_RGBA;
+        CreationFlags.Filter.HasMIPMaps = false;
+        CreationFlags.Filter.WrapMode   = TEXWRAP_CLAMP;
+    }
+    Texture* Tex = createTexture(CreationFlags);
+    
+    /* Create font with glyph atlas */
+    const s32 FontHeight = Rasterizer->getHeight();
+    
+    Font* NewFont = new Font(
+        new FontAtlas(Rasterizer, Tex), FontName, dim::size2di(FontHeight/2, FontHeight)
+    );
+    
+    FontList_.push_back(NewFont);
+    
+    return NewFont;
+}
+
 Font* RenderSystem::createFont(Texture* FontTexture)
 {
     /* Check parameter validity */
@@ -1634,15 +1818,15 @@ Font* RenderSystem::createFont(Texture* FontTexture, const io::stringc &FontXMLF
     }
     
     /* Load XML file */
-    tool::XMLParser Parser;
+    tool::XMLReader Reader;
     
-    if (!Parser.loadFile(FontXMLFile))
+    if (!Reader.loadFile(FontXMLFile))
     {
         io::Log::lowerTab();
         return RenderSystem::createFont();
     }
     
-    /* Examine XML tags */
+    /* Examine XML tags (entities in the attribute values are already decoded by the reader) */
     std::vector<SFontGlyph> GlyphList(256);
     u8 i = 0;
     //u32 Count = 0;
@@ -1650,44 +1834,45 @@ Font* RenderSystem::createFont(Texture* FontTexture, const io::stringc &FontXMLF
     
     const dim::size2di TexSize(FontTexture->getSize());
     
-    foreach (const tool::SXMLTag &Tag, Parser.getRootTag().Tags)
+    tool::EXMLReaderEvents Event;
+    
+    while ( ( Event = Reader.next() ) != tool::XMLEVENT_EOF )
     {
-        if (Tag.Name != "c")
+        if (Event == tool::XMLEVENT_ERROR)
+        {
+            io::Log::lowerTab();
+            return RenderSystem::createFont();
+        }
+        
+        if (Event != tool::XMLEVENT_TAG_START || Reader.getDepth() != 1)
+            continue;
+        
+        if (!Reader.isName("c"))
         {
             io::Log::warning("Unknown tag in font XML file");
             continue;
         }
         
-        foreach (const tool::SXMLAttribute &Attrib, Tag.Attributes)
+        for (u32 a = 0; a < Reader.getNumAttributes(); ++a)
         {
-            if (Attrib.Name[0] == 'c')
+            const io::stringc Name(Reader.getAttributeName(a));
+            const io::stringc Value(Reader.getAttributeValue(a));
+            
+            if (Name[0] == 'c')
             {
-                if (Attrib.Value.size() == 1)
-                    i = Attrib.Value[0];
-                else if (Attrib.Value.size() > 1 && Attrib.Value[0] == '&')
-                {
-                    if (Attrib.Value == "&quot;")
-                        i = '\"';
-                    else if (Attrib.Value == "&amp;")
-                        i = '&';
-                    else if (Attrib.Value == "&lt;")
-                        i = '&';
-                    else if (Attrib.Value == "&rt;")
-                        i = '<';
-                    else if (Attrib.Value == "&amp;")
-                        i = '>';
-                }
+                if (Value.size() == 1)
+                    i = Value[0];
                 
                 if (i > ' ')
                     i -= ' ';
             }
-            else if (Attrib.Name[0] == 'r' && Attrib.Value.size() == 15)
+            else if (Name[0] == 'r' && Value.size() == 15)
             {
                 GlyphList[i].Rect = dim::rect2di(
-                    Attrib.Value.section( 0,  3).val<s32>(),
-                    Attrib.Value.section( 4,  7).val<s32>(),
-                    Attrib.Value.section( 8, 11).val<s32>(),
-                    Attrib.Value.section(12, 15).val<s32>()
+                    Value.section( 0,  3).val<s32>(),
+                    Value.section( 4,  7).val<s32>(),
+                    Value.section( 8, 11).val<s32>(),
+                    Value.section(12, 15).val<s32>()
                 );
                 
                 s32 Height = GlyphList[i].Rect.Bottom - GlyphList[i].Rect.Top;
@@ -1988,6 +2173,13 @@ void RenderSystem::deleteFont(Font* FontObj)
 {
     if (FontObj)
     {
+        /* Dynamic fonts own their atlas texture */
+        if (FontObj->getAtlas())
+        {
+            Texture* AtlasTexture = FontObj->getAtlas()->getTexture();
+            deleteTexture(AtlasTexture);
+        }
+        
         releaseFontObject(FontObj);
         MemoryManager::removeElement(FontList_, FontObj, true);
     }
@@ -1996,7 +2188,11 @@ void RenderSystem::deleteFont(Font* FontObj)
 void RenderSystem::draw2DText(
     const Font* FontObj, const dim::point2di &Position, const io::stringc &Text, const color &Color, s32 Flags)
 {
-    if (!FontObj || !FontObj->getBufferRawData() || FontObj->getGlyphList().size() < 256)
+    if (!FontObj)
+        return;
+    
+    /* Dynamic fonts have no glyph list limitation */
+    if (!FontObj->getAtlas() && (!FontObj->getBufferRawData() || FontObj->getGlyphList().size() < 256))
         return;
     
     /* Check for drawing flags */
@@ -2032,7 +2228,9 @@ void RenderSystem::draw2DText(
     
     if (Position.X < gSharedObjects.ScreenWidth && Position.Y < gSharedObjects.ScreenHeight && Position.Y > -FontSize.Height)
     {
-        if (FontObj->getTexture())
+        if (FontObj->getAtlas())
+            drawAtlasFont(FontObj, Position, Text, Color);
+        else if (FontObj->getTexture())
             drawTexturedFont(FontObj, Position, Text, Color);
         else
             drawBitmapFont(FontObj, Position, Text, Color);
@@ -2180,6 +2378,22 @@ u32 RenderSystem::getNumMaterialUpdates()
     return 0;
     #endif
 }
+u32 RenderSystem::getNumStateChanges()
+{
+    #ifdef SP_COMPILE_WITH_RENDERSYS_QUERIES
+    return NumStateChanges_;
+    #else
+    return 0;
+    #endif
+}
+u32 RenderSystem::getNumRedundantStateChanges()
+{
+    #ifdef SP_COMPILE_WITH_RENDERSYS_QUERIES
+    return NumRedundantStateChanges_;
+    #else
+    return 0;
+    #endif
+}
 
 
 /*
@@ -2219,7 +2433,7 @@ void RenderSystem::createDeviceFont(
         (Flags & FONT_ITALIC    ) != 0 ? TRUE : FALSE,          // Italic
         (Flags & FONT_UNDERLINED) != 0 ? TRUE : FALSE,          // Underline
         (Flags & FONT_STRIKEOUT ) != 0 ? TRUE : FALSE,          // Strikeout
-        ANSI_CHARSET,                                           // Character set identifier
+        static_cast<DWORD>(CharSet),                            // Character set identifier (0 is ANSI_CHARSET)
         OUT_TT_PRECIS,                                          // Output precision
         CLIP_DEFAULT_PRECIS,                                    // Clipping precision
         ANTIALIASED_QUALITY,                                    // Output quality
@@ -2306,6 +2520,72 @@ void RenderSystem::drawBitmapFont(
     // dummy
 }
 
+void RenderSystem::drawAtlasFont(
+    const Font* FontObj, const dim::point2di &Position, const io::stringc &Text, const color &Color)
+{
+    FontAtlas* Atlas = FontObj->getAtlas();
+    const Texture* Tex = Atlas->getTexture();
+    
+    if (!Tex || Text.empty())
+        return;
+    
+    /* Get cached string layout */
+    const SFontLayout& Layout = Atlas->getLayout(Text);
+    
+    const f32 InvTexWidth   = 1.0f / static_cast<f32>(Tex->getSize().Width);
+    const f32 InvTexHeight  = 1.0f / static_cast<f32>(Tex->getSize().Height);
+    
+    const dim::point2df Origin(static_cast<f32>(Position.X), static_cast<f32>(Position.Y));
+    const bool isTransformed = !FontTransform_.isIdentity();
+    
+    for (u32 i = 0, c = Layout.Chars.size(); i < c; ++i)
+    {
+        /* Get glyph from atlas (this may rasterize the glyph again) */
+        const SFontAtlasGlyph* Glyph = Atlas->getGlyph(Layout.Chars[i]);
+        
+        if (!Glyph || !Glyph->hasImage())
+            continue;
+        
+        const dim::rect2di& Rect = Glyph->Metrics.Rect;
+        
+        /* Setup glyph quad */
+        const f32 Left  = static_cast<f32>(Layout.Offsets[i]);
+        const f32 Right = Left + static_cast<f32>(Rect.Right - Rect.Left);
+        const f32 Height = static_cast<f32>(Rect.Bottom - Rect.Top);
+        
+        dim::point2df Corners[4] =
+        {
+            dim::point2df(Left, 0.0f),
+            dim::point2df(Right, 0.0f),
+            dim::point2df(Right, Height),
+            dim::point2df(Left, Height)
+        };
+        
+        for (u32 j = 0; j < 4; ++j)
+            Corners[j] = (isTransformed ? FontTransform_ * Corners[j] : Corners[j]) + Origin;
+        
+        const dim::rect2df Mapping(
+            static_cast<f32>(Rect.Left  ) * InvTexWidth,
+            static_cast<f32>(Rect.Top   ) * InvTexHeight,
+            static_cast<f32>(Rect.Right ) * InvTexWidth,
+            static_cast<f32>(Rect.Bottom) * InvTexHeight
+        );
+        
+        draw2DImage(
+            Tex,
+            dim::point2di(math::round(Corners[0].X), math::round(Corners[0].Y)),
+            dim::point2di(math::round(Corners[1].X), math::round(Corners[1].Y)),
+            dim::point2di(math::round(Corners[2].X), math::round(Corners[2].Y)),
+            dim::point2di(math::round(Corners[3].X), math::round(Corners[3].Y)),
+            dim::point2df(Mapping.Left, Mapping.Top),
+            dim::point2df(Mapping.Right, Mapping.Top),
+            dim::point2df(Mapping.Right, Mapping.Bottom),
+            dim::point2df(Mapping.Left, Mapping.Bottom),
+            Color, Color, Color, Color
+        );
+    }
+}
+
 // Default font glyph vertex format (OpenGL format)
 struct SFontGlyphVertexGL
 {
@@ -2371,10 +2651,12 @@ void RenderSystem::resetQueryCounters()
 {
     #ifdef SP_COMPILE_WITH_RENDERSYS_QUERIES
     /* Reset draw call counter */
-    NumDrawCalls_           = 0;
-    NumMeshBufferBindings_  = 0;
-    NumTexLayerBindings_    = 0;
-    NumMaterialUpdates_     = 0;
+    NumDrawCalls_               = 0;
+    NumMeshBufferBindings_      = 0;
+    NumTexLayerBindings_        = 0;
+    NumMaterialUpdates_         = 0;
+    NumStateChanges_            = 0;
+    NumRedundantStateChanges_   = 0;
     #endif
 }
 
@@ -25,6 +25,10 @@
 #include "RenderSystem/spTextureBase.hpp"
 #include "RenderSystem/spRenderSystemMovie.hpp"
 #include "RenderSystem/spRenderSystemFont.hpp"
+#include "RenderSystem/spRenderSystemFontAtlas.hpp"
+#include "RenderSystem/spAsyncTextureLoader.hpp"
+#include "RenderSystem/spTextureResidencyManager.hpp"
+#include "Base/spImageBlockCompression.hpp"
 #include "RenderSystem/spQuery.hpp"
 #include "SceneGraph/spSceneLight.hpp"
 
@@ -292,6 +296,13 @@ class SP_EXPORT RenderSystem
         //! Updates the specified hardware index buffer only for the specified element.
         virtual void updateIndexBufferElement(void* BufferID, const dim::UniversalBuffer &BufferData, u32 Index) = 0;
         
+        /**
+        Updates the specified hardware vertex buffer only for the specified range of elements.
+        By default each element is updated with "updateVertexBufferElement".
+        \since Version 3.3
+        */
+        virtual void updateVertexBufferRange(void* BufferID, const dim::UniversalBuffer &BufferData, u32 First, u32 Count);
+        
         /**
          * Binds the specified mesh buffer.
          * \param[in] Buffer Constant pointer to the mesh buffer which is to be bound.
@@ -591,6 +602,25 @@ class SP_EXPORT RenderSystem
         virtual void beginDrawing2D();
         virtual void endDrawing2D();
         
+        /**
+        Draws all pending 2D drawing operations. Some render systems (e.g. OpenGL) collect 2D images, solid rectangles and
+        textured text in a batch and draw them with as few draw calls as possible. The batch is flushed automatically
+        whenever the order of drawing could be affected (e.g. when the clipping, the blending or the render target changes).
+        You only need to call this function when you mix the 2D drawing functions with your own graphics API calls.
+        \since Version 3.3
+        */
+        virtual void flush2DDrawing();
+        
+        /**
+        Invalidates the render state cache. The render systems keep shadow copies of the render states and only
+        change those states which really differ from the previous material. This is done automatically when the
+        active render context changes. You only need to call this function when you change render states
+        with your own graphics API calls.
+        \see getNumRedundantStateChanges
+        \since Version 3.3
+        */
+        virtual void invalidateRenderStates();
+        
         /**
         Configures the renderer to draw further in 3D. This only needs to be called before drawing
         in 3D (draw3DLine etc.) but not to render 3D geometry using "SceneGraph::renderScene.
@@ -893,6 +923,58 @@ class SP_EXPORT RenderSystem
         //! Loads a texture using the specified image loader.
         virtual Texture* loadTexture(ImageLoader* Loader);
         
+        /**
+        Creates a suitable image loader for the specified file. The file format is detected by its magic number.
+        This function does not use any render system resources and can be called from other threads.
+        \param TexFile: Specifies the image file which is to be read.
+        \return Shared pointer to the new image loader or an invalid pointer if the file format is not supported.
+        \since Version 3.3
+        */
+        boost::shared_ptr<ImageLoader> createImageLoader(io::File* TexFile) const;
+        
+        /**
+        Loads a texture asynchronously. The image file is read and decoded by the worker threads of the AsyncTextureLoader
+        and uploaded at the end of a frame (in "SoftPixelDevice::updateEvents") under the upload budget.
+        Until then the texture has a 1x1 placeholder image which is filled with the standard fill color.
+        Like "getTexture" each file is only loaded once.
+        \param Filename: Specifies the image filename.
+        \param Priority: Specifies the loading priority. Lower values are loaded first (e.g. the distance to the camera).
+        \param Callback: Specifies the optional callback which is called after the texture has been uploaded.
+        If the texture has already been loaded (or could not be loaded) the callback is called immediately.
+        \return Pointer to the new placeholder Texture object.
+        \see AsyncTextureLoader
+        \since Version 3.3
+        */
+        virtual Texture* loadTextureAsync(
+            const io::stringc &Filename, f32 Priority = 0.0f, const TextureLoadCallback &Callback = 0
+        );
+        
+        /**
+        Returns the asynchronous texture loader. It will be created with the first call.
+        Use it to change the loading priorities or the upload budget.
+        \since Version 3.3
+        */
+        AsyncTextureLoader* getAsyncTextureLoader();
+        
+        /**
+        Returns the texture residency manager. It will be created with the first call.
+        Once it exists, the texture usage is tracked in "bindTextureLayers" and the memory budget is enforced
+        once per frame (in "SoftPixelDevice::updateEvents").
+        \see TextureResidencyManager
+        \since Version 3.3
+        */
+        TextureResidencyManager* getTextureResidencyManager();
+        
+        /**
+        Enables or disables the disk cache for block compressed textures. When enabled, each compressed image is stored
+        in the specified directory and read from there the next time the same image is compressed with the same settings.
+        \param Path: Specifies the cache directory. This directory must already exist. Pass an empty string to disable the cache.
+        \see BlockCompressionCache
+        \see TEXGEN_COMPRESSION
+        \since Version 3.3
+        */
+        void setTextureCompressionCache(const io::stringc &Path);
+        
         /**
         Returns the specified texture file. This function loads a texture file only once.
         If you call this function several times with the same file the engine will use the same Texture object
@@ -911,7 +993,8 @@ class SP_EXPORT RenderSystem
         Saves the specified texture to the disk.
         \param Tex: Pointer to the Texture object which is to be saved.
         \param Filename: Image filename.
-        \param FileFormat: Image format. Currently only the BMP file format is supported.
+        \param FileFormat: Image format. Currently BMP and DDS are supported. DDS files are block compressed
+        with the texture's compression format (or BC1 and BC3 when the texture is uncompressed).
         \return True if saving the image was successful.
         */
         bool saveTexture(const Texture* Tex, io::stringc Filename, const EImageFileFormats FileFormat = IMAGEFORMAT_BMP);
@@ -1018,13 +1101,36 @@ class SP_EXPORT RenderSystem
         Under MS/Windows this is often "Arial".
         \param[in] FontSize Specifies the font size. By default the standard OS font size.
         \param[in] Flags Additional options for the font. This can be a combination of the following values:
-        FONT_BOLD, FONT_ITALIC, FONT_UNDERLINED, FONT_STRIKEOUT, FONT_SYMBOLS.
+        FONT_BOLD, FONT_ITALIC, FONT_UNDERLINED, FONT_STRIKEOUT, FONT_SYMBOLS, FONT_BITMAP, FONT_DYNAMIC.
         */
         virtual Font* createFont(const io::stringc &FontName = "", s32 FontSize = 0, s32 Flags = 0);
         
         virtual Font* createTexturedFont(const io::stringc &FontName = "", s32 FontSize = 0, s32 Flags = 0);
         virtual Font* createBitmapFont(const io::stringc &FontName = "", s32 FontSize = 0, s32 Flags = 0);
         
+        /**
+        Creates a dynamic font with a GDI glyph rasterizer (MS/Windows only).
+        On other platforms use your own GlyphRasterizer.
+        \see FONT_DYNAMIC
+        \since Version 3.3
+        */
+        virtual Font* createDynamicFont(const io::stringc &FontName = "", s32 FontSize = 0, s32 Flags = 0);
+        
+        /**
+        Creates a dynamic font with the specified glyph rasterizer. The glyphs are rasterized on demand
+        into an atlas texture and the least recently used glyphs are evicted when the atlas is full.
+        \param Rasterizer: Specifies the glyph rasterizer. This will be deleted together with the font.
+        \param FontName: Specifies the font name.
+        \param AtlasSize: Specifies the size of the atlas texture. By default 512 x 512.
+        \return Pointer to the new Font object or null if "Rasterizer" is null.
+        \see FontAtlas
+        \see GlyphRasterizer
+        \since Version 3.3
+        */
+        virtual Font* createFont(
+            GlyphRasterizer* Rasterizer, const io::stringc &FontName = "", const dim::size2di &AtlasSize = dim::size2di(512)
+        );
+        
         //! \deprecated
         virtual Font* createFont(Texture* FontTexture);
         //! \deprecated
@@ -1172,6 +1278,21 @@ class SP_EXPORT RenderSystem
         \see MaterialStates
         */
         static u32 getNumMaterialUpdates();
+        /**
+        Returns the current number of issued render state changes or zero if the engine was not compiled
+        with the 'SP_COMPILE_WITH_RENDERSYS_QUERIES' option. In contrast to the material updates each
+        individual state (e.g. the blend function or the depth test) is counted.
+        \see getNumRedundantStateChanges
+        \since Version 3.3
+        */
+        static u32 getNumStateChanges();
+        /**
+        Returns the current number of redundant render state changes, which have been skipped by the render state cache,
+        or zero if the engine was not compiled with the 'SP_COMPILE_WITH_RENDERSYS_QUERIES' option.
+        \see getNumStateChanges
+        \since Version 3.3
+        */
+        static u32 getNumRedundantStateChanges();
         
         /* === Inline functions === */
         
@@ -1256,6 +1377,26 @@ class SP_EXPORT RenderSystem
             return TexGenFlags_;
         }
         
+        /**
+        Sets the encoder quality for block compressed textures. By default BLOCKQUALITY_NORMAL.
+        \see TEXGEN_COMPRESSION
+        \since Version 3.3
+        */
+        inline void setTextureCompressionQuality(const EBlockCompressionQualities Quality)
+        {
+            TexCompressionQuality_ = Quality;
+        }
+        inline EBlockCompressionQualities getTextureCompressionQuality() const
+        {
+            return TexCompressionQuality_;
+        }
+        
+        //! Returns the block compression disk cache or null if the cache is disabled. \since Version 3.3
+        inline BlockCompressionCache* getTextureCompressionCache() const
+        {
+            return TexCompressionCache_;
+        }
+        
         //! Returns the whole texture list.
         inline const std::list<Texture*>& getTextureList() const
         {
@@ -1417,6 +1558,7 @@ class SP_EXPORT RenderSystem
         friend class VertexFormatUniversal;
         friend class Texture;
         friend class TextureLayer;
+        friend class TextureResidencyManager;
         friend class MeshBuffer;
         friend class sp::SoftPixelDevice;
         //friend class SoftPixelDevice;
@@ -1453,6 +1595,8 @@ class SP_EXPORT RenderSystem
             RENDERQUERY_CUBEMAP_ARRAY,
             RENDERQUERY_TEXTURE_BUFFER,
             RENDERQUERY_SHADER_RESOURCE,
+            RENDERQUERY_TEXTURE_COMPRESSION,
+            RENDERQUERY_TEXTURE_COMPRESSION_RG,
             
             RENDERQUERY_HARDWARE_MESHBUFFER,
             RENDERQUERY_HARDWARE_INSTANCING,
@@ -1463,6 +1607,54 @@ class SP_EXPORT RenderSystem
             RENDERQUERY_COUNT,
         };
         
+        /* === Structures === */
+        
+        /**
+        Shadow copy of a single render state. The render systems only issue an API call
+        when "change" returns true, so that only the states which really differ are changed.
+        */
+        template <typename T> struct SStateCache
+        {
+            SStateCache() :
+                isValid(false)
+            {
+            }
+            ~SStateCache()
+            {
+            }
+            
+            /* Functions */
+            inline bool change(const T &NewState)
+            {
+                if (isValid && State == NewState)
+                {
+                    #ifdef SP_COMPILE_WITH_RENDERSYS_QUERIES
+                    ++RenderSystem::NumRedundantStateChanges_;
+                    #endif
+                    return false;
+                }
+                
+                State   = NewState;
+                isValid = true;
+                
+                #ifdef SP_COMPILE_WITH_RENDERSYS_QUERIES
+                ++RenderSystem::NumStateChanges_;
+                #endif
+                
+                return true;
+            }
+            
+            //! Marks the state as unknown, e.g. after it has been changed without the cache.
+            inline void invalidate()
+            {
+                isValid = false;
+            }
+            
+            /* Members */
+            T State;
+            bool isValid;
+        };
+        
         /* === Functions === */
         
         RenderSystem(const ERenderSystems Type);
@@ -1490,6 +1682,7 @@ class SP_EXPORT RenderSystem
         
         virtual void drawTexturedFont(const Font* FontObj, const dim::point2di &Position, const io::stringc &Text, const color &Color);
         virtual void drawBitmapFont(const Font* FontObj, const dim::point2di &Position, const io::stringc &Text, const color &Color);
+        virtual void drawAtlasFont(const Font* FontObj, const dim::point2di &Position, const io::stringc &Text, const color &Color);
         
         virtual void createTexturedFontVertexBuffer(dim::UniversalBuffer &VertexBuffer, VertexFormatUniversal &VertFormat);
         virtual void setupTexturedFontGlyph(void* &RawVertexData, const SFontGlyph &Glyph, const dim::rect2df &Mapping);
@@ -1552,6 +1745,12 @@ class SP_EXPORT RenderSystem
         
         std::map<std::string, Texture*> TextureMap_;
         
+        AsyncTextureLoader* AsyncTextureLoader_;
+        TextureResidencyManager* TextureResidencyManager_;
+        
+        EBlockCompressionQualities TexCompressionQuality_;
+        BlockCompressionCache* TexCompressionCache_;
+        
         std::vector<RenderContext*> ContextList_;
         
         /* Semaphores */
@@ -1604,10 +1803,12 @@ class SP_EXPORT RenderSystem
         
         #ifdef SP_COMPILE_WITH_RENDERSYS_QUERIES
         
-        static u32 NumDrawCalls_;           //!< Draw call counter. This counter will always be incremented when "drawMeshBuffer" has been called.
-        static u32 NumMeshBufferBindings_;  //!< Mesh buffer binding counter.
-        static u32 NumTexLayerBindings_;    //!< Texture layer list binding counter.
-        static u32 NumMaterialUpdates_;     //!< Material states update counter.
+        static u32 NumDrawCalls_;               //!< Draw call counter. This counter will always be incremented when "drawMeshBuffer" has been called.
+        static u32 NumMeshBufferBindings_;      //!< Mesh buffer binding counter.
+        static u32 NumTexLayerBindings_;        //!< Texture layer list binding counter.
+        static u32 NumMaterialUpdates_;         //!< Material states update counter.
+        static u32 NumStateChanges_;            //!< Issued render state change counter.
+        static u32 NumRedundantStateChanges_;   //!< Skipped (redundant) render state change counter.
         
         #endif
         
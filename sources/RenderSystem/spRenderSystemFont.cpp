@@ -6,6 +6,7 @@
  */
 
 #include "RenderSystem/spRenderSystemFont.hpp"
+#include "RenderSystem/spRenderSystemFontAtlas.hpp"
 #include "Platform/spSoftPixelDeviceOS.hpp"
 
 #if defined(SP_PLATFORM_WINDOWS)
@@ -22,7 +23,8 @@ namespace video
 Font::Font() :
     BufferRawData_  (0  ),
     GlyphList_      (256),
-    Texture_        (0  )
+    Texture_        (0  ),
+    Atlas_          (0  )
 {
 }
 Font::Font(
@@ -32,17 +34,34 @@ Font::Font(
     FontName_       (FontName       ),
     Size_           (Size           ),
     GlyphList_      (GlyphList      ),
-    Texture_        (FontTexture    )
+    Texture_        (FontTexture    ),
+    Atlas_          (0              )
 {
     if (GlyphList_.size() < 256)
         GlyphList_.resize(256);
 }
+Font::Font(FontAtlas* Atlas, const io::stringc &FontName, const dim::size2di &Size) :
+    BufferRawData_  (0          ),
+    FontName_       (FontName   ),
+    Size_           (Size       ),
+    GlyphList_      (256        ),
+    Texture_        (0          ),
+    Atlas_          (Atlas      )
+{
+    if (Atlas_)
+        Texture_ = Atlas_->getTexture();
+}
 Font::~Font()
 {
+    delete Atlas_;
 }
 
 s32 Font::getStringWidth(const io::stringc &Text) const
 {
+    /* Dynamic fonts use the cached string layout */
+    if (Atlas_)
+        return Atlas_->getStringWidth(Text);
+        
     #if defined(SP_PLATFORM_LINUX)
     
     return Text.size() * Size_.Width;
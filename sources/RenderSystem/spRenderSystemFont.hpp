@@ -22,6 +22,9 @@ namespace video
 {
 
 
+class FontAtlas;
+class GlyphRasterizer;
+
 //! Font creation flags
 enum EFontFlags
 {
@@ -31,6 +34,7 @@ enum EFontFlags
     FONT_STRIKEOUT  = 0x08, //!< Text is striked out.
     FONT_SYMBOLS    = 0x10, //!< Text may contain special symbols.
     FONT_BITMAP     = 0x20, //!< Uses bitmap font instead of textured font. This is slower and looks worse.
+    FONT_DYNAMIC    = 0x40, //!< Uses a dynamic glyph atlas. The glyphs are rasterized on demand and the texts are decoded as UTF-8. Use this for large character sets (e.g. CJK). \since Version 3.3
 };
 
 struct SP_EXPORT SFontGlyph
@@ -68,6 +72,12 @@ class SP_EXPORT Font
             const dim::size2di &Size, const std::vector<SFontGlyph> &GlyphList,
             video::Texture* FontTexture = 0
         );
+        /**
+        Dynamic font constructor.
+        \param Atlas: Specifies the glyph atlas. This will be deleted by the font.
+        \since Version 3.3
+        */
+        Font(FontAtlas* Atlas, const io::stringc &FontName, const dim::size2di &Size);
         ~Font();
         
         /* === Functions === */
@@ -128,6 +138,16 @@ class SP_EXPORT Font
             return GlyphList_;
         }
         
+        /**
+        Returns the glyph atlas if this is a dynamic font. Otherwise null.
+        \see FONT_DYNAMIC
+        \since Version 3.3
+        */
+        inline FontAtlas* getAtlas() const
+        {
+            return Atlas_;
+        }
+        
     private:
         
         #ifdef SP_COMPILE_WITH_DIRECT3D11
@@ -148,6 +168,8 @@ class SP_EXPORT Font
         
         video::Texture* Texture_;
         
+        FontAtlas* Atlas_;
+        
 };
 
 
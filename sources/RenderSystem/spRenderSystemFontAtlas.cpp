@@ -0,0 +1,518 @@
+/*
+ * Font atlas file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "RenderSystem/spRenderSystemFontAtlas.hpp"
+#include "RenderSystem/spTextureBase.hpp"
+#include "Base/spInputOutputLog.hpp"
+
+#include <algorithm>
+
+
+namespace sp
+{
+namespace video
+{
+
+
+FontAtlas::FontAtlas(GlyphRasterizer* Rasterizer, Texture* AtlasTexture) :
+    Rasterizer_         (Rasterizer     ),
+    Texture_            (AtlasTexture   ),
+    ShelvesHeight_      (0              ),
+    MaxLayoutCount_     (1024           ),
+    UseCounter_         (0              ),
+    NumRasterizedGlyphs_(0              ),
+    NumEvictions_       (0              ),
+    NumLayoutHits_      (0              ),
+    NumLayoutMisses_    (0              )
+{
+    if ( !Texture_ || !Texture_->getImageBuffer() || Texture_->getImageBuffer()->getType() != IMAGEBUFFER_UBYTE ||
+         Texture_->getImageBuffer()->getFormat() != PIXELFORMAT_RGBA )
+    {
+        io::Log::error("Font atlas texture must have an RGBA image buffer with unsigned bytes");
+        Texture_ = 0;
+    }
+    else
+    {
+        clearArea(dim::point2di(0, 0), Texture_->getImageBuffer()->getSize());
+        Texture_->updateImageBuffer();
+    }
+}
+FontAtlas::~FontAtlas()
+{
+    delete Rasterizer_;
+}
+
+const SFontAtlasGlyph* FontAtlas::getGlyph(u32 Char)
+{
+    std::map<u32, SFontAtlasGlyph>::iterator it = Glyphs_.find(Char);
+    
+    if (it != Glyphs_.end())
+    {
+        SFontAtlasGlyph* Glyph = &(it->second);
+        
+        /* Characters which are not in the font are only rasterized once */
+        if (!Glyph->isExisting)
+            return 0;
+        
+        if (Glyph->isResident)
+        {
+            if (Glyph->hasImage())
+                Shelves_[Glyph->Shelf].LastUse = UseCounter_;
+            return Glyph;
+        }
+    }
+    
+    /* Rasterize glyph image */
+    SFontAtlasGlyph* Glyph = &(Glyphs_[Char]);
+    
+    dim::size2di ImageSize;
+    GlyphImage_.clear();
+    
+    Glyph->Shelf        = -1;
+    Glyph->Metrics.Rect = dim::rect2di();
+    
+    if (!Rasterizer_ || !Rasterizer_->rasterize(Char, Glyph->Metrics, ImageSize, GlyphImage_))
+    {
+        Glyph->isExisting = false;
+        Glyph->isResident = true;
+        return 0;
+    }
+    
+    Glyph->isExisting = true;
+    ++NumRasterizedGlyphs_;
+    
+    /* Empty glyphs (e.g. white spaces) don't need any space in the atlas */
+    if (ImageSize.Width <= 0 || ImageSize.Height <= 0)
+    {
+        Glyph->Metrics.Rect = dim::rect2di();
+        Glyph->isResident   = true;
+        return Glyph;
+    }
+    
+    if (GlyphImage_.size() < static_cast<u32>(ImageSize.getArea()))
+    {
+        io::Log::error("Glyph image of character " + io::stringc(Char) + " is too small");
+        Glyph->isResident = false;
+        return Glyph;
+    }
+    
+    Glyph->isResident = insertImage(Char, *Glyph, ImageSize);
+    
+    return Glyph;
+}
+
+const SFontLayout& FontAtlas::getLayout(const io::stringc &Text)
+{
+    ++UseCounter_;
+    
+    /* Search layout in the cache */
+    std::map<std::string, SFontLayout>::iterator it = Layouts_.find(Text.str());
+    
+    if (it != Layouts_.end())
+    {
+        ++NumLayoutHits_;
+        it->second.LastUse = UseCounter_;
+        return it->second;
+    }
+    
+    ++NumLayoutMisses_;
+    
+    if (Layouts_.size() >= MaxLayoutCount_)
+        removeOldLayouts();
+    
+    SFontLayout& Layout = Layouts_[Text.str()];
+    Layout.LastUse = UseCounter_;
+    
+    /* Decode UTF-8 string and compute the glyph offsets */
+    s32 Move = 0;
+    u32 PrevChar = 0;
+    
+    for (u32 Pos = 0; Pos < Text.size();)
+    {
+        u32 Char = Text.decodeUTF8(Pos);
+        
+        const SFontAtlasGlyph* Glyph = getGlyph(Char);
+        
+        if (!Glyph)
+        {
+            /* Use question mark for characters which are not in the font */
+            Char = '?';
+            Glyph = getGlyph(Char);
+            
+            if (!Glyph)
+                continue;
+        }
+        
+        if (PrevChar && Rasterizer_)
+            Move += Rasterizer_->getKerning(PrevChar, Char);
+        
+        Layout.Chars.push_back(Char);
+        Layout.Offsets.push_back(Move + Glyph->Metrics.StartOffset);
+        
+        Move += Glyph->Metrics.getWidth();
+        PrevChar = Char;
+    }
+    
+    Layout.Width = Move;
+    
+    return Layout;
+}
+
+s32 FontAtlas::getStringWidth(const io::stringc &Text)
+{
+    return getLayout(Text).Width;
+}
+
+void FontAtlas::clear()
+{
+    Glyphs_.clear();
+    Shelves_.clear();
+    Layouts_.clear();
+    
+    ShelvesHeight_ = 0;
+    
+    if (Texture_)
+    {
+        clearArea(dim::point2di(0, 0), Texture_->getImageBuffer()->getSize());
+        Texture_->updateImageBuffer();
+    }
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+bool FontAtlas::insertImage(u32 Char, SFontAtlasGlyph &Glyph, const dim::size2di &ImageSize)
+{
+    if (!Texture_)
+        return false;
+    
+    /* Each glyph cell has one pixel padding to avoid color bleeding */
+    const dim::size2di CellSize(ImageSize.Width + 1, ImageSize.Height + 1);
+    
+    ImageBuffer* ImgBuffer = Texture_->getImageBuffer();
+    const dim::size2di TexSize(ImgBuffer->getSize());
+    
+    if (CellSize.Width > TexSize.Width || CellSize.Height > TexSize.Height)
+    {
+        io::Log::error("Glyph image of character " + io::stringc(Char) + " does not fit into the font atlas");
+        return false;
+    }
+    
+    /* Find shelf for the glyph */
+    s32 Index = findShelf(CellSize);
+    
+    if (Index < 0)
+    {
+        /* Rebuild the whole atlas when no shelf is large enough */
+        for (u32 i = 0; i < Shelves_.size(); ++i)
+            evictShelf(i);
+        
+        Shelves_.clear();
+        ShelvesHeight_ = 0;
+        
+        Index = findShelf(CellSize);
+    }
+    
+    SShelf& Shelf = Shelves_[Index];
+    
+    const dim::point2di Pos(Shelf.Width, Shelf.Y);
+    
+    Shelf.Width     += CellSize.Width;
+    Shelf.LastUse   = UseCounter_;
+    Shelf.Chars.push_back(Char);
+    
+    Glyph.Metrics.Rect  = dim::rect2di(Pos.X, Pos.Y, Pos.X + ImageSize.Width, Pos.Y + ImageSize.Height);
+    Glyph.Shelf         = Index;
+    
+    /* Copy glyph image as alpha channel into the atlas (the color is always white) */
+    u8* Buffer = static_cast<u8*>(ImgBuffer->getBuffer());
+    const u8* Image = &GlyphImage_[0];
+    
+    for (s32 y = 0; y < CellSize.Height; ++y)
+    {
+        u8* Row = Buffer + ((Pos.Y + y) * TexSize.Width + Pos.X) * 4;
+        
+        for (s32 x = 0; x < CellSize.Width; ++x, Row += 4)
+        {
+            Row[0] = 255;
+            Row[1] = 255;
+            Row[2] = 255;
+            Row[3] = (x < ImageSize.Width && y < ImageSize.Height ? Image[y * ImageSize.Width + x] : 0);
+        }
+    }
+    
+    Texture_->updateImageBuffer(Pos, CellSize);
+    
+    return true;
+}
+
+s32 FontAtlas::findShelf(const dim::size2di &Size)
+{
+    const dim::size2di TexSize(Texture_->getImageBuffer()->getSize());
+    
+    /* Find best fitting shelf with enough free space */
+    s32 Index = -1;
+    
+    for (u32 i = 0; i < Shelves_.size(); ++i)
+    {
+        const SShelf& Shelf = Shelves_[i];
+        
+        if ( Shelf.Height >= Size.Height && Shelf.Height - Size.Height <= Size.Height/4 &&
+             Shelf.Width + Size.Width <= TexSize.Width &&
+             ( Index < 0 || Shelf.Height < Shelves_[Index].Height ) )
+        {
+            Index = static_cast<s32>(i);
+        }
+    }
+    
+    if (Index >= 0)
+        return Index;
+    
+    /* Open a new shelf */
+    if (ShelvesHeight_ + Size.Height <= TexSize.Height)
+    {
+        SShelf Shelf;
+        {
+            Shelf.Y         = ShelvesHeight_;
+            Shelf.Height    = Size.Height;
+            Shelf.Width     = 0;
+            Shelf.LastUse   = UseCounter_;
+        }
+        Shelves_.push_back(Shelf);
+        
+        ShelvesHeight_ += Size.Height;
+        
+        return static_cast<s32>(Shelves_.size()) - 1;
+    }
+    
+    /* Evict the least recently used shelf which is large enough */
+    for (u32 i = 0; i < Shelves_.size(); ++i)
+    {
+        const SShelf& Shelf = Shelves_[i];
+        
+        if ( Shelf.Height >= Size.Height &&
+             ( Index < 0 || Shelf.LastUse < Shelves_[Index].LastUse ) )
+        {
+            Index = static_cast<s32>(i);
+        }
+    }
+    
+    if (Index >= 0)
+        evictShelf(Index);
+    
+    return Index;
+}
+
+void FontAtlas::evictShelf(u32 Index)
+{
+    SShelf& Shelf = Shelves_[Index];
+    
+    if (Shelf.Chars.empty())
+        return;
+    
+    /* Mark all glyphs of this shelf as evicted */
+    for (std::vector<u32>::iterator it = Shelf.Chars.begin(); it != Shelf.Chars.end(); ++it)
+    {
+        std::map<u32, SFontAtlasGlyph>::iterator itGlyph = Glyphs_.find(*it);
+        
+        if (itGlyph != Glyphs_.end() && itGlyph->second.Shelf == static_cast<s32>(Index))
+        {
+            itGlyph->second.Shelf       = -1;
+            itGlyph->second.isResident  = false;
+        }
+    }
+    
+    Shelf.Chars.clear();
+    Shelf.Width = 0;
+    
+    /* Clear shelf area */
+    const dim::point2di Pos(0, Shelf.Y);
+    const dim::size2di Size(Texture_->getImageBuffer()->getSize().Width, Shelf.Height);
+    
+    clearArea(Pos, Size);
+    Texture_->updateImageBuffer(Pos, Size);
+    
+    ++NumEvictions_;
+}
+
+void FontAtlas::clearArea(const dim::point2di &Pos, const dim::size2di &Size)
+{
+    ImageBuffer* ImgBuffer = Texture_->getImageBuffer();
+    
+    u8* Buffer = static_cast<u8*>(ImgBuffer->getBuffer());
+    const s32 Width = ImgBuffer->getSize().Width;
+    
+    for (s32 y = 0; y < Size.Height; ++y)
+    {
+        u8* Row = Buffer + ((Pos.Y + y) * Width + Pos.X) * 4;
+        
+        for (s32 x = 0; x < Size.Width; ++x, Row += 4)
+        {
+            Row[0] = 255;
+            Row[1] = 255;
+            Row[2] = 255;
+            Row[3] = 0;
+        }
+    }
+}
+
+void FontAtlas::removeOldLayouts()
+{
+    /* Remove the least recently used half of all layouts */
+    std::vector<u32> LastUses;
+    LastUses.reserve(Layouts_.size());
+    
+    for (std::map<std::string, SFontLayout>::iterator it = Layouts_.begin(); it != Layouts_.end(); ++it)
+        LastUses.push_back(it->second.LastUse);
+    
+    std::vector<u32>::iterator itMedian = LastUses.begin() + LastUses.size()/2;
+    std::nth_element(LastUses.begin(), itMedian, LastUses.end());
+    
+    const u32 MedianUse = *itMedian;
+    
+    for (std::map<std::string, SFontLayout>::iterator it = Layouts_.begin(); it != Layouts_.end();)
+    {
+        if (it->second.LastUse < MedianUse)
+            Layouts_.erase(it++);
+        else
+            ++it;
+    }
+}
+
+
+#if defined(SP_PLATFORM_WINDOWS)
+
+/*
+ * GDIGlyphRasterizer class
+ */
+
+GDIGlyphRasterizer::GDIGlyphRasterizer(HDC DeviceContext, HFONT FontHandle) :
+    DeviceContext_  (CreateCompatibleDC(DeviceContext)  ),
+    FontHandle_     (FontHandle                         ),
+    PrevFont_       (0                                  )
+{
+    PrevFont_ = SelectObject(DeviceContext_, FontHandle_);
+    
+    GetTextMetrics(DeviceContext_, &Metrics_);
+    
+    /* Store kerning pairs */
+    const DWORD NumPairs = GetKerningPairsW(DeviceContext_, 0, 0);
+    
+    if (NumPairs > 0)
+    {
+        std::vector<KERNINGPAIR> Pairs(NumPairs);
+        GetKerningPairsW(DeviceContext_, NumPairs, &Pairs[0]);
+        
+        for (std::vector<KERNINGPAIR>::iterator it = Pairs.begin(); it != Pairs.end(); ++it)
+            KerningPairs_[(static_cast<u32>(it->wFirst) << 16) | it->wSecond] = it->iKernAmount;
+    }
+}
+GDIGlyphRasterizer::~GDIGlyphRasterizer()
+{
+    SelectObject(DeviceContext_, PrevFont_);
+    DeleteObject(FontHandle_);
+    DeleteDC(DeviceContext_);
+}
+
+bool GDIGlyphRasterizer::rasterize(u32 Char, SFontGlyph &Metrics, dim::size2di &ImageSize, std::vector<u8> &Image)
+{
+    if (Char > 0xFFFF)
+        return false;
+    
+    /* Check if the font contains this character */
+    WCHAR WideChar = static_cast<WCHAR>(Char);
+    WORD GlyphIndex = 0;
+    
+    if ( GetGlyphIndicesW(DeviceContext_, &WideChar, 1, &GlyphIndex, GGI_MARK_NONEXISTING_GLYPHS) == GDI_ERROR ||
+         GlyphIndex == 0xFFFF )
+    {
+        return false;
+    }
+    
+    /* Query glyph metrics and the size of the anti-aliased glyph bitmap */
+    static const MAT2 Transform = { { 0, 1 }, { 0, 0 }, { 0, 0 }, { 0, 1 } };
+    
+    GLYPHMETRICS GlyphMetrics;
+    const DWORD BufferSize = GetGlyphOutlineW(DeviceContext_, Char, GGO_GRAY8_BITMAP, &GlyphMetrics, 0, 0, &Transform);
+    
+    if (BufferSize == GDI_ERROR)
+        return false;
+    
+    if (BufferSize == 0)
+    {
+        /* Empty glyph (e.g. white space) */
+        Metrics.StartOffset = 0;
+        Metrics.DrawnWidth  = 0;
+        Metrics.WhiteSpace  = GlyphMetrics.gmCellIncX;
+        
+        ImageSize = dim::size2di(0, 0);
+        
+        return true;
+    }
+    
+    Metrics.StartOffset = GlyphMetrics.gmptGlyphOrigin.x;
+    Metrics.DrawnWidth  = static_cast<s32>(GlyphMetrics.gmBlackBoxX);
+    Metrics.WhiteSpace  = GlyphMetrics.gmCellIncX - Metrics.StartOffset - Metrics.DrawnWidth;
+    
+    Buffer_.resize(BufferSize);
+    
+    if (GetGlyphOutlineW(DeviceContext_, Char, GGO_GRAY8_BITMAP, &GlyphMetrics, BufferSize, &Buffer_[0], &Transform) == GDI_ERROR)
+        return false;
+    
+    /* Copy glyph bitmap into the full line height image (GGO_GRAY8_BITMAP has 65 gray levels and DWORD aligned rows) */
+    const s32 Width     = static_cast<s32>(GlyphMetrics.gmBlackBoxX);
+    const s32 Height    = Metrics_.tmHeight;
+    const s32 Pitch     = (Width + 3) & ~3;
+    const s32 Top       = Metrics_.tmAscent - GlyphMetrics.gmptGlyphOrigin.y;
+    
+    ImageSize = dim::size2di(Width, Height);
+    Image.assign(Width * Height, 0);
+    
+    for (s32 y = 0; y < static_cast<s32>(GlyphMetrics.gmBlackBoxY); ++y)
+    {
+        const s32 DestY = Top + y;
+        
+        if (DestY < 0 || DestY >= Height)
+            continue;
+        
+        const u8* Src = &Buffer_[y * Pitch];
+        u8* Dest = &Image[DestY * Width];
+        
+        for (s32 x = 0; x < Width; ++x)
+            Dest[x] = static_cast<u8>(math::Min(255, static_cast<s32>(Src[x]) * 255 / 64));
+    }
+    
+    return true;
+}
+
+s32 GDIGlyphRasterizer::getKerning(u32 PrevChar, u32 Char) const
+{
+    if (PrevChar > 0xFFFF || Char > 0xFFFF || KerningPairs_.empty())
+        return 0;
+    
+    std::map<u32, s32>::const_iterator it = KerningPairs_.find((PrevChar << 16) | Char);
+    
+    return it != KerningPairs_.end() ? it->second : 0;
+}
+
+s32 GDIGlyphRasterizer::getHeight() const
+{
+    return Metrics_.tmHeight;
+}
+
+#endif
+
+
+} // /namespace video
+
+} // /namespace sp
+
+
+
+// ================================================================================
@@ -0,0 +1,308 @@
+/*
+ * Font atlas header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_VIDEODRIVER_FONT_ATLAS_H__
+#define __SP_VIDEODRIVER_FONT_ATLAS_H__
+
+
+#include "Base/spStandard.hpp"
+#include "Base/spInputOutputString.hpp"
+#include "Base/spDimension.hpp"
+#include "RenderSystem/spRenderSystemFont.hpp"
+
+#include <vector>
+#include <map>
+#include <string>
+
+#if defined(SP_PLATFORM_WINDOWS)
+#   include <windows.h>
+#endif
+
+
+namespace sp
+{
+namespace video
+{
+
+
+class Texture;
+
+/**
+Glyph rasterizer interface. The FontAtlas uses it to rasterize the glyphs on demand.
+Implement this interface to use another font library (e.g. FreeType) for dynamic fonts.
+\see FontAtlas
+\see RenderSystem::createFont(GlyphRasterizer*, const io::stringc&, const dim::size2di&)
+\since Version 3.3
+*/
+class SP_EXPORT GlyphRasterizer
+{
+    
+    public:
+        
+        virtual ~GlyphRasterizer()
+        {
+        }
+        
+        /* === Functions === */
+        
+        /**
+        Rasterizes the specified character.
+        \param Char: Specifies the unicode character (code point).
+        \param Metrics: Receives the glyph metrics (StartOffset, DrawnWidth and WhiteSpace). The rectangle will be ignored.
+        \param ImageSize: Receives the size of the glyph image. The image height should be the font height
+        because the glyphs are drawn at the top of the text line. Empty glyphs (e.g. white spaces) have a size of (0, 0).
+        \param Image: Receives the glyph image as 8-bit coverage values (one byte per pixel, row by row).
+        \return False if the font does not contain this character.
+        */
+        virtual bool rasterize(u32 Char, SFontGlyph &Metrics, dim::size2di &ImageSize, std::vector<u8> &Image) = 0;
+        
+        //! Returns the kerning (in pixels) which is added between the two specified characters. By default 0.
+        virtual s32 getKerning(u32 /*PrevChar*/, u32 /*Char*/) const
+        {
+            return 0;
+        }
+        
+        //! Returns the font height (in pixels).
+        virtual s32 getHeight() const = 0;
+        
+};
+
+
+#if defined(SP_PLATFORM_WINDOWS)
+
+/**
+Glyph rasterizer for GDI fonts (MS/Windows only). The glyphs are rasterized with anti-aliasing by "GetGlyphOutlineW"
+and the kerning pairs of the font are used. Only characters of the basic multilingual plane are supported.
+\since Version 3.3
+*/
+class SP_EXPORT GDIGlyphRasterizer : public GlyphRasterizer
+{
+    
+    public:
+        
+        /**
+        GDI glyph rasterizer constructor.
+        \param DeviceContext: Specifies the device context for which a compatible memory device context will be created.
+        \param FontHandle: Specifies the GDI font. This will be deleted by the rasterizer.
+        */
+        GDIGlyphRasterizer(HDC DeviceContext, HFONT FontHandle);
+        ~GDIGlyphRasterizer();
+        
+        /* === Functions === */
+        
+        bool rasterize(u32 Char, SFontGlyph &Metrics, dim::size2di &ImageSize, std::vector<u8> &Image);
+        
+        s32 getKerning(u32 PrevChar, u32 Char) const;
+        
+        s32 getHeight() const;
+        
+    private:
+        
+        /* === Members === */
+        
+        HDC DeviceContext_;
+        HFONT FontHandle_;
+        HGDIOBJ PrevFont_;
+        
+        TEXTMETRIC Metrics_;
+        
+        std::map<u32, s32> KerningPairs_;
+        std::vector<u8> Buffer_;
+        
+};
+
+#endif
+
+
+//! Glyph entry of the FontAtlas.
+struct SFontAtlasGlyph
+{
+    SFontAtlasGlyph() :
+        Shelf       (-1     ),
+        isResident  (false  ),
+        isExisting  (false  )
+    {
+    }
+    ~SFontAtlasGlyph()
+    {
+    }
+    
+    /* Inline functions */
+    
+    //! Returns true if the glyph has an image in the atlas texture.
+    inline bool hasImage() const
+    {
+        return Shelf >= 0;
+    }
+    
+    /* Members */
+    SFontGlyph Metrics;     //!< Glyph metrics. The rectangle is the glyph area in the atlas texture.
+    s32 Shelf;              //!< Shelf index in the atlas or -1 if the glyph has no image.
+    bool isResident;        //!< False if the glyph image has been evicted from the atlas.
+    bool isExisting;        //!< False if the font does not contain this character.
+};
+
+//! Cached layout of one string.
+struct SFontLayout
+{
+    SFontLayout() :
+        Width   (0),
+        LastUse (0)
+    {
+    }
+    ~SFontLayout()
+    {
+    }
+    
+    /* Members */
+    std::vector<u32> Chars;     //!< Decoded unicode characters.
+    std::vector<s32> Offsets;   //!< Horizontal drawing offset of each glyph image (with regard to the kerning).
+    s32 Width;                  //!< Complete text width.
+    u32 LastUse;
+};
+
+
+/**
+Dynamic glyph atlas for large character sets (e.g. CJK). The glyphs are rasterized on demand by a GlyphRasterizer
+and packed into the atlas texture with a shelf packer. When the atlas is full, the least recently used shelf
+is evicted and its glyphs will be rasterized again when they are needed. The texts are decoded as UTF-8 and the layout
+(advance widths and kerning) of each string is cached, so that repeated labels are not measured again.
+\see FONT_DYNAMIC
+\since Version 3.3
+*/
+class SP_EXPORT FontAtlas
+{
+    
+    public:
+        
+        /**
+        Font atlas constructor.
+        \param Rasterizer: Specifies the glyph rasterizer. This will be deleted by the atlas.
+        \param AtlasTexture: Specifies the atlas texture. This must have an RGBA image buffer.
+        The atlas does not delete this texture.
+        */
+        FontAtlas(GlyphRasterizer* Rasterizer, Texture* AtlasTexture);
+        ~FontAtlas();
+        
+        /* === Functions === */
+        
+        /**
+        Returns the glyph of the specified character. If the glyph is not in the atlas it will be rasterized.
+        \return Pointer to the glyph entry or null if the glyph could not be rasterized.
+        */
+        const SFontAtlasGlyph* getGlyph(u32 Char);
+        
+        //! Returns the cached layout of the specified UTF-8 string. This layout is computed only once.
+        const SFontLayout& getLayout(const io::stringc &Text);
+        
+        //! Returns the width of the specified UTF-8 string.
+        s32 getStringWidth(const io::stringc &Text);
+        
+        //! Removes all glyphs from the atlas and clears the layout cache.
+        void clear();
+        
+        /* === Inline functions === */
+        
+        //! Returns the atlas texture.
+        inline Texture* getTexture() const
+        {
+            return Texture_;
+        }
+        //! Returns the glyph rasterizer.
+        inline GlyphRasterizer* getRasterizer() const
+        {
+            return Rasterizer_;
+        }
+        
+        /**
+        Sets the maximal count of cached string layouts. By default 1024.
+        When this count is exceeded the least recently used half of the layouts is removed.
+        */
+        inline void setMaxLayoutCount(u32 Count)
+        {
+            MaxLayoutCount_ = math::Max(1u, Count);
+        }
+        inline u32 getMaxLayoutCount() const
+        {
+            return MaxLayoutCount_;
+        }
+        
+        //! Returns the count of glyph images which have been rasterized.
+        inline u32 getNumRasterizedGlyphs() const
+        {
+            return NumRasterizedGlyphs_;
+        }
+        //! Returns the count of evicted shelves.
+        inline u32 getNumEvictions() const
+        {
+            return NumEvictions_;
+        }
+        //! Returns the count of string layouts which were found in the layout cache.
+        inline u32 getNumLayoutHits() const
+        {
+            return NumLayoutHits_;
+        }
+        //! Returns the count of string layouts which had to be computed.
+        inline u32 getNumLayoutMisses() const
+        {
+            return NumLayoutMisses_;
+        }
+        
+    private:
+        
+        /* === Structures === */
+        
+        struct SShelf
+        {
+            s32 Y, Height, Width;
+            u32 LastUse;
+            std::vector<u32> Chars;
+        };
+        
+        /* === Functions === */
+        
+        bool insertImage(u32 Char, SFontAtlasGlyph &Glyph, const dim::size2di &ImageSize);
+        s32 findShelf(const dim::size2di &Size);
+        
+        void evictShelf(u32 Index);
+        void clearArea(const dim::point2di &Pos, const dim::size2di &Size);
+        
+        void removeOldLayouts();
+        
+        /* === Members === */
+        
+        GlyphRasterizer* Rasterizer_;
+        Texture* Texture_;
+        
+        std::map<u32, SFontAtlasGlyph> Glyphs_;
+        std::vector<SShelf> Shelves_;
+        s32 ShelvesHeight_;
+        
+        std::map<std::string, SFontLayout> Layouts_;
+        u32 MaxLayoutCount_;
+        
+        u32 UseCounter_;
+        std::vector<u8> GlyphImage_;
+        
+        u32 NumRasterizedGlyphs_;
+        u32 NumEvictions_;
+        u32 NumLayoutHits_;
+        u32 NumLayoutMisses_;
+        
+};
+
+
+} // /namespace video
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
@@ -24,6 +24,8 @@ namespace video
 ShaderClass::ShaderClass() :
     ObjectCallback_         (0      ),
     SurfaceCallback_        (0      ),
+    InstanceCallback_       (0      ),
+    MaxInstances_           (256    ),
     VertexShader_           (0      ),
     PixelShader_            (0      ),
     GeometryShader_         (0      ),
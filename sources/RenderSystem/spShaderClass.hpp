@@ -255,6 +255,31 @@ class SP_EXPORT ShaderClass : public BaseObject
             SurfaceCallback_ = CallbackProc;
         }
         
+        /**
+        Sets the shader instance callback function. Meshes which use this shader class can only be
+        drawn instanced by the scene graph (see SceneGraph::setAutoInstancing) when this callback is set.
+        \param[in] CallbackProc Specifies the instance callback function.
+        \param[in] MaxInstances Specifies the maximal count of instances which can be drawn at once,
+        e.g. the count of world matrices which fit into the constant buffer of the vertex shader. By default 256.
+        \see ShaderInstanceCallback
+        \since Version 3.3
+        */
+        inline void setInstanceCallback(const ShaderInstanceCallback &CallbackProc, u32 MaxInstances = 256)
+        {
+            InstanceCallback_   = CallbackProc;
+            MaxInstances_       = math::Max(1u, MaxInstances);
+        }
+        
+        inline const ShaderInstanceCallback& getInstanceCallback() const
+        {
+            return InstanceCallback_;
+        }
+        //! Returns the maximal count of instances which can be drawn at once. By default 256.
+        inline u32 getMaxInstances() const
+        {
+            return MaxInstances_;
+        }
+        
         inline Shader* getVertexShader() const
         {
             return VertexShader_;
@@ -347,6 +372,9 @@ class SP_EXPORT ShaderClass : public BaseObject
         
         ShaderObjectCallback ObjectCallback_;
         ShaderSurfaceCallback SurfaceCallback_;
+        ShaderInstanceCallback InstanceCallback_;
+        
+        u32 MaxInstances_;
         
         Shader* VertexShader_;
         Shader* PixelShader_;
@@ -10,6 +10,7 @@
 
 
 #include "Base/spStandard.hpp"
+#include "Base/spDimensionMatrix4.hpp"
 
 #include <boost/function.hpp>
 #include <vector>
@@ -170,9 +171,22 @@ textures.
 */
 typedef boost::function<void (ShaderClass* ShdClass, const std::vector<TextureLayer*> &TexLayers)> ShaderSurfaceCallback;
 
+/**
+Construction of the shader instance callback. This is called before a batch of mesh instances is drawn with one
+instanced draw call (see SceneGraph::setAutoInstancing). Upload the world matrices to the shader (e.g. into a constant buffer)
+and use the instance index (e.g. "gl_InstanceID" in GLSL or "SV_InstanceID" in HLSL) to select the world matrix of each instance.
+\param[in] ShdClass Pointer to a ShaderClass object which is currently used.
+\param[in] WorldMatrices Constant pointer to the world matrices of all instances.
+\param[in] NumInstances Specifies the count of instances. This is never greater than the maximal count
+which has been specified with "ShaderClass::setInstanceCallback".
+\since Version 3.3
+*/
+typedef boost::function<void (ShaderClass* ShdClass, const dim::matrix4f* WorldMatrices, u32 NumInstances)> ShaderInstanceCallback;
+
 
 #define SHADER_OBJECT_CALLBACK(n) void n(video::ShaderClass* ShdClass, const scene::MaterialNode* Object)
 #define SHADER_SURFACE_CALLBACK(n) void n(video::ShaderClass* ShdClass, const std::vector<TextureLayer*> &TexLayers)
+#define SHADER_INSTANCE_CALLBACK(n) void n(video::ShaderClass* ShdClass, const dim::matrix4f* WorldMatrices, u32 NumInstances)
 
 
 } // /namespace video
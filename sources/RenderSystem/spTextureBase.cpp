@@ -7,6 +7,8 @@
 
 #include "RenderSystem/spTextureBase.hpp"
 #include "Base/spImageManagement.hpp"
+#include "Base/spImageBlockCompression.hpp"
+#include "Base/spProfiler.hpp"
 #include "Platform/spSoftPixelDeviceOS.hpp"
 
 #include <boost/foreach.hpp>
@@ -22,37 +24,46 @@ namespace video
 
 
 Texture::Texture() :
-    BaseObject          (                   ),
-    OrigID_             (0                  ),
-    ID_                 (0                  ),
-    Type_               (TEXTURE_2D         ),
-    HWFormat_           (HWTEXFORMAT_UBYTE8 ),
-    MultiSamples_       (0                  ),
-    CubeMapFace_        (CUBEMAP_POSITIVE_X ),
-    ArrayLayer_         (0                  ),
-    isRenderTarget_     (false              ),
-    DepthBufferSource_  (0                  ),
-    ImageBuffer_        (0                  ),
-    ImageBufferBackup_  (0                  )
+    BaseObject          (                      ),
+    OrigID_             (0                     ),
+    ID_                 (0                     ),
+    Type_               (TEXTURE_2D            ),
+    HWFormat_           (HWTEXFORMAT_UBYTE8    ),
+    Compression_        (BLOCKCOMPRESSION_NONE ),
+    HWCompression_      (BLOCKCOMPRESSION_NONE ),
+    MultiSamples_       (0                     ),
+    CubeMapFace_        (CUBEMAP_POSITIVE_X    ),
+    ArrayLayer_         (0                     ),
+    isRenderTarget_     (false                 ),
+    DepthBufferSource_  (0                     ),
+    ImageBuffer_        (0                     ),
+    ImageBufferBackup_  (0                     ),
+    CompressedImage_    (0                     ),
+    LastUsedFrame_      (0                     )
 {
     createImageBuffer();
 }
 Texture::Texture(const STextureCreationFlags &CreationFlags) :
-    BaseObject          (CreationFlags.Filename ),
-    OrigID_             (0                      ),
-    ID_                 (0                      ),
-    Type_               (CreationFlags.Type     ),
-    HWFormat_           (CreationFlags.HWFormat ),
-    Filter_             (CreationFlags.Filter   ),
-    MultiSamples_       (0                      ),
-    CubeMapFace_        (CUBEMAP_POSITIVE_X     ),
-    ArrayLayer_         (0                      ),
-    isRenderTarget_     (false                  ),
-    DepthBufferSource_  (0                      ),
-    ImageBuffer_        (0                      ),
-    ImageBufferBackup_  (0                      )
+    BaseObject          (CreationFlags.Filename    ),
+    OrigID_             (0                         ),
+    ID_                 (0                         ),
+    Type_               (CreationFlags.Type        ),
+    HWFormat_           (CreationFlags.HWFormat    ),
+    Compression_        (CreationFlags.Compression ),
+    HWCompression_      (BLOCKCOMPRESSION_NONE     ),
+    Filter_             (CreationFlags.Filter      ),
+    MultiSamples_       (0                         ),
+    CubeMapFace_        (CUBEMAP_POSITIVE_X        ),
+    ArrayLayer_         (0                         ),
+    isRenderTarget_     (false                     ),
+    DepthBufferSource_  (0                         ),
+    ImageBuffer_        (0                         ),
+    ImageBufferBackup_  (0                         ),
+    CompressedImage_    (0                         ),
+    LastUsedFrame_      (0                         )
 {
     createImageBuffer(CreationFlags);
+    SP_PROFILE_COUNTER(io::PROFILERCOUNTER_ALLOCATIONS, 1);
 }
 Texture::~Texture()
 {
@@ -127,6 +138,15 @@ void Texture::setHardwareFormat(const EHWTextureFormats HardwareFormat)
     updateImageBuffer();
 }
 
+void Texture::setCompression(const EBlockCompressionFormats Compression)
+{
+    if (Compression_ != Compression)
+    {
+        Compression_ = Compression;
+        updateImageBuffer();
+    }
+}
+
 void Texture::setMipMapping(bool MipMaps)
 {
     if (Filter_.HasMIPMaps != MipMaps && Type_ != TEXTURE_RECTANGLE && Type_ != TEXTURE_BUFFER)
@@ -281,6 +301,47 @@ void Texture::ensurePOT()
         ImageBuffer_->setSize(ImageBuffer_->getSizePOT());
 }
 
+u32 Texture::getMemorySize() const
+{
+    /* Block compressed textures (only 2D textures are compressed) */
+    if (HWCompression_ != BLOCKCOMPRESSION_NONE)
+    {
+        dim::size2di LevelSize(ImageBuffer_->getSize());
+        u32 Size = BlockCompression::getCompressedSize(HWCompression_, LevelSize);
+        
+        while (getMipMapping() && (LevelSize.Width > 1 || LevelSize.Height > 1))
+        {
+            LevelSize.Width     = math::Max(1, LevelSize.Width  / 2);
+            LevelSize.Height    = math::Max(1, LevelSize.Height / 2);
+            Size += BlockCompression::getCompressedSize(HWCompression_, LevelSize);
+        }
+        
+        return Size;
+    }
+    
+    u32 Size = ImageBuffer_->getBufferSize();
+    
+    /* Add the MIP-map chain (each level has a quarter of the previous level) */
+    if (getMipMapping() && !isRenderTarget_)
+    {
+        dim::size2di LevelSize(ImageBuffer_->getSize());
+        const u32 LayerSize = ImageBuffer_->getDepth() * ImageBuffer_->getPixelSize();
+        
+        while (LevelSize.Width > 1 || LevelSize.Height > 1)
+        {
+            LevelSize.Width     = math::Max(1, LevelSize.Width  / 2);
+            LevelSize.Height    = math::Max(1, LevelSize.Height / 2);
+            Size += LevelSize.getArea() * LayerSize;
+        }
+    }
+    
+    /* Multi-sampled render targets store each sample */
+    if (MultiSamples_ > 1)
+        Size *= MultiSamples_;
+    
+    return Size;
+}
+
 void Texture::setReference(Texture* ReferenceTexture)
 {
     if (ReferenceTexture)
@@ -379,6 +440,29 @@ bool Texture::setupImageBuffer(const ImageBuffer* NewImageBuffer)
     return false;
 }
 
+bool Texture::adoptImageBuffer(ImageBuffer* NewImageBuffer)
+{
+    if (NewImageBuffer && NewImageBuffer != ImageBuffer_)
+    {
+        MemoryManager::deleteMemory(ImageBuffer_);
+        ImageBuffer_ = NewImageBuffer;
+        return updateImageBuffer();
+    }
+    return false;
+}
+
+bool Texture::adoptImageBuffer(ImageBuffer* NewImageBuffer, SCompressedImage* CompressedImage)
+{
+    /* The precompressed image is only used for this update */
+    CompressedImage_ = CompressedImage;
+    
+    const bool Result = adoptImageBuffer(NewImageBuffer);
+    
+    MemoryManager::deleteMemory(CompressedImage_);
+    
+    return Result;
+}
+
 bool Texture::setupImageBuffer(const ImageBuffer* SubImageBuffer, const dim::point2di &Position, const dim::size2di &Size)
 {
     if (SubImageBuffer && SubImageBuffer->getType() == ImageBuffer_->getType())
@@ -411,7 +495,7 @@ void Texture::generateMipMap()
 
 void Texture::bind(s32 Level) const
 {
-    // do nothing
+    markUsed();
 }
 void Texture::unbind(s32 Level) const
 {
@@ -427,6 +511,12 @@ void Texture::updateMultiRenderTargets()
 {
 }
 
+void Texture::markUsed() const
+{
+    if (GlbRenderSys->TextureResidencyManager_)
+        LastUsedFrame_ = GlbRenderSys->TextureResidencyManager_->getFrame();
+}
+
 
 /*
  * ======= Private: =======
@@ -28,6 +28,8 @@ namespace video
 {
 
 
+struct SCompressedImage;
+
 /**
 This is the Texture base class. You only need to use this class (or rather interface). The main content
 of this class is an instance of the ImageBuffer class which holds the image data in the RAM which can then be
@@ -102,6 +104,17 @@ class SP_EXPORT Texture : public BaseObject
         
         //! Sets the new hardware format type.
         virtual void setHardwareFormat(const EHWTextureFormats HardwareFormat);
+        
+        /**
+        Sets the block compression format for the hardware texture. The image buffer stays uncompressed.
+        Compression is only applied to 2D textures with UBYTE image buffers which are no render targets,
+        and only if the renderer supports the format (currently OpenGL only). Otherwise the texture is uploaded uncompressed.
+        \param Compression: Specifies the block compression format. By default BLOCKCOMPRESSION_NONE.
+        \see EBlockCompressionFormats
+        \see getHardwareCompression
+        \since Version 3.3
+        */
+        virtual void setCompression(const EBlockCompressionFormats Compression);
         /**
         Enables or disables MIP-mapping. By default MIP-mapping is enabled and in 3D graphics normally
         it should be always enabled. If MIP-mapping is disabled the texture can look very ugly when the number
@@ -129,12 +142,34 @@ class SP_EXPORT Texture : public BaseObject
         //! Replaces the old image buffer by copying the new one.
         virtual bool setupImageBuffer(const ImageBuffer* NewImageBuffer);
         
+        /**
+        Replaces the old image buffer by the new one without copying it.
+        \param NewImageBuffer: Specifies the new image buffer. The texture takes the ownership of this object.
+        \since Version 3.3
+        */
+        virtual bool adoptImageBuffer(ImageBuffer* NewImageBuffer);
+        
+        /**
+        Replaces the old image buffer by the new one and uploads the blocks which have already been compressed
+        (e.g. on a loader thread) instead of compressing the image on the render thread. The blocks are only used
+        if they match the texture's hardware compression and MIP-mapping, otherwise the image is compressed as usual.
+        \param NewImageBuffer: Specifies the new image buffer. The texture takes the ownership of this object.
+        \param CompressedImage: Specifies the compressed image. The texture takes the ownership of this object, too. May be null.
+        \see BlockCompression::compressMipMaps
+        \since Version 3.3
+        */
+        bool adoptImageBuffer(ImageBuffer* NewImageBuffer, SCompressedImage* CompressedImage);
+        
         //! Copies the specified area from the image buffer.
         virtual bool setupImageBuffer(const ImageBuffer* SubImageBuffer, const dim::point2di &Position, const dim::size2di &Size);
         
         //! Generates the mipmaps if enabled.
         virtual void generateMipMap();
         
+        /**
+        Binds the texture to the specified layer. This also marks the texture as used
+        for the texture residency manager (see getLastUsedFrame).
+        */
         virtual void bind(s32 Level = 0) const;
         virtual void unbind(s32 Level = 0) const;
         
@@ -228,6 +263,13 @@ class SP_EXPORT Texture : public BaseObject
         */
         void ensurePOT();
         
+        /**
+        Returns the estimated video memory size (in bytes) of this texture including the whole MIP-map chain.
+        \see TextureResidencyManager
+        \since Version 3.3
+        */
+        u32 getMemorySize() const;
+        
         /* === Inline functions === */
         
         /**
@@ -314,6 +356,21 @@ class SP_EXPORT Texture : public BaseObject
             return HWFormat_;
         }
         
+        //! Returns the requested block compression format. \see setCompression \since Version 3.3
+        inline EBlockCompressionFormats getCompression() const
+        {
+            return Compression_;
+        }
+        /**
+        Returns the block compression format which is actually used for the hardware texture.
+        This is BLOCKCOMPRESSION_NONE if the texture is uploaded uncompressed. BLOCKCOMPRESSION_AUTO is never returned.
+        \since Version 3.3
+        */
+        inline EBlockCompressionFormats getHardwareCompression() const
+        {
+            return HWCompression_;
+        }
+        
         //! Returns true if MIP-mapping is enabled.
         virtual bool getMipMapping() const
         {
@@ -416,12 +473,26 @@ class SP_EXPORT Texture : public BaseObject
             return Type_ >= TEXTURE_1D_RW && Type_ <= TEXTURE_2D_ARRAY_RW;
         }
         
+        /**
+        Returns the frame number in which this texture was bound the last time (see bind).
+        This is only tracked while the texture residency manager exists. By default 0 (never bound).
+        \see TextureResidencyManager
+        \since Version 3.3
+        */
+        inline u32 getLastUsedFrame() const
+        {
+            return LastUsedFrame_;
+        }
+        
     protected:
         
         /* === Functions === */
         
         virtual void updateMultiRenderTargets();
         
+        //! Stores the current frame of the texture residency manager. This must be called by each "bind" implementation.
+        void markUsed() const;
+        
         /* === Members === */
         
         /* Renderer objects */
@@ -431,6 +502,8 @@ class SP_EXPORT Texture : public BaseObject
         /* Creation flags */
         ETextureTypes Type_;                //!< Texture class type. \see ETextureTypes
         EHWTextureFormats HWFormat_;        //!< Hardware texture format. \see EHWTextureFormats
+        EBlockCompressionFormats Compression_;      //!< Requested block compression. \see EBlockCompressionFormats
+        EBlockCompressionFormats HWCompression_;    //!< Block compression of the hardware texture (set by the renderer).
         STextureFilter Filter_;             //!< Texture filtering settings. \see STextureFilter
         
         /* Options */
@@ -459,8 +532,13 @@ class SP_EXPORT Texture : public BaseObject
         */
         ImageBuffer* ImageBufferBackup_;
         
+        //! Precompressed image which is uploaded by the next image buffer update instead of compressing the image. By default null.
+        SCompressedImage* CompressedImage_;
+        
     private:
         
+        friend class TextureResidencyManager;
+        
         /* === Functions === */
         
         void createImageBuffer();
@@ -468,6 +546,10 @@ class SP_EXPORT Texture : public BaseObject
         
         void clearMRTList();
         
+        /* === Members === */
+        
+        mutable u32 LastUsedFrame_;
+        
 };
 
 
@@ -84,6 +84,31 @@ enum EHWTextureFormats
     HWTEXFORMAT_UINT32,     //!< 32-bit unsigned interger components. \see EPixelFormats \since Version 3.3
 };
 
+/**
+Hardware texture block compression formats. Only the hardware texture is compressed, the image buffer stays uncompressed.
+\see BlockCompression
+\since Version 3.3
+*/
+enum EBlockCompressionFormats
+{
+    BLOCKCOMPRESSION_NONE = 0,  //!< No block compression (default).
+    BLOCKCOMPRESSION_AUTO,      //!< BC1 for images without alpha channel, otherwise BC3.
+    BLOCKCOMPRESSION_BC1,       //!< BC1 (DXT1). RGB color with 4 bits per pixel. The alpha channel is ignored.
+    BLOCKCOMPRESSION_BC3,       //!< BC3 (DXT5). RGBA color with 8 bits per pixel. The alpha channel is stored with 8 interpolated values per block.
+    BLOCKCOMPRESSION_BC5,       //!< BC5 (ATI2, RGTC2). Red and green channel with 8 bits per pixel (e.g. for tangent-space normal maps).
+};
+
+/**
+Block compression encoder quality presets.
+\since Version 3.3
+*/
+enum EBlockCompressionQualities
+{
+    BLOCKQUALITY_FAST,      //!< End points from the bounding box of each block.
+    BLOCKQUALITY_NORMAL,    //!< End points from the principal axis of each block (default).
+    BLOCKQUALITY_HIGH,      //!< Like BLOCKQUALITY_NORMAL with an additional least-squares refinement of the end points.
+};
+
 //! Cubemap directions
 enum ECubeMapDirections
 {
@@ -168,12 +193,13 @@ struct STextureFilter
 struct STextureCreationFlags
 {
     STextureCreationFlags() :
-        Depth       (1                  ),
-        ImageBuffer (0                  ),
-        Type        (TEXTURE_2D         ),
-        BufferType  (IMAGEBUFFER_UBYTE  ),
-        Format      (PIXELFORMAT_RGB    ),
-        HWFormat    (HWTEXFORMAT_UBYTE8 )
+        Depth       (1                      ),
+        ImageBuffer (0                      ),
+        Type        (TEXTURE_2D             ),
+        BufferType  (IMAGEBUFFER_UBYTE      ),
+        Format      (PIXELFORMAT_RGB        ),
+        HWFormat    (HWTEXFORMAT_UBYTE8     ),
+        Compression (BLOCKCOMPRESSION_NONE  )
     {
     }
     STextureCreationFlags(const STextureCreationFlags &Other) :
@@ -185,6 +211,7 @@ struct STextureCreationFlags
         BufferType  (Other.BufferType   ),
         Format      (Other.Format       ),
         HWFormat    (Other.HWFormat     ),
+        Compression (Other.Compression  ),
         Filter      (Other.Filter       )
     {
     }
@@ -211,6 +238,9 @@ struct STextureCreationFlags
     EPixelFormats       Format;
     EHWTextureFormats   HWFormat;
     
+    //! Hardware texture block compression. By default BLOCKCOMPRESSION_NONE. \since Version 3.3
+    EBlockCompressionFormats Compression;
+    
     STextureFilter      Filter;
 };
 
@@ -0,0 +1,233 @@
+/*
+ * Texture residency manager file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "RenderSystem/spTextureResidencyManager.hpp"
+#include "RenderSystem/spRenderSystem.hpp"
+#include "RenderSystem/spTextureLayer.hpp"
+
+#include <boost/foreach.hpp>
+#include <algorithm>
+
+
+namespace sp
+{
+
+extern video::RenderSystem* GlbRenderSys;
+
+namespace video
+{
+
+
+TextureResidencyManager::TextureResidencyManager() :
+    Frame_              (1      ),
+    Budget_             (0      ),
+    MinTextureSize_     (64     ),
+    MaxDroppedLevels_   (2      ),
+    MinUnusedFrames_    (2      ),
+    UsedMemory_         (0      ),
+    NumReducedTextures_ (0      ),
+    NumEvictedTextures_ (0      ),
+    NumMipDrops_        (0      ),
+    NumEvictions_       (0      ),
+    NumReloads_         (0      )
+{
+}
+TextureResidencyManager::~TextureResidencyManager()
+{
+}
+
+void TextureResidencyManager::update()
+{
+    ++Frame_;
+    
+    reloadUsedTextures();
+    enforceBudget();
+    
+    /* Update residency counters */
+    NumReducedTextures_ = 0;
+    NumEvictedTextures_ = 0;
+    
+    for (std::map<const Texture*, SResidency>::iterator it = Residencies_.begin(); it != Residencies_.end(); ++it)
+    {
+        if (it->second.isEvicted)
+            ++NumEvictedTextures_;
+        else if (it->second.DroppedLevels > 0)
+            ++NumReducedTextures_;
+    }
+}
+
+void TextureResidencyManager::markUsed(const TextureLayerListType &TexLayers)
+{
+    foreach (TextureLayer* TexLayer, TexLayers)
+    {
+        if (TexLayer->getTexture())
+            TexLayer->getTexture()->LastUsedFrame_ = Frame_;
+    }
+}
+
+void TextureResidencyManager::removeTexture(const Texture* Tex)
+{
+    Residencies_.erase(Tex);
+}
+
+u32 TextureResidencyManager::getDroppedLevels(const Texture* Tex) const
+{
+    std::map<const Texture*, SResidency>::const_iterator it = Residencies_.find(Tex);
+    return it != Residencies_.end() ? it->second.DroppedLevels : 0;
+}
+
+bool TextureResidencyManager::isEvicted(const Texture* Tex) const
+{
+    std::map<const Texture*, SResidency>::const_iterator it = Residencies_.find(Tex);
+    return it != Residencies_.end() && it->second.isEvicted;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void TextureResidencyManager::reloadUsedTextures()
+{
+    for (std::map<const Texture*, SResidency>::iterator it = Residencies_.begin(); it != Residencies_.end();)
+    {
+        Texture* Tex = const_cast<Texture*>(it->first);
+        SResidency &Residency = it->second;
+        
+        if (Residency.isReloading)
+        {
+            /* Texture is fully resident again when the reload has been uploaded */
+            if (!GlbRenderSys->getAsyncTextureLoader()->isLoading(Tex))
+            {
+                Residencies_.erase(it++);
+                continue;
+            }
+        }
+        else if (!isUnused(Tex))
+        {
+            /* Evicted textures are always reloaded, reduced textures only if the budget allows it */
+            const u64 MemorySize = Tex->getMemorySize();
+            const u64 FullMemorySize = (Residency.isEvicted ? 0 : MemorySize << (2*Residency.DroppedLevels));
+            
+            if (Residency.isEvicted || !Budget_ || UsedMemory_ + FullMemorySize - MemorySize <= Budget_)
+            {
+                GlbRenderSys->getAsyncTextureLoader()->request(Tex, Tex->getFilename());
+                
+                Residency.isReloading = true;
+                UsedMemory_ += FullMemorySize - MemorySize;
+                ++NumReloads_;
+            }
+        }
+        
+        ++it;
+    }
+}
+
+void TextureResidencyManager::enforceBudget()
+{
+    /* Measure the texture memory and collect all textures which can be reduced or evicted */
+    std::vector<Texture*> Candidates;
+    
+    UsedMemory_ = 0;
+    
+    GlbRenderSys->TextureListSemaphore_.lock();
+    
+    foreach (Texture* Tex, GlbRenderSys->TextureList_)
+    {
+        UsedMemory_ += Tex->getMemorySize();
+        
+        if (Budget_ && isManageable(Tex) && isUnused(Tex) && !isEvicted(Tex))
+            Candidates.push_back(Tex);
+    }
+    
+    GlbRenderSys->TextureListSemaphore_.unlock();
+    
+    if (!Budget_ || UsedMemory_ <= Budget_)
+        return;
+    
+    /* Evict the least recently used textures first */
+    std::sort(Candidates.begin(), Candidates.end(), TextureResidencyManager::compareLastUse);
+    
+    foreach (Texture* Tex, Candidates)
+    {
+        if (UsedMemory_ <= Budget_)
+            break;
+        
+        SResidency &Residency = Residencies_[Tex];
+        
+        /* Only drop the top MIP level when this frees enough memory (about 3/4 of the texture) */
+        const dim::size2di Size(Tex->getSize());
+        const u64 Excess = UsedMemory_ - Budget_;
+        
+        if ( Residency.DroppedLevels < MaxDroppedLevels_ && math::Min(Size.Width, Size.Height) / 2 >= MinTextureSize_ &&
+             static_cast<u64>(Tex->getMemorySize()) * 3 / 4 >= Excess )
+        {
+            UsedMemory_ -= reduceTexture(Tex, Residency);
+        }
+        else
+            UsedMemory_ -= evictTexture(Tex, Residency);
+    }
+}
+
+bool TextureResidencyManager::isManageable(const Texture* Tex) const
+{
+    /* Only 2D textures which can be reloaded from their file are managed */
+    return
+        Tex->getLastUsedFrame() > 0 &&
+        Tex->getType() == TEXTURE_2D &&
+        !Tex->getRenderTarget() &&
+        Tex->getImageBuffer()->getType() == IMAGEBUFFER_UBYTE &&
+        Tex->getFilename().size() > 0 &&
+        !( GlbRenderSys->AsyncTextureLoader_ && GlbRenderSys->AsyncTextureLoader_->isLoading(Tex) );
+}
+
+bool TextureResidencyManager::isUnused(const Texture* Tex) const
+{
+    return Frame_ - Tex->getLastUsedFrame() >= MinUnusedFrames_;
+}
+
+u32 TextureResidencyManager::reduceTexture(Texture* Tex, SResidency &Residency)
+{
+    const u32 PrevMemorySize = Tex->getMemorySize();
+    
+    /* Drop the top MIP level */
+    const dim::size2di Size(Tex->getSize());
+    Tex->setSize(dim::size2di(math::Max(1, Size.Width / 2), math::Max(1, Size.Height / 2)));
+    
+    ++Residency.DroppedLevels;
+    ++NumMipDrops_;
+    
+    return PrevMemorySize - Tex->getMemorySize();
+}
+
+u32 TextureResidencyManager::evictTexture(Texture* Tex, SResidency &Residency)
+{
+    const u32 PrevMemorySize = Tex->getMemorySize();
+    
+    /* Replace the image by a 1x1 placeholder */
+    Tex->adoptImageBuffer(new ImageBufferUByte(PIXELFORMAT_RGBA, dim::size2di(1), 1, GlbRenderSys->StdFillColor_));
+    
+    Residency.DroppedLevels = 0;
+    Residency.isEvicted     = true;
+    ++NumEvictions_;
+    
+    return PrevMemorySize - Tex->getMemorySize();
+}
+
+bool TextureResidencyManager::compareLastUse(const Texture* A, const Texture* B)
+{
+    return A->getLastUsedFrame() < B->getLastUsedFrame();
+}
+
+
+} // /namespace video
+
+} // /namespace sp
+
+
+
+// ================================================================================
@@ -0,0 +1,218 @@
+/*
+ * Texture residency manager header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_TEXTURE_RESIDENCY_MANAGER_H__
+#define __SP_TEXTURE_RESIDENCY_MANAGER_H__
+
+
+#include "Base/spStandard.hpp"
+#include "Base/spMath.hpp"
+#include "Base/spMaterialConfigTypes.hpp"
+
+#include <vector>
+#include <map>
+
+
+namespace sp
+{
+namespace video
+{
+
+
+class Texture;
+
+/**
+The texture residency manager keeps the texture memory under a configurable budget.
+It tracks the memory of each texture (including the MIP-map chain) and the frame in which it was bound
+the last time (see Texture::bind). When the budget is exceeded, the least recently used textures are evicted first
+(the image is replaced by a 1x1 placeholder). When dropping the top MIP level of the next texture frees enough memory,
+this texture is only reduced (i.e. the image is scaled down to the half size) instead of evicted.
+When a reduced or evicted texture is used again, it is reloaded from its file with the AsyncTextureLoader.
+\note Only 2D textures which have been loaded from a file and have been bound at least once are managed.
+Render targets and procedural textures are never touched.
+Changes which have been made to the image buffer after loading are lost when the texture is reloaded.
+\see RenderSystem::getTextureResidencyManager
+\since Version 3.3
+*/
+class SP_EXPORT TextureResidencyManager
+{
+    
+    public:
+        
+        TextureResidencyManager();
+        ~TextureResidencyManager();
+        
+        /* === Functions === */
+        
+        /**
+        Reloads the used textures and enforces the memory budget. This must be called on the render thread.
+        It is called automatically once per frame by "SoftPixelDevice::updateEvents".
+        */
+        void update();
+        
+        //! Stores the current frame number in all textures of the specified layer list. This is called by "RenderSystem::bindTextureLayers".
+        void markUsed(const TextureLayerListType &TexLayers);
+        
+        //! Removes the residency information of the specified texture. This is called by "RenderSystem::deleteTexture".
+        void removeTexture(const Texture* Tex);
+        
+        //! Returns the count of MIP levels which have been dropped for the specified texture.
+        u32 getDroppedLevels(const Texture* Tex) const;
+        //! Returns true if the specified texture has been evicted.
+        bool isEvicted(const Texture* Tex) const;
+        
+        /* === Inline functions === */
+        
+        /**
+        Sets the texture memory budget (in bytes). By default 0 which means unlimited.
+        \see Texture::getMemorySize
+        */
+        inline void setBudget(u64 Budget)
+        {
+            Budget_ = Budget;
+        }
+        inline u64 getBudget() const
+        {
+            return Budget_;
+        }
+        
+        /**
+        Sets the minimal texture size (width or height). Textures at this size are no longer reduced
+        but evicted. By default 64.
+        */
+        inline void setMinTextureSize(s32 Size)
+        {
+            MinTextureSize_ = math::Max(1, Size);
+        }
+        inline s32 getMinTextureSize() const
+        {
+            return MinTextureSize_;
+        }
+        
+        //! Sets the maximal count of MIP levels which can be dropped from a texture. By default 2.
+        inline void setMaxDroppedLevels(u32 Count)
+        {
+            MaxDroppedLevels_ = Count;
+        }
+        inline u32 getMaxDroppedLevels() const
+        {
+            return MaxDroppedLevels_;
+        }
+        
+        //! Sets the count of frames a texture must be unused before it can be reduced or evicted. By default 2.
+        inline void setMinUnusedFrames(u32 Count)
+        {
+            MinUnusedFrames_ = math::Max(1u, Count);
+        }
+        inline u32 getMinUnusedFrames() const
+        {
+            return MinUnusedFrames_;
+        }
+        
+        //! Returns the current frame number.
+        inline u32 getFrame() const
+        {
+            return Frame_;
+        }
+        
+        //! Returns the memory (in bytes) of all textures measured in the last update.
+        inline u64 getUsedMemory() const
+        {
+            return UsedMemory_;
+        }
+        //! Returns the count of textures which are currently reduced.
+        inline u32 getNumReducedTextures() const
+        {
+            return NumReducedTextures_;
+        }
+        //! Returns the count of textures which are currently evicted.
+        inline u32 getNumEvictedTextures() const
+        {
+            return NumEvictedTextures_;
+        }
+        //! Returns the count of dropped MIP levels since the manager was created.
+        inline u32 getNumMipDrops() const
+        {
+            return NumMipDrops_;
+        }
+        //! Returns the count of texture evictions since the manager was created.
+        inline u32 getNumEvictions() const
+        {
+            return NumEvictions_;
+        }
+        //! Returns the count of texture reloads since the manager was created.
+        inline u32 getNumReloads() const
+        {
+            return NumReloads_;
+        }
+        
+    private:
+        
+        /* === Structures === */
+        
+        struct SResidency
+        {
+            SResidency() :
+                DroppedLevels   (0      ),
+                isEvicted       (false  ),
+                isReloading     (false  )
+            {
+            }
+            ~SResidency()
+            {
+            }
+            
+            /* Members */
+            u32 DroppedLevels;
+            bool isEvicted;
+            bool isReloading;
+        };
+        
+        /* === Functions === */
+        
+        void reloadUsedTextures();
+        void enforceBudget();
+        
+        bool isManageable(const Texture* Tex) const;
+        bool isUnused(const Texture* Tex) const;
+        
+        u32 reduceTexture(Texture* Tex, SResidency &Residency);
+        u32 evictTexture(Texture* Tex, SResidency &Residency);
+        
+        static bool compareLastUse(const Texture* A, const Texture* B);
+        
+        /* === Members === */
+        
+        std::map<const Texture*, SResidency> Residencies_;
+        
+        u32 Frame_;
+        
+        u64 Budget_;
+        s32 MinTextureSize_;
+        u32 MaxDroppedLevels_;
+        u32 MinUnusedFrames_;
+        
+        u64 UsedMemory_;
+        u32 NumReducedTextures_;
+        u32 NumEvictedTextures_;
+        u32 NumMipDrops_;
+        u32 NumEvictions_;
+        u32 NumReloads_;
+        
+};
+
+
+} // /namespace video
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
@@ -7,6 +7,7 @@
 
 #include "SceneGraph/Collision/spCollisionGraph.hpp"
 #include "Base/spMemoryManagement.hpp"
+#include "Base/spProfiler.hpp"
 
 #include <boost/foreach.hpp>
 
@@ -239,6 +240,8 @@ void CollisionGraph::findIntersections(
 
 void CollisionGraph::updateScene()
 {
+    SP_PROFILE_SCOPE("CollisionGraph::updateScene");
+    
     if (RootTreeNode_)
     {
         // !todo!
@@ -0,0 +1,663 @@
+/*
+ * Asynchronous mesh loader file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "SceneGraph/spAsyncMeshLoader.hpp"
+#include "SceneGraph/spSceneManager.hpp"
+#include "SceneGraph/spSceneGraph.hpp"
+#include "SceneGraph/spSceneMesh.hpp"
+#include "SceneGraph/Collision/spCollisionGraph.hpp"
+#include "SceneGraph/Collision/spCollisionMesh.hpp"
+#include "RenderSystem/spRenderSystem.hpp"
+#include "Base/spSharedObjects.hpp"
+#include "Base/spInputOutputFileSystem.hpp"
+#include "Base/spInputOutputLog.hpp"
+#include "Base/spMemoryManagement.hpp"
+#include "Base/spTimer.hpp"
+
+#include <boost/foreach.hpp>
+
+
+namespace sp
+{
+
+extern video::RenderSystem* GlbRenderSys;
+
+namespace scene
+{
+
+
+/*
+ * Internal functions
+ */
+
+//! Request which is currently loaded by the calling worker thread.
+static SP_THREAD_LOCAL AsyncMeshRequest* ActiveRequest = 0;
+
+THREAD_PROC(AsyncMeshLoaderThreadProc)
+{
+    AsyncMeshLoader* Loader = static_cast<AsyncMeshLoader*>(Arguments);
+    
+    while (1)
+    {
+        /* Sleep until a mesh has been requested (canceled requests leave the queue empty) */
+        Loader->RequestSignal_.wait();
+        
+        if (!Loader->isRunning_)
+            break;
+        
+        AsyncMeshRequestPtr Request = Loader->popRequest();
+        
+        if (Request)
+            Loader->loadRequest(Request);
+    }
+    
+    Loader->ExitSignal_.post();
+    
+    return 0;
+}
+
+
+/*
+ * SAsyncMeshDesc structure
+ */
+
+SAsyncMeshDesc::SAsyncMeshDesc() :
+    TexturePath     (video::TEXPATH_IGNORE  ),
+    Format          (MESHFORMAT_UNKNOWN     ),
+    Flags           (0                      ),
+    Priority        (0.0f                   ),
+    UpdateNormals   (false                  ),
+    TangentLayer    (video::TEXTURE_IGNORE  ),
+    BinormalLayer   (video::TEXTURE_IGNORE  ),
+    CollGraph       (0                      ),
+    CollMaterial    (0                      ),
+    CollTreeLevel   (DEF_KDTREE_LEVEL       )
+{
+}
+SAsyncMeshDesc::~SAsyncMeshDesc()
+{
+}
+
+
+/*
+ * AsyncMeshRequest class
+ */
+
+AsyncMeshRequest::AsyncMeshRequest(
+    AsyncMeshLoader* Loader, SceneGraph* Graph, const io::stringc &Filename, const SAsyncMeshDesc &Desc) :
+    Loader_             (Loader         ),
+    Graph_              (Graph          ),
+    Filename_           (Filename       ),
+    Desc_               (Desc           ),
+    State_              (ASYNCMESH_QUEUED),
+    isCanceled_         (false          ),
+    Mesh_               (0              ),
+    CollMesh_           (0              ),
+    NumUploadedSurfaces_(0              )
+{
+}
+AsyncMeshRequest::~AsyncMeshRequest()
+{
+}
+
+bool AsyncMeshRequest::cancel()
+{
+    return Loader_ ? Loader_->cancel(this) : false;
+}
+
+void AsyncMeshRequest::setPriority(f32 Priority)
+{
+    if (Loader_)
+    {
+        Loader_->Mutex_.lock();
+        Desc_.Priority = Priority;
+        Loader_->Mutex_.unlock();
+    }
+}
+
+Mesh* AsyncMeshRequest::wait()
+{
+    if (Loader_)
+        Loader_->waitUntilDone(this);
+    return getMesh();
+}
+
+f32 AsyncMeshRequest::getProgress() const
+{
+    f32 Progress = 1.0f;
+    
+    Mutex_.lock();
+    
+    switch (State_)
+    {
+        case ASYNCMESH_QUEUED:
+        case ASYNCMESH_LOADING:
+            Progress = 0.0f;
+            break;
+        case ASYNCMESH_UPLOADING:
+            if (Surfaces_.empty())
+                Progress = 0.5f;
+            else
+                Progress = 0.5f + 0.5f * static_cast<f32>(NumUploadedSurfaces_) / Surfaces_.size();
+            break;
+        default:
+            break;
+    }
+    
+    Mutex_.unlock();
+    
+    return Progress;
+}
+
+EAsyncMeshStates AsyncMeshRequest::getState() const
+{
+    Mutex_.lock();
+    const EAsyncMeshStates State = State_;
+    Mutex_.unlock();
+    return State;
+}
+
+bool AsyncMeshRequest::isReady() const
+{
+    return getState() == ASYNCMESH_FINISHED;
+}
+bool AsyncMeshRequest::isDone() const
+{
+    return getState() >= ASYNCMESH_FINISHED;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void AsyncMeshRequest::setState(const EAsyncMeshStates State)
+{
+    Mutex_.lock();
+    State_ = State;
+    Mutex_.unlock();
+}
+
+void AsyncMeshRequest::deleteMeshes()
+{
+    /* Delete the animations first, because they refer to the meshes */
+    MemoryManager::deleteList(Animations_);
+    MemoryManager::deleteMemory(CollMesh_);
+    MemoryManager::deleteList(Meshes_);
+    
+    Mesh_ = 0;
+    
+    Mutex_.lock();
+    Surfaces_.clear();
+    Mutex_.unlock();
+}
+
+
+/*
+ * STextureRequest structure
+ */
+
+AsyncMeshLoader::STextureRequest::STextureRequest(const io::stringc &InitFilename, f32 InitPriority) :
+    Filename(InitFilename   ),
+    Priority(InitPriority   ),
+    Tex     (0              )
+{
+}
+AsyncMeshLoader::STextureRequest::~STextureRequest()
+{
+}
+
+
+/*
+ * AsyncMeshLoader class
+ */
+
+AsyncMeshLoader::AsyncMeshLoader(u32 ThreadCount) :
+    isRunning_          (true   ),
+    MaxUploadBytes_     (4194304),
+    MaxUploadTime_      (2000   ),
+    NumUploadedBytes_   (0      ),
+    isWaiting_          (false  )
+{
+    /* Start the worker threads */
+    ThreadCount = math::Max(1u, ThreadCount);
+    
+    for (u32 i = 0; i < ThreadCount; ++i)
+        Threads_.push_back(new ThreadManager(AsyncMeshLoaderThreadProc, this));
+}
+AsyncMeshLoader::~AsyncMeshLoader()
+{
+    /* No further texture requests are accepted, the pending ones get a null pointer */
+    Mutex_.lock();
+    isRunning_ = false;
+    Mutex_.unlock();
+    
+    processTextureRequests();
+    
+    /* Wake up all threads and wait until they are finished */
+    RequestSignal_.post(Threads_.size());
+    
+    for (u32 i = 0; i < Threads_.size(); ++i)
+        ExitSignal_.wait();
+    
+    MemoryManager::deleteList(Threads_);
+    
+    /* Discard all pending requests */
+    foreach (AsyncMeshRequestPtr &Request, Requests_)
+    {
+        Request->deleteMeshes();
+        Request->setState(ASYNCMESH_CANCELED);
+        Request->Loader_ = 0;
+    }
+    
+    /* Canceled requests which were still loading are only referenced in the upload queue */
+    foreach (AsyncMeshRequestPtr &Request, UploadQueue_)
+    {
+        if (Request->isCanceled_)
+            Request->deleteMeshes();
+        Request->Loader_ = 0;
+    }
+}
+
+AsyncMeshRequestPtr AsyncMeshLoader::request(SceneGraph* Graph, const io::stringc &Filename, const SAsyncMeshDesc &Desc)
+{
+    AsyncMeshRequestPtr Request(new AsyncMeshRequest(this, Graph, Filename, Desc));
+    
+    Requests_.push_back(Request);
+    
+    Mutex_.lock();
+    RequestQueue_.push_back(Request);
+    Mutex_.unlock();
+    
+    RequestSignal_.post();
+    
+    return Request;
+}
+
+void AsyncMeshLoader::update()
+{
+    upload(MaxUploadBytes_, MaxUploadTime_);
+}
+
+void AsyncMeshLoader::flush()
+{
+    waitUntilDone(0);
+}
+
+bool AsyncMeshLoader::isLoaderThread()
+{
+    return ActiveRequest != 0;
+}
+
+video::Texture* AsyncMeshLoader::loadTexture(const io::stringc &Filename)
+{
+    AsyncMeshRequest* Request = ActiveRequest;
+    
+    if (!Request || !Request->Loader_)
+        return 0;
+    
+    AsyncMeshLoader* Loader = Request->Loader_;
+    
+    /* Let the render thread create the texture object and wait until it has been created */
+    STextureRequest TexRequest(Filename, Request->Desc_.Priority);
+    
+    Loader->Mutex_.lock();
+    
+    if (!Loader->isRunning_)
+    {
+        /* The loader is shutting down, so the render thread does not process the request anymore */
+        Loader->Mutex_.unlock();
+        return 0;
+    }
+    
+    Loader->TextureRequests_.push_back(&TexRequest);
+    
+    if (Loader->isWaiting_)
+        Loader->LoadedSignal_.post();
+    
+    Loader->Mutex_.unlock();
+    
+    TexRequest.Done.wait();
+    
+    return TexRequest.Tex;
+}
+
+bool AsyncMeshLoader::deferMesh(Mesh* Obj)
+{
+    if (!ActiveRequest)
+        return false;
+    ActiveRequest->Meshes_.push_back(Obj);
+    return true;
+}
+
+bool AsyncMeshLoader::deferAnimation(Animation* Anim)
+{
+    if (!ActiveRequest)
+        return false;
+    ActiveRequest->Animations_.push_back(Anim);
+    return true;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void AsyncMeshLoader::upload(u32 MaxBytes, u64 MaxTime)
+{
+    NumUploadedBytes_ = 0;
+    
+    const u64 StartTime = io::Timer::microsecs();
+    
+    /* Create the textures which the worker threads are waiting for */
+    processTextureRequests();
+    
+    while (1)
+    {
+        AsyncMeshRequestPtr Request = getLoadedRequest();
+        
+        if (!Request)
+            break;
+        
+        if (Request->isCanceled_)
+        {
+            /* The request has been canceled while a worker thread was loading it */
+            removeFromQueue(UploadQueue_, Request.get());
+            Request->deleteMeshes();
+            Request->setState(ASYNCMESH_CANCELED);
+            Request->Loader_ = 0;
+            continue;
+        }
+        
+        /* Create and upload the next hardware mesh buffer */
+        if (Request->NumUploadedSurfaces_ < Request->Surfaces_.size())
+        {
+            video::MeshBuffer* Surface = Request->Surfaces_[Request->NumUploadedSurfaces_];
+            
+            Surface->createMeshBuffer();
+            Surface->updateMeshBuffer();
+            
+            NumUploadedBytes_ += Surface->getVertexBuffer().getSize() + Surface->getIndexBuffer().getSize();
+            
+            Request->Mutex_.lock();
+            ++Request->NumUploadedSurfaces_;
+            Request->Mutex_.unlock();
+        }
+        
+        if (Request->NumUploadedSurfaces_ >= Request->Surfaces_.size())
+            finishRequest(Request);
+        
+        /* Check if the upload budget is exhausted */
+        if (NumUploadedBytes_ >= MaxBytes || io::Timer::microsecs() - StartTime >= MaxTime)
+            break;
+    }
+}
+
+void AsyncMeshLoader::waitUntilDone(const AsyncMeshRequest* Request)
+{
+    Mutex_.lock();
+    isWaiting_ = true;
+    Mutex_.unlock();
+    
+    /* Wait for the specified request or for all requests if it is null */
+    while (Request ? !Request->isDone() : !Requests_.empty())
+    {
+        upload(~0u, ~0u);
+        
+        /* Sleep until the next mesh has been loaded or a worker thread needs a texture */
+        if (Request ? !Request->isDone() : !Requests_.empty())
+            LoadedSignal_.wait();
+    }
+    
+    Mutex_.lock();
+    isWaiting_ = false;
+    Mutex_.unlock();
+}
+
+void AsyncMeshLoader::processTextureRequests()
+{
+    Mutex_.lock();
+    std::vector<STextureRequest*> TexRequests;
+    TexRequests.swap(TextureRequests_);
+    Mutex_.unlock();
+    
+    foreach (STextureRequest* TexRequest, TexRequests)
+    {
+        video::Texture* Tex = 0;
+        
+        if (isRunning_)
+            Tex = GlbRenderSys->loadTextureAsync(TexRequest->Filename, TexRequest->Priority);
+        
+        /* The worker thread continues afterwards, so the request must not be used anymore */
+        TexRequest->Tex = Tex;
+        TexRequest->Done.post();
+    }
+}
+
+AsyncMeshRequestPtr AsyncMeshLoader::popRequest()
+{
+    AsyncMeshRequestPtr Request;
+    
+    Mutex_.lock();
+    
+    if (!RequestQueue_.empty())
+    {
+        /* Select the request with the highest priority */
+        std::vector<AsyncMeshRequestPtr>::iterator itBest = RequestQueue_.begin();
+        
+        for (std::vector<AsyncMeshRequestPtr>::iterator it = itBest + 1; it != RequestQueue_.end(); ++it)
+        {
+            if ((*it)->Desc_.Priority < (*itBest)->Desc_.Priority)
+                itBest = it;
+        }
+        
+        Request = *itBest;
+        Request->setState(ASYNCMESH_LOADING);
+        
+        RequestQueue_.erase(itBest);
+    }
+    
+    Mutex_.unlock();
+    
+    return Request;
+}
+
+AsyncMeshRequestPtr AsyncMeshLoader::getLoadedRequest()
+{
+    AsyncMeshRequestPtr Request;
+    
+    Mutex_.lock();
+    
+    if (!UploadQueue_.empty())
+    {
+        /* Select the request with the highest priority (it stays in the queue until all its mesh buffers are uploaded) */
+        std::vector<AsyncMeshRequestPtr>::iterator itBest = UploadQueue_.begin();
+        
+        for (std::vector<AsyncMeshRequestPtr>::iterator it = itBest + 1; it != UploadQueue_.end(); ++it)
+        {
+            if ((*it)->isCanceled_ || (*it)->Desc_.Priority < (*itBest)->Desc_.Priority)
+                itBest = it;
+        }
+        
+        Request = *itBest;
+    }
+    
+    Mutex_.unlock();
+    
+    return Request;
+}
+
+void AsyncMeshLoader::loadRequest(const AsyncMeshRequestPtr &Request)
+{
+    Mesh* NewMesh = 0;
+    CollisionMesh* CollMesh = 0;
+    
+    std::vector<video::MeshBuffer*> Surfaces;
+    
+    /* Hardware mesh buffers, scene manager registrations and log messages are deferred to the render thread */
+    ActiveRequest = Request.get();
+    video::MeshBuffer::setDeferredUpload(true);
+    io::Log::startRecording(Request->Messages_);
+    
+    const SAsyncMeshDesc& Desc = Request->Desc_;
+    
+    if (io::FileSystem().findFile(Request->Filename_))
+    {
+        /* Read the file and build the mesh */
+        NewMesh = gSharedObjects.SceneMngr->loadMesh(Request->Filename_, Desc.TexturePath, Desc.Format, Desc.Flags);
+        
+        if (NewMesh)
+        {
+            if (Desc.UpdateNormals)
+                NewMesh->updateNormals();
+            if (Desc.TangentLayer != video::TEXTURE_IGNORE)
+                NewMesh->updateTangentSpace(Desc.TangentLayer, Desc.BinormalLayer, false);
+            
+            /* Build the collision kd-tree (the material is set on the render thread) */
+            if (Desc.CollGraph)
+                CollMesh = new CollisionMesh(0, NewMesh, Desc.CollTreeLevel);
+            
+            bool hasAnimations = false;
+            SceneManager::collectUniqueMeshBuffers(NewMesh, Surfaces, hasAnimations);
+        }
+    }
+    else
+        io::Log::error("Could not find mesh file \"" + Request->Filename_ + "\"");
+    
+    io::Log::stopRecording();
+    video::MeshBuffer::setDeferredUpload(false);
+    ActiveRequest = 0;
+    
+    /* Pass the request to the upload queue (failed requests are finished there, too) */
+    Mutex_.lock();
+    
+    Request->Mesh_      = NewMesh;
+    Request->CollMesh_  = CollMesh;
+    
+    Request->Mutex_.lock();
+    Request->Surfaces_  = Surfaces;
+    Request->State_     = ASYNCMESH_UPLOADING;
+    Request->Mutex_.unlock();
+    
+    UploadQueue_.push_back(Request);
+    
+    if (isWaiting_)
+        LoadedSignal_.post();
+    
+    Mutex_.unlock();
+}
+
+void AsyncMeshLoader::finishRequest(const AsyncMeshRequestPtr &Request)
+{
+    Mutex_.lock();
+    removeFromQueue(UploadQueue_, Request.get());
+    Mutex_.unlock();
+    
+    removeFromQueue(Requests_, Request.get());
+    
+    /* Print the messages of the worker thread (the log output is not thread-safe) */
+    io::Log::printRecord(Request->Messages_);
+    Request->Messages_.clear();
+    
+    const bool isLoaded = (Request->Mesh_ != 0);
+    
+    if (isLoaded)
+    {
+        /* Register all new objects in the scene manager */
+        SceneManager* SceneMngr = gSharedObjects.SceneMngr;
+        
+        foreach (Mesh* Obj, Request->Meshes_)
+            SceneMngr->MeshList_.push_back(Obj);
+        foreach (Animation* Anim, Request->Animations_)
+            SceneMngr->AnimationList_.push_back(Anim);
+        
+        Request->Meshes_.clear();
+        Request->Animations_.clear();
+        
+        /* Insert the mesh into the scene- and collision graph */
+        if (Request->Graph_)
+            Request->Graph_->integrateNewMesh(Request->Mesh_);
+        
+        if (Request->CollMesh_)
+        {
+            Request->CollMesh_->setMaterial(Request->Desc_.CollMaterial);
+            Request->Desc_.CollGraph->addCollisionNode(Request->CollMesh_);
+        }
+        
+        Request->setState(ASYNCMESH_FINISHED);
+    }
+    else
+    {
+        io::Log::error("Could not load mesh \"" + Request->Filename_ + "\" asynchronously");
+        Request->deleteMeshes();
+        Request->setState(ASYNCMESH_FAILED);
+    }
+    
+    Request->Mutex_.lock();
+    Request->Surfaces_.clear();
+    Request->Mutex_.unlock();
+    
+    Request->Loader_ = 0;
+    
+    /* Notify the client */
+    if (Request->Desc_.Callback)
+        Request->Desc_.Callback(Request->Mesh_, isLoaded);
+}
+
+void AsyncMeshLoader::removeFromQueue(std::vector<AsyncMeshRequestPtr> &Queue, const AsyncMeshRequest* Request)
+{
+    for (std::vector<AsyncMeshRequestPtr>::iterator it = Queue.begin(); it != Queue.end(); ++it)
+    {
+        if (it->get() == Request)
+        {
+            Queue.erase(it);
+            break;
+        }
+    }
+}
+
+bool AsyncMeshLoader::cancel(AsyncMeshRequest* Request)
+{
+    if (Request->isCanceled_)
+        return false;
+    
+    removeFromQueue(Requests_, Request);
+    
+    Mutex_.lock();
+    
+    const EAsyncMeshStates State = Request->getState();
+    
+    if (State == ASYNCMESH_LOADING)
+    {
+        /* The worker thread still uses this request, so it will be discarded in the next update */
+        Request->isCanceled_ = true;
+    }
+    else
+    {
+        if (State == ASYNCMESH_QUEUED)
+            removeFromQueue(RequestQueue_, Request);
+        else
+            removeFromQueue(UploadQueue_, Request);
+        
+        Request->deleteMeshes();
+        Request->setState(ASYNCMESH_CANCELED);
+        Request->Loader_ = 0;
+    }
+    
+    Mutex_.unlock();
+    
+    return true;
+}
+
+
+} // /namespace scene
+
+} // /namespace sp
+
+
+
+// ================================================================================
@@ -0,0 +1,352 @@
+/*
+ * Asynchronous mesh loader header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_ASYNC_MESH_LOADER_H__
+#define __SP_ASYNC_MESH_LOADER_H__
+
+
+#include "Base/spStandard.hpp"
+#include "Base/spInputOutputString.hpp"
+#include "Base/spInputOutputLog.hpp"
+#include "Base/spCriticalSection.hpp"
+#include "Base/spSemaphore.hpp"
+#include "Base/spThreadManager.hpp"
+#include "Base/spGeometryStructures.hpp"
+
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+
+
+namespace sp
+{
+namespace video
+{
+    class Texture;
+    class MeshBuffer;
+}
+namespace scene
+{
+
+
+class Mesh;
+class Animation;
+class SceneGraph;
+class CollisionGraph;
+class CollisionMaterial;
+class CollisionMesh;
+class AsyncMeshLoader;
+
+/**
+Mesh load callback. This is called on the render thread when an asynchronously loaded mesh has been uploaded
+and inserted into the scene graph, or when the mesh could not be loaded.
+\param Obj: Pointer to the new mesh or null if the mesh could not be loaded.
+\param isLoaded: False if the mesh could not be loaded.
+\see SceneGraph::loadMeshAsync
+\since Version 3.3
+*/
+typedef boost::function<void (Mesh* Obj, bool isLoaded)> MeshLoadCallback;
+
+
+//! States of an asynchronous mesh request. \see AsyncMeshRequest
+enum EAsyncMeshStates
+{
+    ASYNCMESH_QUEUED,       //!< Waiting for a worker thread.
+    ASYNCMESH_LOADING,      //!< A worker thread reads the file and builds the mesh.
+    ASYNCMESH_UPLOADING,    //!< The mesh buffers are being uploaded on the render thread.
+    ASYNCMESH_FINISHED,     //!< The mesh has been uploaded and inserted into the scene graph.
+    ASYNCMESH_FAILED,       //!< The mesh file could not be found.
+    ASYNCMESH_CANCELED,     //!< The request has been canceled.
+};
+
+
+//! Asynchronous mesh loading settings. \see SceneGraph::loadMeshAsync
+struct SP_EXPORT SAsyncMeshDesc
+{
+    SAsyncMeshDesc();
+    ~SAsyncMeshDesc();
+    
+    /* Members */
+    io::stringc TexturePath;            //!< Texture path. By default video::TEXPATH_IGNORE. \see SceneGraph::loadMesh
+    EMeshFileFormats Format;            //!< Mesh file format. By default MESHFORMAT_UNKNOWN.
+    s32 Flags;                          //!< Mesh loader flags. By default 0. \see EMeshLoaderFlags
+    f32 Priority;                       //!< Loading priority. Lower values are loaded first. By default 0.0.
+    bool UpdateNormals;                 //!< Specifies whether the normals are updated on the worker thread. By default false.
+    u8 TangentLayer;                    //!< Tangent texture layer. If not TEXTURE_IGNORE the tangent space is updated on the worker thread.
+    u8 BinormalLayer;                   //!< Binormal texture layer. By default TEXTURE_IGNORE.
+    CollisionGraph* CollGraph;          //!< If not null a collision mesh (incl. its kd-tree) is built on the worker thread and added to this graph.
+    CollisionMaterial* CollMaterial;    //!< Collision material for the collision mesh. By default null.
+    u8 CollTreeLevel;                   //!< Maximal kd-tree level of the collision mesh. By default DEF_KDTREE_LEVEL.
+    MeshLoadCallback Callback;          //!< Optional callback which is called on the render thread when the request is finished.
+};
+
+
+/**
+Asynchronous mesh request. This is a future-like handle which is returned by "SceneGraph::loadMeshAsync".
+The state and the progress can be queried at any time. The mesh is only available when the request has been finished.
+\see AsyncMeshLoader
+\since Version 3.3
+*/
+class SP_EXPORT AsyncMeshRequest
+{
+    
+    public:
+        
+        ~AsyncMeshRequest();
+        
+        /* === Functions === */
+        
+        /**
+        Cancels the request. The callback will not be called and the partially loaded mesh is deleted.
+        This must be called on the render thread.
+        \return True if the request was still pending.
+        */
+        bool cancel();
+        
+        //! Sets the new loading priority. Lower values are loaded and uploaded first.
+        void setPriority(f32 Priority);
+        
+        /**
+        Waits until the request has been finished, i.e. the mesh is uploaded immediately without any budget.
+        This must be called on the render thread (e.g. for loading screens).
+        \return Pointer to the new mesh or null if the request failed or has been canceled.
+        */
+        Mesh* wait();
+        
+        /**
+        Returns the loading progress in the range [0.0 .. 1.0]. Loading the file counts as the first half
+        and uploading the mesh buffers as the second half.
+        */
+        f32 getProgress() const;
+        
+        //! Returns the request state.
+        EAsyncMeshStates getState() const;
+        
+        //! Returns true if the mesh has been uploaded and can be used.
+        bool isReady() const;
+        //! Returns true if the request is no longer pending, i.e. it has been finished, failed or been canceled.
+        bool isDone() const;
+        
+        /* === Inline functions === */
+        
+        //! Returns the new mesh. This is null until the request has been finished.
+        inline Mesh* getMesh() const
+        {
+            return isReady() ? Mesh_ : 0;
+        }
+        //! Returns the new collision mesh (if requested). This is null until the request has been finished.
+        inline CollisionMesh* getCollisionMesh() const
+        {
+            return isReady() ? CollMesh_ : 0;
+        }
+        
+        //! Returns the mesh filename.
+        inline const io::stringc& getFilename() const
+        {
+            return Filename_;
+        }
+        
+    private:
+        
+        friend class AsyncMeshLoader;
+        
+        /* === Functions === */
+        
+        AsyncMeshRequest(AsyncMeshLoader* Loader, SceneGraph* Graph, const io::stringc &Filename, const SAsyncMeshDesc &Desc);
+        
+        void setState(const EAsyncMeshStates State);
+        void deleteMeshes();
+        
+        /* === Members === */
+        
+        AsyncMeshLoader* Loader_;
+        SceneGraph* Graph_;
+        
+        io::stringc Filename_;
+        SAsyncMeshDesc Desc_;
+        
+        /* The state and the upload progress can be queried from any thread */
+        mutable CriticalSection Mutex_;
+        EAsyncMeshStates State_;
+        volatile bool isCanceled_;
+        
+        Mesh* Mesh_;
+        CollisionMesh* CollMesh_;
+        
+        /* Objects which are registered in the scene manager when the request is finished */
+        std::vector<Mesh*> Meshes_;
+        std::vector<Animation*> Animations_;
+        
+        /* Mesh buffers which are uploaded on the render thread */
+        std::vector<video::MeshBuffer*> Surfaces_;
+        u32 NumUploadedSurfaces_;
+        
+        /* Log messages of the worker thread which are printed on the render thread */
+        std::vector<io::SLogMessage> Messages_;
+        
+};
+
+typedef boost::shared_ptr<AsyncMeshRequest> AsyncMeshRequestPtr;
+
+
+/**
+The asynchronous mesh loader runs the mesh loaders on worker threads. The workers read and parse the files,
+build the mesh buffers (incl. normals, tangent space and the optional collision kd-tree) without accessing the render system.
+The hardware buffers are created and uploaded on the render thread with "update" under a per-frame byte and time budget.
+Textures which are referenced by the mesh files are loaded with the AsyncTextureLoader.
+Requests with lower priority values are loaded and uploaded first.
+\see SceneGraph::loadMeshAsync
+\see SceneManager::getAsyncMeshLoader
+\since Version 3.3
+*/
+class SP_EXPORT AsyncMeshLoader
+{
+    
+    public:
+        
+        AsyncMeshLoader(u32 ThreadCount = 2);
+        ~AsyncMeshLoader();
+        
+        /* === Functions === */
+        
+        /**
+        Requests the specified mesh file. When it has been uploaded it will be inserted into the specified scene graph.
+        \param Graph: Specifies the scene graph for the new mesh. May be null.
+        \param Filename: Specifies the mesh filename.
+        \param Desc: Specifies the loading settings.
+        \return Shared pointer to the new request.
+        */
+        AsyncMeshRequestPtr request(SceneGraph* Graph, const io::stringc &Filename, const SAsyncMeshDesc &Desc = SAsyncMeshDesc());
+        
+        /**
+        Uploads the loaded meshes under the upload budget and finishes their requests.
+        At least one mesh buffer is uploaded per call. This must be called on the render thread.
+        It is called automatically once per frame by "SoftPixelDevice::updateEvents".
+        \see setUploadBudget
+        */
+        void update();
+        
+        //! Waits until all pending meshes have been loaded and uploaded (e.g. for loading screens).
+        void flush();
+        
+        /* === Static functions === */
+        
+        //! Returns true if the calling thread is a worker thread which is currently loading a mesh.
+        static bool isLoaderThread();
+        
+        /**
+        Loads a texture for the mesh which is loaded by the calling worker thread. The texture object is created on the
+        render thread with "RenderSystem::loadTextureAsync" and the worker waits for it.
+        This is called by "RenderSystem::loadTexture" on loader threads.
+        */
+        static video::Texture* loadTexture(const io::stringc &Filename);
+        
+        /**
+        Defers the registration of a new mesh in the scene manager until the request has been finished.
+        \return False if the calling thread is no loader thread.
+        */
+        static bool deferMesh(Mesh* Obj);
+        //! Defers the registration of a new animation in the scene manager. \see deferMesh
+        static bool deferAnimation(Animation* Anim);
+        
+        /* === Inline functions === */
+        
+        /**
+        Sets the upload budget per frame.
+        \param MaxBytes: Specifies the maximal count of vertex and index bytes which are uploaded per frame. By default 4 MB.
+        \param MaxMicroseconds: Specifies the maximal upload time (in microseconds) per frame. By default 2000.
+        */
+        inline void setUploadBudget(u32 MaxBytes, u32 MaxMicroseconds)
+        {
+            MaxUploadBytes_ = MaxBytes;
+            MaxUploadTime_  = MaxMicroseconds;
+        }
+        
+        //! Returns the count of meshes which are waiting to be loaded or uploaded.
+        inline u32 getNumPendingMeshes() const
+        {
+            return Requests_.size();
+        }
+        //! Returns the count of vertex and index bytes which have been uploaded in the last update.
+        inline u32 getNumUploadedBytes() const
+        {
+            return NumUploadedBytes_;
+        }
+        
+    private:
+        
+        friend THREAD_PROC(AsyncMeshLoaderThreadProc);
+        friend class AsyncMeshRequest;
+        
+        /* === Structures === */
+        
+        struct STextureRequest
+        {
+            STextureRequest(const io::stringc &InitFilename, f32 InitPriority);
+            ~STextureRequest();
+            
+            /* Members */
+            io::stringc Filename;
+            f32 Priority;
+            video::Texture* Tex;
+            Semaphore Done;     //!< Signaled when the texture has been created.
+        };
+        
+        /* === Functions === */
+        
+        void upload(u32 MaxBytes, u64 MaxTime);
+        void waitUntilDone(const AsyncMeshRequest* Request);
+        void processTextureRequests();
+        
+        AsyncMeshRequestPtr popRequest();
+        AsyncMeshRequestPtr getLoadedRequest();
+        
+        void loadRequest(const AsyncMeshRequestPtr &Request);
+        void finishRequest(const AsyncMeshRequestPtr &Request);
+        
+        bool cancel(AsyncMeshRequest* Request);
+        
+        static void removeFromQueue(std::vector<AsyncMeshRequestPtr> &Queue, const AsyncMeshRequest* Request);
+        
+        /* === Members === */
+        
+        std::vector<AsyncMeshRequestPtr> Requests_;
+        
+        std::vector<AsyncMeshRequestPtr> RequestQueue_;
+        std::vector<AsyncMeshRequestPtr> UploadQueue_;
+        
+        std::vector<STextureRequest*> TextureRequests_;
+        
+        CriticalSection Mutex_;
+        
+        Semaphore RequestSignal_;
+        Semaphore ExitSignal_;
+        Semaphore LoadedSignal_;
+        
+        std::vector<ThreadManager*> Threads_;
+        volatile bool isRunning_;
+        
+        u32 MaxUploadBytes_;
+        u32 MaxUploadTime_;
+        
+        u32 NumUploadedBytes_;
+        
+        bool isWaiting_;
+        
+};
+
+
+} // /namespace scene
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
@@ -6,6 +6,7 @@
  */
 
 #include "SceneGraph/spRenderNode.hpp"
+#include "RenderSystem/spRenderCommandBuffer.hpp"
 #include "Platform/spSoftPixelDeviceOS.hpp"
 
 
@@ -48,6 +49,11 @@ void RenderNode::updateTransformation()
     DepthDistance_ = (spViewMatrix * FinalWorldMatrix_.getPosition()).Z;
 }
 
+void RenderNode::recordRender(video::RenderCommandBuffer &CmdBuffer)
+{
+    CmdBuffer.renderNode(this);
+}
+
 
 } // /namespace scene
 
@@ -15,6 +15,10 @@
 
 namespace sp
 {
+namespace video
+{
+    class RenderCommandBuffer;
+}
 namespace scene
 {
 
@@ -39,6 +43,15 @@ class SP_EXPORT RenderNode : public SceneNode
         //! Updates the objects transformation and sets the depth distance.
         virtual void updateTransformation();
         
+        /**
+        Records the rendering of this object into the specified command buffer instead of rendering it immediately.
+        This may be called on a worker thread, thus it must not call the render system. By default the node is recorded
+        with "RenderCommandBuffer::renderNode", i.e. it will be rendered as usual when the command buffer is submitted.
+        \see video::RenderCommandBuffer
+        \since Version 3.3
+        */
+        virtual void recordRender(video::RenderCommandBuffer &CmdBuffer);
+        
         /* Depth distance sorting */
         
         //! Sets the depth distance. This value is used for sorting the objects by its distance to the camera view.
@@ -10,6 +10,9 @@
 #include "Platform/spSoftPixelDeviceOS.hpp"
 #include "Base/spInternalDeclarations.hpp"
 #include "Base/spSharedObjects.hpp"
+#include "Base/spThreadPool.hpp"
+#include "Base/spProfiler.hpp"
+#include "RenderSystem/spRenderCommandBuffer.hpp"
 
 #include <boost/foreach.hpp>
 
@@ -94,6 +97,28 @@ static bool compareRenderNodesMeshBuffer(RenderNode* ObjA, RenderNode* ObjB)
     return ObjA->getType() > ObjB->getType();
 }
 
+struct SRecordingTaskData
+{
+    const std::vector<RenderNode*>* Nodes;
+    const std::vector<video::RenderCommandBuffer*>* CmdBuffers;
+    u32 RangeSize;
+};
+
+static void RecordingTaskProc(u32 Index, void* UserData)
+{
+    const SRecordingTaskData* TaskData = reinterpret_cast<const SRecordingTaskData*>(UserData);
+    
+    /* Record the range of this task into its own command buffer */
+    const u32 NumNodes  = TaskData->Nodes->size();
+    const u32 First     = math::Min(Index * TaskData->RangeSize, NumNodes);
+    const u32 Last      = math::Min((Index + 1) * TaskData->RangeSize, NumNodes);
+    
+    video::RenderCommandBuffer* CmdBuffer = (*TaskData->CmdBuffers)[Index];
+    
+    for (u32 i = First; i < Last; ++i)
+        (*TaskData->Nodes)[i]->recordRender(*CmdBuffer);
+}
+
 
 /*
  * SceneGraph class
@@ -102,59 +127,75 @@ static bool compareRenderNodesMeshBuffer(RenderNode* ObjA, RenderNode* ObjB)
 bool SceneGraph::ReverseDepthSorting_ = false;
 
 SceneGraph::SceneGraph(const ESceneGraphs Type) :
-    RenderNode      (NODE_SCENEGRAPH        ),
-    GraphType_      (Type                   ),
-    hasChildTree_   (false                  ),
-    ActiveCamera_   (0                      ),
-    ActiveMesh_     (0                      ),
-    WireframeFront_ (video::WIREFRAME_SOLID ),
-    WireframeBack_  (video::WIREFRAME_SOLID ),
-    DepthSorting_   (true                   ),
-    LightSorting_   (true                   )
+    RenderNode          (NODE_SCENEGRAPH        ),
+    GraphType_          (Type                   ),
+    hasChildTree_       (false                  ),
+    ActiveCamera_       (0                      ),
+    ActiveMesh_         (0                      ),
+    WireframeFront_     (video::WIREFRAME_SOLID ),
+    WireframeBack_      (video::WIREFRAME_SOLID ),
+    DepthSorting_       (true                   ),
+    LightSorting_       (true                   ),
+    AutoInstancing_     (false                  ),
+    MinInstances_       (2                      ),
+    ParallelRecording_  (false                  ),
+    RecordingThreads_   (0                      )
 {
 }
 SceneGraph::~SceneGraph()
 {
+    MemoryManager::deleteList(CommandBuffers_);
 }
 
 void SceneGraph::addSceneNode(SceneNode* Object)
 {
     if (Object)
-        NodeList_.push_back(Object);
+        addObjectToList<SceneNode>(Object, NodeList_);
 }
 void SceneGraph::removeSceneNode(SceneNode* Object)
 {
-    MemoryManager::removeElement(NodeList_, Object);
+    removeObjectFromList<SceneNode>(Object, NodeList_);
 }
 
 void SceneGraph::addSceneNode(Camera* Object)
 {
     if (Object)
-        CameraList_.push_back(Object);
+        addObjectToList<Camera>(Object, CameraList_);
 }
 void SceneGraph::removeSceneNode(Camera* Object)
 {
-    MemoryManager::removeElement(CameraList_, Object);
+    removeObjectFromList<Camera>(Object, CameraList_);
 }
 
 void SceneGraph::addSceneNode(Light* Object)
 {
     if (Object)
-        LightList_.push_back(Object);
+        addObjectToList<Light>(Object, LightList_);
 }
 void SceneGraph::removeSceneNode(Light* Object)
 {
-    MemoryManager::removeElement(LightList_, Object);
+    removeObjectFromList<Light>(Object, LightList_);
 }
 
 void SceneGraph::addSceneNode(RenderNode* Object)
 {
     if (Object)
-        RenderList_.push_back(Object);
+        addObjectToList<RenderNode>(Object, RenderList_);
 }
 void SceneGraph::removeSceneNode(RenderNode* Object)
 {
-    MemoryManager::removeElement(RenderList_, Object);
+    removeObjectFromList<RenderNode>(Object, RenderList_);
+}
+
+void SceneGraph::addSceneNodes(const std::vector<SceneNode*> &Objects)
+{
+    foreach (SceneNode* Obj, Objects)
+        addSceneNodeByType(Obj);
+}
+void SceneGraph::removeSceneNodes(const std::vector<SceneNode*> &Objects)
+{
+    foreach (SceneNode* Obj, Objects)
+        removeSceneNodeByType(Obj);
 }
 
 void SceneGraph::addRootNode(SceneNode* Object)
@@ -206,6 +247,10 @@ Mesh* SceneGraph::loadMesh(const io::stringc &Filename, const io::stringc &Textu
 {
     return integrateNewMesh(gSharedObjects.SceneMngr->loadMesh(Filename, TexturePath, Format, Flags));
 }
+AsyncMeshRequestPtr SceneGraph::loadMeshAsync(const io::stringc &Filename, const SAsyncMeshDesc &Desc)
+{
+    return gSharedObjects.SceneMngr->getAsyncMeshLoader()->request(this, Filename, Desc);
+}
 bool SceneGraph::saveMesh(Mesh* Model, const io::stringc &Filename, const EMeshFileFormats Format)
 {
     return gSharedObjects.SceneMngr->saveMesh(Model, Filename, Format);
@@ -249,6 +294,14 @@ Terrain* SceneGraph::createTerrain(
     return NewTerrain;
 }
 
+StreamedTerrain* SceneGraph::createStreamedTerrain(const SStreamedTerrainDesc &Desc)
+{
+    StreamedTerrain* NewTerrain = gSharedObjects.SceneMngr->createStreamedTerrain(Desc);
+    if (NewTerrain)
+        addSceneNode(NewTerrain);
+    return NewTerrain;
+}
+
 void SceneGraph::renderScene()
 {
     foreach (Camera* Cam, CameraList_)
@@ -260,6 +313,8 @@ void SceneGraph::renderScene()
 
 void SceneGraph::renderScene(Camera* ActiveCamera)
 {
+    SP_PROFILE_SCOPE("SceneGraph::renderScene");
+    
     /* Configure view to the current active camera */
     setActiveCamera(ActiveCamera);
     
@@ -427,25 +482,7 @@ bool SceneGraph::deleteNode(SceneNode* Object)
 {
     if (Object)
     {
-        switch (Object->getType())
-        {
-            case NODE_CAMERA:
-                removeSceneNode(static_cast<Camera*>(Object));
-                break;
-            case NODE_LIGHT:
-                removeSceneNode(static_cast<Light*>(Object));
-                break;
-            case NODE_MESH:
-            case NODE_BILLBOARD:
-            case NODE_TERRAIN:
-            case NODE_SCENEGRAPH:
-                removeSceneNode(static_cast<RenderNode*>(Object));
-                break;
-            default:
-                removeSceneNode(Object);
-                break;
-        }
-        
+        removeSceneNodeByType(Object);
         gSharedObjects.SceneMngr->deleteNode(Object);
     }
     return false;
@@ -611,8 +648,10 @@ void SceneGraph::sortRenderList(const ERenderListSortMethods Method, std::vector
             std::sort(ObjectList.begin(), ObjectList.end(), compareRenderNodesMeshBuffer);
             break;
         default:
-            break;
+            return;
     }
+    
+    updateListIndices(ObjectList);
 }
 
 void SceneGraph::sortRenderList(const ERenderListSortMethods Method)
@@ -635,8 +674,60 @@ Mesh* SceneGraph::integrateNewMesh(Mesh* NewMesh)
     return NewMesh;
 }
 
+void SceneGraph::addSceneNodeByType(SceneNode* Object)
+{
+    if (!Object)
+        return;
+    
+    switch (Object->getType())
+    {
+        case NODE_CAMERA:
+            addSceneNode(static_cast<Camera*>(Object));
+            break;
+        case NODE_LIGHT:
+            addSceneNode(static_cast<Light*>(Object));
+            break;
+        case NODE_MESH:
+        case NODE_BILLBOARD:
+        case NODE_TERRAIN:
+        case NODE_SCENEGRAPH:
+            addSceneNode(static_cast<RenderNode*>(Object));
+            break;
+        default:
+            addSceneNode(Object);
+            break;
+    }
+}
+
+void SceneGraph::removeSceneNodeByType(SceneNode* Object)
+{
+    if (!Object)
+        return;
+    
+    switch (Object->getType())
+    {
+        case NODE_CAMERA:
+            removeSceneNode(static_cast<Camera*>(Object));
+            break;
+        case NODE_LIGHT:
+            removeSceneNode(static_cast<Light*>(Object));
+            break;
+        case NODE_MESH:
+        case NODE_BILLBOARD:
+        case NODE_TERRAIN:
+        case NODE_SCENEGRAPH:
+            removeSceneNode(static_cast<RenderNode*>(Object));
+            break;
+        default:
+            removeSceneNode(Object);
+            break;
+    }
+}
+
 void SceneGraph::arrangeRenderList(std::vector<RenderNode*> &ObjectList, const dim::matrix4f &BaseMatrix)
 {
+    SP_PROFILE_SCOPE("SceneGraph::arrangeRenderList");
+    
     if (ActiveCamera_)
         ActiveCamera_->updateTransformation();
     
@@ -659,6 +750,7 @@ void SceneGraph::arrangeLightList(std::vector<Light*> &ObjectList)
     
     /* Sort light list */
     std::sort(ObjectList.begin(), ObjectList.end(), cmpObjectLights);
+    updateListIndices(ObjectList);
     
     /* Update renderer lights for the first [MaxLightCount] objects */
     //if (!RenderFixedFunctionOnly || !GlbRenderSys->getGlobalShaderClass())
@@ -706,12 +798,257 @@ void SceneGraph::renderLightsDefault(const dim::matrix4f &BaseMatrix, bool Rende
     }
 }
 
+void SceneGraph::renderListInstanced(const std::vector<RenderNode*> &ObjectList, bool isSorted)
+{
+    InstancingStats_ = SInstancingStats();
+    
+    const bool isInstancingSupported = GlbRenderSys->queryVideoSupport(video::VIDEOSUPPORT_HARDWARE_INSTANCING);
+    const u32 Count = ObjectList.size();
+    
+    for (u32 i = 0; i < Count;)
+    {
+        RenderNode* Node = ObjectList[i];
+        
+        if (!Node->getVisible())
+        {
+            if (isSorted)
+                break;
+            ++i;
+            continue;
+        }
+        
+        /* Find the run of meshes which can be drawn instanced together with this mesh */
+        u32 RunEnd = i + 1;
+        
+        if (isInstancingSupported && Node->getType() == NODE_MESH && getInstancingShaderClass(static_cast<Mesh*>(Node)))
+        {
+            const Mesh* Object = static_cast<const Mesh*>(Node);
+            
+            while ( RunEnd < Count && ObjectList[RunEnd]->getVisible() && ObjectList[RunEnd]->getType() == NODE_MESH &&
+                    compareInstances(Object, static_cast<const Mesh*>(ObjectList[RunEnd])) )
+            {
+                ++RunEnd;
+            }
+        }
+        
+        /* Render the run instanced or the single node as usual */
+        if (RunEnd - i >= MinInstances_)
+            renderInstances(ObjectList, i, RunEnd);
+        else
+        {
+            for (; i < RunEnd; ++i)
+                ObjectList[i]->render();
+        }
+        
+        i = RunEnd;
+    }
+}
+
+void SceneGraph::renderListRecorded(const std::vector<RenderNode*> &ObjectList, bool isSorted)
+{
+    SP_PROFILE_SCOPE("SceneGraph::renderListRecorded");
+    
+    /* Collect the visible nodes */
+    RecordList_.clear();
+    
+    foreach (RenderNode* Node, ObjectList)
+    {
+        if (Node->getVisible())
+            RecordList_.push_back(Node);
+        else if (isSorted)
+            break;
+    }
+    
+    foreach (video::RenderCommandBuffer* CmdBuffer, CommandBuffers_)
+        CmdBuffer->clear();
+    
+    if (RecordList_.empty())
+        return;
+    
+    /* Starting a thread is only worth it for a larger range of nodes */
+    static const u32 MIN_NODES_PER_THREAD = 64;
+    
+    /* Record on the engine's shared thread pool (its workers plus this thread) to not oversubscribe the CPU */
+    ThreadPool* Pool = ThreadPool::getShared();
+    
+    u32 MaxThreadCount = Pool->getThreadCount() + 1;
+    
+    if (RecordingThreads_)
+        MaxThreadCount = math::Min(MaxThreadCount, RecordingThreads_);
+    
+    const u32 ThreadCount = math::MinMax(
+        MaxThreadCount, 1u, (static_cast<u32>(RecordList_.size()) + MIN_NODES_PER_THREAD - 1) / MIN_NODES_PER_THREAD
+    );
+    
+    while (CommandBuffers_.size() < ThreadCount)
+        CommandBuffers_.push_back(new video::RenderCommandBuffer());
+    
+    /* Each task records a contiguous range, so submitting the buffers in order keeps the order of the render list */
+    SRecordingTaskData TaskData;
+    {
+        TaskData.Nodes      = (&RecordList_);
+        TaskData.CmdBuffers = (&CommandBuffers_);
+        TaskData.RangeSize  = (RecordList_.size() + ThreadCount - 1) / ThreadCount;
+    }
+    
+    if (ThreadCount > 1)
+    {
+        /* This thread records ranges as well and blocks until all ranges are finished */
+        Pool->run(RecordingTaskProc, &TaskData, ThreadCount);
+    }
+    else
+        RecordingTaskProc(0, &TaskData);
+    
+    /* Submit the command buffers in order */
+    for (u32 i = 0; i < ThreadCount; ++i)
+        CommandBuffers_[i]->submit();
+}
+
 void SceneGraph::finishRenderScene()
 {
     GlbRenderSys->endSceneRendering();
 }
 
 
+/*
+ * ======= Private: =======
+ */
+
+video::ShaderClass* SceneGraph::getInstancingShaderClass(const Mesh* Object) const
+{
+    /* Meshes with LOD sub meshes or user callbacks must be rendered individually */
+    if ( Object->LODSurfaceList_->empty() || Object->UseLODSubMeshes_ || Object->UserRenderProc_ ||
+         Object->getMaterial()->getMaterialCallback() )
+    {
+        return 0;
+    }
+    
+    /* The shader class must be able to receive the world matrices of the instances */
+    video::ShaderClass* ShdClass = GlbRenderSys->getGlobalShaderClass();
+    
+    if (!ShdClass)
+        ShdClass = Object->getShaderClass();
+    
+    if (!ShdClass || !ShdClass->getInstanceCallback())
+        return 0;
+    
+    /* Mesh buffers which are already instanced by the user can not be batched */
+    foreach (const video::MeshBuffer* Surface, *Object->LODSurfaceList_)
+    {
+        if (Surface->getReference()->getHardwareInstancing() > 1)
+            return 0;
+    }
+    
+    return ShdClass;
+}
+
+bool SceneGraph::compareInstances(const Mesh* ObjA, const Mesh* ObjB) const
+{
+    /* Compare shader classes */
+    if (ObjA->getShaderClass() != ObjB->getShaderClass() || !getInstancingShaderClass(ObjB))
+        return false;
+    
+    /* Compare mesh buffers (instances share the surface list or the surface references) */
+    if (ObjA->LODSurfaceList_ != ObjB->LODSurfaceList_)
+    {
+        const std::vector<video::MeshBuffer*> &SurfacesA = *ObjA->LODSurfaceList_;
+        const std::vector<video::MeshBuffer*> &SurfacesB = *ObjB->LODSurfaceList_;
+        
+        if (SurfacesA.size() != SurfacesB.size())
+            return false;
+        
+        for (u32 i = 0; i < SurfacesA.size(); ++i)
+        {
+            if (SurfacesA[i]->getReference() != SurfacesB[i]->getReference())
+                return false;
+            
+            /* Compare textures */
+            const std::vector<video::TextureLayer*> &TexLayersA = SurfacesA[i]->getTextureLayerList();
+            const std::vector<video::TextureLayer*> &TexLayersB = SurfacesB[i]->getTextureLayerList();
+            
+            if (TexLayersA.size() != TexLayersB.size())
+                return false;
+            
+            for (u32 j = 0; j < TexLayersA.size(); ++j)
+            {
+                if (TexLayersA[j]->getTexture() != TexLayersB[j]->getTexture() || TexLayersA[j]->getType() != TexLayersB[j]->getType())
+                    return false;
+            }
+        }
+    }
+    
+    /* Compare material states */
+    return ObjA->getMaterial()->compare(ObjB->getMaterial());
+}
+
+void SceneGraph::renderInstances(const std::vector<RenderNode*> &ObjectList, u32 First, u32 Last)
+{
+    Mesh* Object = static_cast<Mesh*>(ObjectList[First]);
+    
+    video::ShaderClass* ShdClass = getInstancingShaderClass(Object);
+    const u32 MaxInstances = ShdClass->getMaxInstances();
+    
+    /* Collect the world matrices of all visible instances */
+    InstanceMatrices_.clear();
+    
+    for (u32 i = First; i < Last; ++i)
+    {
+        Mesh* Instance = static_cast<Mesh*>(ObjectList[i]);
+        
+        Instance->loadTransformation();
+        
+        /* Frustum culling */
+        if (ActiveCamera_ && !Instance->BoundVolume_.checkFrustumCulling(ActiveCamera_->getViewFrustum(), spWorldMatrix))
+            continue;
+        
+        InstanceMatrices_.push_back(spWorldMatrix);
+        
+        if (InstanceMatrices_.size() >= MaxInstances)
+        {
+            drawInstances(Object, ShdClass, &InstanceMatrices_[0], InstanceMatrices_.size());
+            InstanceMatrices_.clear();
+        }
+    }
+    
+    if (!InstanceMatrices_.empty())
+        drawInstances(Object, ShdClass, &InstanceMatrices_[0], InstanceMatrices_.size());
+}
+
+void SceneGraph::drawInstances(Mesh* Object, video::ShaderClass* ShdClass, const dim::matrix4f* WorldMatrices, u32 NumInstances)
+{
+    /* The shader applies the world matrices of the instances */
+    spWorldMatrix.reset();
+    
+    setActiveMesh(Object);
+    GlbRenderSys->updateModelviewMatrix();
+    
+    /* Setup material states and pass the world matrices to the shader */
+    GlbRenderSys->setupMaterialStates(Object->getMaterial());
+    GlbRenderSys->setupShaderClass(Object, Object->getShaderClass());
+    
+    ShdClass->getInstanceCallback()(ShdClass, WorldMatrices, NumInstances);
+    
+    /* Draw all instances of each surface at once */
+    foreach (video::MeshBuffer* Surface, *Object->LODSurfaceList_)
+    {
+        video::MeshBuffer* Reference = Surface->getReference();
+        
+        const u32 PrevNumInstances = Reference->getHardwareInstancing();
+        
+        Reference->setHardwareInstancing(NumInstances);
+        GlbRenderSys->drawMeshBuffer(Surface);
+        Reference->setHardwareInstancing(PrevNumInstances);
+    }
+    
+    GlbRenderSys->unbindShaders();
+    
+    /* Update the statistics */
+    ++InstancingStats_.NumBatches;
+    InstancingStats_.NumInstances += NumInstances;
+    InstancingStats_.NumDrawCallsSaved += (NumInstances - 1) * Object->LODSurfaceList_->size();
+}
+
+
 } // /namespace scene
 
 } // /namespace sp
@@ -19,6 +19,9 @@
 #include "SceneGraph/spSceneLight.hpp"
 #include "SceneGraph/spSceneBillboard.hpp"
 #include "SceneGraph/spSceneTerrain.hpp"
+#include "SceneGraph/spSceneStreamedTerrain.hpp"
+#include "SceneGraph/spSceneStaticGeometry.hpp"
+#include "SceneGraph/spAsyncMeshLoader.hpp"
 #include "SceneGraph/spCameraFirstPerson.hpp"
 #include "SceneGraph/spCameraBlender.hpp"
 #include "SceneGraph/spCameraTracking.hpp"
@@ -48,6 +51,29 @@ enum ESceneGraphs
     SCENEGRAPH_PORTAL_BASED,    //!< Portal-based scene graph.
 };
 
+/**
+Automatic instancing statistics of one frame.
+\see SceneGraph::setAutoInstancing
+\since Version 3.3
+*/
+struct SInstancingStats
+{
+    SInstancingStats() :
+        NumBatches          (0),
+        NumInstances        (0),
+        NumDrawCallsSaved   (0)
+    {
+    }
+    ~SInstancingStats()
+    {
+    }
+    
+    /* Members */
+    u32 NumBatches;         //!< Count of instance batches. Each batch is drawn with one draw call per surface.
+    u32 NumInstances;       //!< Count of meshes which have been drawn instanced.
+    u32 NumDrawCallsSaved;  //!< Count of draw calls which would have been issued without automatic instancing.
+};
+
 //! Sort methods for the render node list.
 enum ERenderListSortMethods
 {
@@ -87,12 +113,27 @@ class SP_EXPORT SceneGraph : public RenderNode
         virtual void addSceneNode(Light*        Object);
         virtual void addSceneNode(RenderNode*   Object);
         
-        //! Removes the sepcified node from the scene node list.
+        /**
+        Removes the sepcified node from the scene node list. This takes constant time because each node
+        stores its position in the list and the last node is moved into the gap.
+        \note Therefore the order of the lists is not preserved. The render list is sorted each frame anyway
+        when depth sorting is enabled.
+        */
         virtual void removeSceneNode(SceneNode*     Object);
         virtual void removeSceneNode(Camera*        Object);
         virtual void removeSceneNode(Light*         Object);
         virtual void removeSceneNode(RenderNode*    Object);
         
+        /**
+        Adds all specified nodes to the scene graph. Each node is added to the list of its type
+        (see "getType"), i.e. cameras to the camera list, lights to the light list and
+        meshes, billboards and terrains to the render list.
+        \since Version 3.3
+        */
+        virtual void addSceneNodes(const std::vector<SceneNode*> &Objects);
+        //! Removes all specified nodes from the scene graph. \see addSceneNodes \since Version 3.3
+        virtual void removeSceneNodes(const std::vector<SceneNode*> &Objects);
+        
         //! Adds a root SceneNode object. This is basically used for child tree scene managers.
         virtual void addRootNode(SceneNode* Object);
         
@@ -174,6 +215,18 @@ class SP_EXPORT SceneGraph : public RenderNode
             const EMeshFileFormats Format = MESHFORMAT_UNKNOWN
         );
         
+        /**
+        Loads a 3D model asynchronously. The file is read and the mesh is built on the worker threads of the AsyncMeshLoader.
+        The mesh buffers are uploaded on the render thread under a per-frame budget and then the mesh is inserted into this scene graph.
+        \param[in] Filename Specifies the model filename which is to be loaded.
+        \param[in] Desc Specifies the loading settings, e.g. the priority, the callback or whether a collision mesh is to be built.
+        \return Shared pointer to the request. Use it to query the progress, to wait for or to cancel the request.
+        \see AsyncMeshLoader
+        \see SceneManager::getAsyncMeshLoader
+        \since Version 3.3
+        */
+        virtual AsyncMeshRequestPtr loadMeshAsync(const io::stringc &Filename, const SAsyncMeshDesc &Desc = SAsyncMeshDesc());
+        
         /**
         Saves a model to the disk.
         \param Model: 3D model which is to be saved.
@@ -242,6 +295,15 @@ class SP_EXPORT SceneGraph : public RenderNode
             const video::SHeightMapTexture &TextureHeightMap, const dim::size2di &Resolution, s32 GeoMIPLevels = DEF_GEOMIP_LEVELS
         );
         
+        /**
+        Creates a streamed terrain. The height field is paged from disk around the active camera,
+        so its size is not limited by the available memory.
+        \param Desc: Specifies the terrain description with the height field filename and size.
+        \return Pointer to the new StreamedTerrain object or null if the height field could not be opened.
+        \see StreamedTerrain
+        */
+        virtual StreamedTerrain* createStreamedTerrain(const SStreamedTerrainDesc &Desc);
+        
         /**
         Copies the specified scene node and returns a pointer to the new
         object or a null pointer if the template object was specified as a null pointer.
@@ -355,6 +417,8 @@ class SP_EXPORT SceneGraph : public RenderNode
         Sorts the list of renderable scene nodes.
         \param[in] Method Specifies the sorting method. If 'depth-sorting' is enabled every time
         the scene graph is rendered this function will be called with the parameter RENDERLIST_SORT_DEPTHDISTANCE.
+        \note The order is not kept when nodes are added or removed (a removed node is replaced by the last one).
+        Sort the list again after such changes.
         \see ERenderListSortMethods
         */
         virtual void sortRenderList(const ERenderListSortMethods Method, std::vector<RenderNode*> &ObjectList);
@@ -465,6 +529,78 @@ class SP_EXPORT SceneGraph : public RenderNode
             return LightSorting_;
         }
         
+        /**
+        Enables or disables automatic instancing. When enabled, consecutive meshes in the (sorted) render list
+        which share the same mesh buffers (see Mesh::setReference and MeshBuffer::setReference), material states
+        and shader class are drawn with one instanced draw call per surface. The world matrices of the instances
+        are passed to the shader class's instance callback (see ShaderClass::setInstanceCallback).
+        Meshes without an instance callback, with LOD sub meshes, a render callback or a material callback are drawn as usual.
+        \param[in] Enable Specifies whether automatic instancing is to be enabled or disabled. By default disabled.
+        \param[in] MinInstances Specifies the minimal count of meshes which are drawn instanced. By default 2.
+        \note Depth sorting interleaves the instances with other meshes. Disable depth sorting and sort the
+        render list with RENDERLIST_SORT_MESHBUFFER to get the longest runs of instances. Adding or removing
+        nodes breaks these runs, so the list must be sorted again afterwards.
+        \note For instanced draw calls the world matrix is the identity matrix, i.e. the shader has to apply the world matrices of the instances.
+        \note Only SceneGraphSimple and SceneGraphSimpleStream support automatic instancing. The other scene graphs ignore this setting.
+        \see sortRenderList
+        \see getInstancingStats
+        \since Version 3.3
+        */
+        inline void setAutoInstancing(bool Enable, u32 MinInstances = 2)
+        {
+            AutoInstancing_     = Enable;
+            MinInstances_       = math::Max(2u, MinInstances);
+        }
+        //! Returns true if automatic instancing is enabled. By default disabled.
+        inline bool getAutoInstancing() const
+        {
+            return AutoInstancing_;
+        }
+        
+        /**
+        Returns the automatic instancing statistics of the last rendered frame.
+        \see setAutoInstancing
+        \since Version 3.3
+        */
+        inline const SInstancingStats& getInstancingStats() const
+        {
+            return InstancingStats_;
+        }
+        
+        /**
+        Enables or disables parallel recording. When enabled, the visible render nodes are split into contiguous ranges
+        which are recorded into one command buffer per thread (see RenderNode::recordRender). Afterwards the command buffers
+        are submitted in order on the render thread, so the result is the same as with immediate rendering.
+        Automatic instancing has priority over parallel recording.
+        \param[in] Enable Specifies whether parallel recording is to be enabled or disabled. By default disabled.
+        \param[in] ThreadCount Specifies the maximal count of recording threads (including the render thread).
+        By default 0 which means all threads of the shared thread pool (see ThreadPool::getShared). Small scenes are recorded with fewer threads.
+        \note Only SceneGraphSimple and SceneGraphSimpleStream support parallel recording. The other scene graphs ignore this setting.
+        \see video::RenderCommandBuffer
+        \since Version 3.3
+        */
+        inline void setParallelRecording(bool Enable, u32 ThreadCount = 0)
+        {
+            ParallelRecording_  = Enable;
+            RecordingThreads_   = ThreadCount;
+        }
+        //! Returns true if parallel recording is enabled. By default disabled.
+        inline bool getParallelRecording() const
+        {
+            return ParallelRecording_;
+        }
+        
+        /**
+        Returns the command buffers of the last rendered frame. Only the buffers of the threads
+        which have been used in the last frame are non-empty.
+        \see setParallelRecording
+        \since Version 3.3
+        */
+        inline const std::vector<video::RenderCommandBuffer*>& getCommandBuffers() const
+        {
+            return CommandBuffers_;
+        }
+        
         /* === Static functions === */
         
         /**
@@ -481,6 +617,7 @@ class SP_EXPORT SceneGraph : public RenderNode
         friend class RenderNode;
         friend class MaterialNode;
         friend class Mesh;
+        friend class AsyncMeshLoader;
         
         /* === Functions === */
         
@@ -488,6 +625,11 @@ class SP_EXPORT SceneGraph : public RenderNode
         
         Mesh* integrateNewMesh(Mesh* NewMesh);
         
+        //! Adds the node with the "addSceneNode" overload which fits to its type.
+        void addSceneNodeByType(SceneNode* Object);
+        //! Removes the node with the "removeSceneNode" overload which fits to its type.
+        void removeSceneNodeByType(SceneNode* Object);
+        
         /**
         Arranges the list of all renderable scene nodes, i.e. the objects will be transformed with the
         active view matrix and the list will be sorted if depth-sorting is enabled.
@@ -510,6 +652,22 @@ class SP_EXPORT SceneGraph : public RenderNode
         */
         void renderLightsDefault(const dim::matrix4f &BaseMatrix, bool RenderFixedFunctionOnly = true);
         
+        /**
+        Renders all visible nodes of the specified list and draws runs of compatible meshes instanced.
+        \param[in] ObjectList Specifies the (arranged) render node list.
+        \param[in] isSorted Specifies whether the invisible nodes are sorted to the end of the list.
+        \see setAutoInstancing
+        */
+        void renderListInstanced(const std::vector<RenderNode*> &ObjectList, bool isSorted);
+        
+        /**
+        Records all visible nodes of the specified list in parallel and submits the command buffers in order.
+        \param[in] ObjectList Specifies the (arranged) render node list.
+        \param[in] isSorted Specifies whether the invisible nodes are sorted to the end of the list.
+        \see setParallelRecording
+        */
+        void renderListRecorded(const std::vector<RenderNode*> &ObjectList, bool isSorted);
+        
         static void finishRenderScene();
         
         /* === Templates === */
@@ -526,23 +684,55 @@ class SP_EXPORT SceneGraph : public RenderNode
                 else
                     ++it;
             }
+            updateListIndices(ObjectList);
         }
         
-        template <class T> bool removeObjectFromList(SceneNode* Object, std::vector<T*> &SearchList)
+        //! Appends the object to the list and stores its position in the object.
+        template <class T> void addObjectToList(T* Object, std::vector<T*> &ObjectList)
         {
-            if (!Object)
+            Object->SceneGraphIndex_ = ObjectList.size();
+            ObjectList.push_back(Object);
+        }
+        
+        /**
+        Removes the object from the list in constant time: the last object is moved into the gap.
+        Therefore a sorted render list (e.g. by RENDERLIST_SORT_MESHBUFFER) must be sorted again after removals.
+        If the stored position does not match (e.g. the object is hooked into several scene graphs
+        or the list has been reordered from outside) the object is searched linearly.
+        */
+        template <class T> bool removeObjectFromList(SceneNode* Object, std::vector<T*> &ObjectList)
+        {
+            if (!Object || ObjectList.empty())
                 return false;
             
-            for (typename std::vector< T*, std::allocator<T*> >::iterator it = SearchList.begin(); it != SearchList.end(); ++it)
+            u32 Index = Object->SceneGraphIndex_;
+            
+            if (Index >= ObjectList.size() || ObjectList[Index] != Object)
             {
-                if (*it == Object)
+                for (Index = 0; Index < ObjectList.size(); ++Index)
                 {
-                    SearchList.erase(it);
-                    return true;
+                    if (ObjectList[Index] == Object)
+                        break;
                 }
+                if (Index >= ObjectList.size())
+                    return false;
+            }
+            
+            if (Index + 1 < ObjectList.size())
+            {
+                ObjectList[Index] = ObjectList.back();
+                ObjectList[Index]->SceneGraphIndex_ = Index;
             }
+            ObjectList.pop_back();
             
-            return false;
+            return true;
+        }
+        
+        //! Stores the new positions in the objects after the list has been reordered.
+        template <class T> void updateListIndices(std::vector<T*> &ObjectList)
+        {
+            for (u32 i = 0, c = ObjectList.size(); i < c; ++i)
+                ObjectList[i]->SceneGraphIndex_ = i;
         }
         
         template <class T> void addChildToList(
@@ -620,8 +810,32 @@ class SP_EXPORT SceneGraph : public RenderNode
         bool DepthSorting_;
         bool LightSorting_;
         
+        bool AutoInstancing_;
+        u32 MinInstances_;
+        SInstancingStats InstancingStats_;
+        
+        bool ParallelRecording_;
+        u32 RecordingThreads_;
+        
         static bool ReverseDepthSorting_;
         
+    private:
+        
+        /* === Functions === */
+        
+        video::ShaderClass* getInstancingShaderClass(const Mesh* Object) const;
+        bool compareInstances(const Mesh* ObjA, const Mesh* ObjB) const;
+        
+        void renderInstances(const std::vector<RenderNode*> &ObjectList, u32 First, u32 Last);
+        void drawInstances(Mesh* Object, video::ShaderClass* ShdClass, const dim::matrix4f* WorldMatrices, u32 NumInstances);
+        
+        /* === Members === */
+        
+        std::vector<dim::matrix4f> InstanceMatrices_;
+        
+        std::vector<RenderNode*> RecordList_;
+        std::vector<video::RenderCommandBuffer*> CommandBuffers_;
+        
 };
 
 
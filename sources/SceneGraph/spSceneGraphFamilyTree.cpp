@@ -48,7 +48,7 @@ void SceneGraphFamilyTree::addSceneNode(SceneNode* Object)
 {
     if (Object)
     {
-        NodeList_.push_back(Object);
+        addObjectToList<SceneNode>(Object, NodeList_);
         RootNodeList_.push_back(Object);
     }
 }
@@ -57,7 +57,7 @@ void SceneGraphFamilyTree::removeSceneNode(SceneNode* Object)
     if (Object)
     {
         removeObjectFromList<SceneNode>(Object, NodeList_       );
-        removeObjectFromList<SceneNode>(Object, RootNodeList_   );
+        SceneGraphFamilyTree::removeRootNode(Object);
     }
 }
 
@@ -65,7 +65,7 @@ void SceneGraphFamilyTree::addSceneNode(Camera* Object)
 {
     if (Object)
     {
-        CameraList_.push_back(Object);
+        addObjectToList<Camera>(Object, CameraList_);
         RootNodeList_.push_back(Object);
     }
 }
@@ -74,7 +74,7 @@ void SceneGraphFamilyTree::removeSceneNode(Camera* Object)
     if (Object)
     {
         removeObjectFromList<Camera>    (Object, CameraList_    );
-        removeObjectFromList<SceneNode> (Object, RootNodeList_  );
+        SceneGraphFamilyTree::removeRootNode(Object);
     }
 }
 
@@ -82,7 +82,7 @@ void SceneGraphFamilyTree::addSceneNode(Light* Object)
 {
     if (Object)
     {
-        LightList_.push_back(Object);
+        addObjectToList<Light>(Object, LightList_);
         RootNodeList_.push_back(Object);
     }
 }
@@ -91,7 +91,7 @@ void SceneGraphFamilyTree::removeSceneNode(Light* Object)
     if (Object)
     {
         removeObjectFromList<Light>     (Object, LightList_     );
-        removeObjectFromList<SceneNode> (Object, RootNodeList_  );
+        SceneGraphFamilyTree::removeRootNode(Object);
     }
 }
 
@@ -99,7 +99,7 @@ void SceneGraphFamilyTree::addSceneNode(RenderNode* Object)
 {
     if (Object)
     {
-        RenderList_.push_back(Object);
+        addObjectToList<RenderNode>(Object, RenderList_);
         RootNodeList_.push_back(Object);
     }
 }
@@ -108,7 +108,7 @@ void SceneGraphFamilyTree::removeSceneNode(RenderNode* Object)
     if (Object)
     {
         removeObjectFromList<RenderNode>(Object, RenderList_    );
-        removeObjectFromList<SceneNode> (Object, RootNodeList_  );
+        SceneGraphFamilyTree::removeRootNode(Object);
     }
 }
 
@@ -119,7 +119,7 @@ void SceneGraphFamilyTree::addRootNode(SceneNode* Object)
 }
 void SceneGraphFamilyTree::removeRootNode(SceneNode* Object)
 {
-    removeObjectFromList<SceneNode>(Object, RootNodeList_);
+    MemoryManager::removeElement(RootNodeList_, Object);
 }
 
 void SceneGraphFamilyTree::render()
@@ -50,7 +50,11 @@ void SceneGraphSimple::render()
     /* Render geometry */
     arrangeRenderList(RenderList_, BaseMatrix);
     
-    if (DepthSorting_)
+    if (AutoInstancing_)
+        renderListInstanced(RenderList_, DepthSorting_);
+    else if (ParallelRecording_)
+        renderListRecorded(RenderList_, DepthSorting_);
+    else if (DepthSorting_)
     {
         foreach (RenderNode* Node, RenderList_)
         {
@@ -10,8 +10,15 @@
 #ifdef SP_COMPILE_WITH_SCENEGRAPH_SIMPLE_STREAM
 
 
+#include "SceneGraph/spSceneManager.hpp"
+#include "Base/spSharedObjects.hpp"
+
 #include <boost/foreach.hpp>
 
+#if defined(SP_PLATFORM_WINDOWS)
+#   include <windows.h>
+#endif
+
 
 namespace sp
 {
@@ -19,100 +26,386 @@ namespace scene
 {
 
 
+/*
+ * Internal structures
+ */
+
+enum ESceneStreamCommands
+{
+    STREAMCMD_ADD_NODE,
+    STREAMCMD_ADD_CAMERA,
+    STREAMCMD_ADD_LIGHT,
+    STREAMCMD_ADD_RENDERNODE,
+    STREAMCMD_REMOVE_NODE,
+    STREAMCMD_REMOVE_CAMERA,
+    STREAMCMD_REMOVE_LIGHT,
+    STREAMCMD_REMOVE_RENDERNODE,
+    STREAMCMD_TRANSFORM,
+};
+
+struct SSceneStreamCommand
+{
+    SSceneStreamCommand(const ESceneStreamCommands CommandType, SceneNode* CommandObject) :
+        Type    (CommandType    ),
+        Object  (CommandObject  ),
+        Next    (0              )
+    {
+    }
+    ~SSceneStreamCommand()
+    {
+    }
+    
+    /* Members */
+    ESceneStreamCommands Type;
+    SceneNode* Object;
+    Transformation Transform;   //!< Only used for STREAMCMD_TRANSFORM.
+    SSceneStreamCommand* Next;
+};
+
+
+/*
+ * Internal functions
+ */
+
+static inline SSceneStreamCommand* atomicExchange(SSceneStreamCommand* volatile* Dest, SSceneStreamCommand* Value)
+{
+    #if defined(SP_COMPILER_VC)
+    return static_cast<SSceneStreamCommand*>(
+        InterlockedExchangePointer(reinterpret_cast<PVOID volatile*>(Dest), Value)
+    );
+    #else
+    return __sync_lock_test_and_set(Dest, Value);
+    #endif
+}
+
+static inline SSceneStreamCommand* atomicCompareExchange(
+    SSceneStreamCommand* volatile* Dest, SSceneStreamCommand* Value, SSceneStreamCommand* Comparand)
+{
+    #if defined(SP_COMPILER_VC)
+    return static_cast<SSceneStreamCommand*>(
+        InterlockedCompareExchangePointer(reinterpret_cast<PVOID volatile*>(Dest), Value, Comparand)
+    );
+    #else
+    return __sync_val_compare_and_swap(Dest, Comparand, Value);
+    #endif
+}
+
+static ESceneStreamCommands getNodeCommand(const SceneNode* Object, bool isAdd)
+{
+    switch (Object->getType())
+    {
+        case NODE_CAMERA:
+            return isAdd ? STREAMCMD_ADD_CAMERA : STREAMCMD_REMOVE_CAMERA;
+        case NODE_LIGHT:
+            return isAdd ? STREAMCMD_ADD_LIGHT : STREAMCMD_REMOVE_LIGHT;
+        case NODE_MESH:
+        case NODE_BILLBOARD:
+        case NODE_TERRAIN:
+        case NODE_SCENEGRAPH:
+            return isAdd ? STREAMCMD_ADD_RENDERNODE : STREAMCMD_REMOVE_RENDERNODE;
+        default:
+            return isAdd ? STREAMCMD_ADD_NODE : STREAMCMD_REMOVE_NODE;
+    }
+}
+
+static void deleteCommands(SSceneStreamCommand* Command)
+{
+    while (Command)
+    {
+        SSceneStreamCommand* Next = Command->Next;
+        delete Command;
+        Command = Next;
+    }
+}
+
+
+/*
+ * SceneStreamDelta class
+ */
+
+SceneStreamDelta::SceneStreamDelta() :
+    First_  (0),
+    Last_   (0)
+{
+}
+SceneStreamDelta::~SceneStreamDelta()
+{
+    clear();
+}
+
+void SceneStreamDelta::addSceneNode(SceneNode* Object)
+{
+    if (Object)
+        addCommand(new SSceneStreamCommand(getNodeCommand(Object, true), Object));
+}
+void SceneStreamDelta::removeSceneNode(SceneNode* Object)
+{
+    if (Object)
+        addCommand(new SSceneStreamCommand(getNodeCommand(Object, false), Object));
+}
+
+void SceneStreamDelta::setTransformation(SceneNode* Object, const Transformation &Transform)
+{
+    if (Object)
+    {
+        SSceneStreamCommand* Command = new SSceneStreamCommand(STREAMCMD_TRANSFORM, Object);
+        Command->Transform = Transform;
+        addCommand(Command);
+    }
+}
+
+void SceneStreamDelta::clear()
+{
+    deleteCommands(First_);
+    First_  = 0;
+    Last_   = 0;
+}
+
+void SceneStreamDelta::addCommand(SSceneStreamCommand* Command)
+{
+    Command->Next = First_;
+    First_ = Command;
+    
+    if (!Last_)
+        Last_ = Command;
+}
+
+
+/*
+ * SceneGraphSimpleStream class
+ */
+
 SceneGraphSimpleStream::SceneGraphSimpleStream() :
-    SceneGraphSimple()
+    SceneGraphSimple(   ),
+    CommandStack_   (0  ),
+    PendingCommands_(0  )
 {
     GraphType_ = SCENEGRAPH_SIMPLE_STREAM;
 }
 SceneGraphSimpleStream::~SceneGraphSimpleStream()
 {
+    deleteCommands(atomicExchange(&CommandStack_, 0));
+    deleteCommands(PendingCommands_);
 }
 
-#define SEMAPHORE(l)                \
-    if (Object)                     \
-    {                               \
-        SemaphoreQueues_.lock();    \
-        l.push_back(Object);        \
-        SemaphoreQueues_.unlock();  \
+#define PUSH_COMMAND(c)                                                     \
+    if (Object)                                                             \
+    {                                                                       \
+        SSceneStreamCommand* Command = new SSceneStreamCommand(c, Object);  \
+        pushCommands(Command, Command);                                     \
     }
-
+    
 void SceneGraphSimpleStream::addSceneNode(SceneNode* Object)
 {
-    SEMAPHORE(QueueAddNodes_)
+    PUSH_COMMAND(STREAMCMD_ADD_NODE)
 }
 void SceneGraphSimpleStream::removeSceneNode(SceneNode* Object)
 {
-    SEMAPHORE(QueueRemoveNodes_)
+    PUSH_COMMAND(STREAMCMD_REMOVE_NODE)
 }
 
 void SceneGraphSimpleStream::addSceneNode(Camera* Object)
 {
-    SEMAPHORE(QueueAddCameras_)
+    PUSH_COMMAND(STREAMCMD_ADD_CAMERA)
 }
 void SceneGraphSimpleStream::removeSceneNode(Camera* Object)
 {
-    SEMAPHORE(QueueRemoveCameras_)
+    PUSH_COMMAND(STREAMCMD_REMOVE_CAMERA)
 }
 
 void SceneGraphSimpleStream::addSceneNode(Light* Object)
 {
-    SEMAPHORE(QueueAddLights_)
+    PUSH_COMMAND(STREAMCMD_ADD_LIGHT)
 }
 void SceneGraphSimpleStream::removeSceneNode(Light* Object)
 {
-    SEMAPHORE(QueueRemoveLights_)
+    PUSH_COMMAND(STREAMCMD_REMOVE_LIGHT)
 }
 
 void SceneGraphSimpleStream::addSceneNode(RenderNode* Object)
 {
-    SEMAPHORE(QueueAddRenderNodes_)
+    PUSH_COMMAND(STREAMCMD_ADD_RENDERNODE)
 }
 void SceneGraphSimpleStream::removeSceneNode(RenderNode* Object)
 {
-    SEMAPHORE(QueueRemoveRenderNodes_)
+    PUSH_COMMAND(STREAMCMD_REMOVE_RENDERNODE)
 }
 
-#undef SEMAPHORE
+#undef PUSH_COMMAND
 
-void SceneGraphSimpleStream::render()
+void SceneGraphSimpleStream::addSceneNodes(const std::vector<SceneNode*> &Objects)
 {
-    #define QUEUE_ADD(t, l, q)                      \
-        if (!q.empty())                             \
-        {                                           \
-            l.insert(l.end(), q.begin(), q.end());  \
-            q.clear();                              \
-        }
+    SceneStreamDelta Delta;
+    
+    foreach (SceneNode* Obj, Objects)
+        Delta.addSceneNode(Obj);
+    
+    commitDelta(Delta);
+}
+void SceneGraphSimpleStream::removeSceneNodes(const std::vector<SceneNode*> &Objects)
+{
+    SceneStreamDelta Delta;
     
-    #define QUEUE_REMOVE(t, l, q)                   \
-        if (!q.empty())                             \
-        {                                           \
-            foreach (t* Object, q)                  \
-                removeObjectFromList<t>(Object, l); \
-            q.clear();                              \
+    foreach (SceneNode* Obj, Objects)
+        Delta.removeSceneNode(Obj);
+    
+    commitDelta(Delta);
+}
+
+void SceneGraphSimpleStream::commitDelta(SceneStreamDelta &Delta)
+{
+    if (!Delta.empty())
+    {
+        pushCommands(Delta.First_, Delta.Last_);
+        Delta.First_    = 0;
+        Delta.Last_     = 0;
+    }
+}
+
+bool SceneGraphSimpleStream::deleteNode(SceneNode* Object)
+{
+    if (!Object)
+        return false;
+    
+    /* Drop all queued commands for this node (only the pointers are compared, the node is never accessed) */
+    takeCommands();
+    
+    SSceneStreamCommand* Prev = 0;
+    SSceneStreamCommand* Command = PendingCommands_;
+    
+    while (Command)
+    {
+        SSceneStreamCommand* Next = Command->Next;
+        
+        if (Command->Object == Object)
+        {
+            if (Prev)
+                Prev->Next = Next;
+            else
+                PendingCommands_ = Next;
+            delete Command;
         }
+        else
+            Prev = Command;
+        
+        Command = Next;
+    }
+    
+    /* Remove the node while it is still alive and delete it afterwards */
+    applyCommand(SSceneStreamCommand(getNodeCommand(Object, false), Object));
+    
+    return gSharedObjects.SceneMngr->deleteNode(Object);
+}
+
+void SceneGraphSimpleStream::render()
+{
+    /* Apply the streamed changes before the frame is rendered */
+    applyCommands();
     
     /* Render scene in default way */
     SceneGraphSimple::render();
+}
+
+
+/*
+ * ======= Protected: =======
+ */
+
+void SceneGraphSimpleStream::pushCommands(SSceneStreamCommand* First, SSceneStreamCommand* Last)
+{
+    /* Link the commands in front of the stack (the full barrier of the CAS publishes the commands) */
+    SSceneStreamCommand* Top = 0;
     
-    /* Start streaming objects */
-    SemaphoreQueues_.lock();
+    do
+    {
+        Top = CommandStack_;
+        Last->Next = Top;
+    }
+    while (atomicCompareExchange(&CommandStack_, First, Top) != Top);
+}
+
+void SceneGraphSimpleStream::takeCommands()
+{
+    /* Take all pushed commands at once */
+    SSceneStreamCommand* Command = atomicExchange(&CommandStack_, 0);
     
-    QUEUE_ADD   (SceneNode, NodeList_, QueueAddNodes_)
-    QUEUE_REMOVE(SceneNode, NodeList_, QueueRemoveNodes_)
+    if (!Command)
+        return;
     
-    QUEUE_ADD   (Light, LightList_, QueueAddLights_)
-    QUEUE_REMOVE(Light, LightList_, QueueRemoveLights_)
+    /* Reverse the stack to get the commands in the order they have been pushed */
+    SSceneStreamCommand* First = 0;
+    SSceneStreamCommand* Last = Command;
     
-    QUEUE_ADD   (Camera, CameraList_, QueueAddCameras_)
-    QUEUE_REMOVE(Camera, CameraList_, QueueRemoveCameras_)
+    while (Command)
+    {
+        SSceneStreamCommand* Next = Command->Next;
+        Command->Next = First;
+        First = Command;
+        Command = Next;
+    }
     
-    QUEUE_ADD   (RenderNode, RenderList_, QueueAddRenderNodes_)
-    QUEUE_REMOVE(RenderNode, RenderList_, QueueRemoveRenderNodes_)
+    /* Append them to the commands which have been taken before */
+    if (PendingCommands_)
+    {
+        SSceneStreamCommand* Tail = PendingCommands_;
+        while (Tail->Next)
+            Tail = Tail->Next;
+        Tail->Next = First;
+    }
+    else
+        PendingCommands_ = First;
     
-    SemaphoreQueues_.unlock();
+    Last->Next = 0;
+}
+
+void SceneGraphSimpleStream::applyCommands()
+{
+    takeCommands();
     
-    #undef QUEUE_ADD
-    #undef QUEUE_REMOVE
+    /* Apply the commands */
+    for (SSceneStreamCommand* Command = PendingCommands_; Command; Command = Command->Next)
+        applyCommand(*Command);
+    
+    deleteCommands(PendingCommands_);
+    PendingCommands_ = 0;
+}
+
+void SceneGraphSimpleStream::applyCommand(const SSceneStreamCommand &Command)
+{
+    SceneNode* Object = Command.Object;
+    
+    switch (Command.Type)
+    {
+        case STREAMCMD_ADD_NODE:
+            addObjectToList<SceneNode>(Object, NodeList_);
+            break;
+        case STREAMCMD_ADD_CAMERA:
+            addObjectToList<Camera>(static_cast<Camera*>(Object), CameraList_);
+            break;
+        case STREAMCMD_ADD_LIGHT:
+            addObjectToList<Light>(static_cast<Light*>(Object), LightList_);
+            break;
+        case STREAMCMD_ADD_RENDERNODE:
+            addObjectToList<RenderNode>(static_cast<RenderNode*>(Object), RenderList_);
+            break;
+            
+        case STREAMCMD_REMOVE_NODE:
+            removeObjectFromList<SceneNode>(Object, NodeList_);
+            break;
+        case STREAMCMD_REMOVE_CAMERA:
+            removeObjectFromList<Camera>(Object, CameraList_);
+            break;
+        case STREAMCMD_REMOVE_LIGHT:
+            removeObjectFromList<Light>(Object, LightList_);
+            break;
+        case STREAMCMD_REMOVE_RENDERNODE:
+            removeObjectFromList<RenderNode>(Object, RenderList_);
+            break;
+            
+        case STREAMCMD_TRANSFORM:
+            Object->setTransformation(Command.Transform);
+            break;
+    }
 }
 
 
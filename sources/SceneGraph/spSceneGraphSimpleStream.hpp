@@ -23,11 +23,69 @@ namespace scene
 {
 
 
+struct SSceneStreamCommand;
+
+/**
+Scene delta for the streaming scene graph. A loader thread prepares all changes for one batch
+(nodes to add or remove and new transformations) and commits them with "SceneGraphSimpleStream::commitDelta".
+The render thread then applies the whole delta at once at the beginning of the next frame.
+A delta object must only be used by one thread at a time.
+\see SceneGraphSimpleStream
+\since Version 3.3
+*/
+class SP_EXPORT SceneStreamDelta
+{
+    
+    public:
+        
+        SceneStreamDelta();
+        ~SceneStreamDelta();
+        
+        /* === Functions === */
+        
+        //! Adds the node to the list of its type (see "SceneGraph::addSceneNodes").
+        void addSceneNode(SceneNode* Object);
+        //! Removes the node from the list of its type.
+        void removeSceneNode(SceneNode* Object);
+        
+        //! Sets the node's transformation when the delta is applied.
+        void setTransformation(SceneNode* Object, const Transformation &Transform);
+        
+        //! Discards all changes which have not been committed yet.
+        void clear();
+        
+        /* === Inline functions === */
+        
+        //! Returns true if the delta contains no changes.
+        inline bool empty() const
+        {
+            return First_ == 0;
+        }
+        
+    private:
+        
+        friend class SceneGraphSimpleStream;
+        
+        /* === Functions === */
+        
+        void addCommand(SSceneStreamCommand* Command);
+        
+        /* === Members === */
+        
+        /* The commands are linked in reverse order (the newest first) like in the stream's stack */
+        SSceneStreamCommand* First_;
+        SSceneStreamCommand* Last_;
+        
+};
+
+
 /**
 This is thread-safe version of the default simple scene graph (SceneGraphSimple).
-When new objects are hooked into the scene graph they will be streamed.
-i.e. only when the render loop is over the new objects will be added to the root list
-and the queue will be cleared.
+When new objects are hooked into the scene graph they will be streamed, i.e. any thread can add or remove nodes,
+but the changes are applied by the render thread at the beginning of the next "render" call.
+The changes are pushed into a lock-free queue (a single compare-and-swap per change or per committed delta),
+so loader threads never wait for the renderer and the render thread takes no locks at all.
+All changes are applied in the order in which they have been pushed.
 \note Here you have to use only the second "renderScene" function which expects a Camera object.
 \ingroup group_scenegraph
 \since Version 3.0
@@ -52,23 +110,44 @@ class SP_EXPORT SceneGraphSimpleStream : public SceneGraphSimple
         void removeSceneNode(Light*         Object);
         void removeSceneNode(RenderNode*    Object);
         
+        //! Queues all specified nodes for adding. They will be applied together in the same frame.
+        void addSceneNodes(const std::vector<SceneNode*> &Objects);
+        //! Queues all specified nodes for removal. They will be applied together in the same frame.
+        void removeSceneNodes(const std::vector<SceneNode*> &Objects);
+        
+        /**
+        Commits the specified delta. All its changes become visible to the render thread at once
+        and are applied at the beginning of the next "render" call. This can be called from any thread.
+        Afterwards the delta is empty and can be reused.
+        \since Version 3.3
+        */
+        void commitDelta(SceneStreamDelta &Delta);
+        
+        /**
+        Removes the node from the scene graph immediately and deletes it. All queued commands for this node are dropped,
+        so they will never access the deleted node. This must be called on the render thread and
+        the node must no longer be used by any other thread.
+        */
+        bool deleteNode(SceneNode* Object);
+        
         virtual void render();
         
     protected:
         
-        /* Members */
+        /* Functions */
+        
+        void pushCommands(SSceneStreamCommand* First, SSceneStreamCommand* Last);
+        void takeCommands();
+        void applyCommands();
+        void applyCommand(const SSceneStreamCommand &Command);
         
-        std::list<SceneNode*>   QueueAddNodes_;
-        std::list<Light*>       QueueAddLights_;
-        std::list<Camera*>      QueueAddCameras_;
-        std::list<RenderNode*>  QueueAddRenderNodes_;
+        /* Members */
         
-        std::list<SceneNode*>   QueueRemoveNodes_;
-        std::list<Light*>       QueueRemoveLights_;
-        std::list<Camera*>      QueueRemoveCameras_;
-        std::list<RenderNode*>  QueueRemoveRenderNodes_;
+        //! Pushed commands (the newest first). Only accessed with atomic operations.
+        SSceneStreamCommand* volatile CommandStack_;
         
-        CriticalSection SemaphoreQueues_;
+        //! Taken commands in push order which have not been applied yet. Only accessed by the render thread.
+        SSceneStreamCommand* PendingCommands_;
         
 };
 
@@ -9,11 +9,15 @@
 #include "SceneGraph/spSceneMesh.hpp"
 #include "SceneGraph/spSceneBillboard.hpp"
 #include "SceneGraph/spSceneTerrain.hpp"
+#include "SceneGraph/spSceneStreamedTerrain.hpp"
 #include "SceneGraph/spSceneLight.hpp"
 #include "SceneGraph/spSceneCamera.hpp"
+#include "SceneGraph/spAsyncMeshLoader.hpp"
 #include "Base/spSharedObjects.hpp"
 #include "Base/spBaseExceptions.hpp"
 #include "Base/spBasicMeshGenerator.hpp"
+#include "Base/spMeshBufferOptimizer.hpp"
+#include "Base/spProfiler.hpp"
 #include "FileFormats/Mesh/spMeshFileFormats.hpp"
 #include "RenderSystem/spRenderSystem.hpp"
 
@@ -34,11 +38,15 @@ video::ERendererDataTypes SceneManager::DefaultIndexFormat_ = video::DATATYPE_UN
 
 bool SceneManager::TextureLoadingState_ = true;
 
-SceneManager::SceneManager()
+SceneManager::SceneManager() :
+    AsyncMeshLoader_(0)
 {
 }
 SceneManager::~SceneManager()
 {
+    /* Stop the mesh loader threads before the scene is cleared */
+    MemoryManager::deleteMemory(AsyncMeshLoader_);
+    
     /* Delete all animations and scene nodes */
     clearAnimations();
     clearScene();
@@ -49,7 +57,7 @@ SceneManager::~SceneManager()
 Mesh* SceneManager::createMesh()
 {
     Mesh* NewMesh = MemoryManager::createMemory<Mesh>("scene::Mesh (Empty)");
-    MeshList_.push_back(NewMesh);
+    addMeshToList(NewMesh);
     return NewMesh;
 }
 
@@ -227,9 +235,18 @@ Mesh* SceneManager::createMeshSurface(Mesh* Model, u32 Surface)
     return NewMesh;
 }
 
+AsyncMeshLoader* SceneManager::getAsyncMeshLoader()
+{
+    if (!AsyncMeshLoader_)
+        AsyncMeshLoader_ = MemoryManager::createMemory<AsyncMeshLoader>("scene::AsyncMeshLoader");
+    return AsyncMeshLoader_;
+}
+
 Mesh* SceneManager::loadMesh(
     io::stringc Filename, io::stringc TexturePath, const EMeshFileFormats Format, const s32 Flags)
 {
+    SP_PROFILE_SCOPE("SceneManager::loadMesh");
+    
     /* Information message */
     io::Log::message("Load mesh: \"" + Filename + "\"");
     io::Log::ScopedTab UnusedTab;
@@ -298,7 +315,25 @@ Mesh* SceneManager::loadMesh(
     Mesh* NewMesh = Loader->loadMesh(Filename, TexturePath, Flags);
     
     if (NewMesh)
-        MeshList_.push_back(NewMesh);
+    {
+        addMeshToList(NewMesh);
+        
+        /* Optimize the mesh buffers for the vertex cache */
+        if (Flags & MESHFLAG_OPTIMIZE_VERTEX_CACHE)
+        {
+            std::vector<video::MeshBuffer*> Surfaces;
+            bool hasAnimations = false;
+            
+            collectUniqueMeshBuffers(NewMesh, Surfaces, hasAnimations);
+            
+            /* Animations refer to the vertex indices, so the vertex order must be kept */
+            s32 OptFlags = video::MESHOPTIMIZE_ALL;
+            if (hasAnimations)
+                OptFlags &= ~video::MESHOPTIMIZE_VERTEX_FETCH;
+            
+            video::MeshBufferOptimizer::optimizeMeshBuffers(Surfaces, OptFlags);
+        }
+    }
     
     /* Delete the temporary mesh loader */
     delete Loader;
@@ -558,6 +593,20 @@ Terrain* SceneManager::createTerrain(
     return NewTerrain;
 }
 
+StreamedTerrain* SceneManager::createStreamedTerrain(const SStreamedTerrainDesc &Desc)
+{
+    StreamedTerrain* NewTerrain = new StreamedTerrain();
+    
+    if (!NewTerrain->open(Desc))
+    {
+        delete NewTerrain;
+        return 0;
+    }
+    
+    TerrainList_.push_back(NewTerrain);
+    return NewTerrain;
+}
+
 /* === Animations: === */
 
 void SceneManager::deleteAnimation(Animation* Anim)
@@ -567,6 +616,8 @@ void SceneManager::deleteAnimation(Animation* Anim)
 
 void SceneManager::updateAnimations()
 {
+    SP_PROFILE_SCOPE("SceneManager::updateAnimations");
+    
     foreach (Animation* Anim, AnimationList_)
     {
         if (Anim->playing())
@@ -863,6 +914,46 @@ ESceneFileFormats SceneManager::getSceneFileFormat(
 }
 
 
+/*
+ * ======= Private: =======
+ */
+
+void SceneManager::addMeshToList(Mesh* Object)
+{
+    /* Meshes which are loaded by the asynchronous mesh loader are registered when their request has been finished */
+    if (!AsyncMeshLoader::deferMesh(Object))
+        MeshList_.push_back(Object);
+}
+
+void SceneManager::addAnimationToList(Animation* Anim)
+{
+    if (!AsyncMeshLoader::deferAnimation(Anim))
+        AnimationList_.push_back(Anim);
+}
+
+void SceneManager::collectUniqueMeshBuffers(Mesh* Model, std::vector<video::MeshBuffer*> &Surfaces, bool &hasAnimations)
+{
+    if (Model->getAnimationCount() > 0)
+        hasAnimations = true;
+    
+    /* Only collect the referenced mesh buffers, because the references share their vertex and index data */
+    foreach (video::MeshBuffer* Surface, Model->getReference()->getMeshBufferList())
+    {
+        video::MeshBuffer* RefSurface = Surface->getReference();
+        
+        if (std::find(Surfaces.begin(), Surfaces.end(), RefSurface) == Surfaces.end())
+            Surfaces.push_back(RefSurface);
+    }
+    
+    /* Collect the mesh buffers of the child meshes, e.g. of fragmented models */
+    foreach (SceneNode* Child, Model->getSceneChildren())
+    {
+        if (Child->getType() == NODE_MESH)
+            collectUniqueMeshBuffers(static_cast<Mesh*>(Child), Surfaces, hasAnimations);
+    }
+}
+
+
 } // /namespace scene
 
 } // /namespace sp
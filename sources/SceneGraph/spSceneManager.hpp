@@ -15,10 +15,14 @@
 #include "SceneGraph/spSceneLight.hpp"
 
 #include <list>
+#include <vector>
 
 
 namespace sp
 {
+
+class SoftPixelDevice;
+
 namespace scene
 {
 
@@ -26,7 +30,10 @@ namespace scene
 class Mesh;
 class Billboard;
 class Terrain;
+class StreamedTerrain;
+struct SStreamedTerrainDesc;
 class Camera;
+class AsyncMeshLoader;
 
 
 /**
@@ -89,6 +96,13 @@ class SP_EXPORT SceneManager
         //! Creates a mesh out of the specified mesh's surface.
         Mesh* createMeshSurface(Mesh* Model, u32 Surface);
         
+        /**
+        Returns the asynchronous mesh loader. It will be created with the first call.
+        \see SceneGraph::loadMeshAsync
+        \since Version 3.3
+        */
+        AsyncMeshLoader* getAsyncMeshLoader();
+        
         /**
         Loads a 3D model from file. The supported file formats are listed in the "EModelTypes" enumeration
         and at the "SoftPixel Engine"'s homepage under "features".
@@ -194,6 +208,13 @@ class SP_EXPORT SceneManager
             const video::SHeightMapTexture &TextureHeightMap, const dim::size2di &Resolution, s32 GeoMIPLevels = DEF_GEOMIP_LEVELS
         );
         
+        /**
+        Creates a streamed terrain. Use this for height fields which are too large to be hold in memory.
+        \return Pointer to the new StreamedTerrain object or null if the height field could not be opened.
+        \see StreamedTerrain
+        */
+        StreamedTerrain* createStreamedTerrain(const SStreamedTerrainDesc &Desc);
+        
         /**
         Copies the specified scene node and returns a pointer to the new
         object or a null pointer if the template object was specified as a null pointer.
@@ -290,7 +311,7 @@ class SP_EXPORT SceneManager
         {
             T* NewAnim = MemoryManager::createMemory<T>(Name.size() ? Name : "Animation");
             NewAnim->setName(Name);
-            AnimationList_.push_back(NewAnim);
+            addAnimationToList(NewAnim);
             return NewAnim;
         }
         
@@ -357,6 +378,16 @@ class SP_EXPORT SceneManager
         
     private:
         
+        friend class AsyncMeshLoader;
+        friend class sp::SoftPixelDevice;
+        
+        /* === Functions === */
+        
+        void addMeshToList(Mesh* Object);
+        void addAnimationToList(Animation* Anim);
+        
+        static void collectUniqueMeshBuffers(Mesh* Model, std::vector<video::MeshBuffer*> &Surfaces, bool &hasAnimations);
+        
         /* === Templates === */
         
         template <class T> void addChildToList(
@@ -433,6 +464,8 @@ class SP_EXPORT SceneManager
         
         std::map<std::string, Mesh*> MeshMap_;
         
+        AsyncMeshLoader* AsyncMeshLoader_;
+        
         static const video::VertexFormat* DefaultVertexFormat_;
         static video::ERendererDataTypes DefaultIndexFormat_;
         
@@ -7,6 +7,7 @@
 
 #include "SceneGraph/spSceneGraph.hpp"
 #include "SceneGraph/spMeshModifier.hpp"
+#include "RenderSystem/spRenderCommandBuffer.hpp"
 #include "Platform/spSoftPixelDeviceOS.hpp"
 
 #include <boost/foreach.hpp>
@@ -87,6 +88,17 @@ bool Mesh::compareMeshBuffers(const Mesh* Other) const
     if (Order_ != Other->Order_)
         return Order_ > Other->Order_;
     
+    /* Compare shader classes (to keep instances together for the automatic instancing) */
+    if (ShaderClass_ != Other->ShaderClass_)
+        return reinterpret_cast<long>(ShaderClass_) > reinterpret_cast<long>(Other->ShaderClass_);
+    
+    /* Compare mesh buffer references (meshes with equal mesh buffer references can be drawn instanced) */
+    const video::MeshBuffer* Reference = (!SurfaceList_->empty() ? SurfaceList_->front()->getReference() : 0);
+    const video::MeshBuffer* OtherReference = (!Other->SurfaceList_->empty() ? Other->SurfaceList_->front()->getReference() : 0);
+    
+    if (Reference != OtherReference)
+        return reinterpret_cast<long>(Reference) > reinterpret_cast<long>(OtherReference);
+    
     /* Compare mesh buffers */
     if (SurfaceList_ != Other->SurfaceList_)
         return reinterpret_cast<long>(SurfaceList_) > reinterpret_cast<long>(Other->SurfaceList_);
@@ -844,6 +856,37 @@ void Mesh::render()
     GlbRenderSys->unbindShaders();
 }
 
+void Mesh::recordRender(video::RenderCommandBuffer &CmdBuffer)
+{
+    /* Check if the entity has any surfaces */
+    if (LODSurfaceList_->empty())
+        return;
+    
+    /* Nodes with callbacks, LOD or a parent transformation are rendered as usual on submission */
+    if ( UseLODSubMeshes_ || UserRenderProc_ || Material_.getMaterialCallback() ||
+         !GlbSceneGraph || GlbSceneGraph->hasChildTree() )
+    {
+        CmdBuffer.renderNode(this);
+        return;
+    }
+    
+    /* Frustum culling */
+    const Camera* ActiveCamera = GlbSceneGraph->getActiveCamera();
+    
+    if (ActiveCamera && !BoundVolume_.checkFrustumCulling(ActiveCamera->getViewFrustum(), FinalWorldMatrix_))
+        return;
+    
+    /* Record the render commands in the same order as "render" */
+    CmdBuffer.setWorldMatrix(FinalWorldMatrix_);
+    CmdBuffer.setupMaterialStates(getMaterial());
+    CmdBuffer.setupShaderClass(this, getShaderClass());
+    
+    foreach (video::MeshBuffer* Surface, *LODSurfaceList_)
+        CmdBuffer.drawMeshBuffer(Surface);
+    
+    CmdBuffer.unbindShaders();
+}
+
 
 /*
  * ======= Private: =======
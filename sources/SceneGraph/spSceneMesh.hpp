@@ -335,6 +335,14 @@ class SP_EXPORT Mesh : public MaterialNode
         */
         virtual void render();
         
+        /**
+        Records the rendering of this mesh into the specified command buffer. The frustum culling is done while recording.
+        Meshes with LOD sub meshes, a render callback or a material callback are recorded with "RenderCommandBuffer::renderNode".
+        \see RenderNode::recordRender
+        \since Version 3.3
+        */
+        virtual void recordRender(video::RenderCommandBuffer &CmdBuffer);
+        
         /* === Inline functions === */
         
         //! Returns the specified video::MeshBuffer object.
@@ -30,9 +30,10 @@ dim::matrix4f spTextureMatrix[MAX_COUNT_OF_TEXTURES];
 
 
 SceneNode::SceneNode(const ENodeTypes Type) :
-    Node        (       ),
-    SceneParent_(0      ),
-    Type_       (Type   )
+    Node            (       ),
+    SceneParent_    (0      ),
+    Type_           (Type   ),
+    SceneGraphIndex_(0      )
 {
 }
 SceneNode::~SceneNode()
@@ -366,6 +366,7 @@ class SP_EXPORT SceneNode : public Node
     protected:
         
         friend class Animation;
+        friend class SceneGraph;
         
         /* === Functions === */
         
@@ -390,6 +391,8 @@ class SP_EXPORT SceneNode : public Node
         
         ENodeTypes Type_;
         
+        u32 SceneGraphIndex_; //!< Position in the scene graph's node list. Used for O(1) removal.
+        
 };
 
 
@@ -0,0 +1,431 @@
+/*
+ * Static geometry file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "SceneGraph/spSceneStaticGeometry.hpp"
+#include "SceneGraph/spSceneMesh.hpp"
+#include "SceneGraph/spSceneGraph.hpp"
+#include "RenderSystem/spRenderSystem.hpp"
+#include "RenderSystem/spTextureLayerStandard.hpp"
+#include "Base/spMemoryManagement.hpp"
+
+#include <boost/foreach.hpp>
+#include <algorithm>
+
+
+namespace sp
+{
+
+extern video::RenderSystem* GlbRenderSys;
+extern scene::SceneGraph* GlbSceneGraph;
+
+namespace scene
+{
+
+
+StaticGeometry::StaticGeometry(u32 PageSize) :
+    RenderNode      (NODE_CUSTOM                ),
+    PageSize_       (math::Max(PageSize, 3u)    ),
+    NumDrawCalls_   (0                          ),
+    NumDrawnRanges_ (0                          )
+{
+}
+StaticGeometry::~StaticGeometry()
+{
+    clearMeshes();
+}
+
+void StaticGeometry::render()
+{
+    NumDrawCalls_   = 0;
+    NumDrawnRanges_ = 0;
+    
+    if (!GlbSceneGraph || !GlbSceneGraph->getActiveCamera())
+        return;
+    
+    /* The pages are stored in world space */
+    GlbRenderSys->setWorldMatrix(dim::matrix4f::IDENTITY);
+    GlbRenderSys->updateModelviewMatrix();
+    
+    const ViewFrustum &Frustum = GlbSceneGraph->getActiveCamera()->getViewFrustum();
+    
+    foreach (SPage* Page, Pages_)
+        drawPage(Page, Frustum);
+}
+
+bool StaticGeometry::addMesh(Mesh* Object)
+{
+    if (!Object || hasMesh(Object))
+        return false;
+    
+    /* Check if all surfaces can be batched */
+    const u32 NumSurfaces = Object->getMeshBufferCount();
+    
+    if (!NumSurfaces)
+        return false;
+    
+    for (u32 i = 0; i < NumSurfaces; ++i)
+    {
+        if (!isSurfaceBatchable(Object->getMeshBuffer(i)))
+            return false;
+    }
+    
+    /* Store the static object data */
+    SObject* NewObject = new SObject();
+    {
+        NewObject->Object       = Object;
+        NewObject->isVisible    = Object->getVisible();
+        NewObject->Transform    = Object->getTransformMatrix(true);
+        NewObject->BoundVolume  = Object->getBoundingVolume();
+    }
+    Objects_[Object] = NewObject;
+    
+    /* Append each surface to a page with the same material */
+    for (u32 i = 0; i < NumSurfaces; ++i)
+    {
+        const video::MeshBuffer* Surface = Object->getMeshBuffer(i);
+        const u32 NumVertices = StaticGeometry::getTriangleVertexCount(Surface);
+        
+        SPage* Page = findPage(Object, Surface, NumVertices);
+        
+        if (!Page)
+            Page = createPage(Object, Surface);
+        
+        insertSurface(Page, NewObject, Surface, NumVertices);
+    }
+    
+    /* The batch renders the object from now on */
+    Object->setVisible(false);
+    
+    return true;
+}
+
+bool StaticGeometry::removeMesh(Mesh* Object)
+{
+    std::map<const Mesh*, SObject*>::iterator it = Objects_.find(Object);
+    
+    if (it == Objects_.end())
+        return false;
+    
+    SObject* OldObject = it->second;
+    
+    /* Remove the vertex ranges only from the pages which contain this object */
+    foreach (SPage* Page, OldObject->Pages)
+    {
+        removeRanges(Page, OldObject);
+        
+        if (Page->Ranges.empty())
+            deletePage(Page);
+    }
+    
+    Object->setVisible(OldObject->isVisible);
+    
+    delete OldObject;
+    Objects_.erase(it);
+    
+    return true;
+}
+
+void StaticGeometry::clearMeshes()
+{
+    /* Restore the visibility of all objects */
+    for (std::map<const Mesh*, SObject*>::iterator it = Objects_.begin(); it != Objects_.end(); ++it)
+    {
+        it->second->Object->setVisible(it->second->isVisible);
+        delete it->second;
+    }
+    Objects_.clear();
+    
+    MemoryManager::deleteList(Pages_);
+}
+
+bool StaticGeometry::hasMesh(const Mesh* Object) const
+{
+    return Objects_.find(Object) != Objects_.end();
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+StaticGeometry::SPage::SPage(const video::VertexFormat* Format) :
+    Surface     (Format ),
+    ShdClass    (0      ),
+    isModified  (false  ),
+    isResized   (false  ),
+    DirtyOffset (~0u    )
+{
+    /* Pages are drawn in parts, so the triangles are stored as plain vertex array */
+    Surface.setIndexBufferEnable(false);
+    Surface.createMeshBuffer();
+}
+StaticGeometry::SPage::~SPage()
+{
+}
+
+bool StaticGeometry::isSurfaceBatchable(const video::MeshBuffer* Surface) const
+{
+    const video::MeshBuffer* Reference = Surface->getReference();
+    
+    if (Reference->getPrimitiveType() != video::PRIMITIVE_TRIANGLES || Reference->getHardwareInstancing() > 1)
+        return false;
+    if (!StaticGeometry::getTriangleVertexCount(Surface))
+        return false;
+    
+    /* Only the pre-defined texture layers without extra parameters can be copied into the pages */
+    foreach (const video::TextureLayer* TexLayer, Surface->getTextureLayerList())
+    {
+        if (TexLayer->getType() != video::TEXLAYER_BASE && TexLayer->getType() != video::TEXLAYER_STANDARD)
+            return false;
+    }
+    
+    return true;
+}
+
+StaticGeometry::SPage* StaticGeometry::findPage(const Mesh* Object, const video::MeshBuffer* Surface, u32 NumVertices)
+{
+    const video::VertexFormat* Format = Surface->getReference()->getVertexFormat();
+    
+    foreach (SPage* Page, Pages_)
+    {
+        /* Check if the page has enough space left */
+        if (Page->Surface.getVertexCount() + NumVertices > PageSize_)
+            continue;
+        
+        /* Compare vertex format, shader class, textures and material states */
+        if ( Page->Surface.getVertexFormat() == Format && Page->ShdClass == Object->getShaderClass() &&
+             StaticGeometry::compareTextureLayers(&Page->Surface, Surface) && Page->Material.compare(Object->getMaterial()) )
+        {
+            return Page;
+        }
+    }
+    
+    return 0;
+}
+
+StaticGeometry::SPage* StaticGeometry::createPage(const Mesh* Object, const video::MeshBuffer* Surface)
+{
+    SPage* NewPage = new SPage(Surface->getReference()->getVertexFormat());
+    
+    /* Copy material states and shader class */
+    NewPage->Material.copy(Object->getMaterial());
+    NewPage->ShdClass = Object->getShaderClass();
+    
+    /* Copy texture layers (the source surface may be deleted before the page) */
+    foreach (const video::TextureLayer* TexLayer, Surface->getTextureLayerList())
+    {
+        video::TextureLayer* NewTexLayer = NewPage->Surface.addTexture(
+            TexLayer->getTexture(), TexLayer->getIndex(), TexLayer->getType()
+        );
+        
+        if (TexLayer->getType() == video::TEXLAYER_STANDARD)
+        {
+            const video::TextureLayerStandard* SrcLayer = static_cast<const video::TextureLayerStandard*>(TexLayer);
+            video::TextureLayerStandard* DestLayer = static_cast<video::TextureLayerStandard*>(NewTexLayer);
+            
+            DestLayer->setMatrix(SrcLayer->getMatrix());
+            DestLayer->setTextureEnv(SrcLayer->getTextureEnv());
+            DestLayer->setMappingGen(SrcLayer->getMappingGen(), false);
+            DestLayer->setMappingGenCoords(SrcLayer->getMappingGenCoords());
+        }
+    }
+    
+    Pages_.push_back(NewPage);
+    
+    return NewPage;
+}
+
+void StaticGeometry::insertSurface(SPage* Page, SObject* Object, const video::MeshBuffer* Surface, u32 NumVertices)
+{
+    const video::MeshBuffer* Reference = Surface->getReference();
+    
+    video::MeshBuffer& Dest = Page->Surface;
+    
+    /* Append the vertex range at the end of the page */
+    SRange Range;
+    {
+        Range.Object        = Object;
+        Range.StartOffset   = Dest.getVertexCount();
+        Range.NumVertices   = NumVertices;
+    }
+    Dest.addVertices(NumVertices);
+    
+    /* Copy the triangle vertices in the order of the indices */
+    const dim::UniversalBuffer& SrcVertices = Reference->getVertexBuffer();
+    dim::UniversalBuffer& DestVertices = Dest.getVertexBuffer();
+    
+    const u32 Stride = DestVertices.getStride();
+    
+    for (u32 i = 0; i < NumVertices; ++i)
+    {
+        const u32 SrcIndex = (Reference->getIndexBufferEnable() ? Reference->getPrimitiveIndex(i) : i);
+        DestVertices.setBuffer(Range.StartOffset + i, 0, SrcVertices.getArray(SrcIndex, 0), Stride);
+    }
+    
+    /*
+    Transform the vertices into world space. Normals use the inverse-transpose matrix to stay perpendicular
+    to the surface under non-uniform scaling, tangents and binormals lie in the surface and use the world matrix.
+    */
+    const dim::matrix4f NormalMatrix(Object->Transform.getInverse().getTransposed());
+    const s32 Flags = Dest.getVertexFormat()->getFlags();
+    
+    for (u32 i = Range.StartOffset, n = Range.StartOffset + NumVertices; i < n; ++i)
+    {
+        Dest.setVertexCoord(i, Object->Transform * Dest.getVertexCoord(i));
+        
+        if (Flags & video::VERTEXFORMAT_NORMAL)
+            Dest.setVertexNormal(i, NormalMatrix.vecRotate(Dest.getVertexNormal(i)).normalize());
+        if (Flags & video::VERTEXFORMAT_TANGENT)
+            Dest.setVertexTangent(i, Object->Transform.vecRotate(Dest.getVertexTangent(i)).normalize());
+        if (Flags & video::VERTEXFORMAT_BINORMAL)
+            Dest.setVertexBinormal(i, Object->Transform.vecRotate(Dest.getVertexBinormal(i)).normalize());
+    }
+    
+    Page->Ranges.push_back(Range);
+    Page->isModified = true;
+    Page->isResized = true;
+    
+    if (std::find(Object->Pages.begin(), Object->Pages.end(), Page) == Object->Pages.end())
+        Object->Pages.push_back(Page);
+}
+
+void StaticGeometry::removeRanges(SPage* Page, const SObject* Object)
+{
+    dim::UniversalBuffer& Vertices = Page->Surface.getVertexBuffer();
+    
+    u32 NumRemovedVertices = 0;
+    
+    /* Remove the ranges of the object and move the following ranges to close the gaps */
+    for (std::vector<SRange>::iterator it = Page->Ranges.begin(); it != Page->Ranges.end();)
+    {
+        if (it->Object == Object)
+        {
+            /* All vertices behind the first removed range are moved */
+            if (!NumRemovedVertices)
+                Page->DirtyOffset = math::Min(Page->DirtyOffset, it->StartOffset);
+            
+            Vertices.removeBuffer(it->StartOffset - NumRemovedVertices, 0, it->NumVertices * Vertices.getStride());
+            NumRemovedVertices += it->NumVertices;
+            it = Page->Ranges.erase(it);
+        }
+        else
+        {
+            it->StartOffset -= NumRemovedVertices;
+            ++it;
+        }
+    }
+    
+    Page->isModified = true;
+}
+
+void StaticGeometry::deletePage(SPage* Page)
+{
+    MemoryManager::removeElement(Pages_, Page, true);
+}
+
+void StaticGeometry::drawPage(SPage* Page, const ViewFrustum &Frustum)
+{
+    /* Upload the page once after all modifications of the last frame (only the moved vertices after removals) */
+    if (Page->isModified)
+    {
+        const u32 NumVertices = Page->Surface.getVertexCount();
+        
+        if (Page->isResized)
+            Page->Surface.updateVertexBuffer();
+        else if (Page->DirtyOffset < NumVertices)
+            Page->Surface.updateVertexBufferRange(Page->DirtyOffset, NumVertices - Page->DirtyOffset);
+        
+        Page->isModified    = false;
+        Page->isResized     = false;
+        Page->DirtyOffset   = ~0u;
+    }
+    
+    /* Build the compacted draw list: adjacent visible ranges are merged into one draw call */
+    DrawList_.clear();
+    
+    const Mesh* FirstObject = 0;
+    
+    foreach (const SRange &Range, Page->Ranges)
+    {
+        if (!Range.Object->BoundVolume.checkFrustumCulling(Frustum, Range.Object->Transform))
+            continue;
+        
+        if (!FirstObject)
+            FirstObject = Range.Object->Object;
+        
+        if (!DrawList_.empty() && DrawList_.back().StartOffset + DrawList_.back().NumVertices == Range.StartOffset)
+            DrawList_.back().NumVertices += Range.NumVertices;
+        else
+        {
+            SDrawRange DrawRange;
+            {
+                DrawRange.StartOffset = Range.StartOffset;
+                DrawRange.NumVertices = Range.NumVertices;
+            }
+            DrawList_.push_back(DrawRange);
+        }
+        
+        ++NumDrawnRanges_;
+    }
+    
+    if (DrawList_.empty())
+        return;
+    
+    /* Setup material states and draw the visible parts of the page */
+    GlbRenderSys->setupMaterialStates(&Page->Material);
+    GlbRenderSys->setupShaderClass(FirstObject, Page->ShdClass);
+    
+    if (GlbRenderSys->bindMeshBuffer(&Page->Surface))
+    {
+        foreach (const SDrawRange &DrawRange, DrawList_)
+            GlbRenderSys->drawMeshBufferPart(&Page->Surface, DrawRange.StartOffset, DrawRange.NumVertices);
+        
+        GlbRenderSys->unbindMeshBuffer();
+        
+        NumDrawCalls_ += DrawList_.size();
+    }
+    
+    GlbRenderSys->unbindShaders();
+}
+
+u32 StaticGeometry::getTriangleVertexCount(const video::MeshBuffer* Surface)
+{
+    const video::MeshBuffer* Reference = Surface->getReference();
+    
+    const u32 Count = (Reference->getIndexBufferEnable() ? Reference->getIndexCount() : Reference->getVertexCount());
+    
+    return Count - Count % 3;
+}
+
+bool StaticGeometry::compareTextureLayers(const video::MeshBuffer* Surface, const video::MeshBuffer* Other)
+{
+    const video::TextureLayerListType& LayersA = Surface->getTextureLayerList();
+    const video::TextureLayerListType& LayersB = Other->getTextureLayerList();
+    
+    if (LayersA.size() != LayersB.size())
+        return false;
+    
+    for (u32 i = 0; i < LayersA.size(); ++i)
+    {
+        if ( LayersA[i]->getIndex() != LayersB[i]->getIndex() || LayersA[i]->getType() != LayersB[i]->getType() ||
+             !LayersA[i]->compare(LayersB[i]) )
+        {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+
+} // /namespace scene
+
+} // /namespace sp
+
+
+
+// ================================================================================
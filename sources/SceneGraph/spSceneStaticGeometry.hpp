@@ -0,0 +1,203 @@
+/*
+ * Static geometry header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_SCENE_STATIC_GEOMETRY_H__
+#define __SP_SCENE_STATIC_GEOMETRY_H__
+
+
+#include "Base/spStandard.hpp"
+#include "Base/spMeshBuffer.hpp"
+#include "Base/spMaterialStates.hpp"
+#include "SceneGraph/spRenderNode.hpp"
+#include "SceneGraph/spBoundingVolume.hpp"
+
+#include <vector>
+#include <map>
+
+
+namespace sp
+{
+namespace video
+{
+    class ShaderClass;
+}
+namespace scene
+{
+
+
+class Mesh;
+
+/**
+StaticGeometry batches static meshes into large shared vertex buffers ("pages") to reduce the count of draw calls.
+All surfaces with the same material states, shader class, vertex format and textures are packed into the same page
+in world space. Each mesh keeps its own vertex range and bounding volume, so the meshes are still frustum culled
+one by one: every frame the ranges of the visible meshes are collected into a compacted draw list,
+in which adjacent ranges are merged, and each entry is drawn with "RenderSystem::drawMeshBufferPart".
+Adding or removing a mesh only rebuilds the pages which contain that mesh.
+\code
+scene::StaticGeometry* Batch = new scene::StaticGeometry();
+spScene->addSceneNode(Batch);
+
+foreach (scene::Mesh* Obj, StaticMeshes)
+    Batch->addMesh(Obj);
+\endcode
+\note The meshes are hidden while they are batched and must not be moved or deleted before they have been removed
+from the batch. Shader object callbacks receive the first visible mesh of each page and the world matrix is the identity.
+\see video::RenderSystem::drawMeshBufferPart
+\since Version 3.3
+\ingroup group_scenegraph
+*/
+class SP_EXPORT StaticGeometry : public RenderNode
+{
+    
+    public:
+        
+        /**
+        \param PageSize Specifies the count of vertices for each page. Meshes which are larger than
+        a page get their own page. By default 65536.
+        */
+        StaticGeometry(u32 PageSize = 65536);
+        virtual ~StaticGeometry();
+        
+        /* === Functions === */
+        
+        virtual void render();
+        
+        /**
+        Adds the specified mesh to the batch. The mesh's current global transformation is baked into the pages
+        and the mesh is hidden until it will be removed from the batch.
+        \param[in] Object Pointer to the static mesh.
+        \return True on success. Otherwise the mesh is already batched or it can not be batched, i.e. it has no vertices,
+        a surface with other primitives than triangles or a custom texture layer. Such meshes are rendered as usual.
+        */
+        bool addMesh(Mesh* Object);
+        
+        /**
+        Removes the specified mesh from the batch and restores its visibility.
+        \return True if the mesh was batched.
+        */
+        bool removeMesh(Mesh* Object);
+        
+        //! Removes all meshes from the batch and deletes all pages.
+        void clearMeshes();
+        
+        //! Returns true if the specified mesh is batched.
+        bool hasMesh(const Mesh* Object) const;
+        
+        /* === Inline functions === */
+        
+        inline u32 getPageSize() const
+        {
+            return PageSize_;
+        }
+        
+        //! Returns the count of pages, i.e. shared vertex buffers.
+        inline u32 getNumPages() const
+        {
+            return Pages_.size();
+        }
+        //! Returns the count of batched meshes.
+        inline u32 getNumMeshes() const
+        {
+            return Objects_.size();
+        }
+        
+        //! Returns the count of draw calls in the last frame.
+        inline u32 getNumDrawCalls() const
+        {
+            return NumDrawCalls_;
+        }
+        //! Returns the count of vertex ranges which passed the frustum culling in the last frame.
+        inline u32 getNumDrawnRanges() const
+        {
+            return NumDrawnRanges_;
+        }
+        
+    private:
+        
+        /* === Structures === */
+        
+        struct SPage;
+        
+        struct SObject
+        {
+            Mesh* Object;
+            bool isVisible;             //!< Visibility of the mesh before it was batched.
+            dim::matrix4f Transform;    //!< Global transformation at the time the mesh was batched.
+            BoundingVolume BoundVolume;
+            std::vector<SPage*> Pages;  //!< Pages which contain the vertex ranges of this mesh.
+        };
+        
+        struct SRange
+        {
+            SObject* Object;
+            u32 StartOffset;
+            u32 NumVertices;
+        };
+        
+        struct SPage
+        {
+            SPage(const video::VertexFormat* Format);
+            ~SPage();
+            
+            /* Members */
+            video::MeshBuffer Surface;
+            video::MaterialStates Material;
+            video::ShaderClass* ShdClass;
+            std::vector<SRange> Ranges;
+            bool isModified;
+            bool isResized;     //!< The page has grown, so the whole vertex buffer must be uploaded.
+            u32 DirtyOffset;    //!< First vertex which has been moved since the last upload.
+        };
+        
+        struct SDrawRange
+        {
+            u32 StartOffset;
+            u32 NumVertices;
+        };
+        
+        /* === Functions === */
+        
+        bool isSurfaceBatchable(const video::MeshBuffer* Surface) const;
+        
+        SPage* findPage(const Mesh* Object, const video::MeshBuffer* Surface, u32 NumVertices);
+        SPage* createPage(const Mesh* Object, const video::MeshBuffer* Surface);
+        
+        void insertSurface(SPage* Page, SObject* Object, const video::MeshBuffer* Surface, u32 NumVertices);
+        void removeRanges(SPage* Page, const SObject* Object);
+        void deletePage(SPage* Page);
+        
+        void drawPage(SPage* Page, const ViewFrustum &Frustum);
+        
+        static u32 getTriangleVertexCount(const video::MeshBuffer* Surface);
+        static bool compareTextureLayers(const video::MeshBuffer* Surface, const video::MeshBuffer* Other);
+        
+        /* === Members === */
+        
+        u32 PageSize_;
+        
+        std::vector<SPage*> Pages_;
+        std::map<const Mesh*, SObject*> Objects_;
+        
+        std::vector<SDrawRange> DrawList_;
+        
+        u32 NumDrawCalls_;
+        u32 NumDrawnRanges_;
+        
+};
+
+
+} // /namespace scene
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
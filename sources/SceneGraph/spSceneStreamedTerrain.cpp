@@ -0,0 +1,612 @@
+/*
+ * Streamed terrain scene node file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "SceneGraph/spSceneStreamedTerrain.hpp"
+#include "SceneGraph/spSceneGraph.hpp"
+#include "SceneGraph/spSceneCamera.hpp"
+#include "RenderSystem/spRenderSystem.hpp"
+#include "Base/spInputOutputFilePhysical.hpp"
+#include "Base/spInputOutputLog.hpp"
+#include "Base/spMathCollisionLibrary.hpp"
+#include "Base/spMemoryManagement.hpp"
+
+#include <boost/foreach.hpp>
+#include <algorithm>
+
+
+namespace sp
+{
+
+extern video::RenderSystem* GlbRenderSys;
+extern scene::SceneGraph* GlbSceneGraph;
+
+namespace scene
+{
+
+
+/*
+ * Internal functions
+ */
+
+THREAD_PROC(StreamedTerrainThreadProc)
+{
+    StreamedTerrain* Terrain = static_cast<StreamedTerrain*>(Arguments);
+    
+    /* Each thread reads the height field with its own file handle */
+    io::FilePhysical File;
+    
+    if (File.open(Terrain->Desc_.Filename, io::FILE_READ))
+    {
+        std::vector<f32> Heights;
+        
+        while (1)
+        {
+            /* Sleep until a chunk has been requested (canceled requests leave the queue empty) */
+            Terrain->RequestSignal_.wait();
+            
+            if (!Terrain->isRunning_)
+                break;
+            
+            StreamedTerrain::SChunk* Chunk = Terrain->popRequest();
+            
+            if (Chunk)
+                Terrain->loadChunk(File, Chunk, Heights);
+        }
+    }
+    
+    Terrain->ExitSignal_.post();
+    
+    return 0;
+}
+
+/*
+ * StreamedTerrain class
+ */
+
+StreamedTerrain::StreamedTerrain() :
+    Terrain             (       ),
+    MaxDepth_           (0      ),
+    isRunning_          (false  ),
+    Frame_              (0      ),
+    NumDrawnChunks_     (0      )
+{
+}
+StreamedTerrain::~StreamedTerrain()
+{
+    close();
+}
+
+void StreamedTerrain::render()
+{
+    if (!isRunning_ || !GlbSceneGraph || !GlbSceneGraph->getActiveCamera())
+        return;
+    
+    ++Frame_;
+    NumDrawnChunks_ = 0;
+    
+    /* Upload the chunks which have been loaded by the worker threads */
+    uploadChunks();
+    
+    /* Setup transformation and material states */
+    loadTransformation();
+    GlbRenderSys->updateModelviewMatrix();
+    
+    GlbRenderSys->setupMaterialStates(getMaterial());
+    GlbRenderSys->setupShaderClass(this, getShaderClass());
+    
+    /* Draw the chunk quad-tree */
+    const dim::vector3df GlobalCamPos = GlbSceneGraph->getActiveCamera()->getPosition(true);
+    
+    drawChunkTree(0, 0, 0, GlobalCamPos, getTransformMatrix(true));
+    
+    GlbRenderSys->unbindShaders();
+    
+    /* Drop the requests of this frame which are no longer required and keep the memory bounded */
+    cancelRequests();
+    evictChunks();
+}
+
+bool StreamedTerrain::open(const SStreamedTerrainDesc &Desc)
+{
+    close();
+    
+    /* Validate description */
+    if (Desc.Size.Width < 2 || Desc.Size.Height < 2)
+    {
+        io::Log::error("Height field of streamed terrain must have at least 2x2 samples");
+        return false;
+    }
+    if ( Desc.ChunkResolution < 2 || Desc.ChunkResolution > 128 ||
+         math::roundPow2(static_cast<s32>(Desc.ChunkResolution)) != static_cast<s32>(Desc.ChunkResolution) )
+    {
+        io::Log::error("Chunk resolution of streamed terrain must be a power of two in the range [2 .. 128]");
+        return false;
+    }
+    
+    /* Check if the height field file exists and is large enough */
+    io::FilePhysical File;
+    
+    if (!File.open(Desc.Filename, io::FILE_READ))
+        return false;
+    
+    std::fstream* Stream = static_cast<std::fstream*>(File.getHandle());
+    Stream->seekg(0, std::ios::end);
+    
+    const u64 FileSize = static_cast<u64>(Stream->tellg());
+    const u64 RequiredSize = static_cast<u64>(Desc.Size.Width) * static_cast<u64>(Desc.Size.Height) * sizeof(u16);
+    
+    if (FileSize < RequiredSize)
+    {
+        io::Log::error("Height field file \"" + Desc.Filename + "\" is too small for the specified size");
+        return false;
+    }
+    
+    File.close();
+    
+    /* Compute the quad-tree depth: the leaf chunks are sampled at full resolution */
+    Desc_       = Desc;
+    MaxDepth_   = 0;
+    
+    const u32 MaxSize = static_cast<u32>(math::Max(Desc.Size.Width, Desc.Size.Height) - 1);
+    
+    while ((Desc_.ChunkResolution << MaxDepth_) < MaxSize)
+        ++MaxDepth_;
+    
+    /* Start the worker threads */
+    isRunning_ = true;
+    
+    const u32 ThreadCount = math::Max(1u, Desc_.ThreadCount);
+    
+    for (u32 i = 0; i < ThreadCount; ++i)
+        Threads_.push_back(new ThreadManager(StreamedTerrainThreadProc, this));
+    
+    return true;
+}
+
+void StreamedTerrain::close()
+{
+    if (!isRunning_)
+        return;
+    
+    /* Wake up all threads and wait until they are finished */
+    isRunning_ = false;
+    
+    RequestSignal_.post(Threads_.size());
+    
+    for (u32 i = 0; i < Threads_.size(); ++i)
+        ExitSignal_.wait();
+    
+    MemoryManager::deleteList(Threads_);
+    
+    /* Delete all chunks */
+    for (std::map<u64, SChunk*>::iterator it = Chunks_.begin(); it != Chunks_.end(); ++it)
+        delete it->second;
+    
+    Chunks_.clear();
+    RequestQueue_.clear();
+    UploadQueue_.clear();
+}
+
+u32 StreamedTerrain::getNumPendingChunks() const
+{
+    Mutex_.lock();
+    const u32 Count = RequestQueue_.size();
+    Mutex_.unlock();
+    return Count;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void StreamedTerrain::drawChunkTree(
+    u32 Depth, u32 X, u32 Y, const dim::vector3df &CamPos, const dim::matrix4f &Transform)
+{
+    const dim::aabbox3df Box(getChunkBox(Depth, X, Y));
+    
+    /* Chunks near the camera are more important */
+    const f32 Distance = math::CollisionLibrary::getPointBoxDistance(
+        Transform * dim::obbox3df(Box.Min, Box.Max), CamPos
+    );
+    
+    if (!isChunkResident(Depth, X, Y, Distance))
+        return;
+    
+    SChunk* Chunk = Chunks_[getChunkKey(Depth, X, Y)];
+    
+    /* Check view-frustum culling with the exact height range */
+    if (!GlbSceneGraph->getActiveCamera()->getViewFrustum().isBoundBoxInside(getChunkBox(Chunk), Transform))
+        return;
+    
+    /* Check if the chunk must be subdivided */
+    if (Depth < MaxDepth_)
+    {
+        const dim::vector3df Scale(Transform.getScale());
+        const f32 ChunkSize = static_cast<f32>(getChunkSpan(Depth)) * math::Max(
+            Scale.X / (Desc_.Size.Width - 1), Scale.Z / (Desc_.Size.Height - 1)
+        );
+        
+        if (Distance < ChunkSize * Desc_.LODFactor)
+        {
+            /* Only descend when all children are available, otherwise this chunk is drawn instead */
+            bool ChildrenResident = true;
+            
+            for (u32 i = 0; i < 4; ++i)
+            {
+                const u32 ChildX = X*2 + (i & 1), ChildY = Y*2 + (i >> 1);
+                
+                if (isChunkInside(Depth + 1, ChildX, ChildY) && !isChunkResident(Depth + 1, ChildX, ChildY, Distance))
+                    ChildrenResident = false;
+            }
+            
+            if (ChildrenResident)
+            {
+                for (u32 i = 0; i < 4; ++i)
+                {
+                    const u32 ChildX = X*2 + (i & 1), ChildY = Y*2 + (i >> 1);
+                    
+                    if (isChunkInside(Depth + 1, ChildX, ChildY))
+                        drawChunkTree(Depth + 1, ChildX, ChildY, CamPos, Transform);
+                }
+                return;
+            }
+        }
+    }
+    
+    /* Draw the chunk */
+    GlbRenderSys->drawMeshBuffer(Chunk->Surface);
+    ++NumDrawnChunks_;
+}
+
+StreamedTerrain::SChunk* StreamedTerrain::requestChunk(u32 Depth, u32 X, u32 Y, f32 Priority)
+{
+    SChunk* &Chunk = Chunks_[getChunkKey(Depth, X, Y)];
+    
+    if (!Chunk)
+    {
+        Chunk = new SChunk(Depth, X, Y);
+        
+        Chunk->Priority = Priority;
+        
+        Mutex_.lock();
+        RequestQueue_.push_back(Chunk);
+        Mutex_.unlock();
+        
+        RequestSignal_.post();
+    }
+    else if (!Chunk->isResident)
+    {
+        /* Update the priority of a queued chunk (lower values are loaded first) */
+        Mutex_.lock();
+        
+        if (Chunk->State == CHUNK_QUEUED)
+            Chunk->Priority = Priority;
+        
+        Mutex_.unlock();
+    }
+    
+    Chunk->LastUsedFrame = Frame_;
+    
+    return Chunk;
+}
+
+bool StreamedTerrain::isChunkResident(u32 Depth, u32 X, u32 Y, f32 Priority)
+{
+    return requestChunk(Depth, X, Y, Priority)->isResident;
+}
+
+void StreamedTerrain::uploadChunks()
+{
+    std::vector<SChunk*> Chunks;
+    
+    /* Take the next loaded chunks */
+    Mutex_.lock();
+    {
+        const u32 Count = math::Min(static_cast<u32>(UploadQueue_.size()), math::Max(1u, Desc_.MaxUploadsPerFrame));
+        
+        Chunks.assign(UploadQueue_.begin(), UploadQueue_.begin() + Count);
+        UploadQueue_.erase(UploadQueue_.begin(), UploadQueue_.begin() + Count);
+    }
+    Mutex_.unlock();
+    
+    /* Create the hardware buffers */
+    foreach (SChunk* Chunk, Chunks)
+    {
+        Chunk->Surface->createMeshBuffer();
+        Chunk->Surface->updateMeshBuffer();
+        Chunk->isResident = true;
+    }
+}
+
+void StreamedTerrain::cancelRequests()
+{
+    Mutex_.lock();
+    
+    for (std::vector<SChunk*>::iterator it = RequestQueue_.begin(); it != RequestQueue_.end();)
+    {
+        SChunk* Chunk = *it;
+        
+        if (Chunk->LastUsedFrame != Frame_)
+        {
+            Chunks_.erase(getChunkKey(Chunk->Depth, Chunk->X, Chunk->Y));
+            delete Chunk;
+            it = RequestQueue_.erase(it);
+        }
+        else
+            ++it;
+    }
+    
+    Mutex_.unlock();
+}
+
+void StreamedTerrain::evictChunks()
+{
+    if (Chunks_.size() <= Desc_.MaxResidentChunks)
+        return;
+    
+    /* Collect all resident chunks which have not been used in this frame */
+    std::vector<SChunk*> Candidates;
+    
+    for (std::map<u64, SChunk*>::iterator it = Chunks_.begin(); it != Chunks_.end(); ++it)
+    {
+        if (it->second->isResident && it->second->LastUsedFrame != Frame_)
+            Candidates.push_back(it->second);
+    }
+    
+    /* Delete the least recently used chunks first */
+    std::sort(Candidates.begin(), Candidates.end(), StreamedTerrain::compareChunkLastUse);
+    
+    for (u32 i = 0; i < Candidates.size() && Chunks_.size() > Desc_.MaxResidentChunks; ++i)
+    {
+        SChunk* Chunk = Candidates[i];
+        Chunks_.erase(getChunkKey(Chunk->Depth, Chunk->X, Chunk->Y));
+        delete Chunk;
+    }
+}
+
+StreamedTerrain::SChunk* StreamedTerrain::popRequest()
+{
+    SChunk* Chunk = 0;
+    
+    Mutex_.lock();
+    
+    if (!RequestQueue_.empty())
+    {
+        /* Select the chunk with the highest priority */
+        std::vector<SChunk*>::iterator itBest = RequestQueue_.begin();
+        
+        for (std::vector<SChunk*>::iterator it = itBest + 1; it != RequestQueue_.end(); ++it)
+        {
+            if ((*it)->Priority < (*itBest)->Priority)
+                itBest = it;
+        }
+        
+        Chunk = *itBest;
+        Chunk->State = CHUNK_LOADING;
+        
+        RequestQueue_.erase(itBest);
+    }
+    
+    Mutex_.unlock();
+    
+    return Chunk;
+}
+
+void StreamedTerrain::loadChunk(io::FilePhysical &File, SChunk* Chunk, std::vector<f32> &Heights)
+{
+    /* Read the heights including a border of one sample for the normals */
+    readHeights(File, Chunk, Heights);
+    
+    const u32 Res       = Desc_.ChunkResolution;
+    const u32 Pitch     = Res + 3;
+    const u32 Span      = getChunkSpan(Chunk->Depth);
+    const u32 Stride    = Span / Res;
+    
+    const u32 LastX     = static_cast<u32>(Desc_.Size.Width - 1);
+    const u32 LastY     = static_cast<u32>(Desc_.Size.Height - 1);
+    const f32 InvLastX  = 1.0f / static_cast<f32>(LastX);
+    const f32 InvLastY  = 1.0f / static_cast<f32>(LastY);
+    
+    const f32 StepX     = static_cast<f32>(Stride) * InvLastX;
+    const f32 StepY     = static_cast<f32>(Stride) * InvLastY;
+    
+    /* Build the vertex grid */
+    video::MeshBuffer* Surface = new video::MeshBuffer(GlbRenderSys->getVertexFormatDefault(), video::DATATYPE_UNSIGNED_SHORT);
+    
+    Chunk->MinHeight = Chunk->MaxHeight = Heights[Pitch + 1];
+    
+    for (u32 y = 0; y <= Res; ++y)
+    {
+        for (u32 x = 0; x <= Res; ++x)
+        {
+            const f32* Sample = &Heights[(y + 1)*Pitch + x + 1];
+            
+            /* Vertices outside the height field are clamped to its border */
+            const dim::vector3df Coord(
+                static_cast<f32>(math::Min(Chunk->X*Span + x*Stride, LastX)) * InvLastX,
+                *Sample,
+                static_cast<f32>(math::Min(Chunk->Y*Span + y*Stride, LastY)) * InvLastY
+            );
+            
+            const dim::vector3df Normal(
+                dim::vector3df(
+                    (Sample[-1] - Sample[1]) / (2.0f*StepX), 1.0f, (Sample[-s32(Pitch)] - Sample[Pitch]) / (2.0f*StepY)
+                ).normalize()
+            );
+            
+            Surface->addVertex(Coord, Normal, dim::vector3df(Coord.X, Coord.Z, 0.0f));
+            
+            math::decrease(Chunk->MinHeight, *Sample);
+            math::increase(Chunk->MaxHeight, *Sample);
+        }
+    }
+    
+    for (u32 y = 0; y < Res; ++y)
+    {
+        for (u32 x = 0; x < Res; ++x)
+        {
+            const u32 i = y*(Res + 1) + x;
+            Surface->addTriangle(i, i + Res + 1, i + Res + 2);
+            Surface->addTriangle(i, i + Res + 2, i + 1);
+        }
+    }
+    
+    /* Add skirts along the four edges to hide the cracks between chunks of different levels */
+    const f32 SkirtDepth = (Chunk->MaxHeight - Chunk->MinHeight) + math::Max(StepX, StepY);
+    
+    static const s32 EdgeStart[4][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+    static const s32 EdgeDir[4][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
+    
+    for (u32 Edge = 0; Edge < 4; ++Edge)
+    {
+        const u32 First = Surface->getVertexCount();
+        
+        for (u32 i = 0; i <= Res; ++i)
+        {
+            const u32 x = EdgeStart[Edge][0]*Res + EdgeDir[Edge][0]*static_cast<s32>(i);
+            const u32 y = EdgeStart[Edge][1]*Res + EdgeDir[Edge][1]*static_cast<s32>(i);
+            
+            const u32 Index = y*(Res + 1) + x;
+            
+            dim::vector3df Coord(Surface->getVertexCoord(Index));
+            Coord.Y -= SkirtDepth;
+            
+            Surface->addVertex(Coord, Surface->getVertexNormal(Index), dim::vector3df(Coord.X, Coord.Z, 0.0f));
+            
+            if (i > 0)
+            {
+                const u32 PrevIndex = (y - EdgeDir[Edge][1])*(Res + 1) + (x - EdgeDir[Edge][0]);
+                Surface->addTriangle(PrevIndex, Index, First + i);
+                Surface->addTriangle(PrevIndex, First + i, First + i - 1);
+            }
+        }
+    }
+    
+    Chunk->MinHeight -= SkirtDepth;
+    
+    /* Pass the chunk to the render thread */
+    Mutex_.lock();
+    {
+        Chunk->Surface  = Surface;
+        Chunk->State    = CHUNK_LOADED;
+        UploadQueue_.push_back(Chunk);
+    }
+    Mutex_.unlock();
+}
+
+void StreamedTerrain::readHeights(io::FilePhysical &File, const SChunk* Chunk, std::vector<f32> &Heights)
+{
+    const s32 Res       = static_cast<s32>(Desc_.ChunkResolution);
+    const s32 Pitch     = Res + 3;
+    const s32 Span      = static_cast<s32>(getChunkSpan(Chunk->Depth));
+    const s32 Stride    = Span / Res;
+    const s32 StartX    = static_cast<s32>(Chunk->X) * Span - Stride;
+    const s32 StartY    = static_cast<s32>(Chunk->Y) * Span - Stride;
+    const s32 Width     = Desc_.Size.Width;
+    const s32 Height    = Desc_.Size.Height;
+    
+    Heights.resize(Pitch*Pitch);
+    
+    std::fstream* Stream = static_cast<std::fstream*>(File.getHandle());
+    std::vector<u16> Row;
+    
+    for (s32 y = 0; y < Pitch; ++y)
+    {
+        const s32 SampleY = math::MinMax(StartY + y*Stride, 0, Height - 1);
+        const std::streamoff RowOffset = static_cast<std::streamoff>(SampleY) * Width * sizeof(u16);
+        
+        /* Read the whole row span at once (coarse chunks are point sampled in memory) */
+        const s32 First = math::MinMax(StartX, 0, Width - 1);
+        const s32 Last  = math::MinMax(StartX + (Pitch - 1)*Stride, 0, Width - 1);
+        
+        Row.resize(Last - First + 1);
+        
+        Stream->seekg(RowOffset + First*sizeof(u16));
+        Stream->read(reinterpret_cast<c8*>(&Row[0]), Row.size()*sizeof(u16));
+        
+        const u32 NumRead = static_cast<u32>(Stream->gcount()) / sizeof(u16);
+        
+        if (NumRead < Row.size())
+        {
+            /* The file size has been validated on creation, so this is an I/O error: use zero for the missing samples */
+            std::fill(Row.begin() + NumRead, Row.end(), 0);
+            Stream->clear();
+        }
+        
+        /* Normalize the heights to [0.0 .. 1.0] */
+        f32* Dest = &Heights[y*Pitch];
+        
+        for (s32 x = 0; x < Pitch; ++x)
+            Dest[x] = static_cast<f32>(Row[math::MinMax(StartX + x*Stride, First, Last) - First]) / 65535.0f;
+    }
+}
+
+dim::aabbox3df StreamedTerrain::getChunkBox(const SChunk* Chunk) const
+{
+    dim::aabbox3df Box(getChunkBox(Chunk->Depth, Chunk->X, Chunk->Y));
+    
+    Box.Min.Y = Chunk->MinHeight;
+    Box.Max.Y = Chunk->MaxHeight;
+    
+    return Box;
+}
+
+dim::aabbox3df StreamedTerrain::getChunkBox(u32 Depth, u32 X, u32 Y) const
+{
+    const u32 Span  = getChunkSpan(Depth);
+    const u32 LastX = static_cast<u32>(Desc_.Size.Width - 1);
+    const u32 LastY = static_cast<u32>(Desc_.Size.Height - 1);
+    
+    return dim::aabbox3df(
+        dim::vector3df(
+            static_cast<f32>(math::Min(X*Span, LastX)) / LastX, 0.0f,
+            static_cast<f32>(math::Min(Y*Span, LastY)) / LastY
+        ),
+        dim::vector3df(
+            static_cast<f32>(math::Min((X + 1)*Span, LastX)) / LastX, 1.0f,
+            static_cast<f32>(math::Min((Y + 1)*Span, LastY)) / LastY
+        )
+    );
+}
+
+bool StreamedTerrain::compareChunkLastUse(const SChunk* A, const SChunk* B)
+{
+    return A->LastUsedFrame < B->LastUsedFrame;
+}
+
+
+/*
+ * SChunk structure
+ */
+
+StreamedTerrain::SChunk::SChunk(u32 InitDepth, u32 InitX, u32 InitY) :
+    Depth           (InitDepth      ),
+    X               (InitX          ),
+    Y               (InitY          ),
+    State           (CHUNK_QUEUED   ),
+    isResident      (false          ),
+    Surface         (0              ),
+    MinHeight       (0.0f           ),
+    MaxHeight       (1.0f           ),
+    Priority        (0.0f           ),
+    LastUsedFrame   (0              )
+{
+}
+StreamedTerrain::SChunk::~SChunk()
+{
+    delete Surface;
+}
+
+
+} // /namespace scene
+
+} // /namespace sp
+
+
+
+// ================================================================================
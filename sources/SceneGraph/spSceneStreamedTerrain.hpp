@@ -0,0 +1,225 @@
+/*
+ * Streamed terrain scene node header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_SCENE_STREAMED_TERRAIN_H__
+#define __SP_SCENE_STREAMED_TERRAIN_H__
+
+
+#include "Base/spStandard.hpp"
+#include "Base/spInputOutputString.hpp"
+#include "Base/spCriticalSection.hpp"
+#include "Base/spSemaphore.hpp"
+#include "Base/spThreadManager.hpp"
+#include "SceneGraph/spSceneTerrain.hpp"
+
+#include <vector>
+#include <map>
+
+
+namespace sp
+{
+namespace io
+{
+    class FilePhysical;
+}
+namespace scene
+{
+
+
+//! Streamed terrain description. \see StreamedTerrain
+struct SP_EXPORT SStreamedTerrainDesc
+{
+    SStreamedTerrainDesc() :
+        ChunkResolution     (32     ),
+        MaxResidentChunks   (256    ),
+        MaxUploadsPerFrame  (4      ),
+        ThreadCount         (1      ),
+        LODFactor           (2.0f   )
+    {
+    }
+    ~SStreamedTerrainDesc()
+    {
+    }
+    
+    /* Members */
+    io::stringc Filename;   //!< Height field file: raw 16-bit unsigned little-endian heights, row by row (Size.Width * Size.Height values).
+    dim::size2di Size;      //!< Count of height samples in X and Z direction.
+    u32 ChunkResolution;    //!< Count of quads along each chunk edge. Must be a power of two in the range [2 .. 128]. By default 32.
+    u32 MaxResidentChunks;  //!< Maximal count of chunks which are hold in memory. Chunks which are drawn in the current frame are never released, so this is a soft limit. By default 256.
+    u32 MaxUploadsPerFrame; //!< Maximal count of chunks which are uploaded to the GPU in one frame. By default 4.
+    u32 ThreadCount;        //!< Count of worker threads which load and build the chunks. By default 1.
+    f32 LODFactor;          //!< A chunk is subdivided when the camera distance is less than its size multiplied by this factor. By default 2.0.
+};
+
+
+/**
+StreamedTerrain is a terrain mode for height fields which are too large to be hold in memory.
+The height field is paged from disk chunk by chunk. All chunks form a quad-tree: the root chunk covers the whole
+height field with a coarse sample stride and each level halves the stride until the chunks are sampled at full
+resolution. Only the chunks around the camera are loaded (by worker threads) and uploaded incrementally,
+i.e. with a limited count of chunks per frame. As long as a chunk is not available, its parent chunk is drawn instead.
+The count of chunks in memory is limited so the memory usage does not depend on the height field size.
+Cracks between neighbor chunks with different levels are hidden with vertical skirts.
+\note The terrain covers the range [0.0 .. 1.0] on each axis in object space like the Terrain class.
+Use the node's scale to specify the world size.
+\ingroup group_scenegraph
+*/
+class SP_EXPORT StreamedTerrain : public Terrain
+{
+    
+    public:
+        
+        StreamedTerrain();
+        virtual ~StreamedTerrain();
+        
+        /* === Functions === */
+        
+        virtual void render();
+        
+        /**
+        Opens the specified height field and starts the worker threads.
+        \param Desc: Specifies the terrain description.
+        \return True on success. Otherwise the height field file could not be opened or the description is invalid.
+        */
+        bool open(const SStreamedTerrainDesc &Desc);
+        
+        //! Stops the worker threads and deletes all chunks.
+        void close();
+        
+        //! Returns the count of chunks which are waiting to be loaded by the worker threads.
+        u32 getNumPendingChunks() const;
+        
+        /* === Inline functions === */
+        
+        //! Returns the terrain description.
+        inline const SStreamedTerrainDesc& getDesc() const
+        {
+            return Desc_;
+        }
+        
+        //! Returns the count of quad-tree levels.
+        inline u32 getNumLevels() const
+        {
+            return MaxDepth_ + 1;
+        }
+        
+        //! Returns the count of chunks in memory (queued, loaded or already uploaded).
+        inline u32 getNumChunks() const
+        {
+            return Chunks_.size();
+        }
+        
+        //! Returns the count of chunks which have been drawn in the last frame.
+        inline u32 getNumDrawnChunks() const
+        {
+            return NumDrawnChunks_;
+        }
+        
+    private:
+        
+        friend THREAD_PROC(StreamedTerrainThreadProc);
+        
+        /* === Enumerations === */
+        
+        enum EChunkStates
+        {
+            CHUNK_QUEUED,   //!< Waiting for a worker thread.
+            CHUNK_LOADING,  //!< A worker thread is loading the chunk.
+            CHUNK_LOADED,   //!< Loaded and built by a worker thread.
+        };
+        
+        /* === Structures === */
+        
+        struct SChunk
+        {
+            SChunk(u32 InitDepth, u32 InitX, u32 InitY);
+            ~SChunk();
+            
+            /* Members */
+            u32 Depth, X, Y;
+            EChunkStates State;         //!< Loading state. Only accessed while the mutex is locked.
+            bool isResident;            //!< Uploaded and ready to draw. Only accessed by the render thread.
+            video::MeshBuffer* Surface;
+            f32 MinHeight, MaxHeight;
+            f32 Priority;
+            u32 LastUsedFrame;
+        };
+        
+        /* === Functions === */
+        
+        void drawChunkTree(u32 Depth, u32 X, u32 Y, const dim::vector3df &CamPos, const dim::matrix4f &Transform);
+        
+        SChunk* requestChunk(u32 Depth, u32 X, u32 Y, f32 Priority);
+        bool isChunkResident(u32 Depth, u32 X, u32 Y, f32 Priority);
+        
+        void uploadChunks();
+        void cancelRequests();
+        void evictChunks();
+        
+        SChunk* popRequest();
+        void loadChunk(io::FilePhysical &File, SChunk* Chunk, std::vector<f32> &Heights);
+        void readHeights(io::FilePhysical &File, const SChunk* Chunk, std::vector<f32> &Heights);
+        
+        dim::aabbox3df getChunkBox(const SChunk* Chunk) const;
+        dim::aabbox3df getChunkBox(u32 Depth, u32 X, u32 Y) const;
+        
+        static bool compareChunkLastUse(const SChunk* A, const SChunk* B);
+        
+        /* === Inline functions === */
+        
+        static inline u64 getChunkKey(u32 Depth, u32 X, u32 Y)
+        {
+            return (static_cast<u64>(Depth) << 58) | (static_cast<u64>(X) << 29) | static_cast<u64>(Y);
+        }
+        
+        //! Returns the count of height samples which are covered by one chunk in the specified depth.
+        inline u32 getChunkSpan(u32 Depth) const
+        {
+            return (Desc_.ChunkResolution << MaxDepth_) >> Depth;
+        }
+        
+        //! Returns false if the specified chunk is completely outside the height field.
+        inline bool isChunkInside(u32 Depth, u32 X, u32 Y) const
+        {
+            const u32 Span = getChunkSpan(Depth);
+            return X*Span < static_cast<u32>(Desc_.Size.Width - 1) && Y*Span < static_cast<u32>(Desc_.Size.Height - 1);
+        }
+        
+        /* === Members === */
+        
+        SStreamedTerrainDesc Desc_;
+        u32 MaxDepth_;
+        
+        std::map<u64, SChunk*> Chunks_;
+        
+        std::vector<SChunk*> RequestQueue_;
+        std::vector<SChunk*> UploadQueue_;
+        
+        mutable CriticalSection Mutex_;
+        
+        Semaphore RequestSignal_;
+        Semaphore ExitSignal_;
+        
+        std::vector<ThreadManager*> Threads_;
+        volatile bool isRunning_;
+        
+        u32 Frame_;
+        u32 NumDrawnChunks_;
+        
+};
+
+
+} // /namespace scene
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
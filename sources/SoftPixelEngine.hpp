@@ -47,7 +47,9 @@
 #include "Base/spInputOutput.hpp"
 #include "Base/spMath.hpp"
 #include "Base/spThreadManager.hpp"
+#include "Base/spThreadPool.hpp"
 #include "Base/spTimer.hpp"
+#include "Base/spProfiler.hpp"
 #include "Base/spMathRasterizer.hpp"
 #include "Base/spMathInterpolator.hpp"
 #include "Base/spDimensionPolygon.hpp"
@@ -66,6 +68,7 @@
 #include "RenderSystem/spTextureLayerStandard.hpp"
 #include "RenderSystem/spTextureLayerRelief.hpp"
 #include "RenderSystem/spQuery.hpp"
+#include "RenderSystem/spRenderCommandBuffer.hpp"
 #include "RenderSystem/PostProcessing/spRadialBlur.hpp"
 
 #include "SceneGraph/spSceneGraph.hpp"
@@ -0,0 +1,398 @@
+/*
+ * Software sound file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "SoundSystem/Software/spSoftwareSound.hpp"
+
+#ifdef SP_COMPILE_WITH_SOFTWARE_SOUND
+
+
+#include "Base/spInputOutputLog.hpp"
+#include "Base/spMath.hpp"
+#include "SoundSystem/Software/spSoftwareSoundDevice.hpp"
+
+#include <boost/foreach.hpp>
+#include <boost/make_shared.hpp>
+
+
+namespace sp
+{
+namespace audio
+{
+
+
+SoftwareSound::SoftwareSound(SoftwareSoundDevice* Device) :
+    Sound       (       ),
+    Device_     (Device ),
+    CurVoice_   (0      )
+{
+}
+SoftwareSound::~SoftwareSound()
+{
+    close();
+}
+
+bool SoftwareSound::reload(const io::stringc &Filename, u8 BufferCount)
+{
+    if (!checkFile(Filename))
+        return false;
+    
+    /* Load the PCM buffer */
+    SAudioBufferPtr AudioBuffer = Device_->loadAudioPCMBuffer(Filename);
+    
+    if (!AudioBuffer || !reload(AudioBuffer, BufferCount))
+    {
+        io::Log::lowerTab();
+        return false;
+    }
+    
+    Filename_ = Filename;
+    io::Log::lowerTab();
+    
+    return true;
+}
+
+bool SoftwareSound::reload(const SAudioBufferPtr &AudioBuffer, u8 BufferCount)
+{
+    /* Close previous loaded sound */
+    close();
+    
+    if (!AudioBuffer || !AudioBuffer->BufferPCM || AudioBuffer->FormatFlags.Channels < 1)
+        return false;
+    
+    const SWaveFormatFlags &Format = AudioBuffer->FormatFlags;
+    
+    if (Format.BitsPerSample != 8 && Format.BitsPerSample != 16)
+    {
+        io::Log::error("Unsupported PCM format for software sound (only 8 and 16 bit are supported)");
+        return false;
+    }
+    
+    /* Convert the PCM samples into planar float samples */
+    const u32 NumChannels       = static_cast<u32>(Format.Channels);
+    const u32 BytesPerSample    = static_cast<u32>(Format.BitsPerSample) / 8;
+    const u32 NumFrames         = AudioBuffer->BufferSize / (BytesPerSample * NumChannels);
+    
+    boost::shared_ptr<SSoftwareSampleBuffer> Buffer = boost::make_shared<SSoftwareSampleBuffer>();
+    
+    Buffer->NumChannels = math::Min(NumChannels, 2u);
+    Buffer->NumFrames   = NumFrames;
+    Buffer->SampleRate  = static_cast<u32>(math::Max(1, Format.SamplesPerSec));
+    
+    for (u32 c = 0; c < Buffer->NumChannels; ++c)
+    {
+        std::vector<f32> &Samples = Buffer->Samples[c];
+        
+        Samples.resize(NumFrames + 2, 0.0f);
+        
+        if (BytesPerSample == 2)
+        {
+            const s16* Src = reinterpret_cast<const s16*>(AudioBuffer->BufferPCM) + c;
+            
+            for (u32 i = 0; i < NumFrames; ++i, Src += NumChannels)
+                Samples[i] = static_cast<f32>(*Src) / 32768.0f;
+        }
+        else
+        {
+            /* 8 bit PCM samples are unsigned */
+            const u8* Src = reinterpret_cast<const u8*>(AudioBuffer->BufferPCM) + c;
+            
+            for (u32 i = 0; i < NumFrames; ++i, Src += NumChannels)
+                Samples[i] = (static_cast<f32>(*Src) - 128.0f) / 128.0f;
+        }
+        
+        /* Repeat the last frame for the interpolation (looping voices wrap around to the first frame in the mixer) */
+        if (NumFrames > 0)
+            Samples[NumFrames] = Samples[NumFrames + 1] = Samples[NumFrames - 1];
+    }
+    
+    Buffer_ = Buffer;
+    
+    /* Create the voices */
+    BufferCount_ = math::Max(static_cast<u8>(1), BufferCount);
+    
+    for (u8 i = 0; i < BufferCount_; ++i)
+    {
+        SSoftwareVoice* Voice = Device_->createVoice();
+        Voice->Buffer = Buffer_;
+        Voices_.push_back(Voice);
+    }
+    
+    CurVoice_ = 0;
+    
+    updateVoices();
+    
+    return true;
+}
+
+void SoftwareSound::close()
+{
+    foreach (SSoftwareVoice* Voice, Voices_)
+        Device_->deleteVoice(Voice);
+    
+    Voices_.clear();
+    Buffer_.reset();
+}
+
+void SoftwareSound::play()
+{
+    Sound::play();
+    
+    if (!Voices_.empty())
+    {
+        Device_->Mutex_.lock();
+        {
+            SSoftwareVoice* Voice = nextVoice();
+            
+            setupVoiceState(Voice->State);
+            
+            Voice->State.Cursor         = 0.0;
+            Voice->State.isPlaying      = true;
+            Voice->State.isPaused       = false;
+            Voice->State.hasLastGain    = false;
+            
+            ++Voice->Serial;
+        }
+        Device_->Mutex_.unlock();
+    }
+}
+
+void SoftwareSound::pause(bool Paused)
+{
+    Sound::pause(Paused);
+    
+    Device_->Mutex_.lock();
+    
+    foreach (SSoftwareVoice* Voice, Voices_)
+    {
+        Voice->State.isPaused       = Paused;
+        Voice->State.hasLastGain    = false;
+    }
+    
+    Device_->Mutex_.unlock();
+}
+
+void SoftwareSound::stop()
+{
+    Sound::stop();
+    
+    Device_->Mutex_.lock();
+    
+    foreach (SSoftwareVoice* Voice, Voices_)
+    {
+        Voice->State.Cursor     = 0.0;
+        Voice->State.isPlaying  = false;
+        Voice->State.isPaused   = false;
+        
+        ++Voice->Serial;
+    }
+    
+    Device_->Mutex_.unlock();
+}
+
+void SoftwareSound::emit2D(f32 Volume, bool /*UseEffectSlot*/)
+{
+    if (Voices_.empty())
+        return;
+    
+    Device_->Mutex_.lock();
+    {
+        SSoftwareVoice* Voice = nextVoice();
+        
+        Voice->State.Cursor         = 0.0;
+        Voice->State.Volume         = Volume;
+        Voice->State.Balance        = 0.0f;
+        Voice->State.isVolumetric   = false;
+        Voice->State.isLoop         = false;
+        Voice->State.isPlaying      = true;
+        Voice->State.isPaused       = false;
+        Voice->State.hasLastGain    = false;
+        
+        ++Voice->Serial;
+    }
+    Device_->Mutex_.unlock();
+}
+
+void SoftwareSound::emit3D(const dim::vector3df &Point, f32 Volume, bool /*UseEffectSlot*/)
+{
+    if (Voices_.empty())
+        return;
+    
+    Device_->Mutex_.lock();
+    {
+        SSoftwareVoice* Voice = nextVoice();
+        
+        Voice->State.Cursor         = 0.0;
+        Voice->State.Volume         = Volume;
+        Voice->State.Position       = Point;
+        Voice->State.isVolumetric   = true;
+        Voice->State.isLoop         = false;
+        Voice->State.isPlaying      = true;
+        Voice->State.isPaused       = false;
+        Voice->State.hasLastGain    = false;
+        
+        ++Voice->Serial;
+    }
+    Device_->Mutex_.unlock();
+}
+
+void SoftwareSound::setSeek(f32 Seek)
+{
+    Sound::setSeek(Seek);
+    
+    if (!Voices_.empty())
+    {
+        Device_->Mutex_.lock();
+        {
+            SSoftwareVoice* Voice = Voices_[CurVoice_];
+            
+            Voice->State.Cursor = static_cast<f64>(math::MinMax(Seek, 0.0f, 1.0f)) * Buffer_->NumFrames;
+            
+            ++Voice->Serial;
+        }
+        Device_->Mutex_.unlock();
+    }
+}
+
+f32 SoftwareSound::getSeek() const
+{
+    if (Voices_.empty() || !Buffer_->NumFrames)
+        return 0.0f;
+    
+    Device_->Mutex_.lock();
+    const f64 Cursor = Voices_[CurVoice_]->State.Cursor;
+    Device_->Mutex_.unlock();
+    
+    return static_cast<f32>(Cursor / Buffer_->NumFrames);
+}
+
+void SoftwareSound::setVolume(f32 Volume)
+{
+    Sound::setVolume(Volume);
+    updateVoices();
+}
+
+void SoftwareSound::setSpeed(f32 Speed)
+{
+    Sound::setSpeed(Speed);
+    updateVoices();
+}
+
+void SoftwareSound::setBalance(f32 Balance)
+{
+    Sound::setBalance(Balance);
+    updateVoices();
+}
+
+void SoftwareSound::setLoop(bool Enable)
+{
+    Sound::setLoop(Enable);
+    updateVoices();
+}
+
+bool SoftwareSound::playing() const
+{
+    if (Voices_.empty())
+        return false;
+    
+    Device_->Mutex_.lock();
+    const bool Result = (Voices_[CurVoice_]->State.isPlaying && !Voices_[CurVoice_]->State.isPaused);
+    Device_->Mutex_.unlock();
+    
+    return Result;
+}
+
+bool SoftwareSound::finish() const
+{
+    return !playing() && !paused() && getSeek() >= 1.0f;
+}
+
+f32 SoftwareSound::getLength() const
+{
+    if (Buffer_)
+        return static_cast<f32>(Buffer_->NumFrames) / Buffer_->SampleRate;
+    return 0.0f;
+}
+
+bool SoftwareSound::valid() const
+{
+    return Buffer_ && !Voices_.empty();
+}
+
+void SoftwareSound::setPosition(const dim::vector3df &Position)
+{
+    Sound::setPosition(Position);
+    updateVoices();
+}
+
+void SoftwareSound::setVolumetric(bool isVolumetric)
+{
+    Sound::setVolumetric(isVolumetric);
+    updateVoices();
+}
+
+void SoftwareSound::setVolumetricRadius(f32 Radius)
+{
+    Sound::setVolumetricRadius(Radius);
+    updateVoices();
+}
+
+bool SoftwareSound::isVirtual() const
+{
+    if (Voices_.empty())
+        return false;
+    
+    Device_->Mutex_.lock();
+    const bool Result = (Voices_[CurVoice_]->State.isPlaying && Voices_[CurVoice_]->State.isVirtual);
+    Device_->Mutex_.unlock();
+    
+    return Result;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void SoftwareSound::updateVoices()
+{
+    Device_->Mutex_.lock();
+    
+    foreach (SSoftwareVoice* Voice, Voices_)
+        setupVoiceState(Voice->State);
+    
+    Device_->Mutex_.unlock();
+}
+
+void SoftwareSound::setupVoiceState(SSoftwareVoiceState &State) const
+{
+    State.Volume        = Volume_;
+    State.Balance       = Balance_;
+    State.Speed         = Speed_;
+    State.Radius        = math::Max(Radius_, math::ROUNDING_ERROR);
+    State.Position      = Position_;
+    State.isVolumetric  = isVolumetric_;
+    State.isLoop        = isLoop_;
+}
+
+SSoftwareVoice* SoftwareSound::nextVoice()
+{
+    /* Use the voices in turn, like the sources of the OpenAL sound */
+    CurVoice_ = (CurVoice_ + 1) % Voices_.size();
+    return Voices_[CurVoice_];
+}
+
+
+} // /namespace audio
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,125 @@
+/*
+ * Software sound header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_AUDIO_SOUND_SOFTWARE_H__
+#define __SP_AUDIO_SOUND_SOFTWARE_H__
+
+
+#include "Base/spStandard.hpp"
+
+#ifdef SP_COMPILE_WITH_SOFTWARE_SOUND
+
+
+#include "SoundSystem/spSound.hpp"
+#include "FileFormats/Sound/spSoundLoader.hpp"
+
+#include <vector>
+
+
+namespace sp
+{
+namespace audio
+{
+
+
+class SoftwareSoundDevice;
+struct SSoftwareSampleBuffer;
+struct SSoftwareVoice;
+struct SSoftwareVoiceState;
+
+/**
+Sound of the software sound device. Each buffer of the sound is one voice of the software mixer,
+so the count of buffers is the count of instances which can be heard at the same time.
+\note Sound effects (see "SoundDevice::setEffectSlot") are not supported by the software mixer.
+\see SoftwareSoundDevice
+\since Version 3.3
+*/
+class SP_EXPORT SoftwareSound : public Sound
+{
+    
+    public:
+        
+        SoftwareSound(SoftwareSoundDevice* Device);
+        ~SoftwareSound();
+        
+        /* === Functions === */
+        
+        bool reload(const io::stringc &Filename, u8 BufferCount = DEF_SOUND_BUFFERCOUNT);
+        
+        /**
+        Reloads the sound from the specified PCM buffer, e.g. for procedurally generated sounds.
+        \param[in] AudioBuffer Specifies the audio buffer. Only 8 and 16 bit PCM formats are supported.
+        \param[in] BufferCount Specifies the count of voices.
+        \return True if the buffer could be converted.
+        */
+        bool reload(const SAudioBufferPtr &AudioBuffer, u8 BufferCount = DEF_SOUND_BUFFERCOUNT);
+        
+        void close();
+        
+        void play();
+        void pause(bool Paused = true);
+        void stop();
+        
+        void emit2D(f32 Volume = 1.0f, bool UseEffectSlot = true);
+        void emit3D(const dim::vector3df &Point, f32 Volume = 1.0f, bool UseEffectSlot = true);
+        
+        void setSeek(f32 Seek);
+        f32 getSeek() const;
+        
+        void setVolume(f32 Volume);
+        void setSpeed(f32 Speed);
+        void setBalance(f32 Balance);
+        
+        void setLoop(bool Enable);
+        
+        bool playing() const;
+        bool finish() const;
+        
+        f32 getLength() const;
+        bool valid() const;
+        
+        void setPosition(const dim::vector3df &Position);
+        
+        void setVolumetric(bool isVolumetric);
+        void setVolumetricRadius(f32 Radius);
+        
+        //! Returns true if the current voice is playing but virtual, i.e. it is too quiet to be mixed.
+        bool isVirtual() const;
+        
+    private:
+        
+        /* === Functions === */
+        
+        void updateVoices();
+        void setupVoiceState(SSoftwareVoiceState &State) const;
+        
+        SSoftwareVoice* nextVoice();
+        
+        /* === Members === */
+        
+        SoftwareSoundDevice* Device_;
+        
+        boost::shared_ptr<SSoftwareSampleBuffer> Buffer_;
+        
+        std::vector<SSoftwareVoice*> Voices_;
+        u32 CurVoice_;
+        
+};
+
+
+} // /namespace audio
+
+} // /namespace sp
+
+
+#endif
+
+#endif
+
+
+
+// ================================================================================
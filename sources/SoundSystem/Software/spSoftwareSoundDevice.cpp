@@ -0,0 +1,706 @@
+/*
+ * Software sound device file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "SoundSystem/Software/spSoftwareSoundDevice.hpp"
+
+#ifdef SP_COMPILE_WITH_SOFTWARE_SOUND
+
+
+#include "Base/spMemoryManagement.hpp"
+#include "Base/spInputOutputLog.hpp"
+#include "Base/spTimer.hpp"
+#include "Base/spMath.hpp"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define SP_SOFTWARE_SOUND_SIMD
+#   include <emmintrin.h>
+#endif
+
+
+namespace sp
+{
+namespace audio
+{
+
+
+/*
+ * Internal functions
+ */
+
+THREAD_PROC(SoftwareSoundDeviceThreadProc)
+{
+    SoftwareSoundDevice* Device = static_cast<SoftwareSoundDevice*>(Arguments);
+    
+    /* Use the wall clock timer (the static timer functions measure the processor time on some platforms) */
+    io::Timer Clock(true);
+    Clock.resetClockCounter();
+    
+    u64 NumFrames = 0;
+    
+    while (Device->isThreadRunning_)
+    {
+        if (Device->Sink_ && Device->Sink_->blocking())
+        {
+            /* The sink paces the audio thread */
+            Device->mixBlock(Device->BlockSize_);
+        }
+        else
+        {
+            /* Mix one block ahead of the system timer */
+            const u64 ElapsedFrames = Clock.getElapsedMicroseconds() * Device->SampleRate_ / 1000000;
+            
+            if (NumFrames <= ElapsedFrames)
+            {
+                Device->mixBlock(Device->BlockSize_);
+                NumFrames += Device->BlockSize_;
+            }
+            else
+                io::Timer::sleep(1);
+        }
+    }
+    
+    Device->ExitSignal_.post();
+    
+    return 0;
+}
+
+//! Wraps the voice around (in loop mode) or stops it when the end of the buffer has been reached.
+static void finishVoice(SSoftwareVoiceState &State, f64 Length)
+{
+    if (State.isLoop)
+        State.Cursor = fmod(State.Cursor, Length);
+    else
+    {
+        State.Cursor    = Length;
+        State.isPlaying = false;
+    }
+}
+
+/**
+Mixes the specified segment of a voice with linear interpolation into the output buffers.
+All frames of the segment must lie inside the sample buffer (including the padding frames).
+*/
+static void mixVoiceSegment(
+    const f32* SrcLeft, const f32* SrcRight, f64 Cursor, f32 Step,
+    f32* DestLeft, f32* DestRight, u32 NumFrames, const f32 Gain[2], const f32 GainStep[2])
+{
+    /* Start at the integral source frame */
+    const u32 Offset = static_cast<u32>(Cursor);
+    const f32 Frac = static_cast<f32>(Cursor - Offset);
+    
+    SrcLeft += Offset;
+    SrcRight += Offset;
+    
+    const bool isMono = (SrcLeft == SrcRight);
+    
+    u32 i = 0;
+    
+    #ifdef SP_SOFTWARE_SOUND_SIMD
+    
+    const __m128 FrameStep  = _mm_set1_ps(4.0f);
+    const __m128 GainStepL  = _mm_set1_ps(GainStep[0] * 4.0f);
+    const __m128 GainStepR  = _mm_set1_ps(GainStep[1] * 4.0f);
+    
+    __m128 GainL = _mm_add_ps(_mm_set1_ps(Gain[0]), _mm_mul_ps(_mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f), _mm_set1_ps(GainStep[0])));
+    __m128 GainR = _mm_add_ps(_mm_set1_ps(Gain[1]), _mm_mul_ps(_mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f), _mm_set1_ps(GainStep[1])));
+    
+    if (Step == 1.0f && Frac == 0.0f)
+    {
+        /* Fast path: no resampling */
+        for (; i + 4 <= NumFrames; i += 4)
+        {
+            const __m128 SampleL = _mm_loadu_ps(SrcLeft + i);
+            const __m128 SampleR = (isMono ? SampleL : _mm_loadu_ps(SrcRight + i));
+            
+            _mm_storeu_ps(DestLeft + i, _mm_add_ps(_mm_loadu_ps(DestLeft + i), _mm_mul_ps(SampleL, GainL)));
+            _mm_storeu_ps(DestRight + i, _mm_add_ps(_mm_loadu_ps(DestRight + i), _mm_mul_ps(SampleR, GainR)));
+            
+            GainL = _mm_add_ps(GainL, GainStepL);
+            GainR = _mm_add_ps(GainR, GainStepR);
+        }
+    }
+    else
+    {
+        /* Resample with linear interpolation (the positions are computed from the frame index to avoid accumulated errors) */
+        const __m128 StartPos   = _mm_set1_ps(Frac);
+        const __m128 PosStep    = _mm_set1_ps(Step);
+        
+        __m128 Frame = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+        
+        s32 Index[4];
+        
+        for (; i + 4 <= NumFrames; i += 4)
+        {
+            const __m128 Pos = _mm_add_ps(StartPos, _mm_mul_ps(Frame, PosStep));
+            const __m128i PosIndex = _mm_cvttps_epi32(Pos);
+            const __m128 Factor = _mm_sub_ps(Pos, _mm_cvtepi32_ps(PosIndex));
+            
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Index), PosIndex);
+            
+            /* Gather and interpolate the samples */
+            __m128 SampleA = _mm_set_ps(SrcLeft[Index[3]    ], SrcLeft[Index[2]    ], SrcLeft[Index[1]    ], SrcLeft[Index[0]    ]);
+            __m128 SampleB = _mm_set_ps(SrcLeft[Index[3] + 1], SrcLeft[Index[2] + 1], SrcLeft[Index[1] + 1], SrcLeft[Index[0] + 1]);
+            
+            const __m128 SampleL = _mm_add_ps(SampleA, _mm_mul_ps(_mm_sub_ps(SampleB, SampleA), Factor));
+            __m128 SampleR = SampleL;
+            
+            if (!isMono)
+            {
+                SampleA = _mm_set_ps(SrcRight[Index[3]    ], SrcRight[Index[2]    ], SrcRight[Index[1]    ], SrcRight[Index[0]    ]);
+                SampleB = _mm_set_ps(SrcRight[Index[3] + 1], SrcRight[Index[2] + 1], SrcRight[Index[1] + 1], SrcRight[Index[0] + 1]);
+                SampleR = _mm_add_ps(SampleA, _mm_mul_ps(_mm_sub_ps(SampleB, SampleA), Factor));
+            }
+            
+            _mm_storeu_ps(DestLeft + i, _mm_add_ps(_mm_loadu_ps(DestLeft + i), _mm_mul_ps(SampleL, GainL)));
+            _mm_storeu_ps(DestRight + i, _mm_add_ps(_mm_loadu_ps(DestRight + i), _mm_mul_ps(SampleR, GainR)));
+            
+            Frame = _mm_add_ps(Frame, FrameStep);
+            GainL = _mm_add_ps(GainL, GainStepL);
+            GainR = _mm_add_ps(GainR, GainStepR);
+        }
+    }
+    
+    #endif
+    
+    /* Mix the remaining frames */
+    for (; i < NumFrames; ++i)
+    {
+        const f32 Pos = Frac + static_cast<f32>(i) * Step;
+        const u32 PosIndex = static_cast<u32>(Pos);
+        const f32 Factor = Pos - static_cast<f32>(PosIndex);
+        
+        const f32 SampleL = SrcLeft[PosIndex] + (SrcLeft[PosIndex + 1] - SrcLeft[PosIndex]) * Factor;
+        const f32 SampleR = (isMono ? SampleL : SrcRight[PosIndex] + (SrcRight[PosIndex + 1] - SrcRight[PosIndex]) * Factor);
+        
+        DestLeft[i]     += SampleL * (Gain[0] + GainStep[0] * i);
+        DestRight[i]    += SampleR * (Gain[1] + GainStep[1] * i);
+    }
+}
+
+//! Mixes a single frame between the last and the first frame of a looping voice.
+static void mixVoiceLoopFrame(
+    const f32* SrcLeft, const f32* SrcRight, u32 Length, f64 Cursor, f32* DestLeft, f32* DestRight, const f32 Gain[2])
+{
+    const u32 Last = Length - 1;
+    const f32 Factor = static_cast<f32>(Cursor - Last);
+    
+    const f32 SampleL = SrcLeft[Last] + (SrcLeft[0] - SrcLeft[Last]) * Factor;
+    const f32 SampleR = (SrcLeft == SrcRight ? SampleL : SrcRight[Last] + (SrcRight[0] - SrcRight[Last]) * Factor);
+    
+    *DestLeft   += SampleL * Gain[0];
+    *DestRight  += SampleR * Gain[1];
+}
+
+
+/*
+ * SoftwareSoundDevice class
+ */
+
+SoftwareSoundDevice::SoftwareSoundDevice(u32 SampleRate, u32 BlockSize) :
+    SoundDevice         (SOUNDDEVICE_SOFTWARE   ),
+    isMixing_           (false                  ),
+    MixListenerSpeed_   (1.0f                   ),
+    MixNearVol_         (1.0f                   ),
+    MixFarVol_          (0.0f                   ),
+    Sink_               (0                      ),
+    Thread_             (0                      ),
+    isThreadRunning_    (false                  ),
+    SampleRate_         (math::Max(1u, SampleRate)  ),
+    BlockSize_          (math::Max(4u, BlockSize)   ),
+    MaxVoices_          (64                     ),
+    VirtualThreshold_   (0.001f                 ),
+    NumPlayingVoices_   (0                      ),
+    NumVirtualVoices_   (0                      ),
+    NumMixedFrames_     (0                      )
+{
+    MixBuffer_[0].resize(BlockSize_);
+    MixBuffer_[1].resize(BlockSize_);
+    OutputBuffer_.resize(BlockSize_ * 2);
+    
+    startThread();
+}
+SoftwareSoundDevice::~SoftwareSoundDevice()
+{
+    stopThread();
+    
+    if (Sink_)
+        Sink_->close();
+    
+    /* Delete the sounds before the voices (the base class would delete them after the mutex has been destroyed) */
+    MemoryManager::deleteList(SoundList_);
+    MemoryManager::deleteList(Voices_);
+}
+
+io::stringc SoftwareSoundDevice::getInterface() const
+{
+    return "Software Mixer (" + io::stringc(SampleRate_) + " Hz)";
+}
+
+void SoftwareSoundDevice::updateSounds()
+{
+    // do nothing
+}
+
+SoftwareSound* SoftwareSoundDevice::createSound()
+{
+    SoftwareSound* NewSound = new SoftwareSound(this);
+    SoundList_.push_back(NewSound);
+    return NewSound;
+}
+
+void SoftwareSoundDevice::setListenerPosition(const dim::vector3df &Position)
+{
+    Mutex_.lock();
+    SoundDevice::setListenerPosition(Position);
+    Mutex_.unlock();
+}
+void SoftwareSoundDevice::setListenerOrientation(const dim::matrix4f &Orientation)
+{
+    Mutex_.lock();
+    SoundDevice::setListenerOrientation(Orientation);
+    Mutex_.unlock();
+}
+void SoftwareSoundDevice::setListenerRange(const f32 NearDist, const f32 FarDist, const f32 NearVol, const f32 FarVol)
+{
+    Mutex_.lock();
+    SoundDevice::setListenerRange(NearDist, FarDist, NearVol, FarVol);
+    Mutex_.unlock();
+}
+void SoftwareSoundDevice::setListenerSpeed(f32 Speed)
+{
+    Mutex_.lock();
+    SoundDevice::setListenerSpeed(Speed);
+    Mutex_.unlock();
+}
+
+bool SoftwareSoundDevice::setSink(SoundSink* Sink)
+{
+    if (Sink_ == Sink)
+        return true;
+    
+    /* Stop the audio thread while the sink is exchanged */
+    const bool isThreadEnabled = (Thread_ != 0);
+    
+    stopThread();
+    
+    if (Sink_)
+        Sink_->close();
+    
+    Sink_ = Sink;
+    
+    bool Result = true;
+    
+    if (Sink_ && !Sink_->open(SampleRate_, 2))
+    {
+        io::Log::error("Could not open sound sink");
+        Sink_ = 0;
+        Result = false;
+    }
+    
+    if (isThreadEnabled)
+        startThread();
+    
+    return Result;
+}
+
+void SoftwareSoundDevice::setAudioThread(bool Enable)
+{
+    if (Enable)
+        startThread();
+    else
+        stopThread();
+}
+
+void SoftwareSoundDevice::render(u32 NumFrames)
+{
+    if (Thread_)
+    {
+        io::Log::error("Cannot render audio manually while the audio thread is running");
+        return;
+    }
+    
+    while (NumFrames > 0)
+    {
+        const u32 Count = math::Min(NumFrames, BlockSize_);
+        mixBlock(Count);
+        NumFrames -= Count;
+    }
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+SSoftwareVoice* SoftwareSoundDevice::createVoice()
+{
+    SSoftwareVoice* Voice = new SSoftwareVoice();
+    
+    Mutex_.lock();
+    Voices_.push_back(Voice);
+    Mutex_.unlock();
+    
+    return Voice;
+}
+
+void SoftwareSoundDevice::deleteVoice(SSoftwareVoice* Voice)
+{
+    Mutex_.lock();
+    
+    if (isMixing_)
+    {
+        /* The mixer still uses this voice, so it will be deleted with the next block */
+        Voice->isDeleted = true;
+        Voice->State.isPlaying = false;
+    }
+    else
+    {
+        MemoryManager::removeElement(Voices_, Voice);
+        delete Voice;
+    }
+    
+    Mutex_.unlock();
+}
+
+void SoftwareSoundDevice::mixBlock(u32 NumFrames)
+{
+    /* Copy the state of all playing voices */
+    Mutex_.lock();
+    {
+        isMixing_ = true;
+        
+        MixVoices_.clear();
+        
+        for (u32 i = 0; i < Voices_.size();)
+        {
+            SSoftwareVoice* Voice = Voices_[i];
+            
+            if (Voice->isDeleted)
+            {
+                /* Delete the voice and remove it in constant time */
+                Voices_[i] = Voices_.back();
+                Voices_.pop_back();
+                delete Voice;
+                continue;
+            }
+            
+            if (Voice->State.isPlaying && !Voice->State.isPaused && Voice->Buffer && Voice->Buffer->NumFrames > 0)
+            {
+                SMixVoice MixVoice;
+                {
+                    MixVoice.Voice  = Voice;
+                    MixVoice.Buffer = Voice->Buffer.get();
+                    MixVoice.Serial = Voice->Serial;
+                    MixVoice.State  = Voice->State;
+                }
+                MixVoices_.push_back(MixVoice);
+            }
+            
+            ++i;
+        }
+        
+        MixListenerPosition_    = ListenerPosition_;
+        MixListenerOrientation_ = ListenerOrientation_;
+        MixListenerSpeed_       = ListenerSpeed_;
+        MixNearVol_             = NearVol_;
+        MixFarVol_              = FarVol_;
+    }
+    Mutex_.unlock();
+    
+    /* Compute the gains and virtualize the inaudible voices */
+    u32 NumAudible = 0;
+    
+    for (std::vector<SMixVoice>::iterator it = MixVoices_.begin(); it != MixVoices_.end(); ++it)
+    {
+        computeGains(*it);
+        
+        it->State.isVirtual = (it->Audibility < VirtualThreshold_);
+        
+        if (!it->State.isVirtual)
+            ++NumAudible;
+    }
+    
+    if (NumAudible > MaxVoices_)
+    {
+        /* Only mix the loudest voices */
+        std::vector<SMixVoice>::iterator itEnd = std::partition(
+            MixVoices_.begin(), MixVoices_.end(), SoftwareSoundDevice::isMixVoiceAudible
+        );
+        
+        std::nth_element(
+            MixVoices_.begin(), MixVoices_.begin() + MaxVoices_, itEnd, SoftwareSoundDevice::cmpMixVoiceAudibility
+        );
+        
+        for (std::vector<SMixVoice>::iterator it = MixVoices_.begin() + MaxVoices_; it != itEnd; ++it)
+            it->State.isVirtual = true;
+    }
+    
+    /* Mix all audible voices and advance the virtual voices */
+    std::fill(MixBuffer_[0].begin(), MixBuffer_[0].begin() + NumFrames, 0.0f);
+    std::fill(MixBuffer_[1].begin(), MixBuffer_[1].begin() + NumFrames, 0.0f);
+    
+    u32 NumVirtual = 0;
+    
+    for (std::vector<SMixVoice>::iterator it = MixVoices_.begin(); it != MixVoices_.end(); ++it)
+    {
+        if (it->State.isVirtual)
+        {
+            advanceVoice(*it, NumFrames);
+            ++NumVirtual;
+        }
+        else
+            mixVoice(*it, NumFrames);
+    }
+    
+    /* Write the playback state back (unless the sound has changed the position meanwhile) */
+    Mutex_.lock();
+    {
+        for (std::vector<SMixVoice>::iterator it = MixVoices_.begin(); it != MixVoices_.end(); ++it)
+        {
+            SSoftwareVoice* Voice = it->Voice;
+            
+            if (Voice->Serial == it->Serial)
+            {
+                Voice->State.Cursor         = it->State.Cursor;
+                Voice->State.isPlaying      = it->State.isPlaying;
+                Voice->State.isVirtual      = it->State.isVirtual;
+                Voice->State.LastGain[0]    = it->State.LastGain[0];
+                Voice->State.LastGain[1]    = it->State.LastGain[1];
+                Voice->State.hasLastGain    = it->State.hasLastGain;
+            }
+        }
+        
+        NumPlayingVoices_   = MixVoices_.size();
+        NumVirtualVoices_   = NumVirtual;
+        NumMixedFrames_     += NumFrames;
+        
+        isMixing_ = false;
+    }
+    Mutex_.unlock();
+    
+    writeOutput(NumFrames);
+}
+
+void SoftwareSoundDevice::computeGains(SMixVoice &MixVoice) const
+{
+    const SSoftwareVoiceState &State = MixVoice.State;
+    
+    f32 Volume = State.Volume;
+    f32 Balance = State.Balance;
+    
+    if (State.isVolumetric)
+    {
+        /* Compute the 3D attenuation (linear to the radius) */
+        const f32 Distance = math::getDistance(MixListenerPosition_, State.Position);
+        
+        if (Distance < State.Radius)
+            Volume *= MixFarVol_ + (1.0f - Distance / State.Radius) * (MixNearVol_ - MixFarVol_);
+        else
+            Volume *= MixFarVol_;
+        
+        /* Compute the panning by the direction in listener space */
+        if (Distance > math::ROUNDING_ERROR)
+        {
+            dim::vector3df Dir((State.Position - MixListenerPosition_) / Distance);
+            Dir = MixListenerOrientation_ * Dir;
+            Balance = Dir.X;
+        }
+        else
+            Balance = 0.0f;
+    }
+    
+    Balance = math::MinMax(Balance, -1.0f, 1.0f);
+    
+    MixVoice.Gain[0]    = Volume * math::Min(1.0f, 1.0f - Balance);
+    MixVoice.Gain[1]    = Volume * math::Min(1.0f, 1.0f + Balance);
+    MixVoice.Audibility = math::Max(math::Abs(MixVoice.Gain[0]), math::Abs(MixVoice.Gain[1]));
+    
+    MixVoice.Step = static_cast<f32>(MixVoice.Buffer->SampleRate) / SampleRate_ * math::Max(0.0f, State.Speed * MixListenerSpeed_);
+}
+
+void SoftwareSoundDevice::mixVoice(SMixVoice &MixVoice, u32 NumFrames)
+{
+    SSoftwareVoiceState &State = MixVoice.State;
+    const SSoftwareSampleBuffer* Buffer = MixVoice.Buffer;
+    
+    if (MixVoice.Step <= 0.0f)
+        return;
+    
+    /* Ramp the gains from the previous block to avoid clicks */
+    if (!State.hasLastGain)
+    {
+        State.LastGain[0] = MixVoice.Gain[0];
+        State.LastGain[1] = MixVoice.Gain[1];
+    }
+    
+    const f32 GainStep[2] =
+    {
+        (MixVoice.Gain[0] - State.LastGain[0]) / NumFrames,
+        (MixVoice.Gain[1] - State.LastGain[1]) / NumFrames
+    };
+    
+    const f32* SrcLeft  = &Buffer->Samples[0][0];
+    const f32* SrcRight = (Buffer->NumChannels > 1 ? &Buffer->Samples[1][0] : SrcLeft);
+    
+    const f64 Length = static_cast<f64>(Buffer->NumFrames);
+    
+    u32 Offset = 0;
+    
+    while (Offset < NumFrames && State.isPlaying)
+    {
+        /* Wrap around or stop at the end */
+        if (State.Cursor >= Length)
+        {
+            finishVoice(State, Length);
+            continue;
+        }
+        
+        const f32 Gain[2] =
+        {
+            State.LastGain[0] + GainStep[0] * Offset,
+            State.LastGain[1] + GainStep[1] * Offset
+        };
+        
+        /* Looping voices interpolate the last frame with the first one (the padding frames repeat the last frame) */
+        const f64 End = (State.isLoop ? Length - 1.0 : Length);
+        
+        if (State.Cursor >= End)
+        {
+            mixVoiceLoopFrame(
+                SrcLeft, SrcRight, Buffer->NumFrames, State.Cursor,
+                &MixBuffer_[0][Offset], &MixBuffer_[1][Offset], Gain
+            );
+            
+            State.Cursor += MixVoice.Step;
+            ++Offset;
+            continue;
+        }
+        
+        /* Mix the frames until the end of the buffer is reached */
+        const u32 Available = static_cast<u32>(ceil((End - State.Cursor) / MixVoice.Step));
+        const u32 Count = math::Min(NumFrames - Offset, math::Max(1u, Available));
+        
+        mixVoiceSegment(
+            SrcLeft, SrcRight, State.Cursor, MixVoice.Step,
+            &MixBuffer_[0][Offset], &MixBuffer_[1][Offset], Count, Gain, GainStep
+        );
+        
+        State.Cursor += static_cast<f64>(MixVoice.Step) * Count;
+        Offset += Count;
+    }
+    
+    if (State.isPlaying && State.Cursor >= Length)
+        finishVoice(State, Length);
+    
+    State.LastGain[0]   = MixVoice.Gain[0];
+    State.LastGain[1]   = MixVoice.Gain[1];
+    State.hasLastGain   = true;
+}
+
+void SoftwareSoundDevice::advanceVoice(SMixVoice &MixVoice, u32 NumFrames)
+{
+    SSoftwareVoiceState &State = MixVoice.State;
+    
+    const f64 Length = static_cast<f64>(MixVoice.Buffer->NumFrames);
+    
+    State.Cursor += static_cast<f64>(MixVoice.Step) * NumFrames;
+    
+    if (State.Cursor >= Length)
+        finishVoice(State, Length);
+    
+    /* Fade in when the voice becomes audible again */
+    State.LastGain[0]   = 0.0f;
+    State.LastGain[1]   = 0.0f;
+    State.hasLastGain   = true;
+}
+
+void SoftwareSoundDevice::writeOutput(u32 NumFrames)
+{
+    if (!Sink_)
+        return;
+    
+    /* Convert the mix buffers to interleaved 16 bit samples */
+    const f32* SrcLeft  = &MixBuffer_[0][0];
+    const f32* SrcRight = &MixBuffer_[1][0];
+    
+    s16* Dest = &OutputBuffer_[0];
+    
+    u32 i = 0;
+    
+    #ifdef SP_SOFTWARE_SOUND_SIMD
+    
+    const __m128 Scale = _mm_set1_ps(32767.0f);
+    
+    for (; i + 4 <= NumFrames; i += 4)
+    {
+        const __m128 SampleL = _mm_mul_ps(_mm_loadu_ps(SrcLeft + i), Scale);
+        const __m128 SampleR = _mm_mul_ps(_mm_loadu_ps(SrcRight + i), Scale);
+        
+        /* Interleave, convert and pack with saturation */
+        const __m128i Low   = _mm_cvtps_epi32(_mm_unpacklo_ps(SampleL, SampleR));
+        const __m128i High  = _mm_cvtps_epi32(_mm_unpackhi_ps(SampleL, SampleR));
+        
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Dest + i*2), _mm_packs_epi32(Low, High));
+    }
+    
+    #endif
+    
+    for (; i < NumFrames; ++i)
+    {
+        Dest[i*2    ] = static_cast<s16>(math::MinMax(SrcLeft[i], -1.0f, 1.0f) * 32767.0f);
+        Dest[i*2 + 1] = static_cast<s16>(math::MinMax(SrcRight[i], -1.0f, 1.0f) * 32767.0f);
+    }
+    
+    Sink_->write(Dest, NumFrames);
+}
+
+bool SoftwareSoundDevice::cmpMixVoiceAudibility(const SMixVoice &ObjA, const SMixVoice &ObjB)
+{
+    return ObjA.Audibility > ObjB.Audibility;
+}
+
+bool SoftwareSoundDevice::isMixVoiceAudible(const SMixVoice &Obj)
+{
+    return !Obj.State.isVirtual;
+}
+
+void SoftwareSoundDevice::startThread()
+{
+    if (!Thread_)
+    {
+        isThreadRunning_ = true;
+        
+        Thread_ = new ThreadManager(SoftwareSoundDeviceThreadProc, this);
+        Thread_->setPriority(THREADPRIORITY_HIGH);
+    }
+}
+
+void SoftwareSoundDevice::stopThread()
+{
+    if (Thread_)
+    {
+        /* Wait until the audio thread has finished the current block */
+        isThreadRunning_ = false;
+        ExitSignal_.wait();
+        
+        MemoryManager::deleteMemory(Thread_);
+    }
+}
+
+
+} // /namespace audio
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
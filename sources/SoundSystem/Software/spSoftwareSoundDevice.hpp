@@ -0,0 +1,309 @@
+/*
+ * Software sound device header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_AUDIO_SOUNDDEVICE_SOFTWARE_H__
+#define __SP_AUDIO_SOUNDDEVICE_SOFTWARE_H__
+
+
+#include "Base/spStandard.hpp"
+
+#ifdef SP_COMPILE_WITH_SOFTWARE_SOUND
+
+
+#include "Base/spCriticalSection.hpp"
+#include "Base/spSemaphore.hpp"
+#include "Base/spThreadManager.hpp"
+#include "SoundSystem/spSoundDevice.hpp"
+#include "SoundSystem/Software/spSoftwareSound.hpp"
+#include "SoundSystem/Software/spSoftwareSoundSink.hpp"
+
+#include <vector>
+
+
+namespace sp
+{
+namespace audio
+{
+
+
+//! Decoded sound buffer of the software mixer (planar 32 bit float samples). Used internally.
+struct SSoftwareSampleBuffer
+{
+    SSoftwareSampleBuffer() :
+        NumChannels (0),
+        NumFrames   (0),
+        SampleRate  (0)
+    {
+    }
+    ~SSoftwareSampleBuffer()
+    {
+    }
+    
+    /* Members */
+    std::vector<f32> Samples[2];    //!< Samples for each channel with two padding frames at the end (for the interpolation).
+    u32 NumChannels;                //!< Count of channels (1 or 2).
+    u32 NumFrames;                  //!< Count of frames (without the padding frames).
+    u32 SampleRate;                 //!< Sample rate (in Hz).
+};
+
+//! Voice state of the software mixer. Used internally.
+struct SSoftwareVoiceState
+{
+    /* Members */
+    f64 Cursor;             //!< Playback position (in source frames).
+    f32 Volume;
+    f32 Balance;
+    f32 Speed;
+    f32 Radius;
+    dim::vector3df Position;
+    f32 LastGain[2];        //!< Gains of the previous block (for click-free gain changes).
+    bool isVolumetric;
+    bool isLoop;
+    bool isPlaying;
+    bool isPaused;
+    bool isVirtual;
+    bool hasLastGain;
+};
+
+//! Voice of the software mixer. Each buffer of a SoftwareSound is one voice. Used internally.
+struct SSoftwareVoice
+{
+    SSoftwareVoice() :
+        Serial      (0      ),
+        isDeleted   (false  )
+    {
+        State = SSoftwareVoiceState();
+        State.Volume    = 1.0f;
+        State.Speed     = 1.0f;
+        State.Radius    = 100.0f;
+    }
+    ~SSoftwareVoice()
+    {
+    }
+    
+    /* Members */
+    boost::shared_ptr<SSoftwareSampleBuffer> Buffer;
+    SSoftwareVoiceState State;
+    u32 Serial;             //!< Incremented each time the playback position is changed by the sound (e.g. with "play" or "setSeek").
+    bool isDeleted;         //!< Deleted by the sound while the mixer still used it.
+};
+
+
+/**
+Built-in software sound device. All voices are mixed on a dedicated audio thread with SIMD resampling, panning and 3D attenuation.
+Thus the count of voices is not limited by an audio hardware API. Voices which are too quiet or exceed the maximal count of
+mixed voices are virtualized: their playback position is still advanced but they are not mixed until they become audible again.
+The mixed audio is written into a sound sink (see SoundSink and WaveFileSoundSink). Without a sink the audio is discarded.
+\code
+audio::SoftwareSoundDevice* SoundDev = static_cast<audio::SoftwareSoundDevice*>(
+    spDevice->createSoundDevice(audio::SOUNDDEVICE_SOFTWARE)
+);
+audio::WaveFileSoundSink Sink("Output.wav");
+SoundDev->setSink(&Sink);
+\endcode
+\note Looping and 3D sounds are updated by the mixer. Calling "updateSounds" is not required for this device.
+\since Version 3.3
+*/
+class SP_EXPORT SoftwareSoundDevice : public SoundDevice
+{
+    
+    public:
+        
+        SoftwareSoundDevice(u32 SampleRate = 44100, u32 BlockSize = 512);
+        ~SoftwareSoundDevice();
+        
+        /* === Functions === */
+        
+        io::stringc getInterface() const;
+        
+        //! Does nothing. Looping and 3D sounds are updated by the mixer.
+        void updateSounds();
+        
+        SoftwareSound* createSound();
+        
+        void setListenerPosition(const dim::vector3df &Position);
+        void setListenerOrientation(const dim::matrix4f &Orientation);
+        void setListenerRange(const f32 NearDist, const f32 FarDist, const f32 NearVol, const f32 FarVol);
+        void setListenerSpeed(f32 Speed);
+        
+        /**
+        Sets the new sound sink. The previous sink will be closed and the new sink will be opened.
+        \param[in] Sink Specifies the new sound sink. This may also be null to discard the audio.
+        The sink is not deleted by the sound device.
+        \return True if the new sink could be opened.
+        */
+        bool setSink(SoundSink* Sink);
+        
+        /**
+        Enables or disables the audio thread. By default enabled. When the audio thread is enabled,
+        the audio is mixed in real-time (or paced by the sink, see SoundSink::blocking).
+        Disable the audio thread to mix the audio manually with "render", e.g. for tests and offline rendering.
+        */
+        void setAudioThread(bool Enable);
+        
+        /**
+        Mixes the specified count of frames on the calling thread and writes them into the sink.
+        This can only be used when the audio thread is disabled.
+        \see setAudioThread
+        */
+        void render(u32 NumFrames);
+        
+        /* === Inline functions === */
+        
+        //! Returns the output sample rate (in Hz). By default 44100.
+        inline u32 getSampleRate() const
+        {
+            return SampleRate_;
+        }
+        //! Returns the count of frames which are mixed at once. By default 512.
+        inline u32 getBlockSize() const
+        {
+            return BlockSize_;
+        }
+        
+        //! Returns the current sound sink or null.
+        inline SoundSink* getSink() const
+        {
+            return Sink_;
+        }
+        
+        //! Returns true if the audio thread is enabled.
+        inline bool getAudioThread() const
+        {
+            return Thread_ != 0;
+        }
+        
+        /**
+        Sets the maximal count of voices which are mixed at once. If more voices are audible,
+        only the loudest ones are mixed and the others are virtualized. By default 64.
+        */
+        inline void setMaxVoices(u32 Count)
+        {
+            MaxVoices_ = Count;
+        }
+        inline u32 getMaxVoices() const
+        {
+            return MaxVoices_;
+        }
+        
+        /**
+        Sets the threshold under which voices are virtualized. By default 0.001 (-60 dB).
+        \param Threshold Specifies the minimal gain (after the attenuation and panning) of an audible voice.
+        */
+        inline void setVirtualThreshold(f32 Threshold)
+        {
+            VirtualThreshold_ = Threshold;
+        }
+        inline f32 getVirtualThreshold() const
+        {
+            return VirtualThreshold_;
+        }
+        
+        //! Returns the count of playing voices in the last mixed block.
+        inline u32 getNumPlayingVoices() const
+        {
+            return NumPlayingVoices_;
+        }
+        //! Returns the count of virtual voices in the last mixed block.
+        inline u32 getNumVirtualVoices() const
+        {
+            return NumVirtualVoices_;
+        }
+        //! Returns the count of frames which have been mixed since the device was created.
+        inline u64 getNumMixedFrames() const
+        {
+            return NumMixedFrames_;
+        }
+        
+    private:
+        
+        friend class SoftwareSound;
+        friend THREAD_PROC(SoftwareSoundDeviceThreadProc);
+        
+        /* === Structures === */
+        
+        struct SMixVoice
+        {
+            SSoftwareVoice* Voice;
+            const SSoftwareSampleBuffer* Buffer;
+            u32 Serial;
+            SSoftwareVoiceState State;
+            f32 Gain[2];
+            f32 Audibility;
+            f32 Step;
+        };
+        
+        /* === Functions === */
+        
+        SSoftwareVoice* createVoice();
+        void deleteVoice(SSoftwareVoice* Voice);
+        
+        void mixBlock(u32 NumFrames);
+        
+        void computeGains(SMixVoice &MixVoice) const;
+        
+        void mixVoice(SMixVoice &MixVoice, u32 NumFrames);
+        void advanceVoice(SMixVoice &MixVoice, u32 NumFrames);
+        
+        void writeOutput(u32 NumFrames);
+        
+        void startThread();
+        void stopThread();
+        
+        /* === Static functions === */
+        
+        static bool cmpMixVoiceAudibility(const SMixVoice &ObjA, const SMixVoice &ObjB);
+        static bool isMixVoiceAudible(const SMixVoice &Obj);
+        
+        /* === Members === */
+        
+        CriticalSection Mutex_;
+        
+        std::vector<SSoftwareVoice*> Voices_;
+        std::vector<SMixVoice> MixVoices_;
+        bool isMixing_;
+        
+        /* Listener state (copied for the mixer) */
+        dim::vector3df MixListenerPosition_;
+        dim::matrix4f MixListenerOrientation_;
+        f32 MixListenerSpeed_;
+        f32 MixNearVol_, MixFarVol_;
+        
+        std::vector<f32> MixBuffer_[2];
+        std::vector<s16> OutputBuffer_;
+        
+        SoundSink* Sink_;
+        
+        ThreadManager* Thread_;
+        Semaphore ExitSignal_;
+        volatile bool isThreadRunning_;
+        
+        u32 SampleRate_;
+        u32 BlockSize_;
+        
+        u32 MaxVoices_;
+        f32 VirtualThreshold_;
+        
+        u32 NumPlayingVoices_;
+        u32 NumVirtualVoices_;
+        u64 NumMixedFrames_;
+        
+};
+
+
+} // /namespace audio
+
+} // /namespace sp
+
+
+#endif
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,120 @@
+/*
+ * Software sound sink file
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#include "SoundSystem/Software/spSoftwareSoundSink.hpp"
+
+#ifdef SP_COMPILE_WITH_SOFTWARE_SOUND
+
+
+#include "Base/spInputOutputLog.hpp"
+#include "FileFormats/Sound/spSoundLoader.hpp"
+
+
+namespace sp
+{
+namespace audio
+{
+
+
+WaveFileSoundSink::WaveFileSoundSink(const io::stringc &Filename) :
+    SoundSink   (           ),
+    File_       (0          ),
+    Filename_   (Filename   ),
+    SampleRate_ (0          ),
+    NumChannels_(0          ),
+    NumFrames_  (0          )
+{
+}
+WaveFileSoundSink::~WaveFileSoundSink()
+{
+    close();
+}
+
+bool WaveFileSoundSink::open(u32 SampleRate, u32 NumChannels)
+{
+    close();
+    
+    File_ = FileSys_.openFile(Filename_, io::FILE_WRITE);
+    
+    if (!File_)
+    {
+        io::Log::error("Could not open WAV file \"" + Filename_ + "\" for the sound sink");
+        return false;
+    }
+    
+    SampleRate_     = SampleRate;
+    NumChannels_    = NumChannels;
+    NumFrames_      = 0;
+    
+    /* Write the header with an empty data chunk (the sizes are updated when the sink is closed) */
+    writeHeader();
+    
+    return true;
+}
+
+void WaveFileSoundSink::close()
+{
+    if (File_)
+    {
+        /* Update the chunk sizes */
+        File_->setSeek(0);
+        writeHeader();
+        
+        FileSys_.closeFile(File_);
+        File_ = 0;
+    }
+}
+
+void WaveFileSoundSink::write(const s16* Samples, u32 NumFrames)
+{
+    if (File_ && Samples && NumFrames)
+    {
+        File_->writeBuffer(Samples, sizeof(s16) * NumChannels_, NumFrames);
+        NumFrames_ += NumFrames;
+    }
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void WaveFileSoundSink::writeHeader()
+{
+    const u32 DataSize = NumFrames_ * NumChannels_ * sizeof(s16);
+    
+    /* Write RIFF header */
+    File_->writeBuffer("RIFF", 4);
+    File_->writeValue<u32>(36 + DataSize);
+    File_->writeBuffer("WAVE", 4);
+    
+    /* Write format chunk */
+    File_->writeBuffer("fmt ", 4);
+    File_->writeValue<u32>(16);
+    File_->writeValue<s16>(WAVEFORMAT_PCM);
+    File_->writeValue<s16>(NumChannels_);
+    File_->writeValue<s32>(SampleRate_);
+    File_->writeValue<s32>(SampleRate_ * NumChannels_ * sizeof(s16));
+    File_->writeValue<s16>(NumChannels_ * sizeof(s16));
+    File_->writeValue<s16>(16);
+    
+    /* Write data chunk header */
+    File_->writeBuffer("data", 4);
+    File_->writeValue<u32>(DataSize);
+}
+
+
+} // /namespace audio
+
+} // /namespace sp
+
+
+#endif
+
+
+
+// ================================================================================
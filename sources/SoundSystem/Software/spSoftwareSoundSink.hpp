@@ -0,0 +1,144 @@
+/*
+ * Software sound sink header
+ * 
+ * This file is part of the "SoftPixel Engine" (Copyright (c) 2008 by Lukas Hermanns)
+ * See "SoftPixelEngine.hpp" for license information.
+ */
+
+#ifndef __SP_AUDIO_SOFTWARE_SOUND_SINK_H__
+#define __SP_AUDIO_SOFTWARE_SOUND_SINK_H__
+
+
+#include "Base/spStandard.hpp"
+
+#ifdef SP_COMPILE_WITH_SOFTWARE_SOUND
+
+
+#include "Base/spInputOutputFileSystem.hpp"
+
+
+namespace sp
+{
+namespace audio
+{
+
+
+/**
+Sound sink interface for the software sound device. The sink receives the final mixed audio blocks
+as interleaved 16 bit PCM samples, e.g. to pass them to an audio hardware API or to write them into a file.
+\see SoftwareSoundDevice::setSink
+\since Version 3.3
+*/
+class SP_EXPORT SoundSink
+{
+    
+    public:
+        
+        virtual ~SoundSink()
+        {
+        }
+        
+        /* === Functions === */
+        
+        /**
+        Opens the sink. This is called by the sound device before the first block is written.
+        \param SampleRate Specifies the output sample rate (in Hz).
+        \param NumChannels Specifies the count of interleaved channels. The software sound device always mixes in stereo.
+        \return True if the sink could be opened.
+        */
+        virtual bool open(u32 SampleRate, u32 NumChannels) = 0;
+        
+        //! Closes the sink. This is called when the sink is removed from the sound device.
+        virtual void close() = 0;
+        
+        /**
+        Writes the next audio block. This is called on the audio thread
+        (or on the thread which calls "SoftwareSoundDevice::render").
+        \param Samples Specifies the interleaved PCM samples.
+        \param NumFrames Specifies the count of frames. Each frame has one sample for each channel.
+        */
+        virtual void write(const s16* Samples, u32 NumFrames) = 0;
+        
+        /**
+        Returns true if "write" blocks until the output device needs the next block, i.e. the sink paces the audio thread.
+        Otherwise the audio thread paces the mixing with the system timer. By default false.
+        */
+        virtual bool blocking() const
+        {
+            return false;
+        }
+        
+    protected:
+        
+        SoundSink()
+        {
+        }
+        
+};
+
+
+/**
+Headless sound sink which writes the mixed audio into an uncompressed WAV (RIFF WAVE) file.
+Use this to record or benchmark the software sound device without audio hardware.
+\since Version 3.3
+*/
+class SP_EXPORT WaveFileSoundSink : public SoundSink
+{
+    
+    public:
+        
+        WaveFileSoundSink(const io::stringc &Filename);
+        ~WaveFileSoundSink();
+        
+        /* === Functions === */
+        
+        bool open(u32 SampleRate, u32 NumChannels);
+        void close();
+        
+        void write(const s16* Samples, u32 NumFrames);
+        
+        /* === Inline functions === */
+        
+        //! Returns the WAV filename.
+        inline const io::stringc& getFilename() const
+        {
+            return Filename_;
+        }
+        
+        //! Returns the count of frames which have been written since the sink was opened.
+        inline u32 getNumFrames() const
+        {
+            return NumFrames_;
+        }
+        
+    private:
+        
+        /* === Functions === */
+        
+        void writeHeader();
+        
+        /* === Members === */
+        
+        io::FileSystem FileSys_;
+        io::File* File_;
+        io::stringc Filename_;
+        
+        u32 SampleRate_;
+        u32 NumChannels_;
+        u32 NumFrames_;
+        
+};
+
+
+} // /namespace audio
+
+} // /namespace sp
+
+
+#endif
+
+#endif
+
+
+
+// ================================================================================
@@ -44,6 +44,7 @@ enum ESoundDevices
     SOUNDDEVICE_XAUDIO2,    //!< DirectX Xaudio2 sound system for Windows and XBox.
     SOUNDDEVICE_OPENSLES,   //!< OpenSL|ES for the mobile Android platform.
     SOUNDDEVICE_WINMM,      //!< Windows Multi Media sound system.
+    SOUNDDEVICE_SOFTWARE,   //!< Built-in software mixer. The audio is written into a sound sink (see SoftwareSoundDevice). \since Version 3.3
     SOUNDDEVICE_DUMMY,      //!< "Dummy" renderer. Just for debugging or for no sound support.
 };
 
@@ -0,0 +1,118 @@
+//
+// SoftPixel Engine - AsyncMeshLoader Tests
+//
+
+#include <SoftPixelEngine.hpp>
+
+using namespace sp;
+
+#include "../common.hpp"
+
+SP_TESTS_DECLARE
+
+/*
+ * Global members
+ */
+
+s32 NumLoadedMeshes = 0;
+s32 NumFailedMeshes = 0;
+
+void MeshLoaded(scene::Mesh* Obj, bool isLoaded)
+{
+    if (isLoaded)
+        ++NumLoadedMeshes;
+    else
+        ++NumFailedMeshes;
+}
+
+
+/*
+ * Main function
+ */
+
+int main()
+{
+    SP_TESTS_INIT("AsyncMeshLoader")
+    
+    scene::AsyncMeshLoader* Loader = spSceneMngr->getAsyncMeshLoader();
+    Loader->setUploadBudget(512*1024, 1000);
+    
+    Cam->setPosition(dim::vector3df(0, 2, -8));
+    
+    scene::CollisionGraph* CollGraph = spDevice->createCollisionGraph();
+    scene::CollisionMaterial* CollMaterial = CollGraph->createMaterial();
+    
+    // Request the meshes (the nearest meshes first) while the main loop keeps running
+    const io::stringc Files[] =
+    {
+        ROOT_PATH + "Media/Statue/statue.obj",
+        ROOT_PATH + "Media/Statue/statue.spm",
+        ROOT_PATH + "AnimationTests/dwarf2.b3d",
+        ROOT_PATH + "AdvancedRendererTests/CornellBox.spm",
+        "MissingFile.spm"
+    };
+    
+    std::vector<scene::AsyncMeshRequestPtr> Requests;
+    
+    for (s32 i = 0; i < 5; ++i)
+    {
+        scene::SAsyncMeshDesc Desc;
+        {
+            Desc.Priority       = static_cast<f32>(i);
+            Desc.UpdateNormals  = (i == 0);
+            Desc.Callback       = MeshLoaded;
+            
+            // Build the collision kd-tree of the first statue on the worker thread, too
+            if (i == 0)
+            {
+                Desc.CollGraph      = CollGraph;
+                Desc.CollMaterial   = CollMaterial;
+            }
+        }
+        Requests.push_back(spScene->loadMeshAsync(Files[i], Desc));
+    }
+    
+    // Request one mesh and cancel it again immediately
+    scene::AsyncMeshRequestPtr CanceledRequest = spScene->loadMeshAsync(ROOT_PATH + "Media/Statue/statue.spm");
+    CanceledRequest->cancel();
+    
+    // Main loop
+    SP_TESTS_MAIN_BEGIN
+    {
+        tool::Toolset::moveCameraFree();
+        
+        // Place each mesh as soon as it is ready
+        for (u32 i = 0; i < Requests.size(); ++i)
+        {
+            scene::Mesh* Obj = Requests[i]->getMesh();
+            if (Obj && Obj->getPosition().getLength() == 0.0f)
+                Obj->meshFit(dim::vector3df(static_cast<f32>(i) * 4.0f - 8.0f, 0, 0), 3.0f);
+        }
+        
+        spScene->renderScene();
+        
+        // Draw statistics
+        Draw2DText(
+            dim::point2di(15, 15),
+            "Pending: " + io::stringc(Loader->getNumPendingMeshes()) +
+            ", loaded: " + io::stringc(NumLoadedMeshes) +
+            ", failed: " + io::stringc(NumFailedMeshes) +
+            ", canceled: " + io::stringc(CanceledRequest->getState() == scene::ASYNCMESH_CANCELED ? "yes" : "no")
+        );
+        
+        for (u32 i = 0; i < Requests.size(); ++i)
+        {
+            Draw2DText(
+                dim::point2di(15, 40 + i*25),
+                Requests[i]->getFilename().getFilePart() + ": " +
+                io::stringc(static_cast<s32>(Requests[i]->getProgress() * 100.0f)) + "%"
+            );
+        }
+        
+        Draw2DText(
+            dim::point2di(15, 40 + Requests.size()*25),
+            "Uploaded last frame: " + io::stringc(Loader->getNumUploadedBytes() / 1024) + " KB"
+        );
+    }
+    SP_TESTS_MAIN_END
+}
@@ -0,0 +1,105 @@
+//
+// SoftPixel Engine - AsyncTexture Tests
+//
+
+#include <SoftPixelEngine.hpp>
+
+using namespace sp;
+
+#include "../common.hpp"
+
+SP_TESTS_DECLARE
+
+/*
+ * Global members
+ */
+
+const s32 GRID_SIZE = 8;
+
+s32 NumLoadedTextures = 0;
+s32 NumFailedTextures = 0;
+
+void TextureLoaded(video::Texture* Tex, bool isLoaded)
+{
+    if (isLoaded)
+        ++NumLoadedTextures;
+    else
+        ++NumFailedTextures;
+}
+
+
+/*
+ * Main function
+ */
+
+int main()
+{
+    SP_TESTS_INIT("AsyncTexture")
+    
+    const io::stringc MediaPath = ROOT_PATH + "Media/";
+    
+    const io::stringc Files[] =
+    {
+        "DetailMap.jpg", "DryGround1.jpg", "FloorBricks1.jpg", "Grass1.jpg",
+        "GrassSnow1.jpg", "HeightMap.jpg", "SkyboxNorth.jpg", "UnusualTextureSize.jpg"
+    };
+    
+    // Create a grid of cubes with asynchronously loaded textures (nearest cubes first)
+    video::AsyncTextureLoader* Loader = spRenderer->getAsyncTextureLoader();
+    Loader->setUploadBudget(1024*1024, 1000);
+    
+    Cam->setPosition(dim::vector3df(0, 3, -5));
+    
+    std::vector<scene::Mesh*> Cubes;
+    std::vector<video::Texture*> Textures;
+    
+    for (s32 z = 0; z < GRID_SIZE; ++z)
+    {
+        for (s32 x = 0; x < GRID_SIZE; ++x)
+        {
+            scene::Mesh* Obj = spScene->createMesh(scene::MESH_CUBE);
+            Obj->setPosition(dim::vector3df(static_cast<f32>(x - GRID_SIZE/2) * 2.0f, 0, static_cast<f32>(z) * 2.0f));
+            
+            const f32 Distance = math::getDistance(Obj->getPosition(), Cam->getPosition());
+            
+            video::Texture* Tex = spRenderer->loadTextureAsync(
+                MediaPath + Files[(z*GRID_SIZE + x) % 8], Distance, TextureLoaded
+            );
+            Obj->addTexture(Tex);
+            
+            Cubes.push_back(Obj);
+            Textures.push_back(Tex);
+        }
+    }
+    
+    // Main loop
+    SP_TESTS_MAIN_BEGIN
+    {
+        tool::Toolset::moveCameraFree();
+        
+        // Update the priorities of the pending textures
+        for (u32 i = 0; i < Cubes.size(); ++i)
+        {
+            if (Loader->isLoading(Textures[i]))
+                Loader->setPriority(Textures[i], math::getDistance(Cubes[i]->getPosition(), Cam->getPosition()));
+        }
+        
+        spScene->renderScene();
+        
+        // Draw statistics
+        Draw2DText(
+            dim::point2di(15, 15),
+            "Pending: " + io::stringc(Loader->getNumPendingTextures()) +
+            ", loaded: " + io::stringc(NumLoadedTextures) +
+            ", failed: " + io::stringc(NumFailedTextures)
+        );
+        Draw2DText(
+            dim::point2di(15, 40),
+            "Uploaded last frame: " + io::stringc(Loader->getNumUploadedTextures()) +
+            " textures, " + io::stringc(Loader->getNumUploadedBytes() / 1024) + " KB"
+        );
+        
+        DrawFPS(dim::point2di(15, 65));
+    }
+    SP_TESTS_MAIN_END
+}
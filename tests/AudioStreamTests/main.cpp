@@ -0,0 +1,155 @@
+//
+// SoftPixel Engine - AudioStream Tests
+//
+
+#include <SoftPixelEngine.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "FileFormats/Sound/spAudioStreamService.hpp"
+
+using namespace sp;
+
+#include "../common.hpp"
+
+SP_TESTS_DECLARE
+
+/*
+ * Procedural audio stream
+ */
+
+class SineAudioStream : public audio::AudioStream
+{
+    
+    public:
+        
+        SineAudioStream(f32 Frequency, f32 Duration) :
+            audio::AudioStream(),
+            Frequency_  (Frequency  ),
+            Duration_   (Duration   ),
+            Frame_      (0          ),
+            NumFrames_  (0          )
+        {
+        }
+        ~SineAudioStream()
+        {
+        }
+        
+        bool openFile(const io::stringc &Filename)
+        {
+            Format_     = audio::WAVECHANNEL_STEREO16;
+            SampleRate_ = 44100;
+            Frame_      = 0;
+            NumFrames_  = static_cast<u32>(Duration_ * SampleRate_);
+            return true;
+        }
+        void closeFile()
+        {
+            SampleRate_ = 0;
+        }
+        
+        u32 stream(s8* BufferPCM, u32 Size)
+        {
+            s16* Samples = reinterpret_cast<s16*>(BufferPCM);
+            
+            u32 i = 0;
+            
+            // Fill the buffer with complete frames until the end of the stream
+            for (; i + 4 <= Size && Frame_ < NumFrames_; i += 4, ++Frame_)
+            {
+                const s16 Sample = static_cast<s16>(sin(2.0 * math::PI * Frequency_ * Frame_ / SampleRate_) * 8000.0);
+                *Samples++ = Sample;
+                *Samples++ = Sample;
+            }
+            
+            return i;
+        }
+        
+        bool rewind()
+        {
+            Frame_ = 0;
+            return true;
+        }
+        
+    private:
+        
+        f32 Frequency_;
+        f32 Duration_;
+        u32 Frame_;
+        u32 NumFrames_;
+        
+};
+
+
+/*
+ * Main function
+ */
+
+int main()
+{
+    SP_TESTS_INIT("AudioStream")
+    
+    const u32 NumStreams = 16;
+    
+    // The streams must outlive the service which streams them
+    std::vector< boost::shared_ptr<SineAudioStream> > Streams;
+    std::vector<audio::AudioStreamChannel*> Channels;
+    
+    audio::AudioStreamService StreamService;
+    
+    // Create the streams (the first half loops, the other half has finished after 10 seconds)
+    for (u32 i = 0; i < NumStreams; ++i)
+    {
+        boost::shared_ptr<SineAudioStream> Stream(
+            new SineAudioStream(220.0f + i * 20.0f, (i < NumStreams/2 ? 3.0f : 10.0f))
+        );
+        Stream->openFile("");
+        
+        Streams.push_back(Stream);
+        Channels.push_back(StreamService.createStream(Stream.get(), 0.5f, i < NumStreams/2));
+    }
+    
+    // Read the streams in real-time with a reused buffer (this is what the playback thread does)
+    std::vector<s8> BufferPCM(44100 * 4);
+    
+    io::Timer Clock(true);
+    Clock.resetClockCounter();
+    
+    u64 NumReadFrames = 0;
+    
+    SP_TESTS_MAIN_BEGIN
+    {
+        const u64 ElapsedFrames = Clock.getElapsedMicroseconds() * 44100 / 1000000;
+        const u32 NumFrames = static_cast<u32>(math::Min<u64>(ElapsedFrames - NumReadFrames, 44100));
+        
+        NumReadFrames += NumFrames;
+        
+        // Change the audibility (e.g. the distance to the listener) to change the decoding order
+        const f32 Time = static_cast<f32>(NumReadFrames) / 44100;
+        
+        for (u32 i = 0; i < NumStreams; ++i)
+        {
+            Channels[i]->setPriority(math::Max(0.0f, math::Sin(Time * 20.0f + i * 22.5f)));
+            Channels[i]->read(&BufferPCM[0], NumFrames);
+        }
+        
+        // Draw stream states
+        for (u32 i = 0; i < NumStreams; ++i)
+        {
+            const audio::AudioStreamChannel* Channel = Channels[i];
+            
+            Draw2DText(
+                dim::point2di(15, 15 + i*20),
+                "Stream " + io::stringc(i) + ": Buffered = " + io::stringc(Channel->getNumBufferedFrames()) +
+                "/" + io::stringc(Channel->getCapacity()) + ", Priority = " + io::stringc(Channel->getPriority()) +
+                ", Underruns = " + io::stringc(Channel->getNumUnderruns()) +
+                (Channel->empty() ? ", Finished" : "")
+            );
+        }
+        
+        Draw2DText(
+            dim::point2di(15, 15 + NumStreams*20),
+            "Decoded: " + io::stringc(StreamService.getNumDecodedBytes() / 1024) + " KB"
+        );
+    }
+    SP_TESTS_MAIN_END
+}
@@ -0,0 +1,113 @@
+//
+// SoftPixel Engine - AutoInstancing Tests
+//
+
+#include <SoftPixelEngine.hpp>
+
+using namespace sp;
+
+#include "../common.hpp"
+
+SP_TESTS_DECLARE
+
+static const u32 MAX_INSTANCES = 128;
+
+/*
+ * Shader callbacks
+ */
+
+void ShaderObjectCallback(video::ShaderClass* ShdClass, const scene::MaterialNode* Object)
+{
+    // Single (non-instanced) draw calls use the world matrix of the scene graph
+    const dim::matrix4f Identity;
+    ShdClass->getVertexShader()->setConstant("WorldMatrices", Identity.getArray(), 16);
+}
+
+void ShaderInstanceCallback(video::ShaderClass* ShdClass, const dim::matrix4f* WorldMatrices, u32 NumInstances)
+{
+    ShdClass->getVertexShader()->setConstant("WorldMatrices", WorldMatrices[0].getArray(), NumInstances * 16);
+}
+
+
+/*
+ * Main function
+ */
+
+int main()
+{
+    SP_TESTS_INIT("AutoInstancing")
+    
+    const io::stringc RootPath = ROOT_PATH + "AutoInstancingTests/";
+    
+    // Load instancing shader
+    video::ShaderClass* ShdClass = spRenderer->createShaderClass();
+    
+    spRenderer->loadShader(ShdClass, video::SHADER_VERTEX, video::GLSL_VERSION_1_20, RootPath + "AutoInstancing.glvert");
+    spRenderer->loadShader(ShdClass, video::SHADER_PIXEL, video::GLSL_VERSION_1_20, RootPath + "AutoInstancing.glfrag");
+    
+    if (!ShdClass->compile())
+        return Fatal("Compiling instancing shader failed");
+    
+    ShdClass->setObjectCallback(ShaderObjectCallback);
+    ShdClass->setInstanceCallback(ShaderInstanceCallback, MAX_INSTANCES);
+    
+    ShdClass->getPixelShader()->setConstant("Color", dim::vector4df(0.4f, 0.7f, 1.0f, 1.0f));
+    
+    // Create many props which share the same mesh buffer and material
+    scene::Mesh* RefModel = spScene->createMesh(scene::MESH_CUBE);
+    RefModel->setShaderClass(ShdClass);
+    RefModel->setVisible(false);
+    
+    const s32 GridSize = 40;
+    
+    for (s32 z = -GridSize/2; z < GridSize/2; ++z)
+    {
+        for (s32 x = -GridSize/2; x < GridSize/2; ++x)
+        {
+            scene::Mesh* Obj = spScene->createMesh();
+            Obj->setReference(RefModel, false, true);
+            Obj->setShaderClass(ShdClass);
+            Obj->setPosition(dim::vector3df(x * 2.0f, -3.0f, z * 2.0f + 40.0f));
+            Obj->setRotation(dim::vector3df(0, math::Randomizer::randFloat(0.0f, 360.0f), 0));
+        }
+    }
+    
+    // Keep the instances together in the render list
+    spScene->setDepthSorting(false);
+    spScene->sortRenderList(scene::RENDERLIST_SORT_MESHBUFFER);
+    spScene->setAutoInstancing(true);
+    
+    io::Timer Clock(true);
+    
+    SP_TESTS_MAIN_BEGIN
+    {
+        if (spControl->keyHit(io::KEY_SPACE))
+            spScene->setAutoInstancing(!spScene->getAutoInstancing());
+        
+        // Measure the CPU time of the scene rendering (the draw call counter is reset when the buffers are flipped)
+        Clock.resetClockCounter();
+        
+        spScene->renderScene();
+        
+        const u64 RenderTime = Clock.getElapsedMicroseconds();
+        const u32 NumDrawCalls = video::RenderSystem::getNumDrawCalls();
+        
+        const scene::SInstancingStats &Stats = spScene->getInstancingStats();
+        
+        // Draw the statistics
+        Draw2DText(
+            dim::point2di(15, 15),
+            "Auto instancing: " + io::stringc(spScene->getAutoInstancing() ? "Enabled" : "Disabled") + " (Press Space)"
+        );
+        Draw2DText(
+            dim::point2di(15, 40),
+            "Draw calls: " + io::stringc(NumDrawCalls) + ", CPU time: " + io::stringc(RenderTime) + " us"
+        );
+        Draw2DText(
+            dim::point2di(15, 65),
+            "Batches: " + io::stringc(Stats.NumBatches) + ", Instances: " + io::stringc(Stats.NumInstances) +
+            ", Draw calls saved: " + io::stringc(Stats.NumDrawCallsSaved)
+        );
+    }
+    SP_TESTS_MAIN_END
+}
@@ -0,0 +1,91 @@
+//
+// SoftPixel Engine - Batch2D Tests
+//
+
+#include <SoftPixelEngine.hpp>
+
+using namespace sp;
+
+#include "../common.hpp"
+
+SP_TESTS_DECLARE
+
+/*
+ * Global members
+ */
+
+const s32 NUM_IMAGES        = 2000;
+const s32 NUM_RECTANGLES    = 500;
+const s32 NUM_TEXTS         = 50;
+
+
+/*
+ * Main function
+ */
+
+int main()
+{
+    SP_TESTS_INIT("Batch2D")
+    
+    const io::stringc MediaPath = ROOT_PATH + "Media/";
+    
+    video::Texture* Tex = spRenderer->loadTexture(MediaPath + "Spark1.jpg");
+    
+    io::Timer Timer(true);
+    
+    f32 Angle = 0.0f;
+    
+    // Main loop
+    SP_TESTS_MAIN_BEGIN
+    {
+        Angle += 0.5f;
+        
+        math::Randomizer::seedRandom(false);
+        
+        Timer.resetClockCounter();
+        const u32 PrevNumDrawCalls = video::RenderSystem::getNumDrawCalls();
+        
+        spRenderer->beginDrawing2D();
+        
+        // Draw many solid rectangles, images and texts. Consecutive drawings with the same texture are merged into one draw call
+        for (s32 i = 0; i < NUM_RECTANGLES; ++i)
+        {
+            const dim::point2di Pos(math::Randomizer::randInt(0, 1000), math::Randomizer::randInt(0, 740));
+            spRenderer->draw2DRectangle(dim::rect2di(Pos.X, Pos.Y, Pos.X + 24, Pos.Y + 24), math::Randomizer::randColor());
+        }
+        
+        for (s32 i = 0; i < NUM_IMAGES; ++i)
+        {
+            const dim::point2di Pos(math::Randomizer::randInt(0, 1024), math::Randomizer::randInt(0, 768));
+            spRenderer->draw2DImage(Tex, Pos, Angle + i, 16.0f, math::Randomizer::randColor());
+        }
+        
+        for (s32 i = 0; i < NUM_TEXTS; ++i)
+        {
+            const dim::point2di Pos(math::Randomizer::randInt(0, 900), math::Randomizer::randInt(0, 740));
+            spRenderer->draw2DText(Fnt, Pos, "Batched Text", math::Randomizer::randColor());
+        }
+        
+        // Changing the clipping rectangle splits the batch
+        spRenderer->setClipping(true, dim::point2di(300, 200), dim::size2di(424, 368));
+        spRenderer->draw2DRectangle(dim::rect2di(0, 0, 1024, 768), video::color(0, 0, 0, 128));
+        spRenderer->setClipping(false, 0, 0);
+        
+        spRenderer->flush2DDrawing();
+        
+        const u32 NumDrawCalls = video::RenderSystem::getNumDrawCalls() - PrevNumDrawCalls;
+        const u64 DrawTime = Timer.getElapsedMicroseconds();
+        
+        spRenderer->endDrawing2D();
+        
+        tool::Toolset::drawDebugInfo(Fnt);
+        
+        Draw2DText(dim::point2di(15, 225), "Draw Calls: " + io::stringc(NumDrawCalls));
+        Draw2DText(dim::point2di(15, 250), "2D Drawing Time: " + io::stringc(DrawTime) + " us");
+    }
+    SP_TESTS_MAIN_END
+}
+
+
+
+// ================================================================================
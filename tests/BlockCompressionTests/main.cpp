@@ -0,0 +1,140 @@
+//
+// SoftPixel Engine - BlockCompression Tests
+//
+
+#include <SoftPixelEngine.hpp>
+#include <boost/foreach.hpp>
+
+using namespace sp;
+
+#include "../common.hpp"
+
+SP_TESTS_DECLARE
+
+/*
+ * Global members
+ */
+
+struct SResult
+{
+    io::stringc Name;
+    f64 MPixelsPerSec;
+    f64 PSNR;
+};
+
+std::vector<SResult> Results;
+
+void BenchmarkFormat(
+    const u8* ImageBuffer, const dim::size2di &Size, const video::EBlockCompressionFormats Format,
+    const video::EBlockCompressionQualities Quality, const io::stringc &Name)
+{
+    std::vector<u8> Blocks(video::BlockCompression::getCompressedSize(Format, Size));
+    std::vector<u8> Decoded(Size.getArea() * 4);
+    
+    // Compress the image and measure the throughput
+    const u64 StartTime = io::Timer::microsecs();
+    
+    video::BlockCompression::compressImage(
+        ImageBuffer, Size, video::PIXELFORMAT_RGBA, Format, &Blocks[0], Quality
+    );
+    
+    const u64 Duration = math::Max<u64>(1, io::Timer::microsecs() - StartTime);
+    
+    // Decompress the image and measure the quality
+    video::BlockCompression::decompressImage(&Blocks[0], Size, Format, &Decoded[0]);
+    
+    SResult Result;
+    {
+        Result.Name             = Name;
+        Result.MPixelsPerSec    = static_cast<f64>(Size.getArea()) / static_cast<f64>(Duration);
+        Result.PSNR             = video::BlockCompression::getPSNR(ImageBuffer, &Decoded[0], Size.getArea(), Format);
+    }
+    Results.push_back(Result);
+    
+    io::Log::message(
+        Name + ": " + io::stringc(Result.MPixelsPerSec) + " MPixel/s, PSNR = " + io::stringc(Result.PSNR) + " dB"
+    );
+}
+
+
+/*
+ * Main function
+ */
+
+int main()
+{
+    SP_TESTS_INIT("BlockCompression")
+    
+    const io::stringc MediaPath = ROOT_PATH + "Media/";
+    
+    // Benchmark the encoder with all formats and qualities
+    video::Texture* RefTex = spRenderer->loadTexture(MediaPath + "FloorBricks1.jpg");
+    RefTex->setFormat(video::PIXELFORMAT_RGBA);
+    
+    const u8* ImageBuffer = static_cast<const u8*>(RefTex->getImageBuffer()->getBuffer());
+    const dim::size2di Size(RefTex->getSize());
+    
+    const video::EBlockCompressionFormats Formats[] = {
+        video::BLOCKCOMPRESSION_BC1, video::BLOCKCOMPRESSION_BC3, video::BLOCKCOMPRESSION_BC5
+    };
+    const video::EBlockCompressionQualities Qualities[] = {
+        video::BLOCKQUALITY_FAST, video::BLOCKQUALITY_NORMAL, video::BLOCKQUALITY_HIGH
+    };
+    const io::stringc FormatNames[] = { "BC1", "BC3", "BC5" };
+    const io::stringc QualityNames[] = { "Fast", "Normal", "High" };
+    
+    for (s32 i = 0; i < 3; ++i)
+    {
+        for (s32 j = 0; j < 3; ++j)
+            BenchmarkFormat(ImageBuffer, Size, Formats[i], Qualities[j], FormatNames[i] + " " + QualityNames[j]);
+    }
+    
+    // Create cubes with uncompressed and compressed textures
+    spRenderer->setTextureCompressionQuality(video::BLOCKQUALITY_HIGH);
+    
+    const video::EBlockCompressionFormats CubeFormats[] = {
+        video::BLOCKCOMPRESSION_NONE, video::BLOCKCOMPRESSION_BC1, video::BLOCKCOMPRESSION_BC3
+    };
+    
+    std::vector<scene::Mesh*> Cubes;
+    
+    for (s32 i = 0; i < 3; ++i)
+    {
+        video::Texture* Tex = spRenderer->loadTexture(MediaPath + "FloorBricks1.jpg");
+        Tex->setCompression(CubeFormats[i]);
+        
+        scene::Mesh* Obj = spScene->createMesh(scene::MESH_CUBE);
+        Obj->setPosition(dim::vector3df(static_cast<f32>(i - 1) * 1.5f, 0, 3));
+        Obj->addTexture(Tex);
+        
+        Cubes.push_back(Obj);
+    }
+    
+    // Main loop
+    SP_TESTS_MAIN_BEGIN
+    {
+        foreach (scene::Mesh* Obj, Cubes)
+            Obj->turn(dim::vector3df(0, 0.5f, 0));
+        
+        spScene->renderScene();
+        
+        // Draw benchmark results
+        for (u32 i = 0; i < Results.size(); ++i)
+        {
+            Draw2DText(
+                dim::point2di(15, 15 + i*25),
+                Results[i].Name + ": " + io::stringc(Results[i].MPixelsPerSec) +
+                " MPixel/s, PSNR = " + io::stringc(Results[i].PSNR) + " dB"
+            );
+        }
+        
+        Draw2DText(
+            dim::point2di(15, 15 + Results.size()*25),
+            "Cubes: Uncompressed, BC1, BC3 (compression " +
+            io::stringc(spRenderer->queryVideoSupport(video::VIDEOSUPPORT_TEXTURE_COMPRESSION) ? "supported" : "not supported") + ")"
+        );
+        
+        DrawFPS(dim::point2di(15, 40 + Results.size()*25));
+    }
+    SP_TESTS_MAIN_END
+}
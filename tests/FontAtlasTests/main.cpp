@@ -0,0 +1,167 @@
+//
+// SoftPixel Engine - FontAtlas Tests
+//
+
+#include <SoftPixelEngine.hpp>
+
+using namespace sp;
+
+#include "../common.hpp"
+
+SP_TESTS_DECLARE
+
+/*
+ * Procedural glyph rasterizer (works on each platform)
+ */
+
+class BoxGlyphRasterizer : public video::GlyphRasterizer
+{
+    
+    public:
+        
+        bool rasterize(u32 Char, video::SFontGlyph &Metrics, dim::size2di &ImageSize, std::vector<u8> &Image)
+        {
+            if (Char == ' ')
+            {
+                Metrics.WhiteSpace = 8;
+                ImageSize = dim::size2di(0, 0);
+                return true;
+            }
+            
+            /* Draw a box with a pattern which depends on the character */
+            Metrics.StartOffset = 1;
+            Metrics.DrawnWidth  = 14;
+            Metrics.WhiteSpace  = 1;
+            
+            ImageSize = dim::size2di(14, 20);
+            Image.resize(ImageSize.getArea());
+            
+            for (s32 y = 0; y < ImageSize.Height; ++y)
+            {
+                for (s32 x = 0; x < ImageSize.Width; ++x)
+                {
+                    const bool isBorder = (x == 0 || y == 0 || x == ImageSize.Width - 1 || y == ImageSize.Height - 1);
+                    const bool isPattern = (((Char >> ((x + y) % 16)) & 1) != 0);
+                    Image[y * ImageSize.Width + x] = (isBorder ? 255 : (isPattern ? 160 : 0));
+                }
+            }
+            
+            return true;
+        }
+        
+        s32 getHeight() const
+        {
+            return 20;
+        }
+        
+};
+
+
+/*
+ * Global members
+ */
+
+const s32 NUM_RANDOM_CHARS = 200;
+
+io::stringc getUTF8(u32 Char)
+{
+    io::stringc Str;
+    
+    if (Char < 0x80)
+        Str += static_cast<c8>(Char);
+    else if (Char < 0x800)
+    {
+        Str += static_cast<c8>(0xC0 | (Char >> 6));
+        Str += static_cast<c8>(0x80 | (Char & 0x3F));
+    }
+    else
+    {
+        Str += static_cast<c8>(0xE0 | (Char >> 12));
+        Str += static_cast<c8>(0x80 | ((Char >> 6) & 0x3F));
+        Str += static_cast<c8>(0x80 | (Char & 0x3F));
+    }
+    
+    return Str;
+}
+
+
+/*
+ * Main function
+ */
+
+int main()
+{
+    SP_TESTS_INIT("FontAtlas")
+    
+    // Create dynamic fonts
+    video::Font* SysFont = spRenderer->createFont("MS Gothic", 24, video::FONT_DYNAMIC);
+    video::Font* BoxFont = spRenderer->createFont(new BoxGlyphRasterizer(), "Boxes", dim::size2di(128));
+    
+    const io::stringc Labels[] =
+    {
+        "Dynamic glyph atlas: AV Wa To",
+        "German: \xC3\x84pfel \xC3\xBC" "ber Stra\xC3\x9F" "e",
+        "Japanese: \xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E\xE3\x81\xAE\xE3\x83\x86\xE3\x82\xAD\xE3\x82\xB9\xE3\x83\x88",
+        "Chinese: \xE4\xBD\xA0\xE5\xA5\xBD\xEF\xBC\x8C\xE4\xB8\x96\xE7\x95\x8C"
+    };
+    
+    // Main loop
+    SP_TESTS_MAIN_BEGIN
+    {
+        spRenderer->beginDrawing2D();
+        
+        // Draw repeated labels (layouts are cached)
+        for (s32 i = 0; i < 4; ++i)
+        {
+            spRenderer->draw2DText(SysFont, dim::point2di(15, 15 + i*35), Labels[i], video::color(255));
+            spRenderer->draw2DText(
+                SysFont, dim::point2di(1009, 15 + i*35), Labels[i], video::color(255, 255, 0), video::TEXT_RIGHT_ALIGN
+            );
+        }
+        
+        // Draw random CJK characters with a small atlas (forces eviction)
+        io::stringc RandomText;
+        
+        for (s32 i = 0; i < NUM_RANDOM_CHARS; ++i)
+        {
+            RandomText += getUTF8(0x4E00 + math::Randomizer::randInt(0, 2000));
+            
+            if ((i + 1) % 50 == 0)
+            {
+                spRenderer->draw2DText(BoxFont, dim::point2di(15, 200 + i/50*25), RandomText, video::color(100, 200, 255));
+                RandomText = "";
+            }
+        }
+        
+        // Draw atlas textures
+        if (SysFont->getTexture())
+            spRenderer->draw2DImage(SysFont->getTexture(), dim::rect2di(15, 320, 256, 256));
+        if (BoxFont->getTexture())
+            spRenderer->draw2DImage(BoxFont->getTexture(), dim::rect2di(300, 320, 256, 256));
+        
+        // Draw statistics
+        const video::FontAtlas* Atlas = BoxFont->getAtlas();
+        
+        Draw2DText(
+            dim::point2di(15, 600),
+            "Box font: rasterized " + io::stringc(Atlas->getNumRasterizedGlyphs()) +
+            ", evictions " + io::stringc(Atlas->getNumEvictions())
+        );
+        
+        if (SysFont->getAtlas())
+        {
+            Atlas = SysFont->getAtlas();
+            Draw2DText(
+                dim::point2di(15, 625),
+                "System font: rasterized " + io::stringc(Atlas->getNumRasterizedGlyphs()) +
+                ", layout hits " + io::stringc(Atlas->getNumLayoutHits()) +
+                ", layout misses " + io::stringc(Atlas->getNumLayoutMisses())
+            );
+        }
+        
+        spRenderer->endDrawing2D();
+        
+        DrawFPS(dim::point2di(15, 650));
+    }
+    SP_TESTS_MAIN_END
+}
@@ -0,0 +1,134 @@
+//
+// SoftPixel Engine - MeshLoaderOBJ Tests
+//
+
+#include <SoftPixelEngine.hpp>
+
+using namespace sp;
+
+#include "../common.hpp"
+
+SP_TESTS_DECLARE
+
+/*
+ * Global members
+ */
+
+const s32 GRID_SIZE     = 256;
+const s32 NUM_GROUPS    = 8;
+
+// Writes a large grid model with texture coordinates, normals and several groups
+static u32 createTestFile(const io::stringc &Filename)
+{
+    std::string Content;
+    c8 Line[256];
+    
+    Content += "# Generated OBJ benchmark model\no Grid\n";
+    
+    for (s32 z = 0; z <= GRID_SIZE; ++z)
+    {
+        for (s32 x = 0; x <= GRID_SIZE; ++x)
+        {
+            const f32 u = static_cast<f32>(x) / GRID_SIZE;
+            const f32 v = static_cast<f32>(z) / GRID_SIZE;
+            
+            sprintf(
+                Line, "v %f %f %f\nvt %f %f\nvn 0.000000 1.000000 0.000000\n",
+                (u - 0.5f) * 10.0f, math::Sin(u * 1440.0f) * math::Cos(v * 1440.0f) * 0.25f, (v - 0.5f) * 10.0f, u, v
+            );
+            Content += Line;
+        }
+    }
+    
+    for (s32 z = 0; z < GRID_SIZE; ++z)
+    {
+        if (z % (GRID_SIZE / NUM_GROUPS) == 0)
+        {
+            sprintf(Line, "g Rows%d\n", z);
+            Content += Line;
+        }
+        
+        for (s32 x = 0; x < GRID_SIZE; ++x)
+        {
+            const s32 i = z * (GRID_SIZE + 1) + x + 1;
+            const s32 j = i + GRID_SIZE + 1;
+            
+            sprintf(Line, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", i, i, i, j, j, j, j + 1, j + 1, j + 1, i + 1, i + 1, i + 1);
+            Content += Line;
+        }
+    }
+    
+    io::FileSystem FileSys;
+    io::File* TestFile = FileSys.openFile(Filename, io::FILE_WRITE);
+    
+    if (!TestFile)
+        return 0;
+    
+    TestFile->writeBuffer(Content.c_str(), Content.size());
+    FileSys.closeFile(TestFile);
+    
+    return Content.size();
+}
+
+// Loads the model and returns the throughput (in MB/s)
+static f32 benchmark(const io::stringc &Filename, u32 FileSize, s32 Flags, scene::Mesh* &Obj)
+{
+    const u64 StartTime = io::Timer::microsecs();
+    
+    Obj = spScene->loadMesh(Filename, "", scene::MESHFORMAT_OBJ, Flags);
+    
+    const u64 Duration = math::Max(static_cast<u64>(1), io::Timer::microsecs() - StartTime);
+    
+    return static_cast<f32>(FileSize) / Duration;
+}
+
+
+/*
+ * Main function
+ */
+
+int main()
+{
+    SP_TESTS_INIT("MeshLoaderOBJ")
+    
+    const io::stringc Filename = "MeshLoaderOBJTest.obj";
+    const u32 FileSize = createTestFile(Filename);
+    
+    // Compare the line-by-line parser with the parallel chunk parser
+    scene::Mesh* LineObj = 0;
+    scene::Mesh* ChunkObj = 0;
+    
+    const f32 LineThroughput = benchmark(Filename, FileSize, scene::MESHFLAG_LINE_BY_LINE_PARSING, LineObj);
+    const f32 ChunkThroughput = benchmark(Filename, FileSize, 0, ChunkObj);
+    
+    io::Log::message("Line-by-line parser: " + io::stringc(LineThroughput) + " MB/s");
+    io::Log::message("Parallel chunk parser: " + io::stringc(ChunkThroughput) + " MB/s");
+    
+    LineObj->setPosition(dim::vector3df(-6, -2, 10));
+    ChunkObj->setPosition(dim::vector3df(6, -2, 10));
+    
+    spScene->createLight();
+    
+    SP_TESTS_MAIN_BEGIN
+    {
+        tool::Toolset::moveCameraFree();
+        
+        spScene->renderScene();
+        
+        Draw2DText(
+            dim::point2di(15, 15),
+            "File size: " + io::stringc(FileSize / 1024) + " KB"
+        );
+        Draw2DText(
+            dim::point2di(15, 40),
+            "Line-by-line parser: " + io::stringc(LineThroughput) + " MB/s, " +
+            io::stringc(LineObj->getVertexCount()) + " vertices"
+        );
+        Draw2DText(
+            dim::point2di(15, 65),
+            "Parallel chunk parser: " + io::stringc(ChunkThroughput) + " MB/s, " +
+            io::stringc(ChunkObj->getVertexCount()) + " vertices"
+        );
+    }
+    SP_TESTS_MAIN_END
+}
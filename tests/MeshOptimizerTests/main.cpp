@@ -0,0 +1,88 @@
+//
+// SoftPixel Engine - MeshOptimizer Tests
+//
+
+#include <SoftPixelEngine.hpp>
+
+using namespace sp;
+
+#include "../common.hpp"
+
+SP_TESTS_DECLARE
+
+static void shuffleTriangles(video::MeshBuffer* Surface)
+{
+    const u32 TriCount = Surface->getTriangleCount();
+    
+    u32 IndicesA[3], IndicesB[3];
+    
+    for (u32 i = TriCount - 1; i > 0; --i)
+    {
+        const u32 j = math::Randomizer::randInt(0, i);
+        
+        Surface->getTriangleIndices(i, IndicesA);
+        Surface->getTriangleIndices(j, IndicesB);
+        
+        Surface->setTriangleIndices(i, IndicesB);
+        Surface->setTriangleIndices(j, IndicesA);
+    }
+    
+    Surface->updateIndexBuffer();
+}
+
+int main()
+{
+    SP_TESTS_INIT("MeshOptimizer")
+    
+    // Create a dense mesh and scramble its triangle order
+    scene::Mesh* Obj = spScene->createMesh(scene::MESH_TEAPOT);
+    Obj->setPosition(dim::vector3df(0, 0, 3));
+    
+    video::MeshBuffer* Surface = Obj->getMeshBuffer(0);
+    
+    shuffleTriangles(Surface);
+    
+    spScene->createLight();
+    
+    // Only measure the vertex cache efficiency (no optimization flags)
+    video::SMeshOptimizationStats Stats;
+    video::MeshBufferOptimizer::optimizeMeshBuffer(*Surface, 0, video::MeshBufferOptimizer::DEF_VERTEX_CACHE_SIZE, &Stats);
+    
+    SP_TESTS_MAIN_BEGIN
+    {
+        if (spContext->isWindowActive())
+            tool::Toolset::moveCameraFree(0, 0.25f);
+        
+        // Optimize the triangle and vertex order
+        if (spControl->keyHit(io::KEY_SPACE))
+        {
+            Stats = Surface->optimizeForVertexCache();
+            Surface->optimizeVertexFetch();
+        }
+        
+        // Scramble the triangle order again
+        if (spControl->keyHit(io::KEY_RETURN))
+        {
+            shuffleTriangles(Surface);
+            video::MeshBufferOptimizer::optimizeMeshBuffer(*Surface, 0, video::MeshBufferOptimizer::DEF_VERTEX_CACHE_SIZE, &Stats);
+        }
+        
+        Obj->turn(dim::vector3df(0, 0.5f, 0));
+        
+        spScene->renderScene();
+        
+        Draw2DText(
+            dim::point2di(15, 15),
+            "Optimize (Press Space), Shuffle Triangles (Press Return), Triangles: " + io::stringc(Stats.NumTriangles)
+        );
+        Draw2DText(
+            dim::point2di(15, 40),
+            "ACMR: " + io::stringc(Stats.ACMRBefore) + " -> " + io::stringc(Stats.ACMRAfter)
+        );
+        Draw2DText(
+            dim::point2di(15, 65),
+            "ATVR: " + io::stringc(Stats.ATVRBefore) + " -> " + io::stringc(Stats.ATVRAfter)
+        );
+    }
+    SP_TESTS_MAIN_END
+}
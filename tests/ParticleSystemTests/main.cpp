@@ -0,0 +1,107 @@
+//
+// SoftPixel Engine - ParticleSystem Tests
+//
+
+#include <SoftPixelEngine.hpp>
+
+using namespace sp;
+
+#include "../common.hpp"
+
+SP_TESTS_DECLARE
+
+#ifdef SP_COMPILE_WITH_PARTICLEANIMATOR
+
+/*
+ * Global members
+ */
+
+const u32 NUM_PARTICLES = 100000;
+const u32 NUM_THREADS   = 4;
+
+
+/*
+ * Main function
+ */
+
+int main()
+{
+    SP_TESTS_INIT("ParticleSystem")
+    
+    const io::stringc MediaPath = ROOT_PATH + "Media/";
+    
+    // Create particle system with 100k particles
+    tool::SParticleSystemDesc Desc;
+    {
+        Desc.Capacity       = NUM_PARTICLES;
+        Desc.EmissionRate   = NUM_PARTICLES / 3.0f;
+        Desc.MinLifeTime    = 2.0f;
+        Desc.MaxLifeTime    = 3.0f;
+        Desc.PositionSpread = dim::vector3df(0.25f, 0.0f, 0.25f);
+        Desc.Velocity       = dim::vector3df(0.0f, 4.0f, 0.0f);
+        Desc.VelocitySpread = dim::vector3df(1.5f, 1.0f, 1.5f);
+        Desc.Gravity        = dim::vector3df(0.0f, -2.0f, 0.0f);
+        Desc.StartSize      = 0.05f;
+        Desc.EndSize        = 0.15f;
+        Desc.StartColor     = video::color(255, 200, 50, 255);
+        Desc.EndColor       = video::color(255, 50, 0, 0);
+    }
+    tool::ParticleSystem* Particles = new tool::ParticleSystem(Desc);
+    
+    Particles->setThreadCount(NUM_THREADS);
+    Particles->setTexture(spRenderer->loadTexture(MediaPath + "Spark1.jpg"));
+    Particles->setPosition(dim::vector3df(0, -2, 5));
+    Particles->getMaterial()->setBlendingMode(video::BLEND_SRCALPHA, video::BLEND_ONE);
+    
+    spScene->addSceneNode(static_cast<scene::RenderNode*>(Particles));
+    
+    io::Timer Timer(true);
+    
+    // Main loop
+    while (spDevice->updateEvents() && !spControl->keyDown(io::KEY_ESCAPE))
+    {
+        spRenderer->clearBuffers();
+        
+        if (spContext->isWindowActive())
+            tool::Toolset::moveCameraFree();
+        
+        // Update particles
+        Timer.resetClockCounter();
+        Particles->update(1.0f / 60.0f);
+        const u64 UpdateTime = Timer.getElapsedMicroseconds();
+        
+        // Draw scene
+        Timer.resetClockCounter();
+        spScene->renderScene();
+        const u64 RenderTime = Timer.getElapsedMicroseconds();
+        
+        tool::Toolset::drawDebugInfo(Fnt);
+        
+        Draw2DText(dim::point2di(15, 225), "Particles: "         + io::stringc(Particles->getNumParticles()));
+        Draw2DText(dim::point2di(15, 250), "Update Time: "       + io::stringc(UpdateTime) + " us");
+        Draw2DText(dim::point2di(15, 275), "Scene Render Time: " + io::stringc(RenderTime) + " us");
+        
+        spContext->flipBuffers();
+    }
+    
+    spScene->removeSceneNode(static_cast<scene::RenderNode*>(Particles));
+    delete Particles;
+    
+    deleteDevice();
+    
+    return 0;
+}
+
+#else
+
+int main()
+{
+    io::Log::error("This engine was not compiled with particle animator utility");
+    return 0;
+}
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,345 @@
+//
+// SoftPixel Engine - PathFinding Tests
+//
+
+#include <SoftPixelEngine.hpp>
+
+using namespace sp;
+
+#ifdef SP_COMPILE_WITH_PATHFINDER
+
+/*
+ * Global members
+ */
+
+const s32 GRID_SIZE         = 256;
+const u32 NUM_QUERIES       = 200;
+const u32 NUM_THREADS       = 4;
+const u32 NUM_POSITIONS     = 10000;
+
+tool::PathGraph* Graph = 0;
+std::vector<tool::PathNode*> Nodes;
+std::vector< std::pair<u32, u32> > Queries;
+
+
+/*
+ * Multi-threaded queries
+ */
+
+struct SWorkerState
+{
+    u32 FirstQuery;
+    u32 NumQueries;
+    u32 NumFound;
+    volatile bool Finished;
+};
+
+THREAD_PROC(WorkerProc)
+{
+    SWorkerState* State = static_cast<SWorkerState*>(Arguments);
+    
+    /* Each thread uses its own query object */
+    tool::PathQuery Query;
+    std::list<tool::PathNode*> Path;
+    
+    for (u32 i = State->FirstQuery; i < State->FirstQuery + State->NumQueries; ++i)
+    {
+        Path.clear();
+        if (Graph->findPath(Query, Nodes[Queries[i].first], Nodes[Queries[i].second], Path))
+            ++State->NumFound;
+    }
+    
+    State->Finished = true;
+    
+    return 0;
+}
+
+
+/*
+ * Grid path finding
+ */
+
+void testGridPathFinding(s32 Size, std::vector<bool> &Bitmap, const std::vector< std::pair<u32, u32> > &CellQueries)
+{
+    io::Log::message("Grid path finding: " + io::stringc(Size) + " x " + io::stringc(Size));
+    io::Log::upperTab();
+    
+    tool::GridPathGraph Grid;
+    tool::GridPathQuery Query;
+    std::vector<dim::point2di> Path;
+    
+    io::Timer Timer(true);
+    
+    Grid.create(dim::vector3df(0.0f), dim::vector3df(Size, Size, 0), dim::size2di(Size), Bitmap, 16);
+    io::Log::message("Grid and cluster construction: " + io::stringc(Timer.getElapsedMicroseconds() / 1000) + " ms");
+    
+    /* Make sure that start and target cells are walkable */
+    for (u32 i = 0; i < CellQueries.size(); ++i)
+    {
+        Bitmap[CellQueries[i].first ] = true;
+        Bitmap[CellQueries[i].second] = true;
+        Grid.setWalkable(dim::point2di(CellQueries[i].first  % Size, CellQueries[i].first  / Size), true);
+        Grid.setWalkable(dim::point2di(CellQueries[i].second % Size, CellQueries[i].second / Size), true);
+    }
+    
+    Timer.resetClockCounter();
+    const u32 NumRebuilt = Grid.updateClusters();
+    io::Log::message("Incremental cluster update: " + io::stringc(NumRebuilt) + " clusters in " + io::stringc(Timer.getElapsedMicroseconds()) + " us");
+    
+    for (u32 Mode = 0; Mode < 2; ++Mode)
+    {
+        u32 NumFound = 0;
+        u64 NumExpanded = 0, PathLength = 0;
+        
+        Timer.resetClockCounter();
+        
+        for (u32 i = 0; i < CellQueries.size(); ++i)
+        {
+            const dim::point2di From(CellQueries[i].first  % Size, CellQueries[i].first  / Size);
+            const dim::point2di To  (CellQueries[i].second % Size, CellQueries[i].second / Size);
+            
+            const bool Found = (Mode == 0 ? Grid.findPathJPS(Query, From, To, Path) : Grid.findPath(Query, From, To, Path));
+            
+            if (Found)
+            {
+                ++NumFound;
+                PathLength += Path.size();
+            }
+            NumExpanded += Query.getNumExpandedNodes();
+        }
+        
+        const u64 Time = Timer.getElapsedMicroseconds();
+        
+        io::Log::message(
+            io::stringc(Mode == 0 ? "Jump point search: " : "Hierarchical search: ") +
+            io::stringc(Time / CellQueries.size()) + " us per query (" + io::stringc(NumFound) + " paths found, " +
+            io::stringc(NumExpanded / CellQueries.size()) + " expanded nodes, " +
+            io::stringc(NumFound > 0 ? PathLength / NumFound : 0) + " cells per path)"
+        );
+    }
+    
+    io::Log::lowerTab();
+}
+
+
+/*
+ * Main function
+ */
+
+int main()
+{
+    io::Log::message("PathFinding Tests");
+    io::Log::message("Grid size: " + io::stringc(GRID_SIZE) + " x " + io::stringc(GRID_SIZE));
+    
+    /* Create grid with random obstacles */
+    math::Randomizer::seedRandom(false);
+    
+    std::vector<bool> Bitmap(GRID_SIZE*GRID_SIZE);
+    for (u32 i = 0; i < Bitmap.size(); ++i)
+        Bitmap[i] = !math::Randomizer::randBool(5);
+    
+    Graph = new tool::PathGraph();
+    
+    io::Timer Timer(true);
+    
+    Timer.resetClockCounter();
+    Graph->createGrid(
+        dim::vector3df(0.0f), dim::vector3df(GRID_SIZE, GRID_SIZE, 0), dim::vector3di(GRID_SIZE, GRID_SIZE, 1), Bitmap
+    );
+    io::Log::message("Grid construction: " + io::stringc(Timer.getElapsedMicroseconds() / 1000) + " ms");
+    
+    Nodes.assign(Graph->getNodeList().begin(), Graph->getNodeList().end());
+    
+    /* Generate random queries */
+    for (u32 i = 0; i < NUM_QUERIES; ++i)
+    {
+        Queries.push_back(std::make_pair(
+            static_cast<u32>(math::Randomizer::randInt(Nodes.size() - 1)),
+            static_cast<u32>(math::Randomizer::randInt(Nodes.size() - 1))
+        ));
+    }
+    
+    /* Single-threaded queries */
+    tool::PathQuery Query;
+    std::list<tool::PathNode*> Path;
+    
+    u32 NumFound = 0;
+    u64 NumExpanded = 0;
+    
+    Timer.resetClockCounter();
+    
+    for (u32 i = 0; i < NUM_QUERIES; ++i)
+    {
+        Path.clear();
+        if (Graph->findPath(Query, Nodes[Queries[i].first], Nodes[Queries[i].second], Path))
+            ++NumFound;
+        NumExpanded += Query.getNumExpandedNodes();
+    }
+    
+    const u64 SingleTime = Timer.getElapsedMicroseconds();
+    
+    io::Log::message(
+        "Single-threaded: " + io::stringc(NUM_QUERIES) + " queries in " + io::stringc(SingleTime / 1000) + " ms (" +
+        io::stringc(SingleTime / NUM_QUERIES) + " us per query, " + io::stringc(NumFound) + " paths found, " +
+        io::stringc(NumExpanded / NUM_QUERIES) + " expanded nodes per query)"
+    );
+    
+    /* Multi-threaded queries */
+    SWorkerState States[NUM_THREADS];
+    std::vector<ThreadManager*> Threads;
+    
+    Timer.resetClockCounter();
+    
+    for (u32 i = 0; i < NUM_THREADS; ++i)
+    {
+        States[i].FirstQuery    = i * NUM_QUERIES / NUM_THREADS;
+        States[i].NumQueries    = (i + 1) * NUM_QUERIES / NUM_THREADS - States[i].FirstQuery;
+        States[i].NumFound      = 0;
+        States[i].Finished      = false;
+        
+        Threads.push_back(new ThreadManager(WorkerProc, &States[i]));
+    }
+    
+    u32 NumFoundMT = 0;
+    
+    for (u32 i = 0; i < NUM_THREADS; ++i)
+    {
+        while (!States[i].Finished)
+            io::Timer::sleep(1);
+        NumFoundMT += States[i].NumFound;
+    }
+    
+    const u64 MultiTime = Timer.getElapsedMicroseconds();
+    
+    io::Log::message(
+        "Multi-threaded (" + io::stringc(NUM_THREADS) + " threads): " + io::stringc(MultiTime / 1000) + " ms (" +
+        io::stringc(NumFoundMT) + " paths found)"
+    );
+    
+    if (NumFound != NumFoundMT)
+        io::Log::error("Single- and multi-threaded results differ");
+    
+    MemoryManager::deleteList(Threads);
+    
+    /* Snap random positions to their nearest nodes */
+    std::vector<dim::vector3df> Positions(NUM_POSITIONS);
+    std::vector<tool::PathNode*> SnapNodes;
+    
+    for (u32 i = 0; i < NUM_POSITIONS; ++i)
+    {
+        Positions[i] = dim::vector3df(
+            math::Randomizer::randFloat(0.0f, GRID_SIZE), math::Randomizer::randFloat(0.0f, GRID_SIZE), 0.0f
+        );
+    }
+    
+    Timer.resetClockCounter();
+    Graph->findNearestNodes(Positions, SnapNodes);
+    const u64 SnapTime = Timer.getElapsedMicroseconds();
+    
+    /* Compare with a linear search over a few positions */
+    u32 NumSnapErrors = 0;
+    
+    Timer.resetClockCounter();
+    
+    for (u32 i = 0; i < 100; ++i)
+    {
+        tool::PathNode* Nearest = 0;
+        f32 NearestDistSq = 0.0f;
+        
+        for (u32 j = 0; j < Nodes.size(); ++j)
+        {
+            const f32 DistSq = math::getDistanceSq(Positions[i], Nodes[j]->getPosition());
+            if (!Nearest || DistSq < NearestDistSq)
+            {
+                Nearest         = Nodes[j];
+                NearestDistSq   = DistSq;
+            }
+        }
+        
+        if (math::getDistanceSq(Positions[i], SnapNodes[i]->getPosition()) > NearestDistSq)
+            ++NumSnapErrors;
+    }
+    
+    const u64 LinearTime = Timer.getElapsedMicroseconds();
+    
+    io::Log::message(
+        "Nearest node: " + io::stringc(NUM_POSITIONS) + " positions in " + io::stringc(SnapTime / 1000) + " ms (linear search: " +
+        io::stringc(LinearTime / 100) + " us per position, " + io::stringc(NumSnapErrors) + " errors)"
+    );
+    
+    /* Move all query start nodes to the same goal with a flow field */
+    tool::PathNode* Goal = Nodes[Queries[0].second];
+    
+    Graph->setFlowFieldThreadCount(NUM_THREADS);
+    
+    Timer.resetClockCounter();
+    const tool::PathFlowField* FlowField = Graph->getFlowField(Goal);
+    const u64 FieldTime = Timer.getElapsedMicroseconds();
+    
+    u32 NumReached = 0;
+    u64 NumSteps = 0;
+    
+    Timer.resetClockCounter();
+    
+    for (u32 i = 0; i < NUM_QUERIES; ++i)
+    {
+        const tool::PathNode* Node = Nodes[Queries[i].first];
+        
+        while (Node && Node != Goal)
+        {
+            Node = FlowField->getNextNode(Node);
+            ++NumSteps;
+        }
+        
+        if (Node == Goal)
+            ++NumReached;
+    }
+    
+    const u64 WalkTime = Timer.getElapsedMicroseconds();
+    
+    io::Log::message(
+        "Flow field: built in " + io::stringc(FieldTime / 1000) + " ms, " + io::stringc(NUM_QUERIES) + " agents walked " +
+        io::stringc(NumSteps) + " steps in " + io::stringc(WalkTime) + " us (" + io::stringc(NumReached) + " reached the goal)"
+    );
+    
+    delete Graph;
+    
+    /* Grid path finding with the same grid and queries */
+    testGridPathFinding(GRID_SIZE, Bitmap, Queries);
+    
+    /* Grid path finding with a large grid */
+    const s32 LargeGridSize = 1024;
+    
+    Bitmap.resize(LargeGridSize*LargeGridSize);
+    for (u32 i = 0; i < Bitmap.size(); ++i)
+        Bitmap[i] = !math::Randomizer::randBool(5);
+    
+    Queries.clear();
+    for (u32 i = 0; i < NUM_QUERIES; ++i)
+    {
+        Queries.push_back(std::make_pair(
+            static_cast<u32>(math::Randomizer::randInt(Bitmap.size() - 1)),
+            static_cast<u32>(math::Randomizer::randInt(Bitmap.size() - 1))
+        ));
+    }
+    
+    testGridPathFinding(LargeGridSize, Bitmap, Queries);
+    
+    io::Log::pauseConsole();
+    
+    return 0;
+}
+
+#else
+
+int main()
+{
+    io::Log::error("This engine was not compiled with path finder utility");
+    return 0;
+}
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,75 @@
+//
+// SoftPixel Engine - Profiler Tests
+//
+
+#include <SoftPixelEngine.hpp>
+
+using namespace sp;
+
+#include "../common.hpp"
+
+SP_TESTS_DECLARE
+
+static void updateScene(std::vector<scene::Mesh*> &Objects)
+{
+    SP_PROFILE_SCOPE("updateScene");
+    
+    for (u32 i = 0; i < Objects.size(); ++i)
+    {
+        SP_PROFILE_SCOPE("turnObject");
+        Objects[i]->turn(dim::vector3df(0, 1.0f + (i % 5), 0));
+    }
+}
+
+int main()
+{
+    SP_TESTS_INIT("Profiler")
+    
+    // Create a few meshes
+    std::vector<scene::Mesh*> Objects;
+    
+    for (s32 z = -5; z < 5; ++z)
+    {
+        for (s32 x = -5; x < 5; ++x)
+        {
+            scene::Mesh* Obj = spScene->createMesh(scene::MESH_TEAPOT);
+            Obj->setPosition(dim::vector3df(x * 2.5f, -2.0f, z * 2.5f + 25.0f));
+            Objects.push_back(Obj);
+        }
+    }
+    
+    spScene->createLight();
+    
+    io::Profiler::setEnabled(true);
+    
+    SP_TESTS_MAIN_BEGIN
+    {
+        if (spContext->isWindowActive())
+            tool::Toolset::moveCameraFree(0, 0.25f);
+        
+        // Toggle the profiler
+        if (spControl->keyHit(io::KEY_SPACE))
+            io::Profiler::setEnabled(!io::Profiler::getEnabled());
+        
+        // Export the last frames (open the file with "chrome://tracing")
+        if (spControl->keyHit(io::KEY_RETURN))
+            io::Profiler::exportChromeTrace("ProfilerTrace.json");
+        
+        updateScene(Objects);
+        
+        spScene->renderScene();
+        
+        io::Profiler::drawOverlay(Fnt, dim::point2di(15, 65));
+        
+        Draw2DText(
+            dim::point2di(15, 15),
+            "Profiler: " + io::stringc(io::Profiler::getEnabled() ? "Enabled" : "Disabled") +
+            " (Press Space), Export Chrome Trace (Press Return)"
+        );
+        Draw2DText(
+            dim::point2di(15, 40),
+            "Frames in History: " + io::stringc(io::Profiler::getFrameHistory().size())
+        );
+    }
+    SP_TESTS_MAIN_END
+}
@@ -0,0 +1,76 @@
+//
+// SoftPixel Engine - RenderCommandBuffer Tests
+//
+
+#include <SoftPixelEngine.hpp>
+#include <boost/foreach.hpp>
+
+using namespace sp;
+
+#include "../common.hpp"
+
+SP_TESTS_DECLARE
+
+int main()
+{
+    SP_TESTS_INIT("RenderCommandBuffer")
+    
+    // Create a large grid of meshes
+    const scene::EBasicMeshes Models[] = { scene::MESH_CUBE, scene::MESH_SPHERE, scene::MESH_TORUS };
+    
+    const s32 GridSize = 40;
+    
+    for (s32 z = -GridSize/2; z < GridSize/2; ++z)
+    {
+        for (s32 x = -GridSize/2; x < GridSize/2; ++x)
+        {
+            scene::Mesh* Obj = spScene->createMesh(Models[math::Randomizer::randInt(0, 2)]);
+            Obj->getMaterial()->setColorMaterial(false);
+            Obj->getMaterial()->setDiffuseColor(video::color(math::Randomizer::randInt(64, 255), 128, 255));
+            Obj->setPosition(dim::vector3df(x * 2.0f, -3.0f, z * 2.0f + 45.0f));
+        }
+    }
+    
+    spScene->createLight();
+    
+    spScene->setParallelRecording(true);
+    
+    SP_TESTS_MAIN_BEGIN
+    {
+        if (spContext->isWindowActive())
+            tool::Toolset::moveCameraFree(0, 0.25f);
+        
+        // Toggle between immediate rendering and parallel recording
+        if (spControl->keyHit(io::KEY_SPACE))
+            spScene->setParallelRecording(!spScene->getParallelRecording());
+        
+        spScene->renderScene();
+        
+        // Summarize the command buffers of the last frame
+        u32 NumBuffers = 0, NumCommands = 0, NumDrawCommands = 0;
+        
+        if (spScene->getParallelRecording())
+        {
+            foreach (const video::RenderCommandBuffer* CmdBuffer, spScene->getCommandBuffers())
+            {
+                if (CmdBuffer->empty())
+                    continue;
+                
+                ++NumBuffers;
+                NumCommands += CmdBuffer->getNumCommands();
+                NumDrawCommands += CmdBuffer->getNumDrawCommands();
+            }
+        }
+        
+        Draw2DText(
+            dim::point2di(15, 15),
+            "Parallel Recording: " + io::stringc(spScene->getParallelRecording() ? "Enabled" : "Disabled") + " (Press Space)"
+        );
+        Draw2DText(
+            dim::point2di(15, 40),
+            "Command Buffers: " + io::stringc(NumBuffers) + ", Commands: " + io::stringc(NumCommands) +
+            ", Draw Commands: " + io::stringc(NumDrawCommands)
+        );
+    }
+    SP_TESTS_MAIN_END
+}
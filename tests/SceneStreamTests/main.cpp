@@ -0,0 +1,130 @@
+//
+// SoftPixel Engine - SceneStream Tests
+//
+
+#include <SoftPixelEngine.hpp>
+
+using namespace sp;
+
+#include "../common.hpp"
+
+SP_TESTS_DECLARE
+
+#ifdef SP_COMPILE_WITH_SCENEGRAPH_SIMPLE_STREAM
+
+const s32 GRID_SIZE = 30;
+
+scene::SceneGraphSimpleStream* Stream = 0;
+std::vector<scene::SceneNode*> Cubes;
+
+volatile bool IsLoaderRunning   = true;
+volatile bool IsLoaderFinished  = false;
+volatile u32 NumDeltas          = 0;
+
+// The loader thread never touches the scene graph lists directly, it only commits deltas
+THREAD_PROC(LoaderProc)
+{
+    scene::SceneStreamDelta Delta;
+    
+    const u32 HalfCount = Cubes.size() / 2;
+    bool IsHalfVisible = true;
+    
+    for (u32 Frame = 0; IsLoaderRunning; ++Frame)
+    {
+        // Animate all cubes
+        for (u32 i = 0; i < Cubes.size(); ++i)
+        {
+            const f32 x = static_cast<f32>(static_cast<s32>(i % GRID_SIZE) - GRID_SIZE/2);
+            const f32 z = static_cast<f32>(static_cast<s32>(i / GRID_SIZE) - GRID_SIZE/2);
+            
+            scene::Transformation Transform;
+            Transform.setPosition(dim::vector3df(
+                x * 2.0f, math::Sin(static_cast<f32>(Frame) * 4.0f + (x + z) * 20.0f) - 3.0f, z * 2.0f + 35.0f
+            ));
+            
+            Delta.setTransformation(Cubes[i], Transform);
+        }
+        
+        // Stream the second half of the cubes out and in again
+        if (Frame % 60 == 59)
+        {
+            for (u32 i = HalfCount; i < Cubes.size(); ++i)
+            {
+                if (IsHalfVisible)
+                    Delta.removeSceneNode(Cubes[i]);
+                else
+                    Delta.addSceneNode(Cubes[i]);
+            }
+            IsHalfVisible = !IsHalfVisible;
+        }
+        
+        Stream->commitDelta(Delta);
+        ++NumDeltas;
+        
+        io::Timer::sleep(16);
+    }
+    
+    IsLoaderFinished = true;
+    
+    return 0;
+}
+
+#endif
+
+int main()
+{
+    SP_TESTS_INIT("SceneStream")
+    
+    #ifdef SP_COMPILE_WITH_SCENEGRAPH_SIMPLE_STREAM
+    
+    // Create the streaming scene graph (this becomes the active scene graph)
+    Stream = static_cast<scene::SceneGraphSimpleStream*>(spDevice->createSceneGraph(scene::SCENEGRAPH_SIMPLE_STREAM));
+    
+    scene::Camera* StreamCam = Stream->createCamera();
+    StreamCam->setRange(0.1f, 1000.0f);
+    
+    Stream->createLight()->setRotation(dim::vector3df(25, 25, 0));
+    Stream->setLighting();
+    
+    for (s32 i = 0; i < GRID_SIZE*GRID_SIZE; ++i)
+    {
+        scene::Mesh* Obj = Stream->createMesh(scene::MESH_CUBE);
+        Obj->getMaterial()->setColorMaterial(false);
+        Obj->getMaterial()->setDiffuseColor(video::color(math::Randomizer::randInt(64, 255), 128, 255));
+        Cubes.push_back(Obj);
+    }
+    
+    ThreadManager* Loader = new ThreadManager(LoaderProc);
+    
+    while (spDevice->updateEvents() && !spControl->keyDown(io::KEY_ESCAPE))
+    {
+        spRenderer->clearBuffers();
+        
+        if (spContext->isWindowActive())
+            tool::Toolset::moveCameraFree(0, 0.25f);
+        
+        // The streamed changes are applied at the beginning of each frame
+        Stream->renderScene(StreamCam);
+        
+        Draw2DText(
+            dim::point2di(15, 15),
+            "Committed Deltas: " + io::stringc(NumDeltas) + ", Render Nodes: " + io::stringc(Stream->getRenderList().size())
+        );
+        
+        spContext->flipBuffers();
+    }
+    
+    // Stop the loader before the scene graph is deleted
+    IsLoaderRunning = false;
+    
+    while (!IsLoaderFinished)
+        io::Timer::sleep(1);
+    
+    delete Loader;
+    
+    deleteDevice();
+    
+    #endif
+    
+    return 0;
+}
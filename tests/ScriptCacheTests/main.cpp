@@ -0,0 +1,227 @@
+//
+// SoftPixel Engine - ScriptCache Tests
+//
+
+#include <SoftPixelEngine.hpp>
+#include <boost/foreach.hpp>
+
+#include "Framework/Tools/ScriptParser/spUtilityShaderPreProcessor.hpp"
+
+using namespace sp;
+
+#if defined(SP_COMPILE_WITH_SHADER_PREPROCESSOR) && defined(SP_COMPILE_WITH_MATERIAL_SCRIPT)
+
+#include "../common.hpp"
+
+SP_TESTS_DECLARE
+
+/*
+ * Global members
+ */
+
+const u32 NumScripts    = 100;
+const u32 NumBlocks     = 50;
+
+const io::stringc CorpusPath("ScriptCacheCorpus/");
+
+struct SResult
+{
+    io::stringc Name;
+    f64 MaterialTime;
+    f64 ShaderTime;
+};
+
+std::vector<SResult> Results;
+std::vector<io::stringc> ShaderCorpus;
+
+
+/*
+ * Corpus generation
+ */
+
+void GenerateMaterialScript(const io::stringc &Filename, u32 Index, u64 Seed)
+{
+    io::FileSystem FileSys;
+    io::File* ScriptFile = FileSys.openFile(Filename, io::FILE_WRITE);
+    
+    if (!ScriptFile)
+        return;
+    
+    // The seed makes sure that the first run is always a cold start
+    ScriptFile->writeStringN("; Generated material script (seed " + io::stringc(Seed) + ")");
+    
+    for (u32 i = 0; i < NumBlocks; ++i)
+    {
+        const io::stringc Name(io::stringc(Index) + "_" + io::stringc(i));
+        
+        ScriptFile->writeStringN("");
+        ScriptFile->writeStringN("material \"Mat" + Name + "\" {");
+        ScriptFile->writeStringN("\t@x = " + io::stringc(i % 256));
+        ScriptFile->writeStringN("\t@name = \"Generated\" + \" \" + \"" + Name + "\"");
+        ScriptFile->writeStringN("\tdiffuse = 255, 230, 100, 255\t\t; RGBA");
+        ScriptFile->writeStringN("\tspecular = @x, @x, @x");
+        ScriptFile->writeStringN("\tambient = 50");
+        ScriptFile->writeStringN("\tshininess = 0.8");
+        ScriptFile->writeStringN("\toffsetFactor = -1.0");
+        ScriptFile->writeStringN("\talphaReference = 0.1");
+        ScriptFile->writeStringN("\tshading = gouraud");
+        ScriptFile->writeStringN("\trenderFace = both");
+        ScriptFile->writeStringN("\tdepthTest = true");
+        ScriptFile->writeStringN("\tlighting = true");
+        ScriptFile->writeStringN("}");
+        ScriptFile->writeStringN("");
+        ScriptFile->writeStringN("vertexFormat \"Fmt" + Name + "\" {");
+        ScriptFile->writeStringN("\tcoord {");
+        ScriptFile->writeStringN("\t\tsize = 3");
+        ScriptFile->writeStringN("\t\ttype = float");
+        ScriptFile->writeStringN("\t}");
+        ScriptFile->writeStringN("\tnormal { }");
+        ScriptFile->writeStringN("\ttexCoord { size = 2 }");
+        ScriptFile->writeStringN("}");
+    }
+    
+    FileSys.closeFile(ScriptFile);
+}
+
+io::stringc GenerateShaderCode(u32 Index, u64 Seed)
+{
+    io::stringc Code("// Generated shader code (seed " + io::stringc(Seed) + ")\n");
+    
+    Code += "\n#define NUM_LIGHTS " + io::stringc(Index % 8 + 1) + "\n\n";
+    
+    for (u32 i = 0; i < NumBlocks; ++i)
+    {
+        Code += "float4 Shade" + io::stringc(i) + "(float4 Color, float2 TexCoord)\n";
+        Code += "{\n";
+        Code += "\tfloat3 Light = float3(0.1, 0.2, 0.3);\n";
+        Code += "\t[unroll]\n";
+        Code += "\tfor (int i = 0; i < NUM_LIGHTS; ++i)\n";
+        Code += "\t\tColor.rgb += Light * TexCoord.x * " + io::stringc(i) + ".5;\n";
+        Code += "\treturn Color;\n";
+        Code += "}\n\n";
+    }
+    
+    return Code;
+}
+
+void GenerateCorpus()
+{
+    io::FileSystem FileSys;
+    
+    FileSys.createDirectory(CorpusPath);
+    
+    const u64 Seed = io::Timer::millisecs();
+    
+    for (u32 i = 0; i < NumScripts; ++i)
+    {
+        GenerateMaterialScript(CorpusPath + "Script" + io::stringc(i) + ".material", i, Seed);
+        ShaderCorpus.push_back(GenerateShaderCode(i, Seed));
+    }
+}
+
+
+/*
+ * Benchmark
+ */
+
+void BenchmarkCorpus(tool::ScriptCache* Cache, const io::stringc &Name)
+{
+    SResult Result;
+    Result.Name = Name;
+    
+    // Load all material scripts
+    tool::MaterialScriptReader ScriptReader;
+    ScriptReader.setCache(Cache);
+    
+    u64 StartTime = io::Timer::microsecs();
+    
+    for (u32 i = 0; i < NumScripts; ++i)
+        ScriptReader.loadScript(CorpusPath + "Script" + io::stringc(i) + ".material");
+    
+    Result.MaterialTime = static_cast<f64>(io::Timer::microsecs() - StartTime) / 1000.0;
+    
+    // Pre-process all shaders
+    tool::ShaderPreProcessor ShaderPP;
+    ShaderPP.setCache(Cache);
+    
+    StartTime = io::Timer::microsecs();
+    
+    foreach (const io::stringc &InputCode, ShaderCorpus)
+    {
+        io::stringc OutputCode;
+        ShaderPP.preProcessShader(
+            InputCode, OutputCode, video::SHADER_PIXEL, video::GLSL_VERSION_1_20, "Shade0",
+            tool::SHADER_PREPROCESS_SOLVE_MACROS | tool::SHADER_PREPROCESS_NO_TABS
+        );
+    }
+    
+    Result.ShaderTime = static_cast<f64>(io::Timer::microsecs() - StartTime) / 1000.0;
+    
+    Results.push_back(Result);
+}
+
+
+/*
+ * Main function
+ */
+
+int main()
+{
+    SP_TESTS_INIT("ScriptCache")
+    
+    // Generate corpus and compare the load times without cache, with an empty cache (cold) and with a filled cache (warm)
+    GenerateCorpus();
+    
+    io::FileSystem().createDirectory(CorpusPath + "Cache");
+    
+    tool::ScriptCache Cache(CorpusPath + "Cache");
+    
+    io::Log::pause(true);
+    {
+        BenchmarkCorpus(0, "No cache");
+        BenchmarkCorpus(&Cache, "Cold start");
+        BenchmarkCorpus(&Cache, "Warm start");
+    }
+    io::Log::pause(false);
+    
+    foreach (const SResult &Result, Results)
+    {
+        io::Log::message(
+            Result.Name + ": Materials = " + io::stringc(Result.MaterialTime) + " ms, Shaders = " + io::stringc(Result.ShaderTime) + " ms"
+        );
+    }
+    
+    io::Log::message(
+        "Cache hits = " + io::stringc(Cache.getNumHits()) + ", Cache misses = " + io::stringc(Cache.getNumMisses())
+    );
+    
+    // Main loop
+    SP_TESTS_MAIN_BEGIN
+    {
+        for (u32 i = 0; i < Results.size(); ++i)
+        {
+            Draw2DText(
+                dim::point2di(15, 15 + i*25),
+                Results[i].Name + ": Materials = " + io::stringc(Results[i].MaterialTime) +
+                " ms, Shaders = " + io::stringc(Results[i].ShaderTime) + " ms"
+            );
+        }
+        
+        Draw2DText(
+            dim::point2di(15, 15 + Results.size()*25),
+            io::stringc(NumScripts) + " scripts, cache hits = " + io::stringc(Cache.getNumHits()) +
+            ", cache misses = " + io::stringc(Cache.getNumMisses())
+        );
+    }
+    SP_TESTS_MAIN_END
+}
+
+#else
+
+int main()
+{
+    io::Log::error("This engine was not compiled with 'shader pre-processor' and 'material script reader' utility");
+    return 0;
+}
+
+#endif
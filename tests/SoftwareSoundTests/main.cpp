@@ -0,0 +1,159 @@
+//
+// SoftPixel Engine - SoftwareSound Tests
+//
+
+#include <SoftPixelEngine.hpp>
+#include <boost/foreach.hpp>
+#include <boost/make_shared.hpp>
+
+#include "SoundSystem/Software/spSoftwareSoundDevice.hpp"
+
+using namespace sp;
+
+#ifdef SP_COMPILE_WITH_SOFTWARE_SOUND
+
+#include "../common.hpp"
+
+SP_TESTS_DECLARE
+
+/*
+ * Global members
+ */
+
+const u32 NumSounds     = 2000;
+const u32 NumSeconds    = 10;
+
+std::vector<io::stringc> Results;
+
+
+/*
+ * Sample generation
+ */
+
+audio::SAudioBufferPtr GenerateSine(f32 Frequency, f32 Duration, s32 SampleRate)
+{
+    audio::SAudioBufferPtr AudioBuffer = boost::make_shared<audio::SAudioBuffer>();
+    
+    const u32 NumFrames = static_cast<u32>(Duration * SampleRate);
+    
+    AudioBuffer->BufferSize = NumFrames * sizeof(s16);
+    AudioBuffer->BufferPCM  = new s8[AudioBuffer->BufferSize];
+    
+    audio::SWaveFormatFlags &Format = AudioBuffer->FormatFlags;
+    {
+        Format.Channels         = 1;
+        Format.SamplesPerSec    = SampleRate;
+        Format.BytePerSec       = SampleRate * sizeof(s16);
+        Format.BlockAlign       = sizeof(s16);
+        Format.BitsPerSample    = 16;
+        Format.ChannelFormat    = audio::WAVECHANNEL_MONO16;
+    }
+    
+    s16* Samples = reinterpret_cast<s16*>(AudioBuffer->BufferPCM);
+    
+    for (u32 i = 0; i < NumFrames; ++i)
+        Samples[i] = static_cast<s16>(sin(2.0 * math::PI * Frequency * i / SampleRate) * 16000.0);
+    
+    return AudioBuffer;
+}
+
+
+/*
+ * Benchmark
+ */
+
+void BenchmarkMixer(audio::SoftwareSoundDevice* SoundDev, u32 MaxVoices)
+{
+    SoundDev->setMaxVoices(MaxVoices);
+    
+    const u64 StartTime = io::Timer::microsecs();
+    
+    SoundDev->render(SoundDev->getSampleRate() * NumSeconds);
+    
+    const f64 Time = static_cast<f64>(io::Timer::microsecs() - StartTime) / 1000.0;
+    
+    Results.push_back(
+        io::stringc(NumSeconds) + " s audio with " + io::stringc(NumSounds) + " voices (max. " + io::stringc(MaxVoices) +
+        " mixed, " + io::stringc(SoundDev->getNumVirtualVoices()) + " virtual): " + io::stringc(Time) + " ms"
+    );
+}
+
+
+/*
+ * Main function
+ */
+
+int main()
+{
+    SP_TESTS_INIT("SoftwareSound")
+    
+    audio::SoftwareSoundDevice* SoundDev = static_cast<audio::SoftwareSoundDevice*>(
+        spDevice->createSoundDevice(audio::SOUNDDEVICE_SOFTWARE)
+    );
+    
+    // Render the audio manually into a WAV file
+    audio::WaveFileSoundSink Sink("SoftwareSoundOutput.wav");
+    
+    SoundDev->setAudioThread(false);
+    SoundDev->setSink(&Sink);
+    
+    // Create looping 3D sounds with different pitches (the sample rate differs from the device to test the resampling)
+    std::vector<audio::SoftwareSound*> Sounds;
+    
+    for (u32 i = 0; i < NumSounds; ++i)
+    {
+        audio::SoftwareSound* Snd = SoundDev->createSound();
+        
+        Snd->reload(GenerateSine(220.0f + (i % 24) * 20.0f, 1.0f, 22050));
+        Snd->setVolume(0.05f);
+        Snd->setLoop(true);
+        Snd->setVolumetric(true);
+        Snd->setVolumetricRadius(50.0f);
+        Snd->setPosition(
+            dim::vector3df(math::Randomizer::randFloat(-100.0f, 100.0f), 0.0f, math::Randomizer::randFloat(-100.0f, 100.0f))
+        );
+        Snd->setSpeed(math::Randomizer::randFloat(0.5f, 2.0f));
+        Snd->play();
+        
+        Sounds.push_back(Snd);
+    }
+    
+    // Compare mixing all audible voices and mixing only the loudest voices
+    BenchmarkMixer(SoundDev, NumSounds);
+    BenchmarkMixer(SoundDev, 64);
+    
+    foreach (const io::stringc &Result, Results)
+        io::Log::message(Result);
+    
+    // Mix the sounds in real-time on the audio thread
+    SoundDev->setSink(0);
+    SoundDev->setAudioThread(true);
+    
+    SP_TESTS_MAIN_BEGIN
+    {
+        // Move the listener in a circle
+        const f32 Angle = static_cast<f32>(io::Timer::millisecs() % 20000) * 0.018f;
+        
+        SoundDev->setListenerPosition(dim::vector3df(math::Sin(Angle) * 50.0f, 0.0f, math::Cos(Angle) * 50.0f));
+        
+        for (u32 i = 0; i < Results.size(); ++i)
+            Draw2DText(dim::point2di(15, 15 + i*25), Results[i]);
+        
+        Draw2DText(
+            dim::point2di(15, 15 + Results.size()*25),
+            "Playing voices: " + io::stringc(SoundDev->getNumPlayingVoices()) +
+            ", Virtual voices: " + io::stringc(SoundDev->getNumVirtualVoices())
+        );
+    }
+    SP_TESTS_MAIN_END
+}
+
+#else
+
+int main()
+{
+    io::Log::error("This engine was not compiled with software sound device");
+    return 0;
+}
+
+#endif
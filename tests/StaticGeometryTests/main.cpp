@@ -0,0 +1,99 @@
+//
+// SoftPixel Engine - StaticGeometry Tests
+//
+
+#include <SoftPixelEngine.hpp>
+#include <boost/foreach.hpp>
+
+using namespace sp;
+
+#include "../common.hpp"
+
+SP_TESTS_DECLARE
+
+int main()
+{
+    SP_TESTS_INIT("StaticGeometry")
+    
+    // Create many static props with a few different materials
+    std::vector<scene::Mesh*> Props;
+    
+    const scene::EBasicMeshes Models[] = { scene::MESH_CUBE, scene::MESH_SPHERE, scene::MESH_CYLINDER };
+    const video::color Colors[] = { video::color(255, 64, 64), video::color(64, 255, 64), video::color(64, 64, 255) };
+    
+    const s32 GridSize = 30;
+    
+    for (s32 z = -GridSize/2; z < GridSize/2; ++z)
+    {
+        for (s32 x = -GridSize/2; x < GridSize/2; ++x)
+        {
+            const s32 Type = math::Randomizer::randInt(0, 2);
+            
+            scene::Mesh* Obj = spScene->createMesh(Models[Type]);
+            Obj->getMaterial()->setColorMaterial(false);
+            Obj->getMaterial()->setDiffuseColor(Colors[(x + z + GridSize) % 3]);
+            Obj->setPosition(dim::vector3df(x * 2.0f, -3.0f, z * 2.0f + 35.0f));
+            Obj->setRotation(dim::vector3df(0, math::Randomizer::randFloat(0.0f, 360.0f), 0));
+            
+            Props.push_back(Obj);
+        }
+    }
+    
+    spScene->createLight();
+    
+    // Batch all props into shared pages
+    scene::StaticGeometry* Batch = new scene::StaticGeometry();
+    spScene->addSceneNode(Batch);
+    
+    foreach (scene::Mesh* Obj, Props)
+        Batch->addMesh(Obj);
+    
+    bool isBatching = true;
+    
+    SP_TESTS_MAIN_BEGIN
+    {
+        if (spContext->isWindowActive())
+            tool::Toolset::moveCameraFree(0, 0.25f);
+        
+        // Toggle the batching of all props
+        if (spControl->keyHit(io::KEY_SPACE))
+        {
+            isBatching = !isBatching;
+            
+            foreach (scene::Mesh* Obj, Props)
+            {
+                if (isBatching)
+                    Batch->addMesh(Obj);
+                else
+                    Batch->removeMesh(Obj);
+            }
+        }
+        
+        // Remove a random prop (the batch only rebuilds the pages of this prop)
+        if (spControl->keyHit(io::KEY_RETURN) && !Props.empty())
+        {
+            const u32 Index = math::Randomizer::randInt(0, Props.size() - 1);
+            
+            Batch->removeMesh(Props[Index]);
+            spScene->deleteNode(Props[Index]);
+            
+            Props.erase(Props.begin() + Index);
+        }
+        
+        spScene->renderScene();
+        
+        Draw2DText(
+            dim::point2di(15, 15),
+            "Batching: " + io::stringc(isBatching ? "Enabled" : "Disabled") + " (Press Space), Remove Prop (Press Return)"
+        );
+        Draw2DText(
+            dim::point2di(15, 40),
+            "Meshes: " + io::stringc(Batch->getNumMeshes()) + ", Pages: " + io::stringc(Batch->getNumPages())
+        );
+        Draw2DText(
+            dim::point2di(15, 65),
+            "Visible Ranges: " + io::stringc(Batch->getNumDrawnRanges()) + ", Batch Draw Calls: " + io::stringc(Batch->getNumDrawCalls())
+        );
+    }
+    SP_TESTS_MAIN_END
+}
@@ -0,0 +1,135 @@
+//
+// SoftPixel Engine - StreamedTerrain Tests
+//
+
+#include <SoftPixelEngine.hpp>
+
+using namespace sp;
+
+#include "../common.hpp"
+
+SP_TESTS_DECLARE
+
+/*
+ * Global members
+ */
+
+const s32 HEIGHTFIELD_SIZE = 4097;
+
+const io::stringc HEIGHTFIELD_FILENAME("StreamedTerrain.raw");
+
+
+/*
+ * Height field generation
+ */
+
+bool createHeightField(const io::stringc &Filename, s32 Size)
+{
+    /* Write the height field row by row, so the whole field is never hold in memory */
+    std::ofstream File(Filename.c_str(), std::ios::binary);
+    
+    if (!File.good())
+        return false;
+    
+    std::vector<u8> Row(Size*2);
+    
+    for (s32 y = 0; y < Size; ++y)
+    {
+        for (s32 x = 0; x < Size; ++x)
+        {
+            const f32 u = static_cast<f32>(x) / (Size - 1);
+            const f32 v = static_cast<f32>(y) / (Size - 1);
+            
+            const f32 Height =
+                0.5f +
+                0.25f   * sin(u * 7.0f ) * cos(v * 5.0f ) +
+                0.125f  * sin(u * 31.0f + v * 13.0f) +
+                0.0625f * cos(u * 97.0f) * sin(v * 113.0f);
+            
+            const u16 Value = static_cast<u16>(math::MinMax(Height, 0.0f, 1.0f) * 65535.0f);
+            
+            /* Store in little-endian byte order */
+            Row[x*2    ] = static_cast<u8>(Value & 0xFF);
+            Row[x*2 + 1] = static_cast<u8>(Value >> 8);
+        }
+        
+        File.write(reinterpret_cast<const c8*>(&Row[0]), Row.size());
+    }
+    
+    return File.good();
+}
+
+
+/*
+ * Main function
+ */
+
+int main()
+{
+    SP_TESTS_INIT("StreamedTerrain")
+    
+    /* Create height field file */
+    io::Log::message("Create height field (" + io::stringc(HEIGHTFIELD_SIZE) + " x " + io::stringc(HEIGHTFIELD_SIZE) + ") ...");
+    
+    if (!createHeightField(HEIGHTFIELD_FILENAME, HEIGHTFIELD_SIZE))
+    {
+        io::Log::error("Could not create height field file");
+        deleteDevice();
+        return 0;
+    }
+    
+    /* Create streamed terrain */
+    scene::SStreamedTerrainDesc Desc;
+    {
+        Desc.Filename       = HEIGHTFIELD_FILENAME;
+        Desc.Size           = HEIGHTFIELD_SIZE;
+        Desc.ThreadCount    = 2;
+    }
+    scene::StreamedTerrain* HeightField = spScene->createStreamedTerrain(Desc);
+    
+    if (!HeightField)
+    {
+        deleteDevice();
+        return 0;
+    }
+    
+    HeightField->setScale(dim::vector3df(4000, 300, 4000));
+    HeightField->setPosition(dim::vector3df(-2000, -200, -2000));
+    
+    Cam->setRange(0.5f, 5000.0f);
+    
+    // Main loop
+    while (spDevice->updateEvents() && !spControl->keyDown(io::KEY_ESCAPE))
+    {
+        spRenderer->clearBuffers();
+        
+        if (spContext->isWindowActive())
+            tool::Toolset::moveCameraFree(0, spControl->keyDown(io::KEY_SHIFT) ? 5.0f : 0.5f);
+        
+        if (spControl->keyHit(io::KEY_TAB))
+        {
+            static bool Wire;
+            Wire = !Wire;
+            spScene->setWireframe(Wire ? video::WIREFRAME_LINES : video::WIREFRAME_SOLID);
+        }
+        
+        spScene->renderScene();
+        
+        tool::Toolset::drawDebugInfo(Fnt);
+        
+        Draw2DText(dim::point2di(15, 225), "Levels: "          + io::stringc(HeightField->getNumLevels()));
+        Draw2DText(dim::point2di(15, 250), "Chunks in Memory: " + io::stringc(HeightField->getNumChunks()));
+        Draw2DText(dim::point2di(15, 275), "Drawn Chunks: "     + io::stringc(HeightField->getNumDrawnChunks()));
+        Draw2DText(dim::point2di(15, 300), "Pending Chunks: "   + io::stringc(HeightField->getNumPendingChunks()));
+        
+        spContext->flipBuffers();
+    }
+    
+    deleteDevice();
+    
+    return 0;
+}
+
+
+
+// ================================================================================